@@ -260,6 +260,8 @@ function (swift_benchmark_compile_archopts)
           ${bench_flags}
           "-parse-as-library"
           "-module-name" "${module_name}"
+          "-emit-module" "-emit-module-path"
+          "${objdir}/${module_name}.swiftmodule"
           "-I" "${objdir}"
           "-output-file-map" "${objdir}/${module_name}/outputmap.json"
           ${sources})
@@ -0,0 +1,109 @@
+//===--- DeepGenerics.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Deeply nested generic types with associated type requirements, and long
+// chains of generic collection adaptors. These stress requirement checking,
+// archetype building and, with optimization, generic specialization.
+
+public protocol Layer {
+  associatedtype Input
+  associatedtype Output
+  func apply(_ x: Input) -> Output
+}
+
+public struct Identity<T> : Layer {
+  public init() {}
+  public func apply(_ x: T) -> T { return x }
+}
+
+public struct Lift<T> : Layer {
+  public init() {}
+  public func apply(_ x: T) -> [T] { return [x] }
+}
+
+public struct Flatten<T> : Layer {
+  public init() {}
+  public func apply(_ x: [[T]]) -> [T] {
+    var result = [T]()
+    for xs in x { result += xs }
+    return result
+  }
+}
+
+public struct Compose<A : Layer, B : Layer where A.Output == B.Input>
+    : Layer {
+  let first: A
+  let second: B
+  public init(_ first: A, _ second: B) {
+    self.first = first
+    self.second = second
+  }
+  public func apply(_ x: A.Input) -> B.Output {
+    return second.apply(first.apply(x))
+  }
+}
+
+public struct Pair<A : Layer, B : Layer where A.Input == B.Input> : Layer {
+  let left: A
+  let right: B
+  public init(_ left: A, _ right: B) {
+    self.left = left
+    self.right = right
+  }
+  public func apply(_ x: A.Input) -> (A.Output, B.Output) {
+    return (left.apply(x), right.apply(x))
+  }
+}
+
+public func deepLayers(_ x: Int) -> [[Int]] {
+  let lift = Compose(Identity<Int>(), Lift<Int>())
+  let twice = Compose(Compose(lift, Lift<[Int]>()), Flatten<Int>())
+  let thrice = Compose(Compose(Compose(twice, Identity<[Int]>()),
+                               Lift<[Int]>()),
+                       Identity<[[Int]]>())
+  let deeper = Compose(Compose(Compose(thrice, Flatten<Int>()),
+                               Lift<[Int]>()),
+                       Compose(Identity<[[Int]]>(), Identity<[[Int]]>()))
+  let pair = Pair(deeper, Compose(Compose(lift, Lift<[Int]>()),
+                                  Identity<[[Int]]>()))
+  let (a, b) = pair.apply(x)
+  return a + b
+}
+
+public struct Box<T> {
+  public var value: T
+  public init(_ value: T) { self.value = value }
+  public func map<U>(_ f: (T) -> U) -> Box<U> { return Box<U>(f(value)) }
+}
+
+public func nestedBoxes(_ x: Int) -> Box<Box<Box<Box<Box<[Int?]>>>>> {
+  return Box(Box(Box(Box(Box([x, nil, x + 1])))))
+    .map { $0.map { $0.map { $0.map { $0.map { $0 + [x * 2] } } } } }
+}
+
+public func adaptorChains(_ xs: [Int]) -> [String] {
+  return Array(xs.lazy
+    .filter { $0 % 2 == 0 }
+    .map { $0 * 3 }
+    .filter { $0 > 10 }
+    .map { ($0, $0 + 1) }
+    .map { "\($0.0)-\($0.1)" }
+    .filter { !$0.isEmpty }
+    .enumerated()
+    .map { "\($0.offset): \($0.element)" })
+}
+
+public func zipChains(_ xs: [Int], _ ys: [Double], _ zs: [String])
+    -> [(Int, (Double, String))] {
+  return Array(zip(xs.map { $0 + 1 }.filter { $0 > 0 },
+                   zip(ys.map { $0 * 2 }, zs.map { $0 + "!" })))
+}
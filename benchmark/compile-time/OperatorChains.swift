@@ -0,0 +1,56 @@
+//===--- OperatorChains.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Long expressions of overloaded operators and literals. The constraint
+// solver has to pick an overload for every operator of an expression at once,
+// so these stress the disjunction search.
+
+func integerChains(_ a: Int, _ b: Int) -> [Int] {
+  let x = a + 1 * 2 - 3 + a * 4 - 5 / 6 + 7 * b - 8 + 9 * a
+  let y = (a + b) * (a - b) + (a * 2 - b * 3) / (b + 1) - a % 7 + 11
+  let z = a << 2 + b >> 1 | a & 0xFF ^ b & 0x0F | (a + b) << 3
+  return [x, y, z, x + y - z, x * 2 + y * 3 - z * 4 + 5]
+}
+
+func floatingPointChains(_ a: Double, _ b: Double) -> [Double] {
+  let x: Double = a * 1.5 + 2 - b / 3 + 4 * a - 5.5 + 6 * b - 7 + a / 8
+  let y = (a + 1.0) * (b - 2.0) / (a * b + 3.0) - (a - b) * 0.5 + 9.25
+  let z = a * a * a - 3 * a * a * b + 3 * a * b * b - b * b * b + 1
+  return [x, y, z, -x + y * 2.0 - z / 4.0]
+}
+
+func mixedChains(_ i: Int, _ d: Double, _ f: Float) -> Double {
+  let a = Double(i) * 2.0 + d - 3 + Double(i) / 4 + d * 5 - Double(f) * 6
+  let b = Double(f) + Double(f) * 0.5 + Double(i * 2 + 1) - d / 2 + 1.5
+  return a * b - (a + b) / 2 + Double(i) * d + Double(f) - 1
+}
+
+func stringChains(_ s: String, _ n: Int) -> String {
+  let a = s + "a" + s + "b" + String(n) + "c" + s + "d" + String(n + 1)
+  let b = "(" + a + ", " + s + ", " + String(n * 2) + ", " + a + ")"
+  return a + " " + b + " " + s + String(n) + "!" + a + b
+}
+
+func comparisonChains(_ a: Int, _ b: Double, _ s: String) -> Bool {
+  return a + 1 > 2 && b - 1 < 3.0 || a * 2 == 4 && a != 5 ||
+         s + "x" == "yx" && b * 2 >= 1.5 || a - 3 <= 7 && !(a == b.hashValue)
+}
+
+func collectionChains(_ a: Int) -> [Int] {
+  let x = [a + 1, a - 2, a * 3, a / 4] + [5, 6, 7] + [a] + [a * a, a + a]
+  let y = x.map { $0 * 2 + 1 }.filter { $0 % 3 == 0 || $0 > 10 }
+  return y + x.map { $0 - 1 } + [x.count + y.count, x[0] + y.count * 2]
+}
+
+func optionalChains(_ a: Int?, _ b: Int?, _ c: Int) -> Int {
+  return (a ?? 0) + (b ?? 1) * c - (a ?? c) / ((b ?? 1) + 1) + (a ?? b ?? c)
+}
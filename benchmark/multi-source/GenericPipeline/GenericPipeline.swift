@@ -0,0 +1,82 @@
+//===--- GenericPipeline.swift --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Pushes a million samples, 24 MB, through a pipeline of generic stages
+// that are defined in other files, and through the same pipeline built out
+// of existentials.
+import TestsUtils
+
+let NumSamples = 1_000_000
+
+let samples = makeSamples(NumSamples)
+
+let acceptedRange: ClosedRange<Double> = 10...150
+
+/// The number of samples that either pipeline must let through.
+let expectedCount: Int = {
+  var count = 0
+  for sample in samples
+      where acceptedRange.contains(sample.value - offsets[sample.sensor]) {
+    count += 1
+  }
+  return count
+}()
+
+@inline(never)
+public func run_GenericPipeline(_ N: Int) {
+  let pipeline = Calibrate(offsets: offsets)
+    .then(Filter<Sample> { acceptedRange.contains($0.value) })
+    .then(Map { (sample: Sample) -> Sample in
+      var scaled = sample
+      scaled.value *= 0.5
+      return scaled
+    })
+    .then(Map { (sample: Sample) -> (Int, Double) in
+      (sample.sensor % 16, sample.value)
+    })
+
+  for _ in 1...N {
+    var statistics = GroupStatistics<Int>()
+    feed(samples, through: pipeline, into: &statistics)
+    CheckResults(statistics.total == expectedCount &&
+                 statistics.counts.count == 16,
+                 "Incorrect results in GenericPipeline")
+  }
+}
+
+@inline(never)
+public func run_ExistentialPipeline(_ N: Int) {
+  let transforms: [SampleTransform] = [
+    CalibrateTransform(offsets: offsets),
+    RangeTransform(acceptedRange),
+    ScaleTransform(factor: 0.5),
+  ]
+
+  for _ in 1...N {
+    var statistics = GroupStatistics<Int>()
+    for sample in samples {
+      var current: Sample? = sample
+      for transform in transforms {
+        guard let input = current else {
+          break
+        }
+        current = transform.apply(input)
+      }
+      if let output = current {
+        statistics.add((output.sensor % 16, output.value))
+      }
+    }
+    CheckResults(statistics.total == expectedCount &&
+                 statistics.counts.count == 16,
+                 "Incorrect results in ExistentialPipeline")
+  }
+}
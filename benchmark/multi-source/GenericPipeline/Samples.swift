@@ -0,0 +1,110 @@
+//===--- Samples.swift ----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+import TestsUtils
+
+let NumSensors = 1024
+
+struct Sample {
+  var sensor: Int
+  var time: Int
+  var value: Double
+}
+
+/// Corrects each sample by the offset of its sensor.
+struct Calibrate : Stage {
+  let offsets: [Double]
+
+  func process(_ sample: Sample) -> Sample? {
+    var calibrated = sample
+    calibrated.value -= offsets[sample.sensor]
+    return calibrated
+  }
+}
+
+/// Groups the values of the samples by a key.
+struct GroupStatistics<Key : Hashable> : Accumulator {
+  var counts: [Key : Int] = [:]
+  var sums: [Key : Double] = [:]
+
+  mutating func add(_ element: (Key, Double)) {
+    counts[element.0] = (counts[element.0] ?? 0) + 1
+    sums[element.0] = (sums[element.0] ?? 0) + element.1
+  }
+
+  var total: Int {
+    var total = 0
+    for (_, count) in counts {
+      total += count
+    }
+    return total
+  }
+}
+
+/// The same steps, as a protocol without associated types, for pipelines
+/// built at run time out of existentials.
+protocol SampleTransform {
+  func apply(_ sample: Sample) -> Sample?
+}
+
+struct CalibrateTransform : SampleTransform {
+  let offsets: [Double]
+
+  func apply(_ sample: Sample) -> Sample? {
+    var calibrated = sample
+    calibrated.value -= offsets[sample.sensor]
+    return calibrated
+  }
+}
+
+final class RangeTransform : SampleTransform {
+  let range: ClosedRange<Double>
+
+  init(_ range: ClosedRange<Double>) {
+    self.range = range
+  }
+
+  func apply(_ sample: Sample) -> Sample? {
+    return range.contains(sample.value) ? sample : nil
+  }
+}
+
+struct ScaleTransform : SampleTransform {
+  let factor: Double
+
+  func apply(_ sample: Sample) -> Sample? {
+    var scaled = sample
+    scaled.value *= factor
+    return scaled
+  }
+}
+
+let offsets: [Double] = {
+  SRand()
+  var offsets: [Double] = []
+  for _ in 0..<NumSensors {
+    offsets.append(Double(Random() % 100) / 10)
+  }
+  return offsets
+}()
+
+func makeSamples(_ count: Int) -> [Sample] {
+  SRand()
+  var samples: [Sample] = []
+  samples.reserveCapacity(count)
+  for time in 0..<count {
+    samples.append(Sample(sensor: Int(Random() % Int64(NumSensors)),
+                          time: time,
+                          value: Double(Random() % 2000) / 10))
+  }
+  return samples
+}
@@ -0,0 +1,72 @@
+//===--- Stage.swift ------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// One step of a pipeline, which may drop its input.
+protocol Stage {
+  associatedtype Input
+  associatedtype Output
+  func process(_ input: Input) -> Output?
+}
+
+/// Feeds the output of one stage into the next.
+struct Chain<First : Stage, Second : Stage
+             where First.Output == Second.Input> : Stage {
+  let first: First
+  let second: Second
+
+  func process(_ input: First.Input) -> Second.Output? {
+    guard let middle = first.process(input) else {
+      return nil
+    }
+    return second.process(middle)
+  }
+}
+
+extension Stage {
+  func then<Next : Stage where Next.Input == Output>(
+    _ next: Next
+  ) -> Chain<Self, Next> {
+    return Chain(first: self, second: next)
+  }
+}
+
+struct Filter<T> : Stage {
+  let predicate: (T) -> Bool
+
+  func process(_ input: T) -> T? {
+    return predicate(input) ? input : nil
+  }
+}
+
+struct Map<T, U> : Stage {
+  let transform: (T) -> U
+
+  func process(_ input: T) -> U? {
+    return transform(input)
+  }
+}
+
+/// Consumes the output of a pipeline.
+protocol Accumulator {
+  associatedtype Element
+  mutating func add(_ element: Element)
+}
+
+func feed<P : Stage, A : Accumulator where P.Output == A.Element>(
+  _ input: [P.Input], through pipeline: P, into accumulator: inout A
+) {
+  for element in input {
+    if let output = pipeline.process(element) {
+      accumulator.add(output)
+    }
+  }
+}
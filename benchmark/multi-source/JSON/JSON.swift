@@ -0,0 +1,97 @@
+//===--- JSON.swift -------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Encodes and decodes a JSON document of about 5 MB, the shape of a large
+// API response, so that it doesn't fit in the caches.
+import TestsUtils
+
+let NumRecords = 16_384
+
+let words = [
+  "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+  "india", "juliett", "kilo", "lima", "mike", "november", "oscar", "papa",
+  "café", "naïve", "Zürich", "東京", "line\nbreak", "\"quoted\"", "tab\there",
+  "back\\slash",
+]
+
+func randomWord() -> String {
+  return words[Int(Random() % Int64(words.count))]
+}
+
+func makeRecord(_ id: Int) -> JSONValue {
+  var friends: [JSONValue] = []
+  for _ in 0..<Int(Random() % 8) {
+    friends.append(.number(Int(Random() % Int64(NumRecords))))
+  }
+  var bio = ""
+  for _ in 0..<Int(8 + Random() % 24) {
+    bio += randomWord()
+    bio += " "
+  }
+  return .object([
+    ("id", .number(id)),
+    ("name", .string(randomWord() + " " + randomWord())),
+    ("active", .bool(Random() % 2 == 0)),
+    ("score", .number(Int(Random() % 100_000) - 50_000)),
+    ("tags", .array([.string(randomWord()), .string(randomWord())])),
+    ("address", .object([
+      ("street", .string("\(Random() % 1000) \(randomWord()) street")),
+      ("city", .string(randomWord())),
+      ("zip", .number(Int(Random() % 100_000))),
+    ])),
+    ("friends", .array(friends)),
+    ("bio", .string(bio)),
+    ("parent", .null),
+  ])
+}
+
+let document: JSONValue = {
+  SRand()
+  var records: [JSONValue] = []
+  for id in 0..<NumRecords {
+    records.append(makeRecord(id))
+  }
+  return .object([("version", .number(1)), ("records", .array(records))])
+}()
+
+let encodedDocument: [UInt8] = {
+  var writer = JSONWriter()
+  writer.write(document)
+  return writer.bytes
+}()
+
+@inline(never)
+public func run_JSONEncode(_ N: Int) {
+  var size = 0
+  for _ in 1...N {
+    var writer = JSONWriter()
+    writer.write(document)
+    size = writer.bytes.count
+  }
+  CheckResults(size == encodedDocument.count,
+               "Incorrect results in JSONEncode")
+}
+
+@inline(never)
+public func run_JSONDecode(_ N: Int) {
+  var leaves = 0
+  for _ in 1...N {
+    var parser = JSONParser(encodedDocument)
+    do {
+      leaves = countLeaves(try parser.parse())
+    } catch {
+      leaves = -1
+    }
+  }
+  CheckResults(leaves == countLeaves(document),
+               "Incorrect results in JSONDecode")
+}
@@ -0,0 +1,266 @@
+//===--- JSONParser.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+enum JSONParseError : ErrorProtocol {
+  case unexpectedEnd
+  case unexpectedByte(at: Int)
+  case invalidEscape(at: Int)
+  case invalidUTF8(at: Int)
+}
+
+/// Decodes JSON values from UTF-8.
+struct JSONParser {
+  let bytes: [UInt8]
+  var position = 0
+
+  init(_ bytes: [UInt8]) {
+    self.bytes = bytes
+  }
+
+  /// Parse the whole input as a single value.
+  mutating func parse() throws -> JSONValue {
+    let value = try parseValue()
+    skipWhitespace()
+    if position != bytes.count {
+      throw JSONParseError.unexpectedByte(at: position)
+    }
+    return value
+  }
+
+  mutating func skipWhitespace() {
+    while position < bytes.count {
+      switch bytes[position] {
+      case UInt8(ascii: " "), UInt8(ascii: "\n"), UInt8(ascii: "\r"),
+           UInt8(ascii: "\t"):
+        position += 1
+      default:
+        return
+      }
+    }
+  }
+
+  /// Skip whitespace and return the next byte without consuming it.
+  mutating func peek() throws -> UInt8 {
+    skipWhitespace()
+    if position == bytes.count {
+      throw JSONParseError.unexpectedEnd
+    }
+    return bytes[position]
+  }
+
+  mutating func expect(_ byte: UInt8) throws {
+    if try peek() != byte {
+      throw JSONParseError.unexpectedByte(at: position)
+    }
+    position += 1
+  }
+
+  mutating func parseValue() throws -> JSONValue {
+    let byte = try peek()
+    switch byte {
+    case UInt8(ascii: "n"):
+      try parseLiteral("null")
+      return .null
+    case UInt8(ascii: "t"):
+      try parseLiteral("true")
+      return .bool(true)
+    case UInt8(ascii: "f"):
+      try parseLiteral("false")
+      return .bool(false)
+    case UInt8(ascii: "\""):
+      return .string(try parseString())
+    case UInt8(ascii: "["):
+      return try parseArray()
+    case UInt8(ascii: "{"):
+      return try parseObject()
+    case UInt8(ascii: "-"), UInt8(ascii: "0")...UInt8(ascii: "9"):
+      return .number(try parseNumber())
+    default:
+      throw JSONParseError.unexpectedByte(at: position)
+    }
+  }
+
+  mutating func parseLiteral(_ literal: String) throws {
+    for unit in literal.utf8 {
+      if position == bytes.count || bytes[position] != unit {
+        throw JSONParseError.unexpectedByte(at: position)
+      }
+      position += 1
+    }
+  }
+
+  mutating func parseNumber() throws -> Int {
+    var negative = false
+    if bytes[position] == UInt8(ascii: "-") {
+      negative = true
+      position += 1
+    }
+    let start = position
+    var value = 0
+    while position < bytes.count {
+      let byte = bytes[position]
+      if byte < UInt8(ascii: "0") || byte > UInt8(ascii: "9") {
+        break
+      }
+      value = value * 10 + Int(byte - UInt8(ascii: "0"))
+      position += 1
+    }
+    if position == start {
+      throw JSONParseError.unexpectedByte(at: position)
+    }
+    return negative ? -value : value
+  }
+
+  mutating func parseString() throws -> String {
+    try expect(UInt8(ascii: "\""))
+    let start = position
+
+    // Most strings have no escapes and can be decoded in place.
+    while position < bytes.count {
+      let byte = bytes[position]
+      if byte == UInt8(ascii: "\"") {
+        guard let result = String._fromCodeUnitSequence(
+            UTF8.self, input: bytes[start..<position]) else {
+          throw JSONParseError.invalidUTF8(at: start)
+        }
+        position += 1
+        return result
+      }
+      if byte == UInt8(ascii: "\\") {
+        break
+      }
+      position += 1
+    }
+
+    // Otherwise, unescape into a buffer.
+    var buffer = Array(bytes[start..<position])
+    while position < bytes.count {
+      let byte = bytes[position]
+      position += 1
+      switch byte {
+      case UInt8(ascii: "\""):
+        guard let result = String._fromCodeUnitSequence(
+            UTF8.self, input: buffer) else {
+          throw JSONParseError.invalidUTF8(at: start)
+        }
+        return result
+      case UInt8(ascii: "\\"):
+        try parseEscape(into: &buffer)
+      default:
+        buffer.append(byte)
+      }
+    }
+    throw JSONParseError.unexpectedEnd
+  }
+
+  mutating func parseEscape(into buffer: inout [UInt8]) throws {
+    if position == bytes.count {
+      throw JSONParseError.unexpectedEnd
+    }
+    let byte = bytes[position]
+    position += 1
+    switch byte {
+    case UInt8(ascii: "\""), UInt8(ascii: "\\"), UInt8(ascii: "/"):
+      buffer.append(byte)
+    case UInt8(ascii: "n"):
+      buffer.append(UInt8(ascii: "\n"))
+    case UInt8(ascii: "t"):
+      buffer.append(UInt8(ascii: "\t"))
+    case UInt8(ascii: "r"):
+      buffer.append(UInt8(ascii: "\r"))
+    case UInt8(ascii: "b"):
+      buffer.append(0x08)
+    case UInt8(ascii: "f"):
+      buffer.append(0x0C)
+    case UInt8(ascii: "u"):
+      let code = try parseHex4()
+      // Surrogate pairs aren't supported.
+      if code >= 0xD800 && code < 0xE000 {
+        throw JSONParseError.invalidEscape(at: position - 6)
+      }
+      UTF8.encode(UnicodeScalar(code)) { buffer.append($0) }
+    default:
+      throw JSONParseError.invalidEscape(at: position - 2)
+    }
+  }
+
+  mutating func parseHex4() throws -> UInt32 {
+    if position + 4 > bytes.count {
+      throw JSONParseError.unexpectedEnd
+    }
+    var code: UInt32 = 0
+    for _ in 0..<4 {
+      let byte = bytes[position]
+      var digit: UInt8
+      switch byte {
+      case UInt8(ascii: "0")...UInt8(ascii: "9"):
+        digit = byte - UInt8(ascii: "0")
+      case UInt8(ascii: "a")...UInt8(ascii: "f"):
+        digit = byte - UInt8(ascii: "a") + 10
+      case UInt8(ascii: "A")...UInt8(ascii: "F"):
+        digit = byte - UInt8(ascii: "A") + 10
+      default:
+        throw JSONParseError.invalidEscape(at: position)
+      }
+      code = code << 4 | UInt32(digit)
+      position += 1
+    }
+    return code
+  }
+
+  mutating func parseArray() throws -> JSONValue {
+    try expect(UInt8(ascii: "["))
+    var elements: [JSONValue] = []
+    if try peek() == UInt8(ascii: "]") {
+      position += 1
+      return .array(elements)
+    }
+    while true {
+      elements.append(try parseValue())
+      switch try peek() {
+      case UInt8(ascii: ","):
+        position += 1
+      case UInt8(ascii: "]"):
+        position += 1
+        return .array(elements)
+      default:
+        throw JSONParseError.unexpectedByte(at: position)
+      }
+    }
+  }
+
+  mutating func parseObject() throws -> JSONValue {
+    try expect(UInt8(ascii: "{"))
+    var members: [(String, JSONValue)] = []
+    if try peek() == UInt8(ascii: "}") {
+      position += 1
+      return .object(members)
+    }
+    while true {
+      if try peek() != UInt8(ascii: "\"") {
+        throw JSONParseError.unexpectedByte(at: position)
+      }
+      let key = try parseString()
+      try expect(UInt8(ascii: ":"))
+      members.append((key, try parseValue()))
+      switch try peek() {
+      case UInt8(ascii: ","):
+        position += 1
+      case UInt8(ascii: "}"):
+        position += 1
+        return .object(members)
+      default:
+        throw JSONParseError.unexpectedByte(at: position)
+      }
+    }
+  }
+}
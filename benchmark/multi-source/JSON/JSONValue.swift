@@ -0,0 +1,43 @@
+//===--- JSONValue.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// A JSON document. Numbers are integers only, so that the benchmarks
+/// measure the handling of the document rather than float formatting.
+enum JSONValue {
+  case null
+  case bool(Bool)
+  case number(Int)
+  case string(String)
+  case array([JSONValue])
+  case object([(String, JSONValue)])
+}
+
+/// The number of scalar values in \p value, used to check that decoding
+/// recovered the document that was encoded.
+func countLeaves(_ value: JSONValue) -> Int {
+  switch value {
+  case .null, .bool, .number, .string:
+    return 1
+  case .array(let elements):
+    var count = 0
+    for element in elements {
+      count += countLeaves(element)
+    }
+    return count
+  case .object(let members):
+    var count = 0
+    for (_, member) in members {
+      count += countLeaves(member)
+    }
+    return count
+  }
+}
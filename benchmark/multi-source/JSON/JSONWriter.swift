@@ -0,0 +1,94 @@
+//===--- JSONWriter.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+let hexDigits: [UInt8] = Array("0123456789abcdef".utf8)
+
+/// Encodes JSON values as UTF-8.
+struct JSONWriter {
+  var bytes: [UInt8] = []
+
+  mutating func write(_ value: JSONValue) {
+    switch value {
+    case .null:
+      bytes.append(contentsOf: "null".utf8)
+    case .bool(let value):
+      bytes.append(contentsOf: (value ? "true" : "false").utf8)
+    case .number(let value):
+      writeNumber(value)
+    case .string(let value):
+      writeString(value)
+    case .array(let elements):
+      bytes.append(UInt8(ascii: "["))
+      for (i, element) in elements.enumerated() {
+        if i > 0 {
+          bytes.append(UInt8(ascii: ","))
+        }
+        write(element)
+      }
+      bytes.append(UInt8(ascii: "]"))
+    case .object(let members):
+      bytes.append(UInt8(ascii: "{"))
+      for (i, (key, member)) in members.enumerated() {
+        if i > 0 {
+          bytes.append(UInt8(ascii: ","))
+        }
+        writeString(key)
+        bytes.append(UInt8(ascii: ":"))
+        write(member)
+      }
+      bytes.append(UInt8(ascii: "}"))
+    }
+  }
+
+  mutating func writeNumber(_ value: Int) {
+    var magnitude = value
+    if value < 0 {
+      bytes.append(UInt8(ascii: "-"))
+      magnitude = -value
+    }
+    // Write the digits backwards, then put them in order.
+    let start = bytes.count
+    repeat {
+      bytes.append(UInt8(ascii: "0") + UInt8(magnitude % 10))
+      magnitude /= 10
+    } while magnitude != 0
+    var low = start, high = bytes.count - 1
+    while low < high {
+      swap(&bytes[low], &bytes[high])
+      low += 1
+      high -= 1
+    }
+  }
+
+  mutating func writeString(_ value: String) {
+    bytes.append(UInt8(ascii: "\""))
+    for unit in value.utf8 {
+      switch unit {
+      case UInt8(ascii: "\""):
+        bytes.append(contentsOf: "\\\"".utf8)
+      case UInt8(ascii: "\\"):
+        bytes.append(contentsOf: "\\\\".utf8)
+      case UInt8(ascii: "\n"):
+        bytes.append(contentsOf: "\\n".utf8)
+      case UInt8(ascii: "\t"):
+        bytes.append(contentsOf: "\\t".utf8)
+      case 0..<0x20:
+        bytes.append(contentsOf: "\\u00".utf8)
+        bytes.append(hexDigits[Int(unit >> 4)])
+        bytes.append(hexDigits[Int(unit & 0xF)])
+      default:
+        bytes.append(unit)
+      }
+    }
+    bytes.append(UInt8(ascii: "\""))
+  }
+}
@@ -0,0 +1,72 @@
+//===--- DictionaryWorkload.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Dictionaries of a million entries, tens of megabytes each, so that every
+// lookup misses the caches.
+import TestsUtils
+
+let NumDictionaryKeys = 1_000_000
+let NumStringKeys = 250_000
+
+let dictionaryKeys = makeIntKeys(NumDictionaryKeys)
+let stringKeys = makeIntKeys(NumStringKeys).map { "user-\($0)@example.com" }
+
+@inline(never)
+public func run_LargeDictionary(_ N: Int) {
+  for _ in 1...N {
+    // Grow the dictionary from empty, so that it rehashes as it goes.
+    var dict: [Int : Int] = [:]
+    for key in dictionaryKeys {
+      dict[key] = key
+    }
+
+    // Look up every other key, half of which are absent.
+    var found = 0
+    for i in stride(from: 0, to: NumDictionaryKeys, by: 2) {
+      if dict[dictionaryKeys[i] + NumDictionaryKeys * (i & 2)] != nil {
+        found += 1
+      }
+    }
+
+    // Update in place, and remove a quarter of the entries.
+    for i in 0..<NumDictionaryKeys {
+      let key = dictionaryKeys[i]
+      if i % 4 == 0 {
+        _ = dict.removeValue(forKey: key)
+      } else {
+        dict[key]! += 1
+      }
+    }
+
+    CheckResults(found == NumDictionaryKeys / 4 &&
+                 dict.count == NumDictionaryKeys - NumDictionaryKeys / 4,
+                 "Incorrect results in LargeDictionary")
+  }
+}
+
+@inline(never)
+public func run_LargeDictionaryOfStrings(_ N: Int) {
+  for _ in 1...N {
+    var dict: [String : Int] = [:]
+    for (i, key) in stringKeys.enumerated() {
+      dict[key] = i
+    }
+
+    var sum = 0
+    for key in stringKeys.reversed() {
+      sum += dict[key]!
+    }
+
+    CheckResults(sum == NumStringKeys * (NumStringKeys - 1) / 2,
+                 "Incorrect results in LargeDictionaryOfStrings")
+  }
+}
@@ -0,0 +1,40 @@
+//===--- Keys.swift -------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+import TestsUtils
+
+/// A key made of several fields, like the keys of a join or a group-by.
+struct CompositeKey : Hashable {
+  var region: Int
+  var id: Int
+
+  var hashValue: Int {
+    return region.hashValue &* 31 &+ id.hashValue
+  }
+}
+
+func ==(lhs: CompositeKey, rhs: CompositeKey) -> Bool {
+  return lhs.region == rhs.region && lhs.id == rhs.id
+}
+
+/// \p count distinct keys in random order.
+func makeIntKeys(_ count: Int) -> [Int] {
+  SRand()
+  var keys = Array(0..<count)
+  for i in (1..<count).reversed() {
+    let j = Int(Random() % Int64(i + 1))
+    if i != j {
+      swap(&keys[i], &keys[j])
+    }
+  }
+  return keys
+}
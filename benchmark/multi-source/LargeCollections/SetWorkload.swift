@@ -0,0 +1,51 @@
+//===--- SetWorkload.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Set algebra on sets of a million composite keys.
+import TestsUtils
+
+let NumSetKeys = 1_000_000
+
+let setKeys: [CompositeKey] = makeIntKeys(NumSetKeys).map {
+  CompositeKey(region: $0 % 64, id: $0 / 64)
+}
+
+@inline(never)
+public func run_LargeSet(_ N: Int) {
+  for _ in 1...N {
+    // Two sets that overlap by half.
+    var evens = Set<CompositeKey>()
+    var lowHalf = Set<CompositeKey>(minimumCapacity: NumSetKeys / 2)
+    for key in setKeys {
+      if key.id % 2 == 0 {
+        evens.insert(key)
+      }
+      if key.id < NumSetKeys / 128 {
+        lowHalf.insert(key)
+      }
+    }
+
+    let both = evens.intersection(lowHalf)
+    let either = evens.union(lowHalf)
+    var onlyEvens = evens
+    onlyEvens.subtract(lowHalf)
+
+    var contained = 0
+    for key in setKeys where either.contains(key) {
+      contained += 1
+    }
+
+    CheckResults(both.count + onlyEvens.count == evens.count &&
+                 contained == either.count,
+                 "Incorrect results in LargeSet")
+  }
+}
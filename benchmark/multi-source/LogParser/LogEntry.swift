@@ -0,0 +1,34 @@
+//===--- LogEntry.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+enum LogLevel : String {
+  case debug = "DEBUG"
+  case info = "INFO"
+  case warning = "WARN"
+  case error = "ERROR"
+}
+
+/// A parsed line of the form
+///
+///   2016-06-14T12:34:56Z [INFO] net.http: GET /api/users/1234 200 17ms
+///     "the user agent"
+struct LogEntry {
+  /// Seconds since the start of the day.
+  var time: Int
+  var level: LogLevel
+  var component: String
+  var method: String
+  var path: String
+  var status: Int
+  var milliseconds: Int
+  var userAgent: String
+}
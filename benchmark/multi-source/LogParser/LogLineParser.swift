@@ -0,0 +1,80 @@
+//===--- LogLineParser.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Parses log lines with the String and Character APIs, the way most
+// programs do it, rather than by looking at the bytes of their encoding.
+
+/// Parse "HH:MM:SS" out of an ISO 8601 timestamp.
+func parseTime(_ timestamp: String.CharacterView) -> Int? {
+  guard let t = timestamp.index(of: "T") else {
+    return nil
+  }
+  var clock = timestamp.suffix(from: timestamp.index(after: t))
+  if clock.last == "Z" {
+    clock = clock.prefix(upTo: clock.index(before: clock.endIndex))
+  }
+  var seconds = 0
+  for field in clock.split(separator: ":") {
+    guard let value = Int(String(field)) else {
+      return nil
+    }
+    seconds = seconds * 60 + value
+  }
+  return seconds
+}
+
+func parseLogLine(_ line: String) -> LogEntry? {
+  let fields = line.characters.split(separator: " ", maxSplits: 7)
+  if fields.count != 8 {
+    return nil
+  }
+
+  // "[INFO]"
+  var level = fields[1]
+  guard level.first == "[" && level.last == "]" else {
+    return nil
+  }
+  level = level.dropFirst().dropLast()
+
+  // "net.http:"
+  var component = fields[2]
+  guard component.last == ":" else {
+    return nil
+  }
+  component = component.dropLast()
+
+  // "17ms"
+  let duration = fields[6]
+  guard String(duration.suffix(2)) == "ms" else {
+    return nil
+  }
+
+  // "\"the user agent\""
+  var userAgent = fields[7]
+  guard userAgent.first == "\"" && userAgent.last == "\"" else {
+    return nil
+  }
+  userAgent = userAgent.dropFirst().dropLast()
+
+  guard let time = parseTime(fields[0]),
+        let parsedLevel = LogLevel(rawValue: String(level)),
+        let status = Int(String(fields[5])),
+        let milliseconds = Int(String(duration.dropLast(2)))
+  else {
+    return nil
+  }
+
+  return LogEntry(time: time, level: parsedLevel,
+                  component: String(component), method: String(fields[3]),
+                  path: String(fields[4]), status: status,
+                  milliseconds: milliseconds, userAgent: String(userAgent))
+}
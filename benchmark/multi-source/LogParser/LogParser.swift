@@ -0,0 +1,93 @@
+//===--- LogParser.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Splits a log of about two million characters into lines, parses them and
+// aggregates them by component, status and resource.
+import TestsUtils
+
+let NumLines = 20_000
+
+let components = [
+  "net.http", "net.tls", "db.query", "db.pool", "cache", "auth", "scheduler",
+]
+let methods = ["GET", "GET", "GET", "POST", "PUT", "DELETE"]
+let resources = ["users", "orders", "items", "sessions", "carts", "reviews"]
+let userAgents = [
+  "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_11_5)",
+  "curl/7.43.0",
+  "Säkerhetskontroll/2.1 (övervakning)",
+  "クローラー/1.0",
+  "Swift-HTTP/1.0 🐦",
+]
+
+func pick(_ strings: [String]) -> String {
+  return strings[Int(Random() % Int64(strings.count))]
+}
+
+func twoDigits(_ value: Int) -> String {
+  return value < 10 ? "0\(value)" : "\(value)"
+}
+
+let logText: String = {
+  SRand()
+  let levels = ["DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"]
+  let statuses = [200, 200, 200, 201, 204, 304, 404, 500]
+  var log = ""
+  for i in 0..<NumLines {
+    let time = i * 86_400 / NumLines
+    log += "2016-06-14T\(twoDigits(time / 3600)):"
+    log += "\(twoDigits(time / 60 % 60)):\(twoDigits(time % 60))Z "
+    log += "[\(pick(levels))] \(pick(components)): \(pick(methods)) "
+    log += "/api/\(pick(resources))/\(Random() % 10_000) "
+    log += "\(statuses[Int(Random() % Int64(statuses.count))]) "
+    log += "\(Random() % 500)ms \"\(pick(userAgents))\"\n"
+  }
+  return log
+}()
+
+@inline(never)
+public func run_LogParse(_ N: Int) {
+  var parsed = 0
+  for _ in 1...N {
+    var requestsByComponent: [String : Int] = [:]
+    var millisecondsByStatus: [Int : Int] = [:]
+    var requestsByResource: [String : Int] = [:]
+    var errors = 0
+    parsed = 0
+
+    for line in logText.characters.split(separator: "\n") {
+      guard let entry = parseLogLine(String(line)) else {
+        continue
+      }
+      parsed += 1
+      requestsByComponent[entry.component] =
+        (requestsByComponent[entry.component] ?? 0) + 1
+      millisecondsByStatus[entry.status] =
+        (millisecondsByStatus[entry.status] ?? 0) + entry.milliseconds
+      // "/api/users/1234" -> "users"
+      let pathFields = entry.path.characters.split(separator: "/")
+      if pathFields.count >= 2 {
+        let resource = String(pathFields[1])
+        requestsByResource[resource] = (requestsByResource[resource] ?? 0) + 1
+      }
+      if entry.level == .error || entry.status >= 500 {
+        errors += 1
+      }
+    }
+
+    CheckResults(requestsByComponent.count == components.count &&
+                 requestsByResource.count == resources.count &&
+                 errors > 0,
+                 "Incorrect results in LogParse")
+  }
+  CheckResults(parsed == NumLines, "Incorrect results in LogParse")
+}
@@ -0,0 +1,289 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# ===--- bisect_benchmark_passes.py --------------------------------------===//
+#
+#  This source file is part of the Swift.org open source project
+#
+#  Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+#  Licensed under Apache License v2.0 with Runtime Library Exception
+#
+#  See http://swift.org/LICENSE.txt for license information
+#  See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ===---------------------------------------------------------------------===//
+#
+# Finds the SIL pass run that makes a benchmark slower or its code bigger.
+# The benchmark is built on its own, with -sil-opt-pass-count limiting the
+# number of optimizer passes that run, and the pass count is binary searched
+# for the first run after which the benchmark is on the bad side of a
+# threshold. The name of that pass, the function it ran on, and the SIL
+# before and after it are printed:
+#
+#   bisect_benchmark_passes.py --swiftc <swiftc> \
+#     single-source/StringWalk.swift StringWalk
+#   bisect_benchmark_passes.py --swiftc <swiftc> --metric size \
+#     multi-source/JSON JSONDecode
+#
+# ===---------------------------------------------------------------------===//
+
+from __future__ import print_function
+
+import argparse
+import difflib
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+SCRIPT_DIR = os.path.dirname(os.path.realpath(__file__))
+TESTS_UTILS = os.path.join(SCRIPT_DIR, os.pardir, 'utils', 'TestsUtils.swift')
+
+MAIN_TEMPLATE = """\
+import TestsUtils
+import {module}
+#if os(Linux)
+import Glibc
+#else
+import Darwin
+#endif
+
+func now() -> Int {{
+  var tv = timeval()
+  gettimeofday(&tv, nil)
+  return Int(tv.tv_sec) * 1_000_000 + Int(tv.tv_usec)
+}}
+
+let iterations = Int(Process.arguments[1])!
+let samples = Int(Process.arguments[2])!
+var best = Int.max
+for _ in 0..<samples {{
+  let start = now()
+  run_{test}(iterations)
+  best = min(best, now() - start)
+}}
+print(best)
+"""
+
+
+class Bisector(object):
+
+    def __init__(self, args, work_dir):
+        self.args = args
+        self.work_dir = work_dir
+        path = os.path.abspath(args.benchmark)
+        if os.path.isdir(path):
+            self.module = os.path.basename(path)
+            self.sources = sorted(os.path.join(path, f)
+                                  for f in os.listdir(path)
+                                  if f.endswith('.swift'))
+        else:
+            self.module = os.path.splitext(os.path.basename(path))[0]
+            self.sources = [path]
+        self.cache = {}
+
+    def swiftc(self, args, **kwargs):
+        cmd = [self.args.swiftc] + self.args.opts + args
+        if self.args.verbose:
+            print(' '.join(cmd), file=sys.stderr)
+        return subprocess.check_output(cmd, cwd=self.work_dir,
+                                       stderr=subprocess.STDOUT,
+                                       universal_newlines=True, **kwargs)
+
+    def build_harness(self):
+        """Build TestsUtils, and the main file that times the benchmark,
+        once. Only the benchmark's module is rebuilt for each pass count."""
+        self.swiftc(['-parse-as-library', '-module-name', 'TestsUtils',
+                     '-emit-module', '-c', '-o', 'TestsUtils.o', TESTS_UTILS])
+        # Emit the benchmark's interface once with the whole pipeline, so
+        # that main can be compiled.
+        self.compile_module(None)
+        main = os.path.join(self.work_dir, 'main.swift')
+        with open(main, 'w') as f:
+            f.write(MAIN_TEMPLATE.format(module=self.module,
+                                         test=self.args.test))
+        self.swiftc(['-I', '.', '-c', '-o', 'main.o', main])
+
+    def compile_module(self, pass_count, extra_args=[],
+                       output='Benchmark.o'):
+        args = ['-parse-as-library', '-module-name', self.module,
+                '-whole-module-optimization', '-I', '.', '-emit-module',
+                '-emit-module-path', self.module + '.swiftmodule',
+                '-c', '-o', output]
+        if pass_count is not None:
+            args += ['-Xllvm', '-sil-opt-pass-count=%d' % pass_count]
+        return self.swiftc(args + extra_args + self.sources)
+
+    def count_passes(self):
+        """Return the number of passes the optimizer runs on the
+        benchmark. The mandatory passes run without a stage name and are
+        not counted."""
+        out = self.compile_module(None, ['-Xllvm', '-sil-print-pass-name'])
+        numbers = [int(n) for n in re.findall(r'^#(\d+) Stage: \S', out,
+                                              re.MULTILINE)]
+        return max(numbers) + 1 if numbers else 0
+
+    def measure(self, pass_count):
+        if pass_count in self.cache:
+            return self.cache[pass_count]
+        self.compile_module(pass_count)
+        if self.args.metric == 'size':
+            value = text_size(os.path.join(self.work_dir, 'Benchmark.o'))
+        else:
+            self.swiftc(['-o', 'bench', 'main.o', 'Benchmark.o',
+                         'TestsUtils.o'])
+            out = subprocess.check_output(
+                [os.path.join(self.work_dir, 'bench'),
+                 str(self.args.num_iters), str(self.args.num_samples)],
+                universal_newlines=True)
+            value = int(out.split()[-1])
+        self.cache[pass_count] = value
+        print('pass count %d: %d %s' % (pass_count, value, self.unit()))
+        sys.stdout.flush()
+        return value
+
+    def unit(self):
+        return 'bytes' if self.args.metric == 'size' else 'us'
+
+    def explain(self, pass_count):
+        """Print the pass that runs last when pass_count passes run."""
+        out = self.compile_module(pass_count,
+                                  ['-Xllvm', '-sil-print-pass-name',
+                                   '-Xllvm', '-sil-print-last'],
+                                  output='Last.o')
+        before = re.search(r'^\*\*\* SIL (function|module) before (.*) '
+                           r'\(\d+\) \*\*\*$', out, re.MULTILINE)
+        after = re.search(r'^\*\*\* SIL (function|module) after .* '
+                          r'\(\d+\) \*\*\*$', out, re.MULTILINE)
+        line = re.search(r'^#%d Stage: \S.*$' % (pass_count - 1), out,
+                         re.MULTILINE)
+        if line:
+            print(line.group(0))
+        if not before or not after:
+            print('error: the compiler printed no SIL for pass #%d; does it '
+                  'support -sil-print-last?' % (pass_count - 1),
+                  file=sys.stderr)
+            return
+        before_sil = out[before.end():after.start()].strip('\n')
+        after_sil = out[after.end():].strip('\n')
+        # Stop at the output that follows the dump, if any.
+        end = re.search(r'^(#\d+ Stage:|\(Skip\)|\(Disabled\))', after_sil,
+                        re.MULTILINE)
+        if end:
+            after_sil = after_sil[:end.start()].rstrip('\n')
+
+        print()
+        print('*** SIL %s before %s ***' % (before.group(1), before.group(2)))
+        print(before_sil)
+        print()
+        print('*** SIL %s after %s ***' % (before.group(1), before.group(2)))
+        print(after_sil)
+        print()
+        print('*** Difference ***')
+        for diff_line in difflib.unified_diff(before_sil.splitlines(),
+                                              after_sil.splitlines(),
+                                              'before', 'after', lineterm=''):
+            print(diff_line)
+
+
+def text_size(path):
+    """Return the size of the text segment of an object file, as reported
+    by size(1): the first column of its second line on both Darwin and
+    Linux."""
+    out = subprocess.check_output(['size', path], universal_newlines=True)
+    return int(out.splitlines()[1].split()[0])
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Binary search the SIL pass count for the pass run that '
+                    'makes a benchmark slower or bigger.')
+    parser.add_argument('benchmark',
+                        help='the source of the benchmark: a file in '
+                             'single-source or a directory in multi-source')
+    parser.add_argument('test',
+                        help='the test to time, i.e. the name of its run_ '
+                             'function without the prefix')
+    parser.add_argument('--swiftc', default='swiftc',
+                        help='the compiler to bisect (default: swiftc)')
+    parser.add_argument('--metric', choices=['time', 'size'], default='time',
+                        help='what got worse: the run time of the test or '
+                             'the text size of its module (default: time)')
+    parser.add_argument('--threshold', type=int,
+                        help='values above this are bad (default: halfway '
+                             'between the values at the good and bad pass '
+                             'counts)')
+    parser.add_argument('--good-count', type=int, default=0,
+                        help='a pass count at which the benchmark is good '
+                             '(default: 0)')
+    parser.add_argument('--bad-count', type=int,
+                        help='a pass count at which the benchmark is bad '
+                             '(default: all passes)')
+    parser.add_argument('--num-iters', type=int, default=1,
+                        help='the N passed to the run function (default: 1)')
+    parser.add_argument('--num-samples', type=int, default=5,
+                        help='take the fastest of this many runs '
+                             '(default: 5)')
+    parser.add_argument('-X', dest='opts', action='append', default=['-O'],
+                        metavar='OPTION',
+                        help='pass OPTION on to the compiler (default: -O)')
+    parser.add_argument('--build-dir',
+                        help='build in this directory, and keep it')
+    parser.add_argument('-v', '--verbose', action='store_true',
+                        help='print the compiler invocations')
+    args = parser.parse_args()
+
+    if args.build_dir:
+        work_dir = os.path.abspath(args.build_dir)
+        if not os.path.isdir(work_dir):
+            os.makedirs(work_dir)
+    else:
+        work_dir = tempfile.mkdtemp(prefix='bisect-passes-')
+    try:
+        bisector = Bisector(args, work_dir)
+        bisector.build_harness()
+
+        good = args.good_count
+        bad = args.bad_count
+        if bad is None:
+            bad = bisector.count_passes()
+            print('the optimizer runs %d passes' % bad)
+        good_value = bisector.measure(good)
+        bad_value = bisector.measure(bad)
+        threshold = args.threshold
+        if threshold is None:
+            threshold = (good_value + bad_value) // 2
+        print('threshold: %d %s' % (threshold, bisector.unit()))
+        if good_value > threshold or bad_value <= threshold:
+            print('error: pass count %d must be at or below the threshold and '
+                  'pass count %d above it; use --good-count, --bad-count or '
+                  '--threshold' % (good, bad), file=sys.stderr)
+            return 1
+
+        # Invariant: good passes are fine, bad passes are not.
+        while bad - good > 1:
+            middle = (good + bad) // 2
+            if bisector.measure(middle) > threshold:
+                bad = middle
+            else:
+                good = middle
+
+        print()
+        print('pass #%d makes the benchmark go from %d to %d %s:' %
+              (good, bisector.measure(good), bisector.measure(bad),
+               bisector.unit()))
+        bisector.explain(bad)
+    except subprocess.CalledProcessError as e:
+        print('error: %s failed:\n%s' % (' '.join(e.cmd), e.output or ''),
+              file=sys.stderr)
+        return 1
+    finally:
+        if not args.build_dir:
+            shutil.rmtree(work_dir)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
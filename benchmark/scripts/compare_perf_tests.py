@@ -15,6 +15,7 @@
 
 import argparse
 import csv
+import math
 import sys
 
 TESTNAME = 1
@@ -24,6 +25,11 @@ MAX = 4
 MEAN = 5
 SD = 6
 MEDIAN = 7
+VALUES = 9
+
+# The fewest samples of each run for which the significance of a change is
+# tested. With fewer, changes are judged by the threshold alone.
+MIN_SIGNIFICANCE_SAMPLES = 5
 
 HTML = """
 <!DOCTYPE html>
@@ -80,6 +86,9 @@ def main():
     new_results = {}
     old_max_results = {}
     new_max_results = {}
+    old_values = {}
+    new_values = {}
+    insignificant_list = set()
     ratio_list = {}
     delta_list = {}
     unknown_list = {}
@@ -107,6 +116,10 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--significance',
+                        help='only report changes whose p-value in a '
+                             'Mann-Whitney U test of the samples is below '
+                             'this (default: 0.01)', default="0.01")
 
     args = parser.parse_args()
 
@@ -121,9 +134,12 @@ def main():
 
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
+    significance = float(args.significance)
 
     for row in old_data:
         if (len(row) > 7 and row[MIN].isdigit()):
+            old_values.setdefault(row[TESTNAME], []).extend(
+                parse_values(row))
             if row[TESTNAME] in old_results:
                 if old_results[row[TESTNAME]] > int(row[MIN]):
                     old_results[row[TESTNAME]] = int(row[MIN])
@@ -135,6 +151,8 @@ def main():
 
     for row in new_data:
         if (len(row) > 7 and row[MIN].isdigit()):
+            new_values.setdefault(row[TESTNAME], []).extend(
+                parse_values(row))
             if row[TESTNAME] in new_results:
                 if int(new_results[row[TESTNAME]]) > int(row[MIN]):
                     new_results[row[TESTNAME]] = int(row[MIN])
@@ -146,6 +164,9 @@ def main():
 
     ratio_total = 0
     for key in new_results.keys():
+            # Tests that only one of the runs has can't be compared.
+            if key not in old_results:
+                continue
             ratio = (old_results[key]+0.001)/(new_results[key]+0.001)
             ratio_list[key] = round(ratio, 2)
             ratio_total *= ratio
@@ -160,10 +181,21 @@ def main():
             else:
                     unknown_list[key] = ""
 
+            # With enough samples, a change only counts when it is
+            # statistically significant, however large it is.
+            if (len(old_values[key]) >= MIN_SIGNIFICANCE_SAMPLES and
+                    len(new_values[key]) >= MIN_SIGNIFICANCE_SAMPLES):
+                p_value = mann_whitney_p_value(old_values[key],
+                                               new_values[key])
+                unknown_list[key] = " (p={0:.3f})".format(p_value)
+                if p_value >= significance:
+                    insignificant_list.add(key)
+
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only,
+                                        insignificant_list)
 
     """
     Create markdown formatted table
@@ -251,7 +283,8 @@ def main():
             """
             html_data = convert_to_html(ratio_list, old_results, new_results,
                                         delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+                                        new_branch, args.changes_only,
+                                        insignificant_list)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -267,15 +300,19 @@ def main():
 
 
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+                    unknown_list, old_branch, new_branch, changes_only,
+                    insignificant_list=()):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, changes_only,
+                                         insignificant_list)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in insignificant_list:
+            color = "black"
+        elif ratio_list[key] < RATIO_MIN:
             color = "red"
         elif ratio_list[key] > RATIO_MAX:
             color = "green"
@@ -316,9 +353,10 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def sort_ratio_list(ratio_list, changes_only=False, insignificant_list=()):
     """
-    Return 3 sorted list improvement, regression and normal.
+    Return 3 sorted list improvement, regression and normal. Changes in
+    `insignificant_list` count as normal.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -326,7 +364,9 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        if key in insignificant_list:
+            normal_perf_list[key] = v
+        elif ratio_list[key] < RATIO_MIN:
             decreased_perf_list.append(key)
         elif ratio_list[key] > RATIO_MAX:
             increased_perf_list.append(key)
@@ -347,6 +387,51 @@ def sort_ratio_list(ratio_list, changes_only=False):
             decreased_perf_list, sorted_normal_perf_list)
 
 
+def parse_values(row):
+    """
+    Return the samples of a result row, which Benchmark_Driver logs separated
+    by semicolons after the other columns. Rows without them have no samples.
+    """
+    if len(row) <= VALUES:
+        return []
+    return [int(v) for v in row[VALUES].split(';') if v.isdigit()]
+
+
+def mann_whitney_p_value(xs, ys):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test of whether the
+    samples `xs` and `ys` come from the same distribution. This uses the
+    normal approximation with a correction for ties, which is accurate enough
+    for the tens of samples a benchmark run takes.
+    """
+    n1 = len(xs)
+    n2 = len(ys)
+    n = n1 + n2
+    combined = sorted([(v, 0) for v in xs] + [(v, 1) for v in ys])
+
+    # Tied values get the mean of the ranks they span.
+    rank_sum = 0.0
+    tie_term = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j < n and combined[j][0] == combined[i][0]:
+            j += 1
+        rank = (i + 1 + j) / 2.0
+        rank_sum += rank * sum(1 for k in range(i, j) if combined[k][1] == 0)
+        ties = j - i
+        tie_term += ties ** 3 - ties
+        i = j
+
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = max(abs(u - mean) - 0.5, 0) / math.sqrt(variance)
+    return math.erfc(z / math.sqrt(2))
+
+
 def max_width(items, title, key_len=False):
     """
     Returns the max length of string in the list
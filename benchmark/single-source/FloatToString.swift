@@ -0,0 +1,37 @@
+//===--- FloatToString.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks performance of Float and Double to String conversion,
+// as used when logging or serializing numbers.
+import TestsUtils
+
+@inline(never)
+public func run_FloatToString(_ N: Int) {
+  let doubles: [Double] = [0.1, 1.5, -2.25, 3.14159, 100.0, 1e-5, 6.02e23,
+                           -0.000123, 123456.789, 1.0 / 3.0, 2.718281828,
+                           42.0, 9.99, -7.5e-10, 65536.0, 0.3]
+  let floats: [Float] = [0.1, 1.5, -2.25, 3.14159, 100.0, 1e-5, 6.02e23,
+                         -0.000123, 123456.8, 0.33333334, 2.7182817,
+                         42.0, 9.99, -7.5e-10, 65536.0, 0.3]
+  var length = 0
+  for _ in 1...1000*N {
+    for d in doubles {
+      length += d.description.utf8.count
+    }
+    for f in floats {
+      length += f.description.utf8.count
+    }
+  }
+  CheckResults(length > 0, "IncorrectResults in FloatToString: \(length)")
+  CheckResults(1.5.description == "1.5",
+               "IncorrectResults in FloatToString: \(1.5.description)")
+}
@@ -0,0 +1,150 @@
+//===--- ThreadScaling.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests run the same workload on every thread at once, to check how
+// the runtime paths that threads share scale: reference counting of shared
+// objects, allocation, generic metadata instantiation and dynamic casts.
+// Every thread does the work of one iteration, so with perfect scaling a
+// sample takes as long on N threads as on one. Run the driver with
+// --num-threads to measure them on several thread counts.
+import TestsUtils
+
+protocol Valued {
+  func getValue() -> Int
+}
+
+final class SharedValue : Valued {
+  func getValue() -> Int { return 1 }
+}
+
+// All threads retain and release this object.
+let sharedValue: Valued = SharedValue()
+
+@inline(never)
+func getValue(_ v: Valued) -> Int {
+  return v.getValue()
+}
+
+@inline(never)
+public func run_ThreadScalingProtocolDispatch(_ N: Int) {
+  runOnThreads { _ in
+    var sum = 0
+    for _ in 0..<100000 * N {
+      sum += getValue(sharedValue)
+    }
+    CheckResults(sum == 100000 * N,
+                 "Incorrect results in ThreadScalingProtocolDispatch")
+  }
+}
+
+final class Node {
+  let value: Int
+  let next: Node?
+
+  init(_ value: Int, _ next: Node?) {
+    self.value = value
+    self.next = next
+  }
+}
+
+@inline(never)
+func sumList(_ n: Node) -> Int {
+  var sum = 0
+  var iter: Node? = n
+  while let node = iter {
+    sum += node.value
+    iter = node.next
+  }
+  return sum
+}
+
+@inline(never)
+public func run_ThreadScalingObjectAllocation(_ N: Int) {
+  runOnThreads { _ in
+    var sum = 0
+    for _ in 0..<N {
+      for i in 0..<1000 {
+        sum += sumList(Node(i, Node(1, Node(2, nil))))
+      }
+    }
+    CheckResults(sum == 502500 * N,
+                 "Incorrect results in ThreadScalingObjectAllocation")
+  }
+}
+
+protocol ArrayMaker {
+  func makeArray() -> Any
+}
+
+extension ArrayMaker {
+  // Called through the protocol, this runs unspecialized and has to look up
+  // the metadata of Array<Self> in the runtime.
+  func makeArray() -> Any {
+    return [self, self]
+  }
+}
+
+struct S1 : ArrayMaker { var x = 1 }
+struct S2 : ArrayMaker { var x = 1.0 }
+struct S3 : ArrayMaker { var x = "" }
+struct S4 : ArrayMaker { var x: [Int] = [] }
+
+let makers: [ArrayMaker] = [S1(), S2(), S3(), S4()]
+
+@inline(never)
+func makeArray(_ m: ArrayMaker) -> Any {
+  return m.makeArray()
+}
+
+@inline(never)
+public func run_ThreadScalingGenericArray(_ N: Int) {
+  runOnThreads { _ in
+    var count = 0
+    for _ in 0..<2500 * N {
+      for m in makers {
+        if let a = makeArray(m) as? [S1] {
+          count += a.count
+        }
+      }
+    }
+    CheckResults(count == 2 * 2500 * N,
+                 "Incorrect results in ThreadScalingGenericArray")
+  }
+}
+
+struct Plain {}
+struct Described : CustomStringConvertible {
+  var description: String { return "" }
+}
+
+let castValues: [Any] = [1, "", 1.0, Plain(), Described(), [1], SharedValue()]
+
+@inline(never)
+func isDescribed(_ x: Any) -> Bool {
+  return x is CustomStringConvertible
+}
+
+@inline(never)
+public func run_ThreadScalingCast(_ N: Int) {
+  runOnThreads { _ in
+    var count = 0
+    for _ in 0..<2500 * N {
+      for v in castValues {
+        if isDescribed(v) {
+          count += 1
+        }
+      }
+    }
+    CheckResults(count == 2500 * N * 5,
+                 "Incorrect results in ThreadScalingCast")
+  }
+}
@@ -15,15 +15,19 @@ import Darwin
 struct BenchResults {
   var delim: String  = ","
   var sampleCount: UInt64 = 0
+  var samples = [UInt64]()
+  /// The samples of each of the SampleCounters, if they were collected.
+  var counterSamples = [[UInt64]]()
   var min: UInt64 = 0
   var max: UInt64 = 0
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
   init() {}
-  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
+  init(delim: String, samples: [UInt64], min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
     self.delim = delim
-    self.sampleCount = sampleCount
+    self.sampleCount = UInt64(samples.count)
+    self.samples = samples
     self.min = min
     self.max = max
     self.mean = mean
@@ -39,6 +43,63 @@ struct BenchResults {
   }
 }
 
+/// The resource usage and runtime events at one point in time.
+struct CounterSnapshot {
+  var usage = rusage()
+  var runtime = [UInt64]()
+
+  static func now() -> CounterSnapshot {
+    var snapshot = CounterSnapshot()
+    getrusage(RUSAGE_SELF, &snapshot.usage)
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+    snapshot.runtime = [UInt64](repeating: 0, count: runtimeCounterNames.count)
+    _ = readRuntimeCounters(&snapshot.runtime, runtimeCounterNames.count)
+#endif
+    return snapshot
+  }
+}
+
+/// The resource usage of a sample, normalized by its number of iterations.
+/// Times are in microseconds per iteration, like the samples themselves,
+/// page faults and context switches are per thousand iterations, and runtime
+/// events are per iteration.
+struct SampleCounters {
+  static var names: [String] {
+    var names = ["UserTime", "SystemTime", "MinorFaults", "MajorFaults",
+                 "VoluntarySwitches", "InvoluntarySwitches"]
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+    names += runtimeCounterNames
+#endif
+    return names
+  }
+
+  var values: [UInt64]
+
+  init(from start: CounterSnapshot, to end: CounterSnapshot,
+       iterations: UInt) {
+    func micros(_ t: timeval) -> UInt64 {
+      return UInt64(t.tv_sec) * 1_000_000 + UInt64(t.tv_usec)
+    }
+    func perIteration(_ start: UInt64, _ end: UInt64) -> UInt64 {
+      return end > start ? (end - start) / UInt64(iterations) : 0
+    }
+    func perKiloIteration(_ start: Int, _ end: Int) -> UInt64 {
+      return end > start ? UInt64(end - start) * 1000 / UInt64(iterations) : 0
+    }
+    values = [
+      perIteration(micros(start.usage.ru_utime), micros(end.usage.ru_utime)),
+      perIteration(micros(start.usage.ru_stime), micros(end.usage.ru_stime)),
+      perKiloIteration(start.usage.ru_minflt, end.usage.ru_minflt),
+      perKiloIteration(start.usage.ru_majflt, end.usage.ru_majflt),
+      perKiloIteration(start.usage.ru_nvcsw, end.usage.ru_nvcsw),
+      perKiloIteration(start.usage.ru_nivcsw, end.usage.ru_nivcsw),
+    ]
+    for (s, e) in zip(start.runtime, end.runtime) {
+      values.append(perIteration(s, e))
+    }
+  }
+}
+
 extension BenchResults : CustomStringConvertible {
   var description: String {
      return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
@@ -88,6 +149,17 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// The time in milliseconds that each sample should run for, before the
+  /// iteration scale is applied. The number of iterations of a test is
+  /// calibrated once to this, and then used for all of its samples.
+  var sampleTime: UInt64 = 1000
+
+  /// Should the time of each sample be printed after the results of a test?
+  var printSamples: Bool = false
+
+  /// Should the resource usage counters of the tests be reported?
+  var counters: Bool = false
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -98,12 +170,16 @@ struct TestConfig {
   /// like leaks that require a PID to run on the test harness.
   var afterRunSleep: Int? = nil
 
+  /// The thread counts to also measure multithreaded tests at.
+  var threadCounts = [Int]()
+
   /// The list of tests to run.
   var tests = [Test]()
 
   mutating func processArguments() -> TestAction {
     let validOptions=["--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"]
+      "--verbose", "--delim", "--run-all", "--list", "--sleep",
+      "--num-threads", "--sample-time", "--print-samples", "--counters"]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
       return .Fail("Failed to parse arguments")
@@ -129,6 +205,21 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--sample-time"] {
+      guard let v = UInt64(x) where v > 0 else {
+        return .Fail("--sample-time requires a positive integer value")
+      }
+      sampleTime = v
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--print-samples"] {
+      printSamples = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--counters"] {
+      counters = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -154,6 +245,18 @@ struct TestConfig {
       afterRunSleep = v!
     }
 
+    if let x = benchArgs.optionalArgsMap["--num-threads"] {
+      for count in x.characters.split(separator: ",") {
+        guard let v = Int(String(count)) where v > 0 else {
+          return .Fail("--num-threads requires a list of thread counts")
+        }
+        threadCounts.append(v)
+      }
+      if threadCounts.isEmpty {
+        return .Fail("--num-threads requires a list of thread counts")
+      }
+    }
+
     filters = benchArgs.positionalArgs
 
     return .Run
@@ -224,12 +327,38 @@ func stopTrackingObjects(_: UnsafeMutablePointer<Void>) -> Int
 
 #endif
 
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+
+/// The events the runtime counts, in the order it reports them.
+let runtimeCounterNames = ["Retains", "Releases", "Allocations",
+                           "AllocatedBytes", "MetadataInstantiations",
+                           "ConformanceLookups"]
+
+@_silgen_name("swift_runtimeCounters_read")
+func readRuntimeCounters(_: UnsafeMutablePointer<UInt64>, _: Int) -> Int
+
+#endif
+
+// Implemented in TestsUtils.
+@_silgen_name("swift_benchmark_setNumThreads")
+func setNumThreads(_: Int)
+@_silgen_name("swift_benchmark_takeRanOnThreads")
+func takeRanOnThreads() -> Bool
+
 class SampleRunner {
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
   init() {
     mach_timebase_info(&info)
   }
-  func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
+  /// The resource usage of the last run, if counters were requested.
+  var counters: SampleCounters? = nil
+
+  func run(_ name: String, fn: (Int) -> Void, num_iters: UInt,
+           counters wantCounters: Bool = false) -> UInt64 {
+    var start_counters = CounterSnapshot()
+    if wantCounters {
+      start_counters = CounterSnapshot.now()
+    }
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     var str = name
@@ -242,6 +371,10 @@ class SampleRunner {
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     stopTrackingObjects(UnsafeMutablePointer<Void>(str._core.startASCII))
 #endif
+    if wantCounters {
+      counters = SampleCounters(from: start_counters, to: CounterSnapshot.now(),
+                                iterations: num_iters)
+    }
 
     // Compute the spent time and the scaling factor.
     let elapsed_ticks = end_ticks - start_ticks
@@ -259,30 +392,45 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
   }
 
   let sampler = SampleRunner()
-  for s in 0..<c.numSamples {
-    let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
+  let time_per_sample: UInt64 =
+    c.sampleTime * 1_000_000 * UInt64(c.iterationScale)
+
+  // Compute the scaling factor once if a fixed c.fixedNumIters is not
+  // specified, so that all samples measure the same amount of work. The
+  // first run warms up caches and lazily initialized globals, and the faster
+  // of the next two is the least disturbed.
+  var scale : UInt
+  if c.fixedNumIters == 0 {
+    _ = sampler.run(name, fn: fn, num_iters: 1)
+    let elapsed_time = min(sampler.run(name, fn: fn, num_iters: 1),
+                           sampler.run(name, fn: fn, num_iters: 1))
+    scale = UInt(time_per_sample / max(elapsed_time, 1))
+  } else {
+    scale = c.fixedNumIters
+  }
+  if scale < 1 {
+    scale = 1
+  }
+  if c.verbose {
+    print("    Measuring with scale \(scale).")
+  }
 
-    var scale : UInt
-    var elapsed_time : UInt64 = 0
-    if c.fixedNumIters == 0 {
-      elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
-      scale = UInt(time_per_sample / elapsed_time)
-    } else {
-      // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
-      scale = c.fixedNumIters
-    }
+  var counterSamples = [[UInt64]]()
+  if c.counters {
+    counterSamples = [[UInt64]](repeating: [],
+                                count: SampleCounters.names.count)
+  }
 
-    // Rerun the test with the computed scale factor.
-    if scale > 1 {
-      if c.verbose {
-        print("    Measuring with scale \(scale).")
-      }
-      elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
-    } else {
-      scale = 1
-    }
+  for s in 0..<c.numSamples {
+    let elapsed_time = sampler.run(name, fn: fn, num_iters: scale,
+                                   counters: c.counters)
     // save result in microseconds or k-ticks
     samples[s] = elapsed_time / UInt64(scale) / 1000
+    if let counters = sampler.counters {
+      for (i, value) in counters.values.enumerated() {
+        counterSamples[i].append(value)
+      }
+    }
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
@@ -291,9 +439,12 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
   let (mean, sd) = internalMeanSD(samples)
 
   // Return our benchmark results.
-  return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
-                      min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+  var results = BenchResults(delim: c.delim, samples: samples,
+                             min: samples.min()!, max: samples.max()!,
+                             mean: mean, sd: sd,
+                             median: internalMedian(samples))
+  results.counterSamples = counterSamples
+  return results
 }
 
 func printRunInfo(_ c: TestConfig) {
@@ -302,9 +453,13 @@ func printRunInfo(_ c: TestConfig) {
     print("NumSamples: \(c.numSamples)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
+    print("SampleTime: \(c.sampleTime)")
     if c.fixedNumIters != 0 {
       print("FixedIters: \(c.fixedNumIters)")
     }
+    if !c.threadCounts.isEmpty {
+      print("NumThreads: \(c.threadCounts)")
+    }
     print("Tests Filter: \(c.filters)")
     print("Tests to run: ", terminator: "")
     for t in c.tests {
@@ -323,6 +478,8 @@ func runBenchmarks(_ c: TestConfig) {
   print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
+  var ScalingResults = [(Test, Int, UInt64, BenchResults)]()
+  var CounterResults = [(Test, BenchResults)]()
 
   for t in c.tests {
     if !t.run {
@@ -331,10 +488,34 @@ func runBenchmarks(_ c: TestConfig) {
     let BenchIndex = t.index
     let BenchName = t.name
     let BenchFunc = t.f
+    setNumThreads(1)
+    _ = takeRanOnThreads()
     let results = runBench(BenchName, BenchFunc, c)
-    print("\(BenchIndex)\(c.delim)\(BenchName)\(c.delim)\(results.description)")
+    if c.printSamples {
+      // The samples follow the usual columns, so that tools which only know
+      // about those can still read the line.
+      let samples = results.samples.map { "\(c.delim)\($0)" }.joined()
+      print("\(BenchIndex)\(c.delim)\(BenchName)\(c.delim)\(results.description)\(samples)")
+    } else {
+      print("\(BenchIndex)\(c.delim)\(BenchName)\(c.delim)\(results.description)")
+    }
     fflush(stdout)
 
+    if c.counters {
+      CounterResults.append((t, results))
+    }
+
+    // Measure tests that spread their work across threads again with each
+    // of the requested thread counts.
+    if takeRanOnThreads() {
+      for count in c.threadCounts {
+        setNumThreads(count)
+        let scaled = count == 1 ? results : runBench(BenchName, BenchFunc, c)
+        ScalingResults.append((t, count, results.mean, scaled))
+      }
+      setNumThreads(1)
+    }
+
     SumBenchResults.min += results.min
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
@@ -347,6 +528,52 @@ func runBenchmarks(_ c: TestConfig) {
 
   print("")
   print("Totals\(c.delim)\(SumBenchResults.description)")
+
+  if !CounterResults.isEmpty {
+    printCounterResults(CounterResults, c)
+  }
+
+  if !ScalingResults.isEmpty {
+    printScalingResults(ScalingResults, c)
+  }
+}
+
+/// Print the resource usage counters of each test in the same format as its
+/// time, as one row per counter named `<test>_<counter>`, so that the tools
+/// which compare results treat each counter as a test of its own.
+func printCounterResults(_ results: [(Test, BenchResults)], _ c: TestConfig) {
+  print("")
+  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN\(c.delim)MAX\(c.delim)MEAN\(c.delim)SD\(c.delim)MEDIAN")
+  for (t, r) in results {
+    for (name, samples) in zip(SampleCounters.names, r.counterSamples) {
+      let (mean, sd) = internalMeanSD(samples)
+      let counter = BenchResults(delim: c.delim, samples: samples,
+                                 min: samples.min()!, max: samples.max()!,
+                                 mean: mean, sd: sd,
+                                 median: internalMedian(samples))
+      let values = c.printSamples ? samples.map { "\(c.delim)\($0)" }.joined() : ""
+      print("\(t.index)\(c.delim)\(t.name)_\(name)\(c.delim)\(counter.description)\(values)")
+    }
+  }
+  fflush(stdout)
+}
+
+/// Print the throughput of each thread of the multithreaded tests, and how
+/// close they come to scaling perfectly. Every thread of a multithreaded
+/// test does the work of one iteration, so the efficiency is the
+/// single-threaded time as a percentage of the time on the given number of
+/// threads.
+func printScalingResults(_ results: [(Test, Int, UInt64, BenchResults)],
+                         _ c: TestConfig) {
+  print("")
+  print("#\(c.delim)TEST\(c.delim)THREADS\(c.delim)MEAN(us)\(c.delim)RUNS/S/THREAD\(c.delim)EFFICIENCY(%)")
+  for (t, count, singleThreadMean, r) in results {
+    let mean = max(r.mean, 1)
+    let throughput = 1_000_000 / mean
+    let efficiency = max(singleThreadMean, 1) * 100 / mean
+    print("\(t.index)\(c.delim)\(t.name)\(c.delim)\(count)\(c.delim)\(r.mean)\(c.delim)\(throughput)\(c.delim)\(efficiency)")
+  }
+  fflush(stdout)
 }
 
 public func main() {
@@ -63,3 +63,60 @@ struct MyStruct : SomeProtocol {
 }
 public func someProtocolFactory() -> SomeProtocol { return MyStruct() }
 
+
+/// The number of threads `runOnThreads` runs a workload on. The driver sets
+/// it for each measurement of a multithreaded benchmark.
+var NumThreads = 1
+
+/// Whether a benchmark called `runOnThreads` since the driver last asked.
+var RanOnThreads = false
+
+// The driver is built before this module, so it calls these by name.
+@_silgen_name("swift_benchmark_setNumThreads")
+public func _setNumThreads(_ n: Int) {
+  NumThreads = n
+}
+
+@_silgen_name("swift_benchmark_takeRanOnThreads")
+public func _takeRanOnThreads() -> Bool {
+  let result = RanOnThreads
+  RanOnThreads = false
+  return result
+}
+
+final class ThreadContext {
+  let body: (Int) -> ()
+  let index: Int
+
+  init(_ body: (Int) -> (), _ index: Int) {
+    self.body = body
+    self.index = index
+  }
+}
+
+/// Run `body` on `NumThreads` threads at once, passing each thread its
+/// index, and return once all of them are done. The calling thread runs the
+/// body with index 0.
+public func runOnThreads(_ body: (Int) -> ()) {
+  RanOnThreads = true
+
+  var threads = [pthread_t]()
+  for i in 1..<max(NumThreads, 1) {
+    // The thread takes over the reference to its context.
+    let context = Unmanaged.passRetained(ThreadContext(body, i)).toOpaque()
+    var thread: pthread_t? = nil
+    let result = pthread_create(&thread, nil, { context in
+      let c = Unmanaged<ThreadContext>.fromOpaque(context!).takeRetainedValue()
+      c.body(c.index)
+      return nil
+    }, context)
+    CheckResults(result == 0, "Failed to create a thread")
+    threads.append(thread!)
+  }
+
+  body(0)
+
+  for thread in threads {
+    pthread_join(thread, nil)
+  }
+}
@@ -22,6 +22,10 @@
 #
 #   Totals,2,2123,2123,2123,0,0
 #
+# The resource usage counters that the drivers report with --counters are
+# rows named <test>_<counter>, and become tests of their own, like
+# "2Sum_UserTime".
+#
 # Output for this input:
 # {
 #     "Machine": {},
@@ -47,13 +47,18 @@ import DictionaryRemove
 import DictionarySwap
 import ErrorHandling
 import Fibonacci
+import FloatToString
+import GenericPipeline
 import GlobalClass
 import Hanoi
 import Hash
 import Histogram
 import Integrate
+import JSON
 import Join
+import LargeCollections
 import LinkedList
+import LogParser
 import MapReduce
 import Memset
 import MonteCarloE
@@ -92,6 +97,7 @@ import StringInterpolation
 import StringTests
 import StringWalk
 import SuperChars
+import ThreadScaling
 import TwoSum
 import TypeFlood
 import UTF8Decode
@@ -134,13 +140,22 @@ precommitTests = [
   "DictionarySwap": run_DictionarySwap,
   "DictionarySwapOfObjects": run_DictionarySwapOfObjects,
   "ErrorHandling": run_ErrorHandling,
+  "ExistentialPipeline": run_ExistentialPipeline,
+  "FloatToString": run_FloatToString,
+  "GenericPipeline": run_GenericPipeline,
   "GlobalClass": run_GlobalClass,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
   "Histogram": run_Histogram,
   "Integrate": run_Integrate,
+  "JSONDecode": run_JSONDecode,
+  "JSONEncode": run_JSONEncode,
   "Join": run_Join,
+  "LargeDictionary": run_LargeDictionary,
+  "LargeDictionaryOfStrings": run_LargeDictionaryOfStrings,
+  "LargeSet": run_LargeSet,
   "LinkedList": run_LinkedList,
+  "LogParse": run_LogParse,
   "MapReduce": run_MapReduce,
   "Memset": run_Memset,
   "MonteCarloE": run_MonteCarloE,
@@ -214,6 +229,10 @@ precommitTests = [
   "StringWalk": run_StringWalk,
   "StringWithCString": run_StringWithCString,
   "SuperChars": run_SuperChars,
+  "ThreadScalingCast": run_ThreadScalingCast,
+  "ThreadScalingGenericArray": run_ThreadScalingGenericArray,
+  "ThreadScalingObjectAllocation": run_ThreadScalingObjectAllocation,
+  "ThreadScalingProtocolDispatch": run_ThreadScalingProtocolDispatch,
   "TwoSum": run_TwoSum,
   "TypeFlood": run_TypeFlood,
   "UTF8Decode": run_UTF8Decode,
@@ -106,6 +106,10 @@ enum : unsigned {
   /// Number of words reserved in generic metadata patterns.
   NumGenericMetadataPrivateDataWords = 16,
 };
+
+/// The tag set on a reference to a LazyWitnessTableBase stored in a base
+/// protocol slot of a witness table, distinguishing it from a witness table.
+const uintptr_t LazyWitnessTableBaseTag = 1;
   
 /// Kinds of type metadata/protocol conformance records.
 enum class TypeMetadataRecordKind : unsigned {
@@ -102,6 +102,23 @@ enum class AllocationArena {
   ConstraintSolver
 };
 
+/// The kinds of AST node whose allocations the ASTContext counts, for
+/// \c ASTContext::printMemoryUsage.
+enum class ASTNodeAllocationKind : unsigned {
+  Decl,
+  /// A declaration imported from Clang, along with its ClangNode.
+  ClangDecl,
+  Expr,
+  Stmt,
+  Pattern,
+  TypeRepr,
+  Type,
+  Conformance,
+};
+enum : unsigned {
+  NumASTNodeAllocationKinds = unsigned(ASTNodeAllocationKind::Conformance) + 1
+};
+
 /// Lists the set of "known" Foundation entities that are used in the
 /// compiler.
 ///
@@ -226,6 +243,27 @@ public:
   /// A consumer of type checker debug output.
   std::unique_ptr<TypeCheckerDebugConsumer> TypeCheckerDebug;
 
+  /// What type-checking one expression with the constraint solver cost.
+  struct SolverProfileEntry {
+    SourceRange Range;
+    /// The wall time, in seconds, including any expressions checked on the
+    /// way to diagnosing this one.
+    double WallTime = 0;
+    /// The part of the wall time spent ranking solutions, in seconds.
+    double RankingTime = 0;
+    /// The constraint solver's memory use once the expression was checked.
+    size_t PeakSolverMemory = 0;
+    unsigned NumStatesExplored = 0;
+    unsigned NumDisjunctions = 0;
+    unsigned NumDisjunctionTerms = 0;
+    unsigned NumComponentsSplit = 0;
+    unsigned NumSolutionsCompared = 0;
+  };
+
+  /// If non-null, the type checker adds an entry to this for each expression
+  /// it solves constraints for.
+  std::vector<SolverProfileEntry> *SolverProfile = nullptr;
+
   /// Cache for names of canonical GenericTypeParamTypes.
   mutable llvm::DenseMap<unsigned, Identifier>
     CanonicalGenericTypeParamTypeNames;
@@ -774,12 +812,37 @@ public:
   /// Take the conformance loader and context data for the given declaration.
   std::pair<LazyMemberLoader *, uint64_t> takeConformanceLoader(Decl *decl);
 
+  /// Returns the USR recorded for \p D by \c cacheUSR, or an empty string if
+  /// there isn't one.
+  StringRef getCachedUSR(const ValueDecl *D) const;
+
+  /// Records the USR of \p D, so that it only has to be mangled once.
+  void cacheUSR(const ValueDecl *D, StringRef USR);
+
   /// \brief Returns memory usage of this ASTContext.
   size_t getTotalMemory() const;
   
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// Note that \p bytes were allocated in \p arena for an AST node of the
+  /// given kind.
+  void recordNodeAllocation(ASTNodeAllocationKind kind, size_t bytes,
+                            AllocationArena arena
+                              = AllocationArena::Permanent) const;
+
+  /// Note that \p bytes were allocated for a declaration.
+  void recordDeclAllocation(size_t bytes, bool fromClang) const {
+    recordNodeAllocation(fromClang ? ASTNodeAllocationKind::ClangDecl
+                                   : ASTNodeAllocationKind::Decl,
+                         bytes);
+  }
+
+  /// Prints the memory used by the AST so far: the bytes allocated in each
+  /// arena, the bytes and number of each kind of node allocated, and the
+  /// sizes of the uniquing tables.
+  void printMemoryUsage(llvm::raw_ostream &os) const;
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
@@ -843,10 +906,11 @@ public:
                                                 ModuleDecl *mod);
 
   /// Set the stored archetype builder for the given canonical generic
-  /// signature and module.
+  /// signature and module, unless there is one already, to a builder from
+  /// getOrCreateArchetypeBuilder for an equivalent signature.
   void setArchetypeBuilder(CanGenericSignature sig,
                            ModuleDecl *mod,
-                           std::unique_ptr<ArchetypeBuilder> builder);
+                           ArchetypeBuilder *builder);
 
   /// Retrieve the inherited name set for the given class.
   const InheritedNameSet *getAllPropertyNames(ClassDecl *classDecl,
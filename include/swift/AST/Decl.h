@@ -842,6 +842,7 @@ void *allocateMemoryForDecl(AllocatorTy &allocator, size_t baseSize,
     size += alignof(DeclTy);
 
   void *mem = allocator.Allocate(size, alignof(DeclTy));
+  allocator.recordDeclAllocation(size, includeSpaceForClangNode);
   if (includeSpaceForClangNode)
     mem = reinterpret_cast<char *>(mem) + alignof(DeclTy);
   return mem;
@@ -21,6 +21,7 @@
 #include "swift/AST/TypeLoc.h"
 #include "swift/AST/DeclNameLoc.h"
 #include "swift/Basic/DiagnosticConsumer.h"
+#include "llvm/ADT/STLExtras.h"
 
 namespace swift {
   class Decl;
@@ -417,6 +418,9 @@ namespace swift {
     /// \brief Track settable, per-diagnostic state that we store
     std::vector<Behavior> perDiagnosticBehavior;
 
+    /// \brief How often each diagnostic was emitted and ignored
+    std::vector<std::pair<unsigned, unsigned>> perDiagnosticCounts;
+
   public:
     DiagnosticState();
 
@@ -424,6 +428,18 @@ namespace swift {
     /// state such as fatality into account.
     Behavior determineBehavior(DiagID id);
 
+    /// \brief Whether the given diagnostic would be ignored if it was emitted
+    /// now. Unlike determineBehavior, this does not change the state.
+    bool wouldIgnore(DiagID id) const {
+      return computeBehavior(id) == Behavior::Ignore;
+    }
+
+    /// \brief The number of times the given diagnostic was emitted and
+    /// ignored, in that order.
+    std::pair<unsigned, unsigned> getDiagnosticCounts(DiagID id) const {
+      return perDiagnosticCounts[(unsigned)id];
+    }
+
     bool hadAnyError() const { return anyErrorOccurred; }
     bool hasFatalErrorOccurred() const { return fatalErrorOccurred; }
 
@@ -450,6 +466,8 @@ namespace swift {
     }
 
   private:
+    Behavior computeBehavior(DiagID id) const;
+
     // Make the state movable only
     DiagnosticState(const DiagnosticState &) = delete;
     const DiagnosticState &operator=(const DiagnosticState &) = delete;
@@ -526,6 +544,13 @@ namespace swift {
       state.resetHadAnyError();
     }
 
+    /// \brief Call \p fn with the name of each diagnostic which was
+    /// diagnosed at least once, the number of times it was emitted and the
+    /// number of times it was ignored.
+    void forEachDiagnosticCount(
+        llvm::function_ref<void(StringRef name, unsigned emitted,
+                                unsigned ignored)> fn) const;
+
     /// \brief Add an additional DiagnosticConsumer to receive diagnostics.
     void addConsumer(DiagnosticConsumer &Consumer) {
       Consumers.push_back(&Consumer);
@@ -555,6 +580,8 @@ namespace swift {
     InFlightDiagnostic diagnose(SourceLoc Loc, DiagID ID, 
                                 ArrayRef<DiagnosticArgument> Args) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(ID))
+        return InFlightDiagnostic();
       ActiveDiagnostic = Diagnostic(ID, Args);
       ActiveDiagnostic->setLoc(Loc);
       return InFlightDiagnostic(*this);
@@ -589,6 +616,8 @@ namespace swift {
     /// be attached.
     InFlightDiagnostic diagnose(SourceLoc Loc, const Diagnostic &D) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(D.getID()))
+        return InFlightDiagnostic();
       ActiveDiagnostic = D;
       ActiveDiagnostic->setLoc(Loc);
       return InFlightDiagnostic(*this);
@@ -608,6 +637,8 @@ namespace swift {
     diagnose(SourceLoc Loc, Diag<ArgTypes...> ID,
              typename detail::PassArgument<ArgTypes>::type... Args) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(ID.ID))
+        return InFlightDiagnostic();
       ActiveDiagnostic = Diagnostic(ID, std::move(Args)...);
       ActiveDiagnostic->setLoc(Loc);
       return InFlightDiagnostic(*this);
@@ -627,6 +658,8 @@ namespace swift {
     diagnose(DeclNameLoc Loc, Diag<ArgTypes...> ID,
              typename detail::PassArgument<ArgTypes>::type... Args) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(ID.ID))
+        return InFlightDiagnostic();
       ActiveDiagnostic = Diagnostic(ID, std::move(Args)...);
       ActiveDiagnostic->setLoc(Loc.getBaseNameLoc());
       return InFlightDiagnostic(*this);
@@ -648,6 +681,8 @@ namespace swift {
     InFlightDiagnostic diagnose(const Decl *decl, DiagID id,
                                 ArrayRef<DiagnosticArgument> args) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(id))
+        return InFlightDiagnostic();
       ActiveDiagnostic = Diagnostic(id, args);
       ActiveDiagnostic->setDecl(decl);
       return InFlightDiagnostic(*this);
@@ -665,6 +700,8 @@ namespace swift {
     /// be attached.
     InFlightDiagnostic diagnose(const Decl *decl, const Diagnostic &diag) {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
+      if (ignoreBeforeEmission(diag.getID()))
+        return InFlightDiagnostic();
       ActiveDiagnostic = diag;
       ActiveDiagnostic->setDecl(decl);
       return InFlightDiagnostic(*this);
@@ -683,6 +720,8 @@ namespace swift {
     InFlightDiagnostic
     diagnose(const Decl *decl, Diag<ArgTypes...> id,
              typename detail::PassArgument<ArgTypes>::type... args) {
+      if (ignoreBeforeEmission(id.ID))
+        return InFlightDiagnostic();
       ActiveDiagnostic = Diagnostic(id, std::move(args)...);
       ActiveDiagnostic->setDecl(decl);
       return InFlightDiagnostic(*this);
@@ -693,6 +732,20 @@ namespace swift {
     bool isDiagnosticPointsToFirstBadToken(DiagID id) const;
 
   private:
+    /// \brief Check whether a diagnostic is going to be ignored before its
+    /// arguments are captured, e.g. a warning with -suppress-warnings. If so,
+    /// the diagnostic is handled as if it was emitted and ignored.
+    ///
+    /// Diagnostics in an open transaction are only emitted when it closes,
+    /// and the state may have changed by then, so they are never ignored
+    /// early.
+    bool ignoreBeforeEmission(DiagID id) {
+      if (TransactionCount != 0 || !state.wouldIgnore(id))
+        return false;
+      (void)state.determineBehavior(id);
+      return true;
+    }
+
     /// \brief Flush the active diagnostic.
     void flushActiveDiagnostic();
     
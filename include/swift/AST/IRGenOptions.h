@@ -120,10 +120,21 @@ public:
   /// (includes alloc_stack allocations).
   unsigned StackPromotionSizeLimit = 1024;
 
+  /// Copies and destroys of loadable structs, tuples and enums with at least
+  /// this many non-trivial fields (or payload cases) call a helper function
+  /// shared by all uses of the type, instead of being emitted inline.
+  /// Zero disables the outlining.
+  unsigned OutlineValueOperationsLimit = 0;
+
   /// Emit code to verify that static and runtime type layout are consistent for
   /// the given type names.
   SmallVector<StringRef, 1> VerifyTypeLayoutNames;
 
+  /// Generic type instantiations, spelled like 'Array<Int>', whose metadata
+  /// should be built at compile time and registered with the runtime's
+  /// metadata caches when the image is loaded.
+  SmallVector<StringRef, 1> PrespecializedGenericMetadataNames;
+
   /// Frameworks that we should not autolink against.
   SmallVector<std::string, 1> DisableAutolinkFrameworks;
 
@@ -156,6 +167,21 @@ public:
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Derive dependent base protocol witness tables the first time they are
+  /// used rather than when their conformance's witness table is
+  /// instantiated. This changes how base protocol witness tables are read,
+  /// so all code using the affected conformances must agree on it.
+  unsigned LazyWitnessTableBases : 1;
+
+  /// Lay out the stored properties of structs which are not visible outside
+  /// of the module in an order which minimizes padding.
+  unsigned ReorderStructFields : 1;
+
+  /// Discard the bodies of the SIL functions once they have been emitted as
+  /// LLVM IR, so that their memory is free for the LLVM passes. The SIL module
+  /// must not be needed after IR generation.
+  unsigned ReleaseSILBodies : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -170,7 +196,8 @@ public:
                    HasValueNamesSetting(false), ValueNames(false),
                    EnableReflectionMetadata(true), EnableReflectionNames(true),
                    UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
-                   CmdArgs()
+                   LazyWitnessTableBases(false), ReorderStructFields(false),
+                   ReleaseSILBodies(false), CmdArgs()
                    {}
 
   /// Gets the name of the specified output filename.
@@ -189,6 +189,19 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates \p Members with the members of \p D whose base name is
+  /// \p Name, without loading any other members.
+  ///
+  /// The implementation should \em not add the members to \p D.
+  ///
+  /// \returns false if the members can't be looked up by name, in which case
+  /// the caller has to load all members.
+  virtual bool
+  loadNamedMembers(const Decl *D, Identifier Name, uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &Members) {
+    return false;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -198,10 +211,17 @@ public:
     llvm_unreachable("unimplemented");
   }
 
-  /// Populates the given vector with all conformances for \p D.
+  /// Sets the type witnesses of \p conformance.
+  virtual void
+  finishNormalConformanceTypeWitnesses(NormalProtocolConformance *conformance,
+                                       uint64_t contextData) {
+    llvm_unreachable("unimplemented");
+  }
+
+  /// Sets the value witnesses of \p conformance.
   virtual void
-  finishNormalConformance(NormalProtocolConformance *conformance,
-                          uint64_t contextData) {
+  finishNormalConformanceValueWitnesses(NormalProtocolConformance *conformance,
+                                        uint64_t contextData) {
     llvm_unreachable("unimplemented");
   }
 
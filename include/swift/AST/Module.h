@@ -76,6 +76,7 @@ namespace swift {
   class ValueDecl;
   class VarDecl;
   class VisibleDeclConsumer;
+  enum class DeclVisibilityKind;
   
 /// Discriminator for file-units.
 enum class FileUnitKind {
@@ -927,6 +928,19 @@ public:
   void cacheVisibleDecls(SmallVectorImpl<ValueDecl *> &&globals) const;
   const SmallVectorImpl<ValueDecl *> &getCachedVisibleDecls() const;
 
+  /// A member found by lookupVisibleMemberDecls, and why it is visible.
+  using VisibleMember = std::pair<ValueDecl *, DeclVisibilityKind>;
+  /// The canonical base type and the context of a member lookup from this
+  /// file, and the options it was performed with.
+  using VisibleMembersKey =
+      std::pair<std::pair<const TypeBase *, const DeclContext *>, unsigned>;
+
+  void cacheVisibleMembers(VisibleMembersKey key,
+                           SmallVectorImpl<VisibleMember> &&members) const;
+  /// Returns null if no members were cached for \p key.
+  const SmallVectorImpl<VisibleMember> *
+  getCachedVisibleMembers(VisibleMembersKey key) const;
+
   virtual void lookupValue(ModuleDecl::AccessPathTy accessPath, DeclName name,
                            NLKind lookupKind,
                            SmallVectorImpl<ValueDecl*> &result) const override;
@@ -348,6 +348,12 @@ class NormalProtocolConformance : public ProtocolConformance,
   LazyMemberLoader *Resolver = nullptr;
   uint64_t ResolverContextData;
 
+  /// Whether the type witnesses still need to be loaded from \c Resolver.
+  mutable bool HasLazyTypeWitnesses = false;
+
+  /// Whether the value witnesses still need to be loaded from \c Resolver.
+  mutable bool HasLazyValueWitnesses = false;
+
   friend class ASTContext;
 
   NormalProtocolConformance(Type conformingType, ProtocolDecl *protocol,
@@ -373,7 +379,8 @@ class NormalProtocolConformance : public ProtocolConformance,
   {
   }
 
-  void resolveLazyInfo() const;
+  void resolveLazyTypeWitnesses() const;
+  void resolveLazyValueWitnesses() const;
 
 public:
   /// Get the protocol being conformed to.
@@ -456,8 +463,8 @@ public:
   /// Determine whether the protocol conformance has a witness for the given
   /// requirement.
   bool hasWitness(ValueDecl *requirement) const {
-    if (Resolver)
-      resolveLazyInfo();
+    if (HasLazyValueWitnesses)
+      resolveLazyValueWitnesses();
     return Mapping.count(requirement) > 0;
   }
 
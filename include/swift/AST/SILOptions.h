@@ -55,6 +55,11 @@ public:
   /// Controls how to perform SIL linking.
   LinkingMode LinkMode = LinkNormal;
 
+  /// Don't link in every serialized function body the optimizer could use up
+  /// front. Instead, the inliner and generic specializer deserialize a body
+  /// when they actually want to look at it.
+  bool LinkOnDemand = false;
+
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
@@ -98,9 +103,22 @@ public:
   /// Instrument code to generate profiling information.
   bool GenerateProfile = false;
 
+  /// Only assign profile counters to function and closure bodies. This keeps
+  /// the overhead of instrumented code low, and is enough for the entry counts
+  /// that -profile-use consumes. Coverage mapping needs all region counters.
+  bool ProfileEntryCountsOnly = false;
+
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The indexed profile data file whose execution counts guide
+  /// optimization, if any.
+  std::string UseProfile;
+
+  /// The list of generic functions to prespecialize and the types to
+  /// specialize them for, if any. See EagerSpecializer.
+  std::string PrespecializationListFilename;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -108,8 +126,15 @@ public:
   /// conventions.
   bool EnableGuaranteedClosureContexts = false;
 
+  /// Export the generic specializations this module owns and reuse the ones
+  /// which imported modules export, instead of specializing again.
+  bool ShareSpecializations = false;
+
   /// The name of the SIL outputfile if compiled with SIL debugging (-gsil).
   std::string SILOutputFileNameForDebugging;
+
+  /// Print where the time parsing a .sil file went.
+  bool PrintSILParseTiming = false;
 };
 
 } // end namespace swift
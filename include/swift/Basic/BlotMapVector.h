@@ -113,6 +113,21 @@ class BlotMapVector {
       Vector.clear();
     }
 
+    /// Replace the contents of this map with the elements of \p Other which
+    /// have not been blotted, in the same order. Unlike copy assignment, this
+    /// does not carry along the empty slots left by blotted elements.
+    void assignUnblotted(const BlotMapVector &Other) {
+      if (this == &Other)
+        return;
+      clear();
+      for (const auto &Elt : Other.Vector) {
+        if (!Elt.hasValue())
+          continue;
+        Map.insert(std::make_pair(Elt->first, Vector.size()));
+        Vector.push_back(Elt);
+      }
+    }
+
     unsigned size() const { return Map.size(); }
 
     ValueT lookup(const KeyT &Val) const {
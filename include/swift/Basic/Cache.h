@@ -55,6 +55,23 @@ struct CacheValueInfo : public CacheValueCostInfo<T>,
                         public CacheTypeMgmtInfo<T> {
 };
 
+/// Counters describing the use of a cache, \see Cache::getStatistics.
+struct CacheStatistics {
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+  /// The number of entries removed to stay within the cost limit.
+  uint64_t Evictions = 0;
+  /// The number of entries currently in the cache.
+  size_t Count = 0;
+  /// The sum of the costs of the entries currently in the cache.
+  size_t TotalCost = 0;
+
+  double getHitRate() const {
+    uint64_t Lookups = Hits + Misses;
+    return Lookups ? double(Hits) / Lookups : 0.0;
+  }
+};
+
 /// The underlying implementation of the caching mechanism.
 /// It should be inherently thread-safe.
 class CacheImpl {
@@ -129,6 +146,21 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Sets the total cost the cache should try to stay within.
+  ///
+  /// \param Limit The cost limit, or zero for no limit.
+  ///
+  /// When the total cost of the values in the cache exceeds the limit, the
+  /// least recently used values are removed until it doesn't, although the
+  /// most recently set value is always kept.  Depending on the platform this
+  /// may only be used as a hint.
+  void setCostLimit(size_t Limit);
+
+  /// Returns the counters describing the use of the cache so far.
+  ///
+  /// Depending on the platform, not all of the counters may be available.
+  CacheStatistics getStatistics();
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +224,9 @@ public:
     removeAll();
   }
 
+  using CacheImpl::setCostLimit;
+  using CacheImpl::getStatistics;
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
@@ -31,6 +31,7 @@
 // Primary observers:
 //   - testing a specific bit
 //   - searching for set bits from the start
+//   - finding the lowest or highest set bit
 //
 //===----------------------------------------------------------------------===//
 
@@ -483,6 +484,27 @@ public:
     getChunksPtr()[i / ChunkSizeInBits] &= ~(ChunkType(1) << (i % ChunkSizeInBits));
   }
 
+  /// Set the bits in [start, start + numBits).
+  void setBits(size_t start, size_t numBits) {
+    assert(start + numBits <= size());
+    if (numBits == 0) return;
+    if (isInlineAndAllClear()) {
+      reserve(LengthInBits);
+    }
+    forEachChunkInRange(start, numBits, [](ChunkType &chunk, ChunkType mask) {
+      chunk |= mask;
+    });
+  }
+
+  /// Clear the bits in [start, start + numBits).
+  void clearBits(size_t start, size_t numBits) {
+    assert(start + numBits <= size());
+    if (numBits == 0 || isInlineAndAllClear()) return;
+    forEachChunkInRange(start, numBits, [](ChunkType &chunk, ChunkType mask) {
+      chunk &= ~mask;
+    });
+  }
+
   /// Toggle bit i.
   void flipBit(size_t i) {
     assert(i < size());
@@ -539,6 +561,30 @@ public:
     return !any();
   }
 
+  /// Return the index of the lowest set bit, if there is one.
+  Optional<size_t> findFirstSetBit() const {
+    if (isInlineAndAllClear()) return None;
+    auto chunks = getChunks();
+    for (size_t i = 0, e = chunks.size(); i != e; ++i) {
+      if (chunks[i])
+        return i * ChunkSizeInBits +
+               llvm::countTrailingZeros(chunks[i], llvm::ZB_Undefined);
+    }
+    return None;
+  }
+
+  /// Return the index of the highest set bit, if there is one.
+  Optional<size_t> findLastSetBit() const {
+    if (isInlineAndAllClear()) return None;
+    auto chunks = getChunks();
+    for (size_t i = chunks.size(); i != 0; --i) {
+      if (chunks[i - 1])
+        return i * ChunkSizeInBits - 1 -
+               llvm::countLeadingZeros(chunks[i - 1], llvm::ZB_Undefined);
+    }
+    return None;
+  }
+
   /// A class for scanning for set bits, from low indices to high ones.
   class SetBitEnumerator {
     ChunkType CurChunk;
@@ -620,6 +666,29 @@ private:
     allocateAndCopyFrom(getOutOfLineChunksPtr(), lengthToCopy, lengthToCopy);
   }
 
+  /// Call fn(chunk, mask) for each chunk overlapping the bits in
+  /// [start, start + numBits), where mask selects the bits of the chunk
+  /// in the range.
+  template <typename Fn>
+  void forEachChunkInRange(size_t start, size_t numBits, Fn fn) {
+    assert(numBits > 0);
+    auto chunks = getChunksPtr();
+    size_t end = start + numBits;
+    size_t firstChunk = start / ChunkSizeInBits;
+    size_t lastChunk = (end - 1) / ChunkSizeInBits;
+    ChunkType firstMask = ~ChunkType(0) << (start % ChunkSizeInBits);
+    ChunkType lastMask =
+      ~ChunkType(0) >> (ChunkSizeInBits - 1 - (end - 1) % ChunkSizeInBits);
+    if (firstChunk == lastChunk) {
+      fn(chunks[firstChunk], firstMask & lastMask);
+      return;
+    }
+    fn(chunks[firstChunk], firstMask);
+    for (size_t i = firstChunk + 1; i != lastChunk; ++i)
+      fn(chunks[i], ~ChunkType(0));
+    fn(chunks[lastChunk], lastMask);
+  }
+
   /// Reallocate this vector, copying the current data into the new space.
   void reallocate(size_t newCapacityInChunks);
 
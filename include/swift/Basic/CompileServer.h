@@ -0,0 +1,100 @@
+//===--- CompileServer.h - Talking to a compile server ----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The protocol between the driver and a compile server ('swift
+// -compile-server'), which runs frontend jobs without the driver having to
+// start a new compiler process for each.
+//
+// The two sides exchange messages over a Unix domain socket, one connection
+// per job. Each message is a kind byte, a 32-bit length in the host's byte
+// order, then that many bytes:
+//
+//   driver -> server   Request   the working directory and the frontend
+//                                arguments, each followed by a NUL
+//   server -> driver   Started   the pid of the process running the job,
+//                                in decimal
+//                      Output    some of what the job printed
+//                      Exited    the job's wait status, in decimal
+//
+// The server closes the connection after Exited.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_COMPILESERVER_H
+#define SWIFT_BASIC_COMPILESERVER_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace swift {
+namespace compile_server {
+
+enum class MessageKind : uint8_t {
+  Request = 'r',
+  Started = 's',
+  Output = 'o',
+  Exited = 'x',
+};
+
+/// Appends the encoding of a message to \p result.
+void encodeMessage(MessageKind kind, StringRef payload, std::string &result);
+
+/// Collects the bytes received on a connection and splits them into
+/// messages.
+class MessageReader {
+  std::string Buffer;
+  size_t Start = 0;
+
+public:
+  void append(StringRef bytes) { Buffer.append(bytes.data(), bytes.size()); }
+
+  /// Takes the next complete message, if one has been received.
+  ///
+  /// \returns false if there isn't a complete message yet.
+  bool next(MessageKind &kind, std::string &payload);
+
+  /// Returns true if part of a message has been received.
+  bool hasPartialMessage() const { return Start != Buffer.size(); }
+};
+
+/// Returns the payload of a request to run a frontend job.
+std::string encodeRequest(StringRef workingDirectory,
+                          ArrayRef<const char *> args);
+
+/// \returns false if \p payload isn't a well-formed request.
+bool decodeRequest(StringRef payload, std::string &workingDirectory,
+                   std::vector<std::string> &args);
+
+/// Writes the encoding of a message to \p fd.
+///
+/// \returns false if it couldn't all be written.
+bool writeMessage(int fd, MessageKind kind, StringRef payload);
+
+/// Blocks until a whole message has been read from \p fd.
+///
+/// \returns false if the connection was closed or there was an error first.
+bool readMessage(int fd, MessageKind &kind, std::string &payload);
+
+/// Connects to the server listening at \p socketPath.
+///
+/// \returns the connected socket, or -1 if there's no server there or this
+/// platform doesn't support one.
+int connectToServer(StringRef socketPath);
+
+} // end namespace compile_server
+} // end namespace swift
+
+#endif // SWIFT_BASIC_COMPILESERVER_H
@@ -161,6 +161,7 @@ private:
   typedef std::vector<NodePointer> NodeVector;
   NodeVector Children;
 
+protected:
   Node(Kind k)
       : NodeKind(k), NodePayloadKind(PayloadKind::None) {
   }
@@ -175,7 +176,7 @@ private:
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
+  friend class NodeFactory;
 
 public:
   ~Node();
@@ -250,6 +251,15 @@ demangleSymbolAsNode(const std::string &mangledName,
   return demangleSymbolAsNode(mangledName.data(), mangledName.size(), options);
 }
 
+class NodeFactory;
+
+/// \brief Demangle the given string as a Swift symbol, allocating the nodes
+/// of the parse tree from \p factory.
+NodePointer
+demangleSymbolAsNode(const char *mangledName, size_t mangledNameLength,
+                     NodeFactory &factory,
+                     const DemangleOptions &options = DemangleOptions());
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
@@ -300,6 +310,13 @@ demangleTypeAsNode(const std::string &mangledName,
   return demangleTypeAsNode(mangledName.data(), mangledName.size(), options);
 }
 
+/// \brief Demangle the given string as a Swift type, allocating the nodes
+/// of the parse tree from \p factory.
+NodePointer
+demangleTypeAsNode(const char *mangledName, size_t mangledNameLength,
+                   NodeFactory &factory,
+                   const DemangleOptions &options = DemangleOptions());
+
 /// \brief Demangle the given string as a Swift type mangling.
 ///
 /// \param mangledName The mangled string.
@@ -350,7 +367,51 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
+/// Creates the nodes of demangling parse trees.
+///
+/// The static create functions allocate each node on the heap by itself.
+/// An instance of NodeFactory is an arena instead: the nodes it creates are
+/// bump-allocated from memory it owns, and that memory is all freed together
+/// when the factory is destroyed. Arena nodes are still reference-counted
+/// through NodePointer, but none of them may be used after their factory is
+/// destroyed.
+class NodeFactory {
+  struct Slab;
+
+  /// The most recently allocated slab, which links to the earlier ones.
+  Slab *CurrentSlab = nullptr;
+
+  /// The unused memory in the current slab.
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+
+  void *allocateSlow(size_t size, size_t alignment);
+
+public:
+  NodeFactory() = default;
+  NodeFactory(const NodeFactory &) = delete;
+  NodeFactory &operator=(const NodeFactory &) = delete;
+  ~NodeFactory();
+
+  /// Allocate memory that lives as long as this factory.
+  void *allocate(size_t size, size_t alignment) {
+    uintptr_t start = (uintptr_t(CurPtr) + alignment - 1) & ~(alignment - 1);
+    if (CurPtr && start + size <= uintptr_t(End)) {
+      CurPtr = reinterpret_cast<char *>(start + size);
+      return reinterpret_cast<void *>(start);
+    }
+    return allocateSlow(size, alignment);
+  }
+
+  NodePointer createNode(Node::Kind K);
+  NodePointer createNode(Node::Kind K, Node::IndexType Index);
+  NodePointer createNode(Node::Kind K, llvm::StringRef Text);
+  NodePointer createNode(Node::Kind K, std::string &&Text);
+  template <size_t N>
+  NodePointer createNode(Node::Kind K, const char (&Text)[N]) {
+    return createNode(K, llvm::StringRef(Text));
+  }
+
   static NodePointer create(Node::Kind K) {
     return NodePointer(new Node(K));
   }
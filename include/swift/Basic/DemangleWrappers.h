@@ -43,6 +43,11 @@ NodePointer
 demangleSymbolAsNode(StringRef MangledName,
                      const DemangleOptions &Options = DemangleOptions());
 
+NodePointer
+demangleSymbolAsNode(StringRef MangledName,
+                     swift::Demangle::NodeFactory &Factory,
+                     const DemangleOptions &Options = DemangleOptions());
+
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
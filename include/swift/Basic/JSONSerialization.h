@@ -26,10 +26,15 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/raw_ostream.h"
+#include <type_traits>
 
 namespace swift {
 namespace json {
 
+/// Writes \p S to \p OS as a quoted JSON string, escaping the characters
+/// which must be escaped.
+void writeEscapedString(llvm::raw_ostream &OS, StringRef S);
+
 /// This class should be specialized by any type that needs to be converted
 /// to/from a JSON object.  For example:
 ///
@@ -557,6 +562,16 @@ jsonize(Output &out, T &Val, bool) {
 }
 
 
+// Strings are written as they are, without a copy into a buffer.
+inline void jsonize(Output &out, std::string &Val, bool) {
+  StringRef Str = Val;
+  out.scalarString(Str, /*MustQuote=*/true);
+}
+
+inline void jsonize(Output &out, StringRef &Val, bool) {
+  out.scalarString(Val, /*MustQuote=*/true);
+}
+
 template<typename T>
 typename std::enable_if<validatedObjectTraits<T>::value, void>::type
 jsonize(Output &out, T &Val, bool) {
@@ -623,6 +638,84 @@ operator<<(Output &yout, T &seq) {
   return yout;
 }
 
+/// Writes JSON to a stream while the values are provided, without the
+/// traits and the intermediate buffers of \c Output. This is meant for
+/// output which can be large. The output is the same as Output's:
+///
+///     json::Writer w(os);
+///     w.beginObject();
+///     w.attribute("name", s.name);
+///     w.key("sizes");
+///     w.beginArray();
+///     for (auto size : s.sizes)
+///       w.value(size);
+///     w.endArray();
+///     w.endObject();
+class Writer {
+  struct Container {
+    bool IsArray;
+    bool HasElements;
+  };
+
+  llvm::raw_ostream &Stream;
+  SmallVector<Container, 8> Stack;
+  bool PrettyPrint;
+  /// Whether a key was just written, so that the next value belongs to it.
+  bool AfterKey = false;
+
+public:
+  Writer(llvm::raw_ostream &os, bool PrettyPrint = true)
+    : Stream(os), PrettyPrint(PrettyPrint) {}
+
+  ~Writer() {
+    assert(Stack.empty() && "unterminated array or object");
+  }
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  /// Writes the key of the next value in the current object.
+  void key(StringRef Key);
+
+  void value(StringRef Str) {
+    beginValue();
+    writeEscapedString(Stream, Str);
+  }
+  void value(const char *Str) { value(StringRef(Str)); }
+  void value(const std::string &Str) { value(StringRef(Str)); }
+
+  void value(bool B) {
+    beginValue();
+    Stream << (B ? "true" : "false");
+  }
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type value(T N) {
+    beginValue();
+    // Print characters as numbers as well.
+    typedef typename std::conditional<std::is_signed<T>::value,
+                                      int64_t, uint64_t>::type Wide;
+    Stream << static_cast<Wide>(N);
+  }
+
+  void value(double D);
+
+  /// Writes a key and its value.
+  template <typename T>
+  void attribute(StringRef Key, const T &Value) {
+    key(Key);
+    value(Value);
+  }
+
+private:
+  /// Writes what comes before a value: a comma after the previous element of
+  /// an array, and the indentation.
+  void beginValue();
+  void newlineAndIndent();
+};
+
 } // end namespace json
 } // end namespace swift
 
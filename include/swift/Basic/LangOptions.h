@@ -126,6 +126,10 @@ namespace swift {
     /// ID of the current process for the purposes of AST verification.
     unsigned ASTVerifierProcessId = 1U;
 
+    /// If greater than one, the AST and SIL verifiers only check about one in
+    /// this many declarations and SIL functions.
+    unsigned VerifierSampleRatio = 1U;
+
     /// \brief The upper bound, in bytes, of temporary data that can be
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 15000000;
@@ -140,6 +144,10 @@ namespace swift {
     /// \brief Enable experimental property behavior feature.
     bool EnableExperimentalPropertyBehaviors = false;
 
+    /// Whether to look up members of deserialized types by name, deserializing
+    /// only the members with that name instead of all of them.
+    bool NamedLazyMemberLoading = false;
+
     /// Should we check the target OSs of serialized modules to see that they're
     /// new enough?
     bool EnableTargetOSChecking = true;
@@ -216,6 +224,13 @@ namespace swift {
     /// Determines if a given conditional compilation flag has been set.
     bool isCustomConditionalCompilationFlagSet(StringRef Name) const;
 
+    /// Returns true if the verifiers should check the declaration or SIL
+    /// function named \p Name, given \c VerifierSampleRatio.
+    ///
+    /// The choice only depends on the name, so that a failure can be
+    /// reproduced.
+    bool shouldVerifySample(StringRef Name) const;
+
     ArrayRef<std::pair<std::string, std::string>>
     getPlatformConditionValues() const {
       return PlatformConditionValues;
@@ -0,0 +1,139 @@
+//===--- ReferenceDependencyFormat.h - Binary swiftdeps files ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The binary format of the reference dependency (".swiftdeps") files the
+// frontend writes for the driver's incremental builds. It holds the same
+// information as the YAML format, but the driver can read it straight out of
+// a mapped file without a YAML parser.
+//
+// All integers are 32-bit little-endian. A file is laid out as:
+//
+//   signature       8 bytes, see Signature below
+//   version         FormatVersion
+//   numStrings
+//   numRecords
+//   interfaceHash   index of the interface hash in the string table, or
+//                   NoString
+//   stringEnds      numStrings offsets, each just past the end of a string in
+//                   the character data
+//   records         numRecords of (name, member, sectionAndFlags)
+//   characters      the contents of every string, without terminators
+//
+// Each distinct string is stored once, however many records refer to it.
+// The member of a record outside the sections of pairs is NoString.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_REFERENCEDEPENDENCYFORMAT_H
+#define SWIFT_BASIC_REFERENCEDEPENDENCYFORMAT_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <vector>
+
+namespace swift {
+namespace reference_dependencies {
+
+/// The lists a reference dependency file is made of, named as in the YAML
+/// format.
+enum class Section : uint8_t {
+  ProvidesTopLevel,
+  ProvidesNominal,
+  ProvidesMember,
+  ProvidesDynamicLookup,
+  DependsTopLevel,
+  DependsMember,
+  DependsNominal,
+  DependsDynamicLookup,
+  DependsExternal,
+  /// Pairs of a provided name (with the type and member of a member joined
+  /// by a NUL) and a fingerprint of the declarations that provide it.
+  Fingerprints,
+  Last = Fingerprints
+};
+
+/// The bytes every binary reference dependency file starts with. The first
+/// can't begin a YAML file.
+const uint8_t Signature[8] = { 0xFE, 'S', 'W', 'D', 'E', 'P', 'S', 0x00 };
+
+/// Bump this whenever the layout changes. Files with a different version are
+/// rejected, which makes the driver rebuild everything.
+const uint32_t FormatVersion = 2;
+
+/// Stands in for a string table index where there is no string.
+const uint32_t NoString = ~0U;
+
+/// Marks a record as not affecting the files that depend on this one.
+const uint32_t PrivateRecordFlag = 1 << 8;
+
+/// Returns the key for \p section in the YAML format.
+StringRef getSectionName(Section section);
+
+/// Returns true if \p section holds pairs of strings rather than names.
+inline bool isPairSection(Section section) {
+  return section == Section::ProvidesMember ||
+         section == Section::DependsMember ||
+         section == Section::Fingerprints;
+}
+
+/// Returns true if \p data is in the binary format rather than YAML.
+bool isBinaryFormat(StringRef data);
+
+/// Collects the contents of a reference dependency file and writes it in the
+/// binary format.
+class BinaryWriter {
+  struct Record {
+    uint32_t Name;
+    uint32_t Member;
+    uint32_t SectionAndFlags;
+  };
+
+  llvm::StringMap<uint32_t> StringIndices;
+  std::vector<StringRef> Strings;
+  std::vector<Record> Records;
+  uint32_t InterfaceHash = NoString;
+
+  uint32_t intern(StringRef string);
+
+public:
+  void addName(Section section, StringRef name, bool isCascading = true);
+  void addPair(Section section, StringRef first, StringRef second,
+               bool isCascading = true);
+  void setInterfaceHash(StringRef hash);
+
+  void write(raw_ostream &out) const;
+};
+
+/// An entry read from a binary reference dependency file.
+struct Entry {
+  Section section;
+  StringRef name;
+  /// Only meaningful in the sections of pairs, where it may be empty.
+  StringRef member;
+  bool isCascading;
+};
+
+/// Reads a binary reference dependency file, passing each entry in it to
+/// \p callback and setting \p interfaceHash. The strings point into \p data.
+///
+/// \returns false if \p data is malformed or has the wrong version, or if
+/// \p callback returned false.
+bool readBinary(StringRef data, StringRef &interfaceHash,
+                llvm::function_ref<bool(const Entry &)> callback);
+
+} // end namespace reference_dependencies
+} // end namespace swift
+
+#endif // SWIFT_BASIC_REFERENCEDEPENDENCYFORMAT_H
@@ -14,10 +14,12 @@
 #define SWIFT_BASIC_SOURCEMANAGER_H
 
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include <map>
+#include <vector>
 
 namespace swift {
 
@@ -42,6 +44,15 @@ class SourceManager {
   std::map<const char *, VirtualFile> VirtualFiles;
   mutable std::pair<const char *, const VirtualFile*> CachedVFile = {};
 
+  /// The offsets at which the lines of each buffer start, built the first
+  /// time a line is looked up in the buffer.
+  mutable llvm::DenseMap<unsigned, std::vector<unsigned>> LineStarts;
+
+  /// The buffer ID and line of the last line lookup. Lookups tend to walk
+  /// forward through a buffer, so the next one is usually on the same or the
+  /// next line.
+  mutable std::pair<unsigned, unsigned> LastLineLookup = {0U, 0U};
+
 public:
   llvm::SourceMgr &getLLVMSourceMgr() {
     return LLVMSourceMgr;
@@ -183,9 +194,9 @@ public:
   getLineAndColumn(SourceLoc Loc, unsigned BufferID = 0) const {
     assert(Loc.isValid());
     int LineOffset = getLineOffset(Loc);
-    int l, c;
-    std::tie(l, c) = LLVMSourceMgr.getLineAndColumn(Loc.Value, BufferID);
-    assert(LineOffset+l > 0 && "bogus line offset");
+    unsigned l, c;
+    std::tie(l, c) = findLineAndColumn(Loc, BufferID);
+    assert(LineOffset+int(l) > 0 && "bogus line offset");
     return { LineOffset + l, c };
   }
 
@@ -196,7 +207,7 @@ public:
   /// This does not respect #line directives.
   unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const {
     assert(Loc.isValid());
-    return LLVMSourceMgr.FindLineNumber(Loc.Value, BufferID);
+    return findLineAndColumn(Loc, BufferID).first;
   }
 
   StringRef extractText(CharSourceRange Range,
@@ -223,6 +234,14 @@ public:
 private:
   const VirtualFile *getVirtualFile(SourceLoc Loc) const;
 
+  /// Returns the offsets at which the lines of \p BufferID start.
+  const std::vector<unsigned> &getLineStarts(unsigned BufferID) const;
+
+  /// Returns the real line and column of \p Loc, as
+  /// \c llvm::SourceMgr::getLineAndColumn would.
+  std::pair<unsigned, unsigned> findLineAndColumn(SourceLoc Loc,
+                                                  unsigned BufferID) const;
+
   int getLineOffset(SourceLoc Loc) const {
     if (auto VFile = getVirtualFile(Loc))
       return VFile->LineOffset;
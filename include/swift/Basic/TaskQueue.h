@@ -46,6 +46,21 @@ class TaskQueue {
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+public:
+  /// How quickly slots freed by finished tasks were given new tasks.
+  struct Statistics {
+    /// The number of tasks started in a slot freed by another task.
+    unsigned NumRefilledSlots = 0;
+
+    /// The total and longest time from a task finishing to another task
+    /// starting in its place.
+    uint64_t TotalRefillLatencyInMicroseconds = 0;
+    uint64_t MaxRefillLatencyInMicroseconds = 0;
+  };
+
+protected:
+  Statistics Stats;
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
@@ -124,6 +139,21 @@ public:
                        ArrayRef<const char *> Env = llvm::None,
                        void *Context = nullptr);
 
+  /// \brief Adds a frontend task to the TaskQueue, which is handed to the
+  /// compile server listening at \p ServerPath if there is one.
+  ///
+  /// If the server can't be reached, or this platform doesn't support one,
+  /// the task runs in a new process like any other.
+  ///
+  /// \param ServerPath the path of the compile server's socket
+  /// \param ExecPath the path to the executable to run without a server
+  /// \param Args the arguments which should be passed to the task, starting
+  /// with "-frontend"
+  /// \param Context an optional context which will be associated with the task
+  virtual void addServerTask(StringRef ServerPath, const char *ExecPath,
+                             ArrayRef<const char *> Args,
+                             void *Context = nullptr);
+
   /// \brief Synchronously executes the tasks in the TaskQueue.
   ///
   /// \param Began a callback which will be called when a task begins
@@ -137,6 +167,12 @@ public:
           TaskFinishedCallback Finished = TaskFinishedCallback(),
           TaskSignalledCallback Signalled = TaskSignalledCallback());
 
+  /// Returns scheduling statistics for the tasks executed so far. Not all
+  /// platforms record them.
+  const Statistics &getStatistics() const {
+    return Stats;
+  }
+
   /// Returns true if there are any tasks that have been queued but have not
   /// yet been executed.
   bool hasRemainingTasks() {
@@ -170,6 +206,10 @@ public:
                        ArrayRef<const char *> Env = llvm::None,
                        void *Context = nullptr);
 
+  virtual void addServerTask(StringRef ServerPath, const char *ExecPath,
+                             ArrayRef<const char *> Args,
+                             void *Context = nullptr);
+
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
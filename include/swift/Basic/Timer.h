@@ -14,10 +14,21 @@
 #define SWIFT_BASIC_TIMER_H
 
 #include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
+#include <string>
+#include <vector>
 
 namespace swift {
+  /// When a phase timed by a SharedTimer started and ended.
+  struct TimedPhase {
+    std::string Name;
+    llvm::sys::TimeValue Start;
+    llvm::sys::TimeValue End;
+  };
+
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
   class SharedTimer {
@@ -27,8 +38,10 @@ namespace swift {
       Enabled
     };
     static State CompilationTimersEnabled;
+    static std::vector<TimedPhase> *Timeline;
 
     Optional<llvm::NamedRegionTimer> Timer;
+    size_t TimelineIndex = 0;
 
   public:
     explicit SharedTimer(StringRef name) {
@@ -36,6 +49,17 @@ namespace swift {
         Timer.emplace(name, StringRef("Swift compilation"));
       else
         CompilationTimersEnabled = State::Skipped;
+
+      if (Timeline) {
+        TimelineIndex = Timeline->size();
+        auto now = llvm::sys::TimeValue::now();
+        Timeline->push_back({name.str(), now, now});
+      }
+    }
+
+    ~SharedTimer() {
+      if (Timeline)
+        (*Timeline)[TimelineIndex].End = llvm::sys::TimeValue::now();
     }
 
     /// Must be called before any SharedTimers have been created.
@@ -44,6 +68,27 @@ namespace swift {
              "a timer has already been created");
       CompilationTimersEnabled = State::Enabled;
     }
+
+    /// Appends the start and end of every phase timed from now on to
+    /// \p timeline, whether or not the compilation timers are enabled.
+    ///
+    /// Must be called before any SharedTimers have been created, unless
+    /// \p timeline is null, which stops the recording.
+    static void recordTimeline(std::vector<TimedPhase> *timeline) {
+      assert((!timeline || CompilationTimersEnabled != State::Skipped) &&
+             "a timer has already been created");
+      Timeline = timeline;
+    }
+
+    /// Writes \p timeline in the form readTimeline accepts: a line for each
+    /// phase with its start and end, in microseconds, and its name.
+    static void writeTimeline(raw_ostream &out,
+                              ArrayRef<TimedPhase> timeline);
+
+    /// Reads a timeline written by writeTimeline.
+    ///
+    /// \returns false if \p data is malformed.
+    static bool readTimeline(StringRef data, std::vector<TimedPhase> &timeline);
   };
 } // end namespace swift
 
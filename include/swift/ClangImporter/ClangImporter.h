@@ -189,7 +189,8 @@ public:
   /// Imports an Objective-C header file into the shared imported header module.
   ///
   /// \param header A header name or full path, to be used in a \#import
-  ///        directive.
+  ///        directive, or the path of a precompiled header that was passed to
+  ///        the importer in ClangImporterOptions::BridgingHeaderPCH.
   /// \param adapter The module that depends on the contents of this header.
   /// \param diagLoc A location to attach any diagnostics to if import fails.
   /// \param trackParsedSymbols If true, tracks decls and macros that were
@@ -211,6 +212,19 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Returns true if \p PCHFilename is a precompiled header this importer
+  /// could load, and none of the headers it was built from have changed.
+  bool canReadPCH(StringRef PCHFilename);
+
+  /// Precompiles the bridging header \p headerPath into \p outputPCHPath,
+  /// with the same Clang options used to import it.
+  ///
+  /// Passing the PCH to \c importBridgingHeader in another invocation with
+  /// the same options then spares that invocation from parsing the header.
+  ///
+  /// \returns true if there was an error.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
@@ -27,6 +27,10 @@ public:
   /// Extra arguments which should be passed to the Clang importer.
   std::vector<std::string> ExtraArgs;
 
+  /// A precompiled bridging header to load when Clang is set up, in place of
+  /// parsing the header itself.
+  std::string BridgingHeaderPCH;
+
   /// A directory for overriding Clang's resource directory.
   std::string OverrideResourceDir;
 
@@ -17,6 +17,7 @@
 #include "swift/Driver/Types.h"
 #include "swift/Driver/Util.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
 namespace llvm {
@@ -46,9 +47,10 @@ public:
     REPLJob,
     LinkJob,
     GenerateDSYMJob,
+    GeneratePCHJob,
 
     JobFirst=CompileJob,
-    JobLast=GenerateDSYMJob
+    JobLast=GeneratePCHJob
   };
 
   static const char *getClassName(ActionClass AC);
@@ -136,6 +138,9 @@ public:
     };
     Status status = UpToDate;
     llvm::sys::TimeValue previousModTime;
+    /// How long the input took to compile the last time it was compiled, or
+    /// zero if that isn't known.
+    llvm::sys::TimeValue previousDuration = llvm::sys::TimeValue::ZeroTime();
 
     InputInfo() = default;
     InputInfo(Status stat, llvm::sys::TimeValue time)
@@ -266,6 +271,29 @@ public:
   }
 };
 
+/// Precompiles the bridging header once for all compile jobs.
+///
+/// Every CompileJobAction takes the same GeneratePCHJobAction as an input,
+/// so unlike other inputs it isn't owned by any of them.
+class GeneratePCHJobAction : public JobAction {
+  std::string PersistentPCHDir;
+
+  virtual void anchor();
+public:
+  GeneratePCHJobAction(Action *Input, StringRef persistentPCHDir)
+      : JobAction(Action::GeneratePCHJob, Input, types::TY_PCH),
+        PersistentPCHDir(persistentPCHDir) {}
+
+  /// Whether the PCH is kept across builds, in \c getPersistentPCHDir(),
+  /// rather than written to a temporary file.
+  bool isPersistentPCH() const { return !PersistentPCHDir.empty(); }
+  StringRef getPersistentPCHDir() const { return PersistentPCHDir; }
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::GeneratePCHJob;
+  }
+};
+
 class LinkJobAction : public JobAction {
   virtual void anchor();
   LinkKind Kind;
@@ -22,6 +22,7 @@
 #include "swift/Basic/ArrayRefView.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
@@ -106,6 +107,13 @@ private:
   /// If unknown, this will be some time in the past.
   llvm::sys::TimeValue LastBuildTime = llvm::sys::TimeValue::MinTime();
 
+  /// The interface hashes of the serialized modules this compilation depended
+  /// on during the last build, keyed by path.
+  ///
+  /// A module whose file changed but whose interface hash didn't doesn't
+  /// trigger rebuilds of the files that depend on it.
+  llvm::StringMap<std::string> LastExternalInterfaceHashes;
+
   /// The number of commands which this compilation should attempt to run in
   /// parallel.
   unsigned NumberOfParallelCommands;
@@ -132,6 +140,31 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When true, prints how quickly the driver started jobs once others had
+  /// finished.
+  bool ShowJobSchedulingStatistics = false;
+
+  /// If non-empty, a timeline of the jobs and the phases the frontends went
+  /// through is written to this file in Chrome's trace event format.
+  std::string TimeTracePath;
+
+  /// If non-empty, the results of frontend jobs are looked up in and added to
+  /// the compilation cache in this directory.
+  std::string CompilationCachePath;
+
+  /// When true, prints how many jobs were restored from the compilation
+  /// cache.
+  bool ShowCompilationCacheStatistics = false;
+
+  /// If non-empty, frontend jobs are handed to the compile server listening
+  /// on this socket rather than each run in a new process.
+  std::string CompileServerPath;
+
+  /// When true, the compile jobs that are ready to run at the start of the
+  /// build are combined into about as many frontend invocations as there are
+  /// parallel job slots, each compiling several primary files.
+  bool EnableBatchMode = false;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -165,6 +198,7 @@ public:
   }
 
   const llvm::opt::DerivedArgList &getArgs() const { return *TranslatedArgs; }
+  StringRef getArgsHash() const { return ArgsHash; }
   ArrayRef<InputPair> getInputFiles() const { return InputFilesWithTypes; }
 
   unsigned getNumberOfParallelCommands() const {
@@ -189,6 +223,30 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  void setShowsJobSchedulingStatistics(bool value = true) {
+    ShowJobSchedulingStatistics = value;
+  }
+
+  void setTimeTracePath(StringRef path) {
+    TimeTracePath = path;
+  }
+
+  void setCompilationCachePath(StringRef path) {
+    CompilationCachePath = path;
+  }
+
+  void setShowsCompilationCacheStatistics(bool value = true) {
+    ShowCompilationCacheStatistics = value;
+  }
+
+  void setCompileServerPath(StringRef path) {
+    CompileServerPath = path;
+  }
+
+  void setBatchModeEnabled(bool value = true) {
+    EnableBatchMode = value;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
@@ -198,6 +256,10 @@ public:
     LastBuildTime = time;
   }
 
+  void setLastExternalInterfaceHashes(llvm::StringMap<std::string> hashes) {
+    LastExternalInterfaceHashes = std::move(hashes);
+  }
+
   /// Requests the path to a file containing all input source files. This can
   /// be shared across jobs.
   ///
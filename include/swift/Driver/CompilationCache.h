@@ -0,0 +1,102 @@
+//===--- CompilationCache.h - Reuse results of identical jobs ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A store of the outputs of frontend jobs, keyed by a hash of everything that
+// goes into them, so that a job run before with the same inputs (by this
+// build or by another machine sharing the directory) doesn't have to run
+// again.
+//
+// Each entry is a set of files in the cache directory named after its key:
+// one per output, named with the output type's suffix, one holding what the
+// frontend printed, and a manifest written last. An entry without a manifest
+// is incomplete and ignored.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_COMPILATIONCACHE_H
+#define SWIFT_DRIVER_COMPILATIONCACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Driver/Util.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace swift {
+namespace driver {
+
+class Job;
+
+class CompilationCache {
+public:
+  struct Statistics {
+    /// The number of jobs looked up, and how many of those were found.
+    unsigned NumLookups = 0;
+    unsigned NumHits = 0;
+    /// The number of jobs whose results were added to the cache.
+    unsigned NumStores = 0;
+    /// The size of the outputs copied out of the cache.
+    uint64_t BytesRestored = 0;
+  };
+
+  using Key = llvm::SmallString<32>;
+
+private:
+  std::string Directory;
+
+  /// The hashes of the contents of the source files read so far.
+  llvm::StringMap<std::string> FileHashes;
+
+  Statistics Stats;
+
+  /// Returns the hash of the contents of \p path, or an empty string if it
+  /// can't be read.
+  StringRef getFileHash(StringRef path);
+
+  std::string getEntryPath(StringRef key, StringRef suffix) const;
+
+public:
+  explicit CompilationCache(StringRef directory) : Directory(directory) {}
+
+  /// Returns true if the results of \p Cmd can be kept in the cache.
+  ///
+  /// Only frontend jobs compiling one primary file straight from source, and
+  /// writing nothing but an object file, module and dependency files, are.
+  /// The job must write a reference dependencies file, which records the
+  /// modules it imported.
+  static bool isCacheable(const Job *Cmd);
+
+  /// Computes the key of \p Cmd from the compiler version, its command line
+  /// and the contents of \p Inputs.
+  ///
+  /// \returns false if one of the inputs can't be read.
+  bool computeKey(const Job *Cmd, ArrayRef<InputPair> Inputs, Key &result);
+
+  /// Copies the outputs stored for \p key into the places \p Cmd would have
+  /// written them, and sets \p output to what the frontend printed.
+  ///
+  /// \returns false if there's no entry for \p key, or if one of the modules
+  /// the job imported has changed since it was stored.
+  bool restore(const Job *Cmd, StringRef key, std::string &output);
+
+  /// Adds the outputs of \p Cmd, which just ran successfully, and what it
+  /// printed to the cache under \p key.
+  void store(const Job *Cmd, StringRef key, StringRef output);
+
+  const Statistics &getStatistics() const { return Stats; }
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
@@ -129,6 +129,19 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
+  /// The fingerprint of each name provided by each node, if its dependency
+  /// file has them. This determines which of the names a modified file
+  /// provides have changed along with its interface.
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>> Fingerprints;
+
+  /// The provided names whose fingerprints changed in the last load of each
+  /// node. The next markTransitive through the node only follows these.
+  llvm::DenseMap<const void *, llvm::StringSet<>> ChangedProvides;
+
+  /// The nodes left unmarked because they only depend on names whose
+  /// fingerprints didn't change.
+  llvm::SmallPtrSet<const void *, 16> SparedByFingerprints;
+
   LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
@@ -182,6 +195,10 @@ protected:
     return Marked.count(node);
   }
 
+  bool wasSparedByFingerprints(const void *node) const {
+    return SparedByFingerprints.count(node);
+  }
+
 public:
   llvm::iterator_range<StringSetIterator> getExternalDependencies() const {
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
@@ -312,6 +329,13 @@ public:
   bool isMarked(T node) const {
     return DependencyGraphImpl::isMarked(Traits::getAsVoidPointer(node));
   }
+
+  /// Returns true if \p node depends on a node whose interface changed, and
+  /// was only left unmarked because none of the declarations it uses did.
+  bool wasSparedByFingerprints(T node) const {
+    return DependencyGraphImpl::wasSparedByFingerprints(
+        Traits::getAsVoidPointer(node));
+  }
 };
 
 } // end namespace swift
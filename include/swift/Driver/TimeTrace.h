@@ -0,0 +1,57 @@
+//===--- TimeTrace.h - Timelines of the driver's jobs -----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Helpers for writing the driver's -driver-time-trace output, which
+/// can be loaded into chrome://tracing.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_TIMETRACE_H
+#define SWIFT_DRIVER_TIMETRACE_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Basic/TaskQueue.h"
+#include "llvm/Support/TimeValue.h"
+
+namespace swift {
+namespace driver {
+
+class Job;
+
+namespace time_trace {
+
+using swift::sys::ProcessId;
+
+/// \brief One run of a job, from when it was started to when it exited.
+struct JobRun {
+  const Job *Cmd;
+  ProcessId Pid;
+  /// The job slot the run took up, counting from zero.
+  unsigned Slot;
+  llvm::sys::TimeValue Start;
+  llvm::sys::TimeValue End;
+};
+
+/// \brief Writes a trace of \p Runs, along with the phases each frontend
+/// recorded in its phase timeline, to the given stream.
+///
+/// Times are shown relative to \p BuildStart. The time a frontend took to get
+/// to its first phase is shown as its spawn phase.
+void writeTimeTrace(raw_ostream &os, ArrayRef<JobRun> Runs,
+                    llvm::sys::TimeValue BuildStart);
+
+} // end namespace time_trace
+} // end namespace driver
+} // end namespace swift
+
+#endif
@@ -330,9 +330,28 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// In batch mode, the buffers, source files, and name trackers of the
+  /// primary inputs after the first, in the same order as
+  /// FrontendOptions::AdditionalPrimaryInputs.
+  std::vector<unsigned> AdditionalPrimaryBufferIDs;
+  std::vector<SourceFile *> AdditionalPrimarySourceFiles;
+  std::vector<ReferencedNameTracker *> AdditionalNameTrackers;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
+  /// Records \p SF as the primary source file for \p BufferID, if that is
+  /// one of the primary inputs.
+  void recordPrimarySourceFile(unsigned BufferID, SourceFile *SF);
+
+  /// Returns true if \p BufferID should be fully compiled: either
+  /// it's one of the primary inputs, or there are none and the whole module
+  /// is being compiled.
+  bool isPrimaryInput(unsigned BufferID) const;
+
+  /// Returns true if \p SF should be fully type-checked.
+  bool isPrimarySourceFile(const SourceFile *SF) const;
+
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
 
@@ -366,6 +385,14 @@ public:
     return NameTracker;
   }
 
+  /// Sets the trackers for the additional primary inputs of a batch mode
+  /// compile, one for each in order.
+  void setAdditionalReferencedNameTrackers(
+      ArrayRef<ReferencedNameTracker *> trackers) {
+    assert(!PrimarySourceFile && "must be called before performSema()");
+    AdditionalNameTrackers = trackers.vec();
+  }
+
   /// Set the SIL module for this compilation instance.
   ///
   /// The CompilerInstance takes ownership of the given SILModule object.
@@ -403,6 +430,12 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Gets the SourceFiles for the additional primary inputs of a batch mode
+  /// compile, in the order they were given.
+  ArrayRef<SourceFile *> getAdditionalPrimarySourceFiles() const {
+    return AdditionalPrimarySourceFiles;
+  }
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
@@ -74,6 +74,24 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// An input for which output should be generated in addition to
+  /// PrimaryInput, along with the per-file outputs to generate for it.
+  struct AdditionalPrimaryInput {
+    SelectedInput Input;
+    std::string OutputFilename;
+    std::string ModuleOutputPath;
+    std::string ModuleDocOutputPath;
+    std::string DependenciesFilePath;
+    std::string ReferenceDependenciesFilePath;
+
+    AdditionalPrimaryInput(SelectedInput Input) : Input(Input) {}
+  };
+
+  /// In batch mode, the primary inputs after the first, in the order they
+  /// were given. Each is compiled as if it were the only primary input, but
+  /// shares the parsed and type-checked module with the others.
+  std::vector<AdditionalPrimaryInput> AdditionalPrimaryInputs;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -112,12 +130,21 @@ public:
   /// The path to which we should output a Swift reference dependencies file.
   std::string ReferenceDependenciesFilePath;
 
+  /// Whether to write the reference dependencies file in the binary format,
+  /// which the driver can load faster, rather than YAML.
+  bool EmitBinaryReferenceDependencies = false;
+
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
   /// Arguments which should be passed in immediate mode.
   std::vector<std::string> ImmediateArgv;
 
+  /// If non-empty, the object code JIT-compiled in immediate mode is cached
+  /// in this directory, keyed by the LLVM IR it was compiled from, so that
+  /// running the same program again skips code generation.
+  std::string ImmediateObjectCachePath;
+
   /// \brief A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -145,6 +172,8 @@ public:
     /// Parse, type-check, and dump type refinement context hierarchy
     DumpTypeRefinementContexts,
 
+    EmitPCH, ///< Emit a precompiled header for the bridging header
+
     EmitSILGen, ///< Emit raw SIL
     EmitSIL, ///< Emit canonical SIL
 
@@ -181,6 +210,35 @@ public:
   /// \sa swift::SharedTimer
   bool DebugTimeCompilation = false;
 
+  /// If non-empty, the start and end of each of the phases timed for
+  /// DebugTimeCompilation are written to this file, for the driver's
+  /// -driver-time-trace.
+  ///
+  /// \sa swift::SharedTimer::writeTimeline
+  std::string PhaseTimelinePath;
+
+  /// If non-empty, what type-checking each expression cost the constraint
+  /// solver is written to this file as JSON, most expensive first.
+  std::string SolverProfilePath;
+
+  /// If non-empty, the phase times, statistics and peak memory of this job
+  /// are written to a new JSON file in this directory, so that a whole build
+  /// can be analyzed afterwards.
+  ///
+  /// \sa utils/process-stats-dir.py
+  std::string StatsOutputDir;
+
+  /// If set, prints the memory used by the AST after each major compilation
+  /// phase to llvm::errs().
+  ///
+  /// \sa swift::ASTContext::printMemoryUsage
+  bool PrintASTMemory = false;
+
+  /// If set, prints the peak RSS, the malloc heap and the AST and SIL arena
+  /// sizes after each major compilation phase to llvm::errs(), as soon as the
+  /// phase is done.
+  bool PrintPhaseMemory = false;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
@@ -259,6 +317,11 @@ public:
 
   void forAllOutputPaths(std::function<void(const std::string &)> fn) const;
   
+  /// Returns options for compiling the \p index'th additional primary input,
+  /// with the outputs of PrimaryInput replaced by its own.
+  FrontendOptions
+  getOptionsForAdditionalPrimaryInput(unsigned index) const;
+
   /// Gets the name of the specified output filename.
   /// If multiple files are specified, the last one is returned.
   StringRef getSingleOutputFilename() const {
@@ -22,7 +22,10 @@
 #include "llvm/Support/Casting.h"
 
 #include <iostream>
+#include <map>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 namespace swift {
 namespace reflection {
@@ -185,6 +188,21 @@ class TypeConverter {
   llvm::DenseMap<const TypeRef *, const TypeInfo *> Cache;
   llvm::DenseMap<std::pair<unsigned, unsigned>,
                  const ReferenceTypeInfo *> ReferenceCache;
+
+  /// Class instance layouts by class, instance start and alignment.
+  llvm::DenseMap<std::pair<const TypeRef *, std::pair<unsigned, unsigned>>,
+                 const TypeInfo *> ClassInstanceCache;
+
+  /// Record layouts by size, alignment, stride, extra inhabitants, kind and
+  /// fields, so that identical layouts share one RecordTypeInfo.
+  using RecordFieldKey = std::tuple<std::string, unsigned, const TypeRef *,
+                                    const TypeInfo *>;
+  using RecordKey = std::tuple<unsigned, unsigned, unsigned, unsigned,
+                               unsigned, std::vector<RecordFieldKey>>;
+  std::map<RecordKey, const RecordTypeInfo *> RecordCache;
+
+  const TypeInfo *lowerClassInstance(const TypeRef *TR, unsigned start,
+                                     unsigned align);
   const TypeRef *RawPointerTR = nullptr;
   const TypeRef *NativeObjectTR = nullptr;
   const TypeRef *UnknownObjectTR = nullptr;
@@ -208,14 +226,25 @@ public:
   /// determined by the isFixedSize() predicate.
   const TypeInfo *getTypeInfo(const TypeRef *TR);
 
+  /// Returns layout information for each of the given types, or null for
+  /// those that can't be lowered. Types that appear more than once are only
+  /// looked up once.
+  std::vector<const TypeInfo *>
+  getTypeInfos(const std::vector<const TypeRef *> &TRs);
+
   /// Returns layout information for an instance of the given
   /// class.
-  ///
-  /// Not cached.
   const TypeInfo *getClassInstanceTypeInfo(const TypeRef *TR,
                                            unsigned start,
                                            unsigned align);
 
+  /// Returns a record layout with the given properties, reusing an
+  /// existing one if it is identical.
+  const RecordTypeInfo *
+  getRecordTypeInfo(unsigned Size, unsigned Alignment, unsigned Stride,
+                    unsigned NumExtraInhabitants, RecordKind Kind,
+                    const std::vector<FieldInfo> &Fields);
+
   /* Not really public */
   const ReferenceTypeInfo *
   getReferenceTypeInfo(ReferenceKind Kind,
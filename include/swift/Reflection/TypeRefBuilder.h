@@ -271,6 +271,23 @@ private:
 
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// Descriptors by the mangled name of the type they describe. These are
+  /// built lazily: each lookup first indexes any ReflectionInfos that were
+  /// added since the last one.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldTypeInfoIndex;
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeInfoIndex;
+  std::unordered_map<std::string, std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeIndex;
+
+  /// The number of ReflectionInfos in the indexes above.
+  size_t NumIndexedReflectionInfos = 0;
+
+  /// TypeRefs already decoded from mangled type names.
+  std::unordered_map<std::string, const TypeRef *> DecodedTypeRefs;
+
+  void indexReflectionInfos();
+
   const AssociatedTypeDescriptor *
   lookupAssociatedTypes(const std::string &MangledTypeName,
                         const DependentMemberTypeRef *DependentMember);
@@ -278,6 +295,10 @@ private:
 public:
   TypeConverter &getTypeConverter() { return TC; }
 
+  /// Demangle and decode a mangled type name, or return null if it doesn't
+  /// describe a type.
+  const TypeRef *decodeMangledTypeName(const std::string &MangledName);
+
   const TypeRef *
   getDependentMemberTypeRef(const std::string &MangledTypeName,
                             const DependentMemberTypeRef *DependentMember);
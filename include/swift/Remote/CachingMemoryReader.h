@@ -0,0 +1,180 @@
+//===--- CachingMemoryReader.h - Page cache for remote reads ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an implementation of MemoryReader that caches the
+//  pages read through another MemoryReader.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace swift {
+namespace remote {
+
+/// An implementation of MemoryReader which reads whole pages through
+/// another MemoryReader and keeps the most recently used ones.
+///
+/// Metadata, nominal type descriptors, generic arguments and the strings
+/// they refer to are mostly read a few bytes at a time, and usually sit
+/// next to each other, so one page read stands in for many small ones.
+/// That matters when each read of the underlying reader is a system call
+/// or a round trip to another process.
+///
+/// The cache assumes the remote memory doesn't change. Call invalidate()
+/// whenever the remote process may have run.
+class CachingMemoryReader final : public MemoryReader {
+  struct Page {
+    uint64_t Address;
+    std::unique_ptr<uint8_t[]> Bytes;
+  };
+
+  std::shared_ptr<MemoryReader> Underlying;
+  uint64_t PageSize;
+  size_t MaxPages;
+
+  /// The cached pages, most recently used first.
+  std::list<Page> Pages;
+  std::unordered_map<uint64_t, std::list<Page>::iterator> PagesByAddress;
+
+  /// Return the cached page at \p address, reading it if necessary, or
+  /// null if it can't be read whole.
+  const uint8_t *getPage(uint64_t address) {
+    auto found = PagesByAddress.find(address);
+    if (found != PagesByAddress.end()) {
+      Pages.splice(Pages.begin(), Pages, found->second);
+      return found->second->Bytes.get();
+    }
+
+    std::unique_ptr<uint8_t[]> bytes(new uint8_t[PageSize]);
+    ++NumUnderlyingReads;
+    if (!Underlying->readBytes(RemoteAddress(address), bytes.get(), PageSize))
+      return nullptr;
+
+    if (Pages.size() >= MaxPages) {
+      PagesByAddress.erase(Pages.back().Address);
+      Pages.pop_back();
+    }
+    Pages.push_front(Page{address, std::move(bytes)});
+    PagesByAddress[address] = Pages.begin();
+    return Pages.front().Bytes.get();
+  }
+
+public:
+  /// The number of reads made of this reader and of the underlying one.
+  uint64_t NumReads = 0;
+  uint64_t NumUnderlyingReads = 0;
+
+  /// \param pageSize must be a power of two.
+  explicit CachingMemoryReader(std::shared_ptr<MemoryReader> underlying,
+                               uint64_t pageSize = 4096,
+                               size_t maxPages = 1024)
+    : Underlying(std::move(underlying)), PageSize(pageSize),
+      MaxPages(maxPages) {
+    assert(PageSize && (PageSize & (PageSize - 1)) == 0 &&
+           "page size must be a power of two");
+    assert(MaxPages > 0 && "cache must hold at least one page");
+  }
+
+  /// Forget all of the cached pages.
+  void invalidate() {
+    Pages.clear();
+    PagesByAddress.clear();
+  }
+
+  uint8_t getPointerSize() override {
+    return Underlying->getPointerSize();
+  }
+
+  uint8_t getSizeSize() override {
+    return Underlying->getSizeSize();
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return Underlying->getSymbolAddress(name);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++NumReads;
+
+    // Reads spanning more than a couple of pages are cheaper to pass
+    // through than to chop up.
+    uint64_t remoteAddress = address.getAddressData();
+    if (size > 2 * PageSize) {
+      ++NumUnderlyingReads;
+      return Underlying->readBytes(address, dest, size);
+    }
+
+    while (size > 0) {
+      uint64_t pageAddress = remoteAddress & ~(PageSize - 1);
+      auto page = getPage(pageAddress);
+      if (!page) {
+        // The page may be only partly mapped.
+        ++NumUnderlyingReads;
+        return Underlying->readBytes(RemoteAddress(remoteAddress), dest, size);
+      }
+
+      uint64_t offset = remoteAddress - pageAddress;
+      uint64_t length = std::min(size, PageSize - offset);
+      std::memcpy(dest, page + offset, length);
+      dest += length;
+      remoteAddress += length;
+      size -= length;
+    }
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    ++NumReads;
+
+    uint64_t remoteAddress = address.getAddressData();
+    std::string result;
+    while (true) {
+      uint64_t pageAddress = remoteAddress & ~(PageSize - 1);
+      auto page = getPage(pageAddress);
+      if (!page) {
+        ++NumUnderlyingReads;
+        std::string rest;
+        if (!Underlying->readString(RemoteAddress(remoteAddress), rest))
+          return false;
+        dest = result + rest;
+        return true;
+      }
+
+      auto start = page + (remoteAddress - pageAddress);
+      auto end = page + PageSize;
+      auto terminator = std::find(start, end, uint8_t(0));
+      result.append(reinterpret_cast<const char *>(start),
+                    terminator - start);
+      if (terminator != end) {
+        dest = std::move(result);
+        return true;
+      }
+      remoteAddress = pageAddress + PageSize;
+    }
+  }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
@@ -14,6 +14,8 @@
 #include <iterator>
 #include <atomic>
 #include <stdint.h>
+#include <stdlib.h>
+#include <thread>
 
 #if defined(__FreeBSD__)
 #include <stdio.h>
@@ -313,4 +315,233 @@ public:
   }
 };
 
+/// A concurrent map that is implemented using an open-addressed hash table
+/// with linear probing. Like ConcurrentMap, it supports concurrent insertions
+/// but not removals, and it has the same interface, so the two can be used
+/// interchangeably. Lookups never block and touch one or two cache lines in
+/// the common case, instead of chasing a pointer per level of a tree.
+///
+/// Entries are allocated separately and the table only stores pointers to
+/// them, so an entry's address is stable for the lifetime of the map.
+/// When the table gets too full, an inserting thread takes a spin lock,
+/// seals every free slot of the current table so no further insertions can
+/// land there, rehashes the (now frozen) contents into a table of twice the
+/// size and publishes it. Readers that are still looking at the old table
+/// see a consistent, if slightly stale, snapshot; a sealed slot is treated
+/// as empty. Replaced tables are kept until the map is destroyed, since
+/// readers may still be traversing them.
+///
+/// The map is two words in size and all-zero is a valid empty state, so it
+/// can be used wherever ConcurrentMap is embedded in a fixed-size structure.
+///
+/// In addition to the operations required by ConcurrentMap, the entry type
+/// must provide:
+///
+///   /// Hash a key. Keys that compare equal must hash equally.
+///   static size_t getKeyHash(KeyTy key);
+template <class EntryTy> class ConcurrentHashMap {
+  struct Node {
+    size_t Hash;
+    EntryTy Payload;
+
+    template <class... Args>
+    Node(size_t hash, Args &&... args)
+      : Hash(hash), Payload(std::forward<Args>(args)...) {}
+
+    Node(const Node &) = delete;
+    Node &operator=(const Node &) = delete;
+  };
+
+  struct Table {
+    /// The number of slots. Always a power of 2.
+    size_t Capacity;
+    /// The number of occupied slots.
+    std::atomic<size_t> Count;
+    /// The table this one replaced, kept alive for concurrent readers.
+    Table *Previous;
+    std::atomic<Node*> Slots[1];
+
+    static Table *allocate(size_t capacity, Table *previous) {
+      size_t size = sizeof(Table) + (capacity - 1) * sizeof(std::atomic<Node*>);
+      // calloc gives us null slots.
+      auto table = reinterpret_cast<Table*>(calloc(1, size));
+      table->Capacity = capacity;
+      table->Previous = previous;
+      return table;
+    }
+  };
+
+  enum : size_t { InitialCapacity = 16 };
+
+  /// A marker stored in the free slots of a table that is being replaced.
+  static Node *getSealedMarker() {
+    return reinterpret_cast<Node*>(uintptr_t(1));
+  }
+
+  /// The current table.
+  std::atomic<Table*> Current;
+
+  /// Held while the current table is being replaced.
+  std::atomic<uintptr_t> GrowLock;
+
+  /// Replace \p oldTable with a larger table, unless another thread has
+  /// already done so.
+  void grow(Table *oldTable) {
+    uintptr_t unlocked = 0;
+    while (!GrowLock.compare_exchange_weak(unlocked, 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+      unlocked = 0;
+      std::this_thread::yield();
+    }
+
+    if (Current.load(std::memory_order_acquire) != oldTable) {
+      // Somebody beat us to it.
+      GrowLock.store(0, std::memory_order_release);
+      return;
+    }
+
+    size_t newCapacity = oldTable ? oldTable->Capacity * 2 : InitialCapacity;
+    Table *newTable = Table::allocate(newCapacity, oldTable);
+    size_t count = 0;
+
+    if (oldTable) {
+      for (size_t i = 0; i < oldTable->Capacity; ++i) {
+        auto &slot = oldTable->Slots[i];
+        // Seal the slot if it's free. If we lose a race with an inserter,
+        // the slot holds its node instead, which we'll carry over.
+        Node *node = nullptr;
+        if (slot.compare_exchange_strong(node, getSealedMarker(),
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+          continue;
+
+        // The new table is not visible yet, so plain probing is fine.
+        uintptr_t mask = newCapacity - 1;
+        size_t index = node->Hash & mask;
+        while (newTable->Slots[index].load(std::memory_order_relaxed))
+          index = (index + 1) & mask;
+        newTable->Slots[index].store(node, std::memory_order_relaxed);
+        ++count;
+      }
+    }
+
+    newTable->Count.store(count, std::memory_order_relaxed);
+    Current.store(newTable, std::memory_order_release);
+    GrowLock.store(0, std::memory_order_release);
+  }
+
+public:
+  constexpr ConcurrentHashMap() : Current(nullptr), GrowLock(0) {}
+
+  ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+  ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+  ~ConcurrentHashMap() {
+    Table *table = Current.load(std::memory_order_relaxed);
+    if (!table)
+      return;
+
+    // Every node lives in the current table; older tables only hold
+    // duplicates of some of them.
+    for (size_t i = 0; i < table->Capacity; ++i)
+      ::delete table->Slots[i].load(std::memory_order_relaxed);
+
+    while (table) {
+      Table *previous = table->Previous;
+      free(table);
+      table = previous;
+    }
+  }
+
+  /// Search for a value by key \p Key.
+  /// \returns a pointer to the value or null if the value is not in the map.
+  template <class KeyTy>
+  EntryTy *find(const KeyTy &key) {
+    Table *table = Current.load(std::memory_order_acquire);
+    if (!table)
+      return nullptr;
+
+    size_t hash = EntryTy::getKeyHash(key);
+    uintptr_t mask = table->Capacity - 1;
+    for (size_t index = hash & mask, probes = 0; probes < table->Capacity;
+         index = (index + 1) & mask, ++probes) {
+      Node *node = table->Slots[index].load(std::memory_order_acquire);
+      // A sealed slot was free when the table was frozen, so the key
+      // wasn't in the map at that point.
+      if (!node || node == getSealedMarker())
+        return nullptr;
+      if (node->Hash == hash && node->Payload.compareWithKey(key) == 0)
+        return &node->Payload;
+    }
+    return nullptr;
+  }
+
+  /// Get or create an entry in the map.
+  ///
+  /// \returns the entry in the map and whether a new node was added (true)
+  ///   or already existed (false)
+  template <class KeyTy, class... ArgTys>
+  std::pair<EntryTy*, bool> getOrInsert(KeyTy key, ArgTys &&... args) {
+    size_t hash = EntryTy::getKeyHash(key);
+
+    // The node we allocated.
+    Node *newNode = nullptr;
+
+    while (true) {
+      Table *table = Current.load(std::memory_order_acquire);
+      if (!table) {
+        grow(nullptr);
+        continue;
+      }
+
+      uintptr_t mask = table->Capacity - 1;
+      for (size_t index = hash & mask, probes = 0; probes < table->Capacity;
+           index = (index + 1) & mask, ++probes) {
+        auto &slot = table->Slots[index];
+        Node *node = slot.load(std::memory_order_acquire);
+
+        if (!node) {
+          // Create a new node.
+          if (!newNode) {
+            size_t allocSize =
+              sizeof(Node) + EntryTy::getExtraAllocationSize(key, args...);
+            void *memory = ::operator new(allocSize);
+            newNode = ::new (memory) Node(hash, key,
+                                          std::forward<ArgTys>(args)...);
+          }
+
+          // Try to claim the slot.
+          if (slot.compare_exchange_strong(node, newNode,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+            // Keep the load factor under 3/4.
+            size_t count = table->Count.fetch_add(1, std::memory_order_relaxed);
+            if ((count + 1) * 4 > table->Capacity * 3)
+              grow(table);
+            return { &newNode->Payload, true };
+          }
+
+          // Otherwise, some other thread claimed the slot (or sealed it)
+          // before us. node holds the new value; examine it.
+        }
+
+        // The table is being replaced; retry in the new one.
+        if (node == getSealedMarker())
+          break;
+
+        // If it's equal, we can use this node.
+        if (node->Hash == hash && node->Payload.compareWithKey(key) == 0) {
+          // Destroy the node we allocated before if we're carrying one around.
+          ::delete newNode;
+          return { &node->Payload, false };
+        }
+      }
+
+      // Either the table was full or it was sealed. Wait for its replacement.
+      grow(table);
+    }
+  }
+};
+
 #endif // SWIFT_RUNTIME_CONCURRENTUTILS_H
@@ -85,6 +85,12 @@
 # define SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_END
 #endif
 
+/// The storage class specifier for runtime-private thread-local variables.
+/// Such variables must be trivially constructible and destructible.
+#ifndef SWIFT_THREAD_LOCAL
+#define SWIFT_THREAD_LOCAL __thread
+#endif
+
 // Bring in visibility attribute macros
 #include "../../../stdlib/public/SwiftShims/Visibility.h"
 
@@ -109,6 +109,15 @@ SWIFT_RUNTIME_EXPORT
 extern "C"
 void swift_reportError(uint32_t flags, const char *message);
 
+/// Print the lookup, contention and allocation counters of every runtime
+/// metadata cache to stderr.
+///
+/// This also happens at exit if SWIFT_DEBUG_METADATA_CACHE_STATISTICS=1
+/// is set in the environment.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_dumpMetadataCacheStatistics();
+
 // namespace swift
 }
 
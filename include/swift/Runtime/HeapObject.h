@@ -336,6 +336,20 @@ SWIFT_RUNTIME_EXPORT
 extern "C" void (*SWIFT_CC(RegisterPreservingCC)
                      _swift_release_n)(HeapObject *object, uint32_t n);
 
+/// Retains each non-null reference in a buffer of \p count references
+/// spaced \p stride bytes apart, in order. Equivalent to calling
+/// swift_retain on each of them.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_retainArray(HeapObject **refs, size_t count,
+                                  size_t stride);
+
+/// Releases each non-null reference in a buffer of \p count references
+/// spaced \p stride bytes apart, in order. Equivalent to calling
+/// swift_release on each of them, so deinitializers run in order too.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_releaseArray(HeapObject **refs, size_t count,
+                                   size_t stride);
+
 /// Sets the RC_DEALLOCATING_FLAG flag. This is done non-atomically.
 /// The strong reference count of \p object must be 1 and no other thread may
 /// retain the object during executing this function.
@@ -2602,6 +2602,27 @@ struct TargetGenericWitnessTable {
 };
 using GenericWitnessTable = TargetGenericWitnessTable<InProcess>;
 
+/// The description of a base protocol witness table that is derived on
+/// first use instead of when its conformance's witness table is
+/// instantiated.
+///
+/// Conformances compiled with -enable-lazy-witness-table-bases store a
+/// pointer to one of these, tagged with LazyWitnessTableBaseTag, in each
+/// base protocol slot that depends on the conforming type.  Code compiled
+/// with the same option reads those slots through
+/// swift_getWitnessTableBase, which replaces the tagged pointer with the
+/// derived witness table.
+template <typename Runtime>
+struct TargetLazyWitnessTableBase {
+  /// The generic witness table of the conformance whose slot this fills.
+  RelativeDirectPointer<TargetGenericWitnessTable<Runtime>> GenericTable;
+
+  /// Derives the base protocol witness table for a conforming type.
+  RelativeDirectPointer<const WitnessTable *(const TargetMetadata<Runtime> *type)>
+    Accessor;
+};
+using LazyWitnessTableBase = TargetLazyWitnessTableBase<InProcess>;
+
 /// The structure of a type metadata record.
 ///
 /// This contains enough static information to recover type metadata from a
@@ -2675,6 +2696,34 @@ public:
 };
 using TypeMetadataRecord = TargetTypeMetadataRecord<InProcess>;
 
+/// The structure of a prespecialized generic metadata record.
+///
+/// The compiler emits one of these for each instantiation of a generic type
+/// whose metadata it was asked to build statically. When the image is loaded,
+/// the runtime adds the metadata to the cache of its pattern, so
+/// swift_getGenericMetadata finds it without instantiating anything.
+template <typename Runtime>
+struct TargetPrespecializedMetadataRecord {
+private:
+  /// The generic metadata pattern the metadata is an instance of.
+  RelativeDirectPointer<TargetGenericMetadata<Runtime>> Pattern;
+
+  /// The address point of the statically built metadata. Its generic
+  /// argument vector holds the key arguments of the instantiation.
+  RelativeDirectPointer<const TargetMetadata<Runtime>> Metadata;
+
+public:
+  TargetGenericMetadata<Runtime> *getPattern() const {
+    return this->Pattern;
+  }
+
+  const TargetMetadata<Runtime> *getMetadata() const {
+    return this->Metadata;
+  }
+};
+using PrespecializedMetadataRecord =
+  TargetPrespecializedMetadataRecord<InProcess>;
+
 /// The structure of a protocol conformance record.
 ///
 /// This contains enough static information to recover the witness table for a
@@ -2915,6 +2964,15 @@ swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
                              void * const *instantiationArgs)
     SWIFT_CC(RegisterPreservingCC);
 
+/// \brief Fetch the base protocol witness table stored at the given index
+/// of an instantiated witness table, deriving it first if the slot is lazy.
+///
+/// \param table - an instantiated witness table
+/// \param index - the index of the base protocol slot in the table
+SWIFT_RUNTIME_EXPORT
+extern "C" const WitnessTable *
+swift_getWitnessTableBase(WitnessTable *table, size_t index);
+
 /// \brief Fetch a uniqued metadata for a function type.
 SWIFT_RUNTIME_EXPORT
 extern "C" const FunctionTypeMetadata *
@@ -3430,6 +3488,14 @@ extern "C"
 void swift_registerTypeMetadataRecords(const TypeMetadataRecord *begin,
                                        const TypeMetadataRecord *end);
 
+/// Register a block of prespecialized generic metadata records, adding the
+/// metadata to the caches of their patterns.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_registerPrespecializedMetadata(
+                                  const PrespecializedMetadataRecord *begin,
+                                  const PrespecializedMetadataRecord *end);
+
 /// Return the type name for a given type metadata.
 std::string nameForMetadata(const Metadata *type,
                             bool qualified = true);
@@ -27,15 +27,12 @@ namespace swift {
 // On OS X and iOS, swift_once_t matches dispatch_once_t.
 typedef long swift_once_t;
 
-#elif defined(__CYGWIN__)
-
-// On Cygwin, std::once_flag can not be used because it is larger than the
-// platform word.
-typedef uintptr_t swift_once_t;
 #else
 
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
+// On other platforms swift_once_t is a word managed by the runtime. (On
+// Cygwin, std::once_flag can not be used because it is larger than the
+// platform word, and elsewhere its "done" value is not known to IRGen.)
+typedef uintptr_t swift_once_t;
 
 #endif
 
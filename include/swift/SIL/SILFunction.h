@@ -56,6 +56,30 @@ public:
   void print(llvm::raw_ostream &OS) const;
 };
 
+/// The side-effects of a function's body, summarized by the optimizer so that
+/// clients of the module can use them without seeing the body.
+///
+/// Each entry is a combination of the Reads, Writes, Retains and Releases
+/// bits. The global effects also hold the AllocsObjects, Traps and ReadsRC
+/// bits. See SideEffectAnalysis::FunctionEffects for what they mean.
+struct SILFunctionEffectsSummary {
+  enum : uint8_t {
+    Reads = 1 << 0,
+    Writes = 1 << 1,
+    Retains = 1 << 2,
+    Releases = 1 << 3,
+    AllocsObjects = 1 << 4,
+    Traps = 1 << 5,
+    ReadsRC = 1 << 6
+  };
+
+  /// The effects which can't be associated with one of the arguments.
+  uint8_t GlobalEffects = 0;
+
+  /// The effects on each of the function's arguments.
+  SmallVector<uint8_t, 6> ArgumentEffects;
+};
+
 /// SILFunction - A function body that has been lowered to SIL. This consists of
 /// zero or more SIL SILBasicBlock objects that contain the SILInstruction
 /// objects making up the function.
@@ -165,6 +189,14 @@ private:
   /// The function's effects attribute.
   EffectsKind EffectsKindAttr;
 
+  /// The side-effects of the function as summarized for clients of the
+  /// module, if they are known.
+  Optional<SILFunctionEffectsSummary> EffectsSummary;
+
+  /// How many times the function was entered in the profile being used to
+  /// guide optimization, if it has one.
+  Optional<uint64_t> EntryCount;
+
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
   bool Inlined = false;
@@ -497,6 +529,25 @@ public:
     EffectsKindAttr = E;
   }
 
+  /// \return the side-effects summarized for clients of the module, if any.
+  ///
+  /// For a definition this is set by the optimizer just before the module is
+  /// serialized; for an external declaration it is read from the module which
+  /// defines the function. See SILModule::lookUpEffectsSummary.
+  const Optional<SILFunctionEffectsSummary> &getEffectsSummary() const {
+    return EffectsSummary;
+  }
+
+  void setEffectsSummary(SILFunctionEffectsSummary S) {
+    EffectsSummary = std::move(S);
+  }
+
+  /// \return how many times the function was entered in the profile given
+  /// with -profile-use, or None if there is no profile for it.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+
+  void setEntryCount(uint64_t Count) { EntryCount = Count; }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
@@ -164,6 +164,10 @@ private:
   /// This is the set of undef values we've created, for uniquing purposes.
   llvm::DenseMap<SILType, SILUndef *> UndefValues;
 
+  /// The mangled names of the constants looked up by declaration so far,
+  /// allocated in the module.
+  llvm::DenseMap<SILDeclRef, StringRef> MangledConstantNames;
+
   /// The stage of processing this module is at.
   SILStage Stage;
 
@@ -182,6 +186,10 @@ private:
   /// optimizations can assume that they see the whole module.
   bool wholeModule;
 
+  /// The largest entry count of any function in the profile given with
+  /// -profile-use, or zero if there is none.
+  uint64_t MaxFunctionEntryCount = 0;
+
   /// The options passed into this SILModule.
   SILOptions &Options;
 
@@ -405,6 +413,12 @@ public:
     return FunctionTable.lookup(name);
   }
 
+  /// Returns the mangled name of \p constant.
+  ///
+  /// This is the same as \c SILDeclRef::mangle, but only mangles each
+  /// constant once.
+  StringRef getMangledName(SILDeclRef constant);
+
   /// Look for a function by declaration.
   ///
   /// \return null if this module has no such function
@@ -431,6 +445,13 @@ public:
   bool linkFunction(StringRef Name,
                     LinkingMode LinkAll = LinkingMode::LinkNormal);
 
+  /// If SIL functions are linked on demand and \p Fun is an external
+  /// declaration, attempt to deserialize its body, along with the shared and
+  /// transparent functions the body references.
+  ///
+  /// \return true if \p Fun has a body now.
+  bool linkFunctionBodyOnDemand(SILFunction *Fun);
+
   /// Check if a given function exists in the module,
   /// i.e. it can be linked by linkFunction.
   ///
@@ -438,6 +459,13 @@ public:
   /// the declaration of a function.
   SILFunction *hasFunction(StringRef Name, SILLinkage Linkage);
 
+  /// Look up the side-effects of \p F which were summarized for clients of
+  /// the module defining it.
+  ///
+  /// \return null if \p F is not an external declaration or its module
+  /// doesn't have a summary for it.
+  const SILFunctionEffectsSummary *lookUpEffectsSummary(SILFunction *F);
+
   /// Link in all Witness Tables in the module.
   void linkAllWitnessTables();
 
@@ -545,6 +573,15 @@ public:
     Stage = s;
   }
 
+  /// \brief Return the largest entry count of any function in the profile
+  /// which guides optimization, which SILFunction::getEntryCount is relative
+  /// to.
+  uint64_t getMaxFunctionEntryCount() const { return MaxFunctionEntryCount; }
+
+  void setMaxFunctionEntryCount(uint64_t Count) {
+    MaxFunctionEntryCount = Count;
+  }
+
   /// \brief Run the SIL verifier to make sure that all Functions follow
   /// invariants.
   void verify() const;
@@ -593,6 +630,12 @@ public:
   /// Deallocate memory of an instruction.
   void deallocateInst(SILInstruction *I);
 
+  /// Returns the number of bytes allocated in the module's internal allocator.
+  ///
+  /// Instructions are allocated separately, with malloc, and are not
+  /// included.
+  size_t getTotalMemory() const { return BPA.getTotalMemory(); }
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
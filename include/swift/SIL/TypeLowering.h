@@ -24,6 +24,7 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
+#include <memory>
 
 namespace clang {
   class Type;
@@ -417,9 +418,6 @@ class TypeConverter {
   friend class TypeLowering;
 
   llvm::BumpPtrAllocator IndependentBPA;
-  /// BumpPtrAllocator for types dependent on contextual generic parameters,
-  /// which is reset when the generic context is popped.
-  llvm::BumpPtrAllocator DependentBPA;
 
   enum : unsigned {
     /// There is a unique entry with this uncurry level in the
@@ -509,12 +507,29 @@ class TypeConverter {
   /// Insert a mapping into the cache.
   void insert(TypeKey k, const TypeLowering *tl);
   
-  /// Mapping for types independent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
+  /// Mapping for types independent on contextual generic parameters.
   llvm::DenseMap<CachingTypeKey, const TypeLowering *> IndependentTypes;
-  /// Mapping for types dependent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
-  llvm::DenseMap<CachingTypeKey, const TypeLowering *> DependentTypes;
+
+  /// The lowerings of the types dependent on the contextual generic
+  /// parameters of one generic signature, and the allocator they live in.
+  struct DependentTypeCache {
+    llvm::BumpPtrAllocator BPA;
+    llvm::DenseMap<CachingTypeKey, const TypeLowering *> Types;
+
+    ~DependentTypeCache();
+  };
+
+  /// The dependent type lowerings of each generic signature seen so far.
+  ///
+  /// These are kept when the generic context is popped, so that the next
+  /// function with the same (uniqued) signature reuses them.
+  llvm::DenseMap<GenericSignature *, std::unique_ptr<DependentTypeCache>>
+    DependentTypeCaches;
+
+  /// The dependent type lowerings of the current generic context.
+  DependentTypeCache *CurDependentTypes = nullptr;
+
+  DependentTypeCache &getCurDependentTypes();
   
   llvm::DenseMap<SILDeclRef, SILConstantInfo> ConstantTypes;
   
@@ -142,6 +142,14 @@ namespace swift {
 
     /// Verify that the function \p F can be used by the analysis.
     static void verifyFunction(SILFunction *F);
+
+    /// Count \p N cached results of a function analysis being thrown away
+    /// by an invalidation.
+    static void countInvalidatedResults(unsigned N);
+
+    /// Count \p N cached results of a function analysis surviving an
+    /// invalidation which didn't affect them, and so not being recomputed.
+    static void countPreservedResults(unsigned N);
   };
 
   /// An abstract base class that implements the boiler plate of caching and
@@ -179,23 +187,37 @@ namespace swift {
     }
 
     virtual void invalidate(SILAnalysis::InvalidationKind K) override {
-      if (!shouldInvalidate(K)) return;
+      unsigned NumCached = 0;
+      for (auto D : Storage)
+        if (D.second)
+          ++NumCached;
+
+      if (!shouldInvalidate(K)) {
+        countPreservedResults(NumCached);
+        return;
+      }
 
       for (auto D : Storage)
         delete D.second;
 
       Storage.clear();
+      countInvalidatedResults(NumCached);
     }
 
     virtual void invalidate(SILFunction *F,
                             SILAnalysis::InvalidationKind K) override {
-      if (!shouldInvalidate(K)) return;
+      auto it = Storage.find(F);
+      if (it == Storage.end() || !it->second)
+        return;
 
-      auto &it = Storage.FindAndConstruct(F);
-      if (it.second) {
-        delete it.second;
-        it.second = nullptr;
+      if (!shouldInvalidate(K)) {
+        countPreservedResults(1);
+        return;
       }
+
+      delete it->second;
+      it->second = nullptr;
+      countInvalidatedResults(1);
     }
 
     FunctionAnalysisBase() {}
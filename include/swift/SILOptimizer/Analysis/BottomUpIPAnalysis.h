@@ -306,6 +306,16 @@ protected:
       FInfo->UpdateID = 0;
     }
   }
+
+  /// Invalidates \p FInfo, but not the analysis data of its callers.
+  /// This must only be used if the recomputed data of \p FInfo is still
+  /// valid for the callers, e.g. if the data was just released to save
+  /// memory.
+  template<typename FunctionInfo>
+  void invalidateWithoutCallers(FunctionInfo *FInfo) {
+    FInfo->clear();
+    FInfo->UpdateID = 0;
+  }
 };
 
 } // end namespace swift
@@ -133,10 +133,12 @@ public:
     CGNode *pointsTo = nullptr;
     
     /// The outgoing defer edges.
-    llvm::SmallVector<CGNode *, 8> defersTo;
+    /// Most nodes only have a few edges. Keeping the inline storage small
+    /// reduces the size of a node considerably.
+    llvm::SmallVector<CGNode *, 4> defersTo;
     
     /// The predecessor edges (points-to and defer).
-    llvm::SmallVector<Predecessor, 8> Preds;
+    llvm::SmallVector<Predecessor, 4> Preds;
     
     /// If this Content node is merged with another Content node, mergeTo is
     /// the merge destination.
@@ -395,6 +397,10 @@ public:
 
     /// Removes all nodes from the graph.
     void clear();
+
+    /// Removes all nodes from the graph and also frees the memory of the
+    /// internal data structures.
+    void releaseMemory();
     
     /// Allocates a node of a given type.
     CGNode *allocNode(ValueBase *V, NodeType Type) {
@@ -616,10 +622,16 @@ private:
     /// them again.
     bool NeedUpdateSummaryGraph = true;
 
+    /// If true, the connection graph was released to save memory, but the
+    /// summary graph is still valid. The connection graph is rebuilt when it
+    /// is requested again.
+    bool GraphIsDropped = false;
+
     /// Clears the analysis data on invalidation.
     void clear() {
       Graph.clear();
       SummaryGraph.clear();
+      GraphIsDropped = false;
     }
   };
 
@@ -644,6 +656,11 @@ private:
   /// The allocator for the connection graphs in Function2ConGraph.
   llvm::SpecificBumpPtrAllocator<FunctionInfo> Allocator;
 
+  /// The functions with the most recently requested connection graphs, the
+  /// latest one at the end. Only for those the complete connection graph is
+  /// kept. For all other functions just the summary graph is kept.
+  llvm::SmallVector<FunctionInfo *, 8> RecentlyUsedGraphs;
+
   /// Cache for isPointer().
   llvm::DenseMap<SILType, bool> isPointerCache;
 
@@ -701,6 +718,13 @@ private:
   /// all called functions, up to a recursion depth of MaxRecursionDepth.
   void recompute(FunctionInfo *Initial);
 
+  /// Releases the connection graph of \p FInfo, but keeps its summary graph.
+  void dropGraph(FunctionInfo *FInfo);
+
+  /// Marks the connection graph of \p FInfo as most recently used and drops
+  /// the least recently used graph if there are too many.
+  void markGraphAsUsed(FunctionInfo *FInfo);
+
   /// Merges the graph of a callee function into the graph of
   /// a caller function, whereas \p FAS is the call-site.
   bool mergeCalleeGraph(FullApplySite FAS,
@@ -730,8 +754,9 @@ public:
   /// Gets the connection graph for \a F.
   ConnectionGraph *getConnectionGraph(SILFunction *F) {
     FunctionInfo *FInfo = getFunctionInfo(F);
-    if (!FInfo->isValid())
+    if (!FInfo->isValid() || FInfo->GraphIsDropped)
       recompute(FInfo);
+    markGraphAsUsed(FInfo);
     return &FInfo->Graph;
   }
 
@@ -78,6 +78,14 @@ public:
       Releases = false;
     }
 
+    /// Sets the effects from their encoding in a SILFunctionEffectsSummary.
+    void setFromSummary(uint8_t Bits) {
+      Reads = (Bits & SILFunctionEffectsSummary::Reads) != 0;
+      Writes = (Bits & SILFunctionEffectsSummary::Writes) != 0;
+      Retains = (Bits & SILFunctionEffectsSummary::Retains) != 0;
+      Releases = (Bits & SILFunctionEffectsSummary::Releases) != 0;
+    }
+
     friend class SideEffectAnalysis;
     
   public:
@@ -118,6 +126,20 @@ public:
       return MemoryBehavior::None;
     }
 
+    /// Returns the encoding of the effects in a SILFunctionEffectsSummary.
+    uint8_t getSummary() const {
+      uint8_t Bits = 0;
+      if (Reads)
+        Bits |= SILFunctionEffectsSummary::Reads;
+      if (Writes)
+        Bits |= SILFunctionEffectsSummary::Writes;
+      if (Retains)
+        Bits |= SILFunctionEffectsSummary::Retains;
+      if (Releases)
+        Bits |= SILFunctionEffectsSummary::Releases;
+      return Bits;
+    }
+
     /// Merge effects from \p RHS.
     bool mergeFrom(const Effects &RHS) {
       bool Changed = false;
@@ -207,6 +229,10 @@ public:
       ReadsRC = false;
     }
   
+    /// Sets the effects from a summary made by the module defining the
+    /// function.
+    void setFromSummary(const SILFunctionEffectsSummary &Summary);
+
     /// Merge the flags from \p RHS.
     bool mergeFlags(const FunctionEffects &RHS) {
       bool Changed = false;
@@ -249,6 +275,10 @@ public:
     /// effects.
     ArrayRef<Effects> getParameterEffects() const { return ParamEffects; }
     
+    /// Returns the effects in the form which is serialized for clients of
+    /// the module.
+    SILFunctionEffectsSummary getSummary() const;
+
     /// Merge effects from \p RHS.
     bool mergeFrom(const FunctionEffects &RHS);
 
@@ -321,6 +351,11 @@ private:
   /// Get the side-effects of a function, which has an @effects attribute.
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
+
+  /// Get the side-effects of an external function, which the module defining
+  /// it summarized for its clients.
+  /// Returns true if \a F has such a summary.
+  static bool getSummarizedEffects(FunctionEffects &Effects, SILFunction *F);
   
   /// Get the side-effects of a semantic call.
   /// Return true if \p ASC could be handled.
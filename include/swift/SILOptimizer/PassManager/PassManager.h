@@ -65,6 +65,9 @@ class SILPassManager {
   /// Set to true when a pass invalidates an analysis.
   bool CurrentPassHasInvalidated = false;
 
+  /// The number of times the current pass has invalidated analyses.
+  unsigned NumCurrentPassInvalidations = 0;
+
   /// True if we need to stop running passes and restart again on the
   /// same function.
   bool RestartPipeline = false;
@@ -119,6 +122,7 @@ public:
         AP->invalidate(K);
 
     CurrentPassHasInvalidated = true;
+    ++NumCurrentPassInvalidations;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
@@ -147,6 +151,7 @@ public:
         AP->invalidate(F, K);
     
     CurrentPassHasInvalidated = true;
+    ++NumCurrentPassInvalidations;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
@@ -162,8 +167,10 @@ public:
         AP->invalidateForDeadFunction(F, K);
     
     CurrentPassHasInvalidated = true;
-    // Any change let all passes run again.
-    CompletedPassesMap[F].reset();
+    ++NumCurrentPassInvalidations;
+    // Forget the function, so that a new function allocated in its place
+    // doesn't inherit its completed passes.
+    CompletedPassesMap.erase(F);
   }
 
   /// \brief Reset the state of the pass manager and remove all transformation
@@ -224,6 +231,10 @@ private:
   /// options) whether we should continue running passes.
   bool continueTransforming();
 
+  /// Return true if -sil-print-last is set and the pass about to run is the
+  /// last one that -sil-opt-pass-count lets run.
+  bool isLastPassToRun();
+
   /// Return true if all analyses are unlocked.
   bool analysesUnlocked();
 
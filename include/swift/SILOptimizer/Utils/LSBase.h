@@ -371,6 +371,19 @@ public:
                                    LSLocationBaseMap &BaseToLoc,
                                    TypeExpansionAnalysis *TE,
                                    std::pair<int, int> &LSCount);
+
+  /// Reorder the enumerated locations so that all locations with the same
+  /// base are adjacent in the vault, and split the vault into partitions of
+  /// at most \p MaxPartitionSize locations. The locations of a single base
+  /// are never split across partitions, so a partition can be larger if one
+  /// base has more locations than that.
+  ///
+  /// On return, \p Partitions contains the start index of each partition,
+  /// followed by the size of the vault.
+  static void partitionLSLocations(std::vector<LSLocation> &LSLocationVault,
+                                   LSLocationIndexMap &LocToBit,
+                                   unsigned MaxPartitionSize,
+                                   llvm::SmallVectorImpl<unsigned> &Partitions);
 };
 
 static inline llvm::hash_code hash_value(const LSLocation &L) {
@@ -92,6 +92,9 @@ public:
   /// information regarding this particular request, e.g., get the
   /// type of a declaration, perform name lookup into a particular
   /// context, and so on.
+  ///
+  /// If the request depends on itself through a cycle that can't be broken,
+  /// the cycle is diagnosed and the request is left unsatisfied.
   void satisfy(TypeCheckRequest request);
 };
 
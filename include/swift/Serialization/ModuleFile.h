@@ -281,6 +281,16 @@ private:
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
 
+  class DeclMemberTableInfo;
+  using SerializedDeclMemberTable =
+      llvm::OnDiskIterableChainedHashTable<DeclMemberTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberTable> DeclMembersByName;
+
+  /// The IDs of the nominal types and extensions whose members may be looked
+  /// up in DeclMembersByName.
+  llvm::DenseMap<const Decl *, serialization::DeclID> MemberContextIDs;
+
   class ObjCMethodTableInfo;
   using SerializedObjCMethodTable =
     llvm::OnDiskIterableChainedHashTable<ObjCMethodTableInfo>;
@@ -390,6 +400,11 @@ private:
   std::unique_ptr<SerializedLocalDeclTable>
   readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk table of members by parent and name stored in
+  /// index_block::DeclListLayout format.
+  std::unique_ptr<SerializedDeclMemberTable>
+  readDeclMemberTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Read an on-disk Objective-C method table stored in
   /// index_block::ObjCMethodTableLayout format.
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
@@ -607,6 +622,10 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual bool
+  loadNamedMembers(const Decl *D, Identifier Name, uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &Members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -614,9 +633,14 @@ public:
   virtual TypeLoc loadAssociatedTypeDefault(const AssociatedTypeDecl *ATD,
                                             uint64_t contextData) override;
 
-  virtual void finishNormalConformance(NormalProtocolConformance *conformance,
+  virtual void
+  finishNormalConformanceTypeWitnesses(NormalProtocolConformance *conformance,
                                        uint64_t contextData) override;
 
+  virtual void
+  finishNormalConformanceValueWitnesses(NormalProtocolConformance *conformance,
+                                        uint64_t contextData) override;
+
   Optional<StringRef> getGroupNameById(unsigned Id) const;
   Optional<StringRef> getSourceFileNameById(unsigned Id) const;
   Optional<StringRef> getGroupNameForDecl(const Decl *D) const;
@@ -53,7 +53,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 250; // Last change: Add Throws bit
+const uint16_t VERSION_MINOR = 253; // Last change: interface hash
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -408,7 +408,8 @@ namespace control_block {
   enum {
     METADATA = 1,
     MODULE_NAME,
-    TARGET
+    TARGET,
+    INTERFACE_HASH
   };
 
   using MetadataLayout = BCRecordLayout<
@@ -428,6 +429,14 @@ namespace control_block {
     TARGET,
     BCBlob // LLVM triple
   >;
+
+  /// A fingerprint of everything in the module a client can depend on: the
+  /// declarations it can see or whose layout it needs, and the SIL bodies it
+  /// can inline. Body-only changes to other code leave it unchanged.
+  using InterfaceHashLayout = BCRecordLayout<
+    INTERFACE_HASH,
+    BCBlob // MD5, as a hex string
+  >;
 }
 
 /// The record types within the options block (a sub-block of the control
@@ -1472,6 +1481,10 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// The table of members of nominal types and extensions, keyed by the
+    /// containing decl and the member's name.
+    DECL_MEMBER_NAMES,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -15,6 +15,7 @@
 
 #include "swift/AST/Module.h"
 #include "swift/AST/ModuleLoader.h"
+#include "swift/Serialization/Validation.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace swift {
@@ -70,6 +71,35 @@ public:
                     std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
                     bool isFramework = false);
 
+  /// A serialized AST which has been read, but not yet loaded into a module.
+  struct PreparedAST {
+    std::unique_ptr<ModuleFile> File;
+    serialization::ValidationInfo LoadInfo;
+    serialization::ExtendedValidationInfo ExtendedInfo;
+    std::string ModuleBufferID;
+    std::string ModuleDocBufferID;
+
+    PreparedAST();
+    PreparedAST(PreparedAST &&);
+    ~PreparedAST();
+  };
+
+  /// Reads a serialized AST, ready to be loaded by the overload of loadAST
+  /// taking a PreparedAST.
+  ///
+  /// This doesn't touch any ASTContext, so several serialized ASTs can be
+  /// prepared at once on different threads.
+  static PreparedAST
+  prepareAST(std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
+             std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
+             bool isFramework = false);
+
+  /// Attempt to load a prepared serialized AST into the given module.
+  ///
+  /// \sa loadAST
+  FileUnit *loadAST(Module &M, Optional<SourceLoc> diagLoc,
+                    PreparedAST prepared);
+
   /// \brief Register a memory buffer that contains the serialized
   /// module for the given access path. This API is intended to be
   /// used by LLDB to add swiftmodules discovered in the __apple_ast
@@ -26,6 +26,7 @@ class FileUnit;
 class ModuleDecl;
 class SILDeserializer;
 class SILFunction;
+struct SILFunctionEffectsSummary;
 class SILGlobalVariable;
 class SILModule;
 class SILVTable;
@@ -102,6 +103,12 @@ public:
   SILWitnessTable *lookupWitnessTable(SILWitnessTable *C);
   SILDefaultWitnessTable *lookupDefaultWitnessTable(SILDefaultWitnessTable *C);
 
+  /// Read the side-effects summarized for the function named \p Name by the
+  /// module defining it.
+  ///
+  /// \returns false if none of the loaded modules has a summary for it.
+  bool lookupEffectsSummary(StringRef Name, SILFunctionEffectsSummary &Summary);
+
   /// Invalidate the cached entries for deserialized SILFunctions.
   void invalidateCaches();
 
@@ -39,7 +39,9 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Format.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include <algorithm>
@@ -47,6 +49,10 @@
 
 using namespace swift;
 
+#define DEBUG_TYPE "ASTContext"
+STATISTIC(NumArchetypeBuilders, "# of archetype builders created");
+STATISTIC(NumArchetypeBuilderLookups, "# of archetype builders looked up");
+
 LazyResolver::~LazyResolver() = default;
 DelegatingLazyResolver::~DelegatingLazyResolver() = default;
 void ModuleLoader::anchor() {}
@@ -242,9 +248,13 @@ struct ASTContext::Implementation {
                            ArchetypeBuilder::PotentialArchetype *>>
     LazyArchetypes;
 
-  /// \brief Stored archetype builders.
+  /// \brief Stored archetype builders. Equivalent signatures, such as a
+  /// canonical signature and its mangling signature, share one builder.
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
-                 std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
+                 ArchetypeBuilder *> ArchetypeBuilders;
+
+  /// \brief The archetype builders in ArchetypeBuilders.
+  std::vector<std::unique_ptr<ArchetypeBuilder>> OwnedArchetypeBuilders;
 
   /// The set of property names that show up in the defining module of a
   /// class.
@@ -258,6 +268,15 @@ struct ASTContext::Implementation {
 
   /// \brief Structure that captures data that is segregated into different
   /// arenas.
+  ///
+  /// FIXME: None of these tables, nor the allocators behind them, are safe to
+  /// use from more than one thread. Uniquing a type looks it up and inserts
+  /// it without a lock, and its storage comes from an unsynchronized bump
+  /// allocator. Creating types concurrently would need per-thread allocators
+  /// and tables that are sharded by hash with a lock per shard (or for the
+  /// FoldingSets, which can't be sharded, one lock each). It would also need
+  /// the lazily computed canonical types and the other state types cache in
+  /// themselves to be published safely.
   struct Arena {
     llvm::FoldingSet<TupleType> TupleTypes;
     llvm::DenseMap<std::pair<Type,char>, MetatypeType*> MetatypeTypes;
@@ -344,9 +363,24 @@ struct ASTContext::Implementation {
 
   llvm::StringMap<OptionSet<SearchPathKind>> SearchPathsSet;
 
+  /// The USRs of the declarations printed so far, allocated in the permanent
+  /// arena.
+  llvm::DenseMap<const ValueDecl *, StringRef> DeclUSRs;
+
   /// \brief The permanent arena.
   Arena Permanent;
 
+  /// The bytes and number of AST nodes allocated, by kind and arena.
+  struct NodeAllocations {
+    size_t Bytes = 0;
+    unsigned Count = 0;
+  };
+  NodeAllocations AllocatedNodes[NumASTNodeAllocationKinds][2];
+
+  /// The bytes allocated in constraint solver arenas that have since been
+  /// freed.
+  size_t FreedSolverBytes = 0;
+
   /// Temporary arena used for a constraint solver.
   struct ConstraintSolverArena : public Arena {
     /// The allocator used for all allocations within this arena.
@@ -400,6 +434,8 @@ ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator,
 }
 
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
+  if (auto current = Self.Impl.CurrentConstraintSolverArena.get())
+    Self.Impl.FreedSolverBytes += current->Allocator.getTotalMemory();
   Self.Impl.CurrentConstraintSolverArena.reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
@@ -1389,30 +1425,35 @@ void ASTContext::getVisibleTopLevelClangModules(
 ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
                     CanGenericSignature sig,
                     ModuleDecl *mod) {
+  ++NumArchetypeBuilderLookups;
+
   // Check whether we already have an archetype builder for this
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
   if (known != Impl.ArchetypeBuilders.end())
-    return known->second.get();
+    return known->second;
 
   // Create a new archetype builder with the given signature.
+  ++NumArchetypeBuilders;
   auto builder = new ArchetypeBuilder(*mod, Diags);
   builder->addGenericSignature(sig, /*adoptArchetypes=*/false,
                                /*treatRequirementsAsExplicit=*/true);
   
   // Store this archetype builder.
-  Impl.ArchetypeBuilders[{sig, mod}]
-    = std::unique_ptr<ArchetypeBuilder>(builder);
+  Impl.OwnedArchetypeBuilders.emplace_back(builder);
+  Impl.ArchetypeBuilders[{sig, mod}] = builder;
   return builder;
 }
 
 void ASTContext::setArchetypeBuilder(CanGenericSignature sig,
                                      ModuleDecl *mod,
-                                     std::unique_ptr<ArchetypeBuilder> builder) {
-  if (Impl.ArchetypeBuilders.find({sig, mod})
-        == Impl.ArchetypeBuilders.end()) {
-    Impl.ArchetypeBuilders[{sig, mod}] = move(builder);
-  }
+                                     ArchetypeBuilder *builder) {
+  assert(std::any_of(Impl.OwnedArchetypeBuilders.begin(),
+                     Impl.OwnedArchetypeBuilders.end(),
+                     [&](const std::unique_ptr<ArchetypeBuilder> &owned) {
+                       return owned.get() == builder;
+                     }) && "archetype builder not created by the context");
+  Impl.ArchetypeBuilders.insert({{sig, mod}, builder});
 }
 
 Module *
@@ -1651,6 +1692,14 @@ ASTContext::takeDelayedConformanceDiags(NormalProtocolConformance *conformance){
   return result;
 }
 
+StringRef ASTContext::getCachedUSR(const ValueDecl *D) const {
+  return Impl.DeclUSRs.lookup(D);
+}
+
+void ASTContext::cacheUSR(const ValueDecl *D, StringRef USR) {
+  Impl.DeclUSRs[D] = AllocateCopy(USR);
+}
+
 size_t ASTContext::getTotalMemory() const {
   size_t Size = sizeof(*this) +
     // LoadedModules ?
@@ -1693,6 +1742,74 @@ size_t ASTContext::getSolverMemory() const {
   return Size;
 }
 
+void ASTContext::recordNodeAllocation(ASTNodeAllocationKind kind, size_t bytes,
+                                      AllocationArena arena) const {
+  auto &allocations =
+    Impl.AllocatedNodes[unsigned(kind)][arena == AllocationArena::Permanent
+                                          ? 0 : 1];
+  allocations.Bytes += bytes;
+  ++allocations.Count;
+}
+
+void ASTContext::printMemoryUsage(llvm::raw_ostream &os) const {
+  static const char *const kindNames[NumASTNodeAllocationKinds] = {
+    "Decl", "Decl (from Clang)", "Expr", "Stmt", "Pattern", "TypeRepr",
+    "Type", "ProtocolConformance"
+  };
+
+  os << "  arena bytes:\n";
+  os << llvm::format("    %-28s %12zu\n", "permanent",
+                     Impl.Allocator.getTotalMemory());
+  os << llvm::format("    %-28s %12zu\n", "constraint solver (freed)",
+                     Impl.FreedSolverBytes);
+  os << llvm::format("    %-28s %12zu\n", "constraint solver (current)",
+                     getSolverMemory());
+
+  os << "  node allocations:" << llvm::format("%18s %9s %12s %9s\n",
+                                              "permanent", "count",
+                                              "solver", "count");
+  for (unsigned i = 0; i != NumASTNodeAllocationKinds; ++i) {
+    auto &permanent = Impl.AllocatedNodes[i][0];
+    auto &solver = Impl.AllocatedNodes[i][1];
+    os << llvm::format("    %-20s %12zu %9u %12zu %9u\n", kindNames[i],
+                       permanent.Bytes, permanent.Count,
+                       solver.Bytes, solver.Count);
+  }
+
+  const Implementation::Arena &arena = Impl.Permanent;
+  os << "  uniquing tables (permanent arena):\n";
+  auto printTable = [&](const char *name, size_t entries) {
+    os << llvm::format("    %-28s %12zu\n", name, entries);
+  };
+  printTable("TupleTypes", arena.TupleTypes.size());
+  printTable("MetatypeTypes", arena.MetatypeTypes.size());
+  printTable("FunctionTypes", arena.FunctionTypes.size());
+  printTable("OptionalTypes", arena.OptionalTypes.size());
+  printTable("ParenTypes", arena.ParenTypes.size());
+  printTable("LValueTypes", arena.LValueTypes.size());
+  printTable("InOutTypes", arena.InOutTypes.size());
+  printTable("SubstitutedTypes", arena.SubstitutedTypes.size());
+  printTable("DependentMemberTypes", arena.DependentMemberTypes.size());
+  printTable("EnumTypes", arena.EnumTypes.size());
+  printTable("StructTypes", arena.StructTypes.size());
+  printTable("ClassTypes", arena.ClassTypes.size());
+  printTable("BoundGenericTypes", arena.BoundGenericTypes.size());
+  printTable("BoundGenericSubstitutions",
+             arena.BoundGenericSubstitutions.size());
+  printTable("NormalConformances", arena.NormalConformances.size());
+  printTable("SpecializedConformances", arena.SpecializedConformances.size());
+  printTable("InheritedConformances", arena.InheritedConformances.size());
+  printTable("GenericFunctionTypes", Impl.GenericFunctionTypes.size());
+  printTable("SILFunctionTypes", Impl.SILFunctionTypes.size());
+  printTable("ProtocolCompositionTypes",
+             Impl.ProtocolCompositionTypes.size());
+  printTable("GenericSignatures", Impl.GenericSignatures.size());
+  printTable("CompoundNames", Impl.CompoundNames.size());
+  printTable("Identifiers", Impl.IdentifierTable.size());
+  os << llvm::format("    %-28s %12zu\n", "bytes in hash tables",
+                     arena.getTotalMemory());
+}
+
 size_t ASTContext::Implementation::Arena::getTotalMemory() const {
   return sizeof(*this) +
     // TupleTypes ?
@@ -329,7 +329,14 @@ struct ASTNodeBase {};
     bool shouldVerify(Expr *E) { return true; }
     bool shouldVerify(Stmt *S) { return true; }
     bool shouldVerify(Pattern *S) { return true; }
-    bool shouldVerify(Decl *S) { return true; }
+    bool shouldVerify(Decl *D) {
+      // Sample declarations at the top level and in type contexts; what's
+      // inside a sampled declaration is verified along with it.
+      auto *VD = dyn_cast<ValueDecl>(D);
+      if (!VD || !VD->hasName() || D->getDeclContext()->isLocalContext())
+        return true;
+      return Ctx.LangOpts.shouldVerifySample(VD->getNameStr());
+    }
 
     // Default cases for cleaning up as we exit a node.
     void cleanup(Expr *E) { }
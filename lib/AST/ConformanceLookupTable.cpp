@@ -18,10 +18,18 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/Module.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Conformance lookup table"
+STATISTIC(NumConformanceLookups, "# of conformances to a protocol looked up");
+STATISTIC(NumConformanceEntries, "# of conformance entries materialized");
+STATISTIC(NumImpliedExpansionsAvoided,
+          "# of lookups answered without expanding implied conformances");
+
 DeclContext *ConformanceLookupTable::ConformanceSource::getDeclContext() const {
   switch (getKind()) {
   case ConformanceEntryKind::Inherited:
@@ -470,6 +478,7 @@ bool ConformanceLookupTable::addProtocol(NominalTypeDecl *nominal,
 
   /// Build the conformance entry (if it hasn't been built before).
   ConformanceEntry *entry = new (ctx) ConformanceEntry(loc, protocol, source);
+  ++NumConformanceEntries;
   conformanceEntries.push_back(entry);
 
   // Record this as a conformance within the given declaration
@@ -537,6 +546,38 @@ void ConformanceLookupTable::expandImpliedConformances(NominalTypeDecl *nominal,
   }
 }
 
+bool ConformanceLookupTable::couldImplyConformance(ProtocolDecl *protocol) {
+  // Implied conformances to this protocol aren't only found through protocol
+  // inheritance; see expandImpliedConformances.
+  if (protocol->isSpecificProtocol(KnownProtocolKind::BridgedNSError))
+    return true;
+
+  // Walk the protocols inherited by those already recorded, the same way
+  // expanding implied conformances would.
+  SmallVector<ProtocolDecl *, 8> worklist;
+  llvm::SmallPtrSet<ProtocolDecl *, 8> visited;
+  for (const auto &entry : Conformances) {
+    if (!entry.second.empty() && visited.insert(entry.first).second)
+      worklist.push_back(entry.first);
+  }
+  while (!worklist.empty()) {
+    auto current = worklist.pop_back_val();
+    for (const auto &inherited : current->getInherited()) {
+      bool found = false;
+      visitProtocols(inherited.getType(), inherited.getLoc(),
+                     [&](ProtocolDecl *inheritedProto, SourceLoc loc) {
+                       if (inheritedProto == protocol)
+                         found = true;
+                       else if (visited.insert(inheritedProto).second)
+                         worklist.push_back(inheritedProto);
+                     });
+      if (found)
+        return true;
+    }
+  }
+  return false;
+}
+
 /// Determine whether the given conformance entry kind can be replaced.
 static bool isReplaceable(ConformanceEntryKind kind) {
   switch (kind) {
@@ -898,9 +939,19 @@ bool ConformanceLookupTable::lookupConformance(
   // Update to record all explicit and inherited conformances.
   updateLookupTable(nominal, ConformanceStage::Inherited, resolver);
 
+  ++NumConformanceLookups;
+
   // Look for conformances to this protocol.
   auto known = Conformances.find(protocol);
   if (known == Conformances.end()) {
+    // If none of the protocols the type is known to conform to inherit from
+    // this one, expanding implied conformances won't find it, so leave the
+    // expansion for a lookup that needs it.
+    if (!couldImplyConformance(protocol)) {
+      ++NumImpliedExpansionsAvoided;
+      return false;
+    }
+
     // If we didn't find anything, expand implied conformances.
     updateLookupTable(nominal, ConformanceStage::ExpandedImplied, resolver);
     known = Conformances.find(protocol);
@@ -339,6 +339,11 @@ class ConformanceLookupTable {
   void expandImpliedConformances(NominalTypeDecl *nominal, DeclContext *dc,
                                  LazyResolver *resolver);
 
+  /// Determine whether expanding implied conformances could add a
+  /// conformance to the given protocol, i.e., whether it's inherited by any
+  /// protocol the type is already known to conform to.
+  bool couldImplyConformance(ProtocolDecl *protocol);
+
   /// A three-way ordering
   enum class Ordering {
     Before,
@@ -90,6 +90,7 @@ const clang::Module *ClangNode::getClangModule() const {
 // Only allow allocation of Decls using the allocator in ASTContext.
 void *Decl::operator new(size_t Bytes, const ASTContext &C,
                          unsigned Alignment) {
+  C.recordDeclAllocation(Bytes, /*fromClang=*/false);
   return C.Allocate(Bytes, Alignment);
 }
 
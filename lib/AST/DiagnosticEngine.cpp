@@ -91,9 +91,15 @@ static const char *diagnosticStrings[] = {
     "<not a diagnostic>",
 };
 
+static const char *diagnosticIDStrings[] = {
+#define DIAG(KIND, ID, Options, Text, Signature) #ID,
+#include "swift/AST/DiagnosticsAll.def"
+};
+
 DiagnosticState::DiagnosticState() {
   // Initialize our per-diagnostic state to default
   perDiagnosticBehavior.resize(LocalDiagID::NumDiags, Behavior::Unspecified);
+  perDiagnosticCounts.resize(LocalDiagID::NumDiags);
 }
 
 static CharSourceRange toCharSourceRange(SourceManager &SM, SourceRange SR) {
@@ -127,6 +133,8 @@ InFlightDiagnostic &InFlightDiagnostic::highlightChars(SourceLoc Start,
 ///
 InFlightDiagnostic &InFlightDiagnostic::fixItInsertAfter(SourceLoc L,
                                                          StringRef Str) {
+  if (!Engine)
+    return *this;
   L = Lexer::getLocForEndOfToken(Engine->SourceMgr, L);
   return fixItInsert(L, Str);
 }
@@ -485,18 +493,25 @@ static DiagnosticKind toDiagnosticKind(DiagnosticState::Behavior behavior) {
 }
 
 DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
-  auto set = [this](DiagnosticState::Behavior lvl) {
-    if (lvl == Behavior::Fatal) {
-      fatalErrorOccurred = true;
-      anyErrorOccurred = true;
-    } else if (lvl == Behavior::Error) {
-      anyErrorOccurred = true;
-    }
+  Behavior lvl = computeBehavior(id);
+  if (lvl == Behavior::Fatal) {
+    fatalErrorOccurred = true;
+    anyErrorOccurred = true;
+  } else if (lvl == Behavior::Error) {
+    anyErrorOccurred = true;
+  }
+
+  auto &counts = perDiagnosticCounts[(unsigned)id];
+  if (lvl == Behavior::Ignore)
+    ++counts.second;
+  else
+    ++counts.first;
 
-    previousBehavior = lvl;
-    return lvl;
-  };
+  previousBehavior = lvl;
+  return lvl;
+}
 
+DiagnosticState::Behavior DiagnosticState::computeBehavior(DiagID id) const {
   // We determine how to handle a diagnostic based on the following rules
   //   1) If current state dictates a certain behavior, follow that
   //   2) If the user provided a behavior for this specific diagnostic, follow
@@ -512,36 +527,46 @@ DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
 
   // Notes relating to ignored diagnostics should also be ignored
   if (previousBehavior == Behavior::Ignore && isNote)
-    return set(Behavior::Ignore);
+    return Behavior::Ignore;
 
   // Suppress diagnostics when in a fatal state, except for follow-on notes
   if (fatalErrorOccurred)
     if (!showDiagnosticsAfterFatalError && !isNote)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
 
   //   2) If the user provided a behavior for this specific diagnostic, follow
   //      that
 
   if (perDiagnosticBehavior[(unsigned)id] != Behavior::Unspecified)
-    return set(perDiagnosticBehavior[(unsigned)id]);
+    return perDiagnosticBehavior[(unsigned)id];
 
   //   3) If the user provided a behavior for this diagnostic's kind, follow
   //      that
   if (diagInfo.kind == DiagnosticKind::Warning) {
     if (suppressWarnings)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
     if (warningsAsErrors)
-      return set(Behavior::Error);
+      return Behavior::Error;
   }
 
   //   4) Otherwise remap the diagnostic kind
   switch (diagInfo.kind) {
   case DiagnosticKind::Note:
-    return set(Behavior::Note);
+    return Behavior::Note;
   case DiagnosticKind::Error:
-    return set(diagInfo.isFatal ? Behavior::Fatal : Behavior::Error);
+    return diagInfo.isFatal ? Behavior::Fatal : Behavior::Error;
   case DiagnosticKind::Warning:
-    return set(Behavior::Warning);
+    return Behavior::Warning;
+  }
+}
+
+void DiagnosticEngine::forEachDiagnosticCount(
+    llvm::function_ref<void(StringRef name, unsigned emitted,
+                            unsigned ignored)> fn) const {
+  for (unsigned i = 0; i != LocalDiagID::NumDiags; ++i) {
+    auto counts = state.getDiagnosticCounts((DiagID)i);
+    if (counts.first != 0 || counts.second != 0)
+      fn(diagnosticIDStrings[i], counts.first, counts.second);
   }
 }
 
@@ -567,6 +592,10 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   if (behavior == DiagnosticState::Behavior::Ignore)
     return;
 
+  // Nobody would see the text.
+  if (Consumers.empty())
+    return;
+
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
   if (loc.isInvalid() && diagnostic.getDecl()) {
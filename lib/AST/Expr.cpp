@@ -37,6 +37,7 @@ using namespace swift;
 // Only allow allocation of Stmts using the allocator in ASTContext.
 void *Expr::operator new(size_t Bytes, ASTContext &C,
                          unsigned Alignment) {
+  C.recordNodeAllocation(ASTNodeAllocationKind::Expr, Bytes);
   return C.Allocate(Bytes, Alignment);
 }
 
@@ -202,13 +202,10 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   }
   
   // Otherwise, we need to compute it.
-  // Dump the generic signature into an ArchetypeBuilder that will figure out
-  // the minimal set of requirements.
-  std::unique_ptr<ArchetypeBuilder> builder(new ArchetypeBuilder(M, 
-                                                                 Context.Diags));
-  
-  builder->addGenericSignature(canonical, /*adoptArchetypes*/ false,
-                               /*treatRequirementsAsExplicit*/ true);
+  // The ArchetypeBuilder of the generic signature will figure out the minimal
+  // set of requirements.
+  ArchetypeBuilder *builder =
+    Context.getOrCreateArchetypeBuilder(canonical, &M);
   
   // Sort out the requirements.
   struct DependentConstraints {
@@ -373,7 +370,7 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   
   // Cache the result.
   Context.ManglingSignatures.insert({{canonical, &M}, canSig});
-  Context.setArchetypeBuilder(canSig, &M, std::move(builder));
+  Context.setArchetypeBuilder(canSig, &M, builder);
 
   return canSig;
 }
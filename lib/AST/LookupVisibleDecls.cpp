@@ -78,6 +78,12 @@ public:
   }
   bool isIncludingInstanceMembers() const { return IncludeInstanceMembers; }
 
+  /// Returns the flags packed into an integer, to key caches with.
+  unsigned getOpaqueValue() const {
+    return IsQualified | IsOnMetatype << 1 | IsOnSuperclass << 2 |
+           InheritsSuperclassInitializers << 3 | IncludeInstanceMembers << 4;
+  }
+
   LookupState withOnMetatype() const {
     auto Result = *this;
     Result.IsOnMetatype = 1;
@@ -734,6 +740,24 @@ public:
 static void lookupVisibleMemberDecls(
     Type BaseTy, VisibleDeclConsumer &Consumer, const DeclContext *CurrDC,
     LookupState LS, DeclVisibilityKind Reason, LazyResolver *TypeResolver) {
+  // Completions keep asking for the members of the same types from the same
+  // context, so the results are cached in the file for the lifetime of its
+  // lookup cache. Type variables don't outlive their constraint system, so
+  // types containing them are not cached.
+  const SourceFile *SF = CurrDC->getParentSourceFile();
+  Optional<SourceFile::VisibleMembersKey> CacheKey;
+  if (SF && !BaseTy->hasTypeVariable()) {
+    CacheKey = SourceFile::VisibleMembersKey(
+        { BaseTy->getCanonicalType().getPointer(), CurrDC },
+        LS.getOpaqueValue() | (TypeResolver != nullptr) << 5 |
+          static_cast<unsigned>(Reason) << 6);
+    if (auto *Cached = SF->getCachedVisibleMembers(*CacheKey)) {
+      for (const auto &DeclAndReason : *Cached)
+        Consumer.foundDecl(DeclAndReason.first, DeclAndReason.second);
+      return;
+    }
+  }
+
   OverrideFilteringConsumer ConsumerWrapper(BaseTy, CurrDC, TypeResolver);
   VisitedSet Visited;
   lookupVisibleMemberDeclsImpl(BaseTy, ConsumerWrapper, CurrDC, LS, Reason,
@@ -742,6 +766,13 @@ static void lookupVisibleMemberDecls(
   // Report the declarations we found to the real consumer.
   for (const auto &DeclAndReason : ConsumerWrapper.DeclsToReport)
     Consumer.foundDecl(DeclAndReason.D, DeclAndReason.Reason);
+
+  if (CacheKey) {
+    SmallVector<SourceFile::VisibleMember, 0> Members;
+    for (const auto &DeclAndReason : ConsumerWrapper.DeclsToReport)
+      Members.push_back({ DeclAndReason.D, DeclAndReason.Reason });
+    SF->cacheVisibleMembers(*CacheKey, std::move(Members));
+  }
 }
 
 void swift::lookupVisibleDecls(VisibleDeclConsumer &Consumer,
@@ -159,6 +159,8 @@ public:
                          const SourceFile &SF);
 
   SmallVector<ValueDecl *, 0> AllVisibleValues;
+  llvm::DenseMap<SourceFile::VisibleMembersKey,
+                 SmallVector<SourceFile::VisibleMember, 0>> VisibleMembers;
 };
 using SourceLookupCache = SourceFile::LookupCache;
 
@@ -330,6 +332,7 @@ void SourceLookupCache::invalidate() {
   // std::move AllVisibleValues into a temporary to destroy its contents.
   using SameSizeSmallVector = decltype(AllVisibleValues);
   (void)SameSizeSmallVector{std::move(AllVisibleValues)};
+  VisibleMembers.clear();
 }
 
 //===----------------------------------------------------------------------===//
@@ -1491,6 +1494,20 @@ SourceFile::getCachedVisibleDecls() const {
   return getCache().AllVisibleValues;
 }
 
+void SourceFile::cacheVisibleMembers(VisibleMembersKey key,
+                                 SmallVectorImpl<VisibleMember> &&members) const {
+  getCache().VisibleMembers[key] = std::move(members);
+}
+
+const SmallVectorImpl<SourceFile::VisibleMember> *
+SourceFile::getCachedVisibleMembers(VisibleMembersKey key) const {
+  auto &cached = getCache().VisibleMembers;
+  auto iter = cached.find(key);
+  if (iter == cached.end())
+    return nullptr;
+  return &iter->second;
+}
+
 static void performAutoImport(SourceFile &SF,
                               SourceFile::ImplicitModuleImportKind modImpKind) {
   if (SF.Kind == SourceFileKind::SIL)
@@ -25,6 +25,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
@@ -698,6 +699,14 @@ TypeDecl* UnqualifiedLookup::getSingleTypeResult() {
 
 #pragma mark Member lookup table
 
+#define DEBUG_TYPE "Name lookup"
+STATISTIC(NumDirectLookups, "# of direct member lookups");
+STATISTIC(NumDirectLookupHits, "# of direct member lookups finding members");
+STATISTIC(NumLookupTableExtensions,
+          "# of extensions added to member lookup tables");
+STATISTIC(NumNamedLazyMemberLookups,
+          "# of lookups into unloaded member lists by name");
+
 void LazyMemberLoader::anchor() {}
 
 /// Lookup table used to store members of a nominal type (and its extensions)
@@ -707,6 +716,10 @@ class swift::MemberLookupTable {
   /// results.
   ExtensionDecl *LastExtensionIncluded = nullptr;
 
+  /// The included extensions whose members had not been loaded when they were
+  /// included. Their members are loaded by name as they are looked up.
+  SmallVector<ExtensionDecl *, 4> LazyExtensions;
+
   /// The type of the internal lookup table.
   typedef llvm::DenseMap<DeclName, llvm::TinyPtrVector<ValueDecl *>>
     LookupTable;
@@ -722,7 +735,15 @@ public:
   void destroy();
 
   /// Update a lookup table with members from newly-added extensions.
-  void updateLookupTable(NominalTypeDecl *nominal);
+  ///
+  /// \param skipLazyExtensions If true, extensions whose members have not been
+  /// loaded are remembered in the lazy extension list instead.
+  void updateLookupTable(NominalTypeDecl *nominal, bool skipLazyExtensions);
+
+  /// The included extensions which may still have unloaded members.
+  ArrayRef<ExtensionDecl *> getLazyExtensions() const {
+    return LazyExtensions;
+  }
 
   /// \brief Add the given member to the lookup table.
   void addMember(Decl *members);
@@ -849,7 +870,8 @@ void MemberLookupTable::addExtensionMembers(NominalTypeDecl *nominal,
   addMembers(members);
 }
 
-void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
+void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal,
+                                          bool skipLazyExtensions) {
   // If the last extension we included is the same as the last known extension,
   // we're already up-to-date.
   if (LastExtensionIncluded == nominal->LastExtension)
@@ -861,7 +883,11 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
                      : nominal->FirstExtension;
        next;
        (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
-    addMembers(next->getMembers());
+    ++NumLookupTableExtensions;
+    if (skipLazyExtensions && next->isLazy())
+      LazyExtensions.push_back(next);
+    else
+      addMembers(next->getMembers());
   }
 }
 
@@ -891,15 +917,21 @@ void ExtensionDecl::addedMember(Decl *member) {
 }
 
 void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
+  auto &ctx = getASTContext();
+
   // If we haven't allocated the lookup table yet, do so now.
   if (!LookupTable.getPointer()) {
-    auto &ctx = getASTContext();
     LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
   }
 
+  // With named lazy member loading, members which haven't been loaded yet are
+  // added to the table as they are looked up, and members which are loaded
+  // later are added as they are loaded.
+  bool namedLazyMemberLoading = ctx.LangOpts.NamedLazyMemberLoading;
+
   // If we haven't walked the member list yet to update the lookup
   // table, do so now.
-  if (!LookupTable.getInt()) {
+  if (!LookupTable.getInt() && !(namedLazyMemberLoading && isLazy())) {
     // Note that we'll have walked the members now.
     LookupTable.setInt(true);
 
@@ -909,7 +941,7 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
 
   if (!ignoreNewExtensions) {
     // Update the lookup table to introduce members from extensions.
-    LookupTable.getPointer()->updateLookupTable(this);
+    LookupTable.getPointer()->updateLookupTable(this, namedLazyMemberLoading);
   }
 }
 
@@ -922,25 +954,66 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
   LookupTable.getPointer()->addMember(member);
 }
 
+/// Add the members of \p IDC named \p name to \p table, loading only those
+/// members if the loader of \p IDC can find them by name.
+static void loadNamedMembers(MemberLookupTable &table,
+                             IterableDeclContext *IDC, Decl *container,
+                             DeclName name) {
+  SmallVector<ValueDecl *, 4> members;
+  if (IDC->getLoader()->loadNamedMembers(container, name.getBaseName(),
+                                         IDC->getLoaderContextData(),
+                                         members)) {
+    ++NumNamedLazyMemberLookups;
+    for (auto member : members)
+      table.addMember(member);
+    return;
+  }
+
+  // Otherwise load all of them.
+  table.addMembers(IDC->getMembers());
+}
+
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
+  ++NumDirectLookups;
+
+  bool namedLazyMemberLoading = getASTContext().LangOpts.NamedLazyMemberLoading;
+
   // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
-  if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
-  }
+  // extensions). The members of extensions already in the lookup table have
+  // been loaded, and any added since were added to the table as well, so only
+  // newly-bound extensions need their members loaded, which updating the
+  // table does.
+  if (!ignoreNewExtensions)
+    (void)getExtensions();
 
-  (void)getMembers();
+  if (!namedLazyMemberLoading)
+    (void)getMembers();
 
   prepareLookupTable(ignoreNewExtensions);
 
+  // With named lazy member loading, load the members with this name from the
+  // contexts whose members haven't all been loaded yet.
+  if (namedLazyMemberLoading) {
+    auto &table = *LookupTable.getPointer();
+    if (isLazy())
+      loadNamedMembers(table, this, this, name);
+
+    // Loading members can cause more extensions to be included.
+    SmallVector<ExtensionDecl *, 4> lazyExtensions(
+        table.getLazyExtensions().begin(), table.getLazyExtensions().end());
+    for (auto ext : lazyExtensions)
+      if (ext->isLazy())
+        loadNamedMembers(table, ext, ext, name);
+  }
+
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
   if (known == LookupTable.getPointer()->end())
     return { };
 
   // We found something; return it.
+  ++NumDirectLookupHits;
   return { known->second.begin(), known->second.size() };
 }
 
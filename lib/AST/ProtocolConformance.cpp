@@ -52,6 +52,8 @@ ProtocolDecl *ProtocolConformanceRef::getRequirement() const {
 void *ProtocolConformance::operator new(size_t bytes, ASTContext &context,
                                         AllocationArena arena,
                                         unsigned alignment) {
+  context.recordNodeAllocation(ASTNodeAllocationKind::Conformance, bytes,
+                               arena);
   return context.Allocate(bytes, alignment, arena);
 
 }
@@ -196,16 +198,36 @@ AbstractStorageDecl *ProtocolConformance::getBehaviorDecl() const {
   return getRootNormalConformance()->getBehaviorDecl();
 }
 
-void NormalProtocolConformance::resolveLazyInfo() const {
-  assert(Resolver);
-  assert(isComplete());
+void NormalProtocolConformance::resolveLazyTypeWitnesses() const {
+  assert(Resolver && HasLazyTypeWitnesses);
 
+  // Loading one kind of witness can require the other, so save and restore
+  // the state rather than assuming the conformance is complete here.
   auto *resolver = Resolver;
   auto *mutableThis = const_cast<NormalProtocolConformance *>(this);
-  mutableThis->Resolver = nullptr;
+  auto state = getState();
+  HasLazyTypeWitnesses = false;
+  if (!HasLazyValueWitnesses)
+    mutableThis->Resolver = nullptr;
   mutableThis->setState(ProtocolConformanceState::Incomplete);
-  resolver->finishNormalConformance(mutableThis, ResolverContextData);
-  mutableThis->setState(ProtocolConformanceState::Complete);
+  resolver->finishNormalConformanceTypeWitnesses(mutableThis,
+                                                 ResolverContextData);
+  mutableThis->setState(state);
+}
+
+void NormalProtocolConformance::resolveLazyValueWitnesses() const {
+  assert(Resolver && HasLazyValueWitnesses);
+
+  auto *resolver = Resolver;
+  auto *mutableThis = const_cast<NormalProtocolConformance *>(this);
+  auto state = getState();
+  HasLazyValueWitnesses = false;
+  if (!HasLazyTypeWitnesses)
+    mutableThis->Resolver = nullptr;
+  mutableThis->setState(ProtocolConformanceState::Incomplete);
+  resolver->finishNormalConformanceValueWitnesses(mutableThis,
+                                                  ResolverContextData);
+  mutableThis->setState(state);
 }
 
 void NormalProtocolConformance::setLazyLoader(LazyMemberLoader *resolver,
@@ -213,12 +235,14 @@ void NormalProtocolConformance::setLazyLoader(LazyMemberLoader *resolver,
   assert(!Resolver && "already has a resolver");
   Resolver = resolver;
   ResolverContextData = contextData;
+  HasLazyTypeWitnesses = true;
+  HasLazyValueWitnesses = true;
 }
 
 bool NormalProtocolConformance::hasTypeWitness(AssociatedTypeDecl *assocType,
                                                LazyResolver *resolver) const {
-  if (Resolver)
-    resolveLazyInfo();
+  if (HasLazyTypeWitnesses)
+    resolveLazyTypeWitnesses();
 
   if (TypeWitnesses.find(assocType) != TypeWitnesses.end()) {
     return true;
@@ -236,8 +260,8 @@ std::pair<const Substitution &, TypeDecl *>
 NormalProtocolConformance::getTypeWitnessSubstAndDecl(
                       AssociatedTypeDecl *assocType, 
                       LazyResolver *resolver) const {
-  if (Resolver)
-    resolveLazyInfo();
+  if (HasLazyTypeWitnesses)
+    resolveLazyTypeWitnesses();
 
   auto known = TypeWitnesses.find(assocType);
   if (known == TypeWitnesses.end()) {
@@ -266,8 +290,8 @@ ConcreteDeclRef NormalProtocolConformance::getWitness(
                   ValueDecl *requirement, 
                   LazyResolver *resolver) const {
   assert(!isa<AssociatedTypeDecl>(requirement) && "Request type witness");
-  if (Resolver)
-    resolveLazyInfo();
+  if (HasLazyValueWitnesses)
+    resolveLazyValueWitnesses();
 
   auto known = Mapping.find(requirement);
   if (known == Mapping.end()) {
@@ -30,6 +30,7 @@ using namespace swift;
 // Only allow allocation of Stmts using the allocator in ASTContext.
 void *Stmt::operator new(size_t Bytes, ASTContext &C,
                          unsigned Alignment) {
+  C.recordNodeAllocation(ASTNodeAllocationKind::Stmt, Bytes);
   return C.Allocate(Bytes, Alignment);
 }
 
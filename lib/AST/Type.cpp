@@ -49,6 +49,7 @@ SourceRange TypeLoc::getSourceRange() const {
 // Only allow allocation of Types using the allocator in ASTContext.
 void *TypeBase::operator new(size_t bytes, const ASTContext &ctx,
                              AllocationArena arena, unsigned alignment) {
+  ctx.recordNodeAllocation(ASTNodeAllocationKind::Type, bytes, arena);
   return ctx.Allocate(bytes, alignment, arena);
 }
 
@@ -71,6 +71,7 @@ SourceRange TypeRepr::getSourceRange() const {
 /// Standard allocator for TypeReprs.
 void *TypeRepr::operator new(size_t Bytes, const ASTContext &C,
                              unsigned Alignment) {
+  C.recordNodeAllocation(ASTNodeAllocationKind::TypeRepr, Bytes);
   return C.Allocate(Bytes, Alignment);
 }
 
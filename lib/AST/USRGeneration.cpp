@@ -29,7 +29,7 @@ static inline StringRef getUSRSpacePrefix() {
   return "s:";
 }
 
-bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+static bool printDeclUSRUncached(const ValueDecl *D, raw_ostream &OS) {
   using namespace Mangle;
 
   if (!isa<FuncDecl>(D) && !D->hasName())
@@ -90,6 +90,25 @@ bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
   return false;
 }
 
+bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+  ASTContext &Ctx = D->getASTContext();
+  StringRef Cached = Ctx.getCachedUSR(D);
+  if (!Cached.empty()) {
+    OS << Cached;
+    return false;
+  }
+
+  // Only USRs that could be printed are kept; a declaration without a type
+  // yet may get one later.
+  llvm::SmallString<128> Buf;
+  llvm::raw_svector_ostream BufOS(Buf);
+  if (printDeclUSRUncached(D, BufOS))
+    return true;
+  Ctx.cacheUSR(D, BufOS.str());
+  OS << BufOS.str();
+  return false;
+}
+
 bool ide::printAccessorUSR(const AbstractStorageDecl *D, AccessorKind AccKind,
                            llvm::raw_ostream &OS) {
   using namespace Mangle;
@@ -14,12 +14,14 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation that evicts the least
+//  recently used entries once the total cost of its values exceeds the cost
+//  limit.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
+#include <list>
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -33,12 +35,66 @@ struct DefaultCacheKey {
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
 
+struct DefaultCacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+};
+
 struct DefaultCache {
   llvm::sys::Mutex Mux;
   CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
+  /// The entries, from the most to the least recently used.
+  std::list<DefaultCacheEntry> LRU;
+  llvm::DenseMap<DefaultCacheKey, std::list<DefaultCacheEntry>::iterator>
+      Entries;
+  /// The number of retains of each value, including the one held by its
+  /// entry. A value is destroyed once this drops to zero.
+  llvm::DenseMap<void *, unsigned> RetainCounts;
+  size_t CostLimit = 0;
+  CacheStatistics Stats;
 
   explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
+
+  void retain(void *Value) {
+    auto &Count = RetainCounts[Value];
+    if (Count != 0) {
+      // The value was entered into the cache again while an earlier copy of
+      // it is still alive, e.g. the same reference-counted object.  The
+      // earlier copy keeps it alive, so let go of the new one.
+      CBs.valueDestroyCB(Value, nullptr);
+    }
+    ++Count;
+  }
+
+  void release(void *Value) {
+    auto Found = RetainCounts.find(Value);
+    assert(Found != RetainCounts.end() && "releasing unknown value");
+    if (--Found->second == 0) {
+      RetainCounts.erase(Found);
+      CBs.valueDestroyCB(Value, nullptr);
+    }
+  }
+
+  void removeEntry(std::list<DefaultCacheEntry>::iterator Entry) {
+    Entries.erase(DefaultCacheKey(Entry->Key, &CBs));
+    Stats.TotalCost -= Entry->Cost;
+    CBs.keyDestroyCB(Entry->Key, nullptr);
+    void *Value = Entry->Value;
+    LRU.erase(Entry);
+    release(Value);
+  }
+
+  /// Removes the least recently used entries until the total cost is within
+  /// the limit, keeping at least the most recently used one.
+  void evict() {
+    if (CostLimit == 0)
+      return;
+    while (Stats.TotalCost > CostLimit && LRU.size() > 1) {
+      removeEntry(std::prev(LRU.end()));
+      ++Stats.Evictions;
+    }
+  }
 };
 } // end anonymous namespace
 
@@ -75,18 +131,20 @@ void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
+  // Retain the value for the entry and for the caller before letting go of
+  // any previous value, which may be the same.
+  DCache.retain(Value);
+  ++DCache.RetainCounts[Value];
+
   DefaultCacheKey CKey(Key, &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
-
-  DCache.Entries[CKey] = Value;
+  if (Entry != DCache.Entries.end())
+    DCache.removeEntry(Entry->second);
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  DCache.LRU.push_front({Key, Value, Cost});
+  DCache.Entries[CKey] = DCache.LRU.begin();
+  DCache.Stats.TotalCost += Cost;
+  DCache.evict();
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
@@ -95,17 +153,23 @@ bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
+  if (Entry == DCache.Entries.end()) {
+    ++DCache.Stats.Misses;
+    return false;
   }
-  return false;
+
+  ++DCache.Stats.Hits;
+  auto LRUEntry = Entry->second;
+  DCache.LRU.splice(DCache.LRU.begin(), DCache.LRU, LRUEntry);
+  ++DCache.RetainCounts[LRUEntry->Value];
+  *Value_out = LRUEntry->Value;
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  DCache.release(Value);
 }
 
 bool CacheImpl::remove(const void *Key) {
@@ -114,24 +178,35 @@ bool CacheImpl::remove(const void *Key) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-    return true;
-  }
-  return false;
+  if (Entry == DCache.Entries.end())
+    return false;
+  DCache.removeEntry(Entry->second);
+  return true;
 }
 
 void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
-  }
-  DCache.Entries.clear();
+  while (!DCache.LRU.empty())
+    DCache.removeEntry(DCache.LRU.begin());
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  DCache.CostLimit = Limit;
+  DCache.evict();
+}
+
+CacheStatistics CacheImpl::getStatistics() {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  CacheStatistics Stats = DCache.Stats;
+  Stats.Count = DCache.LRU.size();
+  return Stats;
 }
 
 void CacheImpl::destroy() {
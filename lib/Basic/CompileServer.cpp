@@ -0,0 +1,178 @@
+//===--- CompileServer.cpp - Talking to a compile server ------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/CompileServer.h"
+#include "llvm/Config/config.h"
+#include <cerrno>
+#include <cstring>
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define SWIFT_COMPILE_SERVER_SUPPORTED 1
+#endif
+
+using namespace swift;
+using namespace swift::compile_server;
+
+static const size_t HeaderSize = 1 + sizeof(uint32_t);
+
+void compile_server::encodeMessage(MessageKind kind, StringRef payload,
+                                   std::string &result) {
+  uint32_t length = payload.size();
+  result.push_back(char(kind));
+  result.append(reinterpret_cast<const char *>(&length), sizeof(length));
+  result.append(payload.data(), payload.size());
+}
+
+bool MessageReader::next(MessageKind &kind, std::string &payload) {
+  if (Buffer.size() - Start < HeaderSize)
+    return false;
+  uint32_t length;
+  memcpy(&length, Buffer.data() + Start + 1, sizeof(length));
+  if (Buffer.size() - Start - HeaderSize < length)
+    return false;
+
+  kind = MessageKind(Buffer[Start]);
+  payload.assign(Buffer, Start + HeaderSize, length);
+  Start += HeaderSize + length;
+
+  // Drop what's been read once it's worth the copy.
+  if (Start == Buffer.size() || Start > 64 * 1024) {
+    Buffer.erase(0, Start);
+    Start = 0;
+  }
+  return true;
+}
+
+std::string compile_server::encodeRequest(StringRef workingDirectory,
+                                          ArrayRef<const char *> args) {
+  std::string result = workingDirectory.str();
+  result.push_back('\0');
+  for (const char *arg : args) {
+    result += arg;
+    result.push_back('\0');
+  }
+  return result;
+}
+
+bool compile_server::decodeRequest(StringRef payload,
+                                   std::string &workingDirectory,
+                                   std::vector<std::string> &args) {
+  if (payload.empty() || payload.back() != '\0')
+    return false;
+
+  SmallVector<StringRef, 64> strings;
+  payload.drop_back().split(strings, StringRef("\0", 1), /*MaxSplit=*/-1,
+                            /*KeepEmpty=*/true);
+  workingDirectory = strings.front().str();
+  if (workingDirectory.empty())
+    return false;
+  args.clear();
+  for (StringRef arg : llvm::makeArrayRef(strings).slice(1))
+    args.push_back(arg.str());
+  return true;
+}
+
+#if SWIFT_COMPILE_SERVER_SUPPORTED
+
+/// Writes all of \p bytes to \p fd, or fails.
+static bool writeAll(int fd, StringRef bytes) {
+  while (!bytes.empty()) {
+    ssize_t written = write(fd, bytes.data(), bytes.size());
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    bytes = bytes.drop_front(written);
+  }
+  return true;
+}
+
+/// Reads exactly \p size bytes from \p fd into \p buffer, or fails.
+static bool readAll(int fd, char *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t readBytes = read(fd, buffer, size);
+    if (readBytes < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (readBytes == 0)
+      return false;
+    buffer += readBytes;
+    size -= readBytes;
+  }
+  return true;
+}
+
+bool compile_server::writeMessage(int fd, MessageKind kind,
+                                  StringRef payload) {
+  std::string message;
+  encodeMessage(kind, payload, message);
+  return writeAll(fd, message);
+}
+
+bool compile_server::readMessage(int fd, MessageKind &kind,
+                                 std::string &payload) {
+  char header[HeaderSize];
+  if (!readAll(fd, header, HeaderSize))
+    return false;
+  uint32_t length;
+  memcpy(&length, header + 1, sizeof(length));
+  kind = MessageKind(header[0]);
+  payload.resize(length);
+  return length == 0 || readAll(fd, &payload[0], length);
+}
+
+int compile_server::connectToServer(StringRef socketPath) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path))
+    return -1;
+  memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  int result;
+  do {
+    result = connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+                     sizeof(address));
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+#else
+
+bool compile_server::writeMessage(int fd, MessageKind kind,
+                                  StringRef payload) {
+  return false;
+}
+
+bool compile_server::readMessage(int fd, MessageKind &kind,
+                                 std::string &payload) {
+  return false;
+}
+
+int compile_server::connectToServer(StringRef socketPath) {
+  return -1;
+}
+
+#endif
@@ -16,11 +16,27 @@
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/SmallString.h"
+#include <atomic>
 #include <cache.h>
 
 using namespace swift::sys;
 using llvm::StringRef;
 
+namespace {
+/// A libcache cache, along with the counters libcache doesn't keep itself.
+struct DarwinCache {
+  cache_t *Cache;
+  std::atomic<uint64_t> Hits{0};
+  std::atomic<uint64_t> Misses{0};
+
+  explicit DarwinCache(cache_t *Cache) : Cache(Cache) {}
+};
+} // end anonymous namespace
+
+static cache_t *getCache(CacheImpl::ImplTy Impl) {
+  return static_cast<DarwinCache*>(Impl)->Cache;
+}
+
 CacheImpl::ImplTy CacheImpl::create(StringRef Name, const CallBacks &CBs) {
   llvm::SmallString<32> NameBuf(Name);
   cache_attributes_t Attrs = {
@@ -39,32 +55,51 @@ CacheImpl::ImplTy CacheImpl::create(StringRef Name, const CallBacks &CBs) {
   cache_t *cache_out = nullptr;
   cache_create(NameBuf.c_str(), &Attrs, &cache_out);
   assert(cache_out);
-  return cache_out;
+  return new DarwinCache(cache_out);
 }
 
 void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
-  cache_set_and_retain(static_cast<cache_t*>(Impl), Key, Value, Cost);
+  cache_set_and_retain(getCache(Impl), Key, Value, Cost);
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
-  int Ret = cache_get_and_retain(static_cast<cache_t*>(Impl),
+  int Ret = cache_get_and_retain(getCache(Impl),
                                  const_cast<void*>(Key), Value_out);
+  if (Ret == 0)
+    ++static_cast<DarwinCache*>(Impl)->Hits;
+  else
+    ++static_cast<DarwinCache*>(Impl)->Misses;
   return Ret == 0;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  cache_release_value(static_cast<cache_t*>(Impl), Value);
+  cache_release_value(getCache(Impl), Value);
 }
 
 bool CacheImpl::remove(const void *Key) {
-  int Ret = cache_remove(static_cast<cache_t*>(Impl), const_cast<void*>(Key));
+  int Ret = cache_remove(getCache(Impl), const_cast<void*>(Key));
   return Ret == 0;
 }
 
 void CacheImpl::removeAll() {
-  cache_remove_all(static_cast<cache_t*>(Impl));
+  cache_remove_all(getCache(Impl));
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  // libcache also evicts under system memory pressure, so the limit is only
+  // used as a hint.
+  cache_set_cost_hint(getCache(Impl), Limit);
+}
+
+CacheStatistics CacheImpl::getStatistics() {
+  // libcache doesn't report its evictions or its contents.
+  CacheStatistics Stats;
+  Stats.Hits = static_cast<DarwinCache*>(Impl)->Hits;
+  Stats.Misses = static_cast<DarwinCache*>(Impl)->Misses;
+  return Stats;
 }
 
 void CacheImpl::destroy() {
-  cache_destroy(static_cast<cache_t*>(Impl));
+  cache_destroy(getCache(Impl));
+  delete static_cast<DarwinCache*>(Impl);
 }
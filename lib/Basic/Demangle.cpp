@@ -96,6 +96,92 @@ Node::~Node() {
   unreachable("bad payload kind");
 }
 
+/// A slab of arena memory. The nodes are allocated after the header.
+struct NodeFactory::Slab {
+  Slab *Previous;
+};
+
+/// The size of the slabs an arena allocates, unless a single allocation
+/// needs more.
+static const size_t NodeFactorySlabSize = 4096;
+
+NodeFactory::~NodeFactory() {
+  while (CurrentSlab) {
+    Slab *previous = CurrentSlab->Previous;
+    free(CurrentSlab);
+    CurrentSlab = previous;
+  }
+}
+
+void *NodeFactory::allocateSlow(size_t size, size_t alignment) {
+  size_t slabSize = std::max(NodeFactorySlabSize,
+                             sizeof(Slab) + size + alignment);
+  auto slab = static_cast<Slab *>(malloc(slabSize));
+  if (!slab)
+    unreachable("out of memory");
+  slab->Previous = CurrentSlab;
+  CurrentSlab = slab;
+  CurPtr = reinterpret_cast<char *>(slab + 1);
+  End = reinterpret_cast<char *>(slab) + slabSize;
+
+  void *result = allocate(size, alignment);
+  assert(result && "fresh slab too small");
+  return result;
+}
+
+namespace {
+/// A node made in a NodeFactory's arena. This only exists so that
+/// std::allocate_shared can reach Node's constructors.
+struct ArenaNode : Node {
+  template <typename... Args>
+  ArenaNode(Args &&... args) : Node(std::forward<Args>(args)...) {}
+};
+
+/// Allocates an arena node together with its shared_ptr control block.
+/// The memory is reclaimed along with the arena, so deallocation does
+/// nothing.
+template <typename T>
+struct ArenaAllocator {
+  typedef T value_type;
+
+  NodeFactory *Factory;
+
+  explicit ArenaAllocator(NodeFactory &factory) : Factory(&factory) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : Factory(other.Factory) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(Factory->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t) {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const {
+    return Factory == other.Factory;
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U> &other) const {
+    return Factory != other.Factory;
+  }
+};
+} // end anonymous namespace
+
+NodePointer NodeFactory::createNode(Node::Kind K) {
+  return std::allocate_shared<ArenaNode>(ArenaAllocator<ArenaNode>(*this), K);
+}
+NodePointer NodeFactory::createNode(Node::Kind K, Node::IndexType Index) {
+  return std::allocate_shared<ArenaNode>(ArenaAllocator<ArenaNode>(*this), K,
+                                         Index);
+}
+NodePointer NodeFactory::createNode(Node::Kind K, llvm::StringRef Text) {
+  return std::allocate_shared<ArenaNode>(ArenaAllocator<ArenaNode>(*this), K,
+                                         Text.str());
+}
+NodePointer NodeFactory::createNode(Node::Kind K, std::string &&Text) {
+  return std::allocate_shared<ArenaNode>(ArenaAllocator<ArenaNode>(*this), K,
+                                         std::move(Text));
+}
+
 namespace {
   struct FindPtr {
     FindPtr(Node *v) : Target(v) {}
@@ -292,8 +378,20 @@ static StringRef toString(ValueWitnessKind k) {
 class Demangler {
   std::vector<NodePointer> Substitutions;
   NameSource Mangled;
+
+  /// The arena to create nodes in, or null to allocate each on the heap.
+  NodeFactory *Factory;
+
+  template <typename... Args>
+  NodePointer createNode(Node::Kind K, Args &&... args) {
+    if (Factory)
+      return Factory->createNode(K, std::forward<Args>(args)...);
+    return NodeFactory::create(K, std::forward<Args>(args)...);
+  }
+
 public:  
-  Demangler(llvm::StringRef mangled) : Mangled(mangled) {}
+  Demangler(llvm::StringRef mangled, NodeFactory *factory = nullptr)
+    : Mangled(mangled), Factory(factory) {}
 
 /// Try to demangle a child node of the given kind.  If that fails,
 /// return; otherwise add it to the parent.
@@ -308,8 +406,8 @@ public:
 #define DEMANGLE_CHILD_AS_NODE_OR_RETURN(PARENT, CHILD_KIND) do {  \
     auto _kind = demangle##CHILD_KIND();                           \
     if (!_kind.hasValue()) return nullptr;                         \
-    (PARENT)->addChild(NodeFactory::create(Node::Kind::CHILD_KIND, \
-                                           unsigned(*_kind)));     \
+    (PARENT)->addChild(createNode(Node::Kind::CHILD_KIND,          \
+                                  unsigned(*_kind)));              \
   } while (false)
 
   /// Attempt to demangle the source string.  The root node will
@@ -322,7 +420,7 @@ public:
     if (!Mangled.nextIf("_T"))
       return nullptr;
 
-    NodePointer topLevel = NodeFactory::create(Node::Kind::Global);
+    NodePointer topLevel = createNode(Node::Kind::Global);
 
     // First demangle any specialization prefixes.
     if (Mangled.nextIf("TS")) {
@@ -339,24 +437,24 @@ public:
         return nullptr;
 
     } else if (Mangled.nextIf("To")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::ObjCAttribute));
+      topLevel->addChild(createNode(Node::Kind::ObjCAttribute));
     } else if (Mangled.nextIf("TO")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::NonObjCAttribute));
+      topLevel->addChild(createNode(Node::Kind::NonObjCAttribute));
     } else if (Mangled.nextIf("TD")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::DynamicAttribute));
+      topLevel->addChild(createNode(Node::Kind::DynamicAttribute));
     } else if (Mangled.nextIf("Td")) {
-      topLevel->addChild(NodeFactory::create(
+      topLevel->addChild(createNode(
                                    Node::Kind::DirectMethodReferenceAttribute));
     } else if (Mangled.nextIf("TV")) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::VTableAttribute));
+      topLevel->addChild(createNode(Node::Kind::VTableAttribute));
     }
 
     DEMANGLE_CHILD_OR_RETURN(topLevel, Global);
 
     // Add a suffix node if there's anything left unmangled.
     if (!Mangled.isEmpty()) {
-      topLevel->addChild(NodeFactory::create(Node::Kind::Suffix,
-                                             Mangled.getString()));
+      topLevel->addChild(createNode(Node::Kind::Suffix,
+                                    Mangled.getString()));
     }
 
     return topLevel;
@@ -468,43 +566,43 @@ private:
     if (Mangled.nextIf('M')) {
       if (Mangled.nextIf('P')) {
         auto pattern =
-            NodeFactory::create(Node::Kind::GenericTypeMetadataPattern);
+            createNode(Node::Kind::GenericTypeMetadataPattern);
         DEMANGLE_CHILD_OR_RETURN(pattern, Type);
         return pattern;
       }
       if (Mangled.nextIf('a')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::TypeMetadataAccessFunction);
+          createNode(Node::Kind::TypeMetadataAccessFunction);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         return accessor;
       }
       if (Mangled.nextIf('L')) {
-        auto cache = NodeFactory::create(Node::Kind::TypeMetadataLazyCache);
+        auto cache = createNode(Node::Kind::TypeMetadataLazyCache);
         DEMANGLE_CHILD_OR_RETURN(cache, Type);
         return cache;
       }
       if (Mangled.nextIf('m')) {
-        auto metaclass = NodeFactory::create(Node::Kind::Metaclass);
+        auto metaclass = createNode(Node::Kind::Metaclass);
         DEMANGLE_CHILD_OR_RETURN(metaclass, Type);
         return metaclass;
       }
       if (Mangled.nextIf('n')) {
         auto nominalType =
-            NodeFactory::create(Node::Kind::NominalTypeDescriptor);
+            createNode(Node::Kind::NominalTypeDescriptor);
         DEMANGLE_CHILD_OR_RETURN(nominalType, Type);
         return nominalType;
       }
       if (Mangled.nextIf('f')) {
-        auto metadata = NodeFactory::create(Node::Kind::FullTypeMetadata);
+        auto metadata = createNode(Node::Kind::FullTypeMetadata);
         DEMANGLE_CHILD_OR_RETURN(metadata, Type);
         return metadata;
       }
       if (Mangled.nextIf('p')) {
-        auto metadata = NodeFactory::create(Node::Kind::ProtocolDescriptor);
+        auto metadata = createNode(Node::Kind::ProtocolDescriptor);
         DEMANGLE_CHILD_OR_RETURN(metadata, ProtocolName);
         return metadata;
       }
-      auto metadata = NodeFactory::create(Node::Kind::TypeMetadata);
+      auto metadata = createNode(Node::Kind::TypeMetadata);
       DEMANGLE_CHILD_OR_RETURN(metadata, Type);
       return metadata;
     }
@@ -515,7 +613,7 @@ private:
       Node::Kind kind = Node::Kind::PartialApplyForwarder;
       if (Mangled.nextIf('o'))
         kind = Node::Kind::PartialApplyObjCForwarder;
-      auto forwarder = NodeFactory::create(kind);
+      auto forwarder = createNode(kind);
       if (Mangled.nextIf("__T"))
         DEMANGLE_CHILD_OR_RETURN(forwarder, Global);
       return forwarder;
@@ -523,7 +621,7 @@ private:
 
     // Top-level types, for various consumers.
     if (Mangled.nextIf('t')) {
-      auto type = NodeFactory::create(Node::Kind::TypeMangling);
+      auto type = createNode(Node::Kind::TypeMangling);
       DEMANGLE_CHILD_OR_RETURN(type, Type);
       return type;
     }
@@ -534,7 +632,7 @@ private:
       if (!w.hasValue())
         return nullptr;
       auto witness =
-        NodeFactory::create(Node::Kind::ValueWitness, unsigned(w.getValue()));
+        createNode(Node::Kind::ValueWitness, unsigned(w.getValue()));
       DEMANGLE_CHILD_OR_RETURN(witness, Type);
       return witness;
     }
@@ -542,69 +640,69 @@ private:
     // Offsets, value witness tables, and protocol witnesses.
     if (Mangled.nextIf('W')) {
       if (Mangled.nextIf('V')) {
-        auto witnessTable = NodeFactory::create(Node::Kind::ValueWitnessTable);
+        auto witnessTable = createNode(Node::Kind::ValueWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, Type);
         return witnessTable;
       }
       if (Mangled.nextIf('o')) {
         auto witnessTableOffset =
-            NodeFactory::create(Node::Kind::WitnessTableOffset);
+            createNode(Node::Kind::WitnessTableOffset);
         DEMANGLE_CHILD_OR_RETURN(witnessTableOffset, Entity);
         return witnessTableOffset;
       }
       if (Mangled.nextIf('v')) {
-        auto fieldOffset = NodeFactory::create(Node::Kind::FieldOffset);
+        auto fieldOffset = createNode(Node::Kind::FieldOffset);
         DEMANGLE_CHILD_AS_NODE_OR_RETURN(fieldOffset, Directness);
         DEMANGLE_CHILD_OR_RETURN(fieldOffset, Entity);
         return fieldOffset;
       }
       if (Mangled.nextIf('P')) {
         auto witnessTable =
-            NodeFactory::create(Node::Kind::ProtocolWitnessTable);
+            createNode(Node::Kind::ProtocolWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('G')) {
         auto witnessTable =
-            NodeFactory::create(Node::Kind::GenericProtocolWitnessTable);
+            createNode(Node::Kind::GenericProtocolWitnessTable);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('I')) {
-        auto witnessTable = NodeFactory::create(
+        auto witnessTable = createNode(
             Node::Kind::GenericProtocolWitnessTableInstantiationFunction);
         DEMANGLE_CHILD_OR_RETURN(witnessTable, ProtocolConformance);
         return witnessTable;
       }
       if (Mangled.nextIf('l')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::LazyProtocolWitnessTableAccessor);
+          createNode(Node::Kind::LazyProtocolWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         return accessor;
       }
       if (Mangled.nextIf('L')) {
         auto accessor =
-          NodeFactory::create(Node::Kind::LazyProtocolWitnessTableCacheVariable);
+          createNode(Node::Kind::LazyProtocolWitnessTableCacheVariable);
         DEMANGLE_CHILD_OR_RETURN(accessor, Type);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         return accessor;
       }
       if (Mangled.nextIf('a')) {
         auto tableTemplate =
-          NodeFactory::create(Node::Kind::ProtocolWitnessTableAccessor);
+          createNode(Node::Kind::ProtocolWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(tableTemplate, ProtocolConformance);
         return tableTemplate;
       }
       if (Mangled.nextIf('t')) {
-        auto accessor = NodeFactory::create(
+        auto accessor = createNode(
             Node::Kind::AssociatedTypeMetadataAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         DEMANGLE_CHILD_OR_RETURN(accessor, DeclName);
         return accessor;
       }
       if (Mangled.nextIf('T')) {
-        auto accessor = NodeFactory::create(
+        auto accessor = createNode(
             Node::Kind::AssociatedTypeWitnessTableAccessor);
         DEMANGLE_CHILD_OR_RETURN(accessor, ProtocolConformance);
         DEMANGLE_CHILD_OR_RETURN(accessor, DeclName);
@@ -617,19 +715,19 @@ private:
     // Other thunks.
     if (Mangled.nextIf('T')) {
       if (Mangled.nextIf('R')) {
-        auto thunk = NodeFactory::create(Node::Kind::ReabstractionThunkHelper);
+        auto thunk = createNode(Node::Kind::ReabstractionThunkHelper);
         if (!demangleReabstractSignature(thunk))
           return nullptr;
         return thunk;
       }
       if (Mangled.nextIf('r')) {
-        auto thunk = NodeFactory::create(Node::Kind::ReabstractionThunk);
+        auto thunk = createNode(Node::Kind::ReabstractionThunk);
         if (!demangleReabstractSignature(thunk))
           return nullptr;
         return thunk;
       }
       if (Mangled.nextIf('W')) {
-        NodePointer thunk = NodeFactory::create(Node::Kind::ProtocolWitness);
+        NodePointer thunk = createNode(Node::Kind::ProtocolWitness);
         DEMANGLE_CHILD_OR_RETURN(thunk, ProtocolConformance);
         // The entity is mangled in its own generic context.
         DEMANGLE_CHILD_OR_RETURN(thunk, Entity);
@@ -645,7 +743,7 @@ private:
   NodePointer demangleGenericSpecialization(NodePointer specialization) {
     while (!Mangled.nextIf('_')) {
       // Otherwise, we have another parameter. Demangle the type.
-      NodePointer param = NodeFactory::create(Node::Kind::GenericSpecializationParam);
+      NodePointer param = createNode(Node::Kind::GenericSpecializationParam);
       DEMANGLE_CHILD_OR_RETURN(param, Type);
 
       // Then parse any conformances until we find an underscore. Pop off the
@@ -663,11 +761,11 @@ private:
 
 /// TODO: This is an atrocity. Come up with a shorter name.
 #define FUNCSIGSPEC_CREATE_PARAM_KIND(kind)                                    \
-  NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParamKind,    \
-                      unsigned(FunctionSigSpecializationParamKind::kind))
+  createNode(Node::Kind::FunctionSignatureSpecializationParamKind,             \
+             unsigned(FunctionSigSpecializationParamKind::kind))
 #define FUNCSIGSPEC_CREATE_PARAM_PAYLOAD(payload)                              \
-  NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParamPayload, \
-                      payload)
+  createNode(Node::Kind::FunctionSignatureSpecializationParamPayload,          \
+             payload)
 
   bool demangleFuncSigSpecializationConstantProp(NodePointer parent) {
     // Then figure out what was actually constant propagated. First check if
@@ -773,8 +871,8 @@ private:
     while (!Mangled.nextIf('_')) {
       // Create the parameter.
       NodePointer param =
-        NodeFactory::create(Node::Kind::FunctionSignatureSpecializationParam,
-                            paramCount);
+        createNode(Node::Kind::FunctionSignatureSpecializationParam,
+                   paramCount);
 
       // First handle options.
       if (Mangled.nextIf("n_")) {
@@ -818,7 +916,7 @@ private:
         if (!Value)
           return nullptr;
 
-        auto result = NodeFactory::create(
+        auto result = createNode(
             Node::Kind::FunctionSignatureSpecializationParamKind, Value);
         if (!result)
           return nullptr;
@@ -838,36 +936,36 @@ private:
   NodePointer demangleSpecializedAttribute() {
     bool isNotReAbstracted = false;
     if (Mangled.nextIf("g") || (isNotReAbstracted = Mangled.nextIf("r"))) {
-      auto spec = NodeFactory::create(isNotReAbstracted ?
+      auto spec = createNode(isNotReAbstracted ?
                               Node::Kind::GenericSpecializationNotReAbstracted :
                               Node::Kind::GenericSpecialization);
 
       // Create a node if the specialization is externally inlineable.
       if (Mangled.nextIf("q")) {
         auto kind = Node::Kind::SpecializationIsFragile;
-        spec->addChild(NodeFactory::create(kind));
+        spec->addChild(createNode(kind));
       }
 
       // Create a node for the pass id.
-      spec->addChild(NodeFactory::create(Node::Kind::SpecializationPassID,
-                                         unsigned(Mangled.next() - 48)));
+      spec->addChild(createNode(Node::Kind::SpecializationPassID,
+                                unsigned(Mangled.next() - 48)));
 
       // And then mangle the generic specialization.
       return demangleGenericSpecialization(spec);
     }
     if (Mangled.nextIf("f")) {
       auto spec =
-          NodeFactory::create(Node::Kind::FunctionSignatureSpecialization);
+          createNode(Node::Kind::FunctionSignatureSpecialization);
 
       // Create a node if the specialization is externally inlineable.
       if (Mangled.nextIf("q")) {
         auto kind = Node::Kind::SpecializationIsFragile;
-        spec->addChild(NodeFactory::create(kind));
+        spec->addChild(createNode(kind));
       }
 
       // Add the pass id.
-      spec->addChild(NodeFactory::create(Node::Kind::SpecializationPassID,
-                                         unsigned(Mangled.next() - 48)));
+      spec->addChild(createNode(Node::Kind::SpecializationPassID,
+                                unsigned(Mangled.next() - 48)));
 
       // Then perform the function signature specialization.
       return demangleFunctionSignatureSpecialization(spec);
@@ -887,7 +985,7 @@ private:
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
 
-      NodePointer localName = NodeFactory::create(Node::Kind::LocalDeclName);
+      NodePointer localName = createNode(Node::Kind::LocalDeclName);
       localName->addChild(std::move(discriminator));
       localName->addChild(std::move(name));
       return localName;
@@ -899,7 +997,7 @@ private:
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
 
-      auto privateName = NodeFactory::create(Node::Kind::PrivateDeclName);
+      auto privateName = createNode(Node::Kind::PrivateDeclName);
       privateName->addChildren(std::move(discriminator), std::move(name));
       return privateName;
     }
@@ -985,7 +1083,7 @@ private:
       identifier = opDecodeBuffer;
     }
     
-    return NodeFactory::create(*kind, identifier);
+    return createNode(*kind, identifier);
   }
 
   bool demangleIndex(Node::IndexType &natural) {
@@ -1007,13 +1105,13 @@ private:
     Node::IndexType index;
     if (!demangleIndex(index))
       return nullptr;
-    return NodeFactory::create(kind, index);
+    return createNode(kind, index);
   }
 
   NodePointer createSwiftType(Node::Kind typeKind, StringRef name) {
-    NodePointer type = NodeFactory::create(typeKind);
-    type->addChild(NodeFactory::create(Node::Kind::Module, STDLIB_NAME));
-    type->addChild(NodeFactory::create(Node::Kind::Identifier, name));
+    NodePointer type = createNode(typeKind);
+    type->addChild(createNode(Node::Kind::Module, STDLIB_NAME));
+    type->addChild(createNode(Node::Kind::Identifier, name));
     return type;
   }
 
@@ -1022,9 +1120,9 @@ private:
     if (!Mangled)
       return nullptr;
     if (Mangled.nextIf('o'))
-      return NodeFactory::create(Node::Kind::Module, MANGLING_MODULE_OBJC);
+      return createNode(Node::Kind::Module, MANGLING_MODULE_OBJC);
     if (Mangled.nextIf('C'))
-      return NodeFactory::create(Node::Kind::Module, MANGLING_MODULE_C);
+      return createNode(Node::Kind::Module, MANGLING_MODULE_C);
     if (Mangled.nextIf('a'))
       return createSwiftType(Node::Kind::Structure, "Array");
     if (Mangled.nextIf('b'))
@@ -1063,7 +1161,7 @@ private:
 
   NodePointer demangleModule() {
     if (Mangled.nextIf('s')) {
-      return NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      return createNode(Node::Kind::Module, STDLIB_NAME);
     }
     if (Mangled.nextIf('S')) {
       NodePointer module = demangleSubstitutionIndex();
@@ -1087,7 +1185,7 @@ private:
     auto name = demangleDeclName();
     if (!name) return nullptr;
 
-    auto decl = NodeFactory::create(kind);
+    auto decl = createNode(kind);
     decl->addChild(context);
     decl->addChild(name);
     Substitutions.push_back(decl);
@@ -1098,7 +1196,7 @@ private:
     NodePointer proto = demangleProtocolNameImpl();
     if (!proto) return nullptr;
 
-    NodePointer type = NodeFactory::create(Node::Kind::Type);
+    NodePointer type = createNode(Node::Kind::Type);
     type->addChild(proto);
     return type;
   }
@@ -1107,7 +1205,7 @@ private:
     NodePointer name = demangleDeclName();
     if (!name) return nullptr;
 
-    auto proto = NodeFactory::create(Node::Kind::Protocol);
+    auto proto = createNode(Node::Kind::Protocol);
     proto->addChild(std::move(context));
     proto->addChild(std::move(name));
     Substitutions.push_back(proto);
@@ -1132,7 +1230,7 @@ private:
     }
 
     if (Mangled.nextIf('s')) {
-      NodePointer stdlib = NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      NodePointer stdlib = createNode(Node::Kind::Module, STDLIB_NAME);
 
       return demangleProtocolNameGivenContext(stdlib);
     }
@@ -1161,7 +1259,7 @@ private:
     // context ::= 'e' module context generic-signature (constrained extension)
     if (!Mangled) return nullptr;
     if (Mangled.nextIf('E')) {
-      NodePointer ext = NodeFactory::create(Node::Kind::Extension);
+      NodePointer ext = createNode(Node::Kind::Extension);
       NodePointer def_module = demangleModule();
       if (!def_module) return nullptr;
       NodePointer type = demangleContext();
@@ -1171,7 +1269,7 @@ private:
       return ext;
     }
     if (Mangled.nextIf('e')) {
-      NodePointer ext = NodeFactory::create(Node::Kind::Extension);
+      NodePointer ext = createNode(Node::Kind::Extension);
       NodePointer def_module = demangleModule();
       if (!def_module) return nullptr;
       NodePointer sig = demangleGenericSignature();
@@ -1190,15 +1288,15 @@ private:
     if (Mangled.nextIf('S'))
       return demangleSubstitutionIndex();
     if (Mangled.nextIf('s'))
-      return NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      return createNode(Node::Kind::Module, STDLIB_NAME);
     if (isStartOfEntity(Mangled.peek()))
       return demangleEntity();
     return demangleModule();
   }
   
   NodePointer demangleProtocolList() {
-    NodePointer proto_list = NodeFactory::create(Node::Kind::ProtocolList);
-    NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+    NodePointer proto_list = createNode(Node::Kind::ProtocolList);
+    NodePointer type_list = createNode(Node::Kind::TypeList);
     proto_list->addChild(type_list);
     while (!Mangled.nextIf('_')) {
       NodePointer proto = demangleProtocolName();
@@ -1220,7 +1318,7 @@ private:
     if (!context)
       return nullptr;
     NodePointer proto_conformance =
-        NodeFactory::create(Node::Kind::ProtocolConformance);
+        createNode(Node::Kind::ProtocolConformance);
     proto_conformance->addChild(type);
     proto_conformance->addChild(protocol);
     proto_conformance->addChild(context);
@@ -1349,7 +1447,7 @@ private:
       if (!name) return nullptr;
     }
 
-    NodePointer entity = NodeFactory::create(entityKind);
+    NodePointer entity = createNode(entityKind);
     entity->addChild(context);
 
     if (name) entity->addChild(name);
@@ -1361,7 +1459,7 @@ private:
     }
     
     if (isStatic) {
-      auto staticNode = NodeFactory::create(Node::Kind::Static);
+      auto staticNode = createNode(Node::Kind::Static);
       staticNode->addChild(entity);
       return staticNode;
     }
@@ -1371,10 +1469,10 @@ private:
 
   NodePointer demangleArchetypeRef(Node::IndexType depth, Node::IndexType i) {
     // FIXME: Name won't match demangled context generic signatures correctly.
-    auto ref = NodeFactory::create(Node::Kind::ArchetypeRef,
-                                   archetypeName(i, depth));
-    ref->addChild(NodeFactory::create(Node::Kind::Index, depth));
-    ref->addChild(NodeFactory::create(Node::Kind::Index, i));
+    auto ref = createNode(Node::Kind::ArchetypeRef,
+                          archetypeName(i, depth));
+    ref->addChild(createNode(Node::Kind::Index, depth));
+    ref->addChild(createNode(Node::Kind::Index, i));
     return ref;
   }
 
@@ -1382,10 +1480,10 @@ private:
     DemanglerPrinter PrintName;
     PrintName << archetypeName(index, depth);
 
-    auto paramTy = NodeFactory::create(Node::Kind::DependentGenericParamType,
-                                       std::move(PrintName).str());
-    paramTy->addChild(NodeFactory::create(Node::Kind::Index, depth));
-    paramTy->addChild(NodeFactory::create(Node::Kind::Index, index));
+    auto paramTy = createNode(Node::Kind::DependentGenericParamType,
+                              std::move(PrintName).str());
+    paramTy->addChild(createNode(Node::Kind::Index, depth));
+    paramTy->addChild(createNode(Node::Kind::Index, index));
 
     return paramTy;
   }
@@ -1438,7 +1536,7 @@ private:
       Substitutions.push_back(assocTy);
     }
 
-    NodePointer depTy = NodeFactory::create(Node::Kind::DependentMemberType);
+    NodePointer depTy = createNode(Node::Kind::DependentMemberType);
     depTy->addChild(base);
     depTy->addChild(assocTy);
     return depTy;
@@ -1450,7 +1548,7 @@ private:
     if (!base)
       return nullptr;
 
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = createNode(Node::Kind::Type);
     nodeType->addChild(base);
 
     // Demangle the associated type name.
@@ -1465,7 +1563,7 @@ private:
 
     // Demangle the associated type chain.
     while (!Mangled.nextIf('_')) {
-      NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+      NodePointer nodeType = createNode(Node::Kind::Type);
       nodeType->addChild(base);
       
       base = demangleDependentMemberTypeName(nodeType);
@@ -1509,19 +1607,19 @@ private:
     if (!type)
       return nullptr;
 
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = createNode(Node::Kind::Type);
     nodeType->addChild(type);
     return nodeType;
   }
 
   NodePointer demangleGenericSignature() {
-    auto sig = NodeFactory::create(Node::Kind::DependentGenericSignature);
+    auto sig = createNode(Node::Kind::DependentGenericSignature);
     // First read in the parameter counts at each depth.
     Node::IndexType count = ~(Node::IndexType)0;
     
     auto addCount = [&]{
       auto countNode =
-        NodeFactory::create(Node::Kind::DependentGenericParamCount, count);
+        createNode(Node::Kind::DependentGenericParamCount, count);
       sig->addChild(countNode);
     };
     
@@ -1560,14 +1658,14 @@ private:
 
   NodePointer demangleMetatypeRepresentation() {
     if (Mangled.nextIf('t'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation, "@thin");
+      return createNode(Node::Kind::MetatypeRepresentation, "@thin");
 
     if (Mangled.nextIf('T'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation, "@thick");
+      return createNode(Node::Kind::MetatypeRepresentation, "@thick");
 
     if (Mangled.nextIf('o'))
-      return NodeFactory::create(Node::Kind::MetatypeRepresentation,
-                                 "@objc_metatype");
+      return createNode(Node::Kind::MetatypeRepresentation,
+                        "@objc_metatype");
 
     unreachable("Unhandled metatype representation");
   }
@@ -1579,7 +1677,7 @@ private:
     if (Mangled.nextIf('z')) {
       NodePointer second = demangleType();
       if (!second) return nullptr;
-      auto reqt = NodeFactory::create(
+      auto reqt = createNode(
           Node::Kind::DependentGenericSameTypeRequirement);
       reqt->addChild(constrainedType);
       reqt->addChild(second);
@@ -1614,14 +1712,14 @@ private:
       } else {
         return nullptr;
       }
-      constraint = NodeFactory::create(Node::Kind::Type);
+      constraint = createNode(Node::Kind::Type);
       constraint->addChild(typeName);
     } else {
       constraint = demangleProtocolName();
       if (!constraint)
         return nullptr;
     }
-    auto reqt = NodeFactory::create(
+    auto reqt = createNode(
                           Node::Kind::DependentGenericConformanceRequirement);
     reqt->addChild(constrainedType);
     reqt->addChild(constraint);
@@ -1630,7 +1728,7 @@ private:
   
   NodePointer demangleArchetypeType() {
     auto makeSelfType = [&](NodePointer proto) -> NodePointer {
-      auto selfType = NodeFactory::create(Node::Kind::SelfTypeRef);
+      auto selfType = createNode(Node::Kind::SelfTypeRef);
       selfType->addChild(proto);
       Substitutions.push_back(selfType);
       return selfType;
@@ -1639,7 +1737,7 @@ private:
     auto makeAssociatedType = [&](NodePointer root) -> NodePointer {
       NodePointer name = demangleIdentifier();
       if (!name) return nullptr;
-      auto assocType = NodeFactory::create(Node::Kind::AssociatedTypeRef);
+      auto assocType = createNode(Node::Kind::AssociatedTypeRef);
       assocType->addChild(root);
       assocType->addChild(name);
       Substitutions.push_back(assocType);
@@ -1666,7 +1764,7 @@ private:
         return makeAssociatedType(sub);
     }
     if (Mangled.nextIf('s')) {
-      NodePointer stdlib = NodeFactory::create(Node::Kind::Module, STDLIB_NAME);
+      NodePointer stdlib = createNode(Node::Kind::Module, STDLIB_NAME);
       return makeAssociatedType(stdlib);
     }
     if (Mangled.nextIf('d')) {
@@ -1681,12 +1779,12 @@ private:
       NodePointer index = demangleIndexAsNode();
       if (!index)
         return nullptr;
-      NodePointer decl_ctx = NodeFactory::create(Node::Kind::DeclContext);
+      NodePointer decl_ctx = createNode(Node::Kind::DeclContext);
       NodePointer ctx = demangleContext();
       if (!ctx)
         return nullptr;
       decl_ctx->addChild(ctx);
-      auto qual_atype = NodeFactory::create(Node::Kind::QualifiedArchetype);
+      auto qual_atype = createNode(Node::Kind::QualifiedArchetype);
       qual_atype->addChild(index);
       qual_atype->addChild(decl_ctx);
       return qual_atype;
@@ -1698,13 +1796,13 @@ private:
   }
 
   NodePointer demangleTuple(IsVariadic isV) {
-    NodePointer tuple = NodeFactory::create(
+    NodePointer tuple = createNode(
         isV == IsVariadic::yes ? Node::Kind::VariadicTuple
                                : Node::Kind::NonVariadicTuple);
     while (!Mangled.nextIf('_')) {
       if (!Mangled)
         return nullptr;
-      NodePointer elt = NodeFactory::create(Node::Kind::TupleElement);
+      NodePointer elt = createNode(Node::Kind::TupleElement);
 
       if (isStartOfIdentifier(Mangled.peek())) {
         NodePointer label = demangleIdentifier(Node::Kind::TupleElementName);
@@ -1724,7 +1822,7 @@ private:
   }
   
   NodePointer postProcessReturnTypeNode (NodePointer out_args) {
-    NodePointer out_node = NodeFactory::create(Node::Kind::ReturnType);
+    NodePointer out_node = createNode(Node::Kind::ReturnType);
     out_node->addChild(out_args);
     return out_node;
   }
@@ -1733,7 +1831,7 @@ private:
     NodePointer type = demangleTypeImpl();
     if (!type)
       return nullptr;
-    NodePointer nodeType = NodeFactory::create(Node::Kind::Type);
+    NodePointer nodeType = createNode(Node::Kind::Type);
     nodeType->addChild(type);
     return nodeType;
   }
@@ -1750,13 +1848,13 @@ private:
     NodePointer out_args = demangleType();
     if (!out_args)
       return nullptr;
-    NodePointer block = NodeFactory::create(kind);
+    NodePointer block = createNode(kind);
     
     if (throws) {
-      block->addChild(NodeFactory::create(Node::Kind::ThrowsAnnotation));
+      block->addChild(createNode(Node::Kind::ThrowsAnnotation));
     }
     
-    NodePointer in_node = NodeFactory::create(Node::Kind::ArgumentTuple);
+    NodePointer in_node = createNode(Node::Kind::ArgumentTuple);
     block->addChild(in_node);
     in_node->addChild(in_args);
     block->addChild(postProcessReturnTypeNode(out_args));
@@ -1772,15 +1870,15 @@ private:
         return nullptr;
       c = Mangled.next();
       if (c == 'b')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.BridgeObject");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.BridgeObject");
       if (c == 'B')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.UnsafeValueBuffer");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.UnsafeValueBuffer");
       if (c == 'f') {
         Node::IndexType size;
         if (demangleBuiltinSize(size)) {
-          return NodeFactory::create(
+          return createNode(
               Node::Kind::BuiltinTypeName,
               std::move(DemanglerPrinter() << "Builtin.Float" << size).str());
         }
@@ -1788,7 +1886,7 @@ private:
       if (c == 'i') {
         Node::IndexType size;
         if (demangleBuiltinSize(size)) {
-          return NodeFactory::create(
+          return createNode(
               Node::Kind::BuiltinTypeName,
               (DemanglerPrinter() << "Builtin.Int" << size).str());
         }
@@ -1802,7 +1900,7 @@ private:
             Node::IndexType size;
             if (!demangleBuiltinSize(size))
               return nullptr;
-            return NodeFactory::create(
+            return createNode(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter() << "Builtin.Vec" << elts << "xInt" << size)
                     .str());
@@ -1811,30 +1909,30 @@ private:
             Node::IndexType size;
             if (!demangleBuiltinSize(size))
               return nullptr;
-            return NodeFactory::create(
+            return createNode(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter() << "Builtin.Vec" << elts << "xFloat"
                                     << size).str());
           }
           if (Mangled.nextIf('p'))
-            return NodeFactory::create(
+            return createNode(
                 Node::Kind::BuiltinTypeName,
                 (DemanglerPrinter() << "Builtin.Vec" << elts << "xRawPointer")
                     .str());
         }
       }
       if (c == 'O')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.UnknownObject");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.UnknownObject");
       if (c == 'o')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.NativeObject");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.NativeObject");
       if (c == 'p')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.RawPointer");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.RawPointer");
       if (c == 'w')
-        return NodeFactory::create(Node::Kind::BuiltinTypeName,
-                                     "Builtin.Word");
+        return createNode(Node::Kind::BuiltinTypeName,
+                            "Builtin.Word");
       return nullptr;
     }
     if (c == 'a')
@@ -1851,7 +1949,7 @@ private:
       if (!type)
         return nullptr;
 
-      NodePointer dynamicSelf = NodeFactory::create(Node::Kind::DynamicSelf);
+      NodePointer dynamicSelf = createNode(Node::Kind::DynamicSelf);
       dynamicSelf->addChild(type);
       return dynamicSelf;
     }
@@ -1860,7 +1958,7 @@ private:
         return nullptr;
       if (!Mangled.nextIf('R'))
         return nullptr;
-      return NodeFactory::create(Node::Kind::ErrorType, std::string());
+      return createNode(Node::Kind::ErrorType, std::string());
     }
     if (c == 'F') {
       return demangleFunctionType(Node::Kind::FunctionType);
@@ -1872,7 +1970,7 @@ private:
       NodePointer unboundType = demangleType();
       if (!unboundType)
         return nullptr;
-      NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+      NodePointer type_list = createNode(Node::Kind::TypeList);
       while (!Mangled.nextIf('_')) {
         NodePointer type = demangleType();
         if (!type)
@@ -1896,7 +1994,7 @@ private:
           return nullptr;
       }
       NodePointer type_application =
-          NodeFactory::create(bound_type_kind);
+          createNode(bound_type_kind);
       type_application->addChild(unboundType);
       type_application->addChild(type_list);
       return type_application;
@@ -1906,7 +2004,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer boxType = NodeFactory::create(Node::Kind::SILBoxType);
+        NodePointer boxType = createNode(Node::Kind::SILBoxType);
         boxType->addChild(type);
         return boxType;
       }
@@ -1918,7 +2016,7 @@ private:
       NodePointer type = demangleType();
       if (!type)
         return nullptr;
-      NodePointer metatype = NodeFactory::create(Node::Kind::Metatype);
+      NodePointer metatype = createNode(Node::Kind::Metatype);
       metatype->addChild(type);
       return metatype;
     }
@@ -1930,7 +2028,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer metatype = NodeFactory::create(Node::Kind::Metatype);
+        NodePointer metatype = createNode(Node::Kind::Metatype);
         metatype->addChild(metatypeRepr);
         metatype->addChild(type);
         return metatype;
@@ -1940,7 +2038,7 @@ private:
       if (Mangled.nextIf('M')) {
         NodePointer type = demangleType();
         if (!type) return nullptr;
-        auto metatype = NodeFactory::create(Node::Kind::ExistentialMetatype);
+        auto metatype = createNode(Node::Kind::ExistentialMetatype);
         metatype->addChild(type);
         return metatype;
       }
@@ -1957,7 +2055,7 @@ private:
           NodePointer type = demangleType();
           if (!type) return nullptr;
 
-          auto metatype = NodeFactory::create(Node::Kind::ExistentialMetatype);
+          auto metatype = createNode(Node::Kind::ExistentialMetatype);
           metatype->addChild(metatypeRepr);
           metatype->addChild(type);
           return metatype;
@@ -1983,7 +2081,7 @@ private:
       return demangleAssociatedTypeCompound();
     }
     if (c == 'R') {
-      NodePointer inout = NodeFactory::create(Node::Kind::InOut);
+      NodePointer inout = createNode(Node::Kind::InOut);
       NodePointer type = demangleTypeImpl();
       if (!type)
         return nullptr;
@@ -2005,7 +2103,7 @@ private:
       NodePointer sub = demangleType();
       if (!sub) return nullptr;
       NodePointer dependentGenericType
-        = NodeFactory::create(Node::Kind::DependentGenericType);
+        = createNode(Node::Kind::DependentGenericType);
       dependentGenericType->addChild(sig);
       dependentGenericType->addChild(sub);
       return dependentGenericType;
@@ -2018,7 +2116,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer unowned = NodeFactory::create(Node::Kind::Unowned);
+        NodePointer unowned = createNode(Node::Kind::Unowned);
         unowned->addChild(type);
         return unowned;
       }
@@ -2026,7 +2124,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer unowned = NodeFactory::create(Node::Kind::Unmanaged);
+        NodePointer unowned = createNode(Node::Kind::Unmanaged);
         unowned->addChild(type);
         return unowned;
       }
@@ -2034,7 +2132,7 @@ private:
         NodePointer type = demangleType();
         if (!type)
           return nullptr;
-        NodePointer weak = NodeFactory::create(Node::Kind::Weak);
+        NodePointer weak = createNode(Node::Kind::Weak);
         weak->addChild(type);
         return weak;
       }
@@ -2081,7 +2179,7 @@ private:
   // impl-function-attribute ::= 'N'             // noreturn
   // impl-function-attribute ::= 'G'             // generic
   NodePointer demangleImplFunctionType() {
-    NodePointer type = NodeFactory::create(Node::Kind::ImplFunctionType);
+    NodePointer type = createNode(Node::Kind::ImplFunctionType);
 
     if (!demangleImplCalleeConvention(type))
       return nullptr;
@@ -2176,13 +2274,13 @@ private:
     if (attr.empty()) {
       return false;
     }
-    type->addChild(NodeFactory::create(Node::Kind::ImplConvention, attr));
+    type->addChild(createNode(Node::Kind::ImplConvention, attr));
     return true;
   }
 
   void addImplFunctionAttribute(NodePointer parent, StringRef attr,
                          Node::Kind kind = Node::Kind::ImplFunctionAttribute) {
-    parent->addChild(NodeFactory::create(kind, attr));
+    parent->addChild(createNode(kind, attr));
   }
 
   // impl-parameter ::= impl-convention type
@@ -2228,9 +2326,9 @@ private:
     auto type = demangleType();
     if (!type) return nullptr;
 
-    NodePointer node = NodeFactory::create(kind);
-    node->addChild(NodeFactory::create(Node::Kind::ImplConvention,
-                                       convention));
+    NodePointer node = createNode(kind);
+    node->addChild(createNode(Node::Kind::ImplConvention,
+                              convention));
     node->addChild(type);
     
     return node;
@@ -2254,6 +2352,24 @@ swift::Demangle::demangleTypeAsNode(const char *MangledName,
   return demangler.demangleTypeName();
 }
 
+NodePointer
+swift::Demangle::demangleSymbolAsNode(const char *MangledName,
+                                      size_t MangledNameLength,
+                                      NodeFactory &Factory,
+                                      const DemangleOptions &Options) {
+  Demangler demangler(StringRef(MangledName, MangledNameLength), &Factory);
+  return demangler.demangleTopLevel();
+}
+
+NodePointer
+swift::Demangle::demangleTypeAsNode(const char *MangledName,
+                                    size_t MangledNameLength,
+                                    NodeFactory &Factory,
+                                    const DemangleOptions &Options) {
+  Demangler demangler(StringRef(MangledName, MangledNameLength), &Factory);
+  return demangler.demangleTypeName();
+}
+
 namespace {
 class NodePrinter {
 private:
@@ -3682,7 +3798,10 @@ std::string Demangle::demangleSymbolAsString(const char *MangledName,
                                              size_t MangledNameLength,
                                              const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
-  auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Options);
+  // The tree is only needed until it's printed.
+  NodeFactory Factory;
+  auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Factory,
+                               Options);
   if (!root) return mangled.str();
 
   std::string demangling = nodeToString(std::move(root), Options);
@@ -3695,7 +3814,10 @@ std::string Demangle::demangleTypeAsString(const char *MangledName,
                                            size_t MangledNameLength,
                                            const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
-  auto root = demangleTypeAsNode(MangledName, MangledNameLength, Options);
+  // The tree is only needed until it's printed.
+  NodeFactory Factory;
+  auto root = demangleTypeAsNode(MangledName, MangledNameLength, Factory,
+                               Options);
   if (!root) return mangled.str();
   
   std::string demangling = nodeToString(std::move(root), Options);
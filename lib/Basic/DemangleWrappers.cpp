@@ -84,6 +84,17 @@ swift::demangle_wrappers::demangleSymbolAsNode(llvm::StringRef MangledName,
                                                MangledName.size(), Options);
 }
 
+NodePointer
+swift::demangle_wrappers::demangleSymbolAsNode(llvm::StringRef MangledName,
+                                               Demangle::NodeFactory &Factory,
+                                               const DemangleOptions &Options) {
+  PrettyStackTraceStringAction prettyStackTrace("demangling string",
+                                                MangledName);
+  return swift::Demangle::demangleSymbolAsNode(MangledName.data(),
+                                               MangledName.size(), Factory,
+                                               Options);
+}
+
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options) {
   PrettyStackTraceNode trace("printing", Root.get());
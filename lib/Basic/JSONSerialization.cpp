@@ -152,72 +152,77 @@ void Output::endBitSetScalar() {
   Stream << ']';
 }
 
-void Output::scalarString(StringRef &S, bool MustQuote) {
-  if (MustQuote) {
-    Stream << '"';
-    for (unsigned char c : S) {
-      // According to the JSON standard, the following characters must be
-      // escaped:
-      //   - Quotation mark (U+0022)
-      //   - Reverse solidus (U+005C)
-      //   - Control characters (U+0000 to U+001F)
-      // We need to check for these and escape them if present.
-      //
-      // Since these are represented by a single byte in UTF8 (and will not be
-      // present in any multi-byte UTF8 representations), we can just switch on
-      // the value of the current byte.
-      //
-      // Any other bytes present in the string should therefore be emitted
-      // as-is, without any escaping.
-      switch (c) {
-      // First, check for characters for which JSON has custom escape sequences.
-      case '"':
-        Stream << '\\' << '"';
-        break;
-      case '\\':
-        Stream << '\\' << '\\';
-        break;
-      case '/':
-        Stream << '\\' << '/';
-        break;
-      case '\b':
-        Stream << '\\' << 'b';
-        break;
-      case '\f':
-        Stream << '\\' << 'f';
-        break;
-      case '\n':
-        Stream << '\\' << 'n';
-        break;
-      case '\r':
-        Stream << '\\' << 'r';
-        break;
-      case '\t':
-        Stream << '\\' << 't';
-        break;
-      default:
-        // Otherwise, check to see if the current byte is a control character.
-        if (c <= '\x1F') {
-          // Since we have a control character, we need to escape it using
-          // JSON's only valid escape sequence: \uxxxx (where x is a hex digit).
-
-          // The upper two digits for control characters are always 00.
-          Stream << "\\u00";
-
-          // Convert the current character into hexadecimal digits.
-          Stream << llvm::hexdigit((c >> 4) & 0xF);
-          Stream << llvm::hexdigit((c >> 0) & 0xF);
-        } else {
-          // This isn't a control character, so we don't need to escape it.
-          // As a result, emit it directly; if it's part of a multi-byte UTF8
-          // representation, all bytes will be emitted in this fashion.
-          Stream << c;
-        }
-        break;
-      }
+void swift::json::writeEscapedString(llvm::raw_ostream &OS, StringRef S) {
+  OS << '"';
+  // Most characters are written as they are, so write the runs between the
+  // characters which need escaping in one go.
+  const char *RunStart = S.begin();
+  for (const char *I = S.begin(), *E = S.end(); I != E; ++I) {
+    unsigned char c = *I;
+    // According to the JSON standard, the following characters must be
+    // escaped:
+    //   - Quotation mark (U+0022)
+    //   - Reverse solidus (U+005C)
+    //   - Control characters (U+0000 to U+001F)
+    // We need to check for these and escape them if present.
+    //
+    // Since these are represented by a single byte in UTF8 (and will not be
+    // present in any multi-byte UTF8 representations), we can just switch on
+    // the value of the current byte.
+    //
+    // Any other bytes present in the string should therefore be emitted
+    // as-is, without any escaping.
+    if (c > '\x1F' && c != '"' && c != '\\' && c != '/')
+      continue;
+
+    OS.write(RunStart, I - RunStart);
+    RunStart = I + 1;
+    switch (c) {
+    // First, check for characters for which JSON has custom escape sequences.
+    case '"':
+      OS << '\\' << '"';
+      break;
+    case '\\':
+      OS << '\\' << '\\';
+      break;
+    case '/':
+      OS << '\\' << '/';
+      break;
+    case '\b':
+      OS << '\\' << 'b';
+      break;
+    case '\f':
+      OS << '\\' << 'f';
+      break;
+    case '\n':
+      OS << '\\' << 'n';
+      break;
+    case '\r':
+      OS << '\\' << 'r';
+      break;
+    case '\t':
+      OS << '\\' << 't';
+      break;
+    default:
+      // Since we have a control character, we need to escape it using
+      // JSON's only valid escape sequence: \uxxxx (where x is a hex digit).
+
+      // The upper two digits for control characters are always 00.
+      OS << "\\u00";
+
+      // Convert the current character into hexadecimal digits.
+      OS << llvm::hexdigit((c >> 4) & 0xF);
+      OS << llvm::hexdigit((c >> 0) & 0xF);
+      break;
     }
-    Stream << '"';
   }
+  OS.write(RunStart, S.end() - RunStart);
+  OS << '"';
+}
+
+void Output::scalarString(StringRef &S, bool MustQuote) {
+  if (MustQuote)
+    writeEscapedString(Stream, S);
   else
     Stream << S;
 }
@@ -294,3 +299,86 @@ void ScalarTraits<double>::output(const double &Val, raw_ostream &Out) {
 void ScalarTraits<float>::output(const float &Val, raw_ostream &Out) {
   Out << llvm::format("%g", Val);
 }
+
+//===----------------------------------------------------------------------===//
+//  Writer
+//===----------------------------------------------------------------------===//
+
+void Writer::newlineAndIndent() {
+  Stream << '\n';
+  Stream.indent(Stack.size() * 2);
+}
+
+void Writer::beginValue() {
+  if (AfterKey) {
+    AfterKey = false;
+    return;
+  }
+  if (Stack.empty())
+    return;
+  assert(Stack.back().IsArray && "values in objects need a key");
+  if (Stack.back().HasElements) {
+    Stream << ',';
+    if (PrettyPrint)
+      Stream << '\n';
+  }
+  if (PrettyPrint)
+    Stream.indent(Stack.size() * 2);
+  Stack.back().HasElements = true;
+}
+
+void Writer::key(StringRef Key) {
+  assert(!Stack.empty() && !Stack.back().IsArray && !AfterKey &&
+         "keys are only allowed in objects");
+  if (Stack.back().HasElements) {
+    Stream << ',';
+    if (PrettyPrint)
+      Stream << '\n';
+  }
+  if (PrettyPrint)
+    Stream.indent(Stack.size() * 2);
+  Stack.back().HasElements = true;
+  writeEscapedString(Stream, Key);
+  Stream << ':';
+  if (PrettyPrint)
+    Stream << ' ';
+  AfterKey = true;
+}
+
+void Writer::beginObject() {
+  beginValue();
+  Stream << '{';
+  if (PrettyPrint)
+    Stream << '\n';
+  Stack.push_back({/*IsArray=*/false, /*HasElements=*/false});
+}
+
+void Writer::endObject() {
+  assert(!Stack.empty() && !Stack.back().IsArray && !AfterKey &&
+         "not in an object");
+  Stack.pop_back();
+  if (PrettyPrint)
+    newlineAndIndent();
+  Stream << '}';
+}
+
+void Writer::beginArray() {
+  beginValue();
+  Stream << '[';
+  if (PrettyPrint)
+    Stream << '\n';
+  Stack.push_back({/*IsArray=*/true, /*HasElements=*/false});
+}
+
+void Writer::endArray() {
+  assert(!Stack.empty() && Stack.back().IsArray && "not in an array");
+  Stack.pop_back();
+  if (PrettyPrint)
+    newlineAndIndent();
+  Stream << ']';
+}
+
+void Writer::value(double D) {
+  beginValue();
+  Stream << llvm::format("%g", D);
+}
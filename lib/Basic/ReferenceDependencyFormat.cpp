@@ -0,0 +1,173 @@
+//===--- ReferenceDependencyFormat.cpp - Binary swiftdeps files -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ReferenceDependencyFormat.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+
+using namespace swift;
+using namespace swift::reference_dependencies;
+using namespace llvm::support;
+
+StringRef reference_dependencies::getSectionName(Section section) {
+  switch (section) {
+  case Section::ProvidesTopLevel: return "provides-top-level";
+  case Section::ProvidesNominal: return "provides-nominal";
+  case Section::ProvidesMember: return "provides-member";
+  case Section::ProvidesDynamicLookup: return "provides-dynamic-lookup";
+  case Section::DependsTopLevel: return "depends-top-level";
+  case Section::DependsMember: return "depends-member";
+  case Section::DependsNominal: return "depends-nominal";
+  case Section::DependsDynamicLookup: return "depends-dynamic-lookup";
+  case Section::DependsExternal: return "depends-external";
+  case Section::Fingerprints: return "fingerprints";
+  }
+  llvm_unreachable("unhandled section");
+}
+
+bool reference_dependencies::isBinaryFormat(StringRef data) {
+  return data.size() >= sizeof(Signature) &&
+         memcmp(data.data(), Signature, sizeof(Signature)) == 0;
+}
+
+uint32_t BinaryWriter::intern(StringRef string) {
+  auto inserted = StringIndices.insert({string, Strings.size()});
+  if (inserted.second)
+    Strings.push_back(inserted.first->getKey());
+  return inserted.first->getValue();
+}
+
+void BinaryWriter::addName(Section section, StringRef name, bool isCascading) {
+  assert(!isPairSection(section) && "use addPair");
+  uint32_t sectionAndFlags = uint32_t(section);
+  if (!isCascading)
+    sectionAndFlags |= PrivateRecordFlag;
+  Records.push_back({intern(name), NoString, sectionAndFlags});
+}
+
+void BinaryWriter::addPair(Section section, StringRef first, StringRef second,
+                           bool isCascading) {
+  assert(isPairSection(section) && "use addName");
+  uint32_t sectionAndFlags = uint32_t(section);
+  if (!isCascading)
+    sectionAndFlags |= PrivateRecordFlag;
+  Records.push_back({intern(first), intern(second), sectionAndFlags});
+}
+
+void BinaryWriter::setInterfaceHash(StringRef hash) {
+  InterfaceHash = intern(hash);
+}
+
+void BinaryWriter::write(raw_ostream &out) const {
+  endian::Writer<little> writer(out);
+
+  out.write(reinterpret_cast<const char *>(Signature), sizeof(Signature));
+  writer.write<uint32_t>(FormatVersion);
+  writer.write<uint32_t>(Strings.size());
+  writer.write<uint32_t>(Records.size());
+  writer.write<uint32_t>(InterfaceHash);
+
+  uint32_t end = 0;
+  for (StringRef string : Strings) {
+    end += string.size();
+    writer.write<uint32_t>(end);
+  }
+
+  for (const Record &record : Records) {
+    writer.write<uint32_t>(record.Name);
+    writer.write<uint32_t>(record.Member);
+    writer.write<uint32_t>(record.SectionAndFlags);
+  }
+
+  for (StringRef string : Strings)
+    out << string;
+}
+
+bool reference_dependencies::readBinary(
+    StringRef data, StringRef &interfaceHash,
+    llvm::function_ref<bool(const Entry &)> callback) {
+  if (!isBinaryFormat(data))
+    return false;
+
+  const size_t headerSize = sizeof(Signature) + 4 * sizeof(uint32_t);
+  if (data.size() < headerSize)
+    return false;
+  auto *cursor =
+      reinterpret_cast<const uint8_t *>(data.data()) + sizeof(Signature);
+  auto readNext = [&]() -> uint32_t {
+    return endian::readNext<uint32_t, little, unaligned>(cursor);
+  };
+
+  if (readNext() != FormatVersion)
+    return false;
+  uint64_t numStrings = readNext();
+  uint64_t numRecords = readNext();
+  uint32_t interfaceHashIndex = readNext();
+
+  uint64_t tableSize = (numStrings + 3 * numRecords) * sizeof(uint32_t);
+  if (data.size() - headerSize < tableSize)
+    return false;
+  StringRef characters = data.substr(headerSize + tableSize);
+
+  const uint8_t *stringEnds = cursor;
+  auto getString = [&](uint32_t index, StringRef &result) -> bool {
+    if (index >= numStrings)
+      return false;
+    const uint8_t *endPtr = stringEnds + index * sizeof(uint32_t);
+    uint32_t end = endian::read<uint32_t, little, unaligned>(endPtr);
+    uint32_t start = 0;
+    if (index != 0) {
+      const uint8_t *startPtr = endPtr - sizeof(uint32_t);
+      start = endian::read<uint32_t, little, unaligned>(startPtr);
+    }
+    if (start > end || end > characters.size())
+      return false;
+    result = characters.slice(start, end);
+    return true;
+  };
+
+  interfaceHash = StringRef();
+  if (interfaceHashIndex != NoString &&
+      !getString(interfaceHashIndex, interfaceHash))
+    return false;
+
+  cursor += numStrings * sizeof(uint32_t);
+  for (uint64_t i = 0; i != numRecords; ++i) {
+    uint32_t name = readNext();
+    uint32_t member = readNext();
+    uint32_t sectionAndFlags = readNext();
+
+    uint32_t rawSection = sectionAndFlags & 0xFF;
+    if (rawSection > uint32_t(Section::Last) ||
+        (sectionAndFlags & ~(0xFF | PrivateRecordFlag)) != 0)
+      return false;
+
+    Entry entry;
+    entry.section = Section(rawSection);
+    entry.isCascading = !(sectionAndFlags & PrivateRecordFlag);
+    if (!getString(name, entry.name))
+      return false;
+    if (isPairSection(entry.section)) {
+      if (!getString(member, entry.member))
+        return false;
+    } else if (member != NoString) {
+      return false;
+    }
+
+    if (!callback(entry))
+      return false;
+  }
+
+  return true;
+}
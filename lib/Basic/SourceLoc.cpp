@@ -201,6 +201,54 @@ unsigned SourceManager::findBufferContainingLoc(SourceLoc Loc) const {
   llvm_unreachable("no buffer containing location found");
 }
 
+const std::vector<unsigned> &
+SourceManager::getLineStarts(unsigned BufferID) const {
+  std::vector<unsigned> &Starts = LineStarts[BufferID];
+  if (!Starts.empty())
+    return Starts;
+
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  Starts.push_back(0);
+  for (size_t i = 0, e = Buffer.size(); i != e; ++i)
+    if (Buffer[i] == '\n')
+      Starts.push_back(i + 1);
+  return Starts;
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::findLineAndColumn(SourceLoc Loc, unsigned BufferID) const {
+  if (BufferID == 0)
+    BufferID = LLVMSourceMgr.FindBufferContainingLoc(Loc.Value);
+  unsigned Offset = getLocOffsetInBuffer(Loc, BufferID);
+  const std::vector<unsigned> &Starts = getLineStarts(BufferID);
+
+  // Lines are numbered from 1, so line N starts at Starts[N - 1].
+  auto isOnLine = [&](unsigned Line) -> bool {
+    return Line != 0 && Line <= Starts.size() && Starts[Line - 1] <= Offset &&
+           (Line == Starts.size() || Offset < Starts[Line]);
+  };
+
+  unsigned Line;
+  if (LastLineLookup.first == BufferID && isOnLine(LastLineLookup.second))
+    Line = LastLineLookup.second;
+  else if (LastLineLookup.first == BufferID &&
+           isOnLine(LastLineLookup.second + 1))
+    Line = LastLineLookup.second + 1;
+  else
+    Line = std::upper_bound(Starts.begin(), Starts.end(), Offset) -
+           Starts.begin();
+  LastLineLookup = {BufferID, Line};
+
+  // Like llvm::SourceMgr, count columns from the last '\r' as well as from
+  // the last '\n'.
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  StringRef LineText = Buffer.slice(Starts[Line - 1], Offset);
+  size_t LastCR = LineText.rfind('\r');
+  if (LastCR != StringRef::npos)
+    LineText = LineText.substr(LastCR + 1);
+  return { Line, LineText.size() + 1 };
+}
+
 void SourceLoc::printLineAndColumn(raw_ostream &OS,
                                    const SourceManager &SM) const {
   if (isInvalid()) {
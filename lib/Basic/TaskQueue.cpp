@@ -47,6 +47,12 @@ void DummyTaskQueue::addTask(const char *ExecPath, ArrayRef<const char *> Args,
     std::unique_ptr<DummyTask>(new DummyTask(ExecPath, Args, Env, Context)));
 }
 
+void DummyTaskQueue::addServerTask(StringRef ServerPath, const char *ExecPath,
+                                   ArrayRef<const char *> Args,
+                                   void *Context) {
+  addTask(ExecPath, Args, llvm::None, Context);
+}
+
 bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
                              TaskQueue::TaskFinishedCallback Finished,
                              TaskQueue::TaskSignalledCallback Signalled) {
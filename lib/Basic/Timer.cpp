@@ -11,7 +11,43 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Timer.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
 SharedTimer::State SharedTimer::CompilationTimersEnabled = State::Initial;
+std::vector<TimedPhase> *SharedTimer::Timeline = nullptr;
+
+void SharedTimer::writeTimeline(raw_ostream &out,
+                                ArrayRef<TimedPhase> timeline) {
+  for (const TimedPhase &phase : timeline) {
+    out << phase.Start.usec() << ' ' << phase.End.usec() << ' ' << phase.Name
+        << '\n';
+  }
+}
+
+bool SharedTimer::readTimeline(StringRef data,
+                               std::vector<TimedPhase> &timeline) {
+  while (!data.empty()) {
+    StringRef line;
+    std::tie(line, data) = data.split('\n');
+    if (line.empty())
+      continue;
+
+    StringRef start, end;
+    std::tie(start, line) = line.split(' ');
+    std::tie(end, line) = line.split(' ');
+
+    uint64_t startUsec, endUsec;
+    if (start.getAsInteger(10, startUsec) || end.getAsInteger(10, endUsec) ||
+        endUsec < startUsec || line.empty())
+      return false;
+
+    TimedPhase phase;
+    phase.Name = line.str();
+    phase.Start.usec(startUsec);
+    phase.End.usec(endUsec);
+    timeline.push_back(std::move(phase));
+  }
+  return true;
+}
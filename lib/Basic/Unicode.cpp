@@ -22,6 +22,16 @@ StringRef swift::unicode::extractFirstExtendedGraphemeCluster(StringRef S) {
   if (S.empty())
     return StringRef();
 
+  // Fast path: there is a boundary between any two ASCII scalars except
+  // CR-LF.
+  if (static_cast<unsigned char>(S[0]) < 0x80) {
+    if (S.size() == 1)
+      return S;
+    if (static_cast<unsigned char>(S[1]) < 0x80 &&
+        !(S[0] == '\r' && S[1] == '\n'))
+      return S.slice(0, 1);
+  }
+
   const UTF8 *SourceStart = reinterpret_cast<const UTF8 *>(S.data());
 
   const UTF8 *SourceNext = SourceStart;
@@ -35,6 +35,7 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Config.h"
+#include "swift/Strings.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Mangle.h"
 #include "clang/Basic/CharInfo.h"
@@ -45,6 +46,7 @@
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "clang/Lex/Preprocessor.h"
@@ -121,9 +123,27 @@ namespace {
     }
   };
 
+  /// Records the modules imported by a precompiled bridging header, which
+  /// never goes through the preprocessor callbacks that catch them otherwise.
+  class PCHDeserializationCallbacks : public clang::ASTDeserializationListener {
+    ClangImporter::Implementation &Impl;
+  public:
+    explicit PCHDeserializationCallbacks(ClangImporter::Implementation &impl)
+      : Impl(impl) {}
+
+    void ModuleImportRead(clang::serialization::SubmoduleID ID,
+                          clang::SourceLocation ImportLoc) override {
+      Impl.PCHImportedSubmodules.push_back(ID);
+    }
+  };
+
   class HeaderParsingASTConsumer : public clang::ASTConsumer {
     SmallVector<clang::DeclGroupRef, 4> DeclGroups;
+    PCHDeserializationCallbacks PCHCallbacks;
   public:
+    explicit HeaderParsingASTConsumer(ClangImporter::Implementation &impl)
+      : PCHCallbacks(impl) {}
+
     void
     HandleTopLevelDeclInObjCContainer(clang::DeclGroupRef decls) override {
       DeclGroups.push_back(decls);
@@ -136,12 +156,21 @@ namespace {
     void reset() {
       DeclGroups.clear();
     }
+
+    clang::ASTDeserializationListener *
+    GetASTDeserializationListener() override {
+      return &PCHCallbacks;
+    }
   };
 
   class ParsingAction : public clang::ASTFrontendAction {
+    ClangImporter::Implementation &Impl;
+  public:
+    explicit ParsingAction(ClangImporter::Implementation &impl) : Impl(impl) {}
+
     std::unique_ptr<clang::ASTConsumer>
     CreateASTConsumer(clang::CompilerInstance &CI, StringRef InFile) override {
-      return llvm::make_unique<HeaderParsingASTConsumer>();
+      return llvm::make_unique<HeaderParsingASTConsumer>(Impl);
     }
   };
 
@@ -572,6 +601,14 @@ ClangImporter::create(ASTContext &ctx,
   }
   addCommonInvocationArguments(invocationArgStrs, ctx, importerOpts);
 
+  // Load a precompiled bridging header up front; importBridgingHeader then
+  // only has to pick up what it brought in.
+  if (!importerOpts.BridgingHeaderPCH.empty()) {
+    invocationArgStrs.insert(invocationArgStrs.end(), {
+      "-include-pch", importerOpts.BridgingHeaderPCH
+    });
+  }
+
   if (importerOpts.DumpClangDiagnostics) {
     llvm::errs() << "clang '";
     interleave(invocationArgStrs,
@@ -639,7 +676,7 @@ ClangImporter::create(ASTContext &ctx,
   instance.setInvocation(&*invocation);
 
   // Create the associated action.
-  importer->Impl.Action.reset(new ParsingAction);
+  importer->Impl.Action.reset(new ParsingAction(importer->Impl));
   auto *action = importer->Impl.Action.get();
 
   // Execute the action. We effectively inline most of
@@ -770,6 +807,47 @@ bool ClangImporter::addSearchPath(StringRef newSearchPath, bool isFramework) {
   return false;
 }
 
+/// Record the result of import-as-member inference for the given global in
+/// the lookup table.
+static void
+addInferredMemberToLookupTable(
+    SwiftLookupTable &table, clang::NamedDecl *global,
+    const ClangImporter::Implementation::ImportedName &importedName) {
+  if (!importedName.ImportAsMember) {
+    table.addInferredMember(global, nullptr, StringRef());
+    return;
+  }
+
+  // Find the type declaration of the context. Contexts that can't be named
+  // aren't recorded, leaving inference to the clients.
+  const auto &effectiveContext = importedName.EffectiveContext;
+  const clang::NamedDecl *context = nullptr;
+  switch (effectiveContext.getKind()) {
+  case EffectiveClangContext::DeclContext: {
+    auto dc = effectiveContext.getAsDeclContext();
+    if (!SwiftLookupTable::translateDeclContext(dc)) return;
+    context = dyn_cast<clang::NamedDecl>(clang::Decl::castFromDeclContext(dc));
+    break;
+  }
+
+  case EffectiveClangContext::TypedefContext:
+    context = effectiveContext.getTypedefName();
+    break;
+
+  case EffectiveClangContext::UnresolvedContext:
+    return;
+  }
+  if (!context) return;
+
+  SmallString<64> swiftName;
+  {
+    llvm::raw_svector_ostream os(swiftName);
+    importedName.printSwiftName(os);
+  }
+  table.addInferredMember(global, const_cast<clang::NamedDecl *>(context),
+                          swiftName);
+}
+
 void ClangImporter::Implementation::addEntryToLookupTable(
        clang::Sema &clangSema,
        SwiftLookupTable &table,
@@ -800,6 +878,11 @@ void ClangImporter::Implementation::addEntryToLookupTable(
   if (auto importedName = importFullName(named, None, &clangSema)) {
     table.addEntry(importedName.Imported, named, importedName.EffectiveContext);
 
+    // Record the result of import-as-member inference, so that clients of
+    // the module don't have to repeat it.
+    if (canInferImportAsMember(named, clangSema))
+      addInferredMemberToLookupTable(table, named, importedName);
+
     // Also add the subscript entry, if needed.
     if (importedName.isSubscriptAccessor())
       table.addEntry(DeclName(SwiftContext, SwiftContext.Id_subscript,
@@ -980,6 +1063,34 @@ bool ClangImporter::Implementation::importHeader(
   return false;
 }
 
+bool ClangImporter::Implementation::importBridgingHeaderPCH(
+    ClangImporter &importer, Module *adapter, StringRef pchPath,
+    SourceLoc diagLoc) {
+  if (StringRef(Invocation->getPreprocessorOpts().ImplicitPCHInclude) !=
+        pchPath) {
+    SwiftContext.Diags.diagnose(diagLoc, diag::bridging_header_error, pchPath);
+    return true;
+  }
+
+  assert(adapter);
+  ImportedHeaderOwners.push_back(adapter);
+
+  // The PCH's declarations and macros are already in its lookup table; only
+  // the modules it imports still need to be wrapped and re-exported.
+  for (auto submoduleID : PCHImportedSubmodules) {
+    auto *imported = Instance->getModuleManager()->getSubmodule(submoduleID);
+    if (!imported)
+      continue;
+    Module *nativeImported = finishLoadingClangModule(importer, imported,
+                                                      /*adapter=*/true);
+    ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+  }
+  PCHImportedSubmodules.clear();
+
+  bumpGeneration();
+  return false;
+}
+
 bool ClangImporter::importHeader(StringRef header, Module *adapter,
                                  off_t expectedSize, time_t expectedModTime,
                                  StringRef cachedContents, SourceLoc diagLoc) {
@@ -1003,6 +1114,9 @@ bool ClangImporter::importHeader(StringRef header, Module *adapter,
 bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                                          SourceLoc diagLoc,
                                          bool trackParsedSymbols) {
+  if (llvm::sys::path::extension(header).endswith(PCH_EXTENSION))
+    return Impl.importBridgingHeaderPCH(*this, adapter, header, diagLoc);
+
   clang::FileManager &fileManager = Impl.Instance->getFileManager();
   const clang::FileEntry *headerFile = fileManager.getFile(header,
                                                            /*open=*/true);
@@ -1072,6 +1186,72 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::canReadPCH(StringRef PCHFilename) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+  // Reading the PCH's lookup table would register it with this importer.
+  invocation->getFrontendOpts().ModuleFileExtensions.clear();
+
+  clang::CompilerInstance checkInstance(
+    Impl.Instance->getPCHContainerOperations());
+  checkInstance.setInvocation(&*invocation);
+  checkInstance.createDiagnostics(new clang::IgnoringDiagConsumer);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  checkInstance.setFileManager(&fileManager);
+  checkInstance.createSourceManager(fileManager);
+  checkInstance.setTarget(&Impl.Instance->getTarget());
+  checkInstance.createPreprocessor(clang::TU_Complete);
+  checkInstance.createASTContext();
+  checkInstance.createModuleManager();
+
+  // Don't accept an out-of-date PCH: one of the headers it was built from
+  // may have changed since.
+  auto result = checkInstance.getModuleManager()->ReadAST(
+      PCHFilename, clang::serialization::MK_PCH, clang::SourceLocation(),
+      clang::ASTReader::ARR_None);
+  return result == clang::ASTReader::Success;
+}
+
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+  invocation->getFrontendOpts().ProgramAction = clang::frontend::GeneratePCH;
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  // The Swift name lookup extension is still installed, so the PCH carries
+  // a lookup table just like a module does.
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
@@ -2290,6 +2470,58 @@ static clang::SwiftNameAttr *findSwiftNameAttr(const clang::Decl *decl,
   return nullptr;
 }
 
+bool ClangImporter::Implementation::canInferImportAsMember(
+       const clang::NamedDecl *D,
+       clang::Sema &clangSema) {
+  return (isa<clang::VarDecl>(D) || isa<clang::FunctionDecl>(D)) &&
+         D->getDeclContext()->isTranslationUnit() &&
+         D->getDeclName().isIdentifier() &&
+         !findSwiftNameAttr(D, /*swift2Name=*/false) &&
+         (InferImportAsMember || moduleIsInferImportAsMember(D, clangSema));
+}
+
+auto ClangImporter::Implementation::findInferredMember(
+       const clang::NamedDecl *D) -> Optional<ImportedName> {
+  // Only module files carry the results of inference.
+  if (!D->isFromASTFile()) return None;
+
+  auto submodule = getClangSubmoduleForDecl(D);
+  if (!submodule || !*submodule) return None;
+
+  auto table = findLookupTable(*submodule);
+  if (!table) return None;
+
+  auto stored = table->lookupInferredMember(D->getName());
+  if (!stored) return None;
+
+  // The global isn't imported as a member.
+  ImportedName result;
+  auto context = stored->first;
+  if (!context) return result;
+
+  ParsedDeclName parsedName = parseDeclName(stored->second);
+  if (!parsedName) return None;
+
+  result.ImportAsMember = true;
+  result.Imported = parsedName.formDeclName(SwiftContext);
+  if (auto typedefName = dyn_cast<clang::TypedefNameDecl>(context))
+    result.EffectiveContext = typedefName;
+  else
+    result.EffectiveContext = cast<clang::DeclContext>(context);
+
+  // Instance or static
+  if (parsedName.SelfIndex)
+    result.SelfIndex = parsedName.SelfIndex;
+
+  // Property
+  if (parsedName.IsGetter)
+    result.AccessorKind = ImportedAccessorKind::PropertyGetter;
+  else if (parsedName.IsSetter)
+    result.AccessorKind = ImportedAccessorKind::PropertySetter;
+
+  return result;
+}
+
 /// Prepare global name for importing onto a swift_newtype.
 static StringRef determineSwiftNewtypeBaseName(StringRef baseName,
                                                StringRef newtypeName,
@@ -2503,28 +2735,30 @@ auto ClangImporter::Implementation::importFullName(
 
       return result;
     }
-  } else if (!swift2Name &&
-             (InferImportAsMember ||
-              moduleIsInferImportAsMember(D, clangSema)) &&
-             (isa<clang::VarDecl>(D) || isa<clang::FunctionDecl>(D)) &&
-             dc->isTranslationUnit()) {
-    auto inference = IAMResult::infer(SwiftContext, clangSema, D);
-    if (inference.isImportAsMember()) {
-      result.ImportAsMember = true;
-      result.Imported = inference.name;
-      result.EffectiveContext = inference.effectiveDC;
-
-      // Instance or static
-      if (inference.selfIndex)
-        result.SelfIndex = inference.selfIndex;
-
-      // Property
-      if (inference.isGetter())
-        result.AccessorKind = ImportedAccessorKind::PropertyGetter;
-      else if (inference.isSetter())
-        result.AccessorKind = ImportedAccessorKind::PropertySetter;
+  } else if (!swift2Name && canInferImportAsMember(D, clangSema)) {
+    // Modules record the results of inference for their globals.
+    if (auto inferred = findInferredMember(D)) {
+      if (inferred->ImportAsMember)
+        return *inferred;
+    } else {
+      auto inference = IAMResult::infer(SwiftContext, clangSema, D);
+      if (inference.isImportAsMember()) {
+        result.ImportAsMember = true;
+        result.Imported = inference.name;
+        result.EffectiveContext = inference.effectiveDC;
 
-      return result;
+        // Instance or static
+        if (inference.selfIndex)
+          result.SelfIndex = inference.selfIndex;
+
+        // Property
+        if (inference.isGetter())
+          result.AccessorKind = ImportedAccessorKind::PropertyGetter;
+        else if (inference.isSetter())
+          result.AccessorKind = ImportedAccessorKind::PropertySetter;
+
+        return result;
+      }
     }
   }
 
@@ -4443,9 +4677,15 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
   auto &entry = Impl.LookupTables[mod.ModuleName];
   if (entry) return nullptr;
 
+  // A precompiled header has no module name, and its table serves lookups
+  // into the bridging header.
+  bool isBridgingHeaderPCH = mod.Kind == clang::serialization::MK_PCH;
+
   // Local function used to remove this entry when the reader goes away.
   std::string moduleName = mod.ModuleName;
-  auto onRemove = [this, moduleName]() {
+  auto onRemove = [this, moduleName, isBridgingHeaderPCH]() {
+    if (isBridgingHeaderPCH)
+      Impl.BridgingHeaderPCHLookupTable = nullptr;
     Impl.LookupTables.erase(moduleName);
   };
 
@@ -4456,6 +4696,8 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
 
   // Create the lookup table.
   entry.reset(new SwiftLookupTable(tableReader.get()));
+  if (isBridgingHeaderPCH)
+    Impl.BridgingHeaderPCHLookupTable = entry.get();
 
   // Return the new reader.
   return std::move(tableReader);
@@ -4464,8 +4706,11 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
 SwiftLookupTable *ClangImporter::Implementation::findLookupTable(
                     const clang::Module *clangModule) {
   // If the Clang module is null, use the bridging header lookup table.
-  if (!clangModule)
+  if (!clangModule) {
+    if (BridgingHeaderPCHLookupTable)
+      return BridgingHeaderPCHLookupTable;
     return &BridgingHeaderLookupTable;
+  }
 
   // Submodules share lookup tables with their parents.
   if (clangModule->isSubModule())
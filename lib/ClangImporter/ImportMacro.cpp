@@ -27,9 +27,16 @@
 #include "swift/AST/Stmt.h"
 #include "swift/AST/Types.h"
 #include "swift/ClangImporter/ClangModule.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Clang module importer"
+STATISTIC(NumMacrosParsed,
+          "# of macro expansions parsed for import");
+STATISTIC(NumMacrosImported,
+          "# of macros imported as Swift declarations");
+
 Optional<clang::Module *>
 ClangImporter::Implementation::getClangSubmoduleForMacro(
     const clang::MacroInfo *MI) {
@@ -364,22 +371,22 @@ ValueDecl *ClangImporter::Implementation::importMacro(Identifier name,
   if (!macro)
     return nullptr;
 
-  // Look for macros imported with the same name.
+  // Check whether this macro has already been imported.
+  auto knownMacro = ImportedMacroInfos.find(macro);
+  if (knownMacro != ImportedMacroInfos.end())
+    return knownMacro->second;
+
+  // Otherwise, check whether this macro is identical to a macro with the same
+  // name that has already been imported.
   auto known = ImportedMacros.find(name);
   if (known != ImportedMacros.end()) {
-    // Check whether this macro has already been imported.
-    for (const auto &entry : known->second) {
-      if (entry.first == macro) return entry.second;
-    }
-
-    // Otherwise, check whether this macro is identical to a macro that has
-    // already been imported.
     auto &clangPP = getClangPreprocessor();
     for (const auto &entry : known->second) {
       // If the macro is equal to an existing macro, map down to the same
       // declaration.
       if (macro->isIdenticalTo(*entry.first, clangPP, true)) {
         known->second.push_back({macro, entry.second});
+        ImportedMacroInfos[macro] = entry.second;
         return entry.second;
       }
     }
@@ -393,7 +400,11 @@ ValueDecl *ClangImporter::Implementation::importMacro(Identifier name,
   if (!DC)
     return nullptr;
 
+  ++NumMacrosParsed;
   auto valueDecl = ::importMacro(*this, DC, name, macro, macro);
+  if (valueDecl)
+    ++NumMacrosImported;
   ImportedMacros[name].push_back({macro, valueDecl});
+  ImportedMacroInfos[macro] = valueDecl;
   return valueDecl;
 }
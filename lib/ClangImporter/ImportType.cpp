@@ -34,11 +34,16 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/TypeVisitor.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 
 using namespace swift;
 using namespace importer;
 
+#define DEBUG_TYPE "Import type"
+STATISTIC(NumImportedTypesCached, "# of imported types found in the cache");
+STATISTIC(NumImportedTypesComputed, "# of imported types computed");
+
 /// Given that a type is the result of a special typedef import, was
 /// it originally a CF pointer?
 static bool isImportedCFPointer(clang::QualType clangType, Type type) {
@@ -1269,6 +1274,21 @@ Type ClangImporter::Implementation::importType(clang::QualType type,
       type = clangContext.getObjCSelType();
   }
   
+  // The same types show up over and over in the parameters, results and
+  // properties of imported APIs, so remember what each one was imported as.
+  // The sugared type is the key, because typedefs affect the import.
+  auto cacheKey = std::make_pair(type.getAsOpaquePtr(),
+                                 getImportedTypeKey(importKind,
+                                                    allowNSUIntegerAsInt,
+                                                    canFullyBridgeTypes,
+                                                    optionality));
+  auto known = ImportedTypes.find(cacheKey);
+  if (known != ImportedTypes.end()) {
+    ++NumImportedTypesCached;
+    return known->second;
+  }
+  ++NumImportedTypesComputed;
+
   // If nullability is provided as part of the type, that overrides
   // optionality provided externally.
   if (auto nullability = type->getNullability(clangContext)) {
@@ -1280,11 +1300,18 @@ Type ClangImporter::Implementation::importType(clang::QualType type,
   auto importResult = converter.Visit(type);
 
   // Now fix up the type based on we're concretely using it.
-  return adjustTypeForConcreteImport(*this, type, importResult.AbstractType,
-                                     importKind, importResult.Hint,
-                                     allowNSUIntegerAsInt,
-                                     canFullyBridgeTypes,
-                                     optionality);
+  Type importedType =
+    adjustTypeForConcreteImport(*this, type, importResult.AbstractType,
+                                importKind, importResult.Hint,
+                                allowNSUIntegerAsInt,
+                                canFullyBridgeTypes,
+                                optionality);
+
+  // Don't remember failures: they can be caused by a declaration that is in
+  // the middle of being imported, and succeed later.
+  if (importedType)
+    ImportedTypes[cacheKey] = importedType;
+  return importedType;
 }
 
 bool ClangImporter::Implementation::isNSString(const clang::Type *type) {
@@ -30,6 +30,7 @@
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/ModuleFileExtension.h"
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/DenseMap.h"
@@ -281,6 +282,12 @@ private:
   /// (through the Swift name lookup module file extension).
   llvm::StringMap<std::unique_ptr<SwiftLookupTable>> LookupTables;
 
+  /// The Swift lookup table stored in a precompiled bridging header, if one
+  /// was loaded; it stands in for \c BridgingHeaderLookupTable.
+  ///
+  /// Owned by \c LookupTables.
+  SwiftLookupTable *BridgingHeaderPCHLookupTable = nullptr;
+
   /// \brief A count of the number of load module operations.
   /// FIXME: Horrible, horrible hack for \c loadModule().
   unsigned ImportCounter = 0;
@@ -386,6 +393,30 @@ public:
                  SmallVector<std::pair<clang::MacroInfo *, ValueDecl *>, 2>>
     ImportedMacros;
 
+  /// The Swift declaration, if any, each macro definition was imported as.
+  ///
+  /// Macros are only imported when a name lookup finds them, so this holds
+  /// just the macros a compilation actually referenced.
+  llvm::DenseMap<const clang::MacroInfo *, ValueDecl *> ImportedMacroInfos;
+
+  /// \brief Mapping of already-imported types.
+  ///
+  /// The key is the opaque pointer of the clang::QualType, with its sugar and
+  /// qualifiers, together with the other arguments to importType packed by
+  /// getImportedTypeKey.
+  llvm::DenseMap<std::pair<void *, unsigned>, Type> ImportedTypes;
+
+  /// Pack the arguments to importType other than the type itself into the
+  /// second half of a key of ImportedTypes.
+  static unsigned getImportedTypeKey(ImportTypeKind kind,
+                                     bool allowNSUIntegerAsInt,
+                                     bool canFullyBridgeTypes,
+                                     OptionalTypeKind optional) {
+    return (static_cast<unsigned>(kind) << 4) |
+           (static_cast<unsigned>(optional) << 2) |
+           (allowNSUIntegerAsInt << 1) | canFullyBridgeTypes;
+  }
+
   /// Keeps track of active selector-based lookups, so that we don't infinitely
   /// recurse when checking whether a method with a given selector has already
   /// been imported.
@@ -604,6 +635,10 @@ public:
   /// The modules re-exported by imported headers.
   llvm::SmallVector<Module::ImportedModule, 8> ImportedHeaderExports;
 
+  /// The modules imported by a precompiled bridging header, recorded while
+  /// the PCH is read and re-exported once the header is imported.
+  SmallVector<clang::serialization::SubmoduleID, 4> PCHImportedSubmodules;
+
   /// The modules that requested imported headers.
   ///
   /// These are used to look up Swift classes forward-declared with \@class.
@@ -738,6 +773,11 @@ public:
                     bool trackParsedSymbols,
                     std::unique_ptr<llvm::MemoryBuffer> contents);
 
+  /// Imports a bridging header that was already loaded from the precompiled
+  /// header \p pchPath when the Clang instance was set up.
+  bool importBridgingHeaderPCH(ClangImporter &importer, Module *adapter,
+                               StringRef pchPath, SourceLoc diagLoc);
+
   /// Returns the redeclaration of \p D that contains its definition for any
   /// tag type decl (struct, enum, or union) or Objective-C class or protocol.
   ///
@@ -933,6 +973,19 @@ public:
                               ImportNameOptions options = None,
                               clang::Sema *clangSemaOverride = nullptr);
 
+  /// Whether import-as-member inference applies to the given Clang
+  /// declaration.
+  bool canInferImportAsMember(const clang::NamedDecl *D,
+                              clang::Sema &clangSema);
+
+  /// Retrieve the result of import-as-member inference for the given Clang
+  /// declaration from the Swift lookup table of its module.
+  ///
+  /// 
+eturns None if the module file doesn't record a result, in which
+  /// case inference has to be performed.
+  Optional<ImportedName> findInferredMember(const clang::NamedDecl *D);
+
   /// Imports the name of the given Clang macro into Swift.
   Identifier importMacroName(const clang::IdentifierInfo *clangIdentifier,
                              const clang::MacroInfo *macro,
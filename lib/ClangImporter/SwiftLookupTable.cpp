@@ -24,6 +24,7 @@
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
@@ -33,6 +34,16 @@
 using namespace swift;
 using namespace llvm::support;
 
+#define DEBUG_TYPE "Swift lookup table"
+STATISTIC(NumBaseNameQueries,
+          "# of base name lookups in Swift lookup tables");
+STATISTIC(NumBaseNamesDeserialized,
+          "# of base names deserialized from Swift lookup tables");
+STATISTIC(NumEntriesDeserialized,
+          "# of entries deserialized from Swift lookup tables");
+STATISTIC(NumEntriesResolved,
+          "# of deserialized entries resolved to Clang decls or macros");
+
 /// Determine whether the new declarations matches an existing declaration.
 static bool matchesExistingDecl(clang::Decl *decl, clang::Decl *existingDecl) {
   // If the canonical declarations are equivalent, we have a match.
@@ -163,6 +174,18 @@ void SwiftLookupTable::addCategory(clang::ObjCCategoryDecl *category) {
   Categories.push_back(category);
 }
 
+void SwiftLookupTable::addInferredMember(clang::NamedDecl *global,
+                                         clang::NamedDecl *context,
+                                         StringRef swiftName) {
+  assert(!Reader && "Cannot modify a lookup table stored on disk");
+
+  InferredMember &entry = InferredMembers[global->getName()];
+  if (context) {
+    entry.Context = encodeEntry(context);
+    entry.Name = swiftName;
+  }
+}
+
 bool SwiftLookupTable::resolveUnresolvedEntries(
     SmallVectorImpl<SingleEntry> &unresolved) {
   // Common case: nothing left to resolve.
@@ -341,6 +364,8 @@ auto SwiftLookupTable::findOrCreate(StringRef baseName)
   // If there is no base name, there is nothing to find.
   if (baseName.empty()) return LookupTable.end();
 
+  ++NumBaseNameQueries;
+
   // Find entries for this base name.
   auto known = LookupTable.find(baseName);
 
@@ -352,7 +377,11 @@ auto SwiftLookupTable::findOrCreate(StringRef baseName)
 
   // Lookup this base name in the module file.
   SmallVector<FullTableEntry, 2> results;
-  (void)Reader->lookup(baseName, results);
+  if (Reader->lookup(baseName, results)) {
+    ++NumBaseNamesDeserialized;
+    for (const auto &entry : results)
+      NumEntriesDeserialized += entry.DeclsOrMacros.size();
+  }
 
   // Add an entry to the table so we don't look again.
   known = LookupTable.insert({ std::move(baseName), std::move(results) }).first;
@@ -398,7 +427,8 @@ SwiftLookupTable::lookupGlobalsAsMembers(StoredContext context) {
 
     // Lookup this base name in the module extension file.
     SmallVector<uintptr_t, 2> results;
-    (void)Reader->lookupGlobalsAsMembers(context, results);
+    if (Reader->lookupGlobalsAsMembers(context, results))
+      NumEntriesDeserialized += results.size();
 
     // Add an entry to the table so we don't look again.
     known = GlobalsAsMembers.insert({ std::move(context),
@@ -449,6 +479,25 @@ SwiftLookupTable::allGlobalsAsMembers() {
   return results;
 }
 
+Optional<std::pair<clang::NamedDecl *, StringRef>>
+SwiftLookupTable::lookupInferredMember(StringRef globalName) {
+  auto known = InferredMembers.find(globalName);
+
+  // If we didn't find anything, look in the module file.
+  if (known == InferredMembers.end()) {
+    InferredMember stored;
+    if (!Reader || !Reader->lookupInferredMember(globalName, stored))
+      return None;
+
+    known = InferredMembers.insert({globalName, std::move(stored)}).first;
+  }
+
+  auto &entry = known->second;
+  if (!entry.Context)
+    return std::make_pair(nullptr, StringRef());
+  return std::make_pair(mapStoredDecl(entry.Context), StringRef(entry.Name));
+}
+
 SmallVector<SwiftLookupTable::SingleEntry, 4>
 SwiftLookupTable::lookup(StringRef baseName,
                          EffectiveClangContext searchContext) {
@@ -716,7 +765,11 @@ namespace {
 
     /// Record that contains the mapping from contexts to the list of
     /// globals that will be injected as members into those contexts.
-    GLOBALS_AS_MEMBERS_RECORD_ID
+    GLOBALS_AS_MEMBERS_RECORD_ID,
+
+    /// Record that contains the mapping from the C names of globals to the
+    /// results of import-as-member inference for them.
+    INFERRED_MEMBERS_RECORD_ID
   };
 
   using BaseNameToEntitiesTableRecordLayout
@@ -728,6 +781,9 @@ namespace {
   using GlobalsAsMembersTableRecordLayout
     = BCRecordLayout<GLOBALS_AS_MEMBERS_RECORD_ID, BCVBR<16>, BCBlob>;
 
+  using InferredMembersTableRecordLayout
+    = BCRecordLayout<INFERRED_MEMBERS_RECORD_ID, BCVBR<16>, BCBlob>;
+
   /// Trait used to write the on-disk hash table for the base name -> entities
   /// mapping.
   class BaseNameToEntitiesTableWriterInfo {
@@ -891,6 +947,67 @@ namespace {
       }
     }
   };
+
+  /// Trait used to write the on-disk hash table for the C name -> inferred
+  /// member mapping.
+  class InferredMembersTableWriterInfo {
+    SwiftLookupTable &Table;
+    clang::ASTWriter &Writer;
+
+  public:
+    using key_type = StringRef;
+    using key_type_ref = key_type;
+    using data_type = SwiftLookupTable::InferredMember;
+    using data_type_ref = data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    InferredMembersTableWriterInfo(SwiftLookupTable &table,
+                                   clang::ASTWriter &writer)
+      : Table(table), Writer(writer)
+    {
+    }
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return llvm::HashString(key);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      // The length of the key.
+      uint32_t keyLength = key.size();
+
+      // The context, followed by the name.
+      uint32_t dataLength =
+        sizeof(clang::serialization::DeclID) + data.Name.size();
+
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key;
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      endian::Writer<little> writer(out);
+
+      // The context, or zero if the global isn't imported as a member.
+      uint32_t id = 0;
+      if (data.Context) {
+        auto decl = Table.mapStoredDecl(data.Context);
+        id = (Writer.getDeclID(decl) << 2) | 0x02;
+      }
+      writer.write<uint32_t>(id);
+
+      // The name.
+      out << data.Name;
+    }
+  };
 }
 
 void SwiftLookupTableWriter::writeExtensionContents(
@@ -970,6 +1087,34 @@ void SwiftLookupTableWriter::writeExtensionContents(
     GlobalsAsMembersTableRecordLayout layout(stream);
     layout.emit(ScratchRecord, tableOffset, hashTableBlob);
   }
+
+  // Write the inferred members table, if non-empty.
+  if (!table.InferredMembers.empty()) {
+    // Sort the keys.
+    SmallVector<StringRef, 4> globalNames;
+    for (const auto &entry : table.InferredMembers)
+      globalNames.push_back(entry.getKey());
+    llvm::array_pod_sort(globalNames.begin(), globalNames.end());
+
+    // Create the on-disk hash table.
+    llvm::SmallString<4096> hashTableBlob;
+    uint32_t tableOffset;
+    {
+      llvm::OnDiskChainedHashTableGenerator<InferredMembersTableWriterInfo>
+        generator;
+      InferredMembersTableWriterInfo info(table, Writer);
+      for (auto globalName : globalNames)
+        generator.insert(globalName, table.InferredMembers[globalName], info);
+
+      llvm::raw_svector_ostream blobStream(hashTableBlob);
+      // Make sure that no bucket is at offset 0
+      endian::Writer<little>(blobStream).write<uint32_t>(0);
+      tableOffset = generator.Emit(blobStream, info);
+    }
+
+    InferredMembersTableRecordLayout layout(stream);
+    layout.emit(ScratchRecord, tableOffset, hashTableBlob);
+  }
 }
 
 namespace {
@@ -1101,6 +1246,52 @@ namespace {
       return result;
     }
   };
+
+  /// Used to deserialize the on-disk C name -> inferred member table.
+  class InferredMembersTableReaderInfo {
+  public:
+    using internal_key_type = StringRef;
+    using external_key_type = internal_key_type;
+    using data_type = SwiftLookupTable::InferredMember;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    internal_key_type GetInternalKey(external_key_type key) {
+      return key;
+    }
+
+    external_key_type GetExternalKey(internal_key_type key) {
+      return key;
+    }
+
+    hash_value_type ComputeHash(internal_key_type key) {
+      return llvm::HashString(key);
+    }
+
+    static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+      return lhs == rhs;
+    }
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const uint8_t *&data) {
+      unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+      unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+      return { keyLength, dataLength };
+    }
+
+    static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+      return StringRef((const char *)data, length);
+    }
+
+    static data_type ReadData(internal_key_type key, const uint8_t *data,
+                              unsigned length) {
+      data_type result;
+      result.Context = endian::readNext<uint32_t, little, unaligned>(data);
+      length -= sizeof(uint32_t);
+      result.Name = StringRef((const char *)data, length);
+      return result;
+    }
+  };
 }
 
 namespace swift {
@@ -1109,6 +1300,9 @@ namespace swift {
 
   using SerializedGlobalsAsMembersTable =
     llvm::OnDiskIterableChainedHashTable<GlobalsAsMembersTableReaderInfo>;
+
+  using SerializedInferredMembersTable =
+    llvm::OnDiskIterableChainedHashTable<InferredMembersTableReaderInfo>;
 }
 
 clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
@@ -1121,6 +1315,7 @@ clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
 
   // Otherwise, resolve the declaration.
   assert(Reader && "Cannot resolve the declaration without a reader");
+  ++NumEntriesResolved;
   clang::serialization::DeclID declID = getSerializationID(entry);
   auto decl = cast_or_null<clang::NamedDecl>(
                 Reader->getASTReader().GetLocalDecl(Reader->getModuleFile(),
@@ -1141,6 +1336,7 @@ clang::MacroInfo *SwiftLookupTable::mapStoredMacro(uintptr_t &entry) {
 
   // Otherwise, resolve the macro.
   assert(Reader && "Cannot resolve the macro without a reader");
+  ++NumEntriesResolved;
   clang::serialization::MacroID macroID = getSerializationID(entry);
   auto macro = cast_or_null<clang::MacroInfo>(
                 Reader->getASTReader().getMacro(
@@ -1164,6 +1360,7 @@ SwiftLookupTableReader::~SwiftLookupTableReader() {
   OnRemove();
   delete static_cast<SerializedBaseNameToEntitiesTable *>(SerializedTable);
   delete static_cast<SerializedGlobalsAsMembersTable *>(GlobalsAsMembersTable);
+  delete static_cast<SerializedInferredMembersTable *>(InferredMembersTable);
 }
 
 std::unique_ptr<SwiftLookupTableReader>
@@ -1179,6 +1376,7 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   auto next = cursor.advance();
   std::unique_ptr<SerializedBaseNameToEntitiesTable> serializedTable;
   std::unique_ptr<SerializedGlobalsAsMembersTable> globalsAsMembersTable;
+  std::unique_ptr<SerializedInferredMembersTable> inferredMembersTable;
   ArrayRef<clang::serialization::DeclID> categories;
   while (next.Kind != llvm::BitstreamEntry::EndBlock) {
     if (next.Kind == llvm::BitstreamEntry::Error)
@@ -1242,6 +1440,22 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
       break;
     }
 
+    case INFERRED_MEMBERS_RECORD_ID: {
+      // Already saw inferred members table.
+      if (inferredMembersTable)
+        return nullptr;
+
+      uint32_t tableOffset;
+      InferredMembersTableRecordLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+      inferredMembersTable.reset(
+        SerializedInferredMembersTable::Create(base + tableOffset,
+                                               base + sizeof(uint32_t),
+                                               base));
+      break;
+    }
+
     default:
       // Unknown record, possibly for use by a future version of the
       // module format.
@@ -1257,7 +1471,8 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   return std::unique_ptr<SwiftLookupTableReader>(
            new SwiftLookupTableReader(extension, reader, moduleFile, onRemove,
                                       serializedTable.release(), categories,
-                                      globalsAsMembersTable.release()));
+                                      globalsAsMembersTable.release(),
+                                      inferredMembersTable.release()));
 
 }
 
@@ -1313,3 +1528,19 @@ bool SwiftLookupTableReader::lookupGlobalsAsMembers(
   entries = std::move(*known);
   return true;
 }
+
+bool SwiftLookupTableReader::lookupInferredMember(
+       StringRef globalName,
+       SwiftLookupTable::InferredMember &result) {
+  auto table =
+    static_cast<SerializedInferredMembersTable*>(InferredMembersTable);
+  if (!table) return false;
+
+  // Look for an entry with this C name.
+  auto known = table->find(globalName);
+  if (known == table->end()) return false;
+
+  // Grab the result.
+  result = *known;
+  return true;
+}
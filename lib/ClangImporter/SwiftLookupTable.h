@@ -26,8 +26,10 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <functional>
+#include <string>
 #include <utility>
 
 namespace llvm {
@@ -146,7 +148,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table minor version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 14; // Swift 2 names
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 15; // inferred members
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -208,6 +210,19 @@ public:
     llvm::SmallVector<uintptr_t, 2> DeclsOrMacros;
   };
 
+  /// The stored result of import-as-member inference for a global.
+  struct InferredMember {
+    /// The type declaration of the context into which the global is
+    /// imported, using the same representation as
+    /// FullTableEntry::DeclsOrMacros, or zero if inference decided not to
+    /// import the global as a member.
+    uintptr_t Context = 0;
+
+    /// The Swift name of the member, in the form used by the swift_name
+    /// attribute.
+    std::string Name;
+  };
+
   /// Whether the given entry is a macro entry.
   static bool isMacroEntry(uintptr_t entry) { return entry & 0x01; }
 
@@ -278,6 +293,10 @@ private:
   /// FullTableEntry::DeclsOrMacros.
   llvm::DenseMap<StoredContext, SmallVector<uintptr_t, 2>> GlobalsAsMembers;
 
+  /// The results of import-as-member inference, keyed by the C name of the
+  /// global.
+  llvm::StringMap<InferredMember> InferredMembers;
+
   /// The reader responsible for lazily loading the contents of this table.
   SwiftLookupTableReader *Reader;
 
@@ -329,6 +348,16 @@ public:
   /// Add an Objective-C category or extension to the table.
   void addCategory(clang::ObjCCategoryDecl *category);
 
+  /// Record the result of import-as-member inference for a global.
+  ///
+  /// \param global The C global the inference was performed for.
+  /// \param context The type declaration the global is imported into, or
+  /// null if it is not imported as a member.
+  /// \param swiftName The Swift name of the member, as printed for the
+  /// swift_name attribute. Ignored if \p context is null.
+  void addInferredMember(clang::NamedDecl *global, clang::NamedDecl *context,
+                         StringRef swiftName);
+
   /// Resolve any unresolved entries.
   ///
   /// \param unresolved Will be populated with the list of entries
@@ -389,7 +418,20 @@ public:
   /// imported as members.
   SmallVector<SingleEntry, 4> allGlobalsAsMembers();
 
+  /// Retrieve the stored result of import-as-member inference for the
+  /// global with the given C name.
+  ///
+  /// 
+eturns None if no result was stored; otherwise, the type declaration
+  /// of the context (null if the global is not imported as a member) and
+  /// the Swift name of the member.
+  Optional<std::pair<clang::NamedDecl *, StringRef>>
+  lookupInferredMember(StringRef globalName);
+
   /// Deserialize all entries.
+  ///
+  /// Only meant for dumping the table; lookups deserialize just the base
+  /// names and contexts they ask about.
   void deserializeAll();
 
   /// Dump the internal representation of this lookup table.
@@ -422,6 +464,7 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
   void *SerializedTable;
   ArrayRef<clang::serialization::DeclID> Categories;
   void *GlobalsAsMembersTable;
+  void *InferredMembersTable;
 
   SwiftLookupTableReader(clang::ModuleFileExtension *extension,
                          clang::ASTReader &reader,
@@ -429,11 +472,13 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
                          std::function<void()> onRemove,
                          void *serializedTable,
                          ArrayRef<clang::serialization::DeclID> categories,
-                         void *globalsAsMembersTable)
+                         void *globalsAsMembersTable,
+                         void *inferredMembersTable)
     : ModuleFileExtensionReader(extension), Reader(reader),
       ModuleFile(moduleFile), OnRemove(onRemove),
       SerializedTable(serializedTable), Categories(categories),
-      GlobalsAsMembersTable(globalsAsMembersTable) { }
+      GlobalsAsMembersTable(globalsAsMembersTable),
+      InferredMembersTable(inferredMembersTable) { }
 
 public:
   /// Create a new lookup table reader for the given AST reader and stream
@@ -476,6 +521,14 @@ public:
   /// \returns true if we found anything, false otherwise.
   bool lookupGlobalsAsMembers(SwiftLookupTable::StoredContext context,
                               SmallVectorImpl<uintptr_t> &entries);
+
+  /// Retrieve the stored result of import-as-member inference for the
+  /// global with the given C name.
+  ///
+  /// 
+eturns true if we found anything, false otherwise.
+  bool lookupInferredMember(StringRef globalName,
+                            SwiftLookupTable::InferredMember &result);
 };
 
 }
@@ -20,10 +20,14 @@
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
 #include "swift/Driver/Action.h"
+#include "swift/Driver/CompilationCache.h"
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Driver/TimeTrace.h"
+#include "swift/Serialization/Validation.h"
+#include "swift/Strings.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -31,6 +35,7 @@
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
@@ -83,6 +88,40 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// The times at which the running jobs began.
+    llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16> StartTimes;
+
+    /// How long each job which finished successfully took to run.
+    llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16> Durations;
+
+    /// Batchable jobs which are ready to run but haven't been handed to the
+    /// task queue yet, because they may still be combined with others.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// The jobs made to run several compile jobs in one frontend invocation.
+    SmallVector<std::unique_ptr<Job>, 4> BatchJobs;
+
+    /// A map from each batch job to the compile jobs it stands in for.
+    llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 4>, 4>
+        BatchJobConstituents;
+
+    /// The compilation cache keys of the jobs which weren't found there, so
+    /// that their results can be added once they've run.
+    llvm::SmallDenseMap<const Job *, CompilationCache::Key, 16> CacheKeys;
+
+    /// Jobs whose outputs were restored from the compilation cache, with what
+    /// they printed, which haven't yet been treated as finished.
+    SmallVector<std::pair<const Job *, std::string>, 4> RestoredCommands;
+
+    /// Returns the compile jobs whose work \p Cmd does, which is just \p Cmd
+    /// unless it is a batch job.
+    ArrayRef<const Job *> getConstituents(const Job *const &Cmd) const {
+      auto found = BatchJobConstituents.find(Cmd);
+      if (found == BatchJobConstituents.end())
+        return Cmd;
+      return found->second;
+    }
   };
 }
 
@@ -103,6 +142,238 @@ static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
   return nullptr;
 }
 
+/// Returns how long \p Cmd took to run the last time it was run, or zero if
+/// that isn't known.
+static llvm::sys::TimeValue getExpectedDuration(const Job *Cmd) {
+  auto *compileAction = dyn_cast<CompileJobAction>(&Cmd->getSource());
+  if (!compileAction)
+    return llvm::sys::TimeValue::ZeroTime();
+  return compileAction->getInputInfo().previousDuration;
+}
+
+/// Orders \p Cmds so that the jobs expected to take longest come first.
+///
+/// Starting a slow job at the end of a parallel build leaves every other
+/// slot idle while it finishes, so it's better to get those started first.
+/// Jobs with the same expected duration (including those with none) keep
+/// their relative order.
+static void sortByExpectedDuration(MutableArrayRef<const Job *> Cmds) {
+  std::stable_sort(Cmds.begin(), Cmds.end(),
+                   [](const Job *lhs, const Job *rhs) -> bool {
+    return getExpectedDuration(lhs) > getExpectedDuration(rhs);
+  });
+}
+
+/// The frontend options naming an output that belongs to a single primary
+/// file. In batch mode each is given once per primary file.
+static const StringRef PerPrimaryFileOutputOptions[] = {
+  "-o",
+  "-emit-module-path",
+  "-emit-module-doc-path",
+  "-emit-dependencies-path",
+  "-emit-reference-dependencies-path",
+};
+
+static bool isPerPrimaryFileOutputOption(StringRef arg) {
+  return std::find(std::begin(PerPrimaryFileOutputOptions),
+                   std::end(PerPrimaryFileOutputOptions),
+                   arg) != std::end(PerPrimaryFileOutputOptions);
+}
+
+/// Returns true if \p Cmd is a frontend job compiling a single primary file
+/// to an object file, which the frontend can do alongside others.
+static bool isBatchable(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return false;
+  if (!Cmd->getInputs().empty() || !Cmd->getExtraEnvironment().empty())
+    return false;
+  if (!Cmd->getFilelistInfo().path.empty())
+    return false;
+
+  const CommandOutput &Output = Cmd->getOutput();
+  if (Output.getPrimaryOutputType() != types::TY_Object ||
+      Output.getPrimaryOutputFilenames().size() != 1)
+    return false;
+  // The frontend can't yet tell apart which diagnostics or fix-its belong to
+  // which primary file, and a time trace shows the phases each file went
+  // through.
+  if (!Output.getAdditionalOutputForType(types::TY_SerializedDiagnostics)
+         .empty() ||
+      !Output.getAdditionalOutputForType(types::TY_Remapping).empty() ||
+      !Output.getAdditionalOutputForType(types::TY_PhaseTimeline).empty())
+    return false;
+
+  const llvm::opt::ArgStringList &Args = Cmd->getArguments();
+  return std::count(Args.begin(), Args.end(), StringRef("-primary-file")) == 1;
+}
+
+namespace {
+/// A frontend command line split into the parts that are the same for every
+/// compile job in the module and the parts that belong to its primary file.
+struct PrimaryFileArguments {
+  /// The arguments with the primary file's outputs removed, and with the
+  /// primary file itself left as an ordinary input (or, if the inputs are in
+  /// a file list, left out).
+  SmallVector<const char *, 32> Common;
+  /// The index in Common of the primary file, or where it was removed.
+  size_t PrimaryFilePosition = 0;
+  const char *PrimaryFile = nullptr;
+  bool UsesFileList = false;
+  /// Each per-primary-file output option and its value.
+  SmallVector<std::pair<const char *, const char *>, 4> Outputs;
+
+  /// \returns false if the arguments aren't the shape expected of a compile
+  /// job.
+  bool split(const llvm::opt::ArgStringList &Args) {
+    UsesFileList = std::count(Args.begin(), Args.end(), StringRef("-filelist"));
+    for (size_t i = 0, e = Args.size(); i != e; ++i) {
+      StringRef Arg = Args[i];
+      if (Arg != "-primary-file" && !isPerPrimaryFileOutputOption(Arg)) {
+        Common.push_back(Args[i]);
+        continue;
+      }
+      if (i + 1 == e)
+        return false;
+      const char *Value = Args[++i];
+      if (Arg != "-primary-file") {
+        Outputs.push_back({Args[i - 1], Value});
+        continue;
+      }
+      PrimaryFile = Value;
+      PrimaryFilePosition = Common.size();
+      if (!UsesFileList)
+        Common.push_back(Value);
+    }
+    return PrimaryFile != nullptr;
+  }
+
+  /// Returns true if \p other could be run in the same frontend invocation.
+  bool isCompatibleWith(const PrimaryFileArguments &other) const {
+    auto sameString = [](const char *lhs, const char *rhs) {
+      return StringRef(lhs) == rhs;
+    };
+    if (UsesFileList != other.UsesFileList ||
+        Common.size() != other.Common.size() ||
+        !std::equal(Common.begin(), Common.end(), other.Common.begin(),
+                    sameString))
+      return false;
+    if (Outputs.size() != other.Outputs.size())
+      return false;
+    for (size_t i = 0, e = Outputs.size(); i != e; ++i)
+      if (!sameString(Outputs[i].first, other.Outputs[i].first))
+        return false;
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// Makes a job that compiles the primary files of all of \p Cmds in one
+/// frontend invocation, producing the same outputs they would.
+///
+/// \returns null if the jobs don't differ only in their primary files and
+/// those files' outputs.
+static std::unique_ptr<Job> makeBatchJob(ArrayRef<const Job *> Cmds) {
+  assert(Cmds.size() > 1 && "no point in a batch of one");
+
+  SmallVector<PrimaryFileArguments, 8> Split(Cmds.size());
+  for (size_t i = 0, e = Cmds.size(); i != e; ++i) {
+    if (!Split[i].split(Cmds[i]->getArguments()))
+      return nullptr;
+    if (StringRef(Cmds[i]->getExecutable()) != Cmds[0]->getExecutable() ||
+        !Split[i].isCompatibleWith(Split[0]))
+      return nullptr;
+  }
+
+  // The frontend pairs outputs with primary files in the order the primary
+  // files appear among its inputs, so everything else has to follow suit.
+  SmallVector<size_t, 8> Order;
+  for (size_t i = 0, e = Cmds.size(); i != e; ++i)
+    Order.push_back(i);
+  std::stable_sort(Order.begin(), Order.end(), [&](size_t lhs, size_t rhs) {
+    return Split[lhs].PrimaryFilePosition < Split[rhs].PrimaryFilePosition;
+  });
+
+  const PrimaryFileArguments &First = Split[0];
+  llvm::opt::ArgStringList Arguments;
+  for (size_t i = 0, e = First.Common.size(); i <= e; ++i) {
+    for (size_t index : Order) {
+      if (Split[index].PrimaryFilePosition != i)
+        continue;
+      Arguments.push_back("-primary-file");
+      if (First.UsesFileList)
+        Arguments.push_back(Split[index].PrimaryFile);
+    }
+    if (i != e)
+      Arguments.push_back(First.Common[i]);
+  }
+
+  for (size_t i = 0, e = First.Outputs.size(); i != e; ++i) {
+    for (size_t index : Order) {
+      Arguments.push_back(First.Outputs[i].first);
+      Arguments.push_back(Split[index].Outputs[i].second);
+    }
+  }
+
+  std::unique_ptr<CommandOutput> Output(new CommandOutput(types::TY_Object));
+  for (size_t index : Order) {
+    const CommandOutput &PartOutput = Cmds[index]->getOutput();
+    Output->addPrimaryOutput(PartOutput.getPrimaryOutputFilename(),
+                             PartOutput.getBaseInput(0));
+  }
+
+  SmallVector<const Job *, 4> Inputs;
+  return std::unique_ptr<Job>(
+      new Job(Cmds[0]->getSource(), std::move(Inputs), std::move(Output),
+              Cmds[0]->getExecutable(), std::move(Arguments)));
+}
+
+/// Splits \p Cmds into at most \p NumBatches groups and makes a batch job for
+/// each group of more than one, adding it to \p BatchJobs and recording its
+/// constituents in \p Constituents.
+///
+/// Each job goes to the group with the least expected work so far, so with
+/// \p Cmds longest first the batches finish at about the same time. Jobs
+/// left on their own, or whose group couldn't be combined, are left in
+/// \p Cmds; the rest are removed.
+static void
+formBatchJobs(SmallVectorImpl<const Job *> &Cmds, unsigned NumBatches,
+              SmallVectorImpl<std::unique_ptr<Job>> &BatchJobs,
+              llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 4>, 4>
+                  &Constituents) {
+  NumBatches = std::min<size_t>(std::max(NumBatches, 1U), Cmds.size());
+  if (NumBatches == 0)
+    return;
+
+  struct Partition {
+    SmallVector<const Job *, 4> Cmds;
+    uint64_t ExpectedMicroseconds = 0;
+  };
+  SmallVector<Partition, 8> Partitions(NumBatches);
+  for (const Job *Cmd : Cmds) {
+    auto Smallest = std::min_element(Partitions.begin(), Partitions.end(),
+        [](const Partition &lhs, const Partition &rhs) -> bool {
+      return std::make_pair(lhs.ExpectedMicroseconds, lhs.Cmds.size()) <
+             std::make_pair(rhs.ExpectedMicroseconds, rhs.Cmds.size());
+    });
+    Smallest->Cmds.push_back(Cmd);
+    Smallest->ExpectedMicroseconds += getExpectedDuration(Cmd).usec();
+  }
+
+  SmallVector<const Job *, 16> Unbatched;
+  for (Partition &P : Partitions) {
+    std::unique_ptr<Job> Batch;
+    if (P.Cmds.size() > 1)
+      Batch = makeBatchJob(P.Cmds);
+    if (!Batch) {
+      Unbatched.append(P.Cmds.begin(), P.Cmds.end());
+      continue;
+    }
+    Constituents[Batch.get()] = std::move(P.Cmds);
+    BatchJobs.push_back(std::move(Batch));
+  }
+  Cmds.swap(Unbatched);
+}
+
 using InputInfoMap =
   llvm::SmallMapVector<const llvm::opt::Arg *, CompileJobAction::InputInfo, 16>;
 
@@ -110,10 +381,14 @@ static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      // Skip the bridging PCH, which compile jobs have as an input too.
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
+      info.previousDuration = getExpectedDuration(entry.first);
       info.status = entry.second ?
           CompileJobAction::InputInfo::NeedsCascadingBuild :
           CompileJobAction::InputInfo::NeedsNonCascadingBuild;
@@ -126,11 +401,19 @@ static void populateInputInfoMap(InputInfoMap &inputs,
     if (!compileAction)
       continue;
 
+    // Jobs that didn't need to run keep the duration of their last run.
+    auto duration = endState.Durations.find(entry);
+    auto previousDuration = (duration != endState.Durations.end()) ?
+        duration->second : compileAction->getInputInfo().previousDuration;
+
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
+      info.previousDuration = previousDuration;
       info.status = CompileJobAction::InputInfo::UpToDate;
       inputs[&inputFile->getInputArg()] = info;
     }
@@ -172,9 +455,27 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
   }
 }
 
+/// Returns the interface hash recorded in the serialized module at \p path, or
+/// an empty string if \p path isn't a module this compiler can read.
+static std::string getExternalInterfaceHash(StringRef path) {
+  if (!llvm::sys::path::extension(path).endswith(SERIALIZED_MODULE_EXTENSION))
+    return std::string();
+
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return std::string();
+
+  auto info = serialization::validateSerializedAST(buffer.get()->getBuffer());
+  if (info.status != serialization::Status::Valid)
+    return std::string();
+  return info.interfaceHash;
+}
+
 static void writeCompilationRecord(StringRef path, StringRef argsHash,
                                    llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+                                   const InputInfoMap &inputs,
+                                   const DependencyGraph<const Job *> &depGraph) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -213,6 +514,32 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  bool wroteDurations = false;
+  for (auto &entry : inputs) {
+    if (entry.second.previousDuration == llvm::sys::TimeValue::ZeroTime())
+      continue;
+    if (!wroteDurations) {
+      out << "durations:\n";
+      wroteDurations = true;
+    }
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": ";
+    writeTimeValue(out, entry.second.previousDuration);
+    out << "\n";
+  }
+
+  bool wroteInterfaceHashes = false;
+  for (StringRef dependency : depGraph.getExternalDependencies()) {
+    std::string interfaceHash = getExternalInterfaceHash(dependency);
+    if (interfaceHash.empty())
+      continue;
+    if (!wroteInterfaceHashes) {
+      out << "external_interface_hashes:\n";
+      wroteInterfaceHashes = true;
+    }
+    out << "  \"" << llvm::yaml::escape(dependency) << "\": \""
+        << llvm::yaml::escape(interfaceHash) << "\"\n";
+  }
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -286,6 +613,27 @@ int Compilation::performJobsImpl() {
     });
   };
 
+  // In batch mode, the compile jobs that are ready before anything runs are
+  // held back so they can be combined into fewer frontend invocations.
+  bool CollectBatchableCommands = EnableBatchMode;
+
+  std::unique_ptr<CompilationCache> Cache;
+  if (!CompilationCachePath.empty() && !SkipTaskExecution)
+    Cache.reset(new CompilationCache(CompilationCachePath));
+
+  // Frontend jobs go to the compile server, if there is one; everything else
+  // runs in a process of its own.
+  auto addTask = [&](const Job *Cmd) {
+    const llvm::opt::ArgStringList &Args = Cmd->getArguments();
+    if (!CompileServerPath.empty() && !Args.empty() &&
+        StringRef(Args.front()) == "-frontend") {
+      TQ->addServerTask(CompileServerPath, Cmd->getExecutable(), Args,
+                        (void *)Cmd);
+      return;
+    }
+    TQ->addTask(Cmd->getExecutable(), Args, llvm::None, (void *)Cmd);
+  };
+
   // Set up scheduleCommandIfNecessaryAndPossible.
   // This will only schedule the given command if it has not been scheduled
   // and if all of its inputs are in FinishedCommands.
@@ -307,8 +655,27 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+
+    // A job whose results are in the cache is finished once the task queue
+    // gets going again, rather than right away, so that the dependency graph
+    // is never updated while this job is still being scheduled.
+    if (Cache && CompilationCache::isCacheable(Cmd)) {
+      CompilationCache::Key Key;
+      if (Cache->computeKey(Cmd, getInputFiles(), Key)) {
+        std::string Output;
+        if (Cache->restore(Cmd, Key, Output)) {
+          State.RestoredCommands.push_back({Cmd, std::move(Output)});
+          return;
+        }
+        State.CacheKeys[Cmd] = Key;
+      }
+    }
+
+    if (CollectBatchableCommands && isBatchable(Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
+    addTask(Cmd);
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -325,8 +692,14 @@ int Compilation::performJobsImpl() {
     }
   };
 
-  // Schedule all jobs we can.
-  for (const Job *Cmd : getJobs()) {
+  // Schedule all jobs we can, starting with the ones that took longest last
+  // time. With only one job running at a time the order doesn't matter.
+  SmallVector<const Job *, 16> JobsInScheduleOrder(getJobs().begin(),
+                                                   getJobs().end());
+  if (NumberOfParallelCommands > 1)
+    sortByExpectedDuration(JobsInScheduleOrder);
+
+  for (const Job *Cmd : JobsInScheduleOrder) {
     if (!getIncrementalBuildEnabled()) {
       scheduleCommandIfNecessaryAndPossible(Cmd);
       continue;
@@ -401,6 +774,18 @@ int Compilation::performJobsImpl() {
         if (depStatus.getLastModificationTime() < LastBuildTime)
           continue;
 
+      // A rebuilt module whose interface didn't change can't affect anything
+      // that depends on it.
+      auto lastHash = LastExternalInterfaceHashes.find(dependency);
+      if (lastHash != LastExternalInterfaceHashes.end() &&
+          lastHash->getValue() == getExternalInterfaceHash(dependency)) {
+        if (ShowIncrementalBuildDecisions)
+          llvm::outs() << "Interface of "
+                       << llvm::sys::path::filename(dependency)
+                       << " is unchanged\n";
+        continue;
+      }
+
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
       // trigger rebuilds through the dependency graph.
@@ -412,6 +797,9 @@ int Compilation::performJobsImpl() {
       noteBuilding(externalCmd, "because of external dependencies");
     }
 
+    if (NumberOfParallelCommands > 1)
+      sortByExpectedDuration(AdditionalOutOfDateCommands);
+
     for (auto *AdditionalCmd : AdditionalOutOfDateCommands) {
       if (!DeferredCommands.count(AdditionalCmd))
         continue;
@@ -420,20 +808,126 @@ int Compilation::performJobsImpl() {
     }
   }
 
+  if (CollectBatchableCommands) {
+    formBatchJobs(State.PendingBatchableCommands, NumberOfParallelCommands,
+                  State.BatchJobs, State.BatchJobConstituents);
+    for (const Job *Cmd : State.PendingBatchableCommands)
+      addTask(Cmd);
+    for (auto &BatchCmd : State.BatchJobs)
+      addTask(BatchCmd.get());
+    State.PendingBatchableCommands.clear();
+
+    // Jobs which only become ready later run on their own.
+    CollectBatchableCommands = false;
+  }
+
   int Result = EXIT_SUCCESS;
 
+  // For the time trace, every run so far, the runs still going, and which job
+  // slots they're using.
+  std::vector<time_trace::JobRun> TimeTraceRuns;
+  llvm::SmallDenseMap<const Job *, size_t, 16> RunningTimeTraceRuns;
+  SmallVector<bool, 8> TimeTraceSlotsInUse;
+
+  auto endTimeTraceRun = [&] (const Job *Cmd) {
+    auto Running = RunningTimeTraceRuns.find(Cmd);
+    if (Running == RunningTimeTraceRuns.end())
+      return;
+    time_trace::JobRun &Run = TimeTraceRuns[Running->second];
+    Run.End = llvm::sys::TimeValue::now();
+    TimeTraceSlotsInUse[Run.Slot] = false;
+    RunningTimeTraceRuns.erase(Running);
+  };
+
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    State.StartTimes[BeganCmd] = llvm::sys::TimeValue::now();
+
+    if (!TimeTracePath.empty()) {
+      // Show the run on the lowest free slot.
+      auto FreeSlot = std::find(TimeTraceSlotsInUse.begin(),
+                                TimeTraceSlotsInUse.end(), false);
+      unsigned Slot = FreeSlot - TimeTraceSlotsInUse.begin();
+      if (FreeSlot == TimeTraceSlotsInUse.end())
+        TimeTraceSlotsInUse.push_back(true);
+      else
+        *FreeSlot = true;
+
+      auto Now = State.StartTimes[BeganCmd];
+      RunningTimeTraceRuns[BeganCmd] = TimeTraceRuns.size();
+      TimeTraceRuns.push_back({BeganCmd, Pid, Slot, Now, Now});
+    }
 
     // For verbose output, print out each command as it begins execution.
     if (Level == OutputLevel::Verbose)
       BeganCmd->printCommandLine(llvm::errs());
     else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+      for (const Job *Cmd : State.getConstituents(BeganCmd))
+        parseable_output::emitBeganMessage(llvm::errs(), *Cmd, Pid);
+  };
+
+  // Once a job has succeeded, schedule whatever was waiting on it.
+  auto handleSucceededJob = [&] (const Job *Cmd) {
+    // When a task finishes, we need to reevaluate the other commands that
+    // might have been blocked.
+    markFinished(Cmd);
+
+    // In order to handle both old dependencies that have disappeared and new
+    // dependencies that have arisen, we need to reload the dependency file.
+    if (getIncrementalBuildEnabled()) {
+      const CommandOutput &Output = Cmd->getOutput();
+      StringRef DependenciesFile =
+        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
+      if (!DependenciesFile.empty()) {
+        SmallVector<const Job *, 16> Dependents;
+        bool wasCascading = DepGraph.isMarked(Cmd);
+
+        switch (DepGraph.loadFromPath(Cmd, DependenciesFile)) {
+        case DependencyGraphImpl::LoadResult::HadError:
+          disableIncrementalBuild();
+          for (const Job *Deferred : DeferredCommands)
+            scheduleCommandIfNecessaryAndPossible(Deferred);
+          DeferredCommands.clear();
+          Dependents.clear();
+          break;
+        case DependencyGraphImpl::LoadResult::UpToDate:
+          if (!wasCascading)
+            break;
+          SWIFT_FALLTHROUGH;
+        case DependencyGraphImpl::LoadResult::AffectsDownstream:
+          DepGraph.markTransitive(Dependents, Cmd);
+          break;
+        }
+
+        for (const Job *Dependent : Dependents) {
+          DeferredCommands.erase(Dependent);
+          noteBuilding(Dependent, "because of dependencies discovered later");
+          scheduleCommandIfNecessaryAndPossible(Dependent);
+        }
+      }
+    }
+  };
+
+  // Treat the jobs restored from the compilation cache as if they had just
+  // run, which may let others be restored in turn.
+  auto finishRestoredCommands = [&] {
+    while (!State.RestoredCommands.empty()) {
+      auto Restored = State.RestoredCommands.pop_back_val();
+      const Job *Cmd = Restored.first;
+
+      // There's no process to report on, so as far as parseable output is
+      // concerned the job was skipped.
+      if (Level == OutputLevel::Parseable)
+        parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
+      else
+        llvm::errs() << Restored.second;
+
+      handleSucceededJob(Cmd);
+    }
   };
 
   // Set up a callback which will be called immediately after a task has
@@ -444,11 +938,18 @@ int Compilation::performJobsImpl() {
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
                            void *Context) -> TaskFinishedResponse {
     const Job *FinishedCmd = (const Job *)Context;
+    ArrayRef<const Job *> Constituents = State.getConstituents(FinishedCmd);
+    endTimeTraceRun(FinishedCmd);
+    StringRef FullOutput = Output;
 
     if (Level == OutputLevel::Parseable) {
-      // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
+      // Parseable output was requested. A batch job's output can't be split
+      // up by file, so it all goes with the first one.
+      for (const Job *Cmd : Constituents) {
+        parseable_output::emitFinishedMessage(llvm::errs(), *Cmd, Pid,
+                                              ReturnCode, Output);
+        Output = StringRef();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -477,56 +978,51 @@ int Compilation::performJobsImpl() {
           TaskFinishedResponse::StopExecution;
     }
 
-    // When a task finishes, we need to reevaluate the other commands that
-    // might have been blocked.
-    markFinished(FinishedCmd);
-
-    // In order to handle both old dependencies that have disappeared and new
-    // dependencies that have arisen, we need to reload the dependency file.
-    if (getIncrementalBuildEnabled()) {
-      const CommandOutput &Output = FinishedCmd->getOutput();
-      StringRef DependenciesFile =
-        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-      if (!DependenciesFile.empty()) {
-        SmallVector<const Job *, 16> Dependents;
-        bool wasCascading = DepGraph.isMarked(FinishedCmd);
-
-        switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
-        case DependencyGraphImpl::LoadResult::HadError:
-          disableIncrementalBuild();
-          for (const Job *Cmd : DeferredCommands)
-            scheduleCommandIfNecessaryAndPossible(Cmd);
-          DeferredCommands.clear();
-          Dependents.clear();
-          break;
-        case DependencyGraphImpl::LoadResult::UpToDate:
-          if (!wasCascading)
-            break;
-          SWIFT_FALLTHROUGH;
-        case DependencyGraphImpl::LoadResult::AffectsDownstream:
-          DepGraph.markTransitive(Dependents, FinishedCmd);
-          break;
-        }
+    auto StartTime = State.StartTimes.find(FinishedCmd);
+    if (StartTime != State.StartTimes.end()) {
+      // There's no telling how a batch job's time was spent, so share it out
+      // evenly among the files it compiled.
+      llvm::sys::TimeValue Duration =
+          llvm::sys::TimeValue::now() - StartTime->second;
+      llvm::sys::TimeValue Share;
+      Share.usec(Duration.usec() / Constituents.size());
+      for (const Job *Cmd : Constituents)
+        State.Durations[Cmd] = Share;
+      State.StartTimes.erase(StartTime);
+    }
 
-        for (const Job *Cmd : Dependents) {
-          DeferredCommands.erase(Cmd);
-          noteBuilding(Cmd, "because of dependencies discovered later");
-          scheduleCommandIfNecessaryAndPossible(Cmd);
-        }
+    if (Cache) {
+      // As with parseable output, a batch job's output goes with its first
+      // file.
+      for (const Job *Cmd : Constituents) {
+        auto Key = State.CacheKeys.find(Cmd);
+        if (Key == State.CacheKeys.end())
+          continue;
+        Cache->store(Cmd, Key->second, FullOutput);
+        FullOutput = StringRef();
+        State.CacheKeys.erase(Key);
       }
     }
 
+    for (const Job *Cmd : Constituents)
+      handleSucceededJob(Cmd);
+    finishRestoredCommands();
+
     return TaskFinishedResponse::ContinueExecution;
   };
 
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
+    endTimeTraceRun(SignalledCmd);
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+      for (const Job *Cmd : State.getConstituents(SignalledCmd)) {
+        parseable_output::emitSignalledMessage(llvm::errs(), *Cmd, Pid,
+                                               ErrorMsg, Output);
+        Output = StringRef();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -547,6 +1043,12 @@ int Compilation::performJobsImpl() {
     return TaskFinishedResponse::StopExecution;
   };
 
+  // The skipped commands that depend on a file whose interface changed, but
+  // on none of the declarations that changed with it.
+  SmallPtrSet<const Job *, 16> SparedCommands;
+
+  llvm::sys::TimeValue ExecutionStartTime = llvm::sys::TimeValue::now();
+  finishRestoredCommands();
   do {
     // Ask the TaskQueue to execute.
     TQ->execute(taskBegan, taskFinished, taskSignalled);
@@ -559,13 +1061,79 @@ int Compilation::performJobsImpl() {
         parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
       }
 
+      if (DepGraph.wasSparedByFingerprints(Cmd) &&
+          SparedCommands.insert(Cmd).second && ShowIncrementalBuildDecisions) {
+        llvm::outs() << "Skipping "
+                     << llvm::sys::path::filename(
+                          Cmd->getOutput().getBaseInput(0))
+                     << " because none of the declarations it uses changed\n";
+      }
+
       State.ScheduledCommands.insert(Cmd);
       markFinished(Cmd);
     }
+    finishRestoredCommands();
 
     // ...which may allow us to go on and do later tasks.
   } while (Result == 0 && TQ->hasRemainingTasks());
 
+  if (!TimeTracePath.empty() && !SkipTaskExecution) {
+    std::error_code EC;
+    llvm::raw_fd_ostream Out(TimeTracePath, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      Diags.diagnose(SourceLoc(), diag::error_opening_output, TimeTracePath,
+                     EC.message());
+    } else {
+      time_trace::writeTimeTrace(Out, TimeTraceRuns, ExecutionStartTime);
+    }
+  }
+
+  if (ShowIncrementalBuildDecisions && !SparedCommands.empty()) {
+    llvm::outs() << "Declaration fingerprints: " << SparedCommands.size()
+                 << " dependent jobs skipped\n";
+  }
+
+  if (ShowCompilationCacheStatistics && Cache) {
+    auto &Stats = Cache->getStatistics();
+    llvm::outs() << "Compilation cache: " << Stats.NumHits << " of "
+                 << Stats.NumLookups << " jobs restored";
+    if (Stats.NumLookups)
+      llvm::outs() << " (" << Stats.NumHits * 100 / Stats.NumLookups << "%)";
+    llvm::outs() << ", " << Stats.BytesRestored << " bytes restored, "
+                 << Stats.NumStores << " jobs stored\n";
+  }
+
+  if (ShowJobSchedulingStatistics) {
+    auto &Stats = TQ->getStatistics();
+    llvm::outs() << "Job scheduling: " << Stats.NumRefilledSlots
+                 << " jobs started in freed slots";
+    if (Stats.NumRefilledSlots) {
+      llvm::outs() << ", "
+                   << Stats.TotalRefillLatencyInMicroseconds /
+                        Stats.NumRefilledSlots
+                   << "us average and "
+                   << Stats.MaxRefillLatencyInMicroseconds
+                   << "us maximum delay";
+    }
+    llvm::outs() << "\n";
+
+    // Report how much of the time the job slots spent waiting, which is what
+    // running long jobs first is meant to cut down.
+    llvm::sys::TimeValue Elapsed =
+        llvm::sys::TimeValue::now() - ExecutionStartTime;
+    uint64_t ElapsedMicroseconds = Elapsed.usec();
+    uint64_t BusyMicroseconds = 0;
+    for (auto &Entry : State.Durations)
+      BusyMicroseconds += Entry.second.usec();
+    uint64_t SlotMicroseconds = ElapsedMicroseconds * NumberOfParallelCommands;
+    uint64_t IdleMicroseconds = 0;
+    if (SlotMicroseconds > BusyMicroseconds)
+      IdleMicroseconds = SlotMicroseconds - BusyMicroseconds;
+    llvm::outs() << "Job slots: " << NumberOfParallelCommands << " for "
+                 << ElapsedMicroseconds << "us, "
+                 << IdleMicroseconds << "us idle\n";
+  }
+
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
            "some blocking commands never finished properly");
@@ -596,7 +1164,7 @@ int Compilation::performJobsImpl() {
     populateInputInfoMap(InputInfo, State);
     checkForOutOfDateInputs(Diags, InputInfo);
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, DepGraph);
   }
 
   if (Result == 0)
@@ -0,0 +1,319 @@
+//===--- CompilationCache.cpp - Reuse results of identical jobs -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/CompilationCache.h"
+#include "swift/Basic/Version.h"
+#include "swift/Driver/Action.h"
+#include "swift/Driver/DependencyGraph.h"
+#include "swift/Driver/Job.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Option/Arg.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <tuple>
+
+using namespace swift;
+using namespace swift::driver;
+
+/// Bump this whenever the layout of an entry or what goes into a key changes.
+static const StringRef CacheVersion = "swift-compilation-cache-1";
+
+static const StringRef ManifestSuffix = "manifest";
+static const StringRef OutputTextSuffix = "log";
+
+/// The kinds of output an entry can hold.
+static bool isCacheableOutputType(types::ID type) {
+  switch (type) {
+  case types::TY_Object:
+  case types::TY_SwiftModuleFile:
+  case types::TY_SwiftModuleDocFile:
+  case types::TY_SwiftDeps:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Calls \p fn with the type and path of each output of \p Cmd.
+template <typename Fn>
+static void forEachOutput(const Job *Cmd, const Fn &fn) {
+  const CommandOutput &Output = Cmd->getOutput();
+  for (const std::string &path : Output.getPrimaryOutputFilenames())
+    fn(Output.getPrimaryOutputType(), StringRef(path));
+  types::forAllTypes([&](types::ID type) {
+    const std::string &path = Output.getAdditionalOutputForType(type);
+    if (!path.empty())
+      fn(type, StringRef(path));
+  });
+}
+
+/// Writes \p contents to \p path without anyone reading the file seeing it
+/// half written.
+static bool writeAtomically(StringRef path, StringRef contents) {
+  SmallString<128> tmpPath(path);
+  tmpPath += "-%%%%%%";
+  int tmpFD;
+  if (llvm::sys::fs::createUniqueFile(tmpPath.str(), tmpFD, tmpPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream out(tmpFD, /*shouldClose=*/true);
+    out << contents;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(tmpPath, path)) {
+    llvm::sys::fs::remove(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+StringRef CompilationCache::getFileHash(StringRef path) {
+  auto inserted = FileHashes.insert({path, std::string()});
+  std::string &result = inserted.first->getValue();
+  if (!inserted.second)
+    return result;
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return result;
+
+  llvm::MD5 hash;
+  hash.update(buffer.get()->getBuffer());
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  SmallString<32> digestString;
+  llvm::MD5::stringifyResult(digest, digestString);
+  result = digestString.str();
+  return result;
+}
+
+std::string CompilationCache::getEntryPath(StringRef key,
+                                           StringRef suffix) const {
+  SmallString<128> path(Directory);
+  llvm::sys::path::append(path, key);
+  path += ".";
+  path += suffix;
+  return path.str();
+}
+
+bool CompilationCache::isCacheable(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return false;
+  if (!Cmd->getInputs().empty() || !Cmd->getExtraEnvironment().empty())
+    return false;
+  if (!Cmd->getFilelistInfo().path.empty())
+    return false;
+
+  const CommandOutput &Output = Cmd->getOutput();
+  if (Output.getPrimaryOutputFilenames().size() != 1 ||
+      Output.getAdditionalOutputForType(types::TY_SwiftDeps).empty())
+    return false;
+
+  bool allOutputsCacheable = true;
+  forEachOutput(Cmd, [&](types::ID type, StringRef path) {
+    if (!isCacheableOutputType(type))
+      allOutputsCacheable = false;
+  });
+  if (!allOutputsCacheable)
+    return false;
+
+  const llvm::opt::ArgStringList &Args = Cmd->getArguments();
+  return std::count(Args.begin(), Args.end(), StringRef("-primary-file")) == 1;
+}
+
+bool CompilationCache::computeKey(const Job *Cmd, ArrayRef<InputPair> Inputs,
+                                  Key &result) {
+  assert(isCacheable(Cmd) && "computing a key for an uncacheable job");
+
+  llvm::MD5 hash;
+  auto addString = [&hash](StringRef string) {
+    hash.update(string);
+    hash.update(StringRef("", 1));
+  };
+
+  addString(CacheVersion);
+  addString(version::getSwiftFullVersion());
+
+  // The outputs are usually temporary files with made-up names, so stand in
+  // for them with their types.
+  llvm::StringMap<types::ID> OutputTypes;
+  forEachOutput(Cmd, [&](types::ID type, StringRef path) {
+    OutputTypes[path] = type;
+  });
+  for (const char *Arg : Cmd->getArguments()) {
+    // The profile a job uses is an input like any other.
+    if (StringRef(Arg).startswith("-profile-use=")) {
+      StringRef path = StringRef(Arg).substr(strlen("-profile-use="));
+      StringRef fileHash = getFileHash(path);
+      if (fileHash.empty())
+        return false;
+      addString(fileHash);
+    }
+
+    auto output = OutputTypes.find(Arg);
+    if (output == OutputTypes.end()) {
+      addString(Arg);
+    } else {
+      SmallString<32> placeholder("<output:");
+      placeholder += types::getTypeName(output->getValue());
+      placeholder += ">";
+      addString(placeholder);
+    }
+  }
+
+  // Every source file of the module can affect the compilation of any of
+  // them.
+  for (const InputPair &Input : Inputs) {
+    if (!types::isPartOfSwiftCompilation(Input.first))
+      continue;
+    StringRef path = Input.second->getValue();
+    StringRef fileHash = getFileHash(path);
+    if (fileHash.empty())
+      return false;
+    addString(path);
+    addString(fileHash);
+  }
+
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  llvm::MD5::stringifyResult(digest, result);
+  return true;
+}
+
+bool CompilationCache::restore(const Job *Cmd, StringRef key,
+                               std::string &output) {
+  ++Stats.NumLookups;
+
+  auto manifest = llvm::MemoryBuffer::getFile(getEntryPath(key,
+                                                           ManifestSuffix));
+  if (!manifest)
+    return false;
+
+  // Check the modules the job imported before touching any of its outputs.
+  SmallVector<StringRef, 16> lines;
+  manifest.get()->getBuffer().split(lines, "\n", /*MaxSplit=*/-1,
+                                    /*KeepEmpty=*/false);
+  if (lines.empty() || lines.front() != CacheVersion)
+    return false;
+  SmallVector<types::ID, 4> outputTypes;
+  for (StringRef line : llvm::makeArrayRef(lines).slice(1)) {
+    StringRef kind, rest;
+    std::tie(kind, rest) = line.split(' ');
+    if (kind == "output") {
+      types::ID type = types::lookupTypeForName(rest);
+      if (!isCacheableOutputType(type))
+        return false;
+      outputTypes.push_back(type);
+    } else if (kind == "external") {
+      StringRef expectedHash, path;
+      std::tie(expectedHash, path) = rest.split(' ');
+      if (path.empty() || getFileHash(path) != expectedHash)
+        return false;
+    } else {
+      return false;
+    }
+  }
+
+  const CommandOutput &Output = Cmd->getOutput();
+  uint64_t bytesRestored = 0;
+  for (types::ID type : outputTypes) {
+    StringRef path = Output.getAnyOutputForType(type);
+    if (path.empty())
+      return false;
+    auto contents = llvm::MemoryBuffer::getFile(
+        getEntryPath(key, types::getTypeTempSuffix(type)));
+    if (!contents)
+      return false;
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+    if (error)
+      return false;
+    out << contents.get()->getBuffer();
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      return false;
+    }
+    bytesRestored += contents.get()->getBufferSize();
+  }
+
+  auto outputText = llvm::MemoryBuffer::getFile(
+      getEntryPath(key, OutputTextSuffix));
+  if (!outputText)
+    return false;
+  output = outputText.get()->getBuffer();
+
+  ++Stats.NumHits;
+  Stats.BytesRestored += bytesRestored;
+  return true;
+}
+
+void CompilationCache::store(const Job *Cmd, StringRef key, StringRef output) {
+  // An existing entry is replaced, since it may have been stored with
+  // different modules.
+  std::string manifestPath = getEntryPath(key, ManifestSuffix);
+  if (llvm::sys::fs::create_directories(Directory))
+    return;
+
+  std::string manifest;
+  llvm::raw_string_ostream manifestOut(manifest);
+  manifestOut << CacheVersion << "\n";
+
+  // The reference dependencies say which modules the job imported, so that a
+  // later lookup can check they haven't changed.
+  DependencyGraph<const Job *> Graph;
+  StringRef DependenciesFile =
+      Cmd->getOutput().getAdditionalOutputForType(types::TY_SwiftDeps);
+  if (Graph.loadFromPath(Cmd, DependenciesFile) ==
+        DependencyGraphImpl::LoadResult::HadError)
+    return;
+  for (StringRef dependency : Graph.getExternalDependencies()) {
+    StringRef fileHash = getFileHash(dependency);
+    if (fileHash.empty())
+      return;
+    manifestOut << "external " << fileHash << " " << dependency << "\n";
+  }
+
+  bool success = true;
+  forEachOutput(Cmd, [&](types::ID type, StringRef path) {
+    if (!success)
+      return;
+    auto contents = llvm::MemoryBuffer::getFile(path);
+    if (!contents ||
+        !writeAtomically(getEntryPath(key, types::getTypeTempSuffix(type)),
+                         contents.get()->getBuffer())) {
+      success = false;
+      return;
+    }
+    manifestOut << "output " << types::getTypeName(type) << "\n";
+  });
+  if (!success)
+    return;
+
+  // The manifest goes last: until it's there, the entry isn't used.
+  if (!writeAtomically(getEntryPath(key, OutputTextSuffix), output) ||
+      !writeAtomically(manifestPath, manifestOut.str()))
+    return;
+
+  ++Stats.NumStores;
+}
@@ -12,6 +12,8 @@
 
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/ReferenceDependencyFormat.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -48,15 +50,105 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using FingerprintCallbackTy = void(StringRef, StringRef);
+
+static LoadResult
+parseBinaryDependencyFile(StringRef data,
+                    llvm::function_ref<DependencyCallbackTy> providesCallback,
+                    llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
+  namespace refdeps = reference_dependencies;
+
+  LoadResult result = LoadResult::UpToDate;
+  auto updateResult = [&result](LoadResult update) -> bool {
+    switch (update) {
+    case LoadResult::HadError:
+      return false;
+    case LoadResult::UpToDate:
+      break;
+    case LoadResult::AffectsDownstream:
+      result = LoadResult::AffectsDownstream;
+      break;
+    }
+    return true;
+  };
+
+  SmallString<64> appended;
+  StringRef interfaceHash;
+  bool success = refdeps::readBinary(data, interfaceHash,
+                                     [&](const refdeps::Entry &entry) -> bool {
+    DependencyKind kind;
+    bool isDepends = true;
+    switch (entry.section) {
+    case refdeps::Section::ProvidesTopLevel:
+      isDepends = false;
+      SWIFT_FALLTHROUGH;
+    case refdeps::Section::DependsTopLevel:
+      kind = DependencyKind::TopLevelName;
+      break;
+    case refdeps::Section::ProvidesNominal:
+      isDepends = false;
+      SWIFT_FALLTHROUGH;
+    case refdeps::Section::DependsNominal:
+      kind = DependencyKind::NominalType;
+      break;
+    case refdeps::Section::ProvidesMember:
+      isDepends = false;
+      SWIFT_FALLTHROUGH;
+    case refdeps::Section::DependsMember:
+      kind = DependencyKind::NominalTypeMember;
+      break;
+    case refdeps::Section::ProvidesDynamicLookup:
+      isDepends = false;
+      SWIFT_FALLTHROUGH;
+    case refdeps::Section::DependsDynamicLookup:
+      kind = DependencyKind::DynamicLookupName;
+      break;
+    case refdeps::Section::DependsExternal:
+      kind = DependencyKind::ExternalFile;
+      break;
+    case refdeps::Section::Fingerprints:
+      fingerprintCallback(entry.name, entry.member);
+      return true;
+    }
+    auto &callback = isDepends ? dependsCallback : providesCallback;
+
+    if (kind != DependencyKind::NominalTypeMember)
+      return updateResult(callback(entry.name, kind, entry.isCascading));
+
+    // As in the YAML format, smash the type and member names together.
+    appended = entry.name;
+    appended.push_back('\0');
+    appended += entry.member;
+    return updateResult(callback(appended.str(), kind, entry.isCascading));
+  });
+  if (!success)
+    return LoadResult::HadError;
+
+  if (!interfaceHash.empty() &&
+      !updateResult(interfaceHashCallback(interfaceHash)))
+    return LoadResult::HadError;
+
+  return result;
+}
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
   namespace yaml = llvm::yaml;
 
-  // FIXME: Switch to a format other than YAML.
+  // The frontend writes the binary format for the driver; YAML is still
+  // accepted, since it's easier to read and to write by hand.
+  if (reference_dependencies::isBinaryFormat(buffer.getBuffer())) {
+    return parseBinaryDependencyFile(buffer.getBuffer(), providesCallback,
+                                     dependsCallback, interfaceHashCallback,
+                                     fingerprintCallback);
+  }
+
   llvm::SourceMgr SM;
   yaml::Stream stream(buffer.getMemBufferRef(), SM);
   auto I = stream.begin();
@@ -105,6 +197,37 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
+    } else if (keyString == "fingerprints") {
+      // Fingerprints come in the form ["name", "fingerprint"], where the name
+      // of a member is already smashed together.
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        auto iter = entry->begin();
+        auto *name = dyn_cast<yaml::ScalarNode>(&*iter);
+        if (!name)
+          return LoadResult::HadError;
+        ++iter;
+
+        auto *fingerprint = dyn_cast<yaml::ScalarNode>(&*iter);
+        if (!fingerprint)
+          return LoadResult::HadError;
+        ++iter;
+
+        // FIXME: LLVM's YAML support doesn't implement == correctly for end
+        // iterators.
+        assert(!(iter != entry->end()));
+
+        SmallString<64> nameString{name->getValue(scratch)};
+        fingerprintCallback(nameString.str(), fingerprint->getValue(scratch));
+      }
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -222,6 +345,10 @@ DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
 LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
+  ChangedProvides.erase(node);
+  llvm::StringSet<> newlyProvided;
+  llvm::StringMap<std::string> newFingerprints;
+  bool interfaceChanged = false;
 
   auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
                                       bool isCascading) -> LoadResult {
@@ -251,9 +378,10 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
   };
 
   auto providesCallback =
-      [this, node, &provides](StringRef name, DependencyKind kind,
-                              bool isCascading) -> LoadResult {
+      [&provides, &newlyProvided](StringRef name, DependencyKind kind,
+                                  bool isCascading) -> LoadResult {
     assert(isCascading);
+    newlyProvided.insert(name);
     auto iter = std::find_if(provides.begin(), provides.end(),
                              [name](const ProvidesEntryTy &entry) -> bool {
       return name == entry.name;
@@ -267,7 +395,8 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  auto interfaceHashCallback = [this, node](StringRef hash) -> LoadResult {
+  auto interfaceHashCallback = [this, node,
+                                &interfaceChanged](StringRef hash) -> LoadResult {
     auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
 
     if (insertResult.second) {
@@ -276,17 +405,65 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
       return LoadResult::UpToDate;
     }
 
+    // Whether this affects the node's dependents depends on the
+    // fingerprints, which may not have been read yet.
     auto iter = insertResult.first;
     if (hash != iter->second) {
       iter->second = hash;
-      return LoadResult::AffectsDownstream;
+      interfaceChanged = true;
     }
 
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  auto fingerprintCallback = [&newFingerprints](StringRef name,
+                                                StringRef fingerprint) {
+    newFingerprints[name] = fingerprint;
+  };
+
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          fingerprintCallback);
+  if (result == LoadResult::HadError)
+    return result;
+
+  auto &fingerprints = Fingerprints[node];
+  if (interfaceChanged) {
+    // Only the names whose fingerprints changed affect the node's dependents.
+    // That can only be trusted if there are fingerprints for everything the
+    // node provides, both before and after.
+    bool isPrecise = !fingerprints.empty() && !newFingerprints.empty() &&
+                     std::all_of(newlyProvided.begin(), newlyProvided.end(),
+                                 [&](const llvm::StringMapEntry<char> &entry) {
+      return newFingerprints.count(entry.getKey());
+    });
+
+    if (!isPrecise) {
+      result = LoadResult::AffectsDownstream;
+    } else {
+      llvm::StringSet<> changed;
+      for (auto &entry : newFingerprints) {
+        auto old = fingerprints.find(entry.getKey());
+        if (old == fingerprints.end() || old->getValue() != entry.getValue())
+          changed.insert(entry.getKey());
+      }
+      // Names that are no longer provided have changed too.
+      for (auto &entry : fingerprints)
+        if (!newFingerprints.count(entry.getKey()))
+          changed.insert(entry.getKey());
+
+      // If the node now depends on something already dirty, everything it
+      // provides is affected anyway.
+      if (!changed.empty() && result != LoadResult::AffectsDownstream) {
+        ChangedProvides[node] = std::move(changed);
+        result = LoadResult::AffectsDownstream;
+      }
+    }
+  }
+  fingerprints = std::move(newFingerprints);
+
+  return result;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -321,8 +498,13 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
+  // The dependents of the starting node that only use names it provides
+  // whose declarations haven't changed.
+  SmallVector<const void *, 16> unchangedDependents;
+
   auto addDependentsToWorklist = [&](const void *next,
-                                     ArrayRef<MarkTracerImpl::Entry> reason) {
+                                     ArrayRef<MarkTracerImpl::Entry> reason,
+                                     const llvm::StringSet<> *changed) {
     auto allProvided = Provides.find(next);
     if (allProvided == Provides.end())
       return;
@@ -332,6 +514,14 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       if (allDependents == Dependencies.end())
         continue;
 
+      if (changed && !changed->count(provided.name)) {
+        for (const auto &dependent : allDependents->second.first)
+          if (dependent.node != next &&
+              (provided.kindMask & dependent.kindMask))
+            unchangedDependents.push_back(dependent.node);
+        continue;
+      }
+
       if (allDependents->second.second.contains(provided.kindMask))
         continue;
 
@@ -373,8 +563,17 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   };
 
   // Always mark through the starting node, even if it's already marked.
+  // If only some of the names it provides have changed, only follow those.
   markIntransitive(node);
-  addDependentsToWorklist(node, {});
+  llvm::StringSet<> changedProvides;
+  auto changedIter = ChangedProvides.find(node);
+  bool onlyChangedProvides = changedIter != ChangedProvides.end();
+  if (onlyChangedProvides) {
+    changedProvides = std::move(changedIter->second);
+    ChangedProvides.erase(changedIter);
+  }
+  addDependentsToWorklist(node, {},
+                          onlyChangedProvides ? &changedProvides : nullptr);
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -386,11 +585,15 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addDependentsToWorklist(next.Node, next.Reason, nullptr);
     if (!markIntransitive(next.Node))
       continue;
     record(next);
   }
+
+  for (const void *dependent : unchangedDependents)
+    if (!visitedSet.count(dependent) && !isMarked(dependent))
+      SparedByFingerprints.insert(dependent);
 }
 
 void DependencyGraphImpl::MarkTracerImpl::printPath(
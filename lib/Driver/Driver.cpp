@@ -38,6 +38,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/config.h"
 #include "llvm/Option/Arg.h"
@@ -48,6 +49,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
@@ -193,7 +195,8 @@ using InputInfoMap = Driver::InputInfoMap;
 
 static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
                                  const InputFileList &inputs,
-                                 StringRef buildRecordPath) {
+                                 StringRef buildRecordPath,
+                                 llvm::StringMap<std::string> &interfaceHashes) {
   // Treat a missing file as "no previous build".
   auto buffer = llvm::MemoryBuffer::getFile(buildRecordPath);
   if (!buffer)
@@ -215,6 +218,7 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
   SmallString<64> scratch;
 
   llvm::StringMap<InputInfo> previousInputs;
+  llvm::StringMap<llvm::sys::TimeValue> previousDurations;
   bool versionValid = false;
   bool optionsMatch = true;
 
@@ -316,6 +320,43 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr == "durations") {
+      auto *durationMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!durationMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = durationMap->begin(), e = durationMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        if (!key)
+          return true;
+
+        llvm::sys::TimeValue duration;
+        if (readTimeValue(i->getValue(), duration))
+          return true;
+
+        previousDurations[key->getValue(scratch)] = duration;
+      }
+
+    } else if (keyStr == "external_interface_hashes") {
+      auto *hashMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!hashMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = hashMap->begin(), e = hashMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!key || !value)
+          return true;
+
+        SmallString<32> valueScratch;
+        interfaceHashes[key->getValue(scratch)] =
+            value->getValue(valueScratch);
+      }
     }
   }
 
@@ -330,7 +371,11 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
       continue;
     }
     ++numInputsFromPrevious;
-    map[inputPair.second] = iter->getValue();
+    InputInfo info = iter->getValue();
+    auto duration = previousDurations.find(inputPair.second->getValue());
+    if (duration != previousDurations.end())
+      info.previousDuration = duration->getValue();
+    map[inputPair.second] = info;
   }
 
   // If a file was removed, we've lost its dependency info. Rebuild everything.
@@ -360,6 +405,17 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     ArgList->hasArg(options::OPT_driver_skip_execution);
   bool ShowIncrementalBuildDecisions =
     ArgList->hasArg(options::OPT_driver_show_incremental);
+  bool ShowJobSchedulingStatistics =
+    ArgList->hasArg(options::OPT_driver_show_job_scheduling);
+  std::string TimeTracePath =
+    ArgList->getLastArgValue(options::OPT_driver_time_trace);
+  bool EnableBatchMode = ArgList->hasArg(options::OPT_enable_batch_mode);
+  std::string CompilationCachePath =
+    ArgList->getLastArgValue(options::OPT_compilation_cache_path);
+  bool ShowCompilationCacheStatistics =
+    ArgList->hasArg(options::OPT_driver_show_compilation_cache);
+  std::string CompileServerPath =
+    ArgList->getLastArgValue(options::OPT_use_compile_server);
 
   bool Incremental = ArgList->hasArg(options::OPT_incremental) &&
     !ArgList->hasArg(options::OPT_whole_module_optimization) &&
@@ -427,6 +483,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   computeArgsHash(ArgsHash, *TranslatedArgList);
 
   InputInfoMap outOfDateMap;
+  llvm::StringMap<std::string> externalInterfaceHashes;
   bool rebuildEverything = true;
   if (Incremental) {
     if (!OFM) {
@@ -450,7 +507,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
 
       } else {
         if (populateOutOfDateMap(outOfDateMap, ArgsHash, Inputs,
-                                 buildRecordPath)) {
+                                 buildRecordPath, externalInterfaceHashes)) {
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
           rebuildEverything = false;
@@ -513,6 +570,18 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
 
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
+  if (ShowJobSchedulingStatistics)
+    C->setShowsJobSchedulingStatistics();
+  if (!TimeTracePath.empty())
+    C->setTimeTracePath(TimeTracePath);
+  if (EnableBatchMode && OI.CompilerMode == OutputInfo::Mode::StandardCompile)
+    C->setBatchModeEnabled();
+  if (!CompilationCachePath.empty())
+    C->setCompilationCachePath(CompilationCachePath);
+  if (ShowCompilationCacheStatistics)
+    C->setShowsCompilationCacheStatistics();
+  if (!CompileServerPath.empty())
+    C->setCompileServerPath(CompileServerPath);
 
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
@@ -526,6 +595,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
       auto buildEntry = outOfDateMap.find(nullptr);
       if (buildEntry != outOfDateMap.end())
         C->setLastBuildTime(buildEntry->second.previousModTime);
+      C->setLastExternalInterfaceHashes(std::move(externalInterfaceHashes));
     }
   }
 
@@ -1121,6 +1191,24 @@ void Driver::buildActions(const ToolChain &TC,
   ActionList AllModuleInputs;
   ActionList AllLinkerInputs;
 
+  // With one frontend job per file, precompile the bridging header once
+  // instead of having every job parse it.
+  JobAction *PCH = nullptr;
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      Args.hasArg(options::OPT_enable_bridging_pch)) {
+    if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+      StringRef Value = A->getValue();
+      auto Ty = TC.lookupTypeForExtension(llvm::sys::path::extension(Value));
+      if (Ty == types::TY_ObjCHeader) {
+        StringRef PersistentPCHDir;
+        if (const Arg *DirArg = Args.getLastArg(options::OPT_pch_output_dir))
+          PersistentPCHDir = DirArg->getValue();
+        PCH = new GeneratePCHJobAction(new InputAction(*A, Ty),
+                                       PersistentPCHDir);
+      }
+    }
+  }
+
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
@@ -1146,6 +1234,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1153,6 +1243,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1185,8 +1277,10 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
+      case types::TY_PhaseTimeline:
         // We could in theory handle assembly or LLVM input, but let's not.
         // FIXME: What about LTO?
         Diags.diagnose(SourceLoc(), diag::error_unexpected_input_file,
@@ -1484,6 +1578,34 @@ static StringRef getOutputFilename(Compilation &C,
     }
   }
 
+  // A persistent PCH is named after the header's contents and the options
+  // it's built with, so that later builds can find it again; the frontend
+  // still checks that none of the headers it includes have changed.
+  if (auto *PCHAct = dyn_cast<GeneratePCHJobAction>(JA)) {
+    if (PCHAct->isPersistentPCH()) {
+      llvm::MD5 hash;
+      hash.update(C.getArgsHash());
+      if (auto contents = llvm::MemoryBuffer::getFile(BaseInput))
+        hash.update((*contents)->getBuffer());
+      llvm::MD5::MD5Result hashBuf;
+      hash.final(hashBuf);
+      SmallString<32> hashStr;
+      llvm::MD5::stringifyResult(hashBuf, hashStr);
+
+      std::error_code EC =
+          llvm::sys::fs::create_directories(PCHAct->getPersistentPCHDir());
+      if (EC) {
+        Diags.diagnose(SourceLoc(), diag::error_unable_to_make_pch_directory,
+                       PCHAct->getPersistentPCHDir(), EC.message());
+        return {};
+      }
+      Buffer = PCHAct->getPersistentPCHDir();
+      llvm::sys::path::append(Buffer, llvm::sys::path::stem(BaseInput) + "-" +
+                                          hashStr.str() + "." + PCH_EXTENSION);
+      return Buffer.str();
+    }
+  }
+
   // dSYM actions are never treated as top-level.
   if (isa<GenerateDSYMJobAction>(JA)) {
     Buffer = InputJobs.front()->getOutput().getPrimaryOutputFilename();
@@ -1833,6 +1955,39 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
     }
     if (C.getIncrementalBuildEnabled()) {
       addAuxiliaryOutput(C, *Output, types::TY_SwiftDeps, OI, OutputMap);
+    } else if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+               C.getArgs().hasArg(options::OPT_compilation_cache_path)) {
+      // The compilation cache reads the modules a job imported out of its
+      // reference dependencies, so make sure there are some.
+      llvm::SmallString<128> Path;
+      std::error_code EC = llvm::sys::fs::createTemporaryFile(
+          llvm::sys::path::stem(BaseInput),
+          types::getTypeTempSuffix(types::TY_SwiftDeps), Path);
+      if (EC) {
+        Diags.diagnose(SourceLoc(),
+                       diag::error_unable_to_make_temporary_file,
+                       EC.message());
+      } else {
+        C.addTemporaryFile(Path);
+        Output->setAdditionalOutputForType(types::TY_SwiftDeps, Path);
+      }
+    }
+
+    // Have the frontend record when it ran each phase, for the time trace.
+    // Only the driver reads this, so it's always a temporary file.
+    if (C.getArgs().hasArg(options::OPT_driver_time_trace)) {
+      llvm::SmallString<128> Path;
+      std::error_code EC = llvm::sys::fs::createTemporaryFile(
+          llvm::sys::path::stem(BaseInput),
+          types::getTypeTempSuffix(types::TY_PhaseTimeline), Path);
+      if (EC) {
+        Diags.diagnose(SourceLoc(),
+                       diag::error_unable_to_make_temporary_file,
+                       EC.message());
+      } else {
+        C.addTemporaryFile(Path);
+        Output->setAdditionalOutputForType(types::TY_PhaseTimeline, Path);
+      }
     }
   }
 
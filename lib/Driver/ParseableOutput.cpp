@@ -23,71 +23,18 @@ using namespace swift::driver::parseable_output;
 using namespace swift::driver;
 using namespace swift;
 
-namespace {
-  struct CommandInput {
-    std::string Path;
-    CommandInput() {}
-    CommandInput(StringRef Path) : Path(Path) {}
-  };
-
-  typedef std::pair<types::ID, std::string> OutputPair;
-}
-
-namespace swift {
-namespace json {
-  template<>
-  struct ScalarTraits<CommandInput> {
-    static void output(const CommandInput &value, llvm::raw_ostream &os) {
-      os << value.Path;
-    }
-    static bool mustQuote(StringRef) { return true; }
-  };
-
-  template<>
-  struct ScalarEnumerationTraits<types::ID> {
-    static void enumeration(Output &out, types::ID &value) {
-      types::forAllTypes([&](types::ID ty) {
-        std::string typeName = types::getTypeName(ty);
-        out.enumCase(value, typeName.c_str(), ty);
-      });
-    }
-  };
-
-  template<>
-  struct ObjectTraits<std::pair<types::ID, std::string>> {
-    static void mapping(Output &out, std::pair<types::ID, std::string> &value) {
-      out.mapRequired("type", value.first);
-      out.mapRequired("path", value.second);
-    }
-  };
-
-  template<typename T, unsigned N>
-  struct ArrayTraits<SmallVector<T, N>> {
-    static size_t size(Output &out, SmallVector<T, N> &seq) {
-      return seq.size();
-    }
-
-    static T &element(Output &out, SmallVector<T, N> &seq, size_t index) {
-      if (index >= seq.size())
-        seq.resize(index+1);
-      return seq[index];
-    }
-  };
-}
-}
-
 namespace {
 
 class Message {
-  std::string Kind;
-  std::string Name;
+  StringRef Kind;
+  StringRef Name;
 public:
   Message(StringRef Kind, StringRef Name) : Kind(Kind), Name(Name) {}
   virtual ~Message() = default;
 
-  virtual void provideMapping(swift::json::Output &out) {
-    out.mapRequired("kind", Kind);
-    out.mapRequired("name", Name);
+  virtual void writeFields(json::Writer &out) const {
+    out.attribute("kind", Kind);
+    out.attribute("name", Name);
   }
 };
 
@@ -99,8 +46,8 @@ public:
 
 class DetailedCommandBasedMessage : public CommandBasedMessage {
   std::string CommandLine;
-  SmallVector<CommandInput, 4> Inputs;
-  SmallVector<OutputPair, 8> Outputs;
+  SmallVector<StringRef, 4> Inputs;
+  SmallVector<std::pair<types::ID, StringRef>, 8> Outputs;
 public:
   DetailedCommandBasedMessage(StringRef Kind, const Job &Cmd) :
       CommandBasedMessage(Kind, Cmd) {
@@ -110,16 +57,16 @@ public:
 
     for (const Action *A : Cmd.getSource().getInputs()) {
       if (const InputAction *IA = dyn_cast<InputAction>(A))
-        Inputs.push_back(CommandInput(IA->getInputArg().getValue()));
+        Inputs.push_back(IA->getInputArg().getValue());
     }
 
     for (const Job *J : Cmd.getInputs()) {
       ArrayRef<std::string> OutFiles = J->getOutput().getPrimaryOutputFilenames();
       if (const auto *BJAction = dyn_cast<BackendJobAction>(&Cmd.getSource())) {
-        Inputs.push_back(CommandInput(OutFiles[BJAction->getInputIndex()]));
+        Inputs.push_back(OutFiles[BJAction->getInputIndex()]);
       } else {
         for (const std::string &FileName : OutFiles) {
-          Inputs.push_back(CommandInput(FileName));
+          Inputs.push_back(FileName);
         }
       }
     }
@@ -129,22 +76,38 @@ public:
     if (PrimaryOutputType != types::TY_Nothing) {
       for (const std::string &OutputFileName : Cmd.getOutput().
                                                  getPrimaryOutputFilenames()) {
-        Outputs.push_back(OutputPair(PrimaryOutputType, OutputFileName));
+        Outputs.push_back({PrimaryOutputType, OutputFileName});
       }
     }
     types::forAllTypes([&](types::ID Ty) {
       const std::string &Output =
           Cmd.getOutput().getAdditionalOutputForType(Ty);
       if (!Output.empty())
-        Outputs.push_back(OutputPair(Ty, Output));
+        Outputs.push_back({Ty, Output});
     });
   }
 
-  virtual void provideMapping(swift::json::Output &out) {
-    Message::provideMapping(out);
-    out.mapRequired("command", CommandLine);
-    out.mapOptional("inputs", Inputs);
-    out.mapOptional("outputs", Outputs);
+  void writeFields(json::Writer &out) const override {
+    Message::writeFields(out);
+    out.attribute("command", CommandLine);
+    if (!Inputs.empty()) {
+      out.key("inputs");
+      out.beginArray();
+      for (StringRef Input : Inputs)
+        out.value(Input);
+      out.endArray();
+    }
+    if (!Outputs.empty()) {
+      out.key("outputs");
+      out.beginArray();
+      for (auto &Output : Outputs) {
+        out.beginObject();
+        out.attribute("type", types::getTypeName(Output.first));
+        out.attribute("path", Output.second);
+        out.endObject();
+      }
+      out.endArray();
+    }
   }
 };
 
@@ -154,9 +117,9 @@ public:
   TaskBasedMessage(StringRef Kind, const Job &Cmd, ProcessId Pid) :
       CommandBasedMessage(Kind, Cmd), Pid(Pid) {}
 
-  virtual void provideMapping(swift::json::Output &out) {
-    CommandBasedMessage::provideMapping(out);
-    out.mapRequired("pid", Pid);
+  void writeFields(json::Writer &out) const override {
+    CommandBasedMessage::writeFields(out);
+    out.attribute("pid", Pid);
   }
 };
 
@@ -166,22 +129,24 @@ public:
   BeganMessage(const Job &Cmd, ProcessId Pid) :
       DetailedCommandBasedMessage("began", Cmd), Pid(Pid) {}
 
-  virtual void provideMapping(swift::json::Output &out) {
-    DetailedCommandBasedMessage::provideMapping(out);
-    out.mapRequired("pid", Pid);
+  void writeFields(json::Writer &out) const override {
+    DetailedCommandBasedMessage::writeFields(out);
+    out.attribute("pid", Pid);
   }
 };
 
 class TaskOutputMessage : public TaskBasedMessage {
-  std::string Output;
+  /// The output of the task, which can be large, so it is not copied.
+  StringRef Output;
 public:
   TaskOutputMessage(StringRef Kind, const Job &Cmd, ProcessId Pid,
                     StringRef Output) : TaskBasedMessage(Kind, Cmd, Pid),
                                         Output(Output) {}
 
-  virtual void provideMapping(swift::json::Output &out) {
-    TaskBasedMessage::provideMapping(out);
-    out.mapOptional("output", Output, std::string());
+  void writeFields(json::Writer &out) const override {
+    TaskBasedMessage::writeFields(out);
+    if (!Output.empty())
+      out.attribute("output", Output);
   }
 };
 
@@ -193,23 +158,24 @@ public:
                                                       Output),
                                     ExitStatus(ExitStatus) {}
 
-  virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
-    out.mapRequired("exit-status", ExitStatus);
+  void writeFields(json::Writer &out) const override {
+    TaskOutputMessage::writeFields(out);
+    out.attribute("exit-status", ExitStatus);
   }
 };
 
 class SignalledMessage : public TaskOutputMessage {
-  std::string ErrorMsg;
+  StringRef ErrorMsg;
 public:
   SignalledMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
                    StringRef ErrorMsg) : TaskOutputMessage("signalled", Cmd,
                                                            Pid, Output),
                                          ErrorMsg(ErrorMsg) {}
 
-  virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
-    out.mapOptional("error-message", ErrorMsg, std::string());
+  void writeFields(json::Writer &out) const override {
+    TaskOutputMessage::writeFields(out);
+    if (!ErrorMsg.empty())
+      out.attribute("error-message", ErrorMsg);
   }
 };
 
@@ -219,29 +185,35 @@ public:
       DetailedCommandBasedMessage("skipped", Cmd) {}
 };
 
-}
+/// A stream which only counts the bytes written to it.
+class CountingStream : public raw_ostream {
+  uint64_t Count = 0;
 
-namespace swift {
-namespace json {
+  void write_impl(const char *Ptr, size_t Size) override { Count += Size; }
+  uint64_t current_pos() const override { return Count; }
 
-template<>
-struct ObjectTraits<Message> {
-  static void mapping(Output &out, Message &msg) {
-    msg.provideMapping(out);
-  }
+public:
+  ~CountingStream() override { flush(); }
 };
 
-} // end namespace yaml
-} // end namespace llvm
-
-static void emitMessage(raw_ostream &os, Message &msg) {
-  std::string JSONString;
-  llvm::raw_string_ostream BufferStream(JSONString);
-  json::Output yout(BufferStream);
-  yout << msg;
-  BufferStream.flush();
-  os << JSONString.length() << '\n';
-  os << JSONString << '\n';
+}
+
+static void writeMessage(raw_ostream &os, const Message &msg) {
+  json::Writer out(os);
+  out.beginObject();
+  msg.writeFields(out);
+  out.endObject();
+}
+
+/// Writes the length of the message and then the message itself. The message,
+/// which can contain the complete output of a job, is written twice instead of
+/// being buffered: once to compute the length, and once to \p os.
+static void emitMessage(raw_ostream &os, const Message &msg) {
+  CountingStream Counter;
+  writeMessage(Counter, msg);
+  os << Counter.tell() << '\n';
+  writeMessage(os, msg);
+  os << '\n';
 }
 
 void parseable_output::emitBeganMessage(raw_ostream &os,
@@ -0,0 +1,187 @@
+//===--- TimeTrace.cpp - Timelines of the driver's jobs -------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/TimeTrace.h"
+
+#include "swift/Basic/JSONSerialization.h"
+#include "swift/Basic/Timer.h"
+#include "swift/Driver/Action.h"
+#include "swift/Driver/Job.h"
+#include "swift/Driver/Types.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift::driver::time_trace;
+using namespace swift::driver;
+using namespace swift;
+
+namespace {
+  /// The driver's own process in the trace. Each job slot is a thread of it.
+  const int DriverTracePid = 1;
+
+  struct TraceEventArgs {
+    std::string Name;
+    int Pid = 0;
+  };
+
+  /// An event in Chrome's trace event format. Every event is either a
+  /// complete event ("X"), with a duration, or metadata ("M").
+  struct TraceEvent {
+    std::string Name;
+    std::string Category;
+    std::string Phase;
+    uint64_t Timestamp = 0;
+    uint64_t Duration = 0;
+    int Pid = DriverTracePid;
+    unsigned Tid = 0;
+    TraceEventArgs Args;
+  };
+
+  struct TraceFile {
+    std::vector<TraceEvent> TraceEvents;
+  };
+}
+
+static void writeTraceEvent(json::Writer &out, const TraceEvent &Event) {
+  out.beginObject();
+  out.attribute("name", Event.Name);
+  if (!Event.Category.empty())
+    out.attribute("cat", Event.Category);
+  out.attribute("ph", Event.Phase);
+  out.attribute("pid", Event.Pid);
+  out.attribute("tid", Event.Tid);
+  if (Event.Phase == "X") {
+    out.attribute("ts", Event.Timestamp);
+    out.attribute("dur", Event.Duration);
+  }
+  out.key("args");
+  out.beginObject();
+  if (!Event.Args.Name.empty())
+    out.attribute("name", Event.Args.Name);
+  if (Event.Args.Pid != 0)
+    out.attribute("pid", Event.Args.Pid);
+  out.endObject();
+  out.endObject();
+}
+
+/// Returns the microseconds from \p BuildStart to \p Time, or zero if \p Time
+/// is earlier.
+static uint64_t sinceBuildStart(llvm::sys::TimeValue Time,
+                                llvm::sys::TimeValue BuildStart) {
+  if (Time < BuildStart)
+    return 0;
+  return (Time - BuildStart).usec();
+}
+
+/// Reads the phases the frontend run by \p Cmd recorded, if any.
+static void readPhases(const Job &Cmd, std::vector<TimedPhase> &Phases) {
+  StringRef Path =
+      Cmd.getOutput().getAdditionalOutputForType(types::TY_PhaseTimeline);
+  if (Path.empty())
+    return;
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+  if (!SharedTimer::readTimeline(Buffer.get()->getBuffer(), Phases))
+    Phases.clear();
+}
+
+void time_trace::writeTimeTrace(raw_ostream &os, ArrayRef<JobRun> Runs,
+                                llvm::sys::TimeValue BuildStart) {
+  TraceFile File;
+  unsigned NumSlots = 0;
+
+  for (const JobRun &Run : Runs) {
+    NumSlots = std::max(NumSlots, Run.Slot + 1);
+
+    TraceEvent JobEvent;
+    JobEvent.Name = Run.Cmd->getSource().getClassName();
+    const CommandOutput &Output = Run.Cmd->getOutput();
+    StringRef BaseInput;
+    if (!Output.getPrimaryOutputFilenames().empty())
+      BaseInput = Output.getBaseInput(0);
+    if (!BaseInput.empty()) {
+      JobEvent.Name += ' ';
+      JobEvent.Name += llvm::sys::path::filename(BaseInput).str();
+    }
+    JobEvent.Category = "job";
+    JobEvent.Phase = "X";
+    JobEvent.Tid = Run.Slot;
+    JobEvent.Timestamp = sinceBuildStart(Run.Start, BuildStart);
+    JobEvent.Duration = sinceBuildStart(Run.End, BuildStart) -
+                        JobEvent.Timestamp;
+    JobEvent.Args.Pid = Run.Pid;
+    File.TraceEvents.push_back(JobEvent);
+
+    std::vector<TimedPhase> Phases;
+    readPhases(*Run.Cmd, Phases);
+    if (Phases.empty())
+      continue;
+
+    auto addPhase = [&](StringRef Name, llvm::sys::TimeValue Start,
+                        llvm::sys::TimeValue End) {
+      // Keep the phases within the job, in case the clocks disagree.
+      uint64_t JobEnd = JobEvent.Timestamp + JobEvent.Duration;
+      uint64_t PhaseStart = std::min(std::max(sinceBuildStart(Start, BuildStart),
+                                              JobEvent.Timestamp), JobEnd);
+      uint64_t PhaseEnd = std::min(std::max(sinceBuildStart(End, BuildStart),
+                                            PhaseStart), JobEnd);
+
+      TraceEvent PhaseEvent;
+      PhaseEvent.Name = Name.str();
+      PhaseEvent.Category = "phase";
+      PhaseEvent.Phase = "X";
+      PhaseEvent.Tid = Run.Slot;
+      PhaseEvent.Timestamp = PhaseStart;
+      PhaseEvent.Duration = PhaseEnd - PhaseStart;
+      PhaseEvent.Args.Pid = Run.Pid;
+      File.TraceEvents.push_back(PhaseEvent);
+    };
+
+    // Everything before the first phase was spent starting the process and
+    // setting up the compiler.
+    llvm::sys::TimeValue FirstPhaseStart = Phases.front().Start;
+    for (const TimedPhase &Phase : Phases)
+      if (Phase.Start < FirstPhaseStart)
+        FirstPhaseStart = Phase.Start;
+    addPhase("Spawn", Run.Start, FirstPhaseStart);
+
+    for (const TimedPhase &Phase : Phases)
+      addPhase(Phase.Name, Phase.Start, Phase.End);
+  }
+
+  TraceEvent ProcessName;
+  ProcessName.Name = "process_name";
+  ProcessName.Phase = "M";
+  ProcessName.Args.Name = "swift driver";
+  File.TraceEvents.push_back(ProcessName);
+
+  for (unsigned Slot = 0; Slot != NumSlots; ++Slot) {
+    TraceEvent ThreadName;
+    ThreadName.Name = "thread_name";
+    ThreadName.Phase = "M";
+    ThreadName.Tid = Slot;
+    ThreadName.Args.Name = "Job slot " + std::to_string(Slot);
+    File.TraceEvents.push_back(ThreadName);
+  }
+
+  json::Writer out(os);
+  out.beginObject();
+  out.key("traceEvents");
+  out.beginArray();
+  for (const TraceEvent &Event : File.TraceEvents)
+    writeTraceEvent(out, Event);
+  out.endArray();
+  out.endObject();
+  os << '\n';
+}
@@ -86,6 +86,7 @@ ToolChain::constructJob(const JobAction &JA,
     CASE(LinkJob)
     CASE(GenerateDSYMJob)
     CASE(AutolinkExtractJob)
+    CASE(GeneratePCHJob)
     CASE(REPLJob)
 #undef CASE
     case Action::Input:
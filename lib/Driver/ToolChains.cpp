@@ -75,6 +75,22 @@ static void addPrimaryInputsOfType(ArgStringList &Arguments,
   }
 }
 
+/// Pass the bridging header to the frontend, preferring the precompiled
+/// header if one of the input jobs generated it.
+static void addBridgingHeaderArgs(ArrayRef<const Job *> inputJobs,
+                                  const ArgList &inputArgs,
+                                  ArgStringList &arguments) {
+  for (const Job *Cmd : inputJobs) {
+    if (!isa<GeneratePCHJobAction>(Cmd->getSource()))
+      continue;
+    arguments.push_back("-import-objc-header");
+    arguments.push_back(
+        Cmd->getOutput().getPrimaryOutputFilename().c_str());
+    return;
+  }
+  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
+}
+
 /// Handle arguments common to all invocations of the frontend (compilation,
 /// module-merging, LLDB's REPL, etc).
 static void addCommonFrontendArgs(const ToolChain &TC,
@@ -118,7 +134,6 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_enable_app_extension);
   inputArgs.AddLastArg(arguments, options::OPT_enable_testing);
   inputArgs.AddLastArg(arguments, options::OPT_g_Group);
-  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
   inputArgs.AddLastArg(arguments, options::OPT_import_underlying_module);
   inputArgs.AddLastArg(arguments, options::OPT_module_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_module_link_name);
@@ -126,9 +141,12 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_entry_counts_only);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use_EQ);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
 
@@ -213,11 +231,13 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
     case types::TY_SwiftDeps:
     case types::TY_Remapping:
+    case types::TY_PhaseTimeline:
       llvm_unreachable("Output type can never be primary output.");
     case types::TY_INVALID:
       llvm_unreachable("Invalid type ID");
@@ -238,8 +258,11 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  assert(std::all_of(context.Inputs.begin(), context.Inputs.end(),
+                     [](const Job *Cmd) {
+                       return isa<GeneratePCHJobAction>(Cmd->getSource());
+                     }) &&
+         "The Swift frontend only expects a precompiled header as input Job!");
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
@@ -297,6 +320,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Inputs, context.Args, Arguments);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -347,6 +371,16 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   if (!ReferenceDependenciesPath.empty()) {
     Arguments.push_back("-emit-reference-dependencies-path");
     Arguments.push_back(ReferenceDependenciesPath.c_str());
+    if (!context.Args.hasArg(
+            options::OPT_driver_emit_yaml_reference_dependencies))
+      Arguments.push_back("-binary-reference-dependencies");
+  }
+
+  const std::string &PhaseTimelinePath =
+    context.Output.getAdditionalOutputForType(types::TY_PhaseTimeline);
+  if (!PhaseTimelinePath.empty()) {
+    Arguments.push_back("-phase-timeline-path");
+    Arguments.push_back(PhaseTimelinePath.c_str());
   }
 
   const std::string &FixitsPath =
@@ -406,6 +440,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Inputs, context.Args, Arguments);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -470,11 +505,13 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
     case types::TY_SwiftDeps:
     case types::TY_Remapping:
+    case types::TY_PhaseTimeline:
       llvm_unreachable("Output type can never be primary output.");
     case types::TY_INVALID:
       llvm_unreachable("Invalid type ID");
@@ -597,6 +634,7 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Inputs, context.Args, Arguments);
 
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
@@ -663,6 +701,7 @@ ToolChain::constructInvocation(const REPLJobAction &job,
   ArgStringList FrontendArgs;
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         FrontendArgs);
+  addBridgingHeaderArgs(context.Inputs, context.Args, FrontendArgs);
   context.Args.AddAllArgs(FrontendArgs, options::OPT_l, options::OPT_framework,
                           options::OPT_L);
 
@@ -687,6 +726,34 @@ ToolChain::constructInvocation(const REPLJobAction &job,
 }
 
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+
+  addInputsOfType(Arguments, context.InputActions, types::TY_ObjCHeader);
+
+  Arguments.push_back("-emit-pch");
+
+  Arguments.push_back("-module-name");
+  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
                                const JobContext &context) const {
@@ -74,6 +74,7 @@ bool types::isTextual(ID Id) {
   case types::TY_LLVM_IR:
   case types::TY_ObjCHeader:
   case types::TY_AutolinkFile:
+  case types::TY_PhaseTimeline:
     return true;
   case types::TY_Image:
   case types::TY_Object:
@@ -85,6 +86,7 @@ bool types::isTextual(ID Id) {
   case types::TY_LLVM_BC:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
@@ -115,9 +117,11 @@ bool types::isAfterLLVM(ID Id) {
   case types::TY_SwiftModuleDocFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
+  case types::TY_PhaseTimeline:
     return false;
   case types::TY_INVALID:
     llvm_unreachable("Invalid type ID.");
@@ -145,9 +149,11 @@ bool types::isPartOfSwiftCompilation(ID Id) {
   case types::TY_SwiftModuleDocFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
+  case types::TY_PhaseTimeline:
     return false;
   case types::TY_INVALID:
     llvm_unreachable("Invalid type ID.");
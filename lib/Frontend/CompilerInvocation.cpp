@@ -18,6 +18,7 @@
 #include "swift/Option/Options.h"
 #include "swift/Option/SanitizerOptions.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -98,10 +99,11 @@ static void debugFailWithCrash() {
 static bool readFileList(DiagnosticEngine &diags,
                          std::vector<std::string> &inputFiles,
                          const llvm::opt::Arg *filelistPath,
-                         const llvm::opt::Arg *primaryFileArg = nullptr,
-                         unsigned *primaryFileIndex = nullptr) {
-  assert((primaryFileArg == nullptr) || (primaryFileIndex != nullptr) &&
-         "did not provide argument for primary file index");
+                         ArrayRef<const llvm::opt::Arg *> primaryFileArgs = {},
+                         SmallVectorImpl<unsigned> *primaryFileIndices =
+                             nullptr) {
+  assert((primaryFileArgs.empty() || primaryFileIndices != nullptr) &&
+         "did not provide argument for primary file indices");
 
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
       llvm::MemoryBuffer::getFile(filelistPath->getValue());
@@ -111,29 +113,98 @@ static bool readFileList(DiagnosticEngine &diags,
     return false;
   }
 
-  bool foundPrimaryFile = false;
-  if (primaryFileIndex) *primaryFileIndex = 0;
+  // Map each primary file to its position on the command line, so that the
+  // indices come out in that order.
+  const unsigned notFound = ~0U;
+  llvm::StringMap<unsigned> primaryFilePositions;
+  for (unsigned i = 0, e = primaryFileArgs.size(); i != e; ++i)
+    primaryFilePositions.insert({primaryFileArgs[i]->getValue(), i});
+  if (primaryFileIndices)
+    primaryFileIndices->assign(primaryFileArgs.size(), notFound);
 
   for (StringRef line : make_range(llvm::line_iterator(*buffer.get()), {})) {
     inputFiles.push_back(line);
 
-    if (foundPrimaryFile || primaryFileArg == nullptr)
+    if (primaryFilePositions.empty())
       continue;
-    if (line == primaryFileArg->getValue())
-      foundPrimaryFile = true;
-    else
-      ++*primaryFileIndex;
+    auto position = primaryFilePositions.find(line);
+    if (position == primaryFilePositions.end())
+      continue;
+    unsigned &index = (*primaryFileIndices)[position->getValue()];
+    if (index == notFound)
+      index = inputFiles.size() - 1;
   }
 
-  if (primaryFileArg && !foundPrimaryFile) {
+  for (unsigned i = 0, e = primaryFileArgs.size(); i != e; ++i) {
+    if ((*primaryFileIndices)[i] != notFound)
+      continue;
     diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
-                   primaryFileArg->getValue(), filelistPath->getValue());
+                   primaryFileArgs[i]->getValue(), filelistPath->getValue());
     return false;
   }
 
   return true;
 }
 
+/// In batch mode each per-file output option is given once per primary
+/// file, in the same order as the primary files. Hands each additional
+/// primary file its own outputs, leaving the first primary file's in the
+/// usual places.
+///
+/// \returns true on error.
+static bool parseAdditionalPrimaryOutputs(FrontendOptions &Opts,
+                                          ArgList &Args,
+                                          DiagnosticEngine &Diags) {
+  using AdditionalPrimaryInput = FrontendOptions::AdditionalPrimaryInput;
+  unsigned numPrimaries = Opts.AdditionalPrimaryInputs.size() + 1;
+
+  auto distribute = [&](StringRef optName,
+                        const std::vector<std::string> &values,
+                        std::string &primaryOutput,
+                        std::string AdditionalPrimaryInput::*output) -> bool {
+    if (values.empty() && primaryOutput.empty())
+      return false;
+    if (values.size() != numPrimaries) {
+      Diags.diagnose(SourceLoc(), diag::error_primary_file_output_count,
+                     optName, numPrimaries, values.size());
+      return true;
+    }
+    primaryOutput = values.front();
+    for (unsigned i = 1; i != numPrimaries; ++i)
+      Opts.AdditionalPrimaryInputs[i - 1].*output = values[i];
+    return false;
+  };
+
+  std::vector<std::string> outputFilenames = Opts.OutputFilenames;
+  // The main output was deduced if it wasn't given, but batch mode doesn't
+  // guess.
+  if (!Args.hasArg(OPT_o))
+    outputFilenames.clear();
+  std::string mainOutput = Opts.getSingleOutputFilename();
+  if (distribute("-o", outputFilenames, mainOutput,
+                 &AdditionalPrimaryInput::OutputFilename))
+    return true;
+  Opts.setSingleOutputFilename(mainOutput);
+
+  return
+    distribute("-emit-module-path",
+               Args.getAllArgValues(OPT_emit_module_path),
+               Opts.ModuleOutputPath,
+               &AdditionalPrimaryInput::ModuleOutputPath) ||
+    distribute("-emit-module-doc-path",
+               Args.getAllArgValues(OPT_emit_module_doc_path),
+               Opts.ModuleDocOutputPath,
+               &AdditionalPrimaryInput::ModuleDocOutputPath) ||
+    distribute("-emit-dependencies-path",
+               Args.getAllArgValues(OPT_emit_dependencies_path),
+               Opts.DependenciesFilePath,
+               &AdditionalPrimaryInput::DependenciesFilePath) ||
+    distribute("-emit-reference-dependencies-path",
+               Args.getAllArgValues(OPT_emit_reference_dependencies_path),
+               Opts.ReferenceDependenciesFilePath,
+               &AdditionalPrimaryInput::ReferenceDependenciesFilePath);
+}
+
 static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                               DiagnosticEngine &Diags) {
   using namespace options;
@@ -174,6 +245,14 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_phase_timeline_path))
+    Opts.PhaseTimelinePath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_solver_profile_path))
+    Opts.SolverProfilePath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
+  Opts.PrintASTMemory |= Args.hasArg(OPT_print_ast_memory);
+  Opts.PrintPhaseMemory |= Args.hasArg(OPT_print_phase_memory);
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -201,13 +280,21 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  auto addPrimaryInput = [&](unsigned index) {
+    if (!Opts.PrimaryInput)
+      Opts.PrimaryInput = SelectedInput(index);
+    else
+      Opts.AdditionalPrimaryInputs.emplace_back(SelectedInput(index));
+  };
+
   if (const Arg *A = Args.getLastArg(OPT_filelist)) {
-    const Arg *primaryFileArg = Args.getLastArg(OPT_primary_file);
-    unsigned primaryFileIndex = 0;
+    SmallVector<const Arg *, 1> primaryFileArgs(
+        Args.filtered_begin(OPT_primary_file), Args.filtered_end());
+    SmallVector<unsigned, 1> primaryFileIndices;
     if (readFileList(Diags, Opts.InputFilenames, A,
-                     primaryFileArg, &primaryFileIndex)) {
-      if (primaryFileArg)
-        Opts.PrimaryInput = SelectedInput(primaryFileIndex);
+                     primaryFileArgs, &primaryFileIndices)) {
+      for (unsigned index : primaryFileIndices)
+        addPrimaryInput(index);
       assert(!Args.hasArg(OPT_INPUT) && "mixing -filelist with inputs");
     }
   } else {
@@ -217,7 +304,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       if (A->getOption().matches(OPT_INPUT)) {
         Opts.InputFilenames.push_back(A->getValue());
       } else if (A->getOption().matches(OPT_primary_file)) {
-        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+        addPrimaryInput(Opts.InputFilenames.size());
         Opts.InputFilenames.push_back(A->getValue());
       } else {
         llvm_unreachable("Unknown input-related argument!");
@@ -257,6 +344,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::DumpTypeRefinementContexts;
     } else if (Opt.matches(OPT_dump_interface_hash)) {
       Action = FrontendOptions::DumpInterfaceHash;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else if (Opt.matches(OPT_print_ast)) {
       Action = FrontendOptions::PrintAST;
     } else if (Opt.matches(OPT_repl) ||
@@ -347,6 +436,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
         Opts.ImmediateArgv.push_back(A->getValue(i));
       }
     }
+    if (const Arg *A = Args.getLastArg(OPT_immediate_object_cache_path))
+      Opts.ImmediateObjectCachePath = A->getValue();
   }
 
   if (TreatAsSIL)
@@ -456,6 +547,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Suffix = SERIALIZED_MODULE_EXTENSION;
       break;
 
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
+
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       // These modes have no frontend-generated output.
@@ -582,6 +677,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           OPT_emit_reference_dependencies,
                           OPT_emit_reference_dependencies_path,
                           "swiftdeps", false);
+  Opts.EmitBinaryReferenceDependencies |=
+      Args.hasArg(OPT_binary_reference_dependencies);
   determineOutputFilename(Opts.SerializedDiagnosticsPath,
                           OPT_serialize_diagnostics,
                           OPT_serialize_diagnostics_path,
@@ -615,6 +712,40 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           SERIALIZED_MODULE_DOC_EXTENSION,
                           false);
 
+  if (!Opts.AdditionalPrimaryInputs.empty()) {
+    switch (Opts.RequestedAction) {
+    case FrontendOptions::NoneAction:
+    case FrontendOptions::DumpParse:
+    case FrontendOptions::DumpInterfaceHash:
+    case FrontendOptions::DumpAST:
+    case FrontendOptions::PrintAST:
+    case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
+    case FrontendOptions::Immediate:
+    case FrontendOptions::REPL:
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_action);
+      return true;
+    case FrontendOptions::Parse:
+    case FrontendOptions::EmitModuleOnly:
+    case FrontendOptions::EmitSILGen:
+    case FrontendOptions::EmitSIL:
+    case FrontendOptions::EmitSIBGen:
+    case FrontendOptions::EmitSIB:
+    case FrontendOptions::EmitIR:
+    case FrontendOptions::EmitBC:
+    case FrontendOptions::EmitAssembly:
+    case FrontendOptions::EmitObject:
+      break;
+    }
+    if (Opts.InputKind != InputFileKind::IFK_Swift &&
+        Opts.InputKind != InputFileKind::IFK_Swift_Library) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_action);
+      return true;
+    }
+    if (parseAdditionalPrimaryOutputs(Opts, Args, Diags))
+      return true;
+  }
+
   if (!Opts.DependenciesFilePath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
@@ -623,6 +754,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
@@ -649,6 +781,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
@@ -677,6 +810,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
@@ -740,6 +874,9 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   Opts.EnableExperimentalPropertyBehaviors |=
     Args.hasArg(OPT_enable_experimental_property_behaviors);
 
+  Opts.NamedLazyMemberLoading |=
+    Args.hasArg(OPT_enable_named_lazy_member_loading);
+
   Opts.DisableAvailabilityChecking |=
       Args.hasArg(OPT_disable_availability_checking);
   
@@ -810,6 +947,16 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     
     Opts.SolverMemoryThreshold = threshold;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_verify_sample_ratio)) {
+    unsigned ratio;
+    if (StringRef(A->getValue()).getAsInteger(10, ratio) || ratio == 0) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.VerifierSampleRatio = ratio;
+  }
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_D),
                                  Args.filtered_end())) {
@@ -866,6 +1013,12 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
   if (const Arg *A = Args.getLastArg(OPT_target_cpu))
     Opts.TargetCPU = A->getValue();
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header)) {
+    StringRef header = A->getValue();
+    if (llvm::sys::path::extension(header).endswith(PCH_EXTENSION))
+      Opts.BridgingHeaderPCH = header;
+  }
+
   for (const Arg *A : make_range(Args.filtered_begin(OPT_Xcc),
                                  Args.filtered_end())) {
     Opts.ExtraArgs.push_back(A->getValue());
@@ -1011,6 +1164,7 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
     else
       llvm_unreachable("Unknown SIL linking option!");
   }
+  Opts.LinkOnDemand |= Args.hasArg(OPT_sil_link_on_demand);
 
   // Parse the optimization level.
   if (const Arg *A = Args.getLastArg(OPT_O_Group)) {
@@ -1073,11 +1227,22 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.PrintInstCounts |= Args.hasArg(OPT_print_inst_counts);
   if (const Arg *A = Args.getLastArg(OPT_external_pass_pipeline_filename))
     Opts.ExternalPassPipelineFilename = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_prespecialize_list))
+    Opts.PrespecializationListFilename = A->getValue();
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  Opts.ProfileEntryCountsOnly |= Args.hasArg(OPT_profile_entry_counts_only);
+  if (Opts.ProfileEntryCountsOnly && Opts.EmitProfileCoverageMapping) {
+    Diags.diagnose(SourceLoc(), diag::error_argument_not_allowed_with,
+                   "-profile-entry-counts-only", "-profile-coverage-mapping");
+    return true;
+  }
+  if (const Arg *A = Args.getLastArg(OPT_profile_use_EQ))
+    Opts.UseProfile = A->getValue();
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
+  Opts.ShareSpecializations |= Args.hasArg(OPT_enable_specialization_sharing);
 
   if (Args.hasArg(OPT_debug_on_sil)) {
     // Derive the name of the SIL file for debugging from
@@ -1194,6 +1359,16 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     Opts.StackPromotionSizeLimit = limit;
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_outline_value_operations_limit)) {
+    unsigned limit;
+    if (StringRef(A->getValue()).getAsInteger(10, limit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.OutlineValueOperationsLimit = limit;
+  }
+
   if (Args.hasArg(OPT_autolink_force_load))
     Opts.ForceLoadSymbolName = Args.getLastArgValue(OPT_module_link_name);
 
@@ -1218,6 +1393,12 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     Opts.VerifyTypeLayoutNames.push_back(A->getValue());
   }
 
+  for (const Arg *A : make_range(
+                 Args.filtered_begin(OPT_prespecialize_generic_metadata),
+                 Args.filtered_end())) {
+    Opts.PrespecializedGenericMetadataNames.push_back(A->getValue());
+  }
+
   for (const Arg *A : make_range(Args.filtered_begin(
                                    OPT_disable_autolink_framework),
                                  Args.filtered_end())) {
@@ -1229,6 +1410,11 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
 
+  Opts.LazyWitnessTableBases =
+    Args.hasArg(OPT_enable_lazy_witness_table_bases);
+
+  Opts.ReorderStructFields = Args.hasArg(OPT_enable_struct_field_reordering);
+
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
     !Args.hasArg(OPT_disable_incremental_llvm_codegeneration);
@@ -32,6 +32,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <atomic>
+#include <thread>
 
 using namespace swift;
 
@@ -52,6 +54,39 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+void CompilerInstance::recordPrimarySourceFile(unsigned BufferID,
+                                               SourceFile *SF) {
+  if (BufferID == PrimaryBufferID) {
+    setPrimarySourceFile(SF);
+    return;
+  }
+
+  auto found = std::find(AdditionalPrimaryBufferIDs.begin(),
+                         AdditionalPrimaryBufferIDs.end(), BufferID);
+  if (found == AdditionalPrimaryBufferIDs.end())
+    return;
+  size_t index = found - AdditionalPrimaryBufferIDs.begin();
+  AdditionalPrimarySourceFiles[index] = SF;
+  if (index < AdditionalNameTrackers.size())
+    SF->setReferencedNameTracker(AdditionalNameTrackers[index]);
+}
+
+bool CompilerInstance::isPrimaryInput(unsigned BufferID) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID)
+    return true;
+  return std::find(AdditionalPrimaryBufferIDs.begin(),
+                   AdditionalPrimaryBufferIDs.end(),
+                   BufferID) != AdditionalPrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+    return true;
+  return std::find(AdditionalPrimarySourceFiles.begin(),
+                   AdditionalPrimarySourceFiles.end(),
+                   SF) != AdditionalPrimarySourceFiles.end();
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
@@ -132,6 +167,21 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
   const Optional<SelectedInput> &PrimaryInput =
     Invocation.getFrontendOptions().PrimaryInput;
+  auto &AdditionalPrimaryInputs =
+    Invocation.getFrontendOptions().AdditionalPrimaryInputs;
+  AdditionalPrimaryBufferIDs.assign(AdditionalPrimaryInputs.size(),
+                                    NO_SUCH_BUFFER);
+  AdditionalPrimarySourceFiles.assign(AdditionalPrimaryInputs.size(), nullptr);
+
+  // Note which of the additional primary inputs, if any, is the given input.
+  auto recordAdditionalPrimaryBuffer = [&](SelectedInput::InputKind Kind,
+                                           unsigned Index, unsigned BufferID) {
+    for (unsigned i = 0, e = AdditionalPrimaryInputs.size(); i != e; ++i) {
+      const SelectedInput &Input = AdditionalPrimaryInputs[i].Input;
+      if (Input.Kind == Kind && Input.Index == Index)
+        AdditionalPrimaryBufferIDs[i] = BufferID;
+    }
+  };
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -152,6 +202,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
       if (PrimaryInput && PrimaryInput->isBuffer() && PrimaryInput->Index == i)
         PrimaryBufferID = BufferID;
+      recordAdditionalPrimaryBuffer(SelectedInput::InputKind::Buffer, i,
+                                    BufferID);
     }
   }
 
@@ -169,6 +221,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (PrimaryInput && PrimaryInput->isFilename() &&
           PrimaryInput->Index == i)
         PrimaryBufferID = ExistingBufferID.getValue();
+      recordAdditionalPrimaryBuffer(SelectedInput::InputKind::Filename, i,
+                                    ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -211,6 +265,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
     if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
       PrimaryBufferID = BufferID;
+    recordAdditionalPrimaryBuffer(SelectedInput::InputKind::Filename, i,
+                                  BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -383,6 +439,20 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // A job with a primary file only needs the declarations of the other files
+  // in the module, not what's in their function bodies.
+  SkipNonTransparentFunctions SkipNonPrimaryBodies;
+  bool SkippingNonPrimaryBodies = false;
+  auto getDelayedCallbacks =
+      [&](unsigned BufferID) -> DelayedParsingCallbacks * {
+    if (DelayedCB || PrimaryBufferID == NO_SUCH_BUFFER ||
+        isPrimaryInput(BufferID) ||
+        (BufferID == MainBufferID && Kind == InputFileKind::IFK_SIL))
+      return DelayedCB.get();
+    SkippingNonPrimaryBodies = true;
+    return &SkipNonPrimaryBodies;
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -401,21 +471,60 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
-      setPrimarySourceFile(MainFile);
+    recordPrimarySourceFile(MainBufferID, MainFile);
   }
 
   bool hadLoadError = false;
 
-  // Parse all the partial modules first.
-  for (auto &PM : PartialModules) {
+  // Parse all the partial modules first. Reading them doesn't involve the
+  // ASTContext, so when merging many of them it's spread across threads;
+  // loading them into the module happens afterwards, in order.
+  std::vector<SerializedModuleLoader::PreparedAST>
+    PreparedModules(PartialModules.size());
+  auto preparePartialModule = [&](size_t i) {
+    PartialModuleInputs &PM = PartialModules[i];
     assert(PM.ModuleBuffer);
-    if (!SML->loadAST(*MainModule, SourceLoc(), std::move(PM.ModuleBuffer),
-                      std::move(PM.ModuleDocBuffer)))
+    PreparedModules[i] =
+      SerializedModuleLoader::prepareAST(std::move(PM.ModuleBuffer),
+                                         std::move(PM.ModuleDocBuffer));
+  };
+
+  unsigned NumThreads = Invocation.getSILOptions().NumThreads;
+  if (NumThreads == 0)
+    NumThreads = std::thread::hardware_concurrency();
+  NumThreads = std::min<size_t>(NumThreads, PartialModules.size());
+  if (NumThreads > 1) {
+    std::atomic<size_t> NextPartialModule(0);
+    auto prepareRemaining = [&] {
+      for (size_t i = NextPartialModule++; i < PartialModules.size();
+           i = NextPartialModule++)
+        preparePartialModule(i);
+    };
+    std::vector<std::thread> Threads;
+    for (unsigned i = 1; i < NumThreads; ++i)
+      Threads.push_back(std::thread(prepareRemaining));
+    prepareRemaining();
+    for (std::thread &Thread : Threads)
+      Thread.join();
+  } else {
+    for (size_t i = 0, e = PartialModules.size(); i != e; ++i)
+      preparePartialModule(i);
+  }
+
+  for (auto &Prepared : PreparedModules) {
+    if (!SML->loadAST(*MainModule, SourceLoc(), std::move(Prepared)))
       hadLoadError = true;
   }
 
   // Then parse all the library files.
+  //
+  // FIXME: Unlike the partial modules above, these can't be parsed on other
+  // threads. The parser allocates every node in the ASTContext, interns
+  // identifiers in its unsynchronized table, and records operator, local type
+  // and interface-hash state in the SourceFile and PersistentParserState as it
+  // goes. Parsing concurrently would need per-thread arenas that are merged
+  // into the context afterwards, a thread-safe identifier table, and files
+  // added to the module in BufferIDs order so the result stays deterministic.
   for (auto BufferID : BufferIDs) {
     if (BufferID == MainBufferID)
       continue;
@@ -427,13 +536,11 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
-      setPrimarySourceFile(NextInput);
+    recordPrimarySourceFile(BufferID, NextInput);
 
     auto &Diags = NextInput->getASTContext().Diags;
     auto DidSuppressWarnings = Diags.getSuppressWarnings();
-    auto IsPrimary
-      = PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID;
+    auto IsPrimary = isPrimaryInput(BufferID);
     Diags.setSuppressWarnings(DidSuppressWarnings || !IsPrimary);
 
     bool Done;
@@ -441,7 +548,7 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, getDelayedCallbacks(BufferID));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -474,8 +581,7 @@ void CompilerInstance::performSema() {
 
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
-    bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+    bool mainIsPrimary = isPrimaryInput(MainBufferID);
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -494,7 +600,8 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          getDelayedCallbacks(MainBufferID));
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
@@ -515,7 +622,7 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (isPrimarySourceFile(SF))
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
                             options.WarnLongFunctionBodies);
@@ -525,7 +632,7 @@ void CompilerInstance::performSema() {
   if (auto *stdlib = Context->getStdlibModule())
     Context->recordKnownProtocols(stdlib);
 
-  if (DelayedCB) {
+  if (DelayedCB || SkippingNonPrimaryBodies) {
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
@@ -539,7 +646,7 @@ void CompilerInstance::performSema() {
 
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (isPrimarySourceFile(SF))
         finishTypeChecking(*SF);
 }
 
@@ -26,6 +26,7 @@ bool FrontendOptions::actionHasOutput() const {
   case PrintAST:
   case DumpTypeRefinementContexts:
     return false;
+  case EmitPCH:
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -53,6 +54,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case DumpInterfaceHash:
   case PrintAST:
   case DumpTypeRefinementContexts:
+  case EmitPCH:
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -88,3 +90,21 @@ void FrontendOptions::forAllOutputPaths(
       fn(*next);
   }
 }
+
+FrontendOptions
+FrontendOptions::getOptionsForAdditionalPrimaryInput(unsigned index) const {
+  const AdditionalPrimaryInput &additional = AdditionalPrimaryInputs[index];
+
+  FrontendOptions result = *this;
+  result.PrimaryInput = additional.Input;
+  result.AdditionalPrimaryInputs.clear();
+  result.setSingleOutputFilename(additional.OutputFilename);
+  result.ModuleOutputPath = additional.ModuleOutputPath;
+  result.ModuleDocOutputPath = additional.ModuleDocOutputPath;
+  result.DependenciesFilePath = additional.DependenciesFilePath;
+  result.ReferenceDependenciesFilePath =
+      additional.ReferenceDependenciesFilePath;
+  // The header describes the whole module, so it only needs writing once.
+  result.ObjCHeaderOutputPath.clear();
+  return result;
+}
@@ -30,18 +30,23 @@
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/ReferencedNameTracker.h"
 #include "swift/AST/TypeRefinementContext.h"
+#include "swift/Basic/Defer.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
+#include "swift/Basic/ReferenceDependencyFormat.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Timer.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
 #include "swift/Option/Options.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/Serialization/SerializationOptions.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 
@@ -50,13 +55,17 @@
 #include "clang/Frontend/CompilerInstance.h"
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
@@ -65,6 +74,10 @@
 #include <memory>
 #include <unordered_set>
 
+#if LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
 using namespace swift;
 
 static std::string displayName(StringRef MainExecutablePath) {
@@ -180,6 +193,236 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+namespace {
+/// Receives the contents of a Swift-style dependencies file, a section at a
+/// time, and writes them out in one of the supported formats.
+class ReferenceDependenciesWriter {
+public:
+  using Section = reference_dependencies::Section;
+
+protected:
+  Section CurrentSection = Section::ProvidesTopLevel;
+
+public:
+  virtual ~ReferenceDependenciesWriter() = default;
+
+  virtual void beginSection(Section section) { CurrentSection = section; }
+  virtual void addName(StringRef name, bool isCascading = true) = 0;
+  virtual void addPair(StringRef first, StringRef second,
+                       bool isCascading = true) = 0;
+  virtual void setInterfaceHash(StringRef hash) = 0;
+  virtual void finish() {}
+};
+
+/// Writes the human-readable YAML format.
+class YAMLReferenceDependenciesWriter : public ReferenceDependenciesWriter {
+  raw_ostream &out;
+
+  void beginEntry(bool isCascading) {
+    out << "- ";
+    if (!isCascading)
+      out << "!private ";
+  }
+
+public:
+  explicit YAMLReferenceDependenciesWriter(raw_ostream &out) : out(out) {
+    out << "### Swift dependencies file v0 ###\n";
+  }
+
+  void beginSection(Section section) override {
+    ReferenceDependenciesWriter::beginSection(section);
+    out << reference_dependencies::getSectionName(section) << ":\n";
+  }
+
+  void addName(StringRef name, bool isCascading) override {
+    beginEntry(isCascading);
+    out << "\"" << llvm::yaml::escape(name) << "\"\n";
+  }
+
+  void addPair(StringRef first, StringRef second, bool isCascading) override {
+    beginEntry(isCascading);
+    out << "[\"" << llvm::yaml::escape(first) << "\", \""
+        << llvm::yaml::escape(second) << "\"]\n";
+  }
+
+  void setInterfaceHash(StringRef hash) override {
+    out << "interface-hash: \"" << hash << "\"\n";
+  }
+};
+
+/// Writes the binary format, which the driver loads faster.
+class BinaryReferenceDependenciesWriter : public ReferenceDependenciesWriter {
+  raw_ostream &out;
+  reference_dependencies::BinaryWriter writer;
+
+public:
+  explicit BinaryReferenceDependenciesWriter(raw_ostream &out) : out(out) {}
+
+  void addName(StringRef name, bool isCascading) override {
+    writer.addName(CurrentSection, name, isCascading);
+  }
+
+  void addPair(StringRef first, StringRef second, bool isCascading) override {
+    writer.addPair(CurrentSection, first, second, isCascading);
+  }
+
+  void setInterfaceHash(StringRef hash) override {
+    writer.setInterfaceHash(hash);
+  }
+
+  void finish() override { writer.write(out); }
+};
+
+/// Computes a fingerprint of each name a file provides from the source text
+/// of the declarations behind it, so that the driver only has to rebuild the
+/// files using the names whose fingerprints changed.
+///
+/// Function bodies are left out, and so are the private methods of structs,
+/// enums and their extensions, which no other file can see. A class's
+/// private methods still take up room in its vtable.
+class DeclFingerprinter {
+  SourceManager &SM;
+
+  /// Everything the declarations of the file may depend on, such as its
+  /// imports, which goes into every fingerprint.
+  llvm::SmallString<32> FileContext;
+
+  /// The hash of each declaration seen so far.
+  llvm::DenseMap<const Decl *, llvm::SmallString<32>> DeclHashes;
+
+  /// The hashes of the declarations behind each name, by name in the order
+  /// the names were provided.
+  llvm::MapVector<std::string, SmallVector<std::string, 1>> NameHashes;
+
+  SourceLoc getStartLoc(const Decl *D) const {
+    SourceLoc start = D->getStartLoc();
+    SourceLoc attrStart = D->getAttrs().getStartLoc();
+    if (attrStart.isValid() &&
+        (start.isInvalid() || SM.isBeforeInBuffer(attrStart, start)))
+      return attrStart;
+    return start;
+  }
+
+  SourceLoc getLocForEndOfToken(SourceLoc loc) const {
+    if (loc.isInvalid())
+      return loc;
+    return Lexer::getLocForEndOfToken(SM, loc);
+  }
+
+  StringRef getText(SourceLoc start, SourceLoc end) const {
+    if (start.isInvalid() || end.isInvalid() ||
+        SM.isBeforeInBuffer(end, start))
+      return StringRef();
+    return SM.extractText(CharSourceRange(SM, start, end));
+  }
+
+  /// Collects the token ranges within \p D other files can't depend on.
+  void collectHiddenRanges(const Decl *D,
+                           SmallVectorImpl<SourceRange> &hidden) const {
+    if (D->isImplicit())
+      return;
+
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D)) {
+      if (auto *body = AFD->getBody(/*canSynthesize=*/false))
+        hidden.push_back(body->getSourceRange());
+      return;
+    }
+
+    if (auto *NTD = dyn_cast<NominalTypeDecl>(D)) {
+      collectHiddenMembers(NTD->getMembers(), isa<ClassDecl>(NTD), hidden);
+    } else if (auto *ED = dyn_cast<ExtensionDecl>(D)) {
+      bool isClass =
+          ED->getExtendedType()->getClassOrBoundGenericClass() != nullptr;
+      collectHiddenMembers(ED->getMembers(), isClass, hidden);
+    }
+  }
+
+  void collectHiddenMembers(DeclRange members, bool isClass,
+                            SmallVectorImpl<SourceRange> &hidden) const {
+    for (const Decl *member : members) {
+      auto *FD = dyn_cast<FuncDecl>(member);
+      if (!isClass && FD && !FD->isAccessor() && FD->hasAccessibility() &&
+          FD->getFormalAccess() == Accessibility::Private) {
+        hidden.push_back({getStartLoc(FD), FD->getEndLoc()});
+        continue;
+      }
+      collectHiddenRanges(member, hidden);
+    }
+  }
+
+  StringRef hashDecl(const Decl *D) {
+    // A variable is written as part of its pattern binding.
+    if (auto *VD = dyn_cast<VarDecl>(D))
+      if (auto *PBD = VD->getParentPatternBinding())
+        D = PBD;
+
+    auto &result = DeclHashes[D];
+    if (!result.empty())
+      return result;
+
+    llvm::MD5 hash;
+    SmallVector<SourceRange, 8> hidden;
+    collectHiddenRanges(D, hidden);
+    SourceLoc next = getStartLoc(D);
+    for (SourceRange range : hidden) {
+      if (range.isInvalid())
+        continue;
+      hash.update(getText(next, range.Start));
+      next = getLocForEndOfToken(range.End);
+    }
+    hash.update(getText(next, getLocForEndOfToken(D->getEndLoc())));
+
+    llvm::MD5::MD5Result digest;
+    hash.final(digest);
+    llvm::MD5::stringifyResult(digest, result);
+    return result;
+  }
+
+public:
+  DeclFingerprinter(SourceFile &SF) : SM(SF.getASTContext().SourceMgr) {
+    llvm::MD5 hash;
+    for (const Decl *D : SF.Decls)
+      if (isa<ImportDecl>(D))
+        hash.update(hashDecl(D));
+    llvm::MD5::MD5Result digest;
+    hash.final(digest);
+    llvm::MD5::stringifyResult(digest, FileContext);
+  }
+
+  /// Records that \p D is one of the declarations providing \p name.
+  void add(StringRef name, const Decl *D) {
+    NameHashes[name].push_back(hashDecl(D).str());
+  }
+
+  /// Records that \p D provides \p member of the type \p base, whose names
+  /// are joined by a NUL, as the driver keeps them.
+  void add(StringRef base, StringRef member, const Decl *D) {
+    llvm::SmallString<64> name{base};
+    name.push_back('\0');
+    name += member;
+    add(name, D);
+  }
+
+  void emit(ReferenceDependenciesWriter &writer) {
+    for (auto &entry : NameHashes) {
+      // The order in which the declarations were found doesn't matter.
+      auto &hashes = entry.second;
+      std::sort(hashes.begin(), hashes.end());
+
+      llvm::MD5 hash;
+      hash.update(FileContext);
+      for (auto &declHash : hashes)
+        hash.update(declHash);
+      llvm::MD5::MD5Result digest;
+      hash.final(digest);
+      llvm::SmallString<32> fingerprint;
+      llvm::MD5::stringifyResult(digest, fingerprint);
+      writer.addPair(entry.first, fingerprint);
+    }
+  }
+};
+} // end anonymous namespace
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -202,16 +445,20 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     return true;
   }
 
-  auto escape = [](Identifier name) -> std::string {
-    return llvm::yaml::escape(name.str());
-  };
-
-  out << "### Swift dependencies file v0 ###\n";
+  using Section = reference_dependencies::Section;
+  std::unique_ptr<ReferenceDependenciesWriter> writer;
+  if (opts.EmitBinaryReferenceDependencies)
+    writer.reset(new BinaryReferenceDependenciesWriter(out));
+  else
+    writer.reset(new YAMLReferenceDependenciesWriter(out));
 
+  DeclFingerprinter fingerprints(*SF);
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
+  llvm::DenseMap<const NominalTypeDecl *,
+                 SmallVector<const ExtensionDecl *, 2>> extensionsInFile;
 
-  out << "provides-top-level:\n";
+  writer->beginSection(Section::ProvidesTopLevel);
   for (const Decl *D : SF->Decls) {
     switch (D->getKind()) {
     case DeclKind::Module:
@@ -243,6 +490,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         }
       }
       extendedNominals[NTD] |= !justMembers;
+      extensionsInFile[NTD].push_back(ED);
       findNominals(extendedNominals, ED->getMembers());
       break;
     }
@@ -250,7 +498,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::InfixOperator:
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
-      out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      writer->addName(cast<OperatorDecl>(D)->getName().str());
+      fingerprints.add(cast<OperatorDecl>(D)->getName().str(), D);
       break;
 
     case DeclKind::Enum:
@@ -264,7 +513,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           NTD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(NTD->getName()) << "\"\n";
+      writer->addName(NTD->getName().str());
+      fingerprints.add(NTD->getName().str(), NTD);
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -280,7 +530,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(VD->getName()) << "\"\n";
+      writer->addName(VD->getName().str());
+      fingerprints.add(VD->getName().str(), VD);
       break;
     }
 
@@ -302,20 +553,30 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     }
   }
 
-  out << "provides-nominal:\n";
+  // A type and its members are provided by its declaration, if it's in this
+  // file, along with its extensions here.
+  auto addTypeFingerprints = [&](StringRef key, const NominalTypeDecl *NTD) {
+    if (NTD->getParentSourceFile() == SF)
+      fingerprints.add(key, NTD);
+    for (auto *ED : extensionsInFile.lookup(NTD))
+      fingerprints.add(key, ED);
+  };
+
+  writer->beginSection(Section::ProvidesNominal);
   for (auto entry : extendedNominals) {
     if (!entry.second)
       continue;
-    out << "- \"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\"\n";
+    auto mangledName = mangleTypeAsContext(entry.first);
+    writer->addName(mangledName);
+    addTypeFingerprints(mangledName, entry.first);
   }
 
-  out << "provides-member:\n";
+  writer->beginSection(Section::ProvidesMember);
   for (auto entry : extendedNominals) {
-    out << "- [\"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\", \"\"]\n";
+    auto mangledName = mangleTypeAsContext(entry.first);
+    writer->addPair(mangledName, "");
+    mangledName.push_back('\0');
+    addTypeFingerprints(mangledName, entry.first);
   }
 
   // This is also part of "provides-member".
@@ -329,8 +590,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         continue;
       }
-      out << "- [\"" << mangledName << "\", \""
-          << escape(VD->getName()) << "\"]\n";
+      writer->addPair(mangledName, VD->getName().str());
+      fingerprints.add(mangledName, VD->getName().str(), VD);
     }
   }
 
@@ -338,36 +599,38 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     // FIXME: This requires a traversal of the whole file to compute.
     // We should (a) see if there's a cheaper way to keep it up to date,
     // and/or (b) see if we can fast-path cases where there's no ObjC involved.
-    out << "provides-dynamic-lookup:\n";
+    writer->beginSection(Section::ProvidesDynamicLookup);
     class ValueDeclPrinter : public VisibleDeclConsumer {
     private:
-      raw_ostream &out;
-      std::string (*escape)(Identifier);
+      ReferenceDependenciesWriter &writer;
+      DeclFingerprinter &fingerprints;
     public:
-      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape)
-        : out(out), escape(escape) {}
+      ValueDeclPrinter(ReferenceDependenciesWriter &writer,
+                       DeclFingerprinter &fingerprints)
+        : writer(writer), fingerprints(fingerprints) {}
 
       void foundDecl(ValueDecl *VD, DeclVisibilityKind Reason) override {
-        out << "- \"" << escape(VD->getName()) << "\"\n";
+        writer.addName(VD->getName().str());
+        fingerprints.add(VD->getName().str(), VD);
       }
     };
-    ValueDeclPrinter printer(out, escape);
+    ValueDeclPrinter printer(*writer, fingerprints);
     SF->lookupClassMembers({}, printer);
   }
 
+  writer->beginSection(Section::Fingerprints);
+  fingerprints.emit(*writer);
+
   ReferencedNameTracker *tracker = SF->getReferencedNameTracker();
 
   // FIXME: Sort these?
-  out << "depends-top-level:\n";
+  writer->beginSection(Section::DependsTopLevel);
   for (auto &entry : tracker->getTopLevelNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addName(entry.first.str(), entry.second);
   }
 
-  out << "depends-member:\n";
+  writer->beginSection(Section::DependsMember);
   auto &memberLookupTable = tracker->getUsedMembers();
   using TableEntryTy = std::pair<ReferencedNameTracker::MemberPair, bool>;
   std::vector<TableEntryTy> sortedMembers{
@@ -394,18 +657,14 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         entry.first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "[\"";
-    out << mangleTypeAsContext(entry.first.first);
-    out << "\", \"";
+    StringRef memberName;
     if (!entry.first.second.empty())
-      out << escape(entry.first.second);
-    out << "\"]\n";
+      memberName = entry.first.second.str();
+    writer->addPair(mangleTypeAsContext(entry.first.first), memberName,
+                    entry.second);
   }
 
-  out << "depends-nominal:\n";
+  writer->beginSection(Section::DependsNominal);
   for (auto i = sortedMembers.begin(), e = sortedMembers.end(); i != e; ++i) {
     bool isCascading = i->second;
     while (i+1 != e && i[0].first.first == i[1].first.first) {
@@ -417,32 +676,24 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         i->first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!isCascading)
-      out << "!private ";
-    out << "\"";
-    out <<  mangleTypeAsContext(i->first.first);
-    out << "\"\n";
+    writer->addName(mangleTypeAsContext(i->first.first), isCascading);
   }
 
   // FIXME: Sort these?
-  out << "depends-dynamic-lookup:\n";
+  writer->beginSection(Section::DependsDynamicLookup);
   for (auto &entry : tracker->getDynamicLookupNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addName(entry.first.str(), entry.second);
   }
 
-  out << "depends-external:\n";
-  for (auto &entry : depTracker.getDependencies()) {
-    out << "- \"" << llvm::yaml::escape(entry) << "\"\n";
-  }
+  writer->beginSection(Section::DependsExternal);
+  for (auto &entry : depTracker.getDependencies())
+    writer->addName(entry);
 
   llvm::SmallString<32> interfaceHash;
   SF->getInterfaceHash(interfaceHash);
-  out << "interface-hash: \"" << interfaceHash << "\"\n";
+  writer->setInterfaceHash(interfaceHash);
+  writer->finish();
 
   return false;
 }
@@ -457,6 +708,8 @@ static bool writeSIL(SILModule &SM, Module *M, bool EmitVerboseSIL,
                                       OutputFilename, EC.message());
     return true;
   }
+  // Whole-module SIL is large; write it out in big chunks.
+  OS.SetBufferSize(1 << 20);
   SM.print(OS, EmitVerboseSIL, M, SortSIL);
   return false;
 }
@@ -599,135 +852,357 @@ private:
 
 } // anonymous namespace
 
-// This is a separate function so that it shows up in stack traces.
-LLVM_ATTRIBUTE_NOINLINE
-static void debugFailWithAssertion() {
-  // This assertion should always fail, per the user's request, and should
-  // not be converted to llvm_unreachable.
-  assert(0 && "This is an assertion!");
-}
-
-// This is a separate function so that it shows up in stack traces.
-LLVM_ATTRIBUTE_NOINLINE
-static void debugFailWithCrash() {
-  LLVM_BUILTIN_TRAP;
-}
-
-/// Performs the compile requested by the user.
-/// \returns true on error
-static bool performCompile(CompilerInstance &Instance,
-                           CompilerInvocation &Invocation,
-                           ArrayRef<const char *> Args,
-                           int &ReturnValue,
-                           FrontendObserver *observer) {
-  FrontendOptions opts = Invocation.getFrontendOptions();
-  FrontendOptions::ActionType Action = opts.RequestedAction;
+/// Writes the entries of a solver profile as a JSON array, most expensive
+/// first.
+static bool
+emitSolverProfile(DiagnosticEngine &diags, SourceManager &SM,
+                  std::vector<ASTContext::SolverProfileEntry> &profile,
+                  StringRef outputPath) {
+  std::error_code EC;
+  llvm::raw_fd_ostream out(outputPath, EC, llvm::sys::fs::F_None);
+  if (out.has_error() || EC) {
+    diags.diagnose(SourceLoc(), diag::error_opening_output, outputPath,
+                   EC.message());
+    out.clear_error();
+    return true;
+  }
 
-  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+  std::stable_sort(profile.begin(), profile.end(),
+                   [](const ASTContext::SolverProfileEntry &lhs,
+                      const ASTContext::SolverProfileEntry &rhs) {
+    return lhs.WallTime > rhs.WallTime;
+  });
 
-  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
-  if (inputIsLLVMIr) {
-    auto &LLVMContext = llvm::getGlobalContext();
+  auto writeLoc = [&](StringRef key, SourceLoc loc) {
+    unsigned line, column;
+    std::tie(line, column) = SM.getLineAndColumn(loc);
+    out << "\"" << key << "_line\": " << line << ", "
+        << "\"" << key << "_column\": " << column << ", ";
+  };
 
-    // Load in bitcode file.
-    assert(Invocation.getInputFilenames().size() == 1 &&
-           "We expect a single input for bitcode input!");
-    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
-      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
-    if (!FileBufOrErr) {
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_open_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              FileBufOrErr.getError().message());
-      return true;
+  out << "[\n";
+  for (size_t i = 0, e = profile.size(); i != e; ++i) {
+    const ASTContext::SolverProfileEntry &entry = profile[i];
+    out << "  {";
+    if (entry.Range.isValid()) {
+      out << "\"file\": \"";
+      out.write_escaped(SM.getIdentifierForBuffer(
+          SM.findBufferContainingLoc(entry.Range.Start)));
+      out << "\", ";
+      writeLoc("start", entry.Range.Start);
+      writeLoc("end", Lexer::getLocForEndOfToken(SM, entry.Range.End));
     }
-    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+    out << llvm::format("\"wall_time_ms\": %0.3f, ", entry.WallTime * 1000)
+        << llvm::format("\"ranking_time_ms\": %0.3f, ",
+                        entry.RankingTime * 1000)
+        << "\"peak_solver_memory\": " << entry.PeakSolverMemory << ", "
+        << "\"states_explored\": " << entry.NumStatesExplored << ", "
+        << "\"disjunctions\": " << entry.NumDisjunctions << ", "
+        << "\"disjunction_terms\": " << entry.NumDisjunctionTerms << ", "
+        << "\"components_split\": " << entry.NumComponentsSplit << ", "
+        << "\"solutions_compared\": " << entry.NumSolutionsCompared << "}"
+        << (i + 1 == e ? "\n" : ",\n");
+  }
+  out << "]\n";
+  return false;
+}
 
-    llvm::SMDiagnostic Err;
-    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
-                                             MainFile->getMemBufferRef(),
-                                             Err, LLVMContext);
-    if (!Module) {
-      // TODO: Translate from the diagnostic info to the SourceManager location
-      // if available.
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_parse_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              Err.getMessage());
-      return true;
-    }
+namespace {
+/// The SIL a frontend job produced, for its -stats-output-dir file.
+struct SILCounters {
+  size_t NumFunctions = 0;
+  size_t NumBasicBlocks = 0;
+  size_t NumInstructions = 0;
+  size_t NumVTables = 0;
+  size_t NumWitnessTables = 0;
+  size_t NumGlobalVariables = 0;
+};
 
-    // TODO: remove once the frontend understands what action it should perform
-    IRGenOpts.OutputKind = getOutputKind(Action);
+/// How much memory a frontend job was using when a phase was done.
+struct PhaseMemory {
+  std::string Phase;
+  uint64_t PeakRSS;
+  size_t MallocBytes;
+  size_t ASTBytes;
+  size_t SILBytes;
+};
 
-    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+/// What a frontend job did, for its -stats-output-dir file.
+struct JobStats {
+  SILCounters SIL;
+  std::vector<PhaseMemory> Memory;
+};
+} // end anonymous namespace
+
+/// Adds the contents of \p SM to \p stats, if there are any.
+static void countSIL(JobStats *stats, SILModule &SM) {
+  if (!stats)
+    return;
+  SILCounters *counters = &stats->SIL;
+  for (SILFunction &F : SM) {
+    ++counters->NumFunctions;
+    for (SILBasicBlock &BB : F) {
+      ++counters->NumBasicBlocks;
+      counters->NumInstructions += BB.size();
+    }
   }
+  counters->NumVTables += SM.getVTableList().size();
+  counters->NumWitnessTables += SM.getWitnessTableList().size();
+  counters->NumGlobalVariables += SM.getSILGlobalList().size();
+}
 
-  ReferencedNameTracker nameTracker;
-  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
-    Instance.setReferencedNameTracker(&nameTracker);
+/// Returns the most memory this process had resident at once, in bytes, or
+/// 0 if the host can't tell.
+static uint64_t getPeakResidentSetSize() {
+#if LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
 
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpInterfaceHash)
-    Instance.performParseOnly();
-  else
-    Instance.performSema();
+/// Notes the memory used once \p phase is done: prints it for
+/// -print-ast-memory and -print-phase-memory, and keeps it in \p stats.
+///
+/// The peak RSS only ever grows, so the first phase after which it jumped is
+/// the one to blame for it.
+static void recordPhaseMemory(const FrontendOptions &opts, ASTContext &context,
+                              const SILModule *SM, StringRef phase,
+                              JobStats *stats) {
+  if (opts.PrintASTMemory) {
+    llvm::errs() << "AST memory after " << phase << ":\n";
+    context.printMemoryUsage(llvm::errs());
+  }
+  if (!opts.PrintPhaseMemory && !stats)
+    return;
+
+  PhaseMemory memory;
+  memory.Phase = phase;
+  memory.PeakRSS = getPeakResidentSetSize();
+  memory.MallocBytes = llvm::sys::Process::GetMallocUsage();
+  memory.ASTBytes = context.getTotalMemory();
+  memory.SILBytes = SM ? SM->getTotalMemory() : 0;
+
+  if (opts.PrintPhaseMemory) {
+    // Print right away, so that the numbers survive the job being killed for
+    // using too much memory.
+    llvm::errs() << "Memory after " << phase << ": "
+                 << "peak RSS " << memory.PeakRSS << ", "
+                 << "malloc " << memory.MallocBytes << ", "
+                 << "AST " << memory.ASTBytes << ", "
+                 << "SIL " << memory.SILBytes << "\n";
+  }
+  if (stats)
+    stats->Memory.push_back(std::move(memory));
+}
 
-  if (observer) {
-    observer->performedSemanticAnalysis(Instance);
+/// Writes the LLVM statistics collected so far as the members of a JSON
+/// array.
+///
+/// LLVM only prints its statistics as a table, so this reads them back out
+/// of that.
+static void writeLLVMStatistics(raw_ostream &out) {
+  std::string table;
+  {
+    llvm::raw_string_ostream tableOut(table);
+    llvm::PrintStatistics(tableOut);
   }
 
-  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
-  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
-    debugFailWithAssertion();
-  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
-    debugFailWithCrash();
+  bool first = true;
+  StringRef rest = table;
+  while (!rest.empty()) {
+    StringRef line;
+    std::tie(line, rest) = rest.split('\n');
 
-  ASTContext &Context = Instance.getASTContext();
+    StringRef valueStr;
+    std::tie(valueStr, line) = line.ltrim().split(' ');
+    uint64_t value;
+    if (valueStr.getAsInteger(10, value))
+      continue;
+    size_t separator = line.find(" - ");
+    if (separator == StringRef::npos)
+      continue;
 
-  if (Action == FrontendOptions::REPL) {
-    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
-            Invocation.getParseStdlib());
-    return false;
+    out << (first ? "\n" : ",\n") << "    {\"component\": \"";
+    out.write_escaped(line.substr(0, separator).trim());
+    out << "\", \"description\": \"";
+    out.write_escaped(line.substr(separator + 3).trim());
+    out << "\", \"value\": " << value << "}";
+    first = false;
   }
+  if (!first)
+    out << "\n  ";
+}
 
-  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
+/// Writes what this job did to a new JSON file in \c opts.StatsOutputDir.
+///
+/// \returns true on error
+static bool emitStatsFile(CompilerInstance &Instance,
+                          const FrontendOptions &opts,
+                          ArrayRef<TimedPhase> timeline,
+                          const JobStats &stats) {
+  DiagnosticEngine &diags = Instance.getDiags();
+  StringRef dir = opts.StatsOutputDir;
+  if (std::error_code EC = llvm::sys::fs::create_directories(dir)) {
+    diags.diagnose(SourceLoc(), diag::error_opening_output, dir, EC.message());
+    return true;
+  }
 
-  // We've been told to dump the AST (either after parsing or type-checking,
-  // which is already differentiated in CompilerInstance::performSema()),
-  // so dump or print the main source file and return.
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpAST ||
-      Action == FrontendOptions::PrintAST ||
-      Action == FrontendOptions::DumpTypeRefinementContexts ||
-      Action == FrontendOptions::DumpInterfaceHash) {
-    SourceFile *SF = PrimarySourceFile;
-    if (!SF) {
-      SourceFileKind Kind = Invocation.getSourceFileKind();
-      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+  // Name the file after the job's primary input, so that it can be found
+  // again, but keep it unique: the same file may be compiled more than once
+  // per build.
+  StringRef stem = "all";
+  if (opts.PrimaryInput.hasValue() && opts.PrimaryInput->isFilename())
+    stem = llvm::sys::path::stem(
+        opts.InputFilenames[opts.PrimaryInput->Index]);
+  SmallString<128> model = dir;
+  llvm::sys::path::append(model, Twine("frontend-") + opts.ModuleName + "-" +
+                                     stem + "-%%%%%%%%.json");
+  int fd;
+  SmallString<128> path;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(model, fd, path)) {
+    diags.diagnose(SourceLoc(), diag::error_opening_output, model.str(),
+                   EC.message());
+    return true;
+  }
+  llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+
+  out << "{\n  \"module\": \"";
+  out.write_escaped(opts.ModuleName);
+  out << "\",\n  \"primary_files\": [";
+  SmallVector<SourceFile *, 4> primaryFiles;
+  if (SourceFile *primary = Instance.getPrimarySourceFile())
+    primaryFiles.push_back(primary);
+  primaryFiles.append(Instance.getAdditionalPrimarySourceFiles().begin(),
+                      Instance.getAdditionalPrimarySourceFiles().end());
+  for (size_t i = 0, e = primaryFiles.size(); i != e; ++i) {
+    out << (i ? ", " : "") << "\"";
+    out.write_escaped(primaryFiles[i]->getFilename());
+    out << "\"";
+  }
+  out << "],\n";
+
+  // Total the time of each phase. Phases keep the order they first started
+  // in.
+  SmallVector<std::pair<StringRef, uint64_t>, 16> phaseTimes;
+  llvm::StringMap<size_t> phaseIndices;
+  for (const TimedPhase &phase : timeline) {
+    auto inserted = phaseIndices.insert({phase.Name, phaseTimes.size()});
+    if (inserted.second)
+      phaseTimes.push_back({phase.Name, 0});
+    phaseTimes[inserted.first->second].second +=
+        phase.End.usec() - phase.Start.usec();
+  }
+  out << "  \"phases_ms\": {";
+  for (size_t i = 0, e = phaseTimes.size(); i != e; ++i) {
+    out << (i ? ",\n" : "\n") << "    \"";
+    out.write_escaped(phaseTimes[i].first);
+    out << llvm::format("\": %0.3f", phaseTimes[i].second / 1000.0);
+  }
+  out << (phaseTimes.empty() ? "" : "\n  ") << "},\n";
+
+  size_t numSourceFiles = 0, numTopLevelDecls = 0;
+  for (FileUnit *file : Instance.getMainModule()->getFiles()) {
+    if (auto SF = dyn_cast<SourceFile>(file)) {
+      ++numSourceFiles;
+      numTopLevelDecls += SF->Decls.size();
     }
-    if (Action == FrontendOptions::PrintAST)
-      SF->print(llvm::outs(), PrintOptions::printEverything());
-    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
-      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
-    else if (Action == FrontendOptions::DumpInterfaceHash)
-      SF->dumpInterfaceHash(llvm::errs());
-    else
-      SF->dump();
-    return false;
   }
+  out << "  \"ast\": {"
+      << "\"source_files\": " << numSourceFiles << ", "
+      << "\"top_level_decls\": " << numTopLevelDecls << ", "
+      << "\"memory_bytes\": " << Instance.getASTContext().getTotalMemory()
+      << "},\n";
+
+  const SILCounters &silCounters = stats.SIL;
+  out << "  \"sil\": {"
+      << "\"functions\": " << silCounters.NumFunctions << ", "
+      << "\"basic_blocks\": " << silCounters.NumBasicBlocks << ", "
+      << "\"instructions\": " << silCounters.NumInstructions << ", "
+      << "\"vtables\": " << silCounters.NumVTables << ", "
+      << "\"witness_tables\": " << silCounters.NumWitnessTables << ", "
+      << "\"global_variables\": " << silCounters.NumGlobalVariables
+      << "},\n";
+
+  // How often each diagnostic was emitted, and ignored, e.g. because of
+  // -suppress-warnings.
+  out << "  \"diagnostics\": {";
+  bool firstDiagnostic = true;
+  diags.forEachDiagnosticCount([&](StringRef name, unsigned emitted,
+                                   unsigned ignored) {
+    out << (firstDiagnostic ? "\n" : ",\n") << "    \"" << name << "\": {"
+        << "\"emitted\": " << emitted << ", "
+        << "\"ignored\": " << ignored << "}";
+    firstDiagnostic = false;
+  });
+  out << (firstDiagnostic ? "" : "\n  ") << "},\n";
+
+  // The deserialization counts are part of these.
+  out << "  \"llvm_statistics\": [";
+  writeLLVMStatistics(out);
+  out << "],\n";
+
+  out << "  \"phase_memory\": [";
+  for (size_t i = 0, e = stats.Memory.size(); i != e; ++i) {
+    const PhaseMemory &memory = stats.Memory[i];
+    out << (i ? ",\n" : "\n") << "    {\"phase\": \"";
+    out.write_escaped(memory.Phase);
+    out << "\", "
+        << "\"peak_rss_bytes\": " << memory.PeakRSS << ", "
+        << "\"malloc_bytes\": " << memory.MallocBytes << ", "
+        << "\"ast_bytes\": " << memory.ASTBytes << ", "
+        << "\"sil_bytes\": " << memory.SILBytes << "}";
+  }
+  out << (stats.Memory.empty() ? "" : "\n  ") << "],\n";
 
-  // If we were asked to print Clang stats, do so.
-  if (opts.PrintClangStats && Context.getClangModuleLoader())
-    Context.getClangModuleLoader()->printStatistics();
+  out << "  \"peak_rss_bytes\": " << getPeakResidentSetSize() << "\n}\n";
+  return false;
+}
+
+// This is a separate function so that it shows up in stack traces.
+LLVM_ATTRIBUTE_NOINLINE
+static void debugFailWithAssertion() {
+  // This assertion should always fail, per the user's request, and should
+  // not be converted to llvm_unreachable.
+  assert(0 && "This is an assertion!");
+}
+
+// This is a separate function so that it shows up in stack traces.
+LLVM_ATTRIBUTE_NOINLINE
+static void debugFailWithCrash() {
+  LLVM_BUILTIN_TRAP;
+}
+
+/// Performs the steps of the compile that follow semantic analysis, for
+/// \p PrimarySourceFile or, if there is no primary input, the whole module.
+/// The outputs are written to the paths in \p opts.
+/// \returns true on error
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        IRGenOptions &IRGenOpts,
+                                        SourceFile *PrimarySourceFile,
+                                        int &ReturnValue,
+                                        FrontendObserver *observer,
+                                        JobStats *stats) {
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  ASTContext &Context = Instance.getASTContext();
+  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
 
   if (!opts.DependenciesFilePath.empty())
     (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
                                opts);
 
   if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
+    emitReferenceDependencies(Context.Diags, PrimarySourceFile,
                               *Instance.getDependencyTracker(), opts);
 
   if (Context.hadError())
@@ -771,6 +1246,7 @@ static bool performCompile(CompilerInstance &Instance,
   if (observer) {
     observer->performedSILGeneration(*SM);
   }
+  recordPhaseMemory(opts, Context, SM.get(), "SIL generation", stats);
 
   // We've been told to emit SIL after SILGen, so write it now.
   if (Action == FrontendOptions::EmitSILGen) {
@@ -849,6 +1325,8 @@ static bool performCompile(CompilerInstance &Instance,
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
   }
+  countSIL(stats, *SM);
+  recordPhaseMemory(opts, Context, SM.get(), "SIL optimization", stats);
 
   // Get the main source file's private discriminator and attach it to
   // the compile unit's flags.
@@ -947,6 +1425,10 @@ static bool performCompile(CompilerInstance &Instance,
     return false;
   }
 
+  // Nothing looks at the SIL once it has been lowered, so let the LLVM passes
+  // have its memory.
+  IRGenOpts.ReleaseSILBodies = true;
+
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = llvm::getGlobalContext();
@@ -957,10 +1439,189 @@ static bool performCompile(CompilerInstance &Instance,
     performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
                         opts.getSingleOutputFilename(), LLVMContext);
   }
+  recordPhaseMemory(opts, Context, SM.get(), "IR generation", stats);
 
   return false;
 }
 
+/// Performs the compile requested by the user.
+/// \returns true on error
+static bool performCompile(CompilerInstance &Instance,
+                           CompilerInvocation &Invocation,
+                           ArrayRef<const char *> Args,
+                           int &ReturnValue,
+                           FrontendObserver *observer,
+                           JobStats *stats) {
+  FrontendOptions opts = Invocation.getFrontendOptions();
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+
+  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+
+  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
+  if (inputIsLLVMIr) {
+    auto &LLVMContext = llvm::getGlobalContext();
+
+    // Load in bitcode file.
+    assert(Invocation.getInputFilenames().size() == 1 &&
+           "We expect a single input for bitcode input!");
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
+      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
+    if (!FileBufOrErr) {
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_open_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              FileBufOrErr.getError().message());
+      return true;
+    }
+    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+
+    llvm::SMDiagnostic Err;
+    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
+                                             MainFile->getMemBufferRef(),
+                                             Err, LLVMContext);
+    if (!Module) {
+      // TODO: Translate from the diagnostic info to the SourceManager location
+      // if available.
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_parse_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              Err.getMessage());
+      return true;
+    }
+
+    // TODO: remove once the frontend understands what action it should perform
+    IRGenOpts.OutputKind = getOutputKind(Action);
+
+    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+  }
+
+  if (Action == FrontendOptions::EmitPCH) {
+    assert(Invocation.getInputFilenames().size() == 1 &&
+           "We expect a single header input for a PCH!");
+    auto clangImporter = static_cast<ClangImporter *>(
+        Instance.getASTContext().getClangModuleLoader());
+    StringRef PCHPath = opts.getSingleOutputFilename();
+
+    // A PCH left behind by an earlier build can be reused as long as none of
+    // the headers it was built from has changed.
+    if (clangImporter->canReadPCH(PCHPath))
+      return false;
+    return clangImporter->emitBridgingPCH(Invocation.getInputFilenames()[0],
+                                          PCHPath);
+  }
+
+  ReferencedNameTracker nameTracker;
+  std::vector<ReferencedNameTracker>
+    additionalNameTrackers(opts.AdditionalPrimaryInputs.size());
+  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
+  if (shouldTrackReferences) {
+    Instance.setReferencedNameTracker(&nameTracker);
+
+    SmallVector<ReferencedNameTracker *, 4> additionalTrackerPtrs;
+    for (auto &tracker : additionalNameTrackers)
+      additionalTrackerPtrs.push_back(&tracker);
+    Instance.setAdditionalReferencedNameTrackers(additionalTrackerPtrs);
+  }
+
+  std::vector<ASTContext::SolverProfileEntry> SolverProfile;
+  if (!opts.SolverProfilePath.empty())
+    Instance.getASTContext().SolverProfile = &SolverProfile;
+
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpInterfaceHash)
+    Instance.performParseOnly();
+  else
+    Instance.performSema();
+
+  if (!opts.SolverProfilePath.empty()) {
+    Instance.getASTContext().SolverProfile = nullptr;
+    (void)emitSolverProfile(Instance.getDiags(), Instance.getSourceMgr(),
+                            SolverProfile, opts.SolverProfilePath);
+  }
+  recordPhaseMemory(opts, Instance.getASTContext(), Instance.getSILModule(),
+                    Action == FrontendOptions::DumpParse ||
+                      Action == FrontendOptions::DumpInterfaceHash
+                    ? "parsing" : "type checking", stats);
+
+  if (observer) {
+    observer->performedSemanticAnalysis(Instance);
+  }
+
+  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
+  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
+    debugFailWithAssertion();
+  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
+    debugFailWithCrash();
+
+  ASTContext &Context = Instance.getASTContext();
+
+  if (Action == FrontendOptions::REPL) {
+    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
+            Invocation.getParseStdlib());
+    return false;
+  }
+
+  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
+
+  // We've been told to dump the AST (either after parsing or type-checking,
+  // which is already differentiated in CompilerInstance::performSema()),
+  // so dump or print the main source file and return.
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpAST ||
+      Action == FrontendOptions::PrintAST ||
+      Action == FrontendOptions::DumpTypeRefinementContexts ||
+      Action == FrontendOptions::DumpInterfaceHash) {
+    SourceFile *SF = PrimarySourceFile;
+    if (!SF) {
+      SourceFileKind Kind = Invocation.getSourceFileKind();
+      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+    }
+    if (Action == FrontendOptions::PrintAST)
+      SF->print(llvm::outs(), PrintOptions::printEverything());
+    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
+      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
+    else if (Action == FrontendOptions::DumpInterfaceHash)
+      SF->dumpInterfaceHash(llvm::errs());
+    else
+      SF->dump();
+    return false;
+  }
+
+  // If we were asked to print Clang stats, do so.
+  if (opts.PrintClangStats && Context.getClangModuleLoader())
+    Context.getClangModuleLoader()->printStatistics();
+
+  // In batch mode, each of the primary inputs is compiled in turn as if it
+  // were the only one, sharing the type-checked module.
+  IRGenOptions BatchIRGenOpts = IRGenOpts;
+  bool hadError = performCompileStepsPostSema(Instance, Invocation, opts,
+                                              IRGenOpts, PrimarySourceFile,
+                                              ReturnValue, observer,
+                                              stats);
+
+  ArrayRef<SourceFile *> AdditionalPrimarySourceFiles =
+    Instance.getAdditionalPrimarySourceFiles();
+  for (unsigned i = 0, e = opts.AdditionalPrimaryInputs.size(); i != e; ++i) {
+    FrontendOptions primaryOpts = opts.getOptionsForAdditionalPrimaryInput(i);
+
+    IRGenOptions primaryIRGenOpts = BatchIRGenOpts;
+    if (primaryOpts.PrimaryInput->isFilename()) {
+      primaryIRGenOpts.MainInputFilename =
+        primaryOpts.InputFilenames[primaryOpts.PrimaryInput->Index];
+    }
+    primaryIRGenOpts.OutputFilenames = primaryOpts.OutputFilenames;
+
+    hadError |= performCompileStepsPostSema(Instance, Invocation, primaryOpts,
+                                            primaryIRGenOpts,
+                                            AdditionalPrimarySourceFiles[i],
+                                            ReturnValue, observer,
+                                            stats);
+  }
+
+  return hadError;
+}
+
+
 /// Returns true if an error occurred.
 static bool dumpAPI(Module *Mod, StringRef OutDir) {
   using namespace llvm::sys;
@@ -1140,7 +1801,34 @@ int swift::performFrontend(ArrayRef<const char *> Args,
   if (Invocation.getFrontendOptions().DebugTimeCompilation)
     SharedTimer::enableCompilationTimers();
 
-  if (Invocation.getFrontendOptions().PrintStats) {
+  // Write out the timeline and the statistics however the compilation ends.
+  std::vector<TimedPhase> PhaseTimeline;
+  JobStats JobStatistics;
+  const std::string &PhaseTimelinePath =
+    Invocation.getFrontendOptions().PhaseTimelinePath;
+  const std::string &StatsOutputDir =
+    Invocation.getFrontendOptions().StatsOutputDir;
+  if (!PhaseTimelinePath.empty() || !StatsOutputDir.empty())
+    SharedTimer::recordTimeline(&PhaseTimeline);
+  defer {
+    SharedTimer::recordTimeline(nullptr);
+    if (!StatsOutputDir.empty() && Instance.hasASTContext())
+      (void)emitStatsFile(Instance, Invocation.getFrontendOptions(),
+                          PhaseTimeline, JobStatistics);
+    if (PhaseTimelinePath.empty())
+      return;
+    std::error_code EC;
+    llvm::raw_fd_ostream out(PhaseTimelinePath, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::error_opening_output,
+                                   PhaseTimelinePath, EC.message());
+      return;
+    }
+    SharedTimer::writeTimeline(out, PhaseTimeline);
+  };
+
+  if (Invocation.getFrontendOptions().PrintStats ||
+      !Invocation.getFrontendOptions().StatsOutputDir.empty()) {
     llvm::EnableStatistics();
   }
 
@@ -1165,7 +1853,8 @@ int swift::performFrontend(ArrayRef<const char *> Args,
 
   int ReturnValue = 0;
   bool HadError =
-    performCompile(Instance, Invocation, Args, ReturnValue, observer) ||
+    performCompile(Instance, Invocation, Args, ReturnValue, observer,
+                   StatsOutputDir.empty() ? nullptr : &JobStatistics) ||
     Instance.getASTContext().hadError();
 
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
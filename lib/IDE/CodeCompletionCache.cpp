@@ -2,6 +2,7 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -88,13 +89,16 @@ CodeCompletionCache::~CodeCompletionCache() {}
 ///
 /// This should be incremented any time we commit a change to the format of the
 /// cached results. This isn't expected to change very often.
-static constexpr uint32_t onDiskCompletionCacheVersion = 0;
+static constexpr uint32_t onDiskCompletionCacheVersion = 1;
 
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
+/// The size of each record in the RESULTS section. \see writeCachedModule.
+static constexpr size_t resultRecordSize = 8 + 8 * sizeof(uint32_t);
+
+/// The size of each record in the CHUNKS section. \see writeCachedModule.
+static constexpr size_t chunkRecordSize = 4 + sizeof(uint32_t);
+
+/// The size of each record in the STRINGS section. \see writeCachedModule.
+static constexpr size_t stringRecordSize = 2 * sizeof(uint32_t);
 
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
@@ -113,29 +117,34 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 }
 
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
-/// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+///
+/// The strings of the results point directly into \p in, which is kept alive
+/// for as long as the results' allocator is. A cache file is normally
+/// memory-mapped, so only the pages holding the records, and the strings
+/// that are actually looked at, are ever read in.
+///
+/// \see writeCachedModule.
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
+  using namespace llvm::support;
   const char *cursor = in->getBufferStart();
   const char *end = in->getBufferEnd();
 
-  auto read32le = [end](const char *&cursor) {
-    auto result = llvm::support::endian::read32le(cursor);
-    cursor += sizeof(result);
-    assert(cursor <= end);
-    return result;
+  auto fits = [&](const char *p, size_t size) {
+    return p <= end && size <= size_t(end - p);
   };
 
   // HEADER
+  if (!fits(cursor, sizeof(uint32_t) + sizeof(uint64_t)))
+    return false;
   {
-    auto version = read32le(cursor);
+    auto version = endian::readNext<uint32_t, little, unaligned>(cursor);
     if (version != onDiskCompletionCacheVersion)
       return false; // File written with different format.
 
-    auto mtime = llvm::support::endian::read64le(cursor);
-    cursor += sizeof(mtime);
+    auto mtime = endian::readNext<uint64_t, little, unaligned>(cursor);
 
     // Check the module file's last modification time.
     if (!allowOutOfDate) {
@@ -147,45 +156,89 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     }
   }
 
-  // DEBUG INFO
-  cursor += read32le(cursor); // Skip the whole debug section.
+  // KEY
+  if (!fits(cursor, sizeof(uint32_t)))
+    return false;
+  auto keySize = endian::readNext<uint32_t, little, unaligned>(cursor);
+  if (!fits(cursor, keySize))
+    return false;
+  cursor += keySize; // Skip the whole debug section.
 
   // Get the size of the various sections.
-  auto resultSize = read32le(cursor);
-  const char *resultEnd = cursor + resultSize;
-  const char *chunks = resultEnd;
-  auto chunkSize = read32le(chunks);
-  const char *strings = chunks + chunkSize;
-  auto stringCount = read32le(strings);
-  assert(strings + stringCount == end && "incorrect file size");
-  (void)stringCount; // so it is not seen as "unused" in release builds.
-  
+  if (!fits(cursor, 4 * sizeof(uint32_t)))
+    return false;
+  auto resultCount = endian::readNext<uint32_t, little, unaligned>(cursor);
+  auto chunkCount = endian::readNext<uint32_t, little, unaligned>(cursor);
+  auto stringListCount = endian::readNext<uint32_t, little, unaligned>(cursor);
+  auto stringCount = endian::readNext<uint32_t, little, unaligned>(cursor);
+
+  uint64_t resultsSize = uint64_t(resultCount) * resultRecordSize;
+  uint64_t chunksSize = uint64_t(chunkCount) * chunkRecordSize;
+  uint64_t stringListsSize = uint64_t(stringListCount) * sizeof(uint32_t);
+  uint64_t stringsSize = uint64_t(stringCount) * stringRecordSize;
+  if (uint64_t(end - cursor) <
+      resultsSize + chunksSize + stringListsSize + stringsSize)
+    return false;
+
+  const char *results = cursor;
+  const char *chunks = results + resultsSize;
+  const char *stringLists = chunks + chunksSize;
+  const char *strings = stringLists + stringListsSize;
+  const char *stringData = strings + stringsSize;
+  size_t stringDataSize = end - stringData;
+
+  bool malformed = false;
+
   // STRINGS
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
       return "";
+    if (index >= stringCount) {
+      malformed = true;
+      return "";
+    }
+
+    const char *p = strings + index * stringRecordSize;
+    auto offset = endian::readNext<uint32_t, little, unaligned>(p);
+    auto size = endian::readNext<uint32_t, little, unaligned>(p);
+    if (offset > stringDataSize || size > stringDataSize - offset) {
+      malformed = true;
+      return "";
+    }
+    return StringRef(stringData + offset, size);
+  };
 
-    const char *p = strings + index;
-    auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+  // STRING LISTS
+  auto getStringFromList = [&](uint32_t index) -> StringRef {
+    if (index >= stringListCount) {
+      malformed = true;
+      return "";
+    }
+    const char *p = stringLists + index * sizeof(uint32_t);
+    return getString(endian::readNext<uint32_t, little, unaligned>(p));
   };
 
   // CHUNKS
-  auto getCompletionString = [&](uint32_t chunkIndex) {
-    const char *p = chunks + chunkIndex;
-    auto len = read32le(p);
-    using Chunk = CodeCompletionString::Chunk;
-    SmallVector<Chunk, 32> chunkList;
-    for (unsigned j = 0; j < len; ++j) {
-      auto kind = static_cast<Chunk::ChunkKind>(*p++);
-      auto nest = *p++;
-      auto isAnnotation = static_cast<bool>(*p++);
-      auto textIndex = read32le(p);
-      auto text = getString(textIndex);
+  using Chunk = CodeCompletionString::Chunk;
+  SmallVector<Chunk, 32> chunkList;
+  auto getCompletionString = [&](uint32_t firstChunk, uint32_t numChunks) {
+    chunkList.clear();
+    if (firstChunk > chunkCount || numChunks > chunkCount - firstChunk) {
+      malformed = true;
+      numChunks = 0;
+    }
+    const char *p = chunks + firstChunk * chunkRecordSize;
+    for (unsigned j = 0; j < numChunks; ++j) {
+      auto kind = static_cast<Chunk::ChunkKind>(p[0]);
+      auto nest = static_cast<unsigned>(p[1]);
+      auto isAnnotation = static_cast<bool>(p[2]);
+      p += 4;
+      auto textIndex = endian::readNext<uint32_t, little, unaligned>(p);
 
       if (Chunk::chunkHasText(kind)) {
-        chunkList.push_back(
-            Chunk::createWithText(kind, nest, text, isAnnotation));
+        chunkList.push_back(Chunk::createWithText(kind, nest,
+                                                  getString(textIndex),
+                                                  isAnnotation));
       } else {
         chunkList.push_back(Chunk::createSimple(kind, nest, isAnnotation));
       }
@@ -194,49 +247,56 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     return CodeCompletionString::create(*V.Sink.Allocator, chunkList);
   };
 
-  // RESULTS
-  while (cursor != resultEnd) {
-    auto kind = static_cast<CodeCompletionResult::ResultKind>(*cursor++);
-    auto declKind = static_cast<CodeCompletionDeclKind>(*cursor++);
-    auto opKind = static_cast<CodeCompletionOperatorKind>(*cursor++);
-    auto context = static_cast<SemanticContextKind>(*cursor++);
-    auto notRecommended = static_cast<bool>(*cursor++);
-    auto numBytesToErase = static_cast<unsigned>(*cursor++);
-    auto oldCursor = cursor;
-    auto chunkIndex = read32le(cursor);
-    auto IntLength = cursor - oldCursor;
-    auto moduleIndex = read32le(cursor);
-    auto briefDocIndex = read32le(cursor);
-    auto assocUSRCount = read32le(cursor);
-    auto assocUSRsIndex = read32le(cursor);
-    auto declKeywordCount = read32le(cursor);
-    auto declKeywordIndex = read32le(cursor);
-
-    CodeCompletionString *string = getCompletionString(chunkIndex);
-    auto moduleName = getString(moduleIndex);
-    auto briefDocComment = getString(briefDocIndex);
-    SmallVector<StringRef, 4> assocUSRs;
-    for (unsigned i = 0; i < assocUSRCount; ++i) {
-      auto usr = getString(assocUSRsIndex);
-      assocUSRs.push_back(usr);
-      assocUSRsIndex += usr.size() + IntLength;
-    }
+  // Keep the file alive for as long as the strings pointing into it.
+  llvm::MemoryBuffer *buffer = in.release();
+  V.Sink.Allocator = CodeCompletionResultSink::AllocatorPtr(
+      new llvm::BumpPtrAllocator(), [buffer](llvm::BumpPtrAllocator *alloc) {
+        delete alloc;
+        delete buffer;
+      });
 
-    SmallVector<std::pair<StringRef, StringRef>, 4> declKeywords;
-    for (unsigned i = 0; i < declKeywordCount; ++i) {
-      auto first = getString(declKeywordIndex);
-      declKeywordIndex += first.size() + IntLength;
-      auto second = getString(declKeywordIndex);
-      declKeywordIndex += second.size() + IntLength;
-      declKeywords.push_back(std::make_pair(first, second));
-    }
+  // RESULTS
+  V.Sink.Results.reserve(resultCount);
+  SmallVector<StringRef, 4> assocUSRs;
+  SmallVector<std::pair<StringRef, StringRef>, 4> declKeywords;
+  for (uint32_t i = 0; i != resultCount; ++i) {
+    const char *p = results + i * resultRecordSize;
+    auto kind = static_cast<CodeCompletionResult::ResultKind>(p[0]);
+    auto declKind = static_cast<CodeCompletionDeclKind>(p[1]);
+    auto opKind = static_cast<CodeCompletionOperatorKind>(p[2]);
+    auto context = static_cast<SemanticContextKind>(p[3]);
+    auto notRecommended = static_cast<bool>(p[4]);
+    auto numBytesToErase = static_cast<unsigned char>(p[5]);
+    p += 8;
+    auto firstChunk = endian::readNext<uint32_t, little, unaligned>(p);
+    auto numChunks = endian::readNext<uint32_t, little, unaligned>(p);
+    auto moduleIndex = endian::readNext<uint32_t, little, unaligned>(p);
+    auto briefDocIndex = endian::readNext<uint32_t, little, unaligned>(p);
+    auto assocUSRsIndex = endian::readNext<uint32_t, little, unaligned>(p);
+    auto assocUSRCount = endian::readNext<uint32_t, little, unaligned>(p);
+    auto declKeywordIndex = endian::readNext<uint32_t, little, unaligned>(p);
+    auto declKeywordCount = endian::readNext<uint32_t, little, unaligned>(p);
+
+    CodeCompletionString *string = getCompletionString(firstChunk, numChunks);
 
     CodeCompletionResult *result = nullptr;
     if (kind == CodeCompletionResult::Declaration) {
+      assocUSRs.clear();
+      for (uint32_t j = 0; j < assocUSRCount && !malformed; ++j)
+        assocUSRs.push_back(getStringFromList(assocUSRsIndex + j));
+
+      declKeywords.clear();
+      for (uint32_t j = 0; j < declKeywordCount && !malformed; ++j) {
+        auto first = getStringFromList(declKeywordIndex + 2 * j);
+        auto second = getStringFromList(declKeywordIndex + 2 * j + 1);
+        declKeywords.push_back(std::make_pair(first, second));
+      }
+
       result = new (*V.Sink.Allocator) CodeCompletionResult(
-          context, numBytesToErase, string, declKind, moduleName,
+          context, numBytesToErase, string, declKind, getString(moduleIndex),
           notRecommended, CodeCompletionResult::NotRecommendedReason::NoReason,
-          briefDocComment, copyStringArray(*V.Sink.Allocator, assocUSRs),
+          getString(briefDocIndex),
+          copyStringArray(*V.Sink.Allocator, assocUSRs),
           copyStringPairArray(*V.Sink.Allocator, declKeywords), opKind);
     } else {
       result = new (*V.Sink.Allocator)
@@ -244,6 +304,10 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
                                CodeCompletionResult::Unrelated, opKind);
     }
 
+    if (malformed) {
+      V.Sink.Results.clear();
+      return false;
+    }
     V.Sink.Results.push_back(result);
   }
 
@@ -261,17 +325,28 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///   KEY
 ///     * the original CodeCompletionCache::Key, used for debugging the cache.
 ///
+///   COUNTS
+///     * The number of records in RESULTS, CHUNKS, STRING LISTS and STRINGS.
+///
 ///   RESULTS
-///     * A length-prefixed array of fixed size CodeCompletionResults.
-///     * Contains offsets into CHUNKS and STRINGS.
+///     * An array of fixed size CodeCompletionResult records.
+///     * Contains indices into CHUNKS, STRING LISTS and STRINGS.
 ///
 ///   CHUNKS
-///     * A length-prefixed array of CodeCompletionStrings.
-///     * Each CodeCompletionString is a length-prefixed array of fixed size
-///       CodeCompletionString::Chunks.
+///     * An array of fixed size CodeCompletionString::Chunk records. Each
+///       result refers to the run of chunks making up its string.
+///
+///   STRING LISTS
+///     * An array of indices into STRINGS, for the associated USRs and the
+///       declaration keywords of the results.
 ///
 ///   STRINGS
-///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * An array of fixed size (offset, length) records into the string data.
+///       Each distinct string is stored once.
+///     * The string data.
+///
+/// Since every record has a fixed size, the reader can find any of them
+/// without decoding what comes before.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -301,95 +376,105 @@ static void writeCachedModule(llvm::raw_ostream &out,
     out.write(OSS.str().data(), OSS.str().size()); // Debug info blob
   }
 
-  // String streams for writing to the CHUNKS and STRINGS sections.
+  // String streams for writing the sections.
   std::string results_;
   llvm::raw_string_ostream results(results_);
+  endian::Writer<little> resultsLE(results);
   std::string chunks_;
   llvm::raw_string_ostream chunks(chunks_);
   endian::Writer<little> chunksLE(chunks);
+  std::string stringLists_;
+  llvm::raw_string_ostream stringLists(stringLists_);
+  endian::Writer<little> stringListsLE(stringLists);
   std::string strings_;
   llvm::raw_string_ostream strings(strings_);
+  endian::Writer<little> stringsLE(strings);
+  std::string stringData_;
+  llvm::raw_string_ostream stringData(stringData_);
+
+  uint32_t chunkCount = 0, stringListCount = 0;
+  llvm::StringMap<uint32_t> stringIndices;
 
-  auto addString = [&strings](StringRef str) {
+  auto addString = [&](StringRef str) -> uint32_t {
     if (str.empty())
       return ~0u;
-    auto size = strings.tell();
-    endian::Writer<little> LE(strings);
-    LE.write(static_cast<uint32_t>(str.size()));
-    strings << str;
-    return static_cast<uint32_t>(size);
+    auto inserted = stringIndices.insert({str, stringIndices.size()});
+    if (inserted.second) {
+      stringsLE.write(static_cast<uint32_t>(stringData.tell()));
+      stringsLE.write(static_cast<uint32_t>(str.size()));
+      stringData << str;
+    }
+    return inserted.first->second;
   };
 
-  auto addCompletionString = [&](const CodeCompletionString *str) {
-    auto size = chunks.tell();
-    chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
-    for (auto chunk : str->getChunks()) {
+  auto addToStringList = [&](StringRef str) {
+    stringListsLE.write(addString(str));
+    return stringListCount++;
+  };
+
+  // RESULTS
+  for (CodeCompletionResult *R : V.Sink.Results) {
+    // FIXME: compress bitfield
+    resultsLE.write(static_cast<uint8_t>(R->getKind()));
+    if (R->getKind() == CodeCompletionResult::Declaration)
+      resultsLE.write(static_cast<uint8_t>(R->getAssociatedDeclKind()));
+    else
+      resultsLE.write(static_cast<uint8_t>(~0u));
+    if (R->isOperator())
+      resultsLE.write(static_cast<uint8_t>(R->getOperatorKind()));
+    else
+      resultsLE.write(static_cast<uint8_t>(CodeCompletionOperatorKind::None));
+    resultsLE.write(static_cast<uint8_t>(R->getSemanticContext()));
+    resultsLE.write(static_cast<uint8_t>(R->isNotRecommended()));
+    resultsLE.write(static_cast<uint8_t>(R->getNumBytesToErase()));
+    resultsLE.write(static_cast<uint16_t>(0)); // padding
+
+    // CHUNKS
+    auto stringChunks = R->getCompletionString()->getChunks();
+    resultsLE.write(chunkCount);
+    resultsLE.write(static_cast<uint32_t>(stringChunks.size()));
+    for (auto chunk : stringChunks) {
       chunksLE.write(static_cast<uint8_t>(chunk.getKind()));
       chunksLE.write(static_cast<uint8_t>(chunk.getNestingLevel()));
       chunksLE.write(static_cast<uint8_t>(chunk.isAnnotation()));
-      if (chunk.hasText()) {
+      chunksLE.write(static_cast<uint8_t>(0)); // padding
+      if (chunk.hasText())
         chunksLE.write(addString(chunk.getText()));
-      } else {
+      else
         chunksLE.write(static_cast<uint32_t>(~0u));
-      }
+      ++chunkCount;
     }
-    return static_cast<uint32_t>(size);
-  };
 
-  // RESULTS
-  {
-    endian::Writer<little> LE(results);
-    for (CodeCompletionResult *R : V.Sink.Results) {
-      // FIXME: compress bitfield
-      LE.write(static_cast<uint8_t>(R->getKind()));
-      if (R->getKind() == CodeCompletionResult::Declaration)
-        LE.write(static_cast<uint8_t>(R->getAssociatedDeclKind()));
-      else
-        LE.write(static_cast<uint8_t>(~0u));
-      if (R->isOperator())
-        LE.write(static_cast<uint8_t>(R->getOperatorKind()));
-      else
-        LE.write(static_cast<uint8_t>(CodeCompletionOperatorKind::None));
-      LE.write(static_cast<uint8_t>(R->getSemanticContext()));
-      LE.write(static_cast<uint8_t>(R->isNotRecommended()));
-      LE.write(static_cast<uint8_t>(R->getNumBytesToErase()));
-      LE.write(
-          static_cast<uint32_t>(addCompletionString(R->getCompletionString())));
-      LE.write(addString(R->getModuleName()));      // index into strings
-      LE.write(addString(R->getBriefDocComment())); // index into strings
-      LE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
-      if (R->getAssociatedUSRs().empty()) {
-        LE.write(static_cast<uint32_t>(~0u));
-      } else {
-        LE.write(addString(R->getAssociatedUSRs()[0]));
-        for (unsigned i = 1; i < R->getAssociatedUSRs().size(); ++i) {
-          addString(R->getAssociatedUSRs()[i]); // ignore result
-        }
-      }
-      auto AllKeywords = R->getDeclKeywords();
-      LE.write(static_cast<uint32_t>(AllKeywords.size()));
-      if (AllKeywords.empty()) {
-        LE.write(static_cast<uint32_t>(~0u));
-      } else {
-        LE.write(addString(AllKeywords[0].first));
-        addString(AllKeywords[0].second);
-        for (unsigned i = 1; i < AllKeywords.size(); ++i) {
-          addString(AllKeywords[i].first);
-          addString(AllKeywords[i].second);
-        }
-      }
+    resultsLE.write(addString(R->getModuleName()));
+    resultsLE.write(addString(R->getBriefDocComment()));
+
+    resultsLE.write(stringListCount);
+    resultsLE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
+    for (StringRef USR : R->getAssociatedUSRs())
+      addToStringList(USR);
+
+    auto AllKeywords = R->getDeclKeywords();
+    resultsLE.write(stringListCount);
+    resultsLE.write(static_cast<uint32_t>(AllKeywords.size()));
+    for (auto keyword : AllKeywords) {
+      addToStringList(keyword.first);
+      addToStringList(keyword.second);
     }
   }
-  LE.write(static_cast<uint32_t>(results.tell()));
-  out << results.str();
+  assert(results.tell() == V.Sink.Results.size() * resultRecordSize);
+  assert(chunks.tell() == chunkCount * chunkRecordSize);
 
-  // CHUNKS
-  LE.write(static_cast<uint32_t>(chunks.tell()));
-  out << chunks.str();
+  // COUNTS
+  LE.write(static_cast<uint32_t>(V.Sink.Results.size()));
+  LE.write(chunkCount);
+  LE.write(stringListCount);
+  LE.write(static_cast<uint32_t>(stringIndices.size()));
 
-  // STRINGS
-  LE.write(static_cast<uint32_t>(strings.tell()));
+  out << results.str();
+  out << chunks.str();
+  out << stringLists.str();
   out << strings.str();
+  out << stringData.str();
 }
 
 /// Get the name for the cached code completion results for a given key \p K in
@@ -424,13 +509,15 @@ static std::string getName(StringRef cacheDirectory,
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K),
+                                                 /*FileSize=*/-1,
+                                                 /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -466,7 +553,8 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename, /*FileSize=*/-1,
+                                                 /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
@@ -475,7 +563,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
@@ -430,11 +430,18 @@ class FormatWalker : public SourceEntityWalker {
     void adjustTokenIteratorToImmediateAfter(SourceLoc End) {
       SourceLocIterator LocBegin(Tokens.begin());
       SourceLocIterator LocEnd(Tokens.end());
+      // Only the tokens around the target are lexed; nothing is known about
+      // what follows a location before them.
+      if (Tokens.empty() ||
+          SM.isBeforeInBuffer(End, Tokens.front().getLoc())) {
+        TI = Tokens.end();
+        return;
+      }
       auto Lower = std::lower_bound(LocBegin, LocEnd, End,
                                     [&](SourceLoc L, SourceLoc R) {
                                       return SM.isBeforeInBuffer(L, R);
                                     });
-      if (*Lower == End) {
+      if (Lower != LocEnd && *Lower == End) {
         Lower ++;
       }
       TI = Tokens.begin();
@@ -456,6 +463,8 @@ class FormatWalker : public SourceEntityWalker {
 
     bool isTargetImmediateAfter(SourceLoc Loc) {
       adjustTokenIteratorToImmediateAfter(Loc);
+      if (TI == Tokens.end())
+        return false;
       // Make sure target loc is after loc
       return SM.isBeforeInBuffer(Loc, TargetLoc) &&
       // Make sure immediate loc after loc is not before target loc.
@@ -651,6 +660,40 @@ class FormatWalker : public SourceEntityWalker {
     }
   }
 
+  /// Lexes the tokens that the walk to \p Loc needs: from the start of the
+  /// top-level declaration containing it, or the end of the one before it, to
+  /// the end of its line. Lexing the whole file instead made every indent
+  /// request linear in the size of the file.
+  void tokenizeAround(SourceLoc Loc) {
+    unsigned BufferID = SF.getBufferID().getValue();
+    SourceLoc RegionStart;
+    for (Decl *D : SF.Decls) {
+      SourceLoc Start = D->getStartLoc();
+      SourceLoc End = D->getEndLoc();
+      if (Start.isInvalid() || End.isInvalid())
+        continue;
+      SourceLoc Candidate;
+      if (SM.isBeforeInBuffer(End, Loc))
+        Candidate = End;
+      else if (!SM.isBeforeInBuffer(Loc, Start))
+        Candidate = Start;
+      if (Candidate.isValid() && (RegionStart.isInvalid() ||
+                                  SM.isBeforeInBuffer(RegionStart, Candidate)))
+        RegionStart = Candidate;
+    }
+
+    StringRef Text = SM.getLLVMSourceMgr().getMemoryBuffer(BufferID)
+                       ->getBuffer();
+    unsigned StartOffset = RegionStart.isValid() ?
+      SM.getLocOffsetInBuffer(RegionStart, BufferID) : 0;
+    size_t EndOffset = Text.find('\n', SM.getLocOffsetInBuffer(Loc, BufferID));
+    if (EndOffset == StringRef::npos)
+      EndOffset = Text.size();
+
+    Tokens = tokenize(Options, SM, BufferID, StartOffset, EndOffset);
+    CurrentTokIt = Tokens.begin();
+  }
+
   template <typename T>
   bool HandlePost(T* Node) {
     if (SM.isBeforeInBuffer(TargetLocation, Node->getStartLoc()))
@@ -662,7 +705,6 @@ class FormatWalker : public SourceEntityWalker {
 public:
   explicit FormatWalker(SourceFile &SF, SourceManager &SM)
   :SF(SF), SM(SM),
-  Tokens(tokenize(Options, SM, SF.getBufferID().getValue())),
   CurrentTokIt(Tokens.begin()),
   SCollector(SM, Tokens, TargetLocation) {}
 
@@ -670,6 +712,7 @@ public:
     Stack.clear();
     TargetLocation = Loc;
     TargetLine = SM.getLineNumber(TargetLocation);
+    tokenizeAround(Loc);
     AtStart = AtEnd = swift::ASTWalker::ParentTy();
     walk(SF);
     scanForComments(SourceLoc());
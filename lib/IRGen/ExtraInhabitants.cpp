@@ -27,7 +27,7 @@ static unsigned getNumLowObjCReservedBits(IRGenModule &IGM) {
   // Get the index of the first non-reserved bit.
   SpareBitVector ObjCMask = IGM.TargetInfo.ObjCPointerReservedBits;
   ObjCMask.flipAll();
-  return ObjCMask.enumerateSetBits().findNext().getValue();
+  return ObjCMask.findFirstSetBit().getValue();
 }
 
 /*****************************************************************************/
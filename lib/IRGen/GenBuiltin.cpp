@@ -20,6 +20,7 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Types.h"
 #include "swift/SIL/SILModule.h"
 
@@ -731,6 +732,13 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      // dispatch_once makes the initialized value visible to every thread
+      // before the predicate is marked done, so a naked load suffices on
+      // Apple platforms. Elsewhere the load has to acquire the
+      // initialization.
+      if (!IGF.IGM.Triple.isOSDarwin() ||
+          IGF.IGM.IRGen.Opts.Sanitize == SanitizerKind::Thread)
+        PredValue->setOrdering(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
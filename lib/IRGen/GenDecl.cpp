@@ -528,6 +528,7 @@ void IRGenModule::emitRuntimeRegistration() {
   // Duck out early if we have nothing to register.
   if (ProtocolConformances.empty()
       && RuntimeResolvableTypes.empty()
+      && PrespecializedMetadata.empty()
       && (!ObjCInterop || (ObjCProtocols.empty() &&
                            ObjCClasses.empty() &&
                            ObjCCategoryDecls.empty())))
@@ -669,6 +670,26 @@ void IRGenModule::emitRuntimeRegistration() {
     RegIGF.Builder.CreateCall(getRegisterTypeMetadataRecordsFn(), {begin, end});
   }
 
+  if (!PrespecializedMetadata.empty()) {
+    llvm::Constant *records = emitPrespecializedMetadataRecords();
+
+    llvm::Constant *beginIndices[] = {
+      llvm::ConstantInt::get(Int32Ty, 0),
+      llvm::ConstantInt::get(Int32Ty, 0),
+    };
+    auto begin = llvm::ConstantExpr::getGetElementPtr(
+        /*Ty=*/nullptr, records, beginIndices);
+    llvm::Constant *endIndices[] = {
+      llvm::ConstantInt::get(Int32Ty, 0),
+      llvm::ConstantInt::get(Int32Ty, PrespecializedMetadata.size()),
+    };
+    auto end = llvm::ConstantExpr::getGetElementPtr(
+        /*Ty=*/nullptr, records, endIndices);
+
+    RegIGF.Builder.CreateCall(getRegisterPrespecializedMetadataFn(),
+                              {begin, end});
+  }
+
   RegIGF.Builder.CreateRetVoid();
 }
 
@@ -736,6 +757,18 @@ void IRGenModule::addRuntimeResolvableType(CanType type) {
   }
 }
 
+/// Build the metadata for the given generic type instantiation statically,
+/// and add it to the list of prespecialized metadata for which runtime
+/// records will be emitted in this translation unit.
+void IRGenModule::addPrespecializedMetadata(CanType type) {
+  for (auto &entry : PrespecializedMetadata)
+    if (entry.first == type)
+      return;
+
+  auto metadata = emitPrespecializedTypeMetadata(*this, type);
+  PrespecializedMetadata.push_back({type, metadata});
+}
+
 void IRGenModule::emitGlobalLists() {
   if (ObjCInterop) {
     assert(TargetInfo.OutputObjectFormat == llvm::Triple::MachO);
@@ -870,6 +903,85 @@ void IRGenerator::emitTypeMetadataRecords() {
   }
 }
 
+void IRGenerator::emitPrespecializedMetadataRecords() {
+  for (auto &m : *this) {
+    m.second->emitPrespecializedMetadataRecords();
+  }
+}
+
+/// Look up a type declaration by name in the module being compiled, then in
+/// the standard library.
+static TypeDecl *lookupTypeToPrespecialize(IRGenModule &IGM, StringRef name) {
+  swift::Module *modules[] = {
+    IGM.getSwiftModule(), IGM.Context.getStdlibModule()
+  };
+  for (auto *M : modules) {
+    if (!M)
+      continue;
+    SmallVector<ValueDecl*, 1> lookup;
+    M->lookupMember(lookup, M, DeclName(IGM.Context.getIdentifier(name)),
+                    Identifier());
+    for (auto decl : lookup)
+      if (auto typeDecl = dyn_cast<TypeDecl>(decl))
+        return typeDecl;
+  }
+  return nullptr;
+}
+
+/// Resolve a name of the form 'Name<Arg, ...>', where each argument names a
+/// non-generic type, to the generic type instantiation it spells.
+static CanType resolveTypeToPrespecialize(IRGenModule &IGM, StringRef name) {
+  size_t open = name.find('<');
+  if (open == StringRef::npos || !name.endswith(">"))
+    return CanType();
+
+  auto typeDecl = dyn_cast_or_null<NominalTypeDecl>(
+                  lookupTypeToPrespecialize(IGM, name.substr(0, open).trim()));
+  if (!typeDecl || !typeDecl->getGenericParams())
+    return CanType();
+
+  SmallVector<StringRef, 2> argNames;
+  name.slice(open + 1, name.size() - 1).split(argNames, ",");
+  if (argNames.size() != typeDecl->getGenericParams()->size())
+    return CanType();
+
+  SmallVector<Type, 2> args;
+  for (auto argName : argNames) {
+    auto argDecl = dyn_cast_or_null<NominalTypeDecl>(
+                               lookupTypeToPrespecialize(IGM, argName.trim()));
+    if (!argDecl || argDecl->isGenericContext())
+      return CanType();
+    args.push_back(argDecl->getDeclaredType());
+  }
+
+  return BoundGenericType::get(typeDecl, Type(), args)->getCanonicalType();
+}
+
+void IRGenerator::emitPrespecializedGenericMetadata() {
+  IRGenModule &PrimaryGM = *getPrimaryIGM();
+  for (auto name : Opts.PrespecializedGenericMetadataNames) {
+    CanType type = resolveTypeToPrespecialize(PrimaryGM, name);
+    if (!type) {
+      PrimaryGM.Context.Diags.diagnose(SourceLoc(),
+                                       diag::type_to_prespecialize_not_found,
+                                       name);
+      continue;
+    }
+
+    // Emit the metadata next to the generic type's own metadata.
+    auto decl = type->getAnyNominal();
+    IRGenModule *IGM = getGenModule(decl->getDeclContext());
+    if (!canPrespecializeTypeMetadata(*IGM, type)) {
+      PrimaryGM.Context.Diags.diagnose(SourceLoc(),
+                                       diag::type_to_prespecialize_unsupported,
+                                       name);
+      continue;
+    }
+
+    IGM->addPrespecializedMetadata(type);
+  }
+}
+
 /// Emit any lazy definitions (of globals or functions or whatever
 /// else) that we require.
 void IRGenerator::emitLazyDefinitions() {
@@ -2162,6 +2274,70 @@ llvm::Constant *IRGenModule::emitTypeMetadataRecords() {
   return var;
 }
 
+/// Emit the records for generic metadata instantiations built statically.
+llvm::Constant *IRGenModule::emitPrespecializedMetadataRecords() {
+  std::string sectionName;
+  switch (TargetInfo.OutputObjectFormat) {
+  case llvm::Triple::MachO:
+    sectionName = "__TEXT, __swift2_prespec, regular, no_dead_strip";
+    break;
+  case llvm::Triple::ELF:
+    sectionName = ".swift2_prespecialized_metadata";
+    break;
+  case llvm::Triple::COFF:
+    sectionName = ".sw2prsp";
+    break;
+  default:
+    llvm_unreachable("Don't know how to emit prespecialized metadata for "
+                     "the selected object format.");
+  }
+
+  // Do nothing if the list is empty.
+  if (PrespecializedMetadata.empty())
+    return nullptr;
+
+  // Define the global variable for the record list.
+  // We have to do this before defining the initializer since the entries will
+  // contain offsets relative to themselves.
+  auto arrayTy = llvm::ArrayType::get(PrespecializedMetadataRecordTy,
+                                      PrespecializedMetadata.size());
+
+  // FIXME: This needs to be a linker-local symbol in order for Darwin ld to
+  // resolve relocations relative to it.
+  auto var = new llvm::GlobalVariable(Module, arrayTy,
+                                      /*isConstant*/ true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      /*initializer*/ nullptr,
+                                      "\x01l_prespecialized_metadata_table");
+
+  SmallVector<llvm::Constant *, 8> elts;
+  for (auto &entry : PrespecializedMetadata) {
+    auto decl = entry.first->getAnyNominal();
+    auto unboundType = decl->getDeclaredType()->getCanonicalType();
+    auto pattern = getAddrOfTypeMetadata(unboundType, /*isPattern*/ true);
+
+    unsigned arrayIdx = elts.size();
+    llvm::Constant *recordFields[] = {
+      emitRelativeReference({pattern, ConstantReference::Direct},
+                            var, { arrayIdx, 0 }),
+      emitRelativeReference({entry.second, ConstantReference::Direct},
+                            var, { arrayIdx, 1 }),
+    };
+
+    auto record = llvm::ConstantStruct::get(PrespecializedMetadataRecordTy,
+                                            recordFields);
+    elts.push_back(record);
+  }
+
+  auto initializer = llvm::ConstantArray::get(arrayTy, elts);
+
+  var->setInitializer(initializer);
+  var->setSection(sectionName);
+  var->setAlignment(getPointerAlignment().getValue());
+  addUsedGlobal(var);
+  return var;
+}
+
 /// Fetch a global reference to a reference to the given Objective-C class.
 /// The result is of type ObjCClassPtrTy->getPointerTo().
 Address IRGenModule::getAddrOfObjCClassRef(ClassDecl *theClass) {
@@ -108,6 +108,7 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/Analysis/CFG.h"
@@ -127,6 +128,11 @@
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumFixedMultiPayloadEnums,
+          "Number of fixed-layout multi-payload enums");
+STATISTIC(NumMultiPayloadEnumsWithExtraTag,
+          "Number of multi-payload enums which need extra tag bits");
+
 SpareBitVector getBitVectorFromAPInt(const APInt &bits, unsigned startBit = 0) {
   if (startBit == 0) {
     return SpareBitVector::fromAPInt(bits);
@@ -4952,12 +4958,42 @@ namespace {
     }
     void copy(IRGenFunction &IGF, Explosion &src,
               Explosion &dest, Atomicity atomicity) const override {
+      if (shouldOutlineValueOperations(IGF.IGM)) {
+        return emitOutlinedCopy(IGF, src, dest, atomicity,
+                                [&](IRGenFunction &helperIGF,
+                                    Explosion &params, Explosion &copy) {
+          Strategy.copy(helperIGF, params, copy, atomicity);
+        });
+      }
       return Strategy.copy(IGF, src, dest, atomicity);
     }
     void consume(IRGenFunction &IGF, Explosion &src,
                  Atomicity atomicity) const override {
+      if (shouldOutlineValueOperations(IGF.IGM)) {
+        return emitOutlinedConsume(IGF, src, atomicity,
+                                   [&](IRGenFunction &helperIGF,
+                                       Explosion &params) {
+          Strategy.consume(helperIGF, params, atomicity);
+        });
+      }
       return Strategy.consume(IGF, src, atomicity);
     }
+
+  private:
+    /// Copies and destroys switch over the cases with non-trivial payloads.
+    bool shouldOutlineValueOperations(IRGenModule &IGM) const {
+      if (isPOD(ResilienceExpansion::Maximal))
+        return false;
+      unsigned numNontrivialPayloads = 0;
+      for (auto &elt : Strategy.getElementsWithPayload())
+        if (!elt.ti->isPOD(ResilienceExpansion::Maximal))
+          ++numNontrivialPayloads;
+      return LoadableTypeInfo::shouldOutlineValueOperations(
+                                                        IGM,
+                                                        numNontrivialPayloads);
+    }
+
+  public:
     void fixLifetime(IRGenFunction &IGF, Explosion &src) const override {
       return Strategy.fixLifetime(IGF, src);
     }
@@ -5368,6 +5404,29 @@ MultiPayloadEnumImplStrategy::completeFixedLayout(TypeConverter &TC,
     ? 0 : numTagBits - commonSpareBitCount;
   NumExtraTagValues = numTags >> commonSpareBitCount;
 
+  ++NumFixedMultiPayloadEnums;
+  if (ExtraTagBitCount > 0) {
+    ++NumMultiPayloadEnumsWithExtraTag;
+
+    // Report which payloads prevent using spare bits for the tag.
+    DEBUG(llvm::dbgs() << "Multi-payload enum ";
+          Type.print(llvm::dbgs());
+          llvm::dbgs() << " needs " << ExtraTagBitCount
+                       << " extra tag bit(s): " << numTags << " tags, "
+                       << commonSpareBitCount << " common spare bit(s)";
+          if (!AllowFixedLayoutOptimizations || TIK < Loadable)
+            llvm::dbgs() << ", spare bits are not used for this layout";
+          llvm::dbgs() << "\n";
+          for (auto &elt : ElementsWithPayload) {
+            SpareBitVector payloadSpareBits;
+            cast<FixedTypeInfo>(*elt.origTI)
+              .applyFixedSpareBitsMask(payloadSpareBits);
+            llvm::dbgs() << "  case " << elt.decl->getName().str() << ": "
+                         << payloadSpareBits.count() << " of "
+                         << payloadSpareBits.size() << " bits spare\n";
+          });
+  }
+
   // Create the type. We need enough bits to store the largest payload plus
   // extra tag bits we need.
   setTaggedEnumBody(TC.IGM, enumTy,
@@ -5822,10 +5881,7 @@ EnumPayload irgen::interleaveSpareBits(IRGenFunction &IGF,
 }
 
 static void setAlignmentBits(SpareBitVector &v, Alignment align) {
-  auto value = align.getValue() >> 1;
-  for (unsigned i = 0; value; ++i, value >>= 1) {
-    v.setBit(i);
-  }
+  v.setBits(0, llvm::Log2_64(align.getValue()));
 }
 
 const SpareBitVector &
@@ -4737,6 +4737,79 @@ static void createInPlaceValueTypeMetadataAccessFunction(IRGenModule &IGM,
   });
 }
 
+namespace {
+  /// An adapter class which turns a value type metadata layout class into a
+  /// builder for the statically built metadata of one instantiation of a
+  /// generic type.
+  ///
+  /// Only instantiations of generic types whose layout does not depend on
+  /// their arguments are supported, so the value witness table and field
+  /// offsets are the ones of the generic type itself; the generic arguments
+  /// are filled in with constant references.
+  template <class Impl, class Base>
+  class PrespecializedMetadataBuilderBase : public Base {
+    typedef Base super;
+
+  protected:
+    using super::IGM;
+    using super::Target;
+    using super::addWord;
+
+    /// The instantiation being built.
+    CanType SpecializedType;
+
+    template <class DeclTy>
+    PrespecializedMetadataBuilderBase(IRGenModule &IGM, DeclTy *theDecl,
+                                      llvm::GlobalVariable *relativeAddressBase,
+                                      CanType specializedType)
+      : super(IGM, theDecl, relativeAddressBase),
+        SpecializedType(specializedType) {}
+
+  public:
+    void addValueWitnessTable() {
+      // The pattern has the same table, since the layout is independent of
+      // the generic arguments.
+      auto unboundType =
+        Target->getDeclaredTypeOfContext()->getCanonicalType();
+      assert(!hasDependentValueWitnessTable(IGM, unboundType));
+      if (auto known = getAddrOfKnownValueWitnessTable(IGM, unboundType))
+        addWord(known);
+      else
+        addWord(IGM.getAddrOfValueWitnessTable(unboundType));
+    }
+
+    void addNominalTypeDescriptor() {
+      // Share the descriptor emitted with the generic type's metadata.
+      auto descriptor = IGM.getAddrOfLLVMVariableOrGOTEquivalent(
+                      LinkEntity::forNominalTypeDescriptor(Target),
+                      IGM.getPointerAlignment(), IGM.NominalTypeDescriptorTy);
+      assert(!descriptor.isIndirect() &&
+             "nominal type descriptor not defined in this module");
+      this->addFarRelativeAddress(descriptor);
+    }
+
+    void addGenericFields(NominalTypeDecl *typeDecl, Type type) {
+      // Lay out the generic requirements for the instantiation rather than
+      // for the type in context.
+      super::addGenericFields(typeDecl, SpecializedType);
+    }
+
+    void addGenericArgument(CanType type) {
+      auto metadata =
+        tryEmitConstantTypeMetadataRef(IGM, type,
+                                       SymbolReferenceKind::Absolute);
+      assert(metadata && "generic argument has no constant metadata");
+      addWord(metadata.getDirectValue());
+    }
+
+    void addGenericWitnessTable(CanType type, ProtocolConformanceRef conf) {
+      auto table = tryEmitConstantWitnessTableRef(IGM, type, conf);
+      assert(table && "conformance has no constant witness table");
+      addWord(table);
+    }
+  };
+}
+
 //===----------------------------------------------------------------------===//
 // Structs
 //===----------------------------------------------------------------------===//
@@ -4916,6 +4989,31 @@ namespace {
   };
 }
 
+namespace {
+  /// A builder for the statically built metadata of a generic struct
+  /// instantiation.
+  class PrespecializedStructMetadataBuilder :
+    public PrespecializedMetadataBuilderBase<PrespecializedStructMetadataBuilder,
+              StructMetadataBuilderBase<PrespecializedStructMetadataBuilder>> {
+    typedef PrespecializedMetadataBuilderBase super;
+
+  public:
+    PrespecializedStructMetadataBuilder(IRGenModule &IGM,
+                                      StructDecl *theStruct,
+                                      llvm::GlobalVariable *relativeAddressBase,
+                                      CanType specializedType)
+      : super(IGM, theStruct, relativeAddressBase, specializedType) {}
+
+    void flagUnfilledParent() {
+      llvm_unreachable("prespecialized metadata has no parent");
+    }
+
+    void flagUnfilledFieldOffset() {
+      llvm_unreachable("prespecialized struct has a dependent layout");
+    }
+  };
+}
+
 /// Emit the type metadata or metadata template for a struct.
 void irgen::emitStructMetadata(IRGenModule &IGM, StructDecl *structDecl) {
   // Set up a dummy global to stand in for the metadata object while we produce
@@ -5106,6 +5204,31 @@ public:
   
 }
 
+namespace {
+  /// A builder for the statically built metadata of a generic enum
+  /// instantiation.
+  class PrespecializedEnumMetadataBuilder :
+    public PrespecializedMetadataBuilderBase<PrespecializedEnumMetadataBuilder,
+              EnumMetadataBuilderBase<PrespecializedEnumMetadataBuilder>> {
+    typedef PrespecializedMetadataBuilderBase super;
+
+  public:
+    PrespecializedEnumMetadataBuilder(IRGenModule &IGM, EnumDecl *theEnum,
+                                      llvm::GlobalVariable *relativeAddressBase,
+                                      CanType specializedType)
+      : super(IGM, theEnum, relativeAddressBase, specializedType) {}
+
+    void addPayloadSize() {
+      auto &strategy = getEnumImplStrategy(IGM, SpecializedType);
+      addConstantWord(strategy.getPayloadSizeForMetadata());
+    }
+
+    void flagUnfilledParent() {
+      llvm_unreachable("prespecialized metadata has no parent");
+    }
+  };
+}
+
 void irgen::emitEnumMetadata(IRGenModule &IGM, EnumDecl *theEnum) {
   // Set up a dummy global to stand in for the metadata object while we produce
   // relative references.
@@ -5143,6 +5266,87 @@ void irgen::emitEnumMetadata(IRGenModule &IGM, EnumDecl *theEnum) {
                          canBeConstant, init, std::move(tempBase));
 }
 
+bool irgen::canPrespecializeTypeMetadata(IRGenModule &IGM, CanType type) {
+  auto boundType = dyn_cast<BoundGenericType>(type);
+  if (!boundType || boundType->getParent())
+    return false;
+
+  NominalTypeDecl *decl = boundType->getDecl();
+  if (!isa<StructDecl>(decl) && !isa<EnumDecl>(decl))
+    return false;
+
+  // The metadata refers to the type's nominal type descriptor with a direct
+  // relative reference, so the type must be emitted in this translation unit.
+  auto &silModule = IGM.getSILModule();
+  if (decl->getModuleContext() != IGM.getSwiftModule() ||
+      !decl->getDeclContext()->isModuleScopeContext() ||
+      (!silModule.isWholeModule() &&
+       decl->getDeclContext()->getParentSourceFile()
+         != silModule.getAssociatedContext()))
+    return false;
+
+  // The value witness table and field offsets come from the generic type.
+  auto unboundType = decl->getDeclaredTypeOfContext()->getCanonicalType();
+  if (hasDependentValueWitnessTable(IGM, unboundType))
+    return false;
+
+  // Every generic requirement must be fulfilled by a constant.
+  bool allConstant = true;
+  GenericTypeRequirements requirements(IGM, decl);
+  auto subs = boundType->getSubstitutions(IGM.getSwiftModule(), nullptr);
+  requirements.enumerateFulfillments(IGM, subs,
+                  [&](unsigned reqtIndex, CanType argType,
+                      Optional<ProtocolConformanceRef> conf) {
+    if (conf) {
+      if (!tryEmitConstantWitnessTableRef(IGM, argType, *conf))
+        allConstant = false;
+    } else {
+      if (!tryEmitConstantTypeMetadataRef(IGM, argType,
+                                          SymbolReferenceKind::Absolute))
+        allConstant = false;
+    }
+  });
+  return allConstant;
+}
+
+llvm::Constant *irgen::emitPrespecializedTypeMetadata(IRGenModule &IGM,
+                                                      CanType type) {
+  assert(canPrespecializeTypeMetadata(IGM, type));
+  auto tempBase = createTemporaryRelativeAddressBase(IGM);
+
+  llvm::Constant *init;
+  NominalTypeDecl *decl = type->getAnyNominal();
+  if (auto theStruct = dyn_cast<StructDecl>(decl)) {
+    PrespecializedStructMetadataBuilder builder(IGM, theStruct, tempBase.get(),
+                                                type);
+    builder.layout();
+    init = builder.getInit();
+  } else {
+    PrespecializedEnumMetadataBuilder builder(IGM, cast<EnumDecl>(decl),
+                                              tempBase.get(), type);
+    builder.layout();
+    init = builder.getInit();
+  }
+
+  // The metadata is only ever handed out by swift_getGenericMetadata, which
+  // may prefer an instantiation registered by another image, so it doesn't
+  // need a public symbol.
+  auto var = new llvm::GlobalVariable(IGM.Module, init->getType(),
+                                      /*isConstant*/ true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      init, "prespecialized_metadata");
+  var->setAlignment(IGM.getPointerAlignment().getValue());
+  replaceTemporaryRelativeAddressBase(IGM, std::move(tempBase), var);
+
+  llvm::Constant *indices[] = {
+    llvm::ConstantInt::get(IGM.Int32Ty, 0),
+    llvm::ConstantInt::get(IGM.Int32Ty, MetadataAdjustmentIndex::ValueType)
+  };
+  auto addressPoint =
+    llvm::ConstantExpr::getInBoundsGetElementPtr(/*Ty=*/nullptr, var, indices);
+  return llvm::ConstantExpr::getBitCast(addressPoint, IGM.TypeMetadataPtrTy);
+}
+
 llvm::Value *IRGenFunction::emitObjCSelectorRefLoad(StringRef selector) {
   llvm::Constant *loadSelRef = IGM.getAddrOfObjCSelectorRef(selector);
   llvm::Value *loadSel =
@@ -131,6 +131,15 @@ namespace irgen {
   /// Emit the metadata associated with the given enum declaration.
   void emitEnumMetadata(IRGenModule &IGM, EnumDecl *theEnum);
 
+  /// Can the metadata for the given instantiation of a generic struct or enum
+  /// be built statically by emitPrespecializedTypeMetadata?
+  bool canPrespecializeTypeMetadata(IRGenModule &IGM, CanType type);
+
+  /// Build the metadata for the given instantiation of a generic struct or
+  /// enum statically, and return its address point.
+  llvm::Constant *emitPrespecializedTypeMetadata(IRGenModule &IGM,
+                                                 CanType type);
+
   /// Get what will be the index into the generic type argument array at the end
   /// of a nominal type's metadata.
   int32_t getIndexOfGenericArgument(IRGenModule &IGM,
@@ -27,6 +27,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "swift/ABI/MetadataValues.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/CanTypeVisitor.h"
 #include "swift/AST/Types.h"
@@ -521,6 +522,25 @@ getProtocolConformanceIndex(CanGenericSignature generics, ModuleDecl &M,
   return (it - conformsTo.begin());
 }
 
+/// Load the base protocol witness table stored at the given index of a
+/// witness table.
+static llvm::Value *emitLoadOfBaseWitnessTable(IRGenFunction &IGF,
+                                               llvm::Value *wtable,
+                                               WitnessIndex index) {
+  llvm::Value *base;
+  if (IGF.IGM.IRGen.Opts.LazyWitnessTableBases) {
+    // The slot may still describe how to derive the base table, so ask the
+    // runtime for it.
+    auto call = IGF.Builder.CreateCall(IGF.IGM.getGetWitnessTableBaseFn(),
+        { wtable, llvm::ConstantInt::get(IGF.IGM.SizeTy, index.getValue()) });
+    call->setDoesNotThrow();
+    base = call;
+  } else {
+    base = emitInvariantLoadOfOpaqueWitness(IGF, wtable, index);
+  }
+  return IGF.Builder.CreateBitCast(base, IGF.IGM.WitnessTablePtrTy);
+}
+
 namespace {
   /// A concrete witness table, together with its known layout.
   class WitnessTable {
@@ -619,11 +639,8 @@ namespace {
 
     /// Apply the path to the given witness table.
     llvm::Value *apply(IRGenFunction &IGF, llvm::Value *wtable) const {
-      for (unsigned i = ReversePath.size(); i != 0; --i) {
-        wtable = emitInvariantLoadOfOpaqueWitness(IGF, wtable,
-                                                  ReversePath[i-1]);
-        wtable = IGF.Builder.CreateBitCast(wtable, IGF.IGM.WitnessTablePtrTy);
-      }
+      for (unsigned i = ReversePath.size(); i != 0; --i)
+        wtable = emitLoadOfBaseWitnessTable(IGF, wtable, ReversePath[i-1]);
       return wtable;
     }
 
@@ -880,6 +897,12 @@ public:
                                           typeMetadataCache);
     }
 
+    // If we already fetched the table in this function, use it.
+    auto kind = LocalTypeDataKind::forConcreteProtocolWitnessTable(
+                     const_cast<NormalProtocolConformance *>(Conformance));
+    if (auto local = IGF.tryGetLocalTypeData(type, kind))
+      return local;
+
     // Otherwise, call a lazy-cache function.
     auto accessor =
       getWitnessTableLazyAccessFunction(IGF.IGM, Conformance, type);
@@ -888,6 +911,9 @@ public:
     call->setDoesNotAccessMemory();
     call->setDoesNotThrow();
 
+    // Save the table for future lookups.
+    IGF.setScopedLocalTypeData(type, kind, call);
+
     return call;
   }
 
@@ -911,6 +937,7 @@ public:
     // Metadata caches are stored at negative offsets.
     unsigned NextCacheIndex = 0;
     bool RequiresSpecialization = false;
+    bool HasLazyBaseConformances = false;
 
   public:
     WitnessTableBuilder(IRGenModule &IGM,
@@ -968,6 +995,12 @@ public:
         return;
       }
 
+      // Otherwise, derive it on first use if we were asked to.
+      if (IGM.IRGen.Opts.LazyWitnessTableBases) {
+        Table.push_back(getLazyBaseWitness(conf));
+        return;
+      }
+
       // Otherwise, we'll need to derive it at instantiation time.
       RequiresSpecialization = true;
       SpecializedBaseConformances.push_back({Table.size(), &conf});
@@ -1075,6 +1108,8 @@ public:
   private:
     llvm::Constant *buildInstantiationFunction();
 
+    llvm::Constant *getLazyBaseWitness(const ConformanceInfo &conf);
+
     llvm::Constant *
     getAssociatedTypeMetadataAccessFunction(AssociatedTypeDecl *requirement,
                                             CanType associatedType);
@@ -1506,6 +1541,67 @@ llvm::Constant *WitnessTableBuilder::buildInstantiationFunction() {
   return fn;
 }
 
+/// Build the tagged reference to a LazyWitnessTableBase stored in a base
+/// protocol slot whose witness table is derived on first use.
+llvm::Constant *
+WitnessTableBuilder::getLazyBaseWitness(const ConformanceInfo &conf) {
+  // The slot is written on first use, so the table must be instantiated
+  // into writable memory even if nothing else requires it.
+  if (!HasLazyBaseConformances) {
+    HasLazyBaseConformances = true;
+    (void) getNextCacheIndex();
+  }
+
+  // Emit the accessor, which derives the base witness table from the
+  // conforming type metadata.
+  auto fnTy = llvm::FunctionType::get(IGM.WitnessTablePtrTy,
+                                      { IGM.TypeMetadataPtrTy },
+                                      /*varargs*/ false);
+  llvm::Function *fn =
+    llvm::Function::Create(fnTy, llvm::GlobalValue::PrivateLinkage,
+                           "get_lazy_base_witness_table", &IGM.Module);
+  fn->setAttributes(IGM.constructInitialAttributes());
+  {
+    IRGenFunction IGF(IGM, fn);
+    if (IGM.DebugInfo)
+      IGM.DebugInfo->emitArtificialFunction(IGF, fn);
+
+    Explosion params = IGF.collectParameters();
+    llvm::Value *metadata = params.claimNext();
+    llvm::Value *baseWTable = conf.getTable(IGF, ConcreteType, &metadata);
+    IGF.Builder.CreateRet(
+      IGF.Builder.CreateBitCast(baseWTable, IGM.WitnessTablePtrTy));
+  }
+
+  // Emit the LazyWitnessTableBase describing the slot. We have to build this
+  // in two phases because it contains relative pointers.
+  auto descriptorTy = llvm::StructType::get(IGM.getLLVMContext(),
+                              { IGM.RelativeAddressTy, IGM.RelativeAddressTy });
+  auto descriptor = new llvm::GlobalVariable(IGM.Module, descriptorTy,
+                                             /*constant*/ true,
+                                             llvm::GlobalValue::PrivateLinkage,
+                                             /*initializer*/ nullptr,
+                                             "lazy_base_witness_table");
+  descriptor->setAlignment(4);
+
+  auto cache =
+    IGM.getAddrOfGenericWitnessTableCache(&Conformance, NotForDefinition);
+  llvm::Constant *descriptorFields[] = {
+    IGM.emitDirectRelativeReference(cache, descriptor, { 0 }),
+    IGM.emitDirectRelativeReference(fn, descriptor, { 1 }),
+  };
+  descriptor->setInitializer(
+    llvm::ConstantStruct::get(descriptorTy, descriptorFields));
+
+  // Tag the reference so the runtime can tell it apart from a witness table.
+  auto tagged = llvm::ConstantExpr::getInBoundsGetElementPtr(
+                   IGM.Int8Ty,
+                   llvm::ConstantExpr::getBitCast(descriptor, IGM.Int8PtrTy),
+                   llvm::ConstantInt::get(IGM.Int32Ty,
+                                          LazyWitnessTableBaseTag));
+  return llvm::ConstantExpr::getBitCast(tagged, IGM.WitnessTablePtrTy);
+}
+
 /// Do a memoized witness-table layout for a protocol.
 const ProtocolInfo &IRGenModule::getProtocolInfo(ProtocolDecl *protocol) {
   return Types.getProtocolInfo(protocol);
@@ -1947,9 +2043,8 @@ llvm::Value *MetadataPath::followComponent(IRGenFunction &IGF,
       auto &pi = IGF.IGM.getProtocolInfo(protocol);
       auto &entry = pi.getWitnessEntry(inheritedProtocol);
       assert(entry.isOutOfLineBase());
-      source = emitInvariantLoadOfOpaqueWitness(IGF, source,
-                                                entry.getOutOfLineBaseIndex());
-      source = IGF.Builder.CreateBitCast(source, IGF.IGM.WitnessTablePtrTy);
+      source = emitLoadOfBaseWitnessTable(IGF, source,
+                                          entry.getOutOfLineBaseIndex());
       setProtocolWitnessTableName(IGF.IGM, source, sourceKey.Type,
                                   inheritedProtocol);
     }
@@ -2141,6 +2236,23 @@ llvm::Value *irgen::emitWitnessTableRef(IRGenFunction &IGF,
   return conformanceI.getTable(IGF, srcType, srcMetadataCache);
 }
 
+llvm::Constant *
+irgen::tryEmitConstantWitnessTableRef(IRGenModule &IGM, CanType srcType,
+                                      ProtocolConformanceRef conformance) {
+  if (conformance.isAbstract())
+    return nullptr;
+
+  auto proto = conformance.getRequirement();
+  auto concreteConformance = conformance.getConcrete();
+  if (concreteConformance->getProtocol() != proto) {
+    concreteConformance = concreteConformance->getInheritedConformance(proto);
+  }
+  auto &protoI = IGM.getProtocolInfo(proto);
+  auto &conformanceI =
+    protoI.getConformance(IGM, proto, concreteConformance);
+  return conformanceI.tryGetConstantTable(IGM, srcType);
+}
+
 /// Emit the witness table references required for the given type
 /// substitution.
 void irgen::emitWitnessTableRefs(IRGenFunction &IGF,
@@ -157,6 +157,12 @@ namespace irgen {
                                    CanType srcType,
                                    ProtocolConformanceRef conformance);
 
+  /// Emit a constant reference to the witness table for a conformance, or
+  /// return null if the table must be instantiated or accessed lazily.
+  llvm::Constant *tryEmitConstantWitnessTableRef(IRGenModule &IGM,
+                                        CanType srcType,
+                                        ProtocolConformanceRef conformance);
+
   /// An entry in a list of known protocols.
   class ProtocolEntry {
     ProtocolDecl *Protocol;
@@ -451,6 +451,29 @@ private:
     }
   }
 
+  bool shouldOutlineValueOperations(IRGenModule &IGM) const {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return false;
+    unsigned numNontrivialFields = 0;
+    for (auto &field : getFields())
+      if (!field.isPOD())
+        ++numNontrivialFields;
+    return LoadableTypeInfo::shouldOutlineValueOperations(IGM,
+                                                          numNontrivialFields);
+  }
+
+  void copyFields(IRGenFunction &IGF, Explosion &src, Explosion &dest) const {
+    for (auto &field : getFields())
+      cast<LoadableTypeInfo>(field.getTypeInfo())
+          .copy(IGF, src, dest, Atomicity::Atomic);
+  }
+
+  void consumeFields(IRGenFunction &IGF, Explosion &src) const {
+    for (auto &field : getFields())
+      cast<LoadableTypeInfo>(field.getTypeInfo())
+          .consume(IGF, src, Atomicity::Atomic);
+  }
+
 public:
   using super::getFields;
 
@@ -485,16 +508,26 @@ public:
 
   void copy(IRGenFunction &IGF, Explosion &src,
             Explosion &dest, Atomicity atomicity) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo())
-          .copy(IGF, src, dest, Atomicity::Atomic);
+    if (shouldOutlineValueOperations(IGF.IGM)) {
+      return this->emitOutlinedCopy(IGF, src, dest, atomicity,
+                                    [&](IRGenFunction &helperIGF,
+                                        Explosion &params, Explosion &copy) {
+        copyFields(helperIGF, params, copy);
+      });
+    }
+    copyFields(IGF, src, dest);
   }
 
   void consume(IRGenFunction &IGF, Explosion &src,
                Atomicity atomicity) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo())
-          .consume(IGF, src, Atomicity::Atomic);
+    if (shouldOutlineValueOperations(IGF.IGM)) {
+      return this->emitOutlinedConsume(IGF, src, atomicity,
+                                       [&](IRGenFunction &helperIGF,
+                                           Explosion &params) {
+        consumeFields(helperIGF, params);
+      });
+    }
+    consumeFields(IGF, src);
   }
 
   void fixLifetime(IRGenFunction &IGF, Explosion &src) const override {
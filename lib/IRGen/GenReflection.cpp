@@ -235,13 +235,18 @@ class AssociatedTypeMetadataBuilder : public ReflectionMetadataBuilder {
       return false;
     };
 
+    Conformance->forEachTypeWitness(/*resolver*/ nullptr, collectTypeWitness);
+
+    // A record for a conformance without associated types doesn't tell
+    // reflection anything, so don't spend the descriptor and typeref strings.
+    if (AssociatedTypes.empty())
+      return;
+
     addTypeRef(ModuleContext, ConformingType);
 
     auto ProtoTy = Conformance->getProtocol()->getDeclaredType();
     addTypeRef(ModuleContext, ProtoTy->getCanonicalType());
 
-    Conformance->forEachTypeWitness(/*resolver*/ nullptr, collectTypeWitness);
-
     addConstantInt32(AssociatedTypes.size());
     addConstantInt32(AssociatedTypeRecordSize);
 
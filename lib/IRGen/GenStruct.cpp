@@ -565,8 +565,12 @@ namespace {
     }
 
     StructLayout performLayout(ArrayRef<const TypeInfo *> fieldTypes) {
+      auto strategy = LayoutStrategy::Optimal;
+      if (auto decl = TheStruct->getStructOrBoundGenericStruct())
+        if (mayReorderStructFields(IGM, decl))
+          strategy = LayoutStrategy::MinimizePadding;
       return StructLayout(IGM, TheStruct, LayoutKind::NonHeapObject,
-                          LayoutStrategy::Optimal, fieldTypes, StructTy);
+                          strategy, fieldTypes, StructTy);
     }
   };
 
@@ -821,6 +825,23 @@ llvm::Constant *irgen::emitPhysicalStructMemberFixedOffset(IRGenModule &IGM,
   FOR_STRUCT_IMPL(IGM, baseType, getConstantFieldOffset, field);
 }
 
+bool irgen::mayReorderStructFields(IRGenModule &IGM, StructDecl *decl) {
+  if (!IGM.IRGen.Opts.ReorderStructFields)
+    return false;
+
+  // Imported and generic structs are laid out by other rules.
+  if (decl->hasClangNode() || decl->isGenericContext())
+    return false;
+
+  // Other modules must not depend on the layout: neither directly nor by
+  // inlining serialized function bodies which access the struct.
+  auto *module = decl->getModuleContext();
+  if (module != IGM.getSwiftModule() ||
+      module->getResilienceStrategy() == ResilienceStrategy::Fragile)
+    return false;
+  return decl->getEffectiveAccess() != Accessibility::Public;
+}
+
 MemberAccessStrategy
 irgen::getPhysicalStructMemberAccessStrategy(IRGenModule &IGM,
                                              SILType baseType, VarDecl *field) {
@@ -24,6 +24,7 @@ namespace llvm {
 namespace swift {
   class CanType;
   class SILType;
+  class StructDecl;
   class VarDecl;
 
 namespace irgen {
@@ -49,6 +50,12 @@ namespace irgen {
                                                       SILType baseType,
                                                       VarDecl *field);
 
+  /// Return true if the stored properties of the given struct may be laid
+  /// out in a different order than they are declared in, to minimize
+  /// padding. This is only done for structs whose layout is not visible
+  /// outside of the module, with -enable-struct-field-reordering.
+  bool mayReorderStructFields(IRGenModule &IGM, StructDecl *decl);
+
   /// Return a strategy for accessing the given stored struct property.
   ///
   /// This API is used by RemoteAST.
@@ -14,6 +14,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "irgen-outlining"
 #include "swift/AST/CanTypeVisitor.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/IRGenOptions.h"
@@ -22,6 +23,7 @@
 #include "swift/SIL/SILModule.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "clang/CodeGen/SwiftCallingConv.h"
 
@@ -30,6 +32,7 @@
 #include "GenMeta.h"
 #include "GenProto.h"
 #include "GenType.h"
+#include "IRGenDebugInfo.h"
 #include "IRGenFunction.h"
 #include "IRGenModule.h"
 #include "Address.h"
@@ -154,6 +157,134 @@ void LoadableTypeInfo::addScalarToAggLowering(IRGenModule &IGM,
   lowering.addTypedData(type, offset.asCharUnits(), storageSize.asCharUnits());
 }
 
+STATISTIC(NumOutlinedValueOperations,
+          "Number of copies and destroys emitted as calls to a helper");
+STATISTIC(NumOutlinedValueOperationHelpers,
+          "Number of helper functions for outlined copies and destroys");
+
+bool LoadableTypeInfo::shouldOutlineValueOperations(
+                                                IRGenModule &IGM,
+                                                unsigned numNontrivialParts) {
+  unsigned limit = IGM.IRGen.Opts.OutlineValueOperationsLimit;
+  return limit != 0 && numNontrivialParts >= limit;
+}
+
+/// Get or create the private helper function which performs an outlined copy
+/// (if \p isCopy) or consume of the values of type \p TI.
+static llvm::Function *
+getOrCreateOutlinedValueOperation(IRGenModule &IGM, const TypeInfo &TI,
+                                  bool isCopy, Atomicity atomicity,
+                                  ArrayRef<llvm::Value *> values,
+                                  llvm::Type *resultTy,
+                    llvm::function_ref<void(IRGenFunction &IGF,
+                                            Explosion &params)> generate) {
+  unsigned kind = (unsigned(isCopy) << 1) |
+                  unsigned(atomicity == Atomicity::Atomic);
+  auto key = std::make_pair(&TI, kind);
+  auto found = IGM.OutlinedValueOperations.find(key);
+  if (found != IGM.OutlinedValueOperations.end())
+    return found->second;
+
+  SmallVector<llvm::Type *, 8> paramTys;
+  for (auto value : values)
+    paramTys.push_back(value->getType());
+  auto fnTy = llvm::FunctionType::get(resultTy, paramTys, false);
+  auto fn = llvm::Function::Create(fnTy, llvm::GlobalValue::PrivateLinkage,
+                                   isCopy ? "__swift_outlined_copy"
+                                          : "__swift_outlined_consume",
+                                   &IGM.Module);
+  fn->setCallingConv(IGM.DefaultCC);
+  fn->setDoesNotThrow();
+  // The point is to have a single copy of the code.
+  fn->addFnAttr(llvm::Attribute::NoInline);
+
+  // Register the helper before emitting its body, which may outline the
+  // operations of the field types in turn.
+  IGM.OutlinedValueOperations.insert({key, fn});
+  ++NumOutlinedValueOperationHelpers;
+
+  IRGenFunction IGF(IGM, fn);
+  if (IGM.DebugInfo)
+    IGM.DebugInfo->emitArtificialFunction(IGF, fn);
+  Explosion params = IGF.collectParameters();
+  generate(IGF, params);
+  return fn;
+}
+
+void LoadableTypeInfo::emitOutlinedCopy(IRGenFunction &IGF,
+                                        Explosion &src, Explosion &dest,
+                                        Atomicity atomicity,
+                    llvm::function_ref<void(IRGenFunction &IGF,
+                                            Explosion &src,
+                                            Explosion &dest)> emitInlineCopy)
+                                        const {
+  SmallVector<llvm::Value *, 8> values;
+  for (auto value : src.claim(getExplosionSize()))
+    values.push_back(value);
+
+  // The copy has the same schema as the original: a single value is returned
+  // directly, more values are returned as a struct.
+  llvm::Type *resultTy;
+  if (values.size() == 1) {
+    resultTy = values[0]->getType();
+  } else {
+    SmallVector<llvm::Type *, 8> elementTys;
+    for (auto value : values)
+      elementTys.push_back(value->getType());
+    resultTy = llvm::StructType::get(IGF.IGM.getLLVMContext(), elementTys);
+  }
+
+  auto fn = getOrCreateOutlinedValueOperation(IGF.IGM, *this, /*copy*/ true,
+                                              atomicity, values, resultTy,
+                                   [&](IRGenFunction &helperIGF,
+                                       Explosion &params) {
+    Explosion copy;
+    emitInlineCopy(helperIGF, params, copy);
+    if (copy.size() == 1) {
+      helperIGF.Builder.CreateRet(copy.claimNext());
+      return;
+    }
+    llvm::Value *result = llvm::UndefValue::get(resultTy);
+    for (unsigned i = 0, e = copy.size(); i != e; ++i)
+      result = helperIGF.Builder.CreateInsertValue(result, copy.claimNext(), i);
+    helperIGF.Builder.CreateRet(result);
+  });
+
+  auto call = IGF.Builder.CreateCall(fn, values);
+  call->setDoesNotThrow();
+  ++NumOutlinedValueOperations;
+
+  if (values.size() == 1) {
+    dest.add(call);
+    return;
+  }
+  for (unsigned i = 0, e = values.size(); i != e; ++i)
+    dest.add(IGF.Builder.CreateExtractValue(call, i));
+}
+
+void LoadableTypeInfo::emitOutlinedConsume(IRGenFunction &IGF,
+                                           Explosion &src,
+                                           Atomicity atomicity,
+                    llvm::function_ref<void(IRGenFunction &IGF,
+                                            Explosion &src)> emitInlineConsume)
+                                           const {
+  SmallVector<llvm::Value *, 8> values;
+  for (auto value : src.claim(getExplosionSize()))
+    values.push_back(value);
+
+  auto fn = getOrCreateOutlinedValueOperation(IGF.IGM, *this, /*copy*/ false,
+                                              atomicity, values, IGF.IGM.VoidTy,
+                                   [&](IRGenFunction &helperIGF,
+                                       Explosion &params) {
+    emitInlineConsume(helperIGF, params);
+    helperIGF.Builder.CreateRetVoid();
+  });
+
+  auto call = IGF.Builder.CreateCall(fn, values);
+  call->setDoesNotThrow();
+  ++NumOutlinedValueOperations;
+}
+
 static llvm::Constant *asSizeConstant(IRGenModule &IGM, Size size) {
   return llvm::ConstantInt::get(IGM.SizeTy, size.getValue());
 }
@@ -619,9 +750,7 @@ TypeConverter::createPrimitiveForAlignedPointer(llvm::PointerType *type,
                                                 Alignment align,
                                                 Alignment pointerAlignment) {
   SpareBitVector spareBits = IGM.TargetInfo.PointerSpareBits;
-  for (unsigned bit = 0; Alignment(1 << bit) != pointerAlignment; ++bit) {
-    spareBits.setBit(bit);
-  }
+  spareBits.setBits(0, llvm::Log2_64(pointerAlignment.getValue()));
 
   return new PrimitiveTypeInfo(type, size, std::move(spareBits), align);
 }
@@ -25,6 +25,7 @@
 #include "swift/AST/Types.h"
 #include "swift/SIL/TypeLowering.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
@@ -41,9 +42,14 @@
 
 #include "GenValueWitness.h"
 
+#define DEBUG_TYPE "value-witness"
+
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumSharedValueWitnessTables,
+          "Number of value witness tables shared with the runtime");
+
 const char *irgen::getValueWitnessName(ValueWitness witness) {
   switch (witness) {
 #define CASE(NAME) case ValueWitness::NAME: return #NAME;
@@ -1358,6 +1364,48 @@ static void addValueWitnessesForAbstractType(IRGenModule &IGM,
                     concreteLoweredType, concreteTI, witnesses);
 }
 
+llvm::Constant *irgen::getAddrOfKnownValueWitnessTable(IRGenModule &IGM,
+                                                       CanType abstractType) {
+  // Enums have additional witnesses for their tag manipulation.
+  auto concreteFormalType = getFormalTypeInContext(abstractType);
+  if (concreteFormalType.getEnumOrBoundGenericEnum())
+    return nullptr;
+
+  auto &ti = IGM.getTypeInfo(IGM.getLoweredType(concreteFormalType));
+  auto *fixedTI = dyn_cast<FixedTypeInfo>(&ti);
+  if (!fixedTI)
+    return nullptr;
+
+  // The witnesses of a POD type without extra inhabitants only depend on its
+  // size and alignment. Those of the common layouts are exported from the
+  // runtime, see also emitFixedTypeLayout.
+  if (!fixedTI->isPOD(ResilienceExpansion::Maximal) ||
+      !fixedTI->isBitwiseTakable(ResilienceExpansion::Maximal) ||
+      fixedTI->mayHaveExtraInhabitants(IGM))
+    return nullptr;
+
+  auto &C = IGM.Context;
+  unsigned size = fixedTI->getFixedSize().getValue();
+  unsigned align = fixedTI->getFixedAlignment().getValue();
+  if (size == 0)
+    return IGM.getAddrOfValueWitnessTable(C.TheEmptyTupleType);
+
+  if (size != align)
+    return nullptr;
+  switch (size) {
+  case 1:
+  case 2:
+  case 4:
+  case 8:
+  case 16:
+  case 32:
+    return IGM.getAddrOfValueWitnessTable(
+        BuiltinIntegerType::get(size * 8, C)->getCanonicalType());
+  default:
+    return nullptr;
+  }
+}
+
 /// Emit a value-witness table for the given type, which is assumed to
 /// be non-dependent.
 llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
@@ -1366,6 +1414,12 @@ llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
   assert(!isa<BoundGenericType>(abstractType) &&
          "emitting VWT for generic instance");
 
+  // Reuse a table from the runtime if the type has a common POD layout.
+  if (auto known = getAddrOfKnownValueWitnessTable(IGM, abstractType)) {
+    ++NumSharedValueWitnessTables;
+    return llvm::ConstantExpr::getBitCast(known, IGM.WitnessTablePtrTy);
+  }
+
   SmallVector<llvm::Constant*, MaxNumValueWitnesses> witnesses;
   bool canBeConstant = false;
   addValueWitnessesForAbstractType(IGM, abstractType, witnesses, canBeConstant);
@@ -1542,11 +1596,33 @@ Address TypeInfo::indexArray(IRGenFunction &IGF, Address base,
   }
 }
 
+/// Emit a call to swift_retainArray or swift_releaseArray on the elements of
+/// an array.
+static void emitNativeArrayRefCountCall(IRGenFunction &IGF,
+                                        const TypeInfo &type,
+                                        llvm::Constant *fn, Address array,
+                                        llvm::Value *count, SILType T) {
+  auto &IGM = IGF.IGM;
+  llvm::Value *refs = IGF.Builder.CreateBitCast(array.getAddress(),
+                                          IGM.RefCountedPtrTy->getPointerTo());
+  llvm::Value *stride = type.getStride(IGF, T);
+  llvm::CallInst *call = IGF.Builder.CreateCall(fn, {refs, count, stride});
+  call->setCallingConv(IGM.DefaultCC);
+  call->setDoesNotThrow();
+}
+
 void TypeInfo::destroyArray(IRGenFunction &IGF, Address array,
                             llvm::Value *count, SILType T) const {
   if (isPOD(ResilienceExpansion::Maximal))
     return;
 
+  if (isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
+    emitNativeArrayRefCountCall(IGF, *this,
+                                IGF.IGM.getNativeStrongReleaseArrayFn(),
+                                array, count, T);
+    return;
+  }
+
   auto entry = IGF.Builder.GetInsertBlock();
   auto iter = IGF.createBasicBlock("iter");
   auto loop = IGF.createBasicBlock("loop");
@@ -1693,6 +1769,18 @@ void TypeInfo::initializeArrayWithCopy(IRGenFunction &IGF,
     return;
   }
 
+  // Copy the references and then retain them all at once.
+  if (isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal)) {
+    llvm::Value *stride = getStride(IGF, T);
+    llvm::Value *byteCount = IGF.Builder.CreateNUWMul(stride, count);
+    IGF.Builder.CreateMemCpy(dest.getAddress(), src.getAddress(),
+                             byteCount, dest.getAlignment().getValue());
+    emitNativeArrayRefCountCall(IGF, *this,
+                                IGF.IGM.getNativeStrongRetainArrayFn(),
+                                dest, count, T);
+    return;
+  }
+
   emitInitializeArrayFrontToBack(IGF, *this, dest, src, count, T, IsNotTake);
 }
 
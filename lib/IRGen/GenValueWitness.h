@@ -36,8 +36,16 @@ namespace irgen {
   /// dependent on its generic parameters.
   bool hasDependentValueWitnessTable(IRGenModule &IGM, CanType ty);
 
+  /// Returns the value witness table exported from the runtime which can be
+  /// used for the given non-dependent type, or null if the type needs its own
+  /// table. This is the case for POD types with a common size and alignment
+  /// and without extra inhabitants.
+  llvm::Constant *getAddrOfKnownValueWitnessTable(IRGenModule &IGM,
+                                                  CanType abstractType);
+
   /// Emit a value-witness table for the given type, which is assumed
-  /// to be non-dependent.
+  /// to be non-dependent. If possible, a table exported from the runtime is
+  /// returned instead.
   llvm::Constant *emitValueWitnessTable(IRGenModule &IGM, CanType type);
 
   /// Emit the elements of a dependent value witness table template into a
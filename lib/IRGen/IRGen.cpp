@@ -542,6 +542,19 @@ static void initLLVMModule(const IRGenModule &IGM) {
   Module->setDataLayout(IGM.DataLayout.getStringRepresentation());
 }
 
+/// Frees the instructions of every SIL function in \p SILMod, if \p Opts
+/// allow it, once all of them have been emitted as LLVM IR.
+static void releaseSILBodies(const IRGenOptions &Opts, SILModule &SILMod) {
+  if (!Opts.ReleaseSILBodies)
+    return;
+
+  // Drop all references first, since the functions may reference each other.
+  for (SILFunction &F : SILMod)
+    F.dropAllReferences();
+  for (SILFunction &F : SILMod)
+    F.getBlocks().clear();
+}
+
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
 static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
@@ -586,6 +599,9 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
       }
     }
 
+    // Build any generic metadata instantiations we were asked to.
+    irgen.emitPrespecializedGenericMetadata();
+
     // Register our info with the runtime if needed.
     if (Opts.UseJIT) {
       IGM.emitRuntimeRegistration();
@@ -594,6 +610,7 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
       // In JIT mode these are manually registered above.
       IGM.emitProtocolConformances();
       IGM.emitTypeMetadataRecords();
+      IGM.emitPrespecializedMetadataRecords();
       IGM.emitBuiltinReflectionMetadata();
     }
 
@@ -637,6 +654,8 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  releaseSILBodies(Opts, *SILMod);
+
   embedBitcode(IGM.getModule(), Opts);
 
   if (performLLVM(Opts, IGM.Context.Diags, nullptr, IGM.ModuleHash,
@@ -732,8 +751,15 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   }
 
   // Emit the module contents.
+  // Note that this is done on a single thread, even though each IGM has its
+  // own LLVMContext. Lowering a SILFunction is not thread-safe: it populates
+  // the type lowering caches of the SILModule and the type info caches of the
+  // ASTContext, uses the clang code generator and debug info builder of the
+  // IGM, which reference AST types, and enqueues lazy metadata and function
+  // definitions in the shared IRGenerator. Only the LLVM passes below are
+  // distributed over the threads.
   irgen.emitGlobalTopLevel();
-  
+
   for (auto *File : M->getFiles()) {
     if (SourceFile *SF = dyn_cast<SourceFile>(File)) {
       IRGenModule *IGM = irgen.getGenModule(SF);
@@ -749,6 +775,9 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
 
   irgen.emitProtocolConformances();
 
+  irgen.emitPrespecializedGenericMetadata();
+  irgen.emitPrespecializedMetadataRecords();
+
   // Okay, emit any definitions that we suddenly need.
   irgen.emitLazyDefinitions();
   
@@ -831,6 +860,8 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  releaseSILBodies(Opts, *SILMod);
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -17,6 +17,7 @@
 #define DEBUG_TYPE "debug-info"
 #include "IRGenDebugInfo.h"
 #include "GenOpaque.h"
+#include "GenStruct.h"
 #include "GenType.h"
 #include "Linking.h"
 #include "swift/AST/Expr.h"
@@ -1055,17 +1056,32 @@ IRGenDebugInfo::getStructMembers(NominalTypeDecl *D, Type BaseTy,
                                  unsigned Flags, unsigned &SizeInBits) {
   SmallVector<llvm::Metadata *, 16> Elements;
   unsigned OffsetInBits = 0;
+  unsigned EndInBits = 0;
+
+  // The fields of some structs are not laid out in declaration order. Use
+  // their physical offsets instead of accumulating the field sizes.
+  auto *SD = dyn_cast<StructDecl>(D);
+  bool IsReordered = SD && mayReorderStructFields(IGM, SD);
+  unsigned SizeOfByte = CI.getTargetInfo().getCharWidth();
+
   for (VarDecl *VD : D->getStoredProperties()) {
     auto memberTy =
         BaseTy->getTypeOfMember(IGM.getSwiftModule(), VD, nullptr);
     DebugTypeInfo DbgTy(VD, IGM.getTypeInfoForUnlowered(
                                 IGM.getSILTypes().getAbstractionPattern(VD),
                                 memberTy));
+    if (IsReordered) {
+      auto *Offset = emitPhysicalStructMemberFixedOffset(
+          IGM, IGM.getLoweredType(BaseTy), VD);
+      if (auto *OffsetInt = dyn_cast_or_null<llvm::ConstantInt>(Offset))
+        OffsetInBits = SizeOfByte * OffsetInt->getZExtValue();
+    }
     Elements.push_back(createMemberType(DbgTy, VD->getName().str(),
                                         OffsetInBits, Scope, File, Flags));
+    EndInBits = std::max(EndInBits, OffsetInBits);
   }
-  if (OffsetInBits > SizeInBits)
-    SizeInBits = OffsetInBits;
+  if (EndInBits > SizeInBits)
+    SizeInBits = EndInBits;
   return DBuilder.getOrCreateArray(Elements);
 }
 
@@ -1737,6 +1753,9 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
     UID = llvm::MDString::get(IGM.getLLVMContext(), MangledName);
     if (llvm::Metadata *CachedTy = DIRefMap.lookup(UID)) {
       auto DITy = cast<llvm::DIType>(CachedTy);
+      // Remember the type for this TypeBase*, so that we don't need to mangle
+      // it again for the next lookup.
+      DITypeCache[DbgTy.getType()] = llvm::TrackingMDNodeRef(DITy);
       return DITy;
     }
   }
@@ -1769,8 +1788,8 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
     }
   }
 
-  // Store it in the cache.
-  DITypeCache.insert({DbgTy.getType(), llvm::TrackingMDNodeRef(DITy)});
+  // Store it in the cache. This replaces an entry whose node was deleted.
+  DITypeCache[DbgTy.getType()] = llvm::TrackingMDNodeRef(DITy);
 
   return DITy;
 }
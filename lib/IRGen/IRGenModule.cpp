@@ -265,7 +265,12 @@ IRGenModule::IRGenModule(IRGenerator &irgen,
   FullBoxMetadataPtrTy = FullBoxMetadataStructTy->getPointerTo(DefaultAS);
 
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  llvm::Type *refCountedElts[] = { TypeMetadataPtrTy, Int32Ty, Int32Ty,
+                                   Int32Ty, Int32Ty };
+#else
   llvm::Type *refCountedElts[] = { TypeMetadataPtrTy, Int32Ty, Int32Ty };
+#endif
   RefCountedStructTy->setBody(refCountedElts);
 
   PtrSize = Size(DataLayout.getPointerSize(DefaultAS));
@@ -301,6 +306,14 @@ IRGenModule::IRGenModule(IRGenerator &irgen,
   TypeMetadataRecordPtrTy
     = TypeMetadataRecordTy->getPointerTo(DefaultAS);
 
+  PrespecializedMetadataRecordTy
+    = createStructType(*this, "swift.prespecialized_metadata_record", {
+      RelativeAddressTy,
+      RelativeAddressTy
+    });
+  PrespecializedMetadataRecordPtrTy
+    = PrespecializedMetadataRecordTy->getPointerTo(DefaultAS);
+
   FieldDescriptorTy
     = llvm::StructType::create(LLVMContext, "swift.field_descriptor");
   FieldDescriptorPtrTy = FieldDescriptorTy->getPointerTo(DefaultAS);
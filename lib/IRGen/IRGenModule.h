@@ -270,6 +270,13 @@ public:
   /// Emit type metadata records for types without explicit protocol conformance.
   void emitTypeMetadataRecords();
 
+  /// Emit the generic metadata instantiations requested with
+  /// -prespecialize-generic-metadata.
+  void emitPrespecializedGenericMetadata();
+
+  /// Emit the prespecialized metadata records needed by each IR module.
+  void emitPrespecializedMetadataRecords();
+
   /// Emit everything which is reachable from already emitted IR.
   void emitLazyDefinitions();
   
@@ -437,6 +444,8 @@ public:
   llvm::PointerType *NominalTypeDescriptorPtrTy;
   llvm::StructType *TypeMetadataRecordTy;
   llvm::PointerType *TypeMetadataRecordPtrTy;
+  llvm::StructType *PrespecializedMetadataRecordTy;
+  llvm::PointerType *PrespecializedMetadataRecordPtrTy;
   llvm::StructType *FieldDescriptorTy;
   llvm::PointerType *FieldDescriptorPtrTy;
   llvm::PointerType *ErrorPtrTy;       /// %swift.error*
@@ -618,6 +627,8 @@ public:
                                 llvm::Function *fn);
   llvm::Constant *emitProtocolConformances();
   llvm::Constant *emitTypeMetadataRecords();
+  void addPrespecializedMetadata(CanType type);
+  llvm::Constant *emitPrespecializedMetadataRecords();
   void emitReflectionMetadata(const NominalTypeDecl *Decl);
   void emitAssociatedTypeMetadataRecord(const NominalTypeDecl *Decl);
   void emitAssociatedTypeMetadataRecord(const ExtensionDecl *Ext);
@@ -642,6 +653,11 @@ public:
                                             ArrayRef<llvm::Type*> paramTypes,
                         llvm::function_ref<void(IRGenFunction &IGF)> generate);
 
+  /// The helper functions for outlined copies and destroys of loadable
+  /// types, keyed by the type and the kind of operation.
+  llvm::DenseMap<std::pair<const TypeInfo *, unsigned>, llvm::Function *>
+    OutlinedValueOperations;
+
 private:
   llvm::Constant *getAddrOfClangGlobalDecl(clang::GlobalDecl global,
                                            ForDefinition_t forDefinition);
@@ -691,6 +707,9 @@ private:
   SmallVector<NormalProtocolConformance *, 4> ProtocolConformances;
   /// List of nominal types to generate type metadata records for.
   SmallVector<CanType, 4> RuntimeResolvableTypes;
+  /// List of generic type instantiations whose metadata was built
+  /// statically, and the address points of that metadata.
+  SmallVector<std::pair<CanType, llvm::Constant *>, 4> PrespecializedMetadata;
   /// Builtin types referenced by types in this module when emitting
   /// reflection metadata.
   llvm::SetVector<CanType> BuiltinTypes;
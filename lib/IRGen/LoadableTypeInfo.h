@@ -20,6 +20,7 @@
 #define SWIFT_IRGEN_LOADABLETYPEINFO_H
 
 #include "FixedTypeInfo.h"
+#include "llvm/ADT/STLExtras.h"
 
 namespace clang {
 namespace CodeGen {
@@ -75,6 +76,29 @@ protected:
     assert(isLoadable());
   }
 
+  /// Whether copies and destroys of a type with the given number of fields
+  /// or payload cases which are not POD should be outlined.
+  static bool shouldOutlineValueOperations(IRGenModule &IGM,
+                                           unsigned numNontrivialParts);
+
+  /// Copy the values of this type by calling a helper function which is
+  /// shared by all copies in the module. The body of the helper is emitted
+  /// by \p emitInlineCopy when it is first needed.
+  void emitOutlinedCopy(IRGenFunction &IGF, Explosion &src, Explosion &dest,
+                        Atomicity atomicity,
+                        llvm::function_ref<void(IRGenFunction &IGF,
+                                                Explosion &src,
+                                                Explosion &dest)>
+                          emitInlineCopy) const;
+
+  /// Consume the values of this type by calling a helper function which is
+  /// shared by all destroys in the module.
+  void emitOutlinedConsume(IRGenFunction &IGF, Explosion &src,
+                           Atomicity atomicity,
+                           llvm::function_ref<void(IRGenFunction &IGF,
+                                                   Explosion &src)>
+                             emitInlineConsume) const;
+
 public:
   // This is useful for metaprogramming.
   static bool isLoadable() { return true; }
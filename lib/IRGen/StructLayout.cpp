@@ -40,7 +40,13 @@ static bool requiresHeapHeader(LayoutKind kind) {
 
 /// Return the size of the standard heap header.
 Size irgen::getHeapHeaderSize(IRGenModule &IGM) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // The runtime keeps an owning thread and a biased reference count after
+  // the strong and weak reference counts.
+  return IGM.getPointerSize() + Size(16);
+#else
   return IGM.getPointerSize() + Size(8);
+#endif
 }
 
 /// Add the fields for the standard heap header to the given layout.
@@ -199,14 +205,60 @@ void StructLayoutBuilder::addHeapHeader() {
   StructFields.push_back(IGM.RefCountedStructTy);
 }
 
+/// Compute the size of a layout of fixed-size elements in the given order,
+/// starting at \p size.
+static Size getSizeOfFixedLayout(ArrayRef<ElementLayout> elts,
+                                 ArrayRef<unsigned> order, Size size) {
+  for (unsigned index : order) {
+    auto &eltTI = cast<FixedTypeInfo>(elts[index].getType());
+    size = size.roundUpToAlignment(eltTI.getFixedAlignment());
+    size += eltTI.getFixedSize();
+  }
+  return size;
+}
+
+/// Compute the order in which the elements are added to the layout.
+///
+/// With the MinimizePadding strategy, the elements after the first one are
+/// sorted by decreasing alignment, if all elements have a fixed size and this
+/// results in a smaller layout. The first element stays at the start, because
+/// the extra inhabitants of a struct are taken from its first field.
+static void computeElementOrder(ArrayRef<ElementLayout> elts,
+                                LayoutStrategy strategy, Size startSize,
+                                SmallVectorImpl<unsigned> &order) {
+  for (unsigned i = 0, e = elts.size(); i != e; ++i)
+    order.push_back(i);
+
+  if (strategy != LayoutStrategy::MinimizePadding || elts.size() < 3)
+    return;
+  for (auto &elt : elts)
+    if (!isa<FixedTypeInfo>(elt.getType()))
+      return;
+
+  SmallVector<unsigned, 8> sorted(order.begin(), order.end());
+  std::stable_sort(sorted.begin() + 1, sorted.end(),
+                   [&](unsigned lhs, unsigned rhs) {
+    return cast<FixedTypeInfo>(elts[lhs].getType()).getFixedAlignment() >
+           cast<FixedTypeInfo>(elts[rhs].getType()).getFixedAlignment();
+  });
+
+  if (getSizeOfFixedLayout(elts, sorted, startSize) <
+      getSizeOfFixedLayout(elts, order, startSize))
+    order.swap(sorted);
+}
+
 bool StructLayoutBuilder::addFields(llvm::MutableArrayRef<ElementLayout> elts,
                                     LayoutStrategy strategy) {
   // Track whether we've added any storage to our layout.
   bool addedStorage = false;
 
+  SmallVector<unsigned, 8> order;
+  computeElementOrder(elts, strategy, CurSize, order);
+
   // Loop through the elements.  The only valid field in each element
   // is Type; StructIndex and ByteOffset need to be laid out.
-  for (auto &elt : elts) {
+  for (unsigned index : order) {
+    auto &elt = elts[index];
     auto &eltTI = elt.getType();
     IsKnownPOD &= eltTI.isPOD(ResilienceExpansion::Maximal);
     IsKnownBitwiseTakable &= eltTI.isBitwiseTakable(ResilienceExpansion::Maximal);
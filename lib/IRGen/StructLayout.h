@@ -44,7 +44,12 @@ enum class LayoutStrategy {
   Optimal,
 
   /// The 'universal' strategy: all modules must agree on the layout.
-  Universal
+  Universal,
+
+  /// Like Optimal, but fixed-size fields after the first one may be laid out
+  /// in a different order than they are given in, if that reduces padding.
+  /// The layouts of the elements are still parallel to the given fields.
+  MinimizePadding
 };
 
 /// The kind of object being laid out.
@@ -134,10 +134,10 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
+  // -1 as ABI for the "done" value. The runtime's own implementation, used on
+  // Linux and FreeBSD, uses the same value.
+  if (triple.isOSDarwin() || triple.isOSLinux() || triple.isOSFreeBSD())
     target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
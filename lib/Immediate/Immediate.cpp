@@ -27,16 +27,23 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Timer.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
 
 #include <dlfcn.h>
 
@@ -277,9 +284,77 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+namespace {
+/// Keeps the object code MCJIT compiles for a module in a directory, named
+/// after a hash of the module and the target options. The JIT compiles a
+/// single module, so the hash is computed up front, before the engine owns
+/// the module.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  SmallString<128> Path;
+
+public:
+  bool Hit = false;
+
+  ImmediateObjectCache(StringRef Dir, const llvm::Module &M, StringRef CPU,
+                       ArrayRef<std::string> Features) : Path(Dir) {
+    SmallString<0> Bitcode;
+    llvm::raw_svector_ostream OS(Bitcode);
+    llvm::WriteBitcodeToFile(&M, OS);
+
+    llvm::MD5 Hasher;
+    Hasher.update(Bitcode.str());
+    Hasher.update(M.getTargetTriple());
+    Hasher.update(CPU);
+    for (auto &Feature : Features)
+      Hasher.update(Feature);
+    llvm::MD5::MD5Result Result;
+    Hasher.final(Result);
+    SmallString<32> Key;
+    llvm::MD5::stringifyResult(Result, Key);
+
+    llvm::sys::path::append(Path, Twine(Key) + ".o");
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      return nullptr;
+    Hit = true;
+    return std::move(Buffer.get());
+  }
+
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // Write to a temporary file and rename it, so that a concurrent run never
+    // reads a partial object. Failing to cache is not an error.
+    if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+      return;
+    int FD;
+    SmallString<128> TmpPath;
+    if (llvm::sys::fs::createUniqueFile(Twine(Path) + "-%%%%%%%%", FD,
+                                          TmpPath))
+      return;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Obj.getBuffer();
+      if (OS.has_error()) {
+        OS.clear_error();
+        llvm::sys::fs::remove(TmpPath);
+        return;
+      }
+    }
+    if (llvm::sys::fs::rename(TmpPath, Path))
+      llvm::sys::fs::remove(TmpPath);
+  }
+};
+} // end anonymous namespace
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                           IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
   ASTContext &Context = CI.getASTContext();
+  const FrontendOptions &FEOpts = CI.getInvocation().getFrontendOptions();
+  auto StartTime = llvm::sys::TimeValue::now();
   
   // IRGen the main module.
   auto *swiftModule = CI.getMainModule();
@@ -323,16 +398,31 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   builder.setMAttrs(Features);
   builder.setErrorStr(&ErrorMsg);
   builder.setEngineKind(llvm::EngineKind::JIT);
+  // Nothing optimizes the IR here unless -O was passed, so don't spend time
+  // on optimizing code generation either; it delays the start of the program.
+  if (!IRGenOpts.Optimize)
+    builder.setOptLevel(llvm::CodeGenOpt::None);
+
+  std::unique_ptr<ImmediateObjectCache> ObjCache;
+  if (!FEOpts.ImmediateObjectCachePath.empty())
+    ObjCache.reset(new ImmediateObjectCache(FEOpts.ImmediateObjectCachePath,
+                                            *Module, CPU, Features));
+
   llvm::ExecutionEngine *EE = builder.create();
   if (!EE) {
     llvm::errs() << "Error loading JIT: " << ErrorMsg;
     return -1;
   }
+  if (ObjCache)
+    EE->setObjectCache(ObjCache.get());
 
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
 
-  EE->finalizeObject();
+  {
+    SharedTimer timer("JIT code generation");
+    EE->finalizeObject();
+  }
   
   // Run the generated program.
   for (auto InitFn : InitFns) {
@@ -343,6 +433,16 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
 
   DEBUG(llvm::dbgs() << "Running static constructors\n");
   EE->runStaticConstructorsDestructors(false);
+  if (FEOpts.DebugTimeCompilation) {
+    auto Elapsed = llvm::sys::TimeValue::now() - StartTime;
+    llvm::errs() << "Immediate mode: " << Elapsed.msec()
+                 << " ms from IRGen to running main";
+    if (ObjCache)
+      llvm::errs() << (ObjCache->Hit ? " (cached object code)"
+                                     : " (object code added to the cache)");
+    llvm::errs() << '\n';
+  }
+
   DEBUG(llvm::dbgs() << "Running main\n");
   llvm::Function *EntryFn = Module->getFunction("main");
   return EE->runFunctionAsMain(EntryFn, CmdLine, 0);
@@ -741,6 +741,8 @@ private:
   SmallVector<llvm::Function*, 8> InitFns;
   bool RanGlobalInitializers;
   llvm::LLVMContext &LLVMContext;
+  /// The empty module the execution engine is created with. Each line is
+  /// added to the engine as a module of its own.
   llvm::Module *Module;
   llvm::StringSet<> FuncsAlreadyGenerated;
   llvm::StringSet<> GlobalsAlreadyEmitted;
@@ -867,17 +869,15 @@ private:
     if (CI.getASTContext().hadError())
       return false;
 
-    // LineModule will get destroy by the following link process.
+    // LineModule is stripped and handed over to the JIT below.
     // Make a copy of it to be able to correct produce DumpModule.
     std::unique_ptr<llvm::Module> SaveLineModule(CloneModule(LineModule.get()));
-    
-    if (!linkLLVMModules(Module, std::move(LineModule))) {
-      return false;
-    }
-
-    std::unique_ptr<llvm::Module> NewModule(CloneModule(Module));
 
-    Module->getFunction("main")->eraseFromParent();
+    // Only the new line's module is JIT'd. Whatever earlier lines already
+    // defined becomes a declaration, which the JIT resolves against the
+    // modules it compiled for them, so the work per line doesn't grow with
+    // the length of the session.
+    std::unique_ptr<llvm::Module> NewModule = std::move(LineModule);
 
     stripPreviouslyGenerated(*NewModule);
 
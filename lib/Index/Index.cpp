@@ -18,6 +18,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 
 using namespace swift;
@@ -324,6 +325,13 @@ private:
 
   // This maps a module to all its imports, recursively.
   llvm::DenseMap<Module *, llvm::SmallVector<Module *, 4>> ImportsMap;
+  // Hashes of the imported modules that were reported as dependencies. The
+  // same module is reached through many import paths, and each hash stats
+  // every recursive import.
+  llvm::DenseMap<Module *, std::string> ModuleHashes;
+  // Size and modification time of the files that went into a hash, None if
+  // the file couldn't be stat'ed.
+  llvm::StringMap<Optional<std::pair<uint64_t, uint64_t>>> FileStatuses;
 };
 } // anonymous namespace
 
@@ -912,20 +920,30 @@ IndexSwiftASTWalker::hashFileReference(llvm::hash_code code,
 
   // FIXME: FileManager for swift ?
 
-  llvm::sys::fs::file_status Status;
-  if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
+  auto Inserted = FileStatuses.insert({ Filename, None });
+  auto &CachedStatus = Inserted.first->getValue();
+  if (Inserted.second) {
+    llvm::sys::fs::file_status Status;
+    if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
+      warn([&](llvm::raw_ostream &OS) {
+        OS << "failed to stat file: " << Filename << " (" << Ret.message()
+           << ')';
+      });
+    } else {
+      CachedStatus = std::make_pair(
+          Status.getSize(), Status.getLastModificationTime().toEpochTime());
+    }
+  }
+
+  if (!CachedStatus) {
     // Failure to read the file, just use filename to recover.
-    warn([&](llvm::raw_ostream &OS) {
-      OS << "failed to stat file: " << Filename << " (" << Ret.message() << ')';
-    });
     return hash_combine(code, Filename);
   }
 
   // Don't use inode because it can easily change when you update the repository
   // even though the file is supposed to be the same (same size/time).
   code = hash_combine(code, Filename);
-  return hash_combine(code, Status.getSize(),
-                      Status.getLastModificationTime().toEpochTime());
+  return hash_combine(code, CachedStatus->first, CachedStatus->second);
 }
 
 llvm::hash_code IndexSwiftASTWalker::hashModule(llvm::hash_code code,
@@ -1037,9 +1055,21 @@ void IndexSwiftASTWalker::collectRecursiveModuleImports(
 
 void IndexSwiftASTWalker::getModuleHash(SourceFileOrModule Mod,
                                         llvm::raw_ostream &OS) {
+  Module *M = Mod.getAsModule();
+  if (M) {
+    auto Found = ModuleHashes.find(M);
+    if (Found != ModuleHashes.end()) {
+      OS << Found->second;
+      return;
+    }
+  }
+
   // FIXME: Use a longer hash string to minimize possibility for conflicts.
   llvm::hash_code code = hashModule(0, Mod);
-  OS << llvm::APInt(64, code).toString(36, /*Signed=*/false);
+  std::string Hash = llvm::APInt(64, code).toString(36, /*Signed=*/false);
+  OS << Hash;
+  if (M)
+    ModuleHashes[M] = std::move(Hash);
 }
 
 //===----------------------------------------------------------------------===//
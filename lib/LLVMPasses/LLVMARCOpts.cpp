@@ -35,6 +35,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -52,6 +53,8 @@ STATISTIC(NumNoopDeleted,
           "Number of no-op swift calls eliminated");
 STATISTIC(NumRetainReleasePairs,
           "Number of swift retain/release pairs eliminated");
+STATISTIC(NumCrossBlockRetainReleasePairs,
+          "Number of retain/release pairs eliminated across basic blocks");
 STATISTIC(NumObjCRetainReleasePairs,
           "Number of objc retain/release pairs eliminated");
 STATISTIC(NumAllocateReleasePairs,
@@ -243,6 +246,32 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
   return Changed;
 }
 
+//===----------------------------------------------------------------------===//
+//                         Straight-Line Block Chains
+//===----------------------------------------------------------------------===//
+
+/// getStraightLineSuccessor - If \p BB ends in an unconditional branch to a
+/// block that can only be entered from \p BB, return that block.  Retain and
+/// release motion continues into such blocks, as if they were part of \p BB.
+/// This picks up the pairs which LLVM inlining splits across blocks.
+static BasicBlock *getStraightLineSuccessor(BasicBlock *BB) {
+  auto *Br = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!Br || Br->isConditional())
+    return nullptr;
+  BasicBlock *Succ = Br->getSuccessor(0);
+  if (Succ->getSinglePredecessor() != BB)
+    return nullptr;
+  return Succ;
+}
+
+/// getStraightLinePredecessor - The inverse of getStraightLineSuccessor.
+static BasicBlock *getStraightLinePredecessor(BasicBlock *BB) {
+  BasicBlock *Pred = BB->getSinglePredecessor();
+  if (!Pred || getStraightLineSuccessor(Pred) != BB)
+    return nullptr;
+  return Pred;
+}
+
 //===----------------------------------------------------------------------===//
 //                         Release() Motion
 //===----------------------------------------------------------------------===//
@@ -250,17 +279,27 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
 /// performLocalReleaseMotion - Scan backwards from the specified release,
 /// moving it earlier in the function if possible, over instructions that do not
 /// access the released object.  If we get to a retain or allocation of the
-/// object, zap both.
+/// object, zap both.  The scan continues into straight-line predecessors.
 static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
                                       SwiftRCIdentity *RC) {
   // FIXME: Call classifier should identify the object for us.  Too bad C++
   // doesn't have nice Swift-style enums.
   Value *ReleasedObject = RC->getSwiftRCIdentityRoot(Release.getArgOperand(0));
 
+  BasicBlock *CurBB = &BB;
+  SmallPtrSet<BasicBlock *, 4> VisitedBBs;
+  VisitedBBs.insert(CurBB);
   BasicBlock::iterator BBI = Release.getIterator();
 
-  // Scan until we get to the top of the block.
-  while (BBI != BB.begin()) {
+  // Scan until we get to the top of the block chain.
+  for (;;) {
+    while (BBI == CurBB->begin()) {
+      BasicBlock *Pred = getStraightLinePredecessor(CurBB);
+      if (!Pred || !VisitedBBs.insert(Pred).second)
+        goto OutOfLoop;
+      CurBB = Pred;
+      BBI = Pred->getTerminator()->getIterator();
+    }
     --BBI;
 
     // Don't analyze PHI nodes.  We can't move retains before them and they
@@ -331,6 +370,8 @@ static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
         Retain.eraseFromParent();
         Release.eraseFromParent();
         ++NumRetainReleasePairs;
+        if (CurBB != &BB)
+          ++NumCrossBlockRetainReleasePairs;
         return true;
       }
 
@@ -383,7 +424,7 @@ OutOfLoop:
 
   // If we got to the top of the block, (and if the instruction didn't start
   // there) move the release to the top of the block.
-  // TODO: This is where we'd plug in some global algorithms someday.
+  // TODO: Straight-line block chains are as global as this gets for now.
   if (&*BBI != &Release) {
     Release.moveBefore(&*BBI);
     return true;
@@ -399,7 +440,8 @@ OutOfLoop:
 
 /// performLocalRetainMotion - Scan forward from the specified retain, moving it
 /// later in the function if possible, over instructions that provably can't
-/// release the object.  If we get to a release of the object, zap both.
+/// release the object.  If we get to a release of the object, zap both.  The
+/// scan continues into straight-line successors.
 ///
 /// NOTE: this handles both objc_retain and swift_retain.
 ///
@@ -409,6 +451,9 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
   // doesn't have nice Swift-style enums.
   Value *RetainedObject = RC->getSwiftRCIdentityRoot(Retain.getArgOperand(0));
 
+  BasicBlock *CurBB = &BB;
+  SmallPtrSet<BasicBlock *, 4> VisitedBBs;
+  VisitedBBs.insert(CurBB);
   BasicBlock::iterator BBI = Retain.getIterator(),
                        BBE = BB.getTerminator()->getIterator();
 
@@ -416,8 +461,16 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
 
   bool MadeProgress = false;
 
-  // Scan until we get to the end of the block.
-  for (++BBI; BBI != BBE; ++BBI) {
+  // Scan until we get to the end of the block chain.
+  for (++BBI;; ++BBI) {
+    while (BBI == BBE) {
+      BasicBlock *Succ = getStraightLineSuccessor(CurBB);
+      if (!Succ || !VisitedBBs.insert(Succ).second)
+        goto OutOfLoop;
+      CurBB = Succ;
+      BBI = Succ->getFirstNonPHI()->getIterator();
+      BBE = Succ->getTerminator()->getIterator();
+    }
     Instruction &CurInst = *BBI;
 
     // Classify the instruction. This switch does a "break" when the instruction
@@ -475,6 +528,8 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
         } else {
           ++NumRetainReleasePairs;
         }
+        if (CurBB != &BB)
+          ++NumCrossBlockRetainReleasePairs;
         return true;
       }
 
@@ -505,7 +560,7 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
 OutOfLoop:
 
   // If we were able to move the retain down, move it now.
-  // TODO: This is where we'd plug in some global algorithms someday.
+  // TODO: Straight-line block chains are as global as this gets for now.
   if (MadeProgress) {
     Retain.moveBefore(&*BBI);
     return true;
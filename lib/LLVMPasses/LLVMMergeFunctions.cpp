@@ -61,6 +61,8 @@ using namespace swift;
 
 STATISTIC(NumSwiftFunctionsMerged, "Number of functions merged");
 STATISTIC(NumSwiftThunksWritten, "Number of thunks generated");
+STATISTIC(NumSwiftInstructionsMerged,
+          "Number of instructions in function bodies replaced by merging");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "swiftmergefunc-sanity",
@@ -1097,6 +1099,10 @@ static bool isEligibleForConstantSharing(const Instruction *I) {
     case Instruction::Load:
     case Instruction::Store:
     case Instruction::Call:
+    case Instruction::Invoke:
+    // Generic specializations often only differ in the metadata or witness
+    // tables they compare against, e.g. in casts.
+    case Instruction::ICmp:
       return true;
     default:
       return false;
@@ -1118,17 +1124,17 @@ int FunctionComparator::cmpOperands(const Instruction *L, const Instruction *R,
   if (!isEligibleForConstantSharing(L))
     return Res;
 
-  if (const CallInst *CL = dyn_cast<CallInst>(L)) {
-    if (CL->isInlineAsm())
+  if (ImmutableCallSite CSL = ImmutableCallSite(L)) {
+    if (CSL.isInlineAsm())
       return Res;
-    if (Function *CalleeL = CL->getCalledFunction()) {
+    if (Function *CalleeL = CSL.getCalledFunction()) {
       if (CalleeL->isIntrinsic())
         return Res;
     }
-    const CallInst *CR = cast<CallInst>(R);
-    if (CR->isInlineAsm())
+    ImmutableCallSite CSR = ImmutableCallSite(R);
+    if (CSR.isInlineAsm())
       return Res;
-    if (Function *CalleeR = CR->getCalledFunction()) {
+    if (Function *CalleeR = CSR.getCalledFunction()) {
       if (CalleeR->isIntrinsic())
         return Res;
     }
@@ -1952,6 +1958,12 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
   // We reuse the body of the first function for the new merged function.
   Function *FirstF = FInfos.front().F;
 
+  // The bodies of all other functions are replaced by thunks (or deleted).
+  for (unsigned FIdx = 1, NumFuncs = FInfos.size(); FIdx < NumFuncs; ++FIdx) {
+    for (const BasicBlock &BB : *FInfos[FIdx].F)
+      NumSwiftInstructionsMerged += BB.size();
+  }
+
   // Build the type for the merged function. This will be the type of the
   // original function (FirstF) but with the additional parameter which are
   // needed to parameterize the merged function.
@@ -306,7 +306,47 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+/// The bytes of an 8-byte word, each set to \p c.
+static inline uint64_t broadcastByte(unsigned char c) {
+  return 0x0101010101010101ULL * c;
+}
+
+/// Returns nonzero if any byte of \p word is zero.
+static inline uint64_t hasZeroByte(uint64_t word) {
+  return (word - broadcastByte(0x01)) & ~word & broadcastByte(0x80);
+}
+
+/// Returns nonzero if any byte of \p word is a control character or isn't
+/// ASCII.
+static inline uint64_t hasControlOrNonASCIIByte(uint64_t word) {
+  return ((word - broadcastByte(0x20)) | word) & broadcastByte(0x80);
+}
+
+/// Advances \p ptr over printable ASCII, 8 bytes at a time, stopping before
+/// the 8 bytes containing anything else. This never reads past \p end.
+///
+/// If \p stopAtCommentDelimiters is true, '*' and '/' stop it as well.
+static const char *skipPlainASCII(const char *ptr, const char *end,
+                                  bool stopAtCommentDelimiters) {
+  while (end - ptr >= 8) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    if (hasControlOrNonASCIIByte(word))
+      break;
+    if (stopAtCommentDelimiters &&
+        (hasZeroByte(word ^ broadcastByte('*')) ||
+         hasZeroByte(word ^ broadcastByte('/'))))
+      break;
+    ptr += 8;
+  }
+  return ptr;
+}
+
 void Lexer::skipToEndOfLine() {
+  // Most of a comment is plain ASCII, which doesn't need to be looked at
+  // byte by byte.
+  CurPtr = skipPlainASCII(CurPtr, BufferEnd,
+                          /*stopAtCommentDelimiters=*/false);
   while (1) {
     switch (*CurPtr++) {
     case '\n':
@@ -361,6 +401,8 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd,
+                            /*stopAtCommentDelimiters=*/true);
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -512,6 +554,20 @@ static bool advanceIfValidContinuationOfIdentifier(char const *&ptr,
   return advanceIf(ptr, end, isValidIdentifierContinuationCodePoint);
 }
 
+/// Advances \p ptr over the rest of an identifier, taking ASCII characters
+/// without decoding them as UTF-8.
+static void skipIdentifierContinuation(char const *&ptr, char const *end) {
+  while (ptr < end) {
+    if ((signed char)*ptr >= 0) {
+      if (!clang::isIdentifierBody(*ptr, /*dollar*/true))
+        return;
+      ++ptr;
+    } else if (!advanceIfValidContinuationOfIdentifier(ptr, end)) {
+      return;
+    }
+  }
+}
+
 static bool advanceIfValidStartOfOperator(char const *&ptr,
                                           char const *end) {
   return advanceIf(ptr, end, Identifier::isOperatorStartCodePoint);
@@ -569,7 +625,7 @@ void Lexer::lexIdentifier() {
   (void) didStart;
 
   // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  skipIdentifierContinuation(CurPtr, BufferEnd);
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1594,6 +1650,9 @@ Restart:
   case '\t':
   case '\f':
   case '\v':
+    // Skip the rest of a run of spaces, such as indentation, at once.
+    while (*CurPtr == ' ' || *CurPtr == '\t')
+      ++CurPtr;
     goto Restart;  // Skip whitespace.
 
   case -1:
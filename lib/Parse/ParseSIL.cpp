@@ -22,7 +22,9 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/SILUndef.h"
 #include "swift/Subsystems.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/ADT/StringSwitch.h"
 using namespace swift;
 
@@ -52,6 +54,58 @@ namespace swift {
     bool DidParseSILStage = false;
     
     DiagnosticEngine *Diags = nullptr;
+
+    /// The top-level declarations looked up by name so far.
+    llvm::DenseMap<Identifier, llvm::PointerUnion<ValueDecl *, Module *>>
+      TopDecls;
+
+    /// The phases of parsing covered by SILOptions::PrintSILParseTiming.
+    enum TimedPhase {
+      ParsingInstructions,
+      ResolvingTypes,
+      ResolvingDecls,
+      VerifyingFunctions,
+      NumTimedPhases
+    };
+
+    /// The time spent in each phase, if SILOptions::PrintSILParseTiming is set.
+    llvm::TimeRecord PhaseTimes[NumTimedPhases];
+    unsigned PhaseCounts[NumTimedPhases] = {};
+
+    /// The number of function body types that were looked up in a function's
+    /// type cache, and how many of them were found.
+    unsigned NumTypeLookups = 0;
+    unsigned NumTypeCacheHits = 0;
+
+    void printTimingReport(llvm::raw_ostream &OS) const;
+  };
+
+  /// Adds the time from its construction to its destruction to one of the
+  /// SILParserTUState::PhaseTimes, if the SIL parse timing report was asked
+  /// for.
+  class SILParsePhaseTimer {
+    SILParserTUState *State;
+    SILParserTUState::TimedPhase Phase;
+    llvm::TimeRecord Start;
+
+  public:
+    SILParsePhaseTimer(SILParserTUState &TUState,
+                       SILParserTUState::TimedPhase Phase)
+        : State(TUState.M.getOptions().PrintSILParseTiming ? &TUState
+                                                            : nullptr),
+          Phase(Phase) {
+      if (State)
+        Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+    }
+
+    ~SILParsePhaseTimer() {
+      if (!State)
+        return;
+      llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(false);
+      Elapsed -= Start;
+      State->PhaseTimes[Phase] += Elapsed;
+      ++State->PhaseCounts[Phase];
+    }
   };
 }
 
@@ -63,7 +117,30 @@ SILParserState::~SILParserState() {
   delete S;
 }
 
+void SILParserTUState::printTimingReport(llvm::raw_ostream &OS) const {
+  static const char *const PhaseNames[NumTimedPhases] = {
+    "instructions",
+    "type resolution",
+    "declaration lookup",
+    "function verification",
+  };
+
+  OS << "===-- SIL parsing time report --===\n";
+  OS << llvm::format("%12s %10s  %s\n", "wall (ms)", "count", "phase");
+  for (unsigned i = 0; i != NumTimedPhases; ++i) {
+    OS << llvm::format("%12.2f %10u  %s\n",
+                       PhaseTimes[i].getWallTime() * 1000.0, PhaseCounts[i],
+                       PhaseNames[i]);
+  }
+  OS << "Types found in the function type cache: " << NumTypeCacheHits
+     << " of " << NumTypeLookups << "\n";
+  OS << "Top-level declarations looked up: " << TopDecls.size() << "\n";
+}
+
 SILParserTUState::~SILParserTUState() {
+  if (M.getOptions().PrintSILParseTiming)
+    printTimingReport(llvm::errs());
+
   if (!ForwardRefFns.empty())
     for (auto Entry : ForwardRefFns)
       if (Entry.second.second.isValid())
@@ -112,6 +189,11 @@ namespace {
     llvm::StringMap<ValueBase*> LocalValues;
     llvm::StringMap<SourceLoc> ForwardRefLocalValues;
 
+    /// The types written in this function so far, by their text (from the
+    /// '$' on). A type's name resolves the same way everywhere in a function
+    /// body, so each is only resolved once.
+    llvm::StringMap<SILType> ParsedTypes;
+
     bool performTypeLocChecking(TypeLoc &T, bool IsSIL = true);
     bool parseSpecConformanceSubstitutions(
                    SmallVectorImpl<ParsedSubstitution> &parsed);
@@ -225,7 +307,8 @@ namespace {
                                        SILValueCategory category,
                                        const TypeAttributes &attrs,
                                        GenericParamList *&genericParams,
-                                       bool IsFuncDecl = false);
+                                       bool IsFuncDecl = false,
+                                       SourceLoc TypeStartLoc = SourceLoc());
     bool parseSILTypeWithoutQualifiers(SILType &Result,
                                        SILValueCategory category,
                                        const TypeAttributes &attrs) {
@@ -752,6 +835,12 @@ bool SILParser::performTypeLocChecking(TypeLoc &T, bool IsSIL) {
 /// Find the top-level ValueDecl or Module given a name.
 static llvm::PointerUnion<ValueDecl*, Module*> lookupTopDecl(Parser &P,
              Identifier Name) {
+  SILParserTUState &TUState = *P.SIL->S;
+  SILParsePhaseTimer Timer(TUState, SILParserTUState::ResolvingDecls);
+  auto Known = TUState.TopDecls.find(Name);
+  if (Known != TUState.TopDecls.end())
+    return Known->second;
+
   // Use UnqualifiedLookup to look through all of the imports.
   // We have to lie and say we're done with parsing to make this happen.
   assert(P.SF.ASTStage == SourceFile::Parsing &&
@@ -761,6 +850,7 @@ static llvm::PointerUnion<ValueDecl*, Module*> lookupTopDecl(Parser &P,
   UnqualifiedLookup DeclLookup(Name, &P.SF, nullptr);
   assert(DeclLookup.isSuccess() && DeclLookup.Results.size() == 1);
   ValueDecl *VD = DeclLookup.Results.back().getValueDecl();
+  TUState.TopDecls[Name] = VD;
   return VD;
 }
 
@@ -796,7 +886,8 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
                                               SILValueCategory category,
                                               const TypeAttributes &attrs,
                                               GenericParamList *&GenericParams,
-                                              bool IsFuncDecl){
+                                              bool IsFuncDecl,
+                                              SourceLoc TypeStartLoc){
   GenericParams = nullptr;
 
   // If this is part of a function decl, generic parameters are visible in the
@@ -823,14 +914,35 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
     }
   }
   
+  // Types in a function body that don't introduce their own generic
+  // parameters come out the same each time they're written.
+  StringRef TypeText;
+  if (TypeStartLoc.isValid() && !IsFuncDecl && !GenericParams && F) {
+    SourceLoc EndLoc = Lexer::getLocForEndOfToken(P.SourceMgr, P.PreviousLoc);
+    TypeText = P.SourceMgr.extractText(
+        CharSourceRange(P.SourceMgr, TypeStartLoc, EndLoc));
+    ++TUState.NumTypeLookups;
+    auto Known = ParsedTypes.find(TypeText);
+    if (Known != ParsedTypes.end()) {
+      ++TUState.NumTypeCacheHits;
+      Result = Known->second;
+      return false;
+    }
+  }
+
   // Apply attributes to the type.
   TypeLoc Ty = P.applyAttributeToType(TyR.get(), attrs);
 
-  if (performTypeLocChecking(Ty))
-    return true;
+  {
+    SILParsePhaseTimer Timer(TUState, SILParserTUState::ResolvingTypes);
+    if (performTypeLocChecking(Ty))
+      return true;
+  }
 
   Result = SILType::getPrimitiveType(Ty.getType()->getCanonicalType(),
                                      category);
+  if (!TypeText.empty())
+    ParsedTypes[TypeText] = Result;
   return false;
 
 }
@@ -840,6 +952,7 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
 ///
 bool SILParser::parseSILType(SILType &Result, GenericParamList *&GenericParams,
                              bool IsFuncDecl){
+  SourceLoc TypeStartLoc = P.Tok.getLoc();
   if (P.parseToken(tok::sil_dollar, diag::expected_sil_type))
     return true;
 
@@ -861,7 +974,7 @@ bool SILParser::parseSILType(SILType &Result, GenericParamList *&GenericParams,
     attrs.convention = "thin";
   }
   return parseSILTypeWithoutQualifiers(Result, category, attrs, GenericParams,
-                                       IsFuncDecl);
+                                       IsFuncDecl, TypeStartLoc);
 }
 
 bool SILParser::parseSILDottedPath(ValueDecl *&Decl,
@@ -3759,6 +3872,7 @@ bool SILParser::parseSILBasicBlock() {
   F->getBlocks().push_back(BB);
 
   do {
+    SILParsePhaseTimer Timer(TUState, SILParserTUState::ParsingInstructions);
     if (parseSILInstruction(BB))
       return true;
   } while (isStartOfSILInstruction());
@@ -3868,8 +3982,11 @@ bool Parser::parseDeclSIL() {
     return true;
 
   // If SIL parsing succeeded, verify the generated SIL.
-  if (!FunctionState.P.Diags.hadAnyError())
+  if (!FunctionState.P.Diags.hadAnyError()) {
+    SILParsePhaseTimer Timer(FunctionState.TUState,
+                             SILParserTUState::VerifyingFunctions);
     FunctionState.F->verify();
+  }
 
   // Link the static initializer for global variables.
   for (SILGlobalVariable &v : FunctionState.SILMod.getSILGlobals()) {
@@ -1491,6 +1491,10 @@ class ModuleWriter {
   using ImportModuleTy = PointerUnion<Module*, const clang::Module*>;
   SmallSetVector<ImportModuleTy, 8,
                  PointerLikeComparator<ImportModuleTy>> imports;
+  /// The results of addImport. The same types are referenced from many
+  /// members, and finding the owning Clang module of a declaration isn't
+  /// cheap.
+  llvm::DenseMap<const Decl *, bool> importedDecls;
 
   std::string bodyBuffer;
   llvm::raw_string_ostream os{bodyBuffer};
@@ -1508,6 +1512,15 @@ public:
   /// The standard library is special-cased: we assume that any types from it
   /// will be handled explicitly rather than needing an explicit @import.
   bool addImport(const Decl *D) {
+    auto known = importedDecls.find(D);
+    if (known != importedDecls.end())
+      return known->second;
+    bool result = addImportUncached(D);
+    importedDecls[D] = result;
+    return result;
+  }
+
+  bool addImportUncached(const Decl *D) {
     Module *otherModule = D->getModuleContext();
 
     if (otherModule == &M)
@@ -31,10 +31,26 @@ using namespace swift;
 
 void ValueBase::replaceAllUsesWith(ValueBase *RHS) {
   assert(this != RHS && "Cannot RAUW a value with itself");
-  while (!use_empty()) {
-    Operand *Op = *use_begin();
-    Op->set(RHS);
+  if (use_empty())
+    return;
+
+  // Move the uses over in one walk instead of unlinking and relinking each
+  // one. They end up in front of RHS's uses in reverse order, just as if each
+  // had been set to RHS in turn, so that passes see the same use order.
+  Operand *Head = RHS->FirstUse;
+  Operand *Op = FirstUse;
+  FirstUse = nullptr;
+  while (Op) {
+    Operand *Next = Op->NextUse;
+    Op->TheValue = RHS;
+    Op->NextUse = Head;
+    if (Head)
+      Head->Back = &Op->NextUse;
+    Head = Op;
+    Op = Next;
   }
+  RHS->FirstUse = Head;
+  Head->Back = &RHS->FirstUse;
 }
 
 
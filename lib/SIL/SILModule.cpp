@@ -27,6 +27,16 @@
 using namespace swift;
 using namespace Lowering;
 
+STATISTIC(NumConstantsMangled, "Number of SIL constants mangled");
+STATISTIC(NumFuncBodiesLinkedOnDemand,
+          "Number of SIL function bodies linked on demand");
+STATISTIC(NumInstsAllocated, "Number of SIL instructions allocated");
+STATISTIC(NumInstBytesAllocated, "Number of bytes allocated for SIL "
+                                 "instructions");
+STATISTIC(NumInstsDeallocated, "Number of SIL instructions deallocated");
+STATISTIC(NumZombieInstsFreed, "Number of instructions freed from the bodies "
+                               "of zombie functions");
+
 class SILModule::SerializationCallback : public SerializedSILLoader::Callback {
   void didDeserialize(Module *M, SILFunction *fn) override {
     updateLinkage(fn);
@@ -105,10 +115,13 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
 }
 
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
+  ++NumInstsAllocated;
+  NumInstBytesAllocated += Size;
   return AlignedAlloc(Size, Align);
 }
 
 void SILModule::deallocateInst(SILInstruction *I) {
+  ++NumInstsDeallocated;
   AlignedFree(I);
 }
 
@@ -309,7 +322,7 @@ SILFunction *SILModule::getOrCreateFunction(SILLocation loc,
                                             SILDeclRef constant,
                                             ForDefinition_t forDefinition) {
 
-  auto name = constant.mangle();
+  auto name = getMangledName(constant);
   auto constantType = Types.getConstantType(constant).castTo<SILFunctionType>();
   SILLinkage linkage = constant.getLinkage(forDefinition);
 
@@ -468,9 +481,20 @@ const BuiltinInfo &SILModule::getBuiltinInfo(Identifier ID) {
   return Info;
 }
 
+StringRef SILModule::getMangledName(SILDeclRef constant) {
+  auto inserted = MangledConstantNames.insert({constant, StringRef()});
+  if (inserted.second) {
+    ++NumConstantsMangled;
+    std::string name = constant.mangle();
+    char *buffer = static_cast<char *>(allocate(name.size(), 1));
+    std::copy(name.begin(), name.end(), buffer);
+    inserted.first->second = StringRef(buffer, name.size());
+  }
+  return inserted.first->second;
+}
+
 SILFunction *SILModule::lookUpFunction(SILDeclRef fnRef) {
-  auto name = fnRef.mangle();
-  return lookUpFunction(name);
+  return lookUpFunction(getMangledName(fnRef));
 }
 
 bool SILModule::linkFunction(SILFunction *Fun, SILModule::LinkingMode Mode) {
@@ -485,6 +509,18 @@ bool SILModule::linkFunction(StringRef Name, SILModule::LinkingMode Mode) {
   return SILLinkerVisitor(*this, getSILLoader(), Mode).processFunction(Name);
 }
 
+bool SILModule::linkFunctionBodyOnDemand(SILFunction *Fun) {
+  if (!Fun->isExternalDeclaration())
+    return true;
+  if (!getOptions().LinkOnDemand)
+    return false;
+  if (!linkFunction(Fun, LinkingMode::LinkNormal) ||
+      Fun->isExternalDeclaration())
+    return false;
+  ++NumFuncBodiesLinkedOnDemand;
+  return true;
+}
+
 SILFunction *SILModule::hasFunction(StringRef Name, SILLinkage Linkage) {
   assert((Linkage == SILLinkage::Public ||
           Linkage == SILLinkage::PublicExternal) &&
@@ -548,6 +584,20 @@ SILFunction *SILModule::hasFunction(StringRef Name, SILLinkage Linkage) {
   return F;
 }
 
+const SILFunctionEffectsSummary *
+SILModule::lookUpEffectsSummary(SILFunction *F) {
+  if (!F->isExternalDeclaration())
+    return nullptr;
+
+  if (!F->getEffectsSummary()) {
+    SILFunctionEffectsSummary Summary;
+    if (!getSILLoader()->lookupEffectsSummary(F->getName(), Summary))
+      return nullptr;
+    F->setEffectsSummary(std::move(Summary));
+  }
+  return F->getEffectsSummary().getPointer();
+}
+
 void SILModule::linkAllWitnessTables() {
   getSILLoader()->getAllWitnessTables();
 }
@@ -590,6 +640,17 @@ void SILModule::eraseFunction(SILFunction *F) {
     // This opens dead-function-removal opportunities for called functions.
     // (References are not needed anymore.)
     F->dropAllReferences();
+
+    // Neither debug info nor the vtable stubs need the body, so free it now
+    // rather than keeping it until the module goes away.
+    unsigned NumInsts = 0;
+    for (auto &BB : *F)
+      NumInsts += std::distance(BB.begin(), BB.end());
+    DEBUG(llvm::dbgs() << "Freeing " << NumInsts
+                       << " instructions of zombie function " << F->getName()
+                       << "\n");
+    NumZombieInstsFreed += NumInsts;
+    F->getBlocks().clear();
   } else {
     FunctionTable.erase(F->getName());
     getFunctionList().erase(F);
@@ -1675,11 +1675,14 @@ static void printLinkage(llvm::raw_ostream &OS, SILLinkage linkage,
 void SILFunction::print(SILPrintContext &PrintCtx) const {
   auto &SM = getModule().getASTContext().SourceMgr;
   llvm::raw_ostream &OS = PrintCtx.OS();
-  for (auto &BB : *this)
-    for (auto &I : BB) {
-      SILPrinter P(PrintCtx);
-      P.printDebugScope(I.getDebugScope(), SM);
-    }
+  {
+    // One printer for all the scopes: setting up a printer is expensive and
+    // makes OS flush. It has to go away (and flush) before OS is used again.
+    SILPrinter P(PrintCtx);
+    for (auto &BB : *this)
+      for (auto &I : BB)
+        P.printDebugScope(I.getDebugScope(), SM);
+  }
   OS << "\n";
 
   OS << "// " << demangleSymbol(getName()) << '\n';
@@ -3158,6 +3158,8 @@ void SILFunction::verify(bool SingleFunction) const {
   // Please put all checks in visitSILFunction in SILVerifier, not here. This
   // ensures that the pretty stack trace in the verifier is included with the
   // back trace when the verifier crashes.
+  if (!getModule().getASTContext().LangOpts.shouldVerifySample(getName()))
+    return;
   SILVerifier(*this, SingleFunction).verify();
 #endif
 }
@@ -30,11 +30,20 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/TypeLowering.h"
 #include "clang/AST/Type.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 using namespace Lowering;
 
+STATISTIC(NumDependentLoweringHits,
+          "Number of dependent type lowerings found in the cache");
+STATISTIC(NumDependentLoweringMisses,
+          "Number of dependent type lowerings not found in the cache");
+STATISTIC(NumGenericContextsReused,
+          "Number of generic contexts which reused the type lowerings of an "
+          "earlier context with the same signature");
+
 namespace {
   /// A CRTP type visitor for deciding whether the metatype for a type
   /// is a singleton type, i.e. whether there can only ever be one
@@ -1281,30 +1290,62 @@ TypeConverter::~TypeConverter() {
   }
 }
 
+TypeConverter::DependentTypeCache::~DependentTypeCache() {
+  // Resetting the BPA will deallocate but not run the destructor of the
+  // dependent TypeLowerings.
+  for (auto &ti : Types) {
+    // Destroy only the unique entries.
+    CanType srcType = ti.first.OrigType;
+    if (!srcType) continue;
+    CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
+    if (srcType == mappedType || isa<LValueType>(srcType))
+      ti.second->~TypeLowering();
+  }
+}
+
 void *TypeLowering::operator new(size_t size, TypeConverter &tc,
                                  IsDependent_t dependent) {
   return dependent
-    ? tc.DependentBPA.Allocate(size, alignof(TypeLowering))
+    ? tc.getCurDependentTypes().BPA.Allocate(size, alignof(TypeLowering))
     : tc.IndependentBPA.Allocate(size, alignof(TypeLowering));
 }
 
+TypeConverter::DependentTypeCache &TypeConverter::getCurDependentTypes() {
+  if (CurDependentTypes)
+    return *CurDependentTypes;
+
+  // Dependent types outside any generic context share the entry for no
+  // signature.
+  auto &Cache = DependentTypeCaches[nullptr];
+  if (!Cache)
+    Cache.reset(new DependentTypeCache());
+  return *Cache;
+}
+
 const TypeLowering *TypeConverter::find(TypeKey k) {
   if (!k.isCacheable()) return nullptr;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
+  auto &Types =
+    k.isDependent() ? getCurDependentTypes().Types : IndependentTypes;
   auto ck = k.getCachingKey();
   auto found = Types.find(ck);
-  if (found == Types.end())
+  if (found == Types.end()) {
+    if (k.isDependent())
+      ++NumDependentLoweringMisses;
     return nullptr;
+  }
 
   assert(found->second && "type recursion not caught in Sema");
+  if (k.isDependent())
+    ++NumDependentLoweringHits;
   return found->second;
 }
 
 void TypeConverter::insert(TypeKey k, const TypeLowering *tl) {
   if (!k.isCacheable()) return;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
+  auto &Types =
+    k.isDependent() ? getCurDependentTypes().Types : IndependentTypes;
 
   Types[k.getCachingKey()] = tl;
 }
@@ -1995,10 +2036,19 @@ void TypeConverter::pushGenericContext(CanGenericSignature sig) {
     return;
   
   // GenericFunctionTypes shouldn't nest.
-  assert(DependentTypes.empty() && "already in generic context?!");
+  assert(!CurDependentTypes && "already in generic context?!");
   assert(!CurGenericContext && "already in generic context!");
 
   CurGenericContext = sig;
+
+  // Signatures are uniqued, so any earlier context with this one lowered its
+  // dependent types the same way.
+  auto &Cache = DependentTypeCaches[sig.getPointer()];
+  if (Cache)
+    ++NumGenericContextsReused;
+  else
+    Cache.reset(new DependentTypeCache());
+  CurDependentTypes = Cache.get();
 }
 
 void TypeConverter::popGenericContext(CanGenericSignature sig) {
@@ -2007,21 +2057,10 @@ void TypeConverter::popGenericContext(CanGenericSignature sig) {
     return;
 
   assert(CurGenericContext == sig && "unpaired push/pop");
-  
-  // Erase our cached TypeLowering objects and associated mappings for dependent
-  // types.
-  // Resetting the DependentBPA will deallocate but not run the destructor of
-  // the dependent TypeLowerings.
-  for (auto &ti : DependentTypes) {
-    // Destroy only the unique entries.
-    CanType srcType = ti.first.OrigType;
-    if (!srcType) continue;
-    CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
-    if (srcType == mappedType || isa<LValueType>(srcType))
-      ti.second->~TypeLowering();
-  }
-  DependentTypes.clear();
-  DependentBPA.Reset();
+
+  // The dependent type lowerings stay cached for the next context with this
+  // signature.
+  CurDependentTypes = nullptr;
   CurGenericContext = nullptr;
 }
 
@@ -27,6 +27,7 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "RValue.h"
 using namespace swift;
@@ -39,6 +40,17 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const std::string &ProfilePath = M.getOptions().UseProfile;
+  if (!ProfilePath.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfilePath);
+    if (auto EC = ReaderOrErr.getError()) {
+      diagnose(SourceLoc(), diag::profile_read_error, ProfilePath,
+               EC.message());
+    } else {
+      ProfileReader = std::move(ReaderOrErr.get());
+      M.setMaxFunctionEntryCount(ProfileReader->getMaximumFunctionCount());
+    }
+  }
 }
 
 SILGenModule::~SILGenModule() {
@@ -1347,6 +1359,13 @@ SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
         M->getSILLoader()->getAllForModule(mod->getName(), file);
     }
   } else {
+    // Note that the files, and the bodies within them, are emitted one after
+    // the other. Emitting independent bodies on several threads would need
+    // more than locking around SILModule::functions: the SILGenModule
+    // bookkeeping (emittedFunctions, delayedFunctions, lastEmittedFunction)
+    // decides both whether and where a function is emitted, the TypeConverter
+    // and the ASTContext caches are populated lazily by type lowering, and
+    // SILBuilder allocates instructions from the single SILModule allocator.
     for (auto file : mod->getFiles()) {
       auto nextSF = dyn_cast<SourceFile>(file);
       if (!nextSF || nextSF->ASTStage != SourceFile::TypeChecked)
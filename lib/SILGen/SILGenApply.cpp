@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "silgen"
 #include "ArgumentSource.h"
 #include "LValue.h"
 #include "RValue.h"
@@ -25,10 +26,16 @@
 #include "swift/Basic/Range.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/PrettyStackTrace.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 using namespace Lowering;
 
+STATISTIC(NumGuaranteedArgsAtPlusZero,
+          "Number of non-trivial guaranteed arguments passed at +0");
+STATISTIC(NumGuaranteedArgsAtPlusOne,
+          "Number of guaranteed arguments copied and destroyed around a call");
+
 /// Retrieve the type to use for a method found via dynamic lookup.
 static CanAnyFunctionType getDynamicMethodFormalType(SILGenModule &SGM,
                                                      SILValue proto,
@@ -1812,8 +1819,14 @@ static SILValue emitRawApply(SILGenFunction &gen,
   // Be sure to use a CleanupLocation so that unreachable code diagnostics don't
   // trigger.
   for (auto i : indices(args)) {
-    if (!inputTypes[i].isGuaranteed() || args[i].isPlusZeroRValueOrTrivial())
+    if (!inputTypes[i].isGuaranteed())
+      continue;
+    if (args[i].isPlusZeroRValueOrTrivial()) {
+      if (!args[i].getType().isTrivial(gen.SGM.M))
+        ++NumGuaranteedArgsAtPlusZero;
       continue;
+    }
+    ++NumGuaranteedArgsAtPlusOne;
 
     SILValue argValue = args[i].forward(gen);
     SILType argType = argValue->getType();
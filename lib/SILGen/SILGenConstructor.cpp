@@ -255,7 +255,7 @@ void SILGenFunction::emitValueConstructor(ConstructorDecl *ctor) {
     emitMemberInitializers(selfDecl, nominal);
   }
 
-  emitProfilerIncrement(ctor->getBody());
+  emitProfilerEntryIncrement(ctor->getBody());
   // Emit the constructor body.
   emitStmt(ctor->getBody());
 
@@ -642,7 +642,7 @@ void SILGenFunction::emitClassConstructorInitializer(ConstructorDecl *ctor) {
     emitMemberInitializers(selfDecl, selfClassDecl);
   }
 
-  emitProfilerIncrement(ctor->getBody());
+  emitProfilerEntryIncrement(ctor->getBody());
   // Emit the constructor body.
   emitStmt(ctor->getBody());
 
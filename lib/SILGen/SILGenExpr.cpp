@@ -700,7 +700,8 @@ RValue SILGenFunction::emitRValueForPropertyLoad(
       B.createStructElementAddr(loc, base.getValue(), field);
 
     Result = emitLoad(loc, ElementPtr, abstractedTL,
-                      hasAbstractionChange ? SGFContext() : C, IsNotTake);
+                      hasAbstractionChange ? SGFContext() : C, IsNotTake,
+                      isGuaranteedValid);
   }
 
   // If we're accessing this member with an abstraction change, perform that
@@ -1649,10 +1650,35 @@ public:
   ~NominalTypeMemberRefRValueEmitter() = default;
 
 private:
+  /// Returns true if the struct value \p base evaluates to cannot change
+  /// until the end of the current evaluation: a 'let', or a stored property
+  /// of such a struct.
+  static bool isGuaranteedValidBase(swift::Expr *base) {
+    base = base->getSemanticsProvidingExpr();
+    if (auto *declRef = dyn_cast<DeclRefExpr>(base)) {
+      auto *var = dyn_cast<VarDecl>(declRef->getDecl());
+      return var && var->isLet();
+    }
+    if (auto *memberRef = dyn_cast<MemberRefExpr>(base)) {
+      auto *var = dyn_cast<VarDecl>(memberRef->getMember().getDecl());
+      return var && var->hasStorage() &&
+             memberRef->getBase()->getType()->getStructOrBoundGenericStruct() &&
+             isGuaranteedValidBase(memberRef->getBase());
+    }
+    return false;
+  }
+
   RValue emitStructDecl(SILGenFunction &SGF) {
+    // If the base will stay valid, and the client is fine with a guaranteed
+    // +0 value, emit the base at guaranteed +0 as well, so that the field
+    // can be passed on at +0 without a copy.
+    bool isGuaranteedValid = Context.isGuaranteedPlusZeroOk() &&
+                             isGuaranteedValidBase(Expr->getBase());
     ManagedValue base =
       SGF.emitRValueAsSingleValue(Expr->getBase(),
-                                  SGFContext::AllowImmediatePlusZero);
+                                  isGuaranteedValid
+                                    ? SGFContext::AllowGuaranteedPlusZero
+                                    : SGFContext::AllowImmediatePlusZero);
     CanType baseFormalType =
       Expr->getBase()->getType()->getCanonicalType();
     assert(baseFormalType->isMaterializable());
@@ -1663,7 +1689,9 @@ private:
                                     Field,
                                     Expr->getMember().getSubstitutions(),
                                     Expr->getAccessSemantics(),
-                                    Expr->getType(), Context);
+                                    Expr->getType(), Context,
+                                    isGuaranteedValid &&
+                                      base.isPlusZeroRValueOrTrivial());
     return result;
   }
 
@@ -423,7 +423,7 @@ void SILGenFunction::emitFunction(FuncDecl *fd) {
   emitProlog(fd, fd->getParameterLists(), resultTy);
   prepareEpilog(resultTy, fd->hasThrows(), CleanupLocation(fd));
 
-  emitProfilerIncrement(fd->getBody());
+  emitProfilerEntryIncrement(fd->getBody());
   emitStmt(fd->getBody());
 
   emitEpilog(fd);
@@ -436,13 +436,13 @@ void SILGenFunction::emitClosure(AbstractClosureExpr *ace) {
   prepareEpilog(ace->getResultType(), ace->isBodyThrowing(),
                 CleanupLocation(ace));
   if (auto *ce = dyn_cast<ClosureExpr>(ace)) {
-    emitProfilerIncrement(ce);
+    emitProfilerEntryIncrement(ce);
     emitStmt(ce->getBody());
   } else {
     auto *autoclosure = cast<AutoClosureExpr>(ace);
     // Closure expressions implicitly return the result of their body
     // expression.
-    emitProfilerIncrement(autoclosure);
+    emitProfilerEntryIncrement(autoclosure);
     emitReturnExpr(ImplicitReturnLocation(ace),
                    autoclosure->getSingleExpressionBody());
   }
@@ -468,6 +468,15 @@ public:
     if (SGM.Profiler && SGM.Profiler->hasRegionCounters())
       SGM.Profiler->emitCounterIncrement(B, N);
   }
+
+  /// Emit code to increment the counter for entering the function, whose body
+  /// is \p N, and record how often it was entered in the profile being used.
+  void emitProfilerEntryIncrement(ASTNode N) {
+    emitProfilerIncrement(N);
+    if (SGM.Profiler)
+      if (auto Count = SGM.Profiler->getExecutionCount(N))
+        F.setEntryCount(*Count);
+  }
   
   SILGenFunction(SILGenModule &SGM, SILFunction &F);
   ~SILGenFunction();
@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -63,10 +64,11 @@ static void walkForProfiling(AbstractFunctionDecl *Root, ASTWalker &Walker) {
 ProfilerRAII::ProfilerRAII(SILGenModule &SGM, AbstractFunctionDecl *D)
     : SGM(SGM), PreviousProfiler(std::move(SGM.Profiler)) {
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  bool UseProfile = SGM.ProfileReader != nullptr;
+  if ((!Opts.GenerateProfile && !UseProfile) || isUnmappedDecl(D))
     return;
-  SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+  SGM.Profiler = llvm::make_unique<SILGenProfiling>(
+      SGM, Opts.EmitProfileCoverageMapping, Opts.ProfileEntryCountsOnly);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -82,8 +84,13 @@ struct MapRegionCounters : public ASTWalker {
   /// The map of statements to counters.
   llvm::DenseMap<ASTNode, unsigned> &CounterMap;
 
-  MapRegionCounters(llvm::DenseMap<ASTNode, unsigned> &CounterMap)
-      : NextCounter(0), CounterMap(CounterMap) {}
+  /// Whether only function and closure bodies get counters.
+  bool EntryCountsOnly;
+
+  MapRegionCounters(llvm::DenseMap<ASTNode, unsigned> &CounterMap,
+                    bool EntryCountsOnly)
+      : NextCounter(0), CounterMap(CounterMap),
+        EntryCountsOnly(EntryCountsOnly) {}
 
   bool walkToDeclPre(Decl *D) override {
     if (isUnmappedDecl(D))
@@ -94,7 +101,11 @@ struct MapRegionCounters : public ASTWalker {
   }
 
   std::pair<bool, Stmt *> walkToStmtPre(Stmt *S) override {
-    if (auto *IS = dyn_cast<IfStmt>(S)) {
+    if (EntryCountsOnly) {
+      // Still look for closures in the expressions of the statement.
+      if (auto *FES = dyn_cast<ForEachStmt>(S))
+        walkForProfiling(FES->getIterator(), *this);
+    } else if (auto *IS = dyn_cast<IfStmt>(S)) {
       CounterMap[IS->getThenStmt()] = NextCounter++;
     } else if (auto *US = dyn_cast<GuardStmt>(S)) {
       CounterMap[US->getBody()] = NextCounter++;
@@ -120,10 +131,12 @@ struct MapRegionCounters : public ASTWalker {
   }
 
   std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
-    if (auto *IE = dyn_cast<IfExpr>(E))
-      CounterMap[IE->getThenExpr()] = NextCounter++;
-    else if (isa<AutoClosureExpr>(E) || isa<ClosureExpr>(E))
+    if (auto *IE = dyn_cast<IfExpr>(E)) {
+      if (!EntryCountsOnly)
+        CounterMap[IE->getThenExpr()] = NextCounter++;
+    } else if (isa<AutoClosureExpr>(E) || isa<ClosureExpr>(E)) {
       CounterMap[E] = NextCounter++;
+    }
     return {true, E};
   }
 };
@@ -672,12 +685,26 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   if (auto *ParentFile = Root->getParentSourceFile())
     CurrentFileName = ParentFile->getFilename();
 
-  MapRegionCounters Mapper(RegionCounterMap);
+  MapRegionCounters Mapper(RegionCounterMap, EntryCountsOnly);
   walkForProfiling(Root, Mapper);
 
   NumRegionCounters = Mapper.NextCounter;
   // TODO: Mapper needs to calculate a function hash as it goes.
-  FunctionHash = 0x0;
+  // Until then, at least keep the counts of one counter layout from being
+  // read as the counts of the other.
+  FunctionHash = EntryCountsOnly ? 0x1 : 0x0;
+
+  if (SGM.ProfileReader) {
+    std::string PGOFuncName = llvm::getPGOFuncName(
+        CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
+        CurrentFileName);
+    // A function the profile has no counts for, or stale counts, is
+    // optimized as if there were no profile.
+    if (SGM.ProfileReader->getFunctionCounts(PGOFuncName, FunctionHash,
+                                             RegionCounts) ||
+        RegionCounts.size() != NumRegionCounters)
+      RegionCounts.clear();
+  }
 
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SGM.M.getASTContext().SourceMgr);
@@ -701,11 +728,16 @@ static SILLocation getLocation(ASTNode Node) {
 }
 
 void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
+  if (!SGM.M.getOptions().GenerateProfile)
+    return;
+
   auto &C = Builder.getASTContext();
 
   auto CounterIt = RegionCounterMap.find(Node);
-  assert(CounterIt != RegionCounterMap.end() &&
-         "cannot increment non-existent counter");
+  if (CounterIt == RegionCounterMap.end()) {
+    assert(EntryCountsOnly && "cannot increment non-existent counter");
+    return;
+  }
 
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
@@ -726,3 +758,12 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   Builder.createBuiltin(Loc, C.getIdentifier("int_instrprof_increment"),
                         SGM.Types.getEmptyTupleType(), {}, Args);
 }
+
+Optional<uint64_t> SILGenProfiling::getExecutionCount(ASTNode Node) const {
+  if (RegionCounts.empty())
+    return None;
+  auto CounterIt = RegionCounterMap.find(Node);
+  if (CounterIt == RegionCounterMap.end())
+    return None;
+  return RegionCounts[CounterIt->second];
+}
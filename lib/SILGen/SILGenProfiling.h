@@ -34,6 +34,7 @@ class SILGenProfiling {
 private:
   SILGenModule &SGM;
   bool EmitCoverageMapping;
+  bool EntryCountsOnly;
 
   // The current function's name and counter data.
   std::string CurrentFuncName;
@@ -43,18 +44,29 @@ private:
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The current function's counts in the profile being used, indexed like
+  /// its counters, or empty if there are none.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
-  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
+  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping,
+                  bool EntryCountsOnly)
       : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
-        NumRegionCounters(0), FunctionHash(0) {}
+        EntryCountsOnly(EntryCountsOnly), NumRegionCounters(0),
+        FunctionHash(0) {}
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
-  /// Emit SIL to increment the counter for \c Node.
+  /// Emit SIL to increment the counter for \c Node, if instrumenting and
+  /// \c Node has a counter.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
+  /// \returns how many times \c Node was executed in the profile being used,
+  /// or None if it has no count there.
+  Optional<uint64_t> getExecutionCount(ASTNode Node) const;
+
 private:
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(AbstractFunctionDecl *Root);
@@ -29,6 +29,12 @@ using ARCBBState = ARCSequenceDataflowEvaluator::ARCBBState;
 /// Merge in the state of the successor basic block. This is an intersection
 /// operation.
 void ARCBBState::mergeSuccBottomUp(ARCBBState &SuccBBState) {
+  // The intersection with nothing is nothing.
+  if (SuccBBState.PtrToBottomUpState.empty()) {
+    PtrToBottomUpState.clear();
+    return;
+  }
+
   // For each [(SILValue, BottomUpState)] that we are tracking...
   for (auto &Pair : getBottomupStates()) {
     if (!Pair.hasValue())
@@ -77,12 +83,21 @@ void ARCBBState::mergeSuccBottomUp(ARCBBState &SuccBBState) {
 /// Initialize this BB with the state of the successor basic block. This is
 /// called on a basic block's state and then any other successors states are
 /// merged in.
+///
+/// Values blotted in the successor are left behind, so that they aren't
+/// copied and skipped again in every block above it.
 void ARCBBState::initSuccBottomUp(ARCBBState &SuccBBState) {
-  PtrToBottomUpState = SuccBBState.PtrToBottomUpState;
+  PtrToBottomUpState.assignUnblotted(SuccBBState.PtrToBottomUpState);
 }
 
 /// Merge in the state of the predecessor basic block.
 void ARCBBState::mergePredTopDown(ARCBBState &PredBBState) {
+  // The intersection with nothing is nothing.
+  if (PredBBState.PtrToTopDownState.empty()) {
+    PtrToTopDownState.clear();
+    return;
+  }
+
   // For each [(SILValue, TopDownState)] that we are tracking...
   for (auto &Pair : getTopDownStates()) {
     if (!Pair.hasValue())
@@ -133,8 +148,11 @@ void ARCBBState::mergePredTopDown(ARCBBState &PredBBState) {
 /// Initialize the state for this BB with the state of its predecessor
 /// BB. Used to create an initial state before we merge in other
 /// predecessors.
+///
+/// Values blotted in the predecessor are left behind, so that they aren't
+/// copied and skipped again in every block below it.
 void ARCBBState::initPredTopDown(ARCBBState &PredBBState) {
-  PtrToTopDownState = PredBBState.PtrToTopDownState;
+  PtrToTopDownState.assignUnblotted(PredBBState.PtrToTopDownState);
 }
 
 //===----------------------------------------------------------------------===//
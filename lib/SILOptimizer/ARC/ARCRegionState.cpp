@@ -36,8 +36,11 @@ ARCRegionState::ARCRegionState(LoopRegion *R, bool AllowsLeaks)
 /// Initialize this Region with the state of the successor region. This is
 /// called on a region's state and then any other successors states are merged
 /// in.
+///
+/// Values blotted in the successor are left behind, so that they aren't
+/// copied and skipped again in every region above it.
 void ARCRegionState::initSuccBottomUp(ARCRegionState &SuccRegionState) {
-  PtrToBottomUpState = SuccRegionState.PtrToBottomUpState;
+  PtrToBottomUpState.assignUnblotted(SuccRegionState.PtrToBottomUpState);
 }
 
 /// Merge in the state of the successor basic block. Returns true if after the
@@ -47,6 +50,12 @@ void ARCRegionState::initSuccBottomUp(ARCRegionState &SuccRegionState) {
 ///
 /// This is an intersection operation.
 void ARCRegionState::mergeSuccBottomUp(ARCRegionState &SuccRegionState) {
+  // The intersection with nothing is nothing.
+  if (SuccRegionState.PtrToBottomUpState.empty()) {
+    PtrToBottomUpState.clear();
+    return;
+  }
+
   // Otherwise for each [(SILValue, BottomUpState)] that we are tracking...
   for (auto &Pair : getBottomupStates()) {
     if (!Pair.hasValue())
@@ -99,12 +108,21 @@ void ARCRegionState::mergeSuccBottomUp(ARCRegionState &SuccRegionState) {
 /// Initialize the state for this Region with the state of its predecessor
 /// Region. Used to create an initial state before we merge in other
 /// predecessors.
+///
+/// Values blotted in the predecessor are left behind, so that they aren't
+/// copied and skipped again in every region below it.
 void ARCRegionState::initPredTopDown(ARCRegionState &PredRegionState) {
-  PtrToTopDownState = PredRegionState.PtrToTopDownState;
+  PtrToTopDownState.assignUnblotted(PredRegionState.PtrToTopDownState);
 }
 
 /// Merge in the state of the predecessor basic block.
 void ARCRegionState::mergePredTopDown(ARCRegionState &PredRegionState) {
+  // The intersection with nothing is nothing.
+  if (PredRegionState.PtrToTopDownState.empty()) {
+    PtrToTopDownState.clear();
+    return;
+  }
+
   // For each [(SILValue, TopDownState)] that we are tracking...
   for (auto &Pair : getTopDownStates()) {
     if (!Pair.hasValue())
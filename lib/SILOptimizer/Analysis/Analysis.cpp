@@ -27,11 +27,25 @@
 
 using namespace swift;
 
+STATISTIC(NumInvalidatedResults,
+          "Number of cached function analysis results invalidated");
+STATISTIC(NumPreservedResults,
+          "Number of cached function analysis results kept across an "
+          "invalidation which didn't affect them");
+
 void SILAnalysis::verifyFunction(SILFunction *F) {
   // Only functions with bodies can be analyzed by the analysis.
   assert(F->isDefinition() && "Can't analyze external functions");
 }
 
+void SILAnalysis::countInvalidatedResults(unsigned N) {
+  NumInvalidatedResults += N;
+}
+
+void SILAnalysis::countPreservedResults(unsigned N) {
+  NumPreservedResults += N;
+}
+
 SILAnalysis *swift::createDominanceAnalysis(SILModule *) {
   return new DominanceAnalysis();
 }
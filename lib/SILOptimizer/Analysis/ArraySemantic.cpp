@@ -30,6 +30,15 @@ getSelfParameterConvention(ApplyInst *SemanticsCall) {
   return FnTy->getSelfParameter().getConvention();
 }
 
+/// Returns true if \p I is a call to swift_bufferDeallocateFromStack.
+static bool isBufferDeallocateFromStack(SILInstruction *I) {
+  auto *AI = dyn_cast<ApplyInst>(I);
+  if (!AI)
+    return false;
+  auto *Fn = AI->getReferencedFunction();
+  return Fn && Fn->getName() == "swift_bufferDeallocateFromStack";
+}
+
 /// \brief Make sure that all parameters are passed with a reference count
 /// neutral parameter convention except for self.
 bool swift::ArraySemanticsCall::isValidSignature() {
@@ -94,8 +103,15 @@ bool swift::ArraySemanticsCall::isValidSignature() {
           AllocFuncName != "swift_bufferAllocateOnStack")
         return false;
 
-      if (!hasOneNonDebugUse(AllocBufferAI))
-        return false;
+      // A buffer which was promoted to the stack is also used by the call to
+      // swift_bufferDeallocateFromStack at the end of its lifetime.
+      for (Operand *Use : getNonDebugUses(AllocBufferAI)) {
+        if (Use->getUser() == SemanticsCall)
+          continue;
+        if (AllocFuncName != "swift_bufferAllocateOnStack" ||
+            !isBufferDeallocateFromStack(Use->getUser()))
+          return false;
+      }
     }
     return true;
   }
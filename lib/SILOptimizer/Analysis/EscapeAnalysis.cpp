@@ -17,11 +17,24 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumGraphsDropped, "Number of dropped connection graphs");
+STATISTIC(NumGraphsRebuilt, "Number of rebuilt dropped connection graphs");
+
+/// The number of functions for which complete connection graphs are kept.
+/// For all other functions only the (much smaller) summary graphs are kept.
+/// Zero means that no connection graphs are dropped.
+static llvm::cl::opt<unsigned> MaxKeptConnectionGraphs(
+    "escape-analysis-max-kept-graphs", llvm::cl::init(8),
+    llvm::cl::desc("Maximum number of complete connection graphs kept by "
+                   "the escape analysis"));
+
 static bool isProjection(ValueBase *V) {
   switch (V->getKind()) {
     case ValueKind::IndexAddrInst:
@@ -79,6 +92,14 @@ void EscapeAnalysis::ConnectionGraph::clear() {
   assert(ToMerge.empty());
 }
 
+void EscapeAnalysis::ConnectionGraph::releaseMemory() {
+  clear();
+  // clear() keeps the allocated storage of the containers for re-use.
+  decltype(Values2Nodes)().swap(Values2Nodes);
+  decltype(Nodes)().swap(Nodes);
+  decltype(UsePoints)().swap(UsePoints);
+}
+
 EscapeAnalysis::CGNode *EscapeAnalysis::ConnectionGraph::
 getNode(ValueBase *V, EscapeAnalysis *EA, bool createIfNeeded) {
   if (isa<FunctionRefInst>(V))
@@ -1226,9 +1247,14 @@ void EscapeAnalysis::analyzeInstruction(SILInstruction *I,
     }
 
     if (auto *Fn = FAS.getReferencedFunction()) {
-      if (Fn->getName() == "swift_bufferAllocate")
+      if (Fn->getName() == "swift_bufferAllocate" ||
+          Fn->getName() == "swift_bufferAllocateOnStack")
         // The call is a buffer allocation, e.g. for Array.
         return;
+      if (Fn->getName() == "swift_bufferDeallocateFromStack")
+        // Like a dealloc_stack, the end of a stack promoted buffer's lifetime
+        // doesn't have any effect on escaping.
+        return;
     }
   }
   if (isProjection(I))
@@ -1498,6 +1524,16 @@ void EscapeAnalysis::setAllEscaping(SILInstruction *I,
 }
 
 void EscapeAnalysis::recompute(FunctionInfo *Initial) {
+  if (Initial->isValid() && Initial->GraphIsDropped) {
+    // Only the connection graph of Initial is needed. Rebuilding it yields a
+    // summary graph which is still valid for the callers, so we don't have
+    // to invalidate them.
+    DEBUG(llvm::dbgs() << "rebuild dropped graph for " <<
+          Initial->Graph.F->getName() << '\n');
+    invalidateWithoutCallers(Initial);
+    ++NumGraphsRebuilt;
+  }
+
   allocNewUpdateID();
 
   DEBUG(llvm::dbgs() << "recompute escape analysis with UpdateID " <<
@@ -1580,13 +1616,47 @@ void EscapeAnalysis::recompute(FunctionInfo *Initial) {
 
   for (FunctionInfo *FInfo : BottomUpOrder) {
     if (BottomUpOrder.wasRecomputedWithCurrentUpdateID(FInfo)) {
-      FInfo->Graph.computeUsePoints();
       FInfo->Graph.verify();
       FInfo->SummaryGraph.verify();
+      // For callees only the summary graph was needed.
+      if (FInfo != Initial && MaxKeptConnectionGraphs != 0) {
+        dropGraph(FInfo);
+        continue;
+      }
+      FInfo->Graph.computeUsePoints();
     }
   }
 }
 
+void EscapeAnalysis::dropGraph(FunctionInfo *FInfo) {
+  if (!FInfo->isValid() || FInfo->GraphIsDropped)
+    return;
+
+  DEBUG(llvm::dbgs() << "  drop graph for " << FInfo->Graph.F->getName() <<
+        '\n');
+  FInfo->Graph.releaseMemory();
+  FInfo->GraphIsDropped = true;
+  ++NumGraphsDropped;
+}
+
+void EscapeAnalysis::markGraphAsUsed(FunctionInfo *FInfo) {
+  if (MaxKeptConnectionGraphs == 0)
+    return;
+  if (!RecentlyUsedGraphs.empty() && RecentlyUsedGraphs.back() == FInfo)
+    return;
+
+  auto Iter = std::find(RecentlyUsedGraphs.begin(), RecentlyUsedGraphs.end(),
+                        FInfo);
+  if (Iter != RecentlyUsedGraphs.end())
+    RecentlyUsedGraphs.erase(Iter);
+  RecentlyUsedGraphs.push_back(FInfo);
+
+  if (RecentlyUsedGraphs.size() > MaxKeptConnectionGraphs) {
+    dropGraph(RecentlyUsedGraphs.front());
+    RecentlyUsedGraphs.erase(RecentlyUsedGraphs.begin());
+  }
+}
+
 bool EscapeAnalysis::mergeCalleeGraph(FullApplySite FAS,
                                       ConnectionGraph *CallerGraph,
                                       ConnectionGraph *CalleeGraph) {
@@ -1839,6 +1909,7 @@ bool EscapeAnalysis::canParameterEscape(FullApplySite FAS, int ParamIdx,
 
 void EscapeAnalysis::invalidate(InvalidationKind K) {
   Function2Info.clear();
+  RecentlyUsedGraphs.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
 }
@@ -16,6 +16,7 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILModule.h"
 
 using namespace swift;
 
@@ -46,6 +47,31 @@ FunctionEffects::getMemBehavior(RetainObserveKind ScanKind) const {
   return Behavior;
 }
 
+SILFunctionEffectsSummary FunctionEffects::getSummary() const {
+  SILFunctionEffectsSummary Summary;
+  Summary.GlobalEffects = GlobalEffects.getSummary();
+  if (AllocsObjects)
+    Summary.GlobalEffects |= SILFunctionEffectsSummary::AllocsObjects;
+  if (Traps)
+    Summary.GlobalEffects |= SILFunctionEffectsSummary::Traps;
+  if (ReadsRC)
+    Summary.GlobalEffects |= SILFunctionEffectsSummary::ReadsRC;
+  for (const Effects &E : ParamEffects)
+    Summary.ArgumentEffects.push_back(E.getSummary());
+  return Summary;
+}
+
+void FunctionEffects::setFromSummary(const SILFunctionEffectsSummary &Summary) {
+  GlobalEffects.setFromSummary(Summary.GlobalEffects);
+  AllocsObjects =
+      (Summary.GlobalEffects & SILFunctionEffectsSummary::AllocsObjects) != 0;
+  Traps = (Summary.GlobalEffects & SILFunctionEffectsSummary::Traps) != 0;
+  ReadsRC = (Summary.GlobalEffects & SILFunctionEffectsSummary::ReadsRC) != 0;
+  ParamEffects.resize(Summary.ArgumentEffects.size());
+  for (unsigned Idx = 0, E = ParamEffects.size(); Idx < E; ++Idx)
+    ParamEffects[Idx].setFromSummary(Summary.ArgumentEffects[Idx]);
+}
+
 bool FunctionEffects::mergeFrom(const FunctionEffects &RHS) {
   bool Changed = mergeFlags(RHS);
   Changed |= GlobalEffects.mergeFrom(RHS.GlobalEffects);
@@ -171,6 +197,23 @@ bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
   return false;
 }
 
+bool SideEffectAnalysis::getSummarizedEffects(FunctionEffects &Effects,
+                                              SILFunction *F) {
+  const SILFunctionEffectsSummary *Summary =
+      F->getModule().lookUpEffectsSummary(F);
+  if (!Summary)
+    return false;
+
+  // The summary describes the arguments of the function's body. Don't use it
+  // if they don't match the function's type here.
+  if (Summary->ArgumentEffects.size() !=
+      F->getLoweredFunctionType()->getNumSILArguments())
+    return false;
+
+  Effects.setFromSummary(*Summary);
+  return true;
+}
+
 bool SideEffectAnalysis::getSemanticEffects(FunctionEffects &FE,
                                             ArraySemanticsCall ASC) {
   assert(ASC.hasSelf());
@@ -256,7 +299,13 @@ void SideEffectAnalysis::analyzeFunction(FunctionInfo *FInfo,
   }
   
   if (!FInfo->F->isDefinition()) {
-    // We can't assume anything about external functions.
+    // Use what the module defining the function found out about its body.
+    if (getSummarizedEffects(FInfo->FE, FInfo->F)) {
+      DEBUG(llvm::dbgs() << "  -- has summarized effects " <<
+            FInfo->F->getName() << '\n');
+      return;
+    }
+    // Otherwise we can't assume anything about external functions.
     DEBUG(llvm::dbgs() << "  -- is external " << FInfo->F->getName() << '\n');
     FInfo->FE.setWorstEffects();
     return;
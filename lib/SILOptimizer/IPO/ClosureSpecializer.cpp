@@ -52,6 +52,12 @@
 /// 3. Handling addresses. We currently do not handle address types. We can in
 ///    the future by introducing alloc_stacks.
 ///
+/// 4. Closures which are only forwarded by the callee to another function which
+///    invokes them. We specialize the callee if the closure reaches an apply
+///    within a bounded number of forwarding calls. The specialized callee then
+///    creates the closure itself and forwards it, so we specialize the
+///    specialized callee again, until the closure is directly invoked.
+///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "closure-specialization"
@@ -86,6 +92,16 @@ llvm::cl::opt<bool> EliminateDeadClosures(
     llvm::cl::desc("Do not eliminate dead closures after closure "
                    "specialization. This is meant ot be used when testing."));
 
+static llvm::cl::opt<unsigned> MaxForwardingDepth(
+    "closure-specialize-max-forwarding-depth", llvm::cl::init(3),
+    llvm::cl::desc("The maximum number of calls a closure is forwarded "
+                   "through before it is invoked"));
+
+static llvm::cl::opt<unsigned> MaxForwarderSize(
+    "closure-specialize-max-forwarder-size", llvm::cl::init(100),
+    llvm::cl::desc("The maximum number of instructions of a function which "
+                   "forwards a closure to be specialized"));
+
 //===----------------------------------------------------------------------===//
 //                                  Utility
 //===----------------------------------------------------------------------===//
@@ -94,6 +110,57 @@ static bool isSupportedClosureKind(const SILInstruction *I) {
   return isa<ThinToThickFunctionInst>(I) || isa<PartialApplyInst>(I);
 }
 
+/// Returns true if \p F has more than \p Limit instructions.
+static bool isLargerThan(SILFunction *F, unsigned Limit) {
+  unsigned Size = 0;
+  for (auto &BB : *F) {
+    Size += std::distance(BB.begin(), BB.end());
+    if (Size > Limit)
+      return true;
+  }
+  return false;
+}
+
+/// Returns the number of calls the closure argument \p ArgIndex of \p Callee
+/// is forwarded through until it is applied, i.e. 0 if \p Callee applies the
+/// closure itself. Returns None if the closure is not applied within
+/// \p MaxDepth forwarding calls.
+static Optional<unsigned> getClosureApplyDepth(SILFunction *Callee,
+                                               unsigned ArgIndex,
+                                               unsigned MaxDepth) {
+  SILValue Arg = Callee->getArgument(ArgIndex);
+  if (std::any_of(Arg->use_begin(), Arg->use_end(),
+                  [&Arg](Operand *Op) -> bool {
+                    auto UserAI = FullApplySite::isa(Op->getUser());
+                    return UserAI && UserAI.getCallee() == Arg;
+                  })) {
+    return 0;
+  }
+
+  // Forwarding functions are cloned, so don't let them be arbitrarily large.
+  if (MaxDepth == 0 || isLargerThan(Callee, MaxForwarderSize))
+    return None;
+
+  for (Operand *Op : Arg->getUses()) {
+    auto UserAI = FullApplySite::isa(Op->getUser());
+    if (!UserAI || UserAI.hasSubstitutions() || UserAI.getCallee() == Arg)
+      continue;
+
+    SILFunction *NextCallee = UserAI.getReferencedFunction();
+    if (!NextCallee || NextCallee == Callee ||
+        NextCallee->isExternalDeclaration())
+      continue;
+
+    for (unsigned i = 0, e = UserAI.getNumArguments(); i != e; ++i) {
+      if (UserAI.getArgument(i) != Arg)
+        continue;
+      if (auto Depth = getClosureApplyDepth(NextCallee, i, MaxDepth - 1))
+        return Depth.getValue() + 1;
+    }
+  }
+  return None;
+}
+
 //===----------------------------------------------------------------------===//
 //                       Closure Spec Cloner Interface
 //===----------------------------------------------------------------------===//
@@ -151,6 +218,10 @@ class CallSiteDescriptor {
   unsigned ClosureIndex;
   SILParameterInfo ClosureParamInfo;
 
+  /// True if the callee does not invoke the closure itself but forwards it to
+  /// another function.
+  bool IsForwarded;
+
   // This is only needed if we have guaranteed parameters. In most cases it will
   // have only one element, a return inst.
   llvm::TinyPtrVector<SILBasicBlock *> NonFailureExitBBs;
@@ -158,9 +229,10 @@ class CallSiteDescriptor {
 public:
   CallSiteDescriptor(ClosureInfo *CInfo, FullApplySite AI,
                      unsigned ClosureIndex, SILParameterInfo ClosureParamInfo,
+                     bool IsForwarded,
                      llvm::TinyPtrVector<SILBasicBlock *> &&NonFailureExitBBs)
     : CInfo(CInfo), AI(AI), ClosureIndex(ClosureIndex),
-      ClosureParamInfo(ClosureParamInfo),
+      ClosureParamInfo(ClosureParamInfo), IsForwarded(IsForwarded),
       NonFailureExitBBs(NonFailureExitBBs) {}
 
   CallSiteDescriptor(CallSiteDescriptor&&) =default;
@@ -186,6 +258,8 @@ public:
 
   SILParameterInfo getClosureParameterInfo() const { return ClosureParamInfo; }
 
+  bool isClosureForwarded() const { return IsForwarded; }
+
   SILInstruction *
   createNewClosure(SILBuilder &B, SILValue V,
                    llvm::SmallVectorImpl<SILValue> &Args) const {
@@ -426,8 +500,11 @@ void CallSiteDescriptor::extendArgumentLifetime(SILValue Arg) const {
   }
 }
 
-static void specializeClosure(ClosureInfo &CInfo,
-                              CallSiteDescriptor &CallDesc) {
+/// Specializes the callee of \p CallDesc and rewrites the call. Returns the
+/// specialized function if it was newly created and null if an existing
+/// specialization was reused.
+static SILFunction *specializeClosure(ClosureInfo &CInfo,
+                                      CallSiteDescriptor &CallDesc) {
   auto NewFName = CallDesc.createName();
   DEBUG(llvm::dbgs() << "    Perform optimizations with new name " << NewFName
                      << '\n');
@@ -435,14 +512,16 @@ static void specializeClosure(ClosureInfo &CInfo,
   // Then see if we already have a specialized version of this function in our
   // module.
   SILFunction *NewF = CInfo.Closure->getModule().lookUpFunction(NewFName);
+  SILFunction *CreatedF = nullptr;
 
   // If not, create a specialized version of ApplyCallee calling the closure
   // directly.
   if (!NewF)
-    NewF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
+    NewF = CreatedF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
 
   // Rewrite the call
   rewriteApplyInst(CallDesc, NewF);
+  return CreatedF;
 }
 
 static bool isSupportedClosure(const SILInstruction *Closure) {
@@ -695,13 +774,22 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// Newly specialized functions which forward the closure they now create
+  /// themselves, together with the number of forwarding calls still allowed
+  /// below them.
+  llvm::SmallVector<std::pair<SILFunction *, unsigned>, 8> ForwardingFunctions;
+
 public:
   ClosureSpecializer() = default;
 
-  void gatherCallSites(SILFunction *Caller,
+  void gatherCallSites(SILFunction *Caller, unsigned MaxDepth,
                        llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
-  bool specialize(SILFunction *Caller);
+  bool specialize(SILFunction *Caller, unsigned MaxDepth);
+
+  /// Specializes the closures which are forwarded by functions created by
+  /// this specializer.
+  bool specializeForwardedClosures();
 
   ArrayRef<SILInstruction *> getPropagatedClosures() {
     if (IsPropagatedClosuresUniqued)
@@ -717,7 +805,7 @@ public:
 } // end anonymous namespace
 
 void ClosureSpecializer::gatherCallSites(
-    SILFunction *Caller,
+    SILFunction *Caller, unsigned MaxDepth,
     llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
     llvm::DenseSet<FullApplySite> &MultipleClosureAI) {
 
@@ -777,20 +865,18 @@ void ClosureSpecializer::gatherCallSites(
         if (!ClosureIndex.hasValue())
           continue;
 
-        // Make sure that the Closure is invoked in the Apply's callee. We only
-        // want to perform closure specialization if we know that we will be
-        // able to change a partial_apply into an apply.
+        // Make sure that the Closure is invoked in the Apply's callee, or in a
+        // function the callee forwards it to. We only want to perform closure
+        // specialization if we know that we will be able to change a
+        // partial_apply into an apply.
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
-        SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        auto ApplyDepth = getClosureApplyDepth(ApplyCallee,
+                                               ClosureIndex.getValue(),
+                                               MaxDepth);
+        if (!ApplyDepth.hasValue())
           continue;
-        }
 
         auto NumIndirectResults =
           AI.getSubstCalleeType()->getNumIndirectResults();
@@ -824,7 +910,8 @@ void ClosureSpecializer::gatherCallSites(
         // call site list.
         CInfo->CallSites.push_back(
           CallSiteDescriptor(CInfo, AI, ClosureIndex.getValue(),
-                             ClosureParamInfo, std::move(NonFailureExitBBs)));
+                             ClosureParamInfo, ApplyDepth.getValue() != 0,
+                             std::move(NonFailureExitBBs)));
       }
       if (CInfo)
         ClosureCandidates.push_back(CInfo);
@@ -832,7 +919,7 @@ void ClosureSpecializer::gatherCallSites(
   }
 }
 
-bool ClosureSpecializer::specialize(SILFunction *Caller) {
+bool ClosureSpecializer::specialize(SILFunction *Caller, unsigned MaxDepth) {
   DEBUG(llvm::dbgs() << "Optimizing callsites that take closure argument in "
                      << Caller->getName() << '\n');
 
@@ -840,7 +927,7 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
   // ApplyInsts. Check the profitability of specializing the closure argument.
   llvm::SmallVector<ClosureInfo*, 8> ClosureCandidates;
   llvm::DenseSet<FullApplySite> MultipleClosureAI;
-  gatherCallSites(Caller, ClosureCandidates, MultipleClosureAI);
+  gatherCallSites(Caller, MaxDepth, ClosureCandidates, MultipleClosureAI);
 
   bool Changed = false;
   for (auto *CInfo : ClosureCandidates) {
@@ -850,15 +937,29 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
       if (MultipleClosureAI.count(CSDesc.getApplyInst()))
         continue;
 
-      specializeClosure(*CInfo, CSDesc);
+      SILFunction *NewF = specializeClosure(*CInfo, CSDesc);
       PropagatedClosures.push_back(CSDesc.getClosure());
       Changed = true;
+
+      // The specialized function now creates the closure and forwards it. An
+      // existing specialization was already handled when it was created.
+      if (NewF && CSDesc.isClosureForwarded())
+        ForwardingFunctions.push_back({NewF, MaxDepth - 1});
     }
     delete CInfo;
   }
   return Changed;
 }
 
+bool ClosureSpecializer::specializeForwardedClosures() {
+  bool Changed = false;
+  while (!ForwardingFunctions.empty()) {
+    auto Entry = ForwardingFunctions.pop_back_val();
+    Changed |= specialize(Entry.first, Entry.second);
+  }
+  return Changed;
+}
+
 //===----------------------------------------------------------------------===//
 //                               Top Level Code
 //===----------------------------------------------------------------------===//
@@ -888,9 +989,12 @@ public:
       if (F->isExternalDeclaration())
         continue;
 
-      Changed |= C.specialize(F);
+      Changed |= C.specialize(F, MaxForwardingDepth);
     }
 
+    // Specialize the functions we created which forward a closure.
+    Changed |= C.specializeForwardedClosures();
+
     // Invalidate everything since we delete calls as well as add new
     // calls and branches.
     if (Changed) {
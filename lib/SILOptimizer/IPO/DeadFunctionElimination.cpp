@@ -25,6 +25,9 @@ using namespace swift;
 
 STATISTIC(NumDeadFunc, "Number of dead functions eliminated");
 STATISTIC(NumEliminatedExternalDefs, "Number of external function definitions eliminated");
+STATISTIC(NumUnusedDeserializedBodies,
+          "Number of deserialized function bodies eliminated without being "
+          "inlined or specialized");
 
 namespace {
 
@@ -414,6 +417,8 @@ public:
       if (!isAlive(F)) {
         DEBUG(llvm::dbgs() << "  erase dead function " << F->getName() << "\n");
         NumDeadFunc++;
+        if (F->isDefinition() && F->isAvailableExternally())
+          NumUnusedDeserializedBodies++;
         DFEPass->invalidateAnalysisForDeadFunction(F,
                                      SILAnalysis::InvalidationKind::Everything);
         Module->eraseFunction(F);
@@ -493,6 +498,7 @@ class ExternalFunctionDefinitionsElimination : FunctionLivenessComputation {
     assert(F->isExternalDeclaration() &&
            "Function should be an external declaration");
     NumEliminatedExternalDefs++;
+    NumUnusedDeserializedBodies++;
     return true;
   }
 
@@ -25,16 +25,38 @@
 ///
 /// TODO: We have not determined whether to support inexact type checks. It
 /// will be a tradeoff between utility of the attribute vs. cost of the check.
+///
+/// A list of further specializations can be given with -prespecialize-list,
+/// e.g. the generic functions most often used with the same types in a
+/// profile. Each line of the list names a generic function by its mangled
+/// name, followed by the module-qualified names of the non-generic nominal
+/// types to substitute for its generic parameters:
+///
+///   # Array<Int>.append
+///   _TFSa6appendfxT_ Swift.Int
+///
+/// Entries for functions which are not defined in the module are ignored, so
+/// that one list can serve several modules. The listed specializations are
+/// also made public, for non-optimized clients to use instead of the generic
+/// function (see UsePrespecialized).
 
 #define DEBUG_TYPE "eager-specializer"
+#include "swift/AST/DiagnosticsSIL.h"
+#include "swift/Basic/Range.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace swift;
 using llvm::dbgs;
 
+STATISTIC(NumListedSpecializations,
+          "Number of specializations created from the prespecialization list");
+
 // Temporary flag.
 llvm::cl::opt<bool> EagerSpecializeFlag(
     "enable-eager-specializer", llvm::cl::init(true),
@@ -409,6 +431,153 @@ emitArgumentConversion(SmallVectorImpl<SILValue> &CallArgs) {
   return StoreResultTo;
 }
 
+//===----------------------------------------------------------------------===//
+//                          Prespecialization List
+//===----------------------------------------------------------------------===//
+
+/// Returns the type named \p Name, the module-qualified name of a non-generic
+/// nominal type, or a null type if there is no such type.
+static Type resolveListedType(ASTContext &Ctx, StringRef Name) {
+  StringRef ModuleName, TypeName;
+  std::tie(ModuleName, TypeName) = Name.split('.');
+  if (ModuleName.empty() || TypeName.empty())
+    return Type();
+
+  ModuleDecl *M = Ctx.getLoadedModule(Ctx.getIdentifier(ModuleName));
+  if (!M)
+    return Type();
+  SmallVector<ValueDecl *, 2> Results;
+  M->lookupValue({}, Ctx.getIdentifier(TypeName), NLKind::QualifiedLookup,
+                 Results);
+  if (Results.size() != 1)
+    return Type();
+  auto *NTD = dyn_cast<NominalTypeDecl>(Results[0]);
+  if (!NTD || NTD->getGenericParams())
+    return Type();
+  return NTD->getDeclaredType();
+}
+
+/// Computes the substitutions of \p Types for the generic parameters of
+/// \p F.
+///
+/// This walks the generic signature's requirements like the type checker does
+/// for @_specialize, but looks up the conformances in the type checked module.
+///
+/// \returns false if \p Types don't meet the requirements.
+static bool getListedSubstitutions(SILFunction *F, ArrayRef<Type> Types,
+                                   SmallVectorImpl<Substitution> &Subs) {
+  GenericSignature *Sig = F->getLoweredFunctionType()->getGenericSignature();
+  if (!Sig || Sig->getGenericParams().size() != Types.size())
+    return false;
+
+  ASTContext &Ctx = F->getASTContext();
+  ModuleDecl *SwiftModule = F->getModule().getSwiftModule();
+  TypeSubstitutionMap SubMap;
+  for (unsigned i : indices(Types))
+    SubMap[Sig->getGenericParams()[i]->getCanonicalType().getPointer()] =
+        Types[i];
+
+  Type Replacement;
+  SmallVector<ProtocolConformanceRef, 4> Conformances;
+  auto flushConformances = [&] {
+    if (Replacement)
+      Subs.push_back({Replacement, Ctx.AllocateCopy(Conformances)});
+    Conformances.clear();
+  };
+  for (const auto &Req : Sig->getRequirements()) {
+    switch (Req.getKind()) {
+    case RequirementKind::WitnessMarker:
+      // Each witness marker starts a new substitution.
+      flushConformances();
+      Replacement = Req.getFirstType().subst(SwiftModule, SubMap, None);
+      if (!Replacement || Replacement->is<ErrorType>())
+        return false;
+      break;
+
+    case RequirementKind::Conformance: {
+      auto *Proto = Req.getSecondType()->castTo<ProtocolType>()->getDecl();
+      auto Conformance =
+          SwiftModule->lookupConformance(Replacement, Proto, nullptr);
+      if (!Conformance)
+        return false;
+      Conformances.push_back(*Conformance);
+      break;
+    }
+
+    case RequirementKind::Superclass: {
+      Type FirstTy = Req.getFirstType().subst(SwiftModule, SubMap, None);
+      Type SuperTy = Req.getSecondType().subst(SwiftModule, SubMap, None);
+      if (!FirstTy || !SuperTy ||
+          !SuperTy->isExactSuperclassOf(FirstTy, nullptr))
+        return false;
+      break;
+    }
+
+    case RequirementKind::SameType: {
+      Type FirstTy = Req.getFirstType().subst(SwiftModule, SubMap, None);
+      Type SameTy = Req.getSecondType().subst(SwiftModule, SubMap, None);
+      if (!FirstTy || !SameTy || !FirstTy->isEqual(SameTy))
+        return false;
+      break;
+    }
+    }
+  }
+  flushConformances();
+  return true;
+}
+
+/// Adds a specialize attribute for each entry of the prespecialization list
+/// to the function it names, and collects them in \p ListedAttrs.
+static void addListedSpecializeAttrs(
+    SILModule &M, llvm::SmallPtrSetImpl<SILSpecializeAttr *> &ListedAttrs) {
+  StringRef Filename = M.getOptions().PrespecializationListFilename;
+  ASTContext &Ctx = M.getASTContext();
+  auto Buffer = llvm::MemoryBuffer::getFile(Filename);
+  if (!Buffer) {
+    Ctx.Diags.diagnose(SourceLoc(), diag::prespecialize_list_unreadable,
+                       Filename, Buffer.getError().message());
+    return;
+  }
+
+  SmallVector<StringRef, 64> Lines;
+  Buffer.get()->getBuffer().split(Lines, "\n", /*MaxSplit=*/-1,
+                                  /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+
+    SmallVector<StringRef, 4> Fields;
+    Line.split(Fields, " ", /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    SILFunction *F = M.lookUpFunction(Fields.front());
+    if (!F || F->isExternalDeclaration() || F->isAvailableExternally())
+      continue;
+
+    SmallVector<Type, 4> Types;
+    for (StringRef TypeName : llvm::makeArrayRef(Fields).slice(1)) {
+      Type T = resolveListedType(Ctx, TypeName);
+      if (!T) {
+        Ctx.Diags.diagnose(SourceLoc(), diag::prespecialize_list_unknown_type,
+                           F->getName(), TypeName);
+        break;
+      }
+      Types.push_back(T);
+    }
+    if (Types.size() != Fields.size() - 1)
+      continue;
+
+    SmallVector<Substitution, 4> Subs;
+    if (!getListedSubstitutions(F, Types, Subs)) {
+      Ctx.Diags.diagnose(SourceLoc(), diag::prespecialize_list_bad_types,
+                         F->getName());
+      continue;
+    }
+    auto *SA = SILSpecializeAttr::create(M, Subs);
+    F->addSpecializeAttr(SA);
+    ListedAttrs.insert(SA);
+  }
+}
+
 namespace {
 // FIXME: This should be a function transform that pushes cloned functions on
 // the pass manager worklist.
@@ -456,6 +625,10 @@ static SILFunction *eagerSpecialize(SILFunction *GenericFunc,
 void EagerSpecializerTransform::run() {
   if (!EagerSpecializeFlag)
     return;
+
+  llvm::SmallPtrSet<SILSpecializeAttr *, 16> ListedAttrs;
+  if (!getOptions().PrespecializationListFilename.empty())
+    addListedSpecializeAttrs(*getModule(), ListedAttrs);
   
   // Process functions in any order.
   bool Changed = false;
@@ -487,6 +660,11 @@ void EagerSpecializerTransform::run() {
       if (NewFunc) {
         Changed = true;
         EagerDispatch(&F, *SA, ReInfo).emitDispatchTo(NewFunc);
+        // Dead function elimination makes it public.
+        if (ListedAttrs.count(SA)) {
+          NewFunc->setKeepAsPublic(true);
+          NumListedSpecializations++;
+        }
       }
     });
     // As specializations are created, the attributes should be removed.
@@ -12,6 +12,7 @@
 
 #define DEBUG_TYPE "globalopt"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Range.h"
 #include "swift/SIL/CFG.h"
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SIL/SILInstruction.h"
@@ -22,11 +23,17 @@
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "swift/AST/Mangle.h"
 using namespace swift;
 
+STATISTIC(NumGlobalsStaticallyInitialized,
+          "Number of globals statically initialized");
+STATISTIC(NumInitializersFolded,
+          "Number of global initializers folded into a single constant");
+
 namespace {
 /// Optimize the placement of global initializers.
 ///
@@ -669,6 +676,217 @@ replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
   SILG->setInitializer(InitF);
 }
 
+namespace {
+/// The value a globalinit_func stores into its global, assembled from stores
+/// to the whole global and to its fields.
+struct InitializerValue {
+  /// The stored value, if it is known as a whole.
+  SILValue Val;
+  /// Otherwise the values of the fields, some of which may not be stored.
+  SmallVector<std::unique_ptr<InitializerValue>, 4> Fields;
+};
+} // end anonymous namespace
+
+/// Returns the number of fields of \p Ty, or 0 if it is not a struct or tuple.
+static unsigned getNumFields(SILType Ty) {
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    unsigned NumFields = 0;
+    for (auto *Field : SD->getStoredProperties()) {
+      (void) Field;
+      ++NumFields;
+    }
+    return NumFields;
+  }
+  if (auto TT = Ty.getAs<TupleType>())
+    return TT->getNumElements();
+  return 0;
+}
+
+/// Returns the type of field \p FieldNo of the struct or tuple type \p Ty.
+static SILType getFieldType(SILType Ty, unsigned FieldNo, SILModule &M) {
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    for (auto *Field : SD->getStoredProperties()) {
+      if (FieldNo-- == 0)
+        return Ty.getFieldType(Field, M);
+    }
+    llvm_unreachable("field number out of range");
+  }
+  return Ty.getTupleElementType(FieldNo);
+}
+
+/// Returns true if \p V is a literal or a struct or tuple of literals, which
+/// IRGen can emit as a constant.
+static bool isConstantInitValue(SILValue V) {
+  if (isa<IntegerLiteralInst>(V) || isa<FloatLiteralInst>(V))
+    return true;
+  if (auto *SL = dyn_cast<StringLiteralInst>(V))
+    return SL->getEncoding() != StringLiteralInst::Encoding::ObjCSelector;
+  if (!isa<StructInst>(V) && !isa<TupleInst>(V))
+    return false;
+  for (auto &Op : cast<SILInstruction>(V)->getAllOperands())
+    if (!isConstantInitValue(Op.get()))
+      return false;
+  return true;
+}
+
+/// Record the store of \p V to the field at \p Path in \p Node, which has
+/// type \p Ty.
+static bool storeInitValue(InitializerValue &Node, SILType Ty,
+                           ArrayRef<unsigned> Path, SILValue V, SILModule &M) {
+  if (Path.empty()) {
+    Node.Val = V;
+    Node.Fields.clear();
+    return true;
+  }
+
+  if (Node.Fields.empty()) {
+    unsigned NumFields = getNumFields(Ty);
+    if (NumFields == 0)
+      return false;
+    for (unsigned i = 0; i < NumFields; ++i)
+      Node.Fields.push_back(llvm::make_unique<InitializerValue>());
+
+    // A value stored as a whole before is split up into its fields.
+    if (Node.Val) {
+      auto *Aggregate = cast<SILInstruction>(Node.Val);
+      for (unsigned i = 0; i < NumFields; ++i)
+        Node.Fields[i]->Val = Aggregate->getOperand(i);
+      Node.Val = SILValue();
+    }
+  }
+  return storeInitValue(*Node.Fields[Path.front()],
+                        getFieldType(Ty, Path.front(), M), Path.slice(1), V, M);
+}
+
+/// Returns true if every field of \p Node was stored.
+static bool isCompletelyInitialized(const InitializerValue &Node) {
+  if (Node.Val)
+    return true;
+  if (Node.Fields.empty())
+    return false;
+  for (auto &Field : Node.Fields)
+    if (!isCompletelyInitialized(*Field))
+      return false;
+  return true;
+}
+
+/// Build the value of \p Node, which has type \p Ty, out of the stored
+/// values.
+static SILValue emitInitValue(const InitializerValue &Node, SILType Ty,
+                              SILBuilder &B, SILLocation Loc) {
+  if (Node.Val)
+    return Node.Val;
+
+  SmallVector<SILValue, 4> Elements;
+  for (unsigned i = 0, e = Node.Fields.size(); i < e; ++i)
+    Elements.push_back(emitInitValue(*Node.Fields[i],
+                                     getFieldType(Ty, i, B.getModule()),
+                                     B, Loc));
+  if (Ty.getStructOrBoundGenericStruct())
+    return B.createStruct(Loc, Ty, Elements);
+  return B.createTuple(Loc, Ty, Elements);
+}
+
+/// Rewrite the globalinit_func \p InitF, which stores constants to the global
+/// field by field, into a single store of a constant struct or tuple, so that
+/// it can be used as a static initializer. Returns true if \p InitF was
+/// rewritten.
+static bool foldStaticInitializer(SILFunction *InitF) {
+  // We only handle a single SILBasicBlock for now.
+  if (InitF->size() != 1)
+    return false;
+
+  SILModule &M = InitF->getModule();
+  SILBasicBlock *BB = &InitF->front();
+  GlobalAddrInst *GAI = nullptr;
+  ReturnInst *Ret = nullptr;
+  InitializerValue Value;
+  // The field path from the global to each address derived from it.
+  llvm::DenseMap<SILValue, SmallVector<unsigned, 4>> Paths;
+  SmallVector<SILInstruction *, 8> ToErase;
+
+  for (auto &I : *BB) {
+    if (isa<AllocGlobalInst>(&I) || isa<IntegerLiteralInst>(&I) ||
+        isa<FloatLiteralInst>(&I) || isa<StructInst>(&I) ||
+        isa<TupleInst>(&I))
+      continue;
+
+    if (auto *SL = dyn_cast<StringLiteralInst>(&I)) {
+      if (SL->getEncoding() == StringLiteralInst::Encoding::ObjCSelector)
+        return false;
+      continue;
+    }
+
+    if (isa<DebugValueInst>(&I) || isa<DebugValueAddrInst>(&I)) {
+      ToErase.push_back(&I);
+      continue;
+    }
+
+    if (auto *G = dyn_cast<GlobalAddrInst>(&I)) {
+      if (GAI)
+        return false;
+      GAI = G;
+      Paths[G];
+      continue;
+    }
+
+    if (isa<StructElementAddrInst>(&I) || isa<TupleElementAddrInst>(&I)) {
+      auto Base = Paths.find(I.getOperand(0));
+      if (Base == Paths.end())
+        return false;
+      SmallVector<unsigned, 4> Path = Base->second;
+      if (auto *SEAI = dyn_cast<StructElementAddrInst>(&I))
+        Path.push_back(SEAI->getFieldNo());
+      else
+        Path.push_back(cast<TupleElementAddrInst>(&I)->getFieldNo());
+      Paths[&I] = Path;
+      ToErase.push_back(&I);
+      continue;
+    }
+
+    if (auto *SI = dyn_cast<StoreInst>(&I)) {
+      auto Dest = Paths.find(SI->getDest());
+      if (Dest == Paths.end() || !isConstantInitValue(SI->getSrc()) ||
+          !storeInitValue(Value, GAI->getType().getObjectType(), Dest->second,
+                          SI->getSrc(), M))
+        return false;
+      ToErase.push_back(SI);
+      continue;
+    }
+
+    if (auto *RI = dyn_cast<ReturnInst>(&I)) {
+      Ret = RI;
+      continue;
+    }
+
+    return false;
+  }
+
+  if (!GAI || !Ret || !isCompletelyInitialized(Value))
+    return false;
+
+  SILType Ty = GAI->getType().getObjectType();
+  if (!Ty.getStructOrBoundGenericStruct() && !Ty.is<TupleType>())
+    return false;
+
+  SILBuilderWithScope B(Ret);
+  SILValue Val = emitInitValue(Value, Ty, B, Ret->getLoc());
+  B.createStore(Ret->getLoc(), Val, GAI);
+
+  for (auto *I : reversed(ToErase))
+    I->eraseFromParent();
+
+  // Remove the constants which are now only used by other dead constants.
+  SmallVector<SILInstruction *, 16> Constants;
+  for (auto &I : *BB)
+    if (isa<LiteralInst>(&I) || isa<StructInst>(&I) || isa<TupleInst>(&I))
+      Constants.push_back(&I);
+  for (auto *I : reversed(Constants))
+    if (I->use_empty())
+      I->eraseFromParent();
+  return true;
+}
+
 /// We analyze the body of globalinit_func to see if it can be statically
 /// initialized. If yes, we set the initial value of the SILGlobalVariable and
 /// remove the "once" call to globalinit_func from the addressor.
@@ -688,13 +906,22 @@ void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
       InitializerCount[InitF] > 1)
     return;
 
-  // If the globalinit_func is trivial, continue; otherwise bail.
+  // If the globalinit_func is trivial, or can be folded into a trivial one,
+  // continue; otherwise bail.
   auto *SILG = SILGlobalVariable::getVariableOfStaticInitializer(InitF);
+  if (!SILG && foldStaticInitializer(InitF)) {
+    DEBUG(llvm::dbgs() << "GlobalOpt: folded initializer "
+          << InitF->getName() << '\n');
+    ++NumInitializersFolded;
+    HasChanged = true;
+    SILG = SILGlobalVariable::getVariableOfStaticInitializer(InitF);
+  }
   if (!SILG || !SILG->isDefinition())
     return;
 
   DEBUG(llvm::dbgs() << "GlobalOpt: use static initializer for " <<
         SILG->getName() << '\n');
+  ++NumGlobalsStaticallyInitialized;
 
   // Remove "once" call from the addressor.
   if (!isAssignedOnlyOnceInInitializer(SILG) || !SILG->getDecl()) {
@@ -16,6 +16,11 @@
 // if this pass can prove that it has analyzed all assignments of an initial
 // value to this property and all those assignments assign the same value
 // to this property.
+//
+// Let properties which are initialized by integer expressions computed from
+// literals and from other let properties with known constant values are
+// handled as well. Their initial values are folded into literals in the
+// initializers, so that they can be promoted the same way.
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "let-properties-opt"
@@ -25,12 +30,21 @@
 #include "swift/SIL/SILLinkage.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/ConstantFolding.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 using namespace swift;
 
+STATISTIC(NumDependentInitsFolded,
+          "Number of let property initial values folded into constants");
+
+/// The maximum depth of an expression which is folded into a constant
+/// initial value of a let property.
+static const unsigned MaxInitValueDepth = 16;
+
 namespace {
 /// Promote values of non-static let properties initialized by means
 /// of constant values of simple types into their uses.
@@ -65,6 +79,11 @@ class LetPropertiesOpt {
   // Set of properties which already fulfill all conditions, except
   // the available of constant, statically known initializer.
   llvm::SmallPtrSet<VarDecl *, 16> PotentialConstantLetProperty;
+  // Map each let property to the operands of the instructions storing its
+  // initial values, if those values are not constant yet, but may be folded
+  // into constants once the values of other let properties are known.
+  // An empty list means that all of them have been folded already.
+  llvm::MapVector<VarDecl *, SmallVector<Operand *, 4>> DependentInitMap;
 
 public:
   LetPropertiesOpt(SILModule *M): Module(M) {}
@@ -78,6 +97,14 @@ protected:
   void optimizeLetPropertyAccess(VarDecl *SILG,
                                  SmallVectorImpl<SILInstruction *> &Init);
   bool analyzeInitValue(SILInstruction *I, VarDecl *Prop);
+  void addDependentInitValue(Operand *Op, VarDecl *Prop);
+  SILValue getKnownInitValue(VarDecl *Prop);
+  SILValue resolveAddress(SILValue Addr);
+  SILValue resolveValue(SILValue V);
+  Optional<APInt> evaluateInitValue(SILValue V, unsigned Depth);
+  bool canMaterializeInitValue(SILValue V, unsigned Depth);
+  SILValue materializeInitValue(SILValue V, SILBuilder &B, SILLocation Loc);
+  void resolveDependentInitValues();
 };
 
 /// Helper class to copy only a set of SIL instructions providing in the
@@ -488,9 +515,10 @@ void LetPropertiesOpt::collectStructPropertiesAccess(StructInst *SI,
     DEBUG(llvm::dbgs() << "Check the value of property '" << *Prop
                        << "' :" << PropValue << "\n");
     if (!analyzeInitValue(SI, Prop)) {
-      SkipProcessing.insert(Prop);
+      // The value may still be computed from other let properties.
+      addDependentInitValue(SI->getOperandForField(Prop), Prop);
       DEBUG(llvm::dbgs() << "The value of a let property '" << *Prop
-                         << "' is not statically known\n");
+                         << "' is not statically known yet\n");
     }
     (void) PropValue;
   }
@@ -535,10 +563,14 @@ void LetPropertiesOpt::collectPropertyAccess(SILInstruction *I,
         // There is a store into this property.
         // Analyze the assigned value and check if it is a constant
         // statically known initializer.
-        if (SI->getDest() != I || !analyzeInitValue(SI, Property)) {
+        if (SI->getDest() != I) {
           SkipProcessing.insert(Property);
           return;
         }
+        // The value may still be computed from other let properties.
+        if (!analyzeInitValue(SI, Property))
+          addDependentInitValue(&SI->getAllOperands()[StoreInst::Src],
+                                Property);
         continue;
       }
 
@@ -561,6 +593,280 @@ void LetPropertiesOpt::collectPropertyAccess(SILInstruction *I,
     CannotRemove.insert(Property);
 }
 
+/// Remember an initial value of a let property, which is not a statically
+/// known constant, but may be folded into one later.
+void LetPropertiesOpt::addDependentInitValue(Operand *Op, VarDecl *Property) {
+  // A constant initializer which is different from an already seen one can
+  // never become the same value.
+  SmallVector<SILInstruction *, 8> Insns;
+  if (analyzeStaticInitializer(Op->get(), Insns)) {
+    SkipProcessing.insert(Property);
+    return;
+  }
+  DependentInitMap[Property].push_back(Op);
+}
+
+/// Return the value computed by the constant initializer of a let property
+/// or an empty value if it is not known (yet).
+SILValue LetPropertiesOpt::getKnownInitValue(VarDecl *Property) {
+  if (SkipProcessing.count(Property))
+    return SILValue();
+
+  auto DepIt = DependentInitMap.find(Property);
+  if (DepIt != DependentInitMap.end() && !DepIt->second.empty())
+    return SILValue();
+
+  auto It = InitMap.find(Property);
+  if (It == InitMap.end() || It->second.empty())
+    return SILValue();
+  return It->second.back();
+}
+
+/// Return the constant value stored at \p Addr, if \p Addr is a projection
+/// of let properties with known constant initializers.
+SILValue LetPropertiesOpt::resolveAddress(SILValue Addr) {
+  if (auto *REAI = dyn_cast<RefElementAddrInst>(Addr))
+    return getKnownInitValue(REAI->getField());
+
+  if (auto *SEAI = dyn_cast<StructElementAddrInst>(Addr)) {
+    if (SILValue V = getKnownInitValue(SEAI->getField()))
+      return V;
+    if (auto *SI = dyn_cast_or_null<StructInst>(
+            resolveAddress(SEAI->getOperand())))
+      return SI->getFieldValue(SEAI->getField());
+    return SILValue();
+  }
+
+  if (auto *TEAI = dyn_cast<TupleElementAddrInst>(Addr)) {
+    if (auto *TI = dyn_cast_or_null<TupleInst>(
+            resolveAddress(TEAI->getOperand())))
+      return TI->getElement(TEAI->getFieldNo());
+  }
+  return SILValue();
+}
+
+/// Look through loads and projections of let properties with known constant
+/// initializers.
+SILValue LetPropertiesOpt::resolveValue(SILValue V) {
+  if (auto *LI = dyn_cast<LoadInst>(V)) {
+    if (SILValue Resolved = resolveAddress(LI->getOperand()))
+      return resolveValue(Resolved);
+    return V;
+  }
+
+  if (auto *SEI = dyn_cast<StructExtractInst>(V)) {
+    if (SILValue Resolved = getKnownInitValue(SEI->getField()))
+      return resolveValue(Resolved);
+    if (auto *SI = dyn_cast<StructInst>(resolveValue(SEI->getOperand())))
+      return resolveValue(SI->getFieldValue(SEI->getField()));
+    return V;
+  }
+
+  if (auto *TEI = dyn_cast<TupleExtractInst>(V)) {
+    if (auto *TI = dyn_cast<TupleInst>(resolveValue(TEI->getOperand())))
+      return resolveValue(TI->getElement(TEI->getFieldNo()));
+  }
+  return V;
+}
+
+/// Evaluate an integer expression built from literals and let properties
+/// with known constant initializers.
+Optional<APInt> LetPropertiesOpt::evaluateInitValue(SILValue V,
+                                                    unsigned Depth) {
+  if (Depth > MaxInitValueDepth)
+    return None;
+
+  V = resolveValue(V);
+  if (auto *ILI = dyn_cast<IntegerLiteralInst>(V))
+    return ILI->getValue();
+
+  // The result of an arithmetic operation with overflow. Bail if it
+  // overflows, because the initializer would trap in this case.
+  if (auto *TEI = dyn_cast<TupleExtractInst>(V)) {
+    auto *BI = dyn_cast<BuiltinInst>(resolveValue(TEI->getOperand()));
+    if (!BI || TEI->getFieldNo() != 0)
+      return None;
+
+    auto ID = BI->getBuiltinInfo().ID;
+    switch (ID) {
+    case BuiltinValueKind::SAddOver:
+    case BuiltinValueKind::UAddOver:
+    case BuiltinValueKind::SSubOver:
+    case BuiltinValueKind::USubOver:
+    case BuiltinValueKind::SMulOver:
+    case BuiltinValueKind::UMulOver: {
+      auto LHS = evaluateInitValue(BI->getArguments()[0], Depth + 1);
+      auto RHS = evaluateInitValue(BI->getArguments()[1], Depth + 1);
+      if (!LHS || !RHS)
+        return None;
+      bool Overflow;
+      APInt Res = constantFoldBinaryWithOverflow(
+          *LHS, *RHS, Overflow, getLLVMIntrinsicIDForBuiltinWithOverflow(ID));
+      if (Overflow)
+        return None;
+      return Res;
+    }
+    default:
+      return None;
+    }
+  }
+
+  auto *BI = dyn_cast<BuiltinInst>(V);
+  if (!BI)
+    return None;
+
+  const BuiltinInfo &Info = BI->getBuiltinInfo();
+  OperandValueArrayRef Args = BI->getArguments();
+  switch (Info.ID) {
+  case BuiltinValueKind::Trunc:
+  case BuiltinValueKind::TruncOrBitCast:
+  case BuiltinValueKind::ZExt:
+  case BuiltinValueKind::ZExtOrBitCast:
+  case BuiltinValueKind::SExt:
+  case BuiltinValueKind::SExtOrBitCast: {
+    auto Op = evaluateInitValue(Args[0], Depth + 1);
+    if (!Op)
+      return None;
+    return constantFoldCast(*Op, Info);
+  }
+  default:
+    break;
+  }
+
+  if (Args.size() != 2)
+    return None;
+  auto LHS = evaluateInitValue(Args[0], Depth + 1);
+  auto RHS = evaluateInitValue(Args[1], Depth + 1);
+  if (!LHS || !RHS)
+    return None;
+
+  switch (Info.ID) {
+  case BuiltinValueKind::Add:
+    return *LHS + *RHS;
+  case BuiltinValueKind::Sub:
+    return *LHS - *RHS;
+  case BuiltinValueKind::Mul:
+    return *LHS * *RHS;
+  case BuiltinValueKind::And:
+  case BuiltinValueKind::AShr:
+  case BuiltinValueKind::LShr:
+  case BuiltinValueKind::Or:
+  case BuiltinValueKind::Shl:
+  case BuiltinValueKind::Xor:
+    return constantFoldBitOperation(*LHS, *RHS, Info.ID);
+  case BuiltinValueKind::ICMP_EQ:
+  case BuiltinValueKind::ICMP_NE:
+  case BuiltinValueKind::ICMP_SLT:
+  case BuiltinValueKind::ICMP_SGT:
+  case BuiltinValueKind::ICMP_SLE:
+  case BuiltinValueKind::ICMP_SGE:
+  case BuiltinValueKind::ICMP_ULT:
+  case BuiltinValueKind::ICMP_UGT:
+  case BuiltinValueKind::ICMP_ULE:
+  case BuiltinValueKind::ICMP_UGE:
+    return constantFoldComparison(*LHS, *RHS, Info.ID);
+  default:
+    return None;
+  }
+}
+
+/// Check if \p V can be folded into a constant initializer.
+bool LetPropertiesOpt::canMaterializeInitValue(SILValue V, unsigned Depth) {
+  if (Depth > MaxInitValueDepth)
+    return false;
+
+  V = resolveValue(V);
+  if (auto *SI = dyn_cast<StructInst>(V)) {
+    for (auto &Op : SI->getAllOperands())
+      if (!canMaterializeInitValue(Op.get(), Depth + 1))
+        return false;
+    return true;
+  }
+  if (auto *TI = dyn_cast<TupleInst>(V)) {
+    for (auto &Op : TI->getAllOperands())
+      if (!canMaterializeInitValue(Op.get(), Depth + 1))
+        return false;
+    return true;
+  }
+  if (isa<FloatLiteralInst>(V))
+    return true;
+  if (V->getType().is<BuiltinIntegerType>())
+    return evaluateInitValue(V, Depth).hasValue();
+  return false;
+}
+
+/// Create a constant initializer computing the same value as \p V.
+/// \p V must be accepted by canMaterializeInitValue.
+SILValue LetPropertiesOpt::materializeInitValue(SILValue V, SILBuilder &B,
+                                                SILLocation Loc) {
+  V = resolveValue(V);
+  if (auto *SI = dyn_cast<StructInst>(V)) {
+    SmallVector<SILValue, 4> Elts;
+    for (auto &Op : SI->getAllOperands())
+      Elts.push_back(materializeInitValue(Op.get(), B, Loc));
+    return B.createStruct(Loc, SI->getType(), Elts);
+  }
+  if (auto *TI = dyn_cast<TupleInst>(V)) {
+    SmallVector<SILValue, 4> Elts;
+    for (auto &Op : TI->getAllOperands())
+      Elts.push_back(materializeInitValue(Op.get(), B, Loc));
+    return B.createTuple(Loc, TI->getType(), Elts);
+  }
+  if (auto *FLI = dyn_cast<FloatLiteralInst>(V))
+    return B.createFloatLiteral(Loc, FLI->getType(), FLI->getValue());
+
+  auto Value = evaluateInitValue(V, 0);
+  assert(Value && "Cannot materialize the initial value");
+  return B.createIntegerLiteral(Loc, V->getType(), *Value);
+}
+
+/// Fold the initial values of let properties, which are computed from
+/// other let properties, into constants. Folding the initial value of one
+/// property may enable the folding of values depending on it, so iterate
+/// until no more initial values can be folded.
+void LetPropertiesOpt::resolveDependentInitValues() {
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto &Entry : DependentInitMap) {
+      VarDecl *Property = Entry.first;
+      auto &Ops = Entry.second;
+      if (Ops.empty() || SkipProcessing.count(Property))
+        continue;
+
+      if (!std::all_of(Ops.begin(), Ops.end(), [&](Operand *Op) {
+            return canMaterializeInitValue(Op->get(), 0);
+          }))
+        continue;
+
+      DEBUG(llvm::dbgs() << "Folding the initial value of property '"
+                         << *Property << "'\n");
+
+      // Replace the stored values by their constant equivalents. The
+      // original computations are left for dead code elimination.
+      SmallVector<Operand *, 4> Worklist(Ops.begin(), Ops.end());
+      Ops.clear();
+      for (auto *Op : Worklist) {
+        SILInstruction *User = Op->getUser();
+        SILBuilderWithScope B(User);
+        Op->set(materializeInitValue(Op->get(), B, User->getLoc()));
+        HasChanged = true;
+        ++NumDependentInitsFolded;
+        if (!analyzeInitValue(User, Property)) {
+          SkipProcessing.insert(Property);
+          break;
+        }
+      }
+      Changed = true;
+    }
+  }
+
+  // The remaining initial values are not statically known.
+  for (auto &Entry : DependentInitMap)
+    if (!Entry.second.empty())
+      SkipProcessing.insert(Entry.first);
+}
+
 bool LetPropertiesOpt::run() {
   // Collect property access information for the whole module.
   for (auto &F : *Module) {
@@ -587,6 +893,9 @@ bool LetPropertiesOpt::run() {
     }
   }
 
+  // Fold the initial values which depend on other let properties.
+  resolveDependentInitValues();
+
   for (auto &Init: InitMap) {
     optimizeLetPropertyAccess(Init.first, Init.second);
   }
@@ -0,0 +1,79 @@
+//===--- SideEffectsSummary.cpp - Summarize side-effects for clients ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "side-effects-summary"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/AST/Module.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumFunctionsSummarized,
+          "Number of public functions with summarized side-effects");
+
+namespace {
+
+/// Records the side-effects of the module's public functions, so that they
+/// are serialized with the module and the SideEffectAnalysis of its clients
+/// doesn't have to assume the worst about calls to them.
+///
+/// This must run after all other optimizations, because the summaries have to
+/// describe the function bodies which are finally emitted.
+class SideEffectsSummary : public SILModuleTransform {
+
+  void run() override {
+    SILModule *M = getModule();
+
+    // The bodies of a resilient module's functions may change without its
+    // clients being recompiled.
+    if (M->getSwiftModule()->getResilienceStrategy() ==
+          ResilienceStrategy::Resilient)
+      return;
+
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    for (auto &F : *M) {
+      if (F.getLinkage() != SILLinkage::Public || !F.isDefinition())
+        continue;
+
+      // Clients see the @effects attribute themselves.
+      if (F.hasEffectsKind())
+        continue;
+
+      const auto &Effects = SEA->getEffects(&F);
+
+      // Don't bother with a summary which isn't better than not knowing
+      // anything.
+      const auto &Global = Effects.getGlobalEffects();
+      if (Global.mayRead() && Global.mayWrite() && Global.mayRetain() &&
+          Global.mayRelease())
+        continue;
+
+      DEBUG(llvm::dbgs() << "  summarize " << F.getName() << ": <"
+                         << Effects << ">\n");
+      F.setEffectsSummary(Effects.getSummary());
+      ++NumFunctionsSummarized;
+    }
+  }
+
+  StringRef getName() override { return "Side Effects Summary"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createSideEffectsSummary() {
+  return new SideEffectsSummary();
+}
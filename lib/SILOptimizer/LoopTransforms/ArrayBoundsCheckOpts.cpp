@@ -26,6 +26,7 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
 #include "swift/SIL/Dominance.h"
 #include "swift/SIL/PatternMatch.h"
@@ -38,6 +39,7 @@
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Allocator.h"
@@ -59,6 +61,19 @@ static llvm::cl::opt<bool> EnableABCOpts("enable-abcopts",
 static llvm::cl::opt<bool> EnableABCHoisting("enable-abc-hoisting",
                                              llvm::cl::init(true));
 
+static llvm::cl::opt<bool> EnableABCVersioning("enable-abc-versioning",
+                                               llvm::cl::init(true));
+
+static llvm::cl::opt<unsigned> ABCVersioningSizeLimit(
+    "abc-versioning-size-limit", llvm::cl::init(200),
+    llvm::cl::desc("The maximum number of instructions in a loop that is "
+                   "versioned to remove its bounds checks"));
+
+STATISTIC(NumLoopsVersioned,
+          "Number of loops versioned to remove bounds checks");
+STATISTIC(NumChecksRemovedByVersioning,
+          "Number of bounds checks removed from versioned loops");
+
 
 using ArraySet = llvm::SmallPtrSet<SILValue, 16>;
 // A pair of the array pointer and the array check kind (kCheckIndex or
@@ -900,6 +915,8 @@ public:
 
   operator bool() { return Ind != nullptr; }
 
+  InductionInfo *getInduction() { return Ind; }
+
   static AccessFunction getLinearFunction(SILValue Idx,
                                           InductionAnalysis &IndVars) {
     // Match the actual induction variable buried in the integer struct.
@@ -1093,11 +1110,188 @@ static bool isComparisonKnownTrue(BuiltinInst *Builtin, InductionInfo &IndVar) {
                                     m_Specific(IndVar.End)));
 }
 
+namespace {
+/// A bounds check on an induction variable that stays in the loop because it
+/// is not executed in every iteration.
+struct VersionedCheck {
+  ApplyInst *Check;
+  InductionInfo *IndVar;
+  /// An array.get_count call that gives the count of the checked array when
+  /// copied in front of the loop.
+  ApplyInst *Count;
+};
+} // end anonymous namespace
+
+/// Find an array.get_count call on the array \p ArrayVal, which is checked in
+/// the loop, that can be copied to \p InsertBefore in front of the loop.
+static ApplyInst *findCountCall(SILValue ArrayVal, SILValue Array,
+                                SILLoop *Loop, SILInstruction *InsertBefore,
+                                DominanceInfo *DT) {
+  SmallVector<SILValue, 4> Values(1, ArrayVal);
+
+  // A safe array that is loaded in the loop has the same count in every
+  // iteration, whichever load of it the count is taken from.
+  if (isa<LoadInst>(ArrayVal) &&
+      !dominates(DT, ArrayVal, InsertBefore->getParent()))
+    for (auto *Use : Array->getUses())
+      if (auto *LI = dyn_cast<LoadInst>(Use->getUser()))
+        if (LI != ArrayVal && Loop->contains(LI->getParent()))
+          Values.push_back(LI);
+
+  for (auto V : Values)
+    for (auto *Use : V->getUses()) {
+      ArraySemanticsCall Count(Use->getUser(), "array.get_count");
+      if (Count && Count.getSelf() == V &&
+          Count.canHoist(InsertBefore, DT))
+        return Count;
+    }
+  return nullptr;
+}
+
+/// Version the loop on the bounds checks that could not be hoisted because
+/// they are not executed in every iteration.
+///
+/// If every induction variable indexing an array stays within the bounds of
+/// the array, which a single check in front of the loop can tell, a copy of the
+/// loop without those bounds checks runs instead of the original loop.
+static bool versionLoopForBoundsChecks(SILLoop *Loop, DominanceInfo *DT,
+                                       ABCAnalysis &ABC,
+                                       InductionAnalysis &IndVars,
+                                       SILBasicBlock *Preheader) {
+  SmallVector<VersionedCheck, 8> Checks;
+  unsigned LoopSize = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      // Can't clone alloc_stack instructions whose dealloc_stack is outside
+      // the loop.
+      if (!Loop->canDuplicate(&Inst))
+        return false;
+      if (++LoopSize > ABCVersioningSizeLimit) {
+        DEBUG(llvm::dbgs() << " loop too big to version\n");
+        return false;
+      }
+
+      ArraySemanticsCall ArrayCall(&Inst);
+      if (ArrayCall.getKind() != ArrayCallKind::kCheckSubscript)
+        continue;
+      auto ArrayVal = ArrayCall.getSelf();
+      // Only the indices of an Array, but not e.g. of an ArraySlice, start at
+      // zero.
+      if (!hasArrayType(ArrayVal, Preheader->getModule()))
+        continue;
+      SILValue Array =
+          getArrayStructPointer(ArrayCallKind::kCheckSubscript, ArrayVal);
+
+      // The array must not change in the loop, just as for hoisting.
+      if (!dominates(DT, Array, Preheader))
+        continue;
+      if (!dominates(DT, ArrayVal, Preheader) && ABC.isUnsafe(Array))
+        continue;
+
+      auto F = AccessFunction::getLinearFunction(ArrayCall.getIndex(),
+                                                 IndVars);
+      if (!F)
+        continue;
+
+      // Without the overflow check the induction variable could wrap around
+      // and we would not know its range.
+      auto *IndVar = F.getInduction();
+      if (!IndVar->IsOverflowCheckInserted)
+        continue;
+
+      auto *Count = findCountCall(ArrayVal, Array, Loop,
+                                  Preheader->getTerminator(), DT);
+      if (!Count || Count->getType() != ArrayCall.getIndex()->getType()) {
+        DEBUG(llvm::dbgs() << " no count to version on " << Inst);
+        continue;
+      }
+
+      Checks.push_back({ArrayCall, IndVar, Count});
+    }
+  }
+  if (Checks.empty())
+    return false;
+
+  DEBUG(llvm::dbgs() << "Versioning " << *Loop);
+
+  // Split off a new empty preheader. This will be the block that checks
+  // whether to execute the loop without bounds checks or the original loop.
+  SILBuilder B(Preheader);
+  auto *CheckBlock = splitBasicBlockAndBranch(B, Preheader->getTerminator(),
+                                              DT, nullptr);
+
+  SmallVector<SILBasicBlock *, 16> ExitBlocks;
+  Loop->getExitBlocks(ExitBlocks);
+
+  // Collect the exit blocks dominated by the loop - they will be dominated by
+  // the check block.
+  SmallVector<SILBasicBlock *, 16> ExitBlocksDominatedByPreheader;
+  for (auto *ExitBlock : ExitBlocks)
+    if (DT->dominates(CheckBlock, ExitBlock))
+      ExitBlocksDominatedByPreheader.push_back(ExitBlock);
+
+  // Split the preheader before the first instruction and clone the loop
+  // starting at the new preheader.
+  SILBasicBlock *NewPreheader =
+      splitBasicBlockAndBranch(B, &*CheckBlock->begin(), DT, nullptr);
+  RegionCloner Cloner(NewPreheader, ExitBlocks, *DT);
+  auto *ClonedPreheader = Cloner.cloneRegion();
+
+  // The induction variables run from Start to End - 1 (the overflow check in
+  // front of the loop makes sure that Start < End), so the checks in the loop
+  // can't fail if 0 <= Start and End <= count.
+  auto *CheckTerm = CheckBlock->getTerminator();
+  SILLocation Loc = CheckTerm->getLoc();
+  B.setInsertionPoint(CheckTerm);
+  SILType BoolTy = SILType::getBuiltinIntegerType(1, B.getASTContext());
+  SILValue IsInBounds = B.createIntegerLiteral(Loc, BoolTy, 1);
+  llvm::DenseSet<std::pair<InductionInfo *, ApplyInst *>> Guarded;
+  for (auto &VC : Checks) {
+    if (!Guarded.insert({VC.IndVar, VC.Count}).second)
+      continue;
+
+    ApplyInst *Count = ArraySemanticsCall(VC.Count).copyTo(CheckTerm, DT);
+    auto *CountDecl = Count->getType().getStructOrBoundGenericStruct();
+    SILValue CountVal = B.createStructExtract(
+        Loc, Count, *CountDecl->getStoredProperties().begin());
+
+    SILValue Start = VC.IndVar->Start;
+    SILValue End = VC.IndVar->End;
+    auto *Zero = B.createIntegerLiteral(Loc, Start->getType(), 0);
+    auto *StartInBounds = B.createBuiltinBinaryFunction(
+        Loc, "cmp_sle", Start->getType(), BoolTy, {Zero, Start});
+    auto *EndInBounds = B.createBuiltinBinaryFunction(
+        Loc, "cmp_sle", End->getType(), BoolTy, {End, CountVal});
+    IsInBounds = B.createBuiltinBinaryFunction(Loc, "and", BoolTy, BoolTy,
+                                               {IsInBounds, StartInBounds});
+    IsInBounds = B.createBuiltinBinaryFunction(Loc, "and", BoolTy, BoolTy,
+                                               {IsInBounds, EndInBounds});
+  }
+  B.createCondBranch(Loc, IsInBounds, ClonedPreheader, NewPreheader);
+  CheckTerm->eraseFromParent();
+
+  // Fixup the exit blocks. They are now dominated by the check block.
+  for (auto *BB : ExitBlocksDominatedByPreheader)
+    DT->changeImmediateDominator(DT->getNode(BB), DT->getNode(CheckBlock));
+
+  // Remove the bounds checks from the cloned loop.
+  for (auto &VC : Checks) {
+    ArraySemanticsCall(Cloner.getClonedInstruction(VC.Check)).removeCall();
+    ++NumChecksRemovedByVersioning;
+  }
+  ++NumLoopsVersioned;
+  return true;
+}
+
 /// Analyse the loop for arrays that are not modified and perform dominator tree
 /// based redundant bounds check removal.
+///
+/// Sets \p ClonedLoop if the loop was versioned, which invalidates the loop
+/// info.
 static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
                               IVInfo &IVs, ArraySet &Arrays,
-                              RCIdentityFunctionInfo *RCIA, bool ShouldVerify) {
+                              RCIdentityFunctionInfo *RCIA, bool ShouldVerify,
+                              bool &ClonedLoop) {
   auto *Header = Loop->getHeader();
   if (!Header) return false;
 
@@ -1226,6 +1420,13 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
   // Hoist bounds checks.
   Changed |= hoistChecksInLoop(DT, DT->getNode(Header), ABC, IndVars,
                                Preheader, Header, SingleExitingBlk);
+
+  // Version the loop on the bounds checks that are left.
+  if (EnableABCVersioning && IVarsFound &&
+      versionLoopForBoundsChecks(Loop, DT, ABC, IndVars, Preheader)) {
+    ClonedLoop = true;
+    Changed = true;
+  }
   if (Changed) {
     Preheader->getParent()->verify();
   }
@@ -1320,6 +1521,7 @@ public:
     if (ShouldReportBoundsChecks) { reportBoundsChecks(F); };
 
     bool ShouldVerify = getOptions().VerifyAll;
+    bool ClonedLoop = false;
 
     if (LI->empty()) {
       DEBUG(llvm::dbgs() << "No loops in " << F->getName() << "\n");
@@ -1339,14 +1541,22 @@ public:
 
         while (!Worklist.empty()) {
           Changed |= hoistBoundsChecks(Worklist.pop_back_val(), DT, LI, IVs,
-                                       ReleaseSafeArrays, RCIA, ShouldVerify);
+                                       ReleaseSafeArrays, RCIA, ShouldVerify,
+                                       ClonedLoop);
         }
       }
 
+      // Versioning loops might have left critical edges that need splitting.
+      if (ClonedLoop)
+        splitAllCriticalEdges(*F, true /* only cond_br terminators*/, DT,
+                              nullptr);
+
       if (ShouldReportBoundsChecks) { reportBoundsChecks(F); };
     }
 
-    if (Changed) {
+    if (ClonedLoop) {
+      PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
+    } else if (Changed) {
       PM->invalidateAnalysis(F,
                           SILAnalysis::InvalidationKind::CallsAndInstructions);
     }
@@ -13,9 +13,13 @@
 #define DEBUG_TYPE "sil-loopunroll"
 
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "swift/SIL/PatternMatch.h"
 #include "swift/SIL/SILCloner.h"
+#include "swift/SILOptimizer/Analysis/IVAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -28,8 +32,23 @@ using namespace swift::PatternMatch;
 using llvm::DenseMap;
 using llvm::MapVector;
 
+STATISTIC(NumLoopsFullyUnrolled, "Number of loops fully unrolled");
+STATISTIC(NumLoopsPartiallyUnrolled, "Number of loops partially unrolled");
+
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The maximum trip count of a loop we fully unroll.
+static const uint64_t SILLoopMaxFullUnrollTripCount = 32;
+
+static llvm::cl::opt<unsigned> SILLoopPartialUnrollFactor(
+    "sil-loop-partial-unroll-factor", llvm::cl::init(4),
+    llvm::cl::desc("The maximum factor a loop is partially unrolled by. A "
+                   "value below 2 disables partial unrolling"));
+
+static llvm::cl::opt<unsigned> SILLoopPartialUnrollThreshold(
+    "sil-loop-partial-unroll-threshold", llvm::cl::init(64),
+    llvm::cl::desc("The maximum cost of a partially unrolled loop body"));
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -162,35 +181,116 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
   return Dist.getZExtValue();
 }
 
-/// Check whether we can duplicate the instructions in the loop and use a
-/// heuristic that looks at the trip count and the cost of the instructions in
-/// the loop to determine whether we should unroll this loop.
-static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
-  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
-  if (TripCount > 32)
+/// The cost of one iteration of a loop.
+struct LoopBodyCost {
+  /// The cost of the loop body as it is.
+  uint64_t Cost = 0;
+  /// The cost of the loop body if the induction variables are constant, as
+  /// they are in each copy of a fully unrolled loop. Instructions computing
+  /// only from constants and induction variables then fold away.
+  uint64_t FoldedCost = 0;
+};
+
+/// Returns true if \p I computes a value which is constant if all its
+/// operands are constant.
+static bool isFoldableInstruction(SILInstruction *I) {
+  switch (I->getKind()) {
+  case ValueKind::BuiltinInst:
+    return !I->mayHaveSideEffects();
+  case ValueKind::TupleExtractInst:
+  case ValueKind::StructExtractInst:
+  case ValueKind::TupleInst:
+  case ValueKind::StructInst:
+  case ValueKind::CondFailInst:
+  case ValueKind::CondBranchInst:
+    return true;
+  default:
     return false;
+  }
+}
 
-  // We can unroll a loop if we can duplicate the instructions it holds.
-  uint64_t Cost = 0;
+/// Compute the cost of the loop body. Returns None if the loop contains an
+/// instruction we cannot duplicate.
+static Optional<LoopBodyCost> getLoopBodyCost(SILLoop *Loop,
+                                              SILBasicBlock *Preheader,
+                                              IVInfo &IVs) {
+  // Induction variables of this loop which start at a constant.
+  auto isConstantIV = [&](ValueBase *V) -> bool {
+    if (!IVs.isInductionVariable(V))
+      return false;
+    SILArgument *HeaderArg = IVs.getInductionVariableHeader(V);
+    return HeaderArg->getParent() == Loop->getHeader() &&
+           isa<IntegerLiteralInst>(HeaderArg->getIncomingValue(Preheader));
+  };
+
+  // The values which are constant in a fully unrolled copy of the loop body.
+  llvm::SmallPtrSet<ValueBase *, 16> FoldedValues;
+  auto isFolded = [&](SILValue V) -> bool {
+    return isa<IntegerLiteralInst>(V) || isConstantIV(V) ||
+           FoldedValues.count(V);
+  };
+
+  LoopBodyCost Result;
   for (auto *BB : Loop->getBlocks()) {
     for (auto &Inst : *BB) {
       if (!Loop->canDuplicate(&Inst))
-        return false;
-      if (instructionInlineCost(Inst) != InlineCost::Free)
-        ++Cost;
-      if (Cost * TripCount > SILLoopUnrollThreshold)
-        return false;
+        return None;
+
+      // The increment of the induction variable, its overflow check and
+      // values derived from it fold away once the induction variable is
+      // constant.
+      bool IsFolded =
+          isConstantIV(&Inst) ||
+          (isFoldableInstruction(&Inst) &&
+           std::all_of(Inst.getAllOperands().begin(),
+                       Inst.getAllOperands().end(),
+                       [&](Operand &Op) { return isFolded(Op.get()); }));
+      if (IsFolded)
+        FoldedValues.insert(&Inst);
+
+      if (instructionInlineCost(Inst) == InlineCost::Free)
+        continue;
+      ++Result.Cost;
+      if (!IsFolded)
+        ++Result.FoldedCost;
+    }
   }
+  return Result;
+}
+
+/// Use a heuristic that looks at the trip count and the cost of the
+/// instructions in the loop to determine whether we should fully unroll this
+/// loop.
+static bool shouldFullyUnrollLoop(const LoopBodyCost &Cost,
+                                  uint64_t TripCount) {
+  if (TripCount > SILLoopMaxFullUnrollTripCount)
+    return false;
+  return Cost.FoldedCost * TripCount <= SILLoopUnrollThreshold;
+}
+
+/// Determine the factor to partially unroll a loop with the exact trip count
+/// \p TripCount by. The factor divides the trip count, so that no remainder
+/// iterations are needed. Returns 0 if the loop should not be unrolled.
+static unsigned getPartialUnrollFactor(const LoopBodyCost &Cost,
+                                       uint64_t TripCount) {
+  for (unsigned Factor = SILLoopPartialUnrollFactor; Factor > 1; --Factor) {
+    if (TripCount % Factor != 0)
+      continue;
+    if (Cost.Cost * Factor <= SILLoopPartialUnrollThreshold)
+      return Factor;
   }
-  return true;
+  return 0;
 }
 
-/// Redirect the terminator of the current loop iteration's latch to the next
-/// iterations header or if this is the last iteration remove the backedge to
-/// the header.
-static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
-                               unsigned LastLoopIter, SILBasicBlock *OrigHeader,
-                               SILBasicBlock *NextIterationsHeader) {
+/// Redirect the terminator of a loop iteration's latch.
+///
+/// If \p NextIterationsHeader is null this is the last iteration and the
+/// backedge to the header is removed. Otherwise, the backedge is redirected to
+/// \p NextIterationsHeader. If \p RemoveExit is true, the loop exit of the
+/// iteration is known to be not taken and is removed.
+static void redirectTerminator(SILBasicBlock *Latch, SILBasicBlock *Header,
+                               SILBasicBlock *NextIterationsHeader,
+                               bool RemoveExit) {
 
   auto *CurrentTerminator = Latch->getTerminator();
 
@@ -214,18 +314,20 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
   // Handle the split backedge case.
   if (auto *Br = dyn_cast<BranchInst>(CurrentTerminator)) {
     // On the last iteration change the conditional exit to an unconditional
-    // one.
-    if (CurLoopIter == LastLoopIter) {
+    // one. If the exit is not taken, unconditionally go to the backedge.
+    if (!NextIterationsHeader || RemoveExit) {
       auto *CondBr =
           cast<CondBranchInst>(Latch->getSinglePredecessor()->getTerminator());
-      if (CondBr->getTrueBB() != Latch)
+      bool TakeTrueBB = (CondBr->getTrueBB() != Latch) == !NextIterationsHeader;
+      if (TakeTrueBB)
         SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getTrueBB(),
                                         CondBr->getTrueArgs());
       else
         SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getFalseBB(),
                                         CondBr->getFalseArgs());
       CondBr->eraseFromParent();
-      return;
+      if (!NextIterationsHeader)
+        return;
     }
 
     // Otherwise, branch to the next iteration's header.
@@ -237,10 +339,11 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
 
   // Otherwise, we have a conditional branch to the header.
   auto *CondBr = cast<CondBranchInst>(CurrentTerminator);
+  bool HeaderIsTrueBB = CondBr->getTrueBB() == Header;
   // On the last iteration change the conditional exit to an unconditional
   // one.
-  if (CurLoopIter == LastLoopIter) {
-    if (CondBr->getTrueBB() != OrigHeader)
+  if (!NextIterationsHeader) {
+    if (!HeaderIsTrueBB)
       SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getTrueBB(),
                                       CondBr->getTrueArgs());
     else
@@ -250,8 +353,18 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
     return;
   }
 
+  // If the exit is not taken, unconditionally branch to the next iteration's
+  // header.
+  if (RemoveExit) {
+    SILBuilder(CondBr).createBranch(CondBr->getLoc(), NextIterationsHeader,
+                                    HeaderIsTrueBB ? CondBr->getTrueArgs()
+                                                   : CondBr->getFalseArgs());
+    CondBr->eraseFromParent();
+    return;
+  }
+
   // Otherwise, branch to the next iteration's header.
-  if (CondBr->getTrueBB() == OrigHeader) {
+  if (HeaderIsTrueBB) {
     SILBuilder(CondBr).createCondBranch(
         CondBr->getLoc(), CondBr->getCondition(), NextIterationsHeader,
         CondBr->getTrueArgs(), CondBr->getFalseBB(), CondBr->getFalseArgs());
@@ -324,9 +437,10 @@ updateSSA(SILLoop *Loop,
   }
 }
 
-/// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
-static bool tryToUnrollLoop(SILLoop *Loop) {
+/// Try to fully unroll the loop if we can determine the trip count and the cost
+/// of the unrolled loop is below a threshold. Otherwise, try to partially
+/// unroll the loop by a factor which divides its trip count.
+static bool tryToUnrollLoop(SILLoop *Loop, IVInfo &IVs) {
   assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
 
   auto *Preheader = Loop->getLoopPreheader();
@@ -344,7 +458,9 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   if (!MaxTripCount)
     return false;
 
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
+  // We can unroll a loop if we can duplicate the instructions it holds.
+  Optional<LoopBodyCost> Cost = getLoopBodyCost(Loop, Preheader, IVs);
+  if (!Cost)
     return false;
 
   // TODO: We need to split edges from non-condbr exits for the SSA updater. For
@@ -355,8 +471,21 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     if (!isa<CondBranchInst>(Exit->getTerminator()))
       return false;
 
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
+  // The number of copies of the loop body, including the original one.
+  uint64_t NumCopies = MaxTripCount.getValue();
+  bool IsFullUnroll = shouldFullyUnrollLoop(Cost.getValue(), NumCopies);
+  if (!IsFullUnroll) {
+    // The trip count is only exact if the loop can't be left early.
+    if (ExitingBlocks.size() != 1)
+      return false;
+    NumCopies = getPartialUnrollFactor(Cost.getValue(), NumCopies);
+    if (!NumCopies)
+      return false;
+  }
+
+  DEBUG(llvm::dbgs() << (IsFullUnroll ? "Unrolling" : "Partially unrolling")
+                     << " loop in " << Header->getParent()->getName()
+                     << " by " << NumCopies << " " << *Loop << "\n");
 
   SmallVector<SILBasicBlock *, 16> Headers;
   Headers.push_back(Header);
@@ -366,8 +495,8 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
 
   DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
 
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+  // Copy the body NumCopies-1 times.
+  for (uint64_t Cnt = 1; Cnt < NumCopies; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -398,21 +527,31 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   }
 
   // Thread the loop clones by redirecting the loop latches to the successor
-  // iteration's header.
+  // iteration's header. If we partially unroll, the last copy branches back
+  // to the original header and only its exit can be taken, because the
+  // number of copies divides the trip count.
   for (unsigned Iteration = 0, End = Latches.size(); Iteration != End;
        ++Iteration) {
     auto *CurrentLatch = Latches[Iteration];
     auto LastIteration = End - 1;
-    auto *OriginalHeader = Headers[0];
-    auto *NextIterationsHeader =
-        Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
-
-    redirectTerminator(CurrentLatch, Iteration, LastIteration, OriginalHeader,
-                       NextIterationsHeader);
+    SILBasicBlock *NextIterationsHeader = nullptr;
+    if (Iteration != LastIteration)
+      NextIterationsHeader = Headers[Iteration + 1];
+    else if (!IsFullUnroll)
+      NextIterationsHeader = Headers[0];
+
+    bool RemoveExit = !IsFullUnroll && Iteration != LastIteration;
+    redirectTerminator(CurrentLatch, Headers[Iteration], NextIterationsHeader,
+                       RemoveExit);
   }
 
   // Fixup SSA form for loop values used outside the loop.
   updateSSA(Loop, LoopLiveOutValues);
+
+  if (IsFullUnroll)
+    ++NumLoopsFullyUnrolled;
+  else
+    ++NumLoopsPartiallyUnrolled;
   return true;
 }
 
@@ -448,8 +587,9 @@ class LoopUnrolling : public SILFunctionTransform {
     }
 
     // Try to unroll innermost loops.
+    IVInfo &IVs = *PM->getAnalysis<IVAnalysis>()->get(Fun);
     for (auto *Loop : InnermostLoops)
-      Changed |= tryToUnrollLoop(Loop);
+      Changed |= tryToUnrollLoop(Loop, IVs);
 
     if (Changed) {
       invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-passmanager"
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/JSONSerialization.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
@@ -25,12 +26,18 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
 
 using namespace swift;
 
 STATISTIC(NumOptzIterations, "Number of optimization iterations");
+STATISTIC(NumPassRunsSkipped, "Number of function pass runs skipped because "
+                              "the function hadn't changed since");
 
 llvm::cl::opt<bool> SILPrintAll(
     "sil-print-all", llvm::cl::init(false),
@@ -48,6 +55,11 @@ llvm::cl::opt<unsigned> SILNumOptPassesToRun(
     "sil-opt-pass-count", llvm::cl::init(UINT_MAX),
     llvm::cl::desc("Stop optimizing after <N> optimization passes"));
 
+llvm::cl::opt<bool> SILPrintLast(
+    "sil-print-last", llvm::cl::init(false),
+    llvm::cl::desc("Print the SIL before and after the last pass that "
+                   "-sil-opt-pass-count lets run"));
+
 llvm::cl::opt<unsigned> SILFunctionPassPipelineLimit("sil-pipeline-limit",
                                                      llvm::cl::init(10),
                                                      llvm::cl::desc(""));
@@ -94,6 +106,158 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<std::string> SILPassStatsFile(
+    "sil-pass-stats-file", llvm::cl::init(""),
+    llvm::cl::desc("Write the time, instruction count change, invalidations "
+                   "and memory change of each SIL pass run to this file, as "
+                   "JSON"));
+
+namespace {
+  /// One run of a pass, on one function or (for module passes) the module.
+  struct PassRunStatistics {
+    std::string Stage;
+    std::string Pass;
+    std::string Function;
+    uint64_t TimeNs = 0;
+    int64_t InstDelta = 0;
+    uint32_t Invalidations = 0;
+    int64_t MallocDelta = 0;
+  };
+
+  /// The sum of all runs of a pass.
+  struct PassTotalStatistics {
+    std::string Pass;
+    uint32_t Runs = 0;
+    /// The number of times it wasn't run on a function because the function
+    /// hadn't changed since it last ran there.
+    uint32_t Skipped = 0;
+    uint64_t TimeNs = 0;
+    int64_t InstDelta = 0;
+    uint32_t Invalidations = 0;
+    int64_t MallocDelta = 0;
+  };
+
+  struct PassStatisticsFile {
+    std::vector<PassTotalStatistics> Passes;
+    std::vector<PassRunStatistics> Runs;
+  };
+} // end anonymous namespace
+
+namespace swift {
+namespace json {
+  template<>
+  struct ObjectTraits<PassRunStatistics> {
+    static void mapping(Output &out, PassRunStatistics &value) {
+      out.mapRequired("stage", value.Stage);
+      out.mapRequired("pass", value.Pass);
+      out.mapOptional("function", value.Function, std::string());
+      out.mapRequired("time_ns", value.TimeNs);
+      out.mapRequired("inst_delta", value.InstDelta);
+      out.mapRequired("invalidations", value.Invalidations);
+      out.mapRequired("malloc_delta", value.MallocDelta);
+    }
+  };
+
+  template<>
+  struct ObjectTraits<PassTotalStatistics> {
+    static void mapping(Output &out, PassTotalStatistics &value) {
+      out.mapRequired("pass", value.Pass);
+      out.mapRequired("runs", value.Runs);
+      out.mapRequired("skipped", value.Skipped);
+      out.mapRequired("time_ns", value.TimeNs);
+      out.mapRequired("inst_delta", value.InstDelta);
+      out.mapRequired("invalidations", value.Invalidations);
+      out.mapRequired("malloc_delta", value.MallocDelta);
+    }
+  };
+
+  template<typename T>
+  struct ArrayTraits<std::vector<T>> {
+    static size_t size(Output &out, std::vector<T> &seq) {
+      return seq.size();
+    }
+
+    static T &element(Output &out, std::vector<T> &seq, size_t index) {
+      return seq[index];
+    }
+  };
+
+  template<>
+  struct ObjectTraits<PassStatisticsFile> {
+    static void mapping(Output &out, PassStatisticsFile &value) {
+      out.mapRequired("passes", value.Passes);
+      out.mapRequired("runs", value.Runs);
+    }
+  };
+} // end namespace json
+} // end namespace swift
+
+/// The runs recorded for -sil-pass-stats-file by all the pass managers of
+/// this compilation.
+static std::vector<PassRunStatistics> &getRecordedPassRuns() {
+  static std::vector<PassRunStatistics> Runs;
+  return Runs;
+}
+
+/// The number of runs of each pass skipped on unchanged functions, for
+/// -sil-pass-stats-file.
+static std::map<std::string, uint32_t> &getSkippedPassRuns() {
+  static std::map<std::string, uint32_t> Skipped;
+  return Skipped;
+}
+
+static int64_t countInstructions(SILFunction &F) {
+  int64_t Count = 0;
+  for (auto &BB : F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+static int64_t countInstructions(SILModule &M) {
+  int64_t Count = 0;
+  for (auto &F : M)
+    Count += countInstructions(F);
+  return Count;
+}
+
+/// Writes everything recorded so far to -sil-pass-stats-file.
+///
+/// Each pass manager rewrites the file as it goes away, so that it ends up
+/// holding the runs of every stage.
+static void writePassStatistics() {
+  PassStatisticsFile File;
+  File.Runs = getRecordedPassRuns();
+
+  std::map<std::string, PassTotalStatistics> Totals;
+  for (const PassRunStatistics &Run : File.Runs) {
+    PassTotalStatistics &Total = Totals[Run.Pass];
+    Total.Pass = Run.Pass;
+    ++Total.Runs;
+    Total.TimeNs += Run.TimeNs;
+    Total.InstDelta += Run.InstDelta;
+    Total.Invalidations += Run.Invalidations;
+    Total.MallocDelta += Run.MallocDelta;
+  }
+  for (auto &Entry : getSkippedPassRuns()) {
+    PassTotalStatistics &Total = Totals[Entry.first];
+    Total.Pass = Entry.first;
+    Total.Skipped = Entry.second;
+  }
+  for (auto &Entry : Totals)
+    File.Passes.push_back(Entry.second);
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(SILPassStatsFile, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "error: unable to open '" << SILPassStatsFile
+                 << "': " << EC.message() << "\n";
+    return;
+  }
+  json::Output YOut(OS);
+  YOut << File;
+  OS << '\n';
+}
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -181,6 +345,11 @@ bool SILPassManager::continueTransforming() {
          NumPassesRun < SILNumOptPassesToRun;
 }
 
+bool SILPassManager::isLastPassToRun() {
+  return SILPrintLast && Mod->getStage() != SILStage::Raw &&
+         NumPassesRun + 1 == SILNumOptPassesToRun;
+}
+
 bool SILPassManager::analysesUnlocked() {
   for (auto A : Analysis)
     if (A->isLocked())
@@ -227,6 +396,9 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
         llvm::dbgs() << "(Skip) Stage: " << StageName
                      << " Pass: " << SFT->getName()
                      << ", Function: " << F->getName() << "\n";
+      ++NumPassRunsSkipped;
+      if (!SILPassStatsFile.empty())
+        ++getSkippedPassRuns()[SFT->getName()];
       continue;
     }
 
@@ -239,19 +411,26 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
     }
 
     CurrentPassHasInvalidated = false;
+    NumCurrentPassInvalidations = 0;
 
     if (SILPrintPassName)
       llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
                    << " Pass: " << SFT->getName()
                    << ", Function: " << F->getName() << "\n";
 
-    if (doPrintBefore(SFT, F)) {
+    bool IsLastPass = isLastPassToRun();
+    if (IsLastPass || doPrintBefore(SFT, F)) {
       llvm::dbgs() << "*** SIL function before " << StageName << " "
                    << SFT->getName() << " (" << NumOptimizationIterations
                    << ") ***\n";
       F->dump(Options.EmitVerboseSIL);
     }
 
+    bool RecordStatistics = !SILPassStatsFile.empty();
+    int64_t InstsBefore = RecordStatistics ? countInstructions(*F) : 0;
+    size_t MallocBefore =
+        RecordStatistics ? llvm::sys::Process::GetMallocUsage() : 0;
+
     llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
     Mod->registerDeleteNotificationHandler(SFT);
     if (breakBeforeRunning(F->getName(), SFT->getName()))
@@ -271,8 +450,23 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
                    << ")\n";
     }
 
+    if (RecordStatistics) {
+      PassRunStatistics Run;
+      Run.Stage = StageName;
+      Run.Pass = SFT->getName();
+      Run.Function = F->getName();
+      Run.TimeNs =
+          llvm::sys::TimeValue::now().nanoseconds() - StartTime.nanoseconds();
+      Run.InstDelta = countInstructions(*F) - InstsBefore;
+      Run.Invalidations = NumCurrentPassInvalidations;
+      Run.MallocDelta = int64_t(llvm::sys::Process::GetMallocUsage()) -
+                        int64_t(MallocBefore);
+      getRecordedPassRuns().push_back(Run);
+    }
+
     // If this pass invalidated anything, print and verify.
-    if (doPrintAfter(SFT, F, CurrentPassHasInvalidated && SILPrintAll)) {
+    if (IsLastPass ||
+        doPrintAfter(SFT, F, CurrentPassHasInvalidated && SILPrintAll)) {
       llvm::dbgs() << "*** SIL function after " << StageName << " "
                    << SFT->getName() << " (" << NumOptimizationIterations
                    << ") ***\n";
@@ -341,6 +535,14 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
 
   // Pop functions off the worklist, and run all function transforms
   // on each of them.
+  //
+  // FIXME: Functions in independent call graph SCCs could be optimized
+  // concurrently, but nothing here is thread-safe: the analyses cache their
+  // results without locking, the type lowering and substitution caches in the
+  // SILModule and the ASTContext are shared, and function passes add to the
+  // module (specializations, thunks) and push onto this worklist directly.
+  // All of that would need to be made safe or deferred to a serial point
+  // first.
   while (!FunctionWorklist.empty() && continueTransforming()) {
     auto *F = FunctionWorklist.back();
 
@@ -415,18 +617,25 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   SMT->injectModule(Mod);
 
   CurrentPassHasInvalidated = false;
+  NumCurrentPassInvalidations = 0;
 
   if (SILPrintPassName)
     llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
                  << " Pass: " << SMT->getName() << " (module pass)\n";
 
-  if (doPrintBefore(SMT, nullptr)) {
+  bool IsLastPass = isLastPassToRun();
+  if (IsLastPass || doPrintBefore(SMT, nullptr)) {
     llvm::dbgs() << "*** SIL module before " << StageName << " "
                  << SMT->getName() << " (" << NumOptimizationIterations
                  << ") ***\n";
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
+  bool RecordStatistics = !SILPassStatsFile.empty();
+  int64_t InstsBefore = RecordStatistics ? countInstructions(*Mod) : 0;
+  size_t MallocBefore =
+      RecordStatistics ? llvm::sys::Process::GetMallocUsage() : 0;
+
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
@@ -440,9 +649,22 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
   }
 
+  if (RecordStatistics) {
+    PassRunStatistics Run;
+    Run.Stage = StageName;
+    Run.Pass = SMT->getName();
+    Run.TimeNs =
+        llvm::sys::TimeValue::now().nanoseconds() - StartTime.nanoseconds();
+    Run.InstDelta = countInstructions(*Mod) - InstsBefore;
+    Run.Invalidations = NumCurrentPassInvalidations;
+    Run.MallocDelta = int64_t(llvm::sys::Process::GetMallocUsage()) -
+                      int64_t(MallocBefore);
+    getRecordedPassRuns().push_back(Run);
+  }
+
   // If this pass invalidated anything, print and verify.
-  if (doPrintAfter(SMT, nullptr,
-                   CurrentPassHasInvalidated && SILPrintAll)) {
+  if (IsLastPass || doPrintAfter(SMT, nullptr,
+                                 CurrentPassHasInvalidated && SILPrintAll)) {
     llvm::dbgs() << "*** SIL module after " << StageName << " "
                  << SMT->getName() << " (" << NumOptimizationIterations
                  << ") ***\n";
@@ -529,6 +751,9 @@ void SILPassManager::run() {
 
 /// D'tor.
 SILPassManager::~SILPassManager() {
+  if (!SILPassStatsFile.empty())
+    writePassStatistics();
+
   // Free all transformations.
   for (auto T : Transformations)
     delete T;
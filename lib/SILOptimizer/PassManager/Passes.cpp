@@ -209,6 +209,8 @@ void AddSSAPasses(SILPassManager &PM, OptimizationLevelKind OpLevel) {
       // global-init functions.
       PM.addGlobalOpt();
       PM.addLetPropertiesOpt();
+      // Move trap paths out of line before the inliner measures the callees.
+      PM.addColdBlockOutlining();
       PM.addPerfInliner();
       break;
     case OptimizationLevelKind::LowLevel:
@@ -391,6 +393,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
+
+  // Summarize the side-effects of public functions for clients of the module.
+  // This must come after all the optimizations which change function bodies.
+  PM.addSideEffectsSummary();
   
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
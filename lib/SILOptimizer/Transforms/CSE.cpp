@@ -13,6 +13,12 @@
 // This pass performs a simple dominator tree walk that eliminates trivially
 // redundant instructions.
 //
+// Before the walk, instructions which are computed in all successors of a
+// branch are hoisted into the branching block. This catches redundancies the
+// dominator tree walk can't see on its own: a value computed in both sides of
+// a diamond is now available after the merge, and a load repeated in sibling
+// branches becomes a single load before the branch.
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-cse"
@@ -31,6 +37,7 @@
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/ScopedHashTable.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
@@ -41,6 +48,7 @@ STATISTIC(NumOpenExtRemoved,
 
 STATISTIC(NumSimplify, "Number of instructions simplified or DCE'd");
 STATISTIC(NumCSE,      "Number of instructions CSE'd");
+STATISTIC(NumHoisted,  "Number of instructions hoisted out of sibling blocks");
 
 using namespace swift;
 
@@ -409,6 +417,10 @@ public:
       : SEA(SEA), RunsOnHighLevelSil(RunsOnHighLevelSil) {}
 
   bool processFunction(SILFunction &F, DominanceInfo *DT);
+
+  /// Hoist instructions which are computed in all successors of a block into
+  /// the block.
+  bool hoistCommonInstructions(SILFunction &F);
   
   bool canHandle(SILInstruction *Inst);
 
@@ -469,6 +481,12 @@ private:
   };
 
   bool processNode(DominanceInfoNode *Node);
+
+  bool canHoist(SILInstruction *Inst, SILBasicBlock *Succ);
+  bool mayWriteToMemory(SILInstruction *Inst);
+  SILInstruction *findIdenticalInstruction(SILInstruction *Inst,
+                                           SILBasicBlock *Succ);
+  bool hoistCommonInstructions(SILBasicBlock *BB);
 };
 }  // end anonymous namespace
 
@@ -685,6 +703,118 @@ bool CSE::canHandle(SILInstruction *Inst) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+//                      Hoisting out of Sibling Blocks
+//===----------------------------------------------------------------------===//
+
+/// The number of instructions at the start of a sibling block which are
+/// searched for an instruction identical to a hoisting candidate.
+static const unsigned HoistSearchLimit = 64;
+
+/// Returns true if \p Inst may be moved from the successor \p Succ into its
+/// single predecessor.
+bool CSE::canHoist(SILInstruction *Inst, SILBasicBlock *Succ) {
+  // Calls and cond_fails must stay behind the side effects before them.
+  if (isa<ApplyInst>(Inst) || isa<CondFailInst>(Inst))
+    return false;
+  if (!isa<LoadInst>(Inst) && !canHandle(Inst))
+    return false;
+
+  // The operands must be available in the predecessor.
+  for (auto &Op : Inst->getAllOperands())
+    if (Op.get()->getParentBB() == Succ)
+      return false;
+  return true;
+}
+
+/// Returns true if \p Inst may write to memory, which prevents hoisting a load
+/// which comes after it.
+bool CSE::mayWriteToMemory(SILInstruction *Inst) {
+  if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
+    SideEffectAnalysis::FunctionEffects Effects;
+    SEA->getEffects(Effects, AI);
+    auto MB = Effects.getMemBehavior(RetainObserveKind::IgnoreRetains);
+    return MB > SILInstruction::MemoryBehavior::MayRead;
+  }
+  return Inst->mayWriteToMemory();
+}
+
+/// Find the instruction in \p Succ which is identical to \p Inst and which
+/// may be replaced by \p Inst hoisted into the predecessor of \p Succ.
+SILInstruction *CSE::findIdenticalInstruction(SILInstruction *Inst,
+                                              SILBasicBlock *Succ) {
+  unsigned NumSearched = 0;
+  for (auto &Candidate : *Succ) {
+    if (++NumSearched > HoistSearchLimit)
+      return nullptr;
+    if (Candidate.getKind() == Inst->getKind() &&
+        Candidate.isIdenticalTo(Inst))
+      return &Candidate;
+    // A load may only be replaced if nothing before it may have changed the
+    // loaded value.
+    if (isa<LoadInst>(Inst) && mayWriteToMemory(&Candidate))
+      return nullptr;
+  }
+  return nullptr;
+}
+
+bool CSE::hoistCommonInstructions(SILBasicBlock *BB) {
+  auto *Term = BB->getTerminator();
+  auto Succs = BB->getSuccessors();
+  if (Succs.size() < 2 || Term->mayWriteToMemory())
+    return false;
+
+  // Each successor must be entered only from this block, so that an
+  // instruction hoisted into the block doesn't run on additional paths.
+  SmallPtrSet<SILBasicBlock *, 4> SeenSuccs;
+  for (auto &Succ : Succs)
+    if (!SeenSuccs.insert(Succ.getBB()).second ||
+        Succ.getBB()->getSinglePredecessor() != BB)
+      return false;
+
+  SILBasicBlock *FirstSucc = Succs[0].getBB();
+  bool Changed = false;
+  bool MayHaveWritten = false;
+  SmallVector<SILInstruction *, 4> Identical;
+  for (auto I = FirstSucc->begin(), E = FirstSucc->end(); I != E;) {
+    SILInstruction *Inst = &*I;
+    ++I;
+
+    if (canHoist(Inst, FirstSucc) &&
+        !(isa<LoadInst>(Inst) && MayHaveWritten)) {
+      Identical.clear();
+      for (auto &Succ : Succs.slice(1)) {
+        SILInstruction *Other = findIdenticalInstruction(Inst, Succ.getBB());
+        if (!Other)
+          break;
+        Identical.push_back(Other);
+      }
+
+      if (Identical.size() == Succs.size() - 1) {
+        DEBUG(llvm::dbgs() << "SILCSE HOIST: " << *Inst);
+        Inst->moveBefore(Term);
+        for (auto *Other : Identical) {
+          Other->replaceAllUsesWith(Inst);
+          Other->eraseFromParent();
+        }
+        Changed = true;
+        ++NumHoisted;
+        continue;
+      }
+    }
+
+    MayHaveWritten |= mayWriteToMemory(Inst);
+  }
+  return Changed;
+}
+
+bool CSE::hoistCommonInstructions(SILFunction &F) {
+  bool Changed = false;
+  for (auto &BB : F)
+    Changed |= hoistCommonInstructions(&BB);
+  return Changed;
+}
+
 using ApplyWitnessPair = std::pair<ApplyInst *, WitnessMethodInst *>;
 
 /// Returns the Apply and WitnessMethod instructions that use the
@@ -901,6 +1031,10 @@ class SILCSE : public SILFunctionTransform {
     CSE C(RunsOnHighLevelSil, SEA);
     bool Changed = false;
 
+    // Make values computed in sibling blocks available to the blocks they
+    // dominate.
+    Changed |= C.hoistCommonInstructions(*getFunction());
+
     // Perform the traditional CSE.
     Changed |= C.processFunction(*getFunction(), DA->get(getFunction()));
 
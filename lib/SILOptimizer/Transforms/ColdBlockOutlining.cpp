@@ -0,0 +1,369 @@
+//===--- ColdBlockOutlining.cpp - Outline program-terminating regions -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Moves regions of a function which can only end in an unreachable, e.g. the
+// failure arms of preconditions and calls to fatalError, into separate
+// functions. Such regions are never executed more than once per process, but
+// they stay in the middle of hot code, take up instruction cache and count
+// against the callers' inlining budgets.
+//
+// An outlined function is never inlined and is marked as a program termination
+// point, so that the ARC optimizer still treats the remaining call like the
+// trap it replaces.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cold-block-outlining"
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumRegionsOutlined, "Number of cold regions outlined");
+STATISTIC(NumInstructionsOutlined, "Number of instructions moved out of line");
+
+static llvm::cl::opt<unsigned> ColdOutliningMinSize(
+    "cold-outlining-min-size", llvm::cl::init(10),
+    llvm::cl::desc("The minimum number of instructions in a region which ends "
+                   "in an unreachable for it to be outlined"));
+
+/// Collect the blocks of \p F from which every path ends in an unreachable.
+static void findNoReturnBlocks(SILFunction &F,
+                               llvm::SmallPtrSetImpl<SILBasicBlock *> &Blocks) {
+  SmallVector<SILBasicBlock *, 16> Worklist;
+  for (auto &BB : F) {
+    if (isa<UnreachableInst>(BB.getTerminator())) {
+      Blocks.insert(&BB);
+      Worklist.push_back(&BB);
+    }
+  }
+
+  while (!Worklist.empty()) {
+    SILBasicBlock *BB = Worklist.pop_back_val();
+    for (auto *Pred : BB->getPreds()) {
+      if (Blocks.count(Pred))
+        continue;
+      auto Succs = Pred->getSuccessors();
+      if (std::all_of(Succs.begin(), Succs.end(),
+                      [&](const SILSuccessor &Succ) {
+                        return Blocks.count(Succ.getBB());
+                      })) {
+        Blocks.insert(Pred);
+        Worklist.push_back(Pred);
+      }
+    }
+  }
+}
+
+/// Returns true if the type of \p V depends on the generic context or the
+/// dynamic Self type of its function, which the outlined function doesn't
+/// have.
+static bool hasContextDependentType(SILValue V) {
+  CanType Ty = V->getType().getSwiftRValueType();
+  return Ty->hasArchetype() || Ty->hasDynamicSelfType();
+}
+
+/// Returns true if \p I can be moved into another function.
+static bool canOutline(SILInstruction &I) {
+  // Stack allocations have to be balanced within their function.
+  if (isa<AllocStackInst>(&I) || isa<DeallocStackInst>(&I))
+    return false;
+
+  if (hasContextDependentType(&I))
+    return false;
+  for (auto &Op : I.getAllOperands())
+    if (hasContextDependentType(Op.get()))
+      return false;
+  return true;
+}
+
+namespace {
+/// A single-entry region of blocks which can only end in an unreachable.
+struct ColdRegion {
+  SILBasicBlock *Entry;
+  /// The blocks of the region, starting with the entry.
+  llvm::SmallSetVector<SILBasicBlock *, 8> Blocks;
+  /// The values the region uses which are defined outside of it, starting
+  /// with the arguments of the entry.
+  llvm::SmallSetVector<SILValue, 8> Captured;
+  /// The number of instructions in the region.
+  unsigned Size = 0;
+
+  ColdRegion(SILBasicBlock *Entry) : Entry(Entry) {}
+
+  /// Collect the blocks reachable from the entry, which all end in an
+  /// unreachable. Returns false if the region can't be outlined.
+  bool collect();
+};
+} // end anonymous namespace
+
+bool ColdRegion::collect() {
+  Blocks.insert(Entry);
+  for (unsigned i = 0; i < Blocks.size(); ++i) {
+    for (auto &Succ : Blocks[i]->getSuccessors()) {
+      // The entry becomes the outlined function's entry, which must not have
+      // any predecessors.
+      if (Succ.getBB() == Entry)
+        return false;
+      Blocks.insert(Succ.getBB());
+    }
+  }
+
+  for (auto *Arg : Entry->getBBArgs()) {
+    if (hasContextDependentType(Arg))
+      return false;
+    Captured.insert(Arg);
+  }
+
+  for (auto *BB : Blocks) {
+    for (auto *Arg : BB->getBBArgs())
+      if (hasContextDependentType(Arg))
+        return false;
+
+    for (auto &I : *BB) {
+      if (!canOutline(I))
+        return false;
+      if (!isa<DebugValueInst>(&I) && !isa<DebugValueAddrInst>(&I))
+        ++Size;
+
+      for (auto &Op : I.getAllOperands()) {
+        SILValue V = Op.get();
+        SILBasicBlock *DefBB = V->getParentBB();
+        if (DefBB && !Blocks.count(DefBB))
+          Captured.insert(V);
+      }
+    }
+  }
+  return true;
+}
+
+namespace {
+/// Clones a cold region into the function it is outlined to.
+class ColdRegionCloner : public SILClonerWithScopes<ColdRegionCloner> {
+  friend class SILVisitor<ColdRegionCloner>;
+  friend class SILCloner<ColdRegionCloner>;
+
+public:
+  ColdRegionCloner(SILFunction &Outlined)
+      : SILClonerWithScopes<ColdRegionCloner>(Outlined) {}
+
+  void cloneRegion(ColdRegion &Region);
+};
+} // end anonymous namespace
+
+void ColdRegionCloner::cloneRegion(ColdRegion &Region) {
+  SILFunction &Outlined = getBuilder().getFunction();
+  SILModule &M = Outlined.getModule();
+
+  // The captured values become the arguments of the outlined function.
+  SILBasicBlock *EntryBB = Outlined.createBasicBlock();
+  for (SILValue V : Region.Captured) {
+    SILValue Arg = new (M) SILArgument(EntryBB, V->getType());
+    ValueMap.insert(std::make_pair(V, Arg));
+  }
+
+  // Recursively visit the region's blocks in depth-first preorder, cloning
+  // all instructions other than terminators.
+  BBMap.insert(std::make_pair(Region.Entry, EntryBB));
+  getBuilder().setInsertionPoint(EntryBB);
+  visitSILBasicBlock(Region.Entry);
+
+  // Now iterate over the blocks and fix up the terminators.
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    getBuilder().setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+}
+
+/// Create the function \p Region of \p F is outlined to.
+static SILFunction *createOutlinedFunction(SILFunction *F,
+                                           ColdRegion &Region) {
+  SILModule &M = F->getModule();
+
+  // The caller keeps the captured values alive, since it never gets past the
+  // call.
+  SmallVector<SILParameterInfo, 8> Params;
+  for (SILValue V : Region.Captured) {
+    SILType Ty = V->getType();
+    ParameterConvention Convention;
+    if (Ty.isAddress())
+      Convention = ParameterConvention::Indirect_InoutAliasable;
+    else if (Ty.isTrivial(M))
+      Convention = ParameterConvention::Direct_Unowned;
+    else
+      Convention = ParameterConvention::Direct_Guaranteed;
+    Params.push_back(SILParameterInfo(Ty.getSwiftRValueType(), Convention));
+  }
+
+  auto ExtInfo = SILFunctionType::ExtInfo()
+                     .withRepresentation(SILFunctionTypeRepresentation::Thin)
+                     .withIsNoReturn();
+  auto FnTy = SILFunctionType::get(nullptr, ExtInfo,
+                                   ParameterConvention::Direct_Unowned, Params,
+                                   ArrayRef<SILResultInfo>(), None,
+                                   M.getASTContext());
+
+  std::string Name;
+  for (unsigned i = 0;; ++i) {
+    Name = (F->getName() + "_cold" + llvm::Twine(i)).str();
+    if (!M.lookUpFunction(Name))
+      break;
+  }
+
+  auto *Outlined = M.createFunction(
+      SILLinkage::Private, Name, FnTy, /*contextGenericParams*/ nullptr,
+      F->getLocation(), IsBare, IsNotTransparent, IsNotFragile, IsNotThunk,
+      SILFunction::NotRelevant, NoInline, EffectsKind::Unspecified,
+      /*InsertBefore*/ F, F->getDebugScope(), F->getDeclContext());
+  Outlined->addSemanticsAttr("arc.programtermination_point");
+
+  ColdRegionCloner Cloner(*Outlined);
+  Cloner.cloneRegion(Region);
+  return Outlined;
+}
+
+/// Replace the body of the region's entry with a call to \p Outlined. The
+/// rest of the region's blocks are left unreachable by this.
+static void replaceRegionWithCall(ColdRegion &Region, SILFunction *Outlined) {
+  SILBasicBlock *Entry = Region.Entry;
+  TermInst *Term = Entry->getTerminator();
+  RegularLocation Loc(Term->getLoc().getSourceLoc());
+
+  SILBuilderWithScope B(Term);
+  auto *FRI = B.createFunctionRef(Loc, Outlined);
+  SmallVector<SILValue, 8> Args(Region.Captured.begin(),
+                                Region.Captured.end());
+  B.createApply(Loc, FRI, Args, false);
+
+  for (auto It = Entry->begin(); &*It != FRI;) {
+    SILInstruction *I = &*It++;
+    I->replaceAllUsesWithUndef();
+    I->eraseFromParent();
+  }
+  Term->eraseFromParent();
+
+  B.setInsertionPoint(Entry);
+  B.createUnreachable(ArtificialUnreachableLocation());
+}
+
+/// Remove the blocks of \p F which are not reachable from its entry.
+static void removeUnreachableBlocks(SILFunction &F) {
+  llvm::SmallPtrSet<SILBasicBlock *, 32> Reachable;
+  SmallVector<SILBasicBlock *, 32> Worklist;
+  Worklist.push_back(&*F.begin());
+  Reachable.insert(&*F.begin());
+  while (!Worklist.empty()) {
+    for (auto &Succ : Worklist.pop_back_val()->getSuccessors())
+      if (Reachable.insert(Succ.getBB()).second)
+        Worklist.push_back(Succ.getBB());
+  }
+
+  SmallVector<SILBasicBlock *, 8> DeadBlocks;
+  for (auto &BB : F)
+    if (!Reachable.count(&BB))
+      DeadBlocks.push_back(&BB);
+
+  // Dead blocks may use values of other dead blocks, so empty all of them
+  // before erasing any.
+  for (auto *BB : DeadBlocks)
+    clearBlockBody(BB);
+  for (auto *BB : DeadBlocks)
+    BB->eraseFromParent();
+}
+
+namespace {
+class ColdBlockOutlining : public SILFunctionTransform {
+  /// The main entry point of the optimization.
+  void run() override {
+    SILFunction *F = getFunction();
+
+    // The outlined function has no generic context and isn't serialized, so
+    // it can't take code from functions that need either.
+    if (F->getContextGenericParams() || F->isFragile() ||
+        F->isTransparent() ||
+        F->hasSemanticsAttr("arc.programtermination_point"))
+      return;
+
+    llvm::SmallPtrSet<SILBasicBlock *, 16> NoReturnBlocks;
+    findNoReturnBlocks(*F, NoReturnBlocks);
+    if (NoReturnBlocks.empty())
+      return;
+
+    // A region starts where control can't return anymore. Visit the regions
+    // in post order, so that a region reachable from another one is outlined
+    // first and is then only called from the other one's outlined function.
+    SmallVector<SILBasicBlock *, 8> Entries;
+    auto *PO = getAnalysis<PostOrderAnalysis>()->get(F);
+    for (auto *BB : PO->getPostOrder()) {
+      if (!NoReturnBlocks.count(BB) || BB == &*F->begin())
+        continue;
+      for (auto *Pred : BB->getPreds()) {
+        if (!NoReturnBlocks.count(Pred)) {
+          Entries.push_back(BB);
+          break;
+        }
+      }
+    }
+
+    SmallVector<SILFunction *, 4> NewFunctions;
+    for (auto *Entry : Entries) {
+      ColdRegion Region(Entry);
+      if (!Region.collect())
+        continue;
+
+      // The call which replaces the region takes a function_ref, an apply
+      // with one argument per captured value, and the unreachable.
+      if (Region.Size < ColdOutliningMinSize ||
+          Region.Size <= Region.Captured.size() + 3)
+        continue;
+
+      SILFunction *Outlined = createOutlinedFunction(F, Region);
+      replaceRegionWithCall(Region, Outlined);
+      NewFunctions.push_back(Outlined);
+
+      DEBUG(llvm::dbgs() << "Outlined a region of " << Region.Size
+                         << " instructions from " << F->getName() << " into "
+                         << Outlined->getName() << "\n");
+      ++NumRegionsOutlined;
+      NumInstructionsOutlined += Region.Size;
+    }
+
+    if (NewFunctions.empty())
+      return;
+
+    removeUnreachableBlocks(*F);
+    invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+
+    // Give the outlined functions the same optimizations as the callers.
+    for (auto *NewF : NewFunctions)
+      notifyPassManagerOfFunction(NewF);
+  }
+
+  StringRef getName() override { return "Cold Block Outlining"; }
+};
+} // end anonymous namespace
+
+SILTransform *swift::createColdBlockOutlining() {
+  return new ColdBlockOutlining();
+}
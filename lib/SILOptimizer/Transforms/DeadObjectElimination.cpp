@@ -647,6 +647,200 @@ static bool removeAndReleaseArray(SILValue NewArrayValue, bool &CFGChanged) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+//                         Dead Mutated Array Elimination
+//===----------------------------------------------------------------------===//
+
+/// Returns true if the argument \p Idx of the call \p AI can be dropped when
+/// the call is removed. Owned arguments are released instead.
+static bool isRemovableArgument(ApplyInst *AI, unsigned Idx) {
+  SILValue Arg = AI->getArgument(Idx);
+  if (Arg->getType().isTrivial(AI->getModule()))
+    return true;
+
+  switch (AI->getArgumentConvention(Idx)) {
+  case SILArgumentConvention::Direct_Owned:
+  case SILArgumentConvention::Direct_Guaranteed:
+  case SILArgumentConvention::Direct_Unowned:
+  case SILArgumentConvention::Indirect_In_Guaranteed:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Returns true if all arguments of the array semantics call \p AI, except
+/// the array itself, can be dropped when the call is removed.
+static bool hasRemovableArguments(ApplyInst *AI, SILValue Array) {
+  for (unsigned Idx = 0, E = AI->getNumArguments(); Idx != E; ++Idx) {
+    SILValue Arg = AI->getArgument(Idx);
+    if (AI->hasSelfArgument() && Idx == E - 1)
+      continue;
+    if (Arg == Array || !isRemovableArgument(AI, Idx))
+      return false;
+  }
+  return true;
+}
+
+/// Releases the owned arguments of a removed array semantics call \p AI,
+/// except the array itself. Those are typically elements appended to the
+/// array.
+static void releaseOwnedArguments(ApplyInst *AI) {
+  SILBuilderWithScope B(AI);
+  for (unsigned Idx = 0, E = AI->getNumArguments(); Idx != E; ++Idx) {
+    if (AI->hasSelfArgument() && Idx == E - 1)
+      continue;
+    SILValue Arg = AI->getArgument(Idx);
+    if (Arg->getType().isTrivial(AI->getModule()) ||
+        AI->getArgumentConvention(Idx) != SILArgumentConvention::Direct_Owned)
+      continue;
+    B.createReleaseValue(AI->getLoc(), Arg, Atomicity::Atomic);
+  }
+}
+
+/// Collects the instructions which use the array created by the array.init
+/// call \p ArrayInit, if the array is never read.
+///
+/// Besides retains and releases, the array may be stored into alloc_stacks.
+/// Those may be passed as self to "mutating" array semantics calls, e.g. the
+/// make_mutable and mutate_unknown calls of an inlined append or
+/// reserveCapacity. The resulting count or capacity may be read, but only by
+/// calls which are removed as well.
+///
+/// Returns false if the array may be observed by other instructions.
+static bool collectDeadArrayUsers(ApplyInst *ArrayInit, UserList &Users) {
+  llvm::SmallVector<SILValue, 8> ValueWorklist;
+  llvm::SmallVector<AllocStackInst *, 4> AddressWorklist;
+  llvm::SmallPtrSet<ValueBase *, 16> ArrayValues;
+  llvm::SmallPtrSet<AllocStackInst *, 4> ArrayAddresses;
+  llvm::SmallVector<StoreInst *, 8> AddressStores;
+
+  ValueWorklist.push_back(ArrayInit);
+  ArrayValues.insert(ArrayInit);
+  Users.insert(ArrayInit);
+
+  while (!ValueWorklist.empty() || !AddressWorklist.empty()) {
+    if (!ValueWorklist.empty()) {
+      SILValue V = ValueWorklist.pop_back_val();
+      for (auto *Op : V->getUses()) {
+        auto *User = Op->getUser();
+        if (isa<RefCountingInst>(User) || isa<DebugValueInst>(User)) {
+          Users.insert(User);
+          continue;
+        }
+        if (auto *SEI = dyn_cast<StructExtractInst>(User)) {
+          if (ArrayValues.insert(SEI).second)
+            ValueWorklist.push_back(SEI);
+          Users.insert(SEI);
+          continue;
+        }
+        if (auto *SI = dyn_cast<StoreInst>(User)) {
+          auto *ASI = dyn_cast<AllocStackInst>(SI->getDest());
+          if (!ASI || Op->get() != SI->getSrc())
+            return false;
+          if (ArrayAddresses.insert(ASI).second)
+            AddressWorklist.push_back(ASI);
+          continue;
+        }
+        // Non-mutating semantics calls which read the storage descriptor.
+        ArraySemanticsCall Call(User);
+        switch (Call.getKind()) {
+        case ArrayCallKind::kGetCount:
+        case ArrayCallKind::kGetCapacity:
+        case ArrayCallKind::kArrayPropsIsNativeTypeChecked:
+          if (Call.getSelf() != V || !hasRemovableArguments(Call, V))
+            return false;
+          Users.insert(User);
+          continue;
+        default:
+          DEBUG(llvm::dbgs() << "        Found a read of the array: " << *User);
+          return false;
+        }
+      }
+      continue;
+    }
+
+    AllocStackInst *ASI = AddressWorklist.pop_back_val();
+    Users.insert(ASI);
+    for (auto *Op : ASI->getUses()) {
+      auto *User = Op->getUser();
+      if (isa<DeallocStackInst>(User) || isa<DestroyAddrInst>(User) ||
+          isa<DebugValueAddrInst>(User)) {
+        Users.insert(User);
+        continue;
+      }
+      if (auto *SI = dyn_cast<StoreInst>(User)) {
+        if (Op->get() != SI->getDest())
+          return false;
+        // The stored value is checked when all array values are known.
+        AddressStores.push_back(SI);
+        Users.insert(SI);
+        continue;
+      }
+      if (auto *LI = dyn_cast<LoadInst>(User)) {
+        if (ArrayValues.insert(LI).second)
+          ValueWorklist.push_back(LI);
+        Users.insert(LI);
+        continue;
+      }
+      // Mutating semantics calls, which only write the array state.
+      ArraySemanticsCall Call(User);
+      switch (Call.getKind()) {
+      case ArrayCallKind::kMakeMutable:
+      case ArrayCallKind::kMutateUnknown:
+        if (Call.getSelf() != ASI || !hasRemovableArguments(Call, ASI))
+          return false;
+        Users.insert(User);
+        continue;
+      default:
+        DEBUG(llvm::dbgs() << "        Found an escaping use: " << *User);
+        return false;
+      }
+    }
+  }
+
+  // The alloc_stacks must not contain anything else than the array.
+  for (StoreInst *SI : AddressStores)
+    if (!ArrayValues.count(SI->getSrc()))
+      return false;
+
+  // Results of the removed instructions, e.g. the array count, may only be
+  // used by other removed instructions.
+  for (SILInstruction *I : Users) {
+    if (ArrayValues.count(I))
+      continue;
+    for (auto *Op : I->getUses())
+      if (!Users.count(Op->getUser()))
+        return false;
+  }
+  return true;
+}
+
+/// Attempt to remove the array created by \p ArrayInit, including all the
+/// semantics calls which mutate it, if the array is never read.
+static bool removeDeadMutatedArray(ApplyInst *ArrayInit) {
+  if (!hasRemovableArguments(ArrayInit, SILValue()))
+    return false;
+
+  UserList Users;
+  if (!collectDeadArrayUsers(ArrayInit, Users))
+    return false;
+
+  // Release the elements which were passed to the removed calls.
+  for (SILInstruction *I : Users)
+    if (auto *AI = dyn_cast<ApplyInst>(I))
+      releaseOwnedArguments(AI);
+
+  // Delete the uses before the definitions. Remaining uses are replaced by
+  // undef, so the order does not matter otherwise.
+  removeInstructions(
+      ArrayRef<SILInstruction *>(Users.begin(), Users.end()).slice(1));
+  DEBUG(llvm::dbgs() << "    Success! Eliminating array.init(...).\n");
+  eraseUsesOfInstruction(ArrayInit);
+  recursivelyDeleteTriviallyDeadInstructions(ArrayInit, true);
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                            Function Processing
 //===----------------------------------------------------------------------===//
@@ -655,7 +849,8 @@ static bool removeAndReleaseArray(SILValue NewArrayValue, bool &CFGChanged) {
 /// side effect?
 static bool isAllocatingApply(SILInstruction *Inst) {
   ArraySemanticsCall ArrayAlloc(Inst);
-  return ArrayAlloc.getKind() == ArrayCallKind::kArrayUninitialized;
+  return ArrayAlloc.getKind() == ArrayCallKind::kArrayUninitialized ||
+         ArrayAlloc.getKind() == ArrayCallKind::kArrayInit;
 }
 
 namespace {
@@ -775,7 +970,15 @@ bool DeadObjectElimination::processAllocStack(AllocStackInst *ASI) {
 }
 
 bool DeadObjectElimination::processAllocApply(ApplyInst *AI) {
-  // Currently only handle array.uninitialized
+  // An array.init array, which is only mutated, but never read.
+  if (ArraySemanticsCall(AI).getKind() == ArrayCallKind::kArrayInit) {
+    if (!removeDeadMutatedArray(AI))
+      return false;
+    ++DeadAllocApplyEliminated;
+    return true;
+  }
+
+  // Otherwise handle array.uninitialized
   if (ArraySemanticsCall(AI).getKind() != ArrayCallKind::kArrayUninitialized)
     return false;
 
@@ -799,6 +1002,18 @@ bool DeadObjectElimination::processAllocApply(ApplyInst *AI) {
   assert(AI->use_empty() && "All users should have been removed.");
   recursivelyDeleteTriviallyDeadInstructions(AI, true);
   if (AllocBufferAI) {
+    // If the buffer was promoted to the stack, its only remaining uses are
+    // the calls to swift_bufferDeallocateFromStack.
+    SmallVector<SILInstruction *, 2> Deallocs;
+    for (Operand *Use : getNonDebugUses(AllocBufferAI))
+      Deallocs.push_back(Use->getUser());
+    for (SILInstruction *Dealloc : Deallocs) {
+      auto *DeallocFRI = cast<FunctionRefInst>(
+          cast<ApplyInst>(Dealloc)->getCallee());
+      Dealloc->eraseFromParent();
+      if (DeallocFRI->use_empty())
+        DeallocFRI->eraseFromParent();
+    }
     recursivelyDeleteTriviallyDeadInstructions(AllocBufferAI, true);
   }
   ++DeadAllocApplyEliminated;
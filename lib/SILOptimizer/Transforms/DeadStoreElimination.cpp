@@ -160,10 +160,15 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run DSE on functions with 256 basic blocks and 256 locations,
-/// which is a large function.  
+/// The locations are processed in partitions such that # of BBs x(times) # of
+/// locations in a partition does not exceed this limit, i.e. 256 basic blocks
+/// and 256 locations.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
+/// The minimum size of a partition of locations. Very large functions are
+/// processed with partitions of this size, using the one iteration data flow.
+constexpr unsigned MinLSLocationPartitionSize = 64;
+
 /// we could run optimistic DSE on functions with less than 64 basic blocks
 /// and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
@@ -248,12 +253,11 @@ public:
   llvm::DenseMap<SILValue, SILValue> LiveStores;
 
   /// Constructors.
-  BlockState(SILBasicBlock *B, unsigned LocationNum, bool Optimistic) 
-      : BB(B), LocationNum(LocationNum) {
-    init(LocationNum, Optimistic);
-  }
+  BlockState(SILBasicBlock *B) : BB(B), LocationNum(0) {}
 
-  /// Initialize the bitvectors for the current basic block.
+  /// Initialize the bitvectors for the current basic block. This is done for
+  /// every partition of locations. The dead and live stores found in earlier
+  /// partitions are kept.
   void init(unsigned LocationNum, bool Optimistic);
 
   /// Check whether the BBWriteSetIn has changed. If it does, we need to rerun
@@ -332,10 +336,21 @@ private:
   llvm::SmallDenseMap<SILBasicBlock *, BlockState *> BBToLocState;
 
   /// Keeps all the locations for the current function. The BitVector in each
-  /// BlockState is then laid on top of it to keep track of which LSLocation
-  /// has an upward visible store.
+  /// BlockState is then laid on top of the current partition of it to keep
+  /// track of which LSLocation has an upward visible store.
   std::vector<LSLocation> LocationVault;
 
+  /// The range of the LocationVault which is currently processed.
+  unsigned PartitionBegin = 0;
+  unsigned PartitionEnd = 0;
+
+  /// The number of reachable basic blocks in the function.
+  unsigned BBCount = 0;
+
+  /// True if the data flow converges in one iteration, because every basic
+  /// block has all its successors processed in post order.
+  bool RunOneIteration = true;
+
   /// Keeps a list of basic blocks that have StoreInsts. If a basic block does
   /// not have StoreInst, we do not actually perform the last iteration where
   /// DSE is actually performed on the basic block.
@@ -369,8 +384,8 @@ private:
   /// There is a read to a location, expand the location into individual fields
   /// before processing them.
   void processRead(SILInstruction *Inst, SILValue M, DSEKind K);
-  void processReadForGenKillSet(BlockState *S, unsigned bit);
-  void processReadForDSE(BlockState *S, unsigned Bit);
+  void processReadForGenKillSet(BlockState *S, LSLocation &R);
+  void processReadForDSE(BlockState *S, LSLocation &R);
 
   /// There is a write to a location, expand the location into individual fields
   /// before processing them.
@@ -422,9 +437,12 @@ private:
   void invalidateBaseForGenKillSet(SILValue B, BlockState *S);
   void invalidateBaseForDSE(SILValue B, BlockState *S);
 
-  /// Get the bit representing the location in the LocationVault.
+  /// Get the bit representing the location in the current partition.
   unsigned getLocationBit(const LSLocation &L);
 
+  /// Returns true if the location is in the current partition.
+  bool isTrackedLocation(const LSLocation &L);
+
 public:
   /// Constructor.
   DSEContext(SILFunction *F, SILModule *M, SILPassManager *PM,
@@ -439,8 +457,10 @@ public:
   /// Run the iterative DF to converge the BBWriteSetIn.
   void runIterativeDSE();
 
-  /// Returns the location vault of the current function.
-  std::vector<LSLocation> &getLocationVault() { return LocationVault; }
+  /// Given the bit, get the location from the current partition.
+  LSLocation &getLocation(unsigned Bit) {
+    return LocationVault[PartitionBegin + Bit];
+  }
 
   /// Returns the epilogue release matcher we are using.
   ConsumedArgToEpilogueReleaseMatcher &getERM() const { return ERM; }
@@ -449,6 +469,12 @@ public:
   /// one iteration data flow on the function.
   ProcessKind getProcessFunctionKind(unsigned StoreCount);
 
+  /// Returns how to process a partition of \p LocationCount locations.
+  ProcessKind getProcessPartitionKind(unsigned LocationCount);
+
+  /// Run DSE on the locations in [\p Begin, \p End) of the LocationVault.
+  void processPartition(unsigned Begin, unsigned End);
+
   /// Compute the kill set for the basic block. return true if the store set
   /// changes.
   void processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic);
@@ -486,19 +512,20 @@ void BlockState::init(unsigned LocationNum, bool Optimistic) {
   // However, by doing so, we can only eliminate the dead stores after the
   // data flow stabilizes.
   //
-  BBWriteSetIn.resize(LocationNum, Optimistic);
-  BBWriteSetOut.resize(LocationNum, false);
-  BBWriteSetMid.resize(LocationNum, false);
+  this->LocationNum = LocationNum;
+  BBWriteSetIn = llvm::SmallBitVector(LocationNum, Optimistic);
+  BBWriteSetOut = llvm::SmallBitVector(LocationNum, false);
+  BBWriteSetMid = llvm::SmallBitVector(LocationNum, false);
 
   // GenSet and KillSet initially empty.
-  BBGenSet.resize(LocationNum, false);
-  BBKillSet.resize(LocationNum, false);
+  BBGenSet = llvm::SmallBitVector(LocationNum, false);
+  BBKillSet = llvm::SmallBitVector(LocationNum, false);
 
   // MaxStoreSet is optimistically set to true initially.
-  BBMaxStoreSet.resize(LocationNum, true);
+  BBMaxStoreSet = llvm::SmallBitVector(LocationNum, true);
 
   // DeallocateLocation initially empty.
-  BBDeallocateLocation.resize(LocationNum, false);
+  BBDeallocateLocation = llvm::SmallBitVector(LocationNum, false);
 }
 
 unsigned DSEContext::getLocationBit(const LSLocation &Loc) {
@@ -509,7 +536,15 @@ unsigned DSEContext::getLocationBit(const LSLocation &Loc) {
   // point.
   auto Iter = LocToBitIndex.find(Loc);
   assert(Iter != LocToBitIndex.end() && "LSLocation should have been enum'ed");
-  return Iter->second;
+  assert(Iter->second >= PartitionBegin && Iter->second < PartitionEnd &&
+         "LSLocation should be in the current partition");
+  return Iter->second - PartitionBegin;
+}
+
+bool DSEContext::isTrackedLocation(const LSLocation &Loc) {
+  auto Iter = LocToBitIndex.find(Loc);
+  assert(Iter != LocToBitIndex.end() && "LSLocation should have been enum'ed");
+  return Iter->second >= PartitionBegin && Iter->second < PartitionEnd;
 }
 
 DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount) {
@@ -521,9 +556,8 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
   if (StoreCount < 1)
     return ProcessKind::ProcessNone;
 
-  bool RunOneIteration = true;
-  unsigned BBCount = 0;
-  unsigned LocationCount = LocationVault.size();
+  if (LocationVault.empty())
+    return ProcessKind::ProcessNone;
 
   // If all basic blocks will have their successors processed if
   // the basic blocks in the functions are iterated in post order.
@@ -542,16 +576,17 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
-    return ProcessKind::ProcessNone;
+  return getProcessPartitionKind(LocationVault.size());
+}
 
+DSEContext::ProcessKind
+DSEContext::getProcessPartitionKind(unsigned LocationCount) {
   // This function's data flow would converge in 1 iteration.
   if (RunOneIteration)
     return ProcessKind::ProcessPessimistic;
   
   // We run one pessimistic data flow to do dead store elimination on
-  // the function.
+  // the partition.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
     return ProcessKind::ProcessPessimistic;
 
@@ -648,12 +683,11 @@ void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
 }
 
 void BlockState::initStoreSetAtEndOfBlock(DSEContext &Ctx) {
-  std::vector<LSLocation> &LocationVault = Ctx.getLocationVault();
   // We set the store bit at the end of the basic block in which a stack
   // allocated location is deallocated.
-  for (unsigned i = 0; i < LocationVault.size(); ++i) {
+  for (unsigned i = 0; i < LocationNum; ++i) {
     // Turn on the store bit at the block which the stack slot is deallocated.
-    if (auto *ASI = dyn_cast<AllocStackInst>(LocationVault[i].getBase())) {
+    if (auto *ASI = dyn_cast<AllocStackInst>(Ctx.getLocation(i).getBase())) {
       for (auto X : findDeallocStackInst(ASI)) {
         SILBasicBlock *DSIBB = X->getParent();
         if (DSIBB != BB)
@@ -700,7 +734,7 @@ void DSEContext::mergeSuccessorLiveIns(SILBasicBlock *BB) {
 
 void DSEContext::invalidateBaseForGenKillSet(SILValue B, BlockState *S) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (LocationVault[i].getBase() != B)
+    if (getLocation(i).getBase() != B)
       continue;
     S->startTrackingLocation(S->BBKillSet, i);
     S->stopTrackingLocation(S->BBGenSet, i);
@@ -711,7 +745,7 @@ void DSEContext::invalidateBaseForDSE(SILValue B, BlockState *S) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->BBWriteSetMid.test(i))
       continue;
-    if (LocationVault[i].getBase() != B)
+    if (getLocation(i).getBase() != B)
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
   }
@@ -736,32 +770,33 @@ void DSEContext::invalidateBase(SILValue B, BlockState *S, DSEKind Kind) {
   llvm_unreachable("Unknown DSE compute kind");
 }
 
-void DSEContext::processReadForDSE(BlockState *S, unsigned bit) {
+void DSEContext::processReadForDSE(BlockState *S, LSLocation &R) {
   // Remove any may/must-aliasing stores to the LSLocation, as they can't be
   // used to kill any upward visible stores due to the interfering load.
-  LSLocation &R = LocationVault[bit];
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->isTrackingLocation(S->BBWriteSetMid, i))
       continue;
-    LSLocation &L = LocationVault[i];
+    LSLocation &L = getLocation(i);
     if (!L.isMayAliasLSLocation(R, AA))
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
   }
 }
 
-void DSEContext::processReadForGenKillSet(BlockState *S, unsigned bit) {
+void DSEContext::processReadForGenKillSet(BlockState *S, LSLocation &R) {
   // Start tracking the read to this LSLocation in the killset and update
   // the genset accordingly.
   //
   // Even though, LSLocations are canonicalized, we still need to consult
   // alias analysis to determine whether 2 LSLocations are disjointed.
-  LSLocation &R = LocationVault[bit];
+  //
+  // The read location may be in another partition than the tracked
+  // locations, but it can still alias them.
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->BBMaxStoreSet.test(i))
       continue;
     // Do nothing if the read location NoAlias with the current location.
-    LSLocation &L = LocationVault[i];
+    LSLocation &L = getLocation(i);
     if (!L.isMayAliasLSLocation(R, AA))
       continue;
     // Update the genset and kill set.
@@ -809,7 +844,7 @@ void DSEContext::processRead(SILInstruction *I, SILValue Mem, DSEKind Kind) {
   if (isBuildingGenKillSet(Kind)) {
     for (auto &E : Locs) {
       // Only building the gen and kill sets for now.
-      processReadForGenKillSet(S, getLocationBit(E));
+      processReadForGenKillSet(S, E);
     }
     return;
   }
@@ -818,7 +853,7 @@ void DSEContext::processRead(SILInstruction *I, SILValue Mem, DSEKind Kind) {
   if (isPerformingDSE(Kind)) {
     for (auto &E : Locs) {
       // This is the last iteration, compute BBWriteSetOut and perform DSE. 
-      processReadForDSE(S, getLocationBit(E));
+      processReadForDSE(S, E);
     }
     return;
   }
@@ -829,12 +864,12 @@ void DSEContext::processRead(SILInstruction *I, SILValue Mem, DSEKind Kind) {
 bool DSEContext::processWriteForDSE(BlockState *S, unsigned bit) {
   // If a tracked store must aliases with this store, then this store is dead.
   bool StoreDead = false;
-  LSLocation &R = LocationVault[bit];
+  LSLocation &R = getLocation(bit);
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->isTrackingLocation(S->BBWriteSetMid, i))
       continue;
     // If 2 locations may alias, we can still keep both stores.
-    LSLocation &L = LocationVault[i];
+    LSLocation &L = getLocation(i);
     if (!L.isMustAliasLSLocation(R, AA))
       continue;
     // There is a must alias store. No need to check further.
@@ -891,6 +926,14 @@ void DSEContext::processWrite(SILInstruction *I, SILValue Val, SILValue Mem,
   LSLocation::expand(L, Mod, Locs, TE);
   llvm::SmallBitVector V(Locs.size());
 
+  // Stores to locations which are not in the current partition are handled
+  // when their partition is processed. A store never kills an upward visible
+  // store to another location.
+  for (auto &E : Locs) {
+    if (!isTrackedLocation(E))
+      return;
+  }
+
   // Are we computing max store set.
   if (isComputeMaxStoreSet(Kind)) {
     for (auto &E : Locs) {
@@ -994,7 +1037,7 @@ void DSEContext::processDebugValueAddrInstForGenKillSet(SILInstruction *I) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->BBMaxStoreSet.test(i))
       continue;
-    if (AA->isNoAlias(Mem, LocationVault[i].getBase()))
+    if (AA->isNoAlias(Mem, getLocation(i).getBase()))
       continue;
     S->stopTrackingLocation(S->BBGenSet, i);
     S->startTrackingLocation(S->BBKillSet, i);
@@ -1007,7 +1050,7 @@ void DSEContext::processDebugValueAddrInstForDSE(SILInstruction *I) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->isTrackingLocation(S->BBWriteSetMid, i))
       continue;
-    if (AA->isNoAlias(Mem, LocationVault[i].getBase()))
+    if (AA->isNoAlias(Mem, getLocation(i).getBase()))
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
   }
@@ -1034,7 +1077,7 @@ void DSEContext::processUnknownReadInstForGenKillSet(SILInstruction *I) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->BBMaxStoreSet.test(i))
       continue;
-    if (!AA->mayReadFromMemory(I, LocationVault[i].getBase()))
+    if (!AA->mayReadFromMemory(I, getLocation(i).getBase()))
       continue;
     // Update the genset and kill set.
     S->startTrackingLocation(S->BBKillSet, i);
@@ -1047,7 +1090,7 @@ void DSEContext::processUnknownReadInstForDSE(SILInstruction *I) {
   for (unsigned i = 0; i < S->LocationNum; ++i) {
     if (!S->isTrackingLocation(S->BBWriteSetMid, i))
       continue;
-    if (!AA->mayReadFromMemory(I, LocationVault[i].getBase()))
+    if (!AA->mayReadFromMemory(I, getLocation(i).getBase()))
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
   }
@@ -1132,30 +1175,20 @@ void DSEContext::runIterativeDSE() {
   }
 }
 
-bool DSEContext::run() {
-  std::pair<int, int> LSCount = std::make_pair(0, 0);
-  // Walk over the function and find all the locations accessed by
-  // this function.
-  LSLocation::enumerateLSLocations(*F, LocationVault, LocToBitIndex,
-                                   BaseToLocIndex, TE, LSCount);
-
-  // Check how to optimize this function.
-  ProcessKind Kind = getProcessFunctionKind(LSCount.second);
-  
-  // We do not optimize this function at all.
-  if (Kind == ProcessKind::ProcessNone)
-    return false;
+void DSEContext::processPartition(unsigned Begin, unsigned End) {
+  PartitionBegin = Begin;
+  PartitionEnd = End;
+  DEBUG(llvm::dbgs() << "Processing locations " << Begin << " to " << End
+                     << " of " << LocationVault.size() << "\n");
 
   // Do we run a pessimistic data flow ?
-  bool Optimistic = Kind == ProcessKind::ProcessOptimistic ? true : false;
+  bool Optimistic = getProcessPartitionKind(End - Begin) ==
+                        ProcessKind::ProcessOptimistic;
 
   // For all basic blocks in the function, initialize a BB state.
-  //
-  // Initialize the BBToLocState mapping.
-  unsigned LocationNum = this->getLocationVault().size();
   for (auto &B : *F) {
-    auto *State = new (BPA.Allocate()) BlockState(&B, LocationNum, Optimistic);
-    BBToLocState[&B] = State;
+    BlockState *State = getBlockState(&B);
+    State->init(End - Begin, Optimistic);
     State->initStoreSetAtEndOfBlock(*this);
   }
 
@@ -1175,6 +1208,9 @@ bool DSEContext::run() {
   // Phase 1 - 3 are only performed when we know the data flow will not
   // converge in a single iteration. Otherwise, we only run phase 4 and 5
   // on the function.
+  //
+  // Phase 1 - 4 are performed for each partition of locations, phase 5 once
+  // all partitions are processed.
 
   // We need to run the iterative data flow on the function.
   if (Optimistic) {
@@ -1188,6 +1224,38 @@ bool DSEContext::run() {
   for (SILBasicBlock *B : PO->getPostOrder()) {
     processBasicBlockForDSE(B, Optimistic);
   }
+}
+
+bool DSEContext::run() {
+  std::pair<int, int> LSCount = std::make_pair(0, 0);
+  // Walk over the function and find all the locations accessed by
+  // this function.
+  LSLocation::enumerateLSLocations(*F, LocationVault, LocToBitIndex,
+                                   BaseToLocIndex, TE, LSCount);
+
+  // Check how to optimize this function.
+  ProcessKind Kind = getProcessFunctionKind(LSCount.second);
+  
+  // We do not optimize this function at all.
+  if (Kind == ProcessKind::ProcessNone)
+    return false;
+
+  // Split the locations into partitions which are small enough to run the
+  // data flow on. The locations of one base are always in the same partition,
+  // so that a store can be found dead within its partition.
+  unsigned PartitionSize = std::max(MinLSLocationPartitionSize,
+                                    MaxLSLocationBBMultiplicationNone /
+                                    std::max(BBCount, 1U));
+  llvm::SmallVector<unsigned, 8> Partitions;
+  LSLocation::partitionLSLocations(LocationVault, LocToBitIndex, PartitionSize,
+                                   Partitions);
+
+  // Initialize the BBToLocState mapping.
+  for (auto &B : *F)
+    BBToLocState[&B] = new (BPA.Allocate()) BlockState(&B);
+
+  for (unsigned i = 0, e = Partitions.size() - 1; i < e; ++i)
+    processPartition(Partitions[i], Partitions[i + 1]);
 
   // Finally, delete the dead stores and create the live stores.
   bool Changed = false;
@@ -43,7 +43,9 @@
 #include "swift/SIL/Mangle.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/SIL/SILValue.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
@@ -54,6 +56,8 @@ STATISTIC(NumDeadArgsEliminated, "Total dead args eliminated");
 STATISTIC(NumOwnedConvertedToGuaranteed, "Total owned args -> guaranteed args");
 STATISTIC(NumOwnedConvertedToNotOwnedResult, "Total owned result -> not owned result");
 STATISTIC(NumSROAArguments, "Total SROA arguments optimized");
+STATISTIC(NumTableEntrySignaturesOptimized,
+          "Total func sig optimized for vtable and witness table entries");
 
 using SILParameterInfoList = llvm::SmallVector<SILParameterInfo, 8>;
 using SILResultInfoList =  llvm::SmallVector<SILResultInfo, 8>;
@@ -834,6 +838,29 @@ void FunctionSignatureTransform::ArgumentExplosionFinalizeOptimizedFunction() {
 //===----------------------------------------------------------------------===//
 namespace {
 class FunctionSignatureOpts : public SILFunctionTransform {
+  /// The functions which are referenced from a vtable or a witness table of
+  /// the module. Computed lazily.
+  llvm::DenseSet<SILFunction *> TableEntries;
+  bool TableEntriesComputed = false;
+
+  /// Returns true if \p F is the implementation of a vtable or witness table
+  /// entry in the current module.
+  bool isTableEntry(SILFunction *F) {
+    if (!TableEntriesComputed) {
+      SILModule &Mod = F->getModule();
+      for (auto &VT : Mod.getVTableList())
+        for (auto &Entry : VT.getEntries())
+          TableEntries.insert(Entry.second);
+      for (auto &WT : Mod.getWitnessTableList())
+        for (auto &Entry : WT.getEntries())
+          if (Entry.getKind() == SILWitnessTable::WitnessKind::Method)
+            if (SILFunction *Witness = Entry.getMethodWitness().Witness)
+              TableEntries.insert(Witness);
+      TableEntriesComputed = true;
+    }
+    return TableEntries.count(F) != 0;
+  }
+
 public:
   void run() override {
     auto *F = getFunction();
@@ -850,8 +877,17 @@ public:
     // If this function does not have a direct caller in the current module
     // and maybe called indirectly, e.g. from virtual table do not function
     // signature specialize it, as this will introduce a thunk.
-    if (!hasCaller && canBeCalledIndirectly(F->getRepresentation()))
-      return; 
+    //
+    // The exception is a vtable or witness table entry in whole module mode.
+    // The table must keep the original signature, so it refers to the thunk,
+    // but all calls which are devirtualized later in the pipeline will get the
+    // thunk inlined and call the optimized function directly.
+    bool isOptimizedTableEntry = false;
+    if (!hasCaller && canBeCalledIndirectly(F->getRepresentation())) {
+      if (!F->getModule().isWholeModule() || !isTableEntry(F))
+        return;
+      isOptimizedTableEntry = true;
+    }
 
     // Check the signature of F to make sure that it is a function that we
     // can specialize. These are conditions independent of the call graph.
@@ -888,10 +924,13 @@ public:
     }
 
     // Owned to guaranteed optimization.
-    FunctionSignatureTransform FST(F, hasCaller, PM, AA, RCIA, FM, AIM,
-                                   ArgumentDescList, ResultDescList);
+    FunctionSignatureTransform FST(F, hasCaller || isOptimizedTableEntry, PM,
+                                   AA, RCIA, FM, AIM, ArgumentDescList,
+                                   ResultDescList);
     if (FST.run()) {
       ++ NumFunctionSignaturesOptimized;
+      if (isOptimizedTableEntry)
+        ++ NumTableEntrySignaturesOptimized;
       // The old function must be a thunk now.
       assert(F->isThunk() && "Old function should have been turned into a thunk");
       // Make sure the PM knows about this function. This will also help us
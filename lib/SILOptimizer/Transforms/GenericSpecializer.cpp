@@ -68,7 +68,10 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
         continue;
 
       auto *Callee = Apply.getReferencedFunction();
-      if (!Callee || !Callee->isDefinition())
+      if (!Callee)
+        continue;
+      if (!Callee->isDefinition() &&
+          !Callee->getModule().linkFunctionBodyOnDemand(Callee))
         continue;
 
       Applies.insert(Apply.getInstruction());
@@ -38,6 +38,12 @@
 using namespace swift;
 
 STATISTIC(NumFunctionsInlined, "Number of functions inlined");
+STATISTIC(NumColdCalleesNotInlined,
+          "Number of calls not inlined because the profile says the callee "
+          "never ran");
+STATISTIC(NumHotCalleesFavored,
+          "Number of calls favored for inlining because the profile says the "
+          "callee is hot");
 
 llvm::cl::opt<bool> PrintShortestPathInfo(
     "print-shortest-path-info", llvm::cl::init(false),
@@ -1021,6 +1027,10 @@ class SILPerformanceInliner {
     /// Configuration for the caller block limit.
     BlockLimitDenominator = 10000,
 
+    /// With a profile, a callee is hot if it was entered at least this
+    /// fraction of the times the most frequently entered function was.
+    HotCalleeEntryCountDenominator = 3,
+
     /// The assumed execution length of a function call.
     DefaultApplyLength = 10
   };
@@ -1105,11 +1115,6 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     }
   }
 
-  // We can't inline external declarations.
-  if (Callee->empty() || Callee->isExternalDeclaration()) {
-    return nullptr;
-  }
-
   // Explicitly disabled inlining.
   if (Callee->getInlineStrategy() == NoInline) {
     return nullptr;
@@ -1119,6 +1124,13 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     return nullptr;
   }
 
+  // We can't inline external declarations. If SIL is linked on demand, the
+  // body may just not have been deserialized yet.
+  if (!Callee->getModule().linkFunctionBodyOnDemand(Callee) ||
+      Callee->empty()) {
+    return nullptr;
+  }
+
   // We don't support this yet.
   if (AI.hasSubstitutions()) {
     return nullptr;
@@ -1261,6 +1273,29 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     return true;
   }
 
+  // With a profile, a callee which never ran is only inlined if that doesn't
+  // increase the code size, and a hot one is worth twice as much.
+  const char *ProfileDecision = "";
+  if (Optional<uint64_t> EntryCount = Callee->getEntryCount()) {
+    uint64_t MaxEntryCount = Callee->getModule().getMaxFunctionEntryCount();
+    if (*EntryCount == 0) {
+      if (CalleeCost > TrivialFunctionThreshold) {
+        DEBUG(
+          dumpCaller(AI.getFunction());
+          llvm::dbgs() << "    not inlining never executed {c=" <<
+              CalleeCost << "} " << Callee->getName() << '\n';
+        );
+        NumColdCalleesNotInlined++;
+        return false;
+      }
+      ProfileDecision = ", never executed";
+    } else if (*EntryCount >= MaxEntryCount / HotCalleeEntryCountDenominator) {
+      Benefit *= 2;
+      NumHotCalleesFavored++;
+      ProfileDecision = ", hot";
+    }
+  }
+
   // We reduce the benefit if the caller is too large. For this we use a
   // cubic function on the number of caller blocks. This starts to prevent
   // inlining at about 800 - 1000 caller blocks.
@@ -1281,7 +1316,8 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     llvm::dbgs() << "    decision {c=" << CalleeCost << ", b=" << Benefit <<
         ", l=" << SPA->getScopeLength(CalleeEntry, 0) <<
         ", c-w=" << CallerWeight << ", bb=" << Callee->size() <<
-        ", c-bb=" << NumCallerBlocks << "} " << Callee->getName() << '\n';
+        ", c-bb=" << NumCallerBlocks << ProfileDecision << "} " <<
+        Callee->getName() << '\n';
   );
   return true;
 }
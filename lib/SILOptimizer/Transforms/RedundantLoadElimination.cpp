@@ -37,6 +37,11 @@
 /// 4. An optimistic iterative intersection-based dataflow is performed on the
 /// gensets until convergence.
 ///
+/// Functions with many locations are processed in partitions: the locations
+/// are grouped by their base and steps 3. and 4. are done for one partition of
+/// locations at a time. This keeps the size of the bitvectors and the cost of
+/// a data flow iteration bounded for large (e.g. generated) functions.
+///
 /// At the core of RLE, there is the LSLocation class. A LSLocation is an
 /// abstraction of an object field in program. It consists of a base and a
 /// projection path to the field accessed.
@@ -174,10 +179,15 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
+/// The locations are processed in partitions such that # of BBs x(times) # of
+/// locations in a partition does not exceed this limit, i.e. 128 basic blocks
+/// and 128 locations.
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
 
+/// The minimum size of a partition of locations. Very large functions are
+/// processed with partitions of this size, using the one iteration data flow.
+constexpr unsigned MinLSLocationPartitionSize = 64;
+
 /// we could run optimistic RLE on functions with less than 64 basic blocks
 /// and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
@@ -272,6 +282,10 @@ private:
   void processWrite(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
                     SILValue Val, RLEKind Kind);
 
+  /// There is a write to the LSLocation \p R which is not in the partition of
+  /// locations being processed. Invalidate the locations it may alias.
+  void processUntrackedWrite(RLEContext &Ctx, LSLocation &R, RLEKind Kind);
+
   /// BitVector manipulation functions.
   void startTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
   void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
@@ -306,15 +320,21 @@ public:
     // unreachable block.
     //
     // we rely on other passes to clean up unreachable block.
-    ForwardSetIn.resize(LocationNum, false);
-    ForwardSetOut.resize(LocationNum, optimistic);
+    //
+    // The state is initialized again for every partition of locations. The
+    // redundant loads found in earlier partitions are kept.
+    ForwardSetIn = llvm::SmallBitVector(LocationNum, false);
+    ForwardSetOut = llvm::SmallBitVector(LocationNum, optimistic);
 
     // If we are running an optimistic data flow, set forward max to true
     // initially.
-    ForwardSetMax.resize(LocationNum, optimistic);
+    ForwardSetMax = llvm::SmallBitVector(LocationNum, optimistic);
+
+    BBGenSet = llvm::SmallBitVector(LocationNum, false);
+    BBKillSet = llvm::SmallBitVector(LocationNum, false);
 
-    BBGenSet.resize(LocationNum, false);
-    BBKillSet.resize(LocationNum, false);
+    ForwardValIn.clear();
+    ForwardValOut.clear();
   }
 
   /// Initialize the AvailSetMax by intersecting this basic block's
@@ -444,10 +464,21 @@ private:
   ConsumedArgToEpilogueReleaseMatcher& ERM;
 
   /// Keeps all the locations for the current function. The BitVector in each
-  /// BlockState is then laid on top of it to keep track of which LSLocation
-  /// has a downward available value.
+  /// BlockState is then laid on top of the current partition of it to keep
+  /// track of which LSLocation has a downward available value.
   std::vector<LSLocation> LocationVault;
 
+  /// The range of the LocationVault which is currently processed.
+  unsigned PartitionBegin = 0;
+  unsigned PartitionEnd = 0;
+
+  /// The number of reachable basic blocks in the function.
+  unsigned BBCount = 0;
+
+  /// True if the data flow converges in one iteration, because every basic
+  /// block has all its predecessors processed in reverse post order.
+  bool RunOneIteration = true;
+
   /// Contains a map between LSLocation to their index in the LocationVault.
   /// Use for fast lookup.
   LSLocationIndexMap LocToBitIndex;
@@ -495,6 +526,12 @@ public:
   /// one iteration data flow on the function.
   ProcessKind getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount);
 
+  /// Returns how to process a partition of \p LocationCount locations.
+  ProcessKind getProcessPartitionKind(unsigned LocationCount);
+
+  /// Run RLE on the locations in [\p Begin, \p End) of the LocationVault.
+  void processPartition(unsigned Begin, unsigned End);
+
   /// Run the iterative data flow until convergence.
   void runIterativeRLE();
 
@@ -523,10 +560,13 @@ public:
   /// Return the BlockState for the basic block this basic block belongs to.
   BlockState &getBlockState(SILBasicBlock *B) { return BBToLocState[B]; }
 
-  /// Get the bit representing the LSLocation in the LocationVault.
+  /// Get the bit representing the LSLocation in the current partition.
   unsigned getLocationBit(const LSLocation &L);
 
-  /// Given the bit, get the LSLocation from the LocationVault.
+  /// Returns true if the LSLocation is in the current partition.
+  bool isTrackedLocation(const LSLocation &L);
+
+  /// Given the bit, get the LSLocation from the current partition.
   LSLocation &getLocation(const unsigned index);
 
   /// Get the bit representing the LSValue in the LSValueVault.
@@ -829,6 +869,8 @@ void BlockState::processWrite(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
 
   if (isComputeAvailSetMax(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i]))
+        continue;
       updateMaxAvailSetForWrite(Ctx, Ctx.getLocationBit(Locs[i]));
     }
     return;
@@ -837,6 +879,10 @@ void BlockState::processWrite(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   // Are we computing the genset and killset ?
   if (isComputeAvailGenKillSet(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i])) {
+        processUntrackedWrite(Ctx, Locs[i], Kind);
+        continue;
+      }
       updateGenKillSetForWrite(Ctx, Ctx.getLocationBit(Locs[i]));
     }
     return;
@@ -847,6 +893,10 @@ void BlockState::processWrite(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   LSValue::expand(Val, &I->getModule(), Vals, Ctx.getTE());
   if (isComputeAvailValue(Kind) || isPerformingRLE(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i])) {
+        processUntrackedWrite(Ctx, Locs[i], Kind);
+        continue;
+      }
       updateForwardSetAndValForWrite(Ctx, Ctx.getLocationBit(Locs[i]),
                                      Ctx.getValueBit(Vals[i]));
     }
@@ -856,6 +906,31 @@ void BlockState::processWrite(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   llvm_unreachable("Unknown RLE compute kind");
 }
 
+void BlockState::processUntrackedWrite(RLEContext &Ctx, LSLocation &R,
+                                       RLEKind Kind) {
+  // Only the tracked locations are interesting for the AvailSetMax.
+  if (isComputeAvailSetMax(Kind))
+    return;
+
+  bool GenKill = isComputeAvailGenKillSet(Kind);
+  llvm::SmallBitVector &Tracked = GenKill ? ForwardSetMax : ForwardSetIn;
+  for (unsigned i = 0; i < LocationNum; ++i) {
+    if (!isTrackingLocation(Tracked, i))
+      continue;
+    LSLocation &L = Ctx.getLocation(i);
+    if (!L.isMayAliasLSLocation(R, Ctx.getAA()))
+      continue;
+    // MayAlias, invalidate the location.
+    if (GenKill) {
+      stopTrackingLocation(BBGenSet, i);
+      startTrackingLocation(BBKillSet, i);
+      continue;
+    }
+    stopTrackingLocation(ForwardSetIn, i);
+    stopTrackingValue(ForwardValIn, i);
+  }
+}
+
 void BlockState::processRead(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
                              SILValue Val, RLEKind Kind) {
   // Initialize the LSLocation.
@@ -878,8 +953,12 @@ void BlockState::processRead(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   LSLocationList Locs;
   LSLocation::expand(L, &I->getModule(), Locs, Ctx.getTE());
 
+  // Reads of locations which are not in the current partition are handled
+  // when their partition is processed.
   if (isComputeAvailSetMax(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i]))
+        continue;
       updateMaxAvailSetForRead(Ctx, Ctx.getLocationBit(Locs[i]));
     }
     return;
@@ -888,6 +967,8 @@ void BlockState::processRead(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   // Are we computing the genset and killset.
   if (isComputeAvailGenKillSet(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i]))
+        continue;
       updateGenKillSetForRead(Ctx, Ctx.getLocationBit(Locs[i]));
     }
     return;
@@ -899,6 +980,10 @@ void BlockState::processRead(RLEContext &Ctx, SILInstruction *I, SILValue Mem,
   LSValue::expand(Val, &I->getModule(), Vals, Ctx.getTE());
   if (isComputeAvailValue(Kind) || isPerformingRLE(Kind)) {
     for (unsigned i = 0; i < Locs.size(); ++i) {
+      if (!Ctx.isTrackedLocation(Locs[i])) {
+        CanForward = false;
+        continue;
+      }
       if (isTrackingLocation(ForwardSetIn, Ctx.getLocationBit(Locs[i])))
         continue;
       updateForwardSetAndValForRead(Ctx, Ctx.getLocationBit(Locs[i]),
@@ -1080,11 +1165,7 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
   if (LoadCount + StoreCount < 2)
     return ProcessKind::ProcessNone;
 
-  bool RunOneIteration = true;
-  unsigned BBCount = 0;
-  unsigned LocationCount = LocationVault.size();
-
-  if (LocationCount == 0) 
+  if (LocationVault.empty())
     return ProcessKind::ProcessNone;
 
   // If all basic blocks will have their predecessors processed if
@@ -1104,16 +1185,17 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
-  if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
-    return ProcessKind::ProcessNone;
+  return getProcessPartitionKind(LocationVault.size());
+}
 
+RLEContext::ProcessKind
+RLEContext::getProcessPartitionKind(unsigned LocationCount) {
   // This function's data flow would converge in 1 iteration.
   if (RunOneIteration)
     return ProcessKind::ProcessOneIteration;
   
-  // We run one pessimistic data flow to do dead store elimination on
-  // the function.
+  // We run one pessimistic data flow to do redundant load elimination on
+  // the partition.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationPessimistic)
     return ProcessKind::ProcessOneIteration;
 
@@ -1131,7 +1213,7 @@ RLEContext::RLEContext(SILFunction *F, SILPassManager *PM, AliasAnalysis *AA,
 }
 
 LSLocation &RLEContext::getLocation(const unsigned index) {
-  return LocationVault[index];
+  return LocationVault[PartitionBegin + index];
 }
 
 unsigned RLEContext::getLocationBit(const LSLocation &Loc) {
@@ -1142,7 +1224,15 @@ unsigned RLEContext::getLocationBit(const LSLocation &Loc) {
   // point.
   auto Iter = LocToBitIndex.find(Loc);
   assert(Iter != LocToBitIndex.end() && "Location should have been enum'ed");
-  return Iter->second;
+  assert(Iter->second >= PartitionBegin && Iter->second < PartitionEnd &&
+         "Location should be in the current partition");
+  return Iter->second - PartitionBegin;
+}
+
+bool RLEContext::isTrackedLocation(const LSLocation &Loc) {
+  auto Iter = LocToBitIndex.find(Loc);
+  assert(Iter != LocToBitIndex.end() && "Location should have been enum'ed");
+  return Iter->second >= PartitionBegin && Iter->second < PartitionEnd;
 }
 
 LSValue &RLEContext::getValue(const unsigned index) {
@@ -1431,6 +1521,38 @@ void RLEContext::runIterativeRLE() {
   processBasicBlocksForAvailValue();
 }
 
+void RLEContext::processPartition(unsigned Begin, unsigned End) {
+  PartitionBegin = Begin;
+  PartitionEnd = End;
+  DEBUG(llvm::dbgs() << "Processing locations " << Begin << " to " << End
+                     << " of " << LocationVault.size() << "\n");
+
+  // Do we run a multi-iteration data flow ?
+  bool Optimistic = getProcessPartitionKind(End - Begin) ==
+                        ProcessKind::ProcessMultipleIterations;
+
+  // These are a list of basic blocks that we actually processed.
+  // We do not process unreachable block, instead we set their liveouts to nil.
+  llvm::DenseSet<SILBasicBlock *> BBToProcess;
+  for (auto X : PO->getPostOrder()) 
+    BBToProcess.insert(X);
+
+  // For all basic blocks in the function, initialize a BB state. Since we
+  // know all the locations accessed in this partition, we can resize the bit
+  // vector to the appropriate size.
+  for (auto &B : *Fn) {
+    BBToLocState[&B].init(&B, End - Begin, Optimistic &&
+                          BBToProcess.find(&B) != BBToProcess.end());
+  }
+
+  if (Optimistic)
+    runIterativeRLE();
+
+  // We have the available value bit computed and the local forwarding value.
+  // Set up the load forwarding.
+  processBasicBlocksForRLE(Optimistic);
+}
+
 bool RLEContext::run() {
   // We perform redundant load elimination in the following phases.
   //
@@ -1458,31 +1580,21 @@ bool RLEContext::run() {
   if (Kind == ProcessKind::ProcessNone)
     return false;
 
-  // Do we run a multi-iteration data flow ?
-  bool Optimistic = Kind == ProcessKind::ProcessMultipleIterations ?
-                        true : false;
-
-  // These are a list of basic blocks that we actually processed.
-  // We do not process unreachable block, instead we set their liveouts to nil.
-  llvm::DenseSet<SILBasicBlock *> BBToProcess;
-  for (auto X : PO->getPostOrder()) 
-    BBToProcess.insert(X);
-
-  // For all basic blocks in the function, initialize a BB state. Since we
-  // know all the locations accessed in this function, we can resize the bit
-  // vector to the appropriate size.
-  for (auto &B : *Fn) {
+  // Split the locations into partitions which are small enough to run the
+  // data flow on. The locations of one base are always in the same partition,
+  // so that a load can be forwarded within its partition.
+  unsigned PartitionSize = std::max(MinLSLocationPartitionSize,
+                                    MaxLSLocationBBMultiplicationNone /
+                                    std::max(BBCount, 1U));
+  llvm::SmallVector<unsigned, 8> Partitions;
+  LSLocation::partitionLSLocations(LocationVault, LocToBitIndex, PartitionSize,
+                                   Partitions);
+
+  for (auto &B : *Fn)
     BBToLocState[&B] = BlockState();
-    BBToLocState[&B].init(&B, LocationVault.size(), Optimistic &&
-                          BBToProcess.find(&B) != BBToProcess.end());
-  }
 
-  if (Optimistic)
-    runIterativeRLE();
-
-  // We have the available value bit computed and the local forwarding value.
-  // Set up the load forwarding.
-  processBasicBlocksForRLE(Optimistic);
+  for (unsigned i = 0, e = Partitions.size() - 1; i < e; ++i)
+    processPartition(Partitions[i], Partitions[i + 1]);
 
   // Finally, perform the redundant load replacements.
   llvm::DenseSet<SILInstruction *> InstsToDelete;
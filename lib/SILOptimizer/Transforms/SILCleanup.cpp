@@ -24,7 +24,9 @@
 
 using namespace swift;
 
-static void cleanFunction(SILFunction &Fn) {
+/// Returns true if any instructions were removed.
+static bool cleanFunction(SILFunction &Fn) {
+  bool Changed = false;
   for (auto &BB : Fn) {
     auto I = BB.begin(), E = BB.end();
     while (I != E) {
@@ -40,6 +42,7 @@ static void cleanFunction(SILFunction &Fn) {
           // The call to the builtin should get removed before we reach
           // IRGen.
           recursivelyDeleteTriviallyDeadInstructions(BI, /* Force */true);
+          Changed = true;
         }
       }
     }
@@ -50,6 +53,7 @@ static void cleanFunction(SILFunction &Fn) {
   if (Fn.isDefinition() && Fn.getLinkage() == SILLinkage::PublicExternal) {
     Fn.setLinkage(SILLinkage::SharedExternal);
   }
+  return Changed;
 }
 
 void swift::performSILCleanup(SILModule *M) {
@@ -62,8 +66,10 @@ class SILCleanup : public swift::SILFunctionTransform {
 
   /// The entry point to the transformation.
   void run() override {
-    cleanFunction(*getFunction());
-    invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+    // Removing the builtins (and whatever only they used) leaves the CFG
+    // alone.
+    if (cleanFunction(*getFunction()))
+      invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
   }
 
   StringRef getName() override { return "SIL Cleanup"; }
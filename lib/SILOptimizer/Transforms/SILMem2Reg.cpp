@@ -46,6 +46,7 @@ STATISTIC(NumAllocStackFound,    "Number of AllocStack found");
 STATISTIC(NumAllocStackCaptured, "Number of AllocStack captured");
 STATISTIC(NumInstRemoved,        "Number of Instructions removed");
 STATISTIC(NumPhiPlaced,          "Number of Phi blocks placed");
+STATISTIC(NumPartialStores,      "Number of partial stores expanded");
 
 namespace {
 
@@ -155,6 +156,14 @@ class MemoryToRegisters {
   /// The builder used to create new instructions during register promotion.
   SILBuilder B;
 
+  /// Loads of the whole AllocStack which were inserted for expanding partial
+  /// stores. Those may load from not yet initialized memory.
+  llvm::SmallPtrSet<SILInstruction *, 8> AggregateLoads;
+
+  /// \brief Replace all stores into struct and tuple projections of \p ASI
+  /// with stores of the whole reconstructed aggregate value.
+  void expandPartialStores(AllocStackInst *ASI);
+
   /// \brief Check if the AllocStackInst \p ASI is only written into.
   bool isWriteOnlyAllocation(AllocStackInst *ASI, bool Promoted = false);
 
@@ -176,9 +185,11 @@ public:
 } // end anonymous namespace.
 
 /// Returns true if \p I is an address of a LoadInst, skipping struct and
-/// tuple address projections. Sets \p singleBlock to null if the load (or
-/// it's address is not in \p singleBlock.
-static bool isAddressForLoad(SILInstruction *I, SILBasicBlock *&singleBlock) {
+/// tuple address projections. If \p allowStores is true, stores into the
+/// projected addresses are accepted as well. Sets \p singleBlock to null if
+/// the load (or it's address is not in \p singleBlock.
+static bool isAddressForLoad(SILInstruction *I, SILBasicBlock *&singleBlock,
+                             bool allowStores) {
   
   if (isa<LoadInst>(I))
     return true;
@@ -191,8 +202,13 @@ static bool isAddressForLoad(SILInstruction *I, SILBasicBlock *&singleBlock) {
     SILInstruction *II = UI->getUser();
     if (II->getParent() != singleBlock)
       singleBlock = nullptr;
+
+    // A partial store into the aggregate.
+    if (auto *SI = dyn_cast<StoreInst>(II))
+      if (allowStores && SI->getDest() == I)
+        continue;
     
-    if (!isAddressForLoad(II, singleBlock))
+    if (!isAddressForLoad(II, singleBlock, allowStores))
         return false;
   }
   return true;
@@ -203,6 +219,10 @@ static bool isAddressForLoad(SILInstruction *I, SILBasicBlock *&singleBlock) {
 static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
   
   SILBasicBlock *singleBlock = ASI->getParent();
+
+  // Partial stores are expanded to stores of the whole aggregate, which
+  // requires to load the aggregate.
+  bool allowPartialStores = ASI->getElementType().isLoadable(ASI->getModule());
   
   // For all users of the AllocStack instruction.
   for (auto UI = ASI->use_begin(), E = ASI->use_end(); UI != E; ++UI) {
@@ -212,7 +232,7 @@ static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
       singleBlock = nullptr;
     
     // Loads are okay.
-    if (isAddressForLoad(II, singleBlock))
+    if (isAddressForLoad(II, singleBlock, allowPartialStores))
       continue;
 
     // We can store into an AllocStack (but not the pointer).
@@ -344,6 +364,89 @@ static void replaceLoad(LoadInst *LI, SILValue val, AllocStackInst *ASI) {
   }
 }
 
+/// Collects all stores which (transitively) use the address projection \p I
+/// as destination.
+static void collectPartialStores(SILInstruction *I,
+                                 SmallVectorImpl<StoreInst *> &Stores) {
+  if (!isa<StructElementAddrInst>(I) && !isa<TupleElementAddrInst>(I))
+    return;
+
+  for (auto UI : I->getUses()) {
+    if (auto *SI = dyn_cast<StoreInst>(UI->getUser())) {
+      if (SI->getDest() == I)
+        Stores.push_back(SI);
+      continue;
+    }
+    collectPartialStores(UI->getUser(), Stores);
+  }
+}
+
+/// Creates a copy of the aggregate \p Agg where the element at the
+/// projection path \p Path is replaced by \p NewElement.
+static SILValue insertIntoAggregate(SILBuilder &B, SILLocation Loc,
+                                    SILValue Agg, ArrayRef<Projection> Path,
+                                    SILValue NewElement) {
+  if (Path.empty())
+    return NewElement;
+
+  llvm::SmallVector<Projection, 8> Projections;
+  Projection::getFirstLevelProjections(Agg->getType(), B.getModule(),
+                                       Projections);
+  llvm::SmallVector<SILValue, 8> Elements;
+  for (const Projection &P : Projections) {
+    SILValue Element = P.createObjectProjection(B, Loc, Agg).get();
+    if (P == Path.front())
+      Element = insertIntoAggregate(B, Loc, Element, Path.slice(1),
+                                    NewElement);
+    Elements.push_back(Element);
+  }
+  auto *NewAgg = Projection::createAggFromFirstLevelProjections(
+      B, Loc, Agg->getType(), Elements).get();
+  assert(NewAgg && "can only insert into struct and tuple aggregates");
+  return NewAgg;
+}
+
+void MemoryToRegisters::expandPartialStores(AllocStackInst *ASI) {
+  AggregateLoads.clear();
+  llvm::SmallVector<StoreInst *, 8> PartialStores;
+  for (auto UI : ASI->getUses())
+    collectPartialStores(UI->getUser(), PartialStores);
+
+  for (StoreInst *SI : PartialStores) {
+    DEBUG(llvm::dbgs() << "*** Expanding partial store: " << *SI);
+
+    // Compute the projection path from the AllocStack to the stored element.
+    llvm::SmallVector<Projection, 4> Path;
+    SILValue Addr = SI->getDest();
+    while (Addr != ASI) {
+      auto *Proj = cast<SILInstruction>(Addr);
+      Path.push_back(Projection(Proj));
+      Addr = Proj->getOperand(0);
+    }
+    std::reverse(Path.begin(), Path.end());
+
+    // Load the old value, insert the stored element and store the new value
+    // as a whole. The memory at the AllocStack may still be uninitialized
+    // here, in which case the loaded value becomes undef.
+    SILBuilderWithScope Builder(SI);
+    SILLocation Loc = SI->getLoc();
+    LoadInst *OldVal = Builder.createLoad(Loc, ASI);
+    AggregateLoads.insert(OldVal);
+    SILValue NewVal = insertIntoAggregate(Builder, Loc, OldVal, Path,
+                                          SI->getSrc());
+    Builder.createStore(Loc, NewVal, ASI);
+
+    SILValue Dest = SI->getDest();
+    SI->eraseFromParent();
+    while (Dest != ASI && Dest->use_empty()) {
+      auto *Proj = cast<SILInstruction>(Dest);
+      Dest = Proj->getOperand(0);
+      Proj->eraseFromParent();
+    }
+    NumPartialStores++;
+  }
+}
+
 static void replaceDestroy(DestroyAddrInst *DAI, SILValue NewValue) {
   assert(DAI->getOperand()->getType().isLoadable(DAI->getModule()) &&
          "Unexpected promotion of address-only type!");
@@ -460,7 +563,8 @@ void MemoryToRegisters::removeSingleBlockAllocation(AllocStackInst *ASI) {
     // with our running value.
     if (isLoadFromStack(Inst, ASI)) {
       if (!RunningVal) {
-        assert(ASI->getElementType().isVoid() &&
+        assert((ASI->getElementType().isVoid() ||
+                AggregateLoads.count(Inst)) &&
                "Expected initialization of non-void type!");
         RunningVal = SILUndef::get(ASI->getElementType(), ASI->getModule());
       }
@@ -842,6 +946,10 @@ bool MemoryToRegisters::run() {
         continue;
       }
 
+      // Turn partial stores into stores of the whole value, so that the
+      // AllocStack can be promoted without splitting it up first.
+      expandPartialStores(ASI);
+
       // Remove write-only AllocStacks.
       if (isWriteOnlyAllocation(ASI)) {
         eraseUsesOfInstruction(ASI);
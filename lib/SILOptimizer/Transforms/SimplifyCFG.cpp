@@ -37,6 +37,10 @@ using namespace swift;
 STATISTIC(NumBlocksDeleted, "Number of unreachable blocks removed");
 STATISTIC(NumBlocksMerged, "Number of blocks merged together");
 STATISTIC(NumJumpThreads, "Number of jumps threaded");
+STATISTIC(NumInstsDuplicatedByThreading,
+          "Number of instructions duplicated by jump threading");
+STATISTIC(NumBranchesRemovedByThreading,
+          "Number of conditional branches removed by jump threading");
 STATISTIC(NumTermBlockSimplified, "Number of programterm block simplified");
 STATISTIC(NumConstantFolded, "Number of terminators constant folded");
 STATISTIC(NumDeadArguments, "Number of unused arguments removed");
@@ -54,6 +58,32 @@ STATISTIC(NumSROAArguments, "Number of aggregate argument levels split by "
 ///
 static unsigned MaxIterationsOfDominatorBasedSimplify = 10;
 
+/// The number of instructions jump threading may duplicate in a function, as
+/// a percentage of the function's size.
+static llvm::cl::opt<unsigned> JumpThreadingGrowthPercent(
+    "sil-jump-threading-growth-percent", llvm::cl::init(25),
+    llvm::cl::desc("The maximum code growth by jump threading, in percent of "
+                   "the function size"));
+
+/// The number of instructions jump threading may duplicate in a function,
+/// regardless of its size.
+static const unsigned MinJumpThreadingBudget = 64;
+
+/// The maximum cost of a block we duplicate if its terminator is known to fold
+/// into an unconditional branch on the threaded edge.
+static const unsigned MaxFoldingThreadedBlockCost = 8;
+
+/// Check whether duplicating \p BB fits into the remaining \p Budget of
+/// duplicated instructions. If so, charge the size of \p BB to the budget.
+static bool consumeDuplicationBudget(SILBasicBlock *BB, unsigned &Budget) {
+  unsigned Size = std::distance(BB->begin(), BB->end());
+  if (Size > Budget)
+    return false;
+  Budget -= Size;
+  NumInstsDuplicatedByThreading += Size;
+  return true;
+}
+
 namespace {
   class SimplifyCFG {
     SILFunction &Fn;
@@ -73,6 +103,10 @@ namespace {
 
     bool ShouldVerify;
     bool EnableJumpThread;
+
+    /// The number of instructions jump threading may still duplicate in this
+    /// function.
+    unsigned DuplicationBudget = 0;
   public:
     SimplifyCFG(SILFunction &Fn, SILPassManager *PM, bool Verify,
                 bool EnableJumpThread)
@@ -315,6 +349,8 @@ public:
     DEBUG(llvm::dbgs() << "thread edge from bb" << Src->getDebugID() <<
           " to bb" << Dest->getDebugID() << '\n');
     auto *SrcTerm = cast<BranchInst>(Src->getTerminator());
+    ++NumJumpThreads;
+    ++NumBranchesRemovedByThreading;
 
     EdgeThreadingCloner Cloner(SrcTerm);
     for (auto &I : *Dest)
@@ -432,7 +468,8 @@ static bool tryDominatorBasedSimplifications(
     llvm::DenseSet<std::pair<SILBasicBlock *, SILBasicBlock *>>
         &ThreadedEdgeSet,
     bool TryJumpThreading,
-    llvm::DenseMap<SILBasicBlock *, bool> &CachedThreadable) {
+    llvm::DenseMap<SILBasicBlock *, bool> &CachedThreadable,
+    unsigned &DuplicationBudget) {
   auto *DominatingTerminator = DominatingBB->getTerminator();
 
   // We handle value propagation from cond_br and switch_enum terminators.
@@ -542,6 +579,10 @@ static bool tryDominatorBasedSimplifications(
           if (!ThreadedEdgeSet.insert(std::make_pair(PredBB, DestBB)).second)
             continue;
 
+          // Stop duplicating blocks once the function grew too much.
+          if (!consumeDuplicationBudget(DestBB, DuplicationBudget))
+            break;
+
           if (isa<CondBranchInst>(DestBB->getTerminator()))
             JumpThreadableEdges.push_back(ThreadInfo(PredBB, DestBB, Idx));
           else
@@ -581,7 +622,7 @@ bool SimplifyCFG::dominatorBasedSimplifications(SILFunction &Fn,
     if (DT->getNode(&BB)) // Only handle reachable blocks.
       Changed |= tryDominatorBasedSimplifications(
           &BB, DT, LoopHeaders, JumpThreadableEdges, ThreadedEdgeSet,
-          EnableJumpThread, CachedThreadable);
+          EnableJumpThread, CachedThreadable, DuplicationBudget);
 
   // Nothing to jump thread?
   if (JumpThreadableEdges.empty())
@@ -910,7 +951,25 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   // given the duplication.
   bool WantToThread = false;
 
-  if (isa<CondBranchInst>(DestBB->getTerminator()))
+  // If the terminator of the destination switches on a block argument which
+  // we pass a known value, the duplicated terminator folds into an
+  // unconditional branch. This is what lets us thread chains of blocks
+  // branching on the same value, e.g. the state of a state machine, so we are
+  // willing to duplicate larger blocks for it.
+  bool TerminatorFolds = false;
+  if (auto *Arg = dyn_cast_or_null<SILArgument>(
+          getTerminatorCondition(DestBB->getTerminator()))) {
+    if (Arg->getParent() == DestBB) {
+      SILValue Incoming = BI->getArg(Arg->getIndex());
+      if (isa<CondBranchInst>(DestBB->getTerminator()))
+        TerminatorFolds = isa<IntegerLiteralInst>(Incoming);
+      else
+        TerminatorFolds = getEnumCase(Incoming, SrcBB, 0).isNonNull();
+    }
+  }
+  WantToThread = TerminatorFolds;
+
+  if (!WantToThread && isa<CondBranchInst>(DestBB->getTerminator()))
     for (auto V : BI->getArgs()) {
       if (isa<IntegerLiteralInst>(V) || isa<FloatLiteralInst>(V)) {
         WantToThread = true;
@@ -932,6 +991,7 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   // If it looks potentially interesting, decide whether we *can* do the
   // operation and whether the block is small enough to be worth duplicating.
   unsigned Cost = 0;
+  unsigned MaxCost = TerminatorFolds ? MaxFoldingThreadedBlockCost : 4;
 
   for (auto &Inst : *DestBB) {
     if (!Inst.isTriviallyDuplicatable())
@@ -944,7 +1004,7 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
     // This is a really trivial cost model, which is only intended as a starting
     // point.
     if (instructionInlineCost(Inst) != InlineCost::Free)
-      if (++Cost == 4) return false;
+      if (++Cost == MaxCost) return false;
 
     // We need to update ssa if a value is used outside the duplicated block.
     if (!NeedToUpdateSSA)
@@ -957,6 +1017,10 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   if (!isa<SwitchEnumInst>(DestBB->getTerminator()) && DestIsLoopHeader)
     return false;
 
+  // Stop duplicating blocks once the function grew too much.
+  if (!consumeDuplicationBudget(DestBB, DuplicationBudget))
+    return false;
+
   DEBUG(llvm::dbgs() << "jump thread from bb" << SrcBB->getDebugID() <<
         " to bb" << DestBB->getDebugID() << '\n');
 
@@ -986,6 +1050,8 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
     findLoopHeaders();
 
   ++NumJumpThreads;
+  if (TerminatorFolds)
+    ++NumBranchesRemovedByThreading;
   return true;
 }
 
@@ -2713,6 +2779,13 @@ bool SimplifyCFG::run() {
   // First remove any block not reachable from the entry.
   bool Changed = RU.run();
 
+  // Bound the code growth caused by jump threading in this function.
+  unsigned FunctionSize = 0;
+  for (auto &BB : Fn)
+    FunctionSize += std::distance(BB.begin(), BB.end());
+  DuplicationBudget = std::max(MinJumpThreadingBudget,
+                               FunctionSize * JumpThreadingGrowthPercent / 100);
+
   // Find the set of loop headers. We don't want to jump-thread through headers.
   findLoopHeaders();
 
@@ -44,7 +44,15 @@ using namespace swift;
 // speculative devirtualizer will try to predict.
 static const int MaxNumSpeculativeTargets = 6;
 
+// The percentage of the profiled calls of a method which one implementation
+// must receive for the speculative devirtualizer to check only for its class.
+static const unsigned DominantTargetPercentage = 90;
+
 STATISTIC(NumTargetsPredicted, "Number of monomorphic functions predicted");
+STATISTIC(NumDominantTargetsPredicted,
+          "Number of calls speculated on the dominant profiled target");
+STATISTIC(NumMegamorphicCallsSkipped,
+          "Number of calls not speculated because the profile is megamorphic");
 
 // A utility function for cloning the apply instruction.
 static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
@@ -307,6 +315,96 @@ static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
   return true;
 }
 
+/// Returns the type to check for in a speculative call to a method of the
+/// subclass \p S, where \p SubType is the type of the instance or metatype the
+/// method is called on.
+static SILType getClassOrMetatypeType(ClassDecl *S, SILType SubType) {
+  CanType CanClassType = S->getDeclaredType()->getCanonicalType();
+  SILType ClassType = SILType::getPrimitiveObjectType(CanClassType);
+  if (auto EMT = SubType.getAs<AnyMetatypeType>()) {
+    auto InstTy = ClassType.getSwiftRValueType();
+    auto *MetaTy = MetatypeType::get(InstTy, EMT->getRepresentation());
+    auto CanMetaTy = CanMetatypeType::CanTypeWrapper(MetaTy);
+    return SILType::getPrimitiveObjectType(CanMetaTy);
+  }
+  return ClassType;
+}
+
+namespace {
+/// What the profile says about the classes a method call is dispatched on.
+enum class ProfiledReceivers {
+  /// Not all implementations the call can dispatch to have profile counts.
+  Unknown,
+  /// The implementation of one class receives almost all of the calls.
+  Dominant,
+  /// The calls are spread over too many implementations to check for each.
+  Megamorphic,
+  /// The calls are spread over a few implementations.
+  Polymorphic
+};
+} // end anonymous namespace
+
+/// Classify the receivers of the method call \p CMI on an instance or
+/// metatype of \p SubType, which can also be any of the subclasses \p Subs,
+/// by the profiled entry counts of the implementations they dispatch to.
+///
+/// The profile only counts how often each implementation is entered, from all
+/// of its callers, so this is the histogram of the receiver classes of the
+/// method across the program rather than of this call site.
+///
+/// If one class dominates, its type is returned in \p DominantType.
+static ProfiledReceivers
+classifyProfiledReceivers(ClassMethodInst *CMI, SILType SubType,
+                          ArrayRef<ClassDecl *> Subs, SILType &DominantType) {
+  auto &M = CMI->getModule();
+  if (!M.getMaxFunctionEntryCount())
+    return ProfiledReceivers::Unknown;
+
+  SmallVector<SILType, 8> Candidates(1, SubType);
+  for (auto S : Subs) {
+    // Generic subclasses can't be checked for, but their calls count too.
+    if (!S->getDeclaredType()->getClassOrBoundGenericClass())
+      return ProfiledReceivers::Unknown;
+    Candidates.push_back(getClassOrMetatypeType(S, SubType));
+  }
+
+  // The implementations the call can dispatch to, with the classes which use
+  // them.
+  llvm::MapVector<SILFunction *, SmallVector<SILType, 2>> Implementations;
+  for (auto Candidate : Candidates) {
+    SILFunction *F = getTargetClassMethod(M, Candidate, CMI);
+    if (!F || !F->getEntryCount())
+      return ProfiledReceivers::Unknown;
+    Implementations[F].push_back(Candidate);
+  }
+
+  uint64_t TotalCount = 0;
+  unsigned NumCalledImplementations = 0;
+  for (auto &Impl : Implementations) {
+    uint64_t Count = *Impl.first->getEntryCount();
+    TotalCount += Count;
+    if (Count)
+      ++NumCalledImplementations;
+  }
+  if (!TotalCount)
+    return ProfiledReceivers::Unknown;
+
+  for (auto &Impl : Implementations) {
+    uint64_t Count = *Impl.first->getEntryCount();
+    // A single class check only covers the implementation if no other
+    // candidate class shares it.
+    if (Count * 100 >= TotalCount * DominantTargetPercentage &&
+        Impl.second.size() == 1) {
+      DominantType = Impl.second.front();
+      return ProfiledReceivers::Dominant;
+    }
+  }
+
+  if (NumCalledImplementations > MaxNumSpeculativeTargets)
+    return ProfiledReceivers::Megamorphic;
+  return ProfiledReceivers::Polymorphic;
+}
+
 /// \brief Try to speculate the call target for the call \p AI. This function
 /// returns true if a change was made.
 static bool tryToSpeculateTarget(FullApplySite AI,
@@ -392,6 +490,10 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     Subs.erase(RemovedIt, Subs.end());
   }
 
+  SILType DominantType;
+  auto Receivers = classifyProfiledReceivers(CMI, SubType, Subs,
+                                             DominantType);
+
   // Number of subclasses which cannot be handled by checked_cast_br checks.
   int NotHandledSubsNum = 0;
   if (Subs.size() > MaxNumSpeculativeTargets) {
@@ -418,6 +520,29 @@ static bool tryToSpeculateTarget(FullApplySite AI,
       return false;
   }
 
+  // With a profile, check only for the class which receives almost all of the
+  // calls, and don't check at all if the calls are spread over too many
+  // implementations.
+  switch (Receivers) {
+  case ProfiledReceivers::Dominant:
+    DEBUG(llvm::dbgs() << "Inserting a speculative call for the dominant "
+          "profiled receiver " << DominantType << " of class "
+          << CD->getName() << "\n");
+    if (speculateMonomorphicTarget(AI, DominantType, LastCCBI)) {
+      ++NumDominantTargetsPredicted;
+      return true;
+    }
+    break;
+  case ProfiledReceivers::Megamorphic:
+    DEBUG(llvm::dbgs() << "Not speculating the megamorphic call of a method "
+          "of class " << CD->getName() << "\n");
+    ++NumMegamorphicCallsSkipped;
+    return false;
+  case ProfiledReceivers::Unknown:
+  case ProfiledReceivers::Polymorphic:
+    break;
+  }
+
   auto FirstAI = speculateMonomorphicTarget(AI, SubType, LastCCBI);
   if (FirstAI) {
     Changed = true;
@@ -458,8 +583,9 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   // in the future, if we start using PGO for ordering of checked_cast_br
   // checks.
 
-  // TODO: The ordering of checks may benefit from using a PGO, because
-  // the most probable alternatives could be checked first.
+  // TODO: With a profile that doesn't single out one class, the ordering of
+  // checks may still benefit from checking the most probable alternatives
+  // first.
 
   for (auto S : Subs) {
     DEBUG(llvm::dbgs() << "Inserting a speculative call for class "
@@ -474,13 +600,7 @@ static bool tryToSpeculateTarget(FullApplySite AI,
       continue;
     }
 
-    auto ClassOrMetatypeType = ClassType;
-    if (auto EMT = SubType.getAs<AnyMetatypeType>()) {
-      auto InstTy = ClassType.getSwiftRValueType();
-      auto *MetaTy = MetatypeType::get(InstTy, EMT->getRepresentation());
-      auto CanMetaTy = CanMetatypeType::CanTypeWrapper(MetaTy);
-      ClassOrMetatypeType = SILType::getPrimitiveObjectType(CanMetaTy);
-    }
+    auto ClassOrMetatypeType = getClassOrMetatypeType(S, SubType);
 
     // Pass the metatype of the subclass.
     auto NewAI = speculateMonomorphicTarget(AI, ClassOrMetatypeType, LastCCBI);
@@ -36,6 +36,9 @@ using namespace swift;
 ///    swift_bufferAllocateOnStack and a call to swift_bufferDeallocateFromStack
 ///    is inserted at the end of the buffer's lifetime.
 ///    Those calls are lowered by the LLVM SwiftStackPromotion pass.
+///    A promoted buffer is still recognized by the array.uninitialized
+///    semantics call, so that e.g. DeadObjectElimination and
+///    ArrayElementPropagation can still optimize the array.
 ///    TODO: This is a terrible hack, but necessary because we need constant
 ///    size and alignment for the final stack promotion decision. The arguments
 ///    to swift_bufferAllocate in SIL are not constant because they depend on
@@ -42,8 +42,12 @@ class SILLinker : public SILModuleTransform {
 
   void run() override {
     SILModule &M = *getModule();
+    // With on-demand linking, only bring in what's needed for correctness;
+    // the inliner and specializer deserialize other bodies as they need them.
+    auto Mode = M.getOptions().LinkOnDemand ? SILModule::LinkingMode::LinkNormal
+                                            : SILModule::LinkingMode::LinkAll;
     for (auto &Fn : M)
-      if (M.linkFunction(&Fn, SILModule::LinkingMode::LinkAll))
+      if (M.linkFunction(&Fn, Mode))
           invalidateAnalysis(&Fn, SILAnalysis::InvalidationKind::Everything);
   }
 
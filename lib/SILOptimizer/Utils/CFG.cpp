@@ -15,9 +15,24 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool> VerifyDominanceUpdates(
+    "sil-verify-dominance-updates", llvm::cl::init(false),
+    llvm::cl::desc("Check the dominator tree against a full recomputation "
+                   "each time a CFG utility updates it in place"));
+
+/// Checks \p DT after it has been updated in place, in asserts builds with
+/// -sil-verify-dominance-updates.
+static void verifyDominanceUpdate(DominanceInfo *DT) {
+#ifndef NDEBUG
+  if (DT && VerifyDominanceUpdates)
+    DT->verify();
+#endif
+}
+
 /// \brief Adds a new argument to an edge between a branch and a destination
 /// block.
 ///
@@ -560,6 +575,7 @@ SILBasicBlock *swift::splitBasicBlockAndBranch(SILBuilder &B,
       for (auto *Adoptee : Adoptees)
         DT->changeImmediateDominator(Adoptee, NewBBDTNode);
     }
+    verifyDominanceUpdate(DT);
   }
 
   // Update loop info.
@@ -619,6 +635,7 @@ SILBasicBlock *swift::splitEdge(TermInst *T, unsigned EdgeIdx,
       if (OldSrcBBDominatesAllPreds)
         DT->changeImmediateDominator(DestBBNode, EdgeBBNode);
     }
+    verifyDominanceUpdate(DT);
   }
 
   if (!LI)
@@ -739,7 +756,7 @@ bool swift::mergeBasicBlockWithSuccessor(SILBasicBlock *BB, DominanceInfo *DT,
       auto *BBNode = DT->getNode(BB);
       SmallVector<DominanceInfoNode *, 8> Children(SuccBBNode->begin(),
                                                    SuccBBNode->end());
-      for (auto *ChildNode : *SuccBBNode)
+      for (auto *ChildNode : Children)
         DT->changeImmediateDominator(ChildNode, BBNode);
 
       DT->eraseNode(SuccBB);
@@ -749,6 +766,7 @@ bool swift::mergeBasicBlockWithSuccessor(SILBasicBlock *BB, DominanceInfo *DT,
     LI->removeBlock(SuccBB);
 
   SuccBB->eraseFromParent();
+  verifyDominanceUpdate(DT);
 
   return true;
 }
@@ -16,9 +16,15 @@
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/Utils/GenericCloner.h"
 #include "swift/SIL/DebugUtils.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 
+STATISTIC(NumSpecializationsExported,
+          "Number of specializations exported for other modules to reuse");
+STATISTIC(NumSharedSpecializationsReused,
+          "Number of specializations reused from other modules");
+
 // =============================================================================
 // ReabstractionInfo
 // =============================================================================
@@ -164,6 +170,12 @@ GenericFuncSpecializer::GenericFuncSpecializer(SILFunction *GenericFunc,
   DEBUG(llvm::dbgs() << "    Specialized function " << ClonedName << '\n');
 }
 
+// Forward decls for specialization sharing.
+static SILFunction *lookupSharedSpecialization(SILModule &M,
+                                               StringRef FunctionName);
+static void shareSpecialization(SILModule &M, SILFunction *F,
+                                ArrayRef<Substitution> ParamSubs);
+
 // Return an existing specialization if one exists.
 SILFunction *GenericFuncSpecializer::lookupSpecialization() {
   if (SILFunction *SpecializedF = M.lookUpFunction(ClonedName)) {
@@ -174,6 +186,16 @@ SILFunction *GenericFuncSpecializer::lookupSpecialization() {
                        << "\n");
     return SpecializedF;
   }
+  // Specializations are only shared between modules with the default
+  // resilience level, see shareSpecialization.
+  if (Fragile == IsNotFragile) {
+    if (SILFunction *SharedF = lookupSharedSpecialization(M, ClonedName)) {
+      assert(ReInfo.getSpecializedType()
+             == SharedF->getLoweredFunctionType() &&
+             "Shared specialization does not match expected type.");
+      return SharedF;
+    }
+  }
   DEBUG(llvm::dbgs() << "Could not find an existing specialization for: "
                      << ClonedName << "\n");
   return nullptr;
@@ -198,7 +220,8 @@ SILFunction *GenericFuncSpecializer::tryCreateSpecialization() {
                                  ParamSubs, ClonedName);
 
   // Check if this specialization should be linked for prespecialization.
-  linkSpecialization(M, SpecializedF);
+  if (!linkSpecialization(M, SpecializedF) && Fragile == IsNotFragile)
+    shareSpecialization(M, SpecializedF, ParamSubs);
   return SpecializedF;
 }
 
@@ -595,6 +618,69 @@ static bool linkSpecialization(SILModule &M, SILFunction *F) {
   return false;
 }
 
+// =============================================================================
+// Sharing specializations between modules.
+//
+// With -enable-specialization-sharing a module exports the specializations
+// it owns like the prespecializations of the standard library, and looks up
+// the ones it needs in the modules it imports before creating its own copy.
+// =============================================================================
+
+/// Returns true if one of \p ParamSubs refers to a public type of \p M's
+/// module, and none to a non-public one.
+///
+/// Only a module which imports \p M can refer to its types, and two modules
+/// can't import each other, so at most one module owns a specialization.
+static bool ownsSpecialization(SILModule &M, ArrayRef<Substitution> ParamSubs) {
+  ModuleDecl *SwiftModule = M.getSwiftModule();
+  bool RefersToOwnType = false;
+  bool RefersToHiddenType = false;
+  for (const Substitution &Sub : ParamSubs) {
+    Sub.getReplacement().findIf([&](Type T) -> bool {
+      if (auto *NTD = T->getAnyNominal()) {
+        if (NTD->getModuleContext() == SwiftModule)
+          RefersToOwnType = true;
+        if (NTD->getEffectiveAccess() != Accessibility::Public)
+          RefersToHiddenType = true;
+      }
+      return RefersToHiddenType;
+    });
+  }
+  return RefersToOwnType && !RefersToHiddenType;
+}
+
+/// Export \p F, a new specialization with \p ParamSubs, for modules which
+/// import this one, if this module owns it.
+static void shareSpecialization(SILModule &M, SILFunction *F,
+                                ArrayRef<Substitution> ParamSubs) {
+  if (!M.getOptions().ShareSpecializations || !ownsSpecialization(M, ParamSubs))
+    return;
+  keepSpecializationAsPublic(F);
+  NumSpecializationsExported++;
+}
+
+/// Returns a declaration of the specialization \p FunctionName if an
+/// imported module exports it.
+static SILFunction *lookupSharedSpecialization(SILModule &M,
+                                               StringRef FunctionName) {
+  if (!M.getOptions().ShareSpecializations)
+    return nullptr;
+
+  // Only check that the function exists: its body stays in the module which
+  // exports it.
+  SILFunction *Specialization =
+      M.hasFunction(FunctionName, SILLinkage::PublicExternal);
+  if (!Specialization)
+    return nullptr;
+
+  assert(Specialization->isExternalDeclaration() &&
+         "Shared specialization should be an external declaration");
+  DEBUG(llvm::dbgs() << "Reusing the specialization " << FunctionName
+                     << " of another module\n");
+  NumSharedSpecializationsReused++;
+  return Specialization;
+}
+
 /// Check of a given name could be a name of a white-listed
 /// specialization.
 bool swift::isWhitelistedSpecialization(StringRef SpecName) {
@@ -681,9 +767,9 @@ bool swift::isWhitelistedSpecialization(StringRef SpecName) {
 /// Try to look up an existing specialization in the specialization cache.
 /// If it is found, it tries to link this specialization.
 ///
-/// For now, it performs a lookup only in the standard library.
-/// But in the future, one could think of maintaining a cache
-/// of optimized specializations.
+/// Besides the whitelisted specializations of the standard library, any
+/// module may export specializations it was asked to create with
+/// -prespecialize-list.
 static SILFunction *lookupExistingSpecialization(SILModule &M,
                                                  StringRef FunctionName) {
   // Try to link existing specialization only in -Onone mode.
@@ -691,10 +777,7 @@ static SILFunction *lookupExistingSpecialization(SILModule &M,
   // TODO: Cache optimized specializations and perform lookup here?
   // Only check that this function exists, but don't read
   // its body. It can save some compile-time.
-  if (isWhitelistedSpecialization(FunctionName))
-    return M.hasFunction(FunctionName, SILLinkage::PublicExternal);
-
-  return nullptr;
+  return M.hasFunction(FunctionName, SILLinkage::PublicExternal);
 }
 
 SILFunction *swift::lookupPrespecializedSymbol(SILModule &M,
@@ -262,3 +262,40 @@ LSLocation::enumerateLSLocations(SILFunction &F,
     }
   }
 }
+
+void
+LSLocation::partitionLSLocations(std::vector<LSLocation> &Locations,
+                                 LSLocationIndexMap &IndexMap,
+                                 unsigned MaxPartitionSize,
+                                 llvm::SmallVectorImpl<unsigned> &Partitions) {
+  // Group the locations by base, keeping the bases in the order they were
+  // first enumerated so that the result is deterministic.
+  llvm::SmallVector<SILValue, 32> Bases;
+  llvm::DenseMap<SILValue, llvm::SmallVector<unsigned, 4>> BaseToLocs;
+  for (unsigned i = 0, e = Locations.size(); i < e; ++i) {
+    SILValue Base = Locations[i].getBase();
+    auto &Locs = BaseToLocs[Base];
+    if (Locs.empty())
+      Bases.push_back(Base);
+    Locs.push_back(i);
+  }
+
+  std::vector<LSLocation> Sorted;
+  Sorted.reserve(Locations.size());
+  Partitions.clear();
+  for (SILValue Base : Bases) {
+    auto &Locs = BaseToLocs[Base];
+    // Start a new partition if this base doesn't fit into the current one.
+    unsigned CurrentSize = Partitions.empty() ? 0 :
+                           Sorted.size() - Partitions.back();
+    if (Partitions.empty() ||
+        (CurrentSize != 0 && CurrentSize + Locs.size() > MaxPartitionSize))
+      Partitions.push_back(Sorted.size());
+    for (unsigned Idx : Locs) {
+      IndexMap[Locations[Idx]] = Sorted.size();
+      Sorted.push_back(Locations[Idx]);
+    }
+  }
+  Partitions.push_back(Sorted.size());
+  Locations = std::move(Sorted);
+}
@@ -21,11 +21,82 @@
 #include "swift/AST/TypeMatcher.h"
 #include "swift/Basic/StringExtras.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 
 using namespace swift;
 using namespace constraints;
 
+#define DEBUG_TYPE "Failure diagnosis"
+STATISTIC(NumFailureDiagnoses,
+          "# of expressions whose failures were diagnosed");
+STATISTIC(NumDiagnosisRechecks,
+          "# of subexpressions re-type-checked while diagnosing failures");
+STATISTIC(NumDiagnosisBudgetsExceeded,
+          "# of failure diagnoses that gave up after exceeding their budget");
+
+/// The most subexpressions one failure diagnosis, including the diagnoses
+/// nested within it, re-type-checks before giving up.
+static const unsigned MaxDiagnosisRechecks = 1024;
+
+/// The longest one failure diagnosis runs before giving up, in seconds.
+static const double MaxDiagnosisSeconds = 10.0;
+
+namespace swift {
+namespace constraints {
+/// The budget of the outermost failure diagnosis under way.
+///
+/// Diagnosing a failure re-type-checks subexpressions, whose failures are
+/// diagnosed in turn; in a large expression, this search for the best
+/// diagnostic can take far longer than solving did. Once it has used up its
+/// budget, the diagnosis settles for saying the expression is too complex.
+class FailureDiagnosisSession {
+  TypeChecker &TC;
+  Expr *Root;
+  double StartTime;
+  unsigned NumRechecks = 0;
+  bool Exceeded = false;
+
+public:
+  FailureDiagnosisSession(TypeChecker &TC, Expr *root)
+    : TC(TC), Root(root),
+      StartTime(llvm::TimeRecord::getCurrentTime().getWallTime()) {
+    assert(!TC.ActiveDiagnosisSession && "nested diagnosis sessions");
+    TC.ActiveDiagnosisSession = this;
+  }
+
+  ~FailureDiagnosisSession() {
+    TC.ActiveDiagnosisSession = nullptr;
+  }
+
+  /// Returns true if the budget has been used up, in which case the generic
+  /// diagnostic has been emitted.
+  bool hasExceededBudget() const { return Exceeded; }
+
+  /// Records that a subexpression is about to be re-type-checked.
+  ///
+  /// \returns false, after emitting the generic diagnostic, if doing so
+  /// would exceed the budget.
+  bool noteRecheck() {
+    if (Exceeded)
+      return false;
+    ++NumDiagnosisRechecks;
+    if (++NumRechecks <= MaxDiagnosisRechecks &&
+        llvm::TimeRecord::getCurrentTime().getWallTime() - StartTime <
+          MaxDiagnosisSeconds)
+      return true;
+
+    ++NumDiagnosisBudgetsExceeded;
+    Exceeded = true;
+    TC.diagnose(Root->getLoc(), diag::expression_too_complex)
+      .highlight(Root->getSourceRange());
+    return false;
+  }
+};
+} // end namespace constraints
+} // end namespace swift
+
 static bool isUnresolvedOrTypeVarType(Type ty) {
   return ty->is<TypeVariableType>() || ty->is<UnresolvedType>();
 }
@@ -2850,6 +2921,12 @@ typeCheckChildIndependently(Expr *subExpr, Type convertType,
   
     CS->TC.addExprForDiagnosis(subExpr, subExpr);
   }
+
+  // If the diagnosis has run out of budget, the generic diagnostic has been
+  // emitted instead.
+  if (auto session = CS->TC.ActiveDiagnosisSession)
+    if (!session->noteRecheck())
+      return nullptr;
   
   // If we have a conversion type, but it has type variables (from the current
   // ConstraintSystem), then we can't use it.
@@ -5356,6 +5433,13 @@ void ConstraintSystem::diagnoseFailureForExpr(Expr *expr) {
   // Look through RebindSelfInConstructorExpr to avoid weird sema issues.
   if (auto *RB = dyn_cast<RebindSelfInConstructorExpr>(expr))
     expr = RB->getSubExpr();
+
+  // The outermost diagnosis sets the budget for those nested within it.
+  Optional<FailureDiagnosisSession> session;
+  if (!TC.ActiveDiagnosisSession) {
+    ++NumFailureDiagnoses;
+    session.emplace(TC, expr);
+  }
   
   FailureDiagnosis diagnosis(expr, this);
   
@@ -5363,13 +5447,21 @@ void ConstraintSystem::diagnoseFailureForExpr(Expr *expr) {
   if (diagnosis.diagnoseExprFailure())
     return;
 
+  // Once the budget is used up, nothing more can be found out; the generic
+  // diagnostic has been emitted.
+  auto activeSession = TC.ActiveDiagnosisSession;
+  if (activeSession->hasExceededBudget())
+    return;
+
   // If this is a contextual conversion problem, dig out some information.
-  if (diagnosis.diagnoseContextualConversionError())
+  if (diagnosis.diagnoseContextualConversionError() ||
+      activeSession->hasExceededBudget())
     return;
 
   // If we can diagnose a problem based on the constraints left laying around in
   // the system, do so now.
-  if (diagnosis.diagnoseConstraintFailure())
+  if (diagnosis.diagnoseConstraintFailure() ||
+      activeSession->hasExceededBudget())
     return;
 
   // If no one could find a problem with this expression or constraint system,
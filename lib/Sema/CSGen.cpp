@@ -69,6 +69,46 @@ static bool isArithmeticOperatorDecl(ValueDecl *vd) {
    vd->getName().str() == "%");
 }
 
+/// Returns the struct or enum that a value of type \p type must be, or null
+/// if it could be a different struct or enum, or converted to one.
+///
+/// Structs and enums other than Optional don't convert to one another, so an
+/// argument of one of these types can't be passed to a parameter of another.
+static NominalTypeDecl *getExactStructOrEnum(Type type) {
+  if (!type)
+    return nullptr;
+  if (auto structTy = type->getAs<StructType>())
+    return structTy->getDecl();
+  if (auto enumTy = type->getAs<EnumType>())
+    return enumTy->getDecl();
+  return nullptr;
+}
+
+std::pair<NominalTypeDecl *, NominalTypeDecl *>
+TypeChecker::getBinaryOperatorParamTypes(ValueDecl *op) {
+  auto known = BinaryOperatorParamTypes.find(op);
+  if (known != BinaryOperatorParamTypes.end())
+    return known->second;
+
+  std::pair<NominalTypeDecl *, NominalTypeDecl *> result{nullptr, nullptr};
+  if (op->hasType()) {
+    if (auto fnTy = op->getType()->getAs<AnyFunctionType>()) {
+      if (op->getDeclContext()->isTypeContext())
+        fnTy = fnTy->getResult()->getAs<AnyFunctionType>();
+      auto paramTupleTy = fnTy ? fnTy->getInput()->getAs<TupleType>() : nullptr;
+      if (paramTupleTy && paramTupleTy->getNumElements() == 2) {
+        result.first =
+          getExactStructOrEnum(paramTupleTy->getElement(0).getType());
+        result.second =
+          getExactStructOrEnum(paramTupleTy->getElement(1).getType());
+      }
+    }
+  }
+
+  BinaryOperatorParamTypes[op] = result;
+  return result;
+}
+
 static bool mergeRepresentativeEquivalenceClasses(ConstraintSystem &CS,
                                                   TypeVariableType* tyvar1,
                                                   TypeVariableType* tyvar2) {
@@ -1071,6 +1111,71 @@ namespace {
     favorCallOverloads(expr, CS, isFavoredDecl, createReplacements);
   }
   
+  /// Drops the overloads of a binary operator that can't accept its
+  /// arguments, where the arguments are already known to be of particular
+  /// structs or enums.
+  ///
+  /// The disjunction for an operator like '+' covers every overload in
+  /// scope, almost all of which are for other types; without this, each of
+  /// them is tried in turn.
+  void pruneBinaryOperatorOverloads(ApplyExpr *expr, ConstraintSystem &CS) {
+    auto tyvarType = expr->getFn()->getType()->getAs<TypeVariableType>();
+    if (!tyvarType)
+      return;
+
+    auto argTupleTy = expr->getArg()->getType()->getAs<TupleType>();
+    if (!argTupleTy || argTupleTy->getNumElements() != 2)
+      return;
+    NominalTypeDecl *argTypes[2];
+    for (unsigned i = 0; i != 2; ++i) {
+      Type argTy = getInnerParenType(argTupleTy->getElement(i).getType());
+      argTypes[i] = getExactStructOrEnum(argTy->getRValueType());
+    }
+    if (!argTypes[0] && !argTypes[1])
+      return;
+
+    SmallVector<Constraint *, 4> constraints;
+    CS.getConstraintGraph().gatherConstraints(tyvarType, constraints);
+    for (auto constraint : constraints) {
+      if (constraint->getKind() != ConstraintKind::Disjunction)
+        continue;
+      auto choices = constraint->getNestedConstraints();
+      if (choices[0]->getKind() != ConstraintKind::BindOverload)
+        continue;
+
+      SmallVector<Constraint *, 4> viableChoices;
+      for (auto choice : choices) {
+        if (choice->getKind() == ConstraintKind::BindOverload &&
+            choice->getOverloadChoice().getKind() == OverloadChoiceKind::Decl) {
+          auto paramTypes = CS.TC.getBinaryOperatorParamTypes(
+                              choice->getOverloadChoice().getDecl());
+          if ((argTypes[0] && paramTypes.first &&
+               argTypes[0] != paramTypes.first) ||
+              (argTypes[1] && paramTypes.second &&
+               argTypes[1] != paramTypes.second))
+            continue;
+        }
+        viableChoices.push_back(choice);
+      }
+
+      // Leave the disjunction alone if nothing would go, or if everything
+      // would; in the latter case the full set is needed for diagnostics.
+      if (viableChoices.size() == choices.size() || viableChoices.empty())
+        break;
+      auto rememberChoice = constraint->shouldRememberChoice()
+                              ? RememberChoice : ForgetChoice;
+      if (rememberChoice && viableChoices.size() == 1)
+        break;
+
+      CS.removeInactiveConstraint(constraint);
+      CS.addConstraint(
+        Constraint::createDisjunction(CS, viableChoices,
+                                      constraint->getLocator(),
+                                      rememberChoice));
+      break;
+    }
+  }
+
   class ConstraintOptimizer : public ASTWalker {
     
     ConstraintSystem &CS;
@@ -1087,6 +1192,7 @@ namespace {
             isa<PostfixUnaryExpr>(applyExpr)) {
           favorMatchingUnaryOperators(applyExpr, CS);
         } else if (isa<BinaryExpr>(applyExpr)) {
+          pruneBinaryOperatorOverloads(applyExpr, CS);
           favorMatchingBinaryOperators(applyExpr, CS);
         } else {
           favorMatchingOverloadExprs(applyExpr, CS);
@@ -1863,25 +1969,111 @@ namespace {
                                                ConstraintLocator::Member),
                                              /*options=*/0);
 
+      // Elements that are literals of the same shape get the same type, so
+      // merge their equivalence classes and only convert the first of them.
+      // This keeps large literals of repeated shapes from turning into one
+      // independent problem per element.
+      //
+      // Likewise, elements whose types are already known convert to the
+      // element type the same way as any earlier element of the same type.
+      llvm::DenseSet<Expr *> mergedElements;
+      llvm::StringMap<TypeVariableType *> firstTyvarOfShape;
+      llvm::SmallPtrSet<TypeBase *, 4> concreteElementTypes;
+      SmallString<16> shape;
+      for (auto element : expr->getElements()) {
+        if (!element->getType()->hasTypeVariable()) {
+          auto canTy = element->getType()->getCanonicalType().getPointer();
+          if (!concreteElementTypes.insert(canTy).second)
+            mergedElements.insert(element);
+          continue;
+        }
+        auto tyvar = element->getType()->getAs<TypeVariableType>();
+        shape.clear();
+        if (!tyvar || !getLiteralShape(element, shape))
+          continue;
+        auto inserted = firstTyvarOfShape.insert({shape, tyvar});
+        if (inserted.second)
+          continue;
+        mergeRepresentativeEquivalenceClasses(CS, inserted.first->getValue(),
+                                              tyvar);
+        mergedElements.insert(element);
+      }
+
       // Introduce conversions from each element to the element type of the
       // array.
       unsigned index = 0;
       for (auto element : expr->getElements()) {
+        auto elementLocator = CS.getConstraintLocator(
+                                expr,
+                                LocatorPathElt::getTupleElement(index++));
+        if (mergedElements.count(element))
+          continue;
         CS.addConstraint(ConstraintKind::Conversion,
                          element->getType(),
                          arrayElementTy,
-                         CS.getConstraintLocator(
-                           expr,
-                           LocatorPathElt::getTupleElement(index++)));
+                         elementLocator);
       }
 
       return arrayTy;
     }
 
-    static bool isMergeableValueKind(Expr *expr) {
-      return isa<CollectionExpr>(expr) ||
-             isa<StringLiteralExpr>(expr) || isa<IntegerLiteralExpr>(expr) ||
-             isa<FloatLiteralExpr>(expr);
+    /// Appends a description of the shape of \p expr to \p shape, if it's a
+    /// literal whose type depends on nothing but that shape: for example,
+    /// [1, 2] and [3] have the same shape, but [1, 2] and [1, "a"] don't.
+    static bool getLiteralShape(Expr *expr, SmallVectorImpl<char> &shape) {
+      if (isa<IntegerLiteralExpr>(expr)) {
+        shape.push_back('i');
+        return true;
+      }
+      if (isa<FloatLiteralExpr>(expr)) {
+        shape.push_back('f');
+        return true;
+      }
+      if (isa<BooleanLiteralExpr>(expr)) {
+        shape.push_back('b');
+        return true;
+      }
+      if (isa<StringLiteralExpr>(expr)) {
+        shape.push_back('s');
+        return true;
+      }
+
+      // A collection has a shape if all of its elements have the same one.
+      auto collection = dyn_cast<CollectionExpr>(expr);
+      if (!collection || collection->getElements().empty())
+        return false;
+      bool isDictionary = isa<DictionaryExpr>(collection);
+      shape.push_back(isDictionary ? '{' : '[');
+      size_t start = shape.size();
+      size_t elementShapeSize = 0;
+      for (auto element : collection->getElements()) {
+        size_t elementStart = shape.size();
+        if (isDictionary) {
+          auto tuple = dyn_cast<TupleExpr>(element);
+          if (!tuple || tuple->getNumElements() != 2 ||
+              !getLiteralShape(tuple->getElement(0), shape))
+            return false;
+          shape.push_back(':');
+          if (!getLiteralShape(tuple->getElement(1), shape))
+            return false;
+        } else if (!getLiteralShape(element, shape)) {
+          return false;
+        }
+
+        // Keep only the first element's shape, after checking that this
+        // element's is the same.
+        if (elementStart == start) {
+          elementShapeSize = shape.size() - start;
+          continue;
+        }
+        if (shape.size() - elementStart != elementShapeSize ||
+            !std::equal(shape.begin() + start, shape.begin() + elementStart,
+                        shape.begin() + elementStart))
+          return false;
+        shape.resize(elementStart);
+      }
+      shape.push_back(isDictionary ? '}' : ']');
+      return true;
     }
 
     Type visitDictionaryExpr(DictionaryExpr *expr) {
@@ -1938,49 +2130,54 @@ namespace {
       // been merged.
       llvm::DenseSet<Expr *> mergedElements;
 
-      // If no contextual type is present, Merge equivalence classes of key 
-      // and value types as necessary.
+      // If no contextual type is present, merge equivalence classes of key
+      // and value types as necessary. Every key gets the same type, as does
+      // every value that's a literal of the same shape, so an element whose
+      // value has the same shape as an earlier one's needs no conversion of
+      // its own.
       if (!CS.getContextualType(expr)) {
-        for (auto element1 : expr->getElements()) {
-          for (auto element2 : expr->getElements()) {
-            if (element1 == element2)
-              continue;
-
-            auto tty1 = element1->getType()->getAs<TupleType>();
-            auto tty2 = element2->getType()->getAs<TupleType>();
-
-            if (tty1 && tty2) {
-              auto mergedKey = false;
-              auto mergedValue = false;
-
-              auto keyTyvar1 = tty1->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-              auto keyTyvar2 = tty2->getElementTypes()[0]->
-                                getAs<TypeVariableType>();
-
-              mergedKey = mergeRepresentativeEquivalenceClasses(CS, 
-                            keyTyvar1, keyTyvar2);
-
-              auto valueTyvar1 = tty1->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-              auto valueTyvar2 = tty2->getElementTypes()[1]->
-                                  getAs<TypeVariableType>();
-
-              auto elemExpr1 = dyn_cast<TupleExpr>(element1)->getElements()[1];
-              auto elemExpr2 = dyn_cast<TupleExpr>(element2)->getElements()[1];
-
-              if (elemExpr1->getKind() == elemExpr2->getKind() &&
-                isMergeableValueKind(elemExpr1)) {
-                mergedValue = mergeRepresentativeEquivalenceClasses(CS, 
-                                valueTyvar1, valueTyvar2);
-              }
-
-              if (mergedKey && mergedValue)
-                mergedElements.insert(element2);
-            }
+        TypeVariableType *firstKeyTyvar = nullptr;
+        llvm::StringMap<TypeVariableType *> firstValueTyvarOfShape;
+        llvm::SmallPtrSet<TypeBase *, 4> concreteElementTypes;
+        SmallString<16> shape;
+        for (auto element : expr->getElements()) {
+          // Elements whose key and value types are already known need only
+          // one conversion per distinct type.
+          if (!element->getType()->hasTypeVariable()) {
+            auto canTy = element->getType()->getCanonicalType().getPointer();
+            if (!concreteElementTypes.insert(canTy).second)
+              mergedElements.insert(element);
+            continue;
           }
+
+          auto tty = element->getType()->getAs<TupleType>();
+          auto tuple = dyn_cast<TupleExpr>(element);
+          if (!tty || !tuple)
+            continue;
+
+          auto keyTyvar = tty->getElementTypes()[0]->getAs<TypeVariableType>();
+          if (!keyTyvar)
+            continue;
+          if (!firstKeyTyvar)
+            firstKeyTyvar = keyTyvar;
+          else
+            mergeRepresentativeEquivalenceClasses(CS, firstKeyTyvar, keyTyvar);
+
+          auto valueTyvar =
+            tty->getElementTypes()[1]->getAs<TypeVariableType>();
+          auto valueExpr = tuple->getElements()[1];
+          shape.clear();
+          if (!valueTyvar || !getLiteralShape(valueExpr, shape))
+            continue;
+          auto inserted = firstValueTyvarOfShape.insert({shape, valueTyvar});
+          if (inserted.second)
+            continue;
+          mergeRepresentativeEquivalenceClasses(CS,
+                                                inserted.first->getValue(),
+                                                valueTyvar);
+          mergedElements.insert(element);
         }
-      }      
+      }
 
       // Introduce conversions from each element to the element type of the
       // dictionary. (If the equivalence class of an element has already been
@@ -16,7 +16,9 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "swift/AST/ArchetypeBuilder.h"
+#include "swift/Basic/Defer.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Timer.h"
 
 using namespace swift;
 using namespace constraints;
@@ -26,6 +28,8 @@ using namespace constraints;
 //===----------------------------------------------------------------------===//
 #define DEBUG_TYPE "Constraint solver overall"
 STATISTIC(NumDiscardedSolutions, "Number of solutions discarded");
+STATISTIC(NumSolutionsDiscardedByFixedScore,
+          "Number of solutions discarded for their fixed score alone");
 
 void ConstraintSystem::increaseScore(ScoreKind kind) {
   unsigned index = static_cast<unsigned>(kind);
@@ -733,6 +737,8 @@ ConstraintSystem::compareSolutions(ConstraintSystem &cs,
                                    ArrayRef<Solution> solutions,
                                    const SolutionDiff &diff,
                                    unsigned idx1, unsigned idx2) {
+  if (cs.solverState)
+    ++cs.solverState->NumSolutionsCompared;
 
   if (cs.TC.getLangOpts().DebugConstraintSolver) {
     auto &log = cs.getASTContext().TypeCheckerDebug->getStream();
@@ -1143,12 +1149,43 @@ ConstraintSystem::findBestSolution(SmallVectorImpl<Solution> &viable,
   if (viable.size() == 1)
     return 0;
 
+  auto startTime = llvm::TimeRecord::getCurrentTime();
+  defer {
+    auto endTime = llvm::TimeRecord::getCurrentTime(false);
+    TotalRankingTime += endTime.getWallTime() - startTime.getWallTime();
+  };
+
+  // A solution with a worse fixed score than another loses to it without
+  // anything else being compared, so drop those before comparing solutions
+  // pairwise.
+  SmallVector<bool, 16> losers(viable.size(), false);
+  Score bestFixedScore = viable[0].getFixedScore();
+  for (auto &solution : viable)
+    if (solution.getFixedScore() < bestFixedScore)
+      bestFixedScore = solution.getFixedScore();
+  unsigned numWithBestFixedScore = 0;
+  unsigned bestIdx = viable.size();
+  for (unsigned i = 0, n = viable.size(); i != n; ++i) {
+    if (bestFixedScore < viable[i].getFixedScore()) {
+      losers[i] = true;
+      ++NumSolutionsDiscardedByFixedScore;
+      continue;
+    }
+    if (numWithBestFixedScore++ == 0)
+      bestIdx = i;
+  }
+  if (numWithBestFixedScore == 1) {
+    NumDiscardedSolutions += viable.size() - 1;
+    return bestIdx;
+  }
+
   SolutionDiff diff(viable);
 
   // Find a potential best.
-  SmallVector<bool, 16> losers(viable.size(), false);
-  unsigned bestIdx = 0;
-  for (unsigned i = 1, n = viable.size(); i != n; ++i) {
+  for (unsigned i = bestIdx + 1, n = viable.size(); i != n; ++i) {
+    if (losers[i])
+      continue;
+
     switch (compareSolutions(*this, viable, diff, i, bestIdx)) {
     case SolutionCompareResult::Identical:
       // FIXME: Might want to warn about this in debug builds, so we can
@@ -1170,7 +1207,7 @@ ConstraintSystem::findBestSolution(SmallVectorImpl<Solution> &viable,
   // Make sure that our current best is better than all of the solved systems.
   bool ambiguous = false;
   for (unsigned i = 0, n = viable.size(); i != n && !ambiguous; ++i) {
-    if (i == bestIdx)
+    if (i == bestIdx || losers[i])
       continue;
 
     switch (compareSolutions(*this, viable, diff, bestIdx, i)) {
@@ -1250,8 +1287,8 @@ ConstraintSystem::findBestSolution(SmallVectorImpl<Solution> &viable,
 
     ++outIndex;
   }
-  viable.erase(viable.begin() + outIndex, viable.end());
   NumDiscardedSolutions += viable.size() - outIndex;
+  viable.erase(viable.begin() + outIndex, viable.end());
 
   return None;
 }
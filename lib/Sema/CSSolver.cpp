@@ -18,6 +18,8 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -415,7 +417,9 @@ ConstraintSystem::SolverState::~SolverState() {
   langOpts.DebugConstraintSolver = OldDebugConstraintSolver;
 
   // Write our local statistics back to the overall statistics.
-  #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
+  #define CS_STATISTIC(Name, Description) \
+    JOIN2(Overall,Name) += Name; \
+    CS.TotalStats.Name += Name;
   #include "ConstraintSolverStats.def"
 
   // Update the "largest" statistics if this system is larger than the
@@ -1370,6 +1374,22 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     }
   };
 
+  // Each component sees its own type variables and those that aren't part of
+  // any component, in their original order. Sort them out once up front,
+  // since a large literal can split into hundreds of components and scanning
+  // every type variable for each of them is quadratic.
+  std::unique_ptr<SmallVector<unsigned, 8>[]>
+    componentTypeVarIndices(new SmallVector<unsigned, 8>[numComponents]);
+  SmallVector<unsigned, 16> sharedTypeVarIndices;
+  for (unsigned i = 0, n = TypeVariables.size(); i != n; ++i) {
+    auto known = typeVarComponent.find(TypeVariables[i]);
+    if (known == typeVarComponent.end())
+      sharedTypeVarIndices.push_back(i);
+    else
+      componentTypeVarIndices[known->second].push_back(i);
+  }
+  SmallVector<unsigned, 16> typeVarIndices;
+
   // Compute the partial solutions produced for each connected component.
   std::unique_ptr<SmallVector<Solution, 4>[]> 
     partialSolutions(new SmallVector<Solution, 4>[numComponents]);
@@ -1390,13 +1410,14 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     // substituted all of those other type variables through.
     llvm::SmallVector<TypeVariableType *, 16> allTypeVariables 
       = std::move(TypeVariables);
-    for (auto typeVar : allTypeVariables) {
-      auto known = typeVarComponent.find(typeVar);
-      if (known != typeVarComponent.end() && known->second != component)
-        continue;
-
-      TypeVariables.push_back(typeVar);
-    }
+    auto &ownTypeVarIndices = componentTypeVarIndices[component];
+    typeVarIndices.clear();
+    std::merge(ownTypeVarIndices.begin(), ownTypeVarIndices.end(),
+               sharedTypeVarIndices.begin(), sharedTypeVarIndices.end(),
+               std::back_inserter(typeVarIndices));
+    TypeVariables.clear();
+    for (unsigned index : typeVarIndices)
+      TypeVariables.push_back(allTypeVariables[index]);
     
     // Solve for this component. If it fails, we're done.
     bool failed;
@@ -38,6 +38,8 @@ ConstraintGraph::~ConstraintGraph() {
     delete impl.getGraphNode();
     impl.setGraphNode(0);
   }
+  for (auto node : FreeNodes)
+    delete node;
 }
 
 #pragma mark Graph accessors
@@ -53,8 +55,17 @@ ConstraintGraph::lookupNode(TypeVariableType *typeVar) {
     return { *nodePtr, impl.getGraphIndex() };
   }
 
-  // Allocate the new node.
-  auto nodePtr = new ConstraintGraphNode(typeVar);
+  // Reuse a node of a type variable that has since been removed, or allocate
+  // a new one.
+  ConstraintGraphNode *nodePtr;
+  if (!FreeNodes.empty()) {
+    nodePtr = FreeNodes.pop_back_val();
+    nodePtr->reset(typeVar);
+  } else {
+    nodePtr = new ConstraintGraphNode(typeVar);
+    if (CS.solverState)
+      ++CS.solverState->NumGraphNodesAllocated;
+  }
   unsigned index = TypeVariables.size();
   impl.setGraphNode(nodePtr);
   impl.setGraphIndex(index);
@@ -145,7 +156,7 @@ ConstraintGraphNode::getAdjacency(TypeVariableType *typeVar) {
 
 void ConstraintGraphNode::modifyAdjacency(
        TypeVariableType *typeVar,
-       std::function<void(Adjacency& adj)> modify) {
+       llvm::function_ref<void(Adjacency& adj)> modify) {
    // Find the adjacency information.
   auto pos = AdjacencyInfo.find(typeVar);
   assert(pos != AdjacencyInfo.end() && "Type variables not adjacent");
@@ -178,6 +189,17 @@ void ConstraintGraphNode::modifyAdjacency(
   Adjacencies.pop_back();
 }
 
+void ConstraintGraphNode::reset(TypeVariableType *typeVar) {
+  TypeVar = typeVar;
+  Constraints.clear();
+  ConstraintIndex.clear();
+  Adjacencies.clear();
+  AdjacencyInfo.clear();
+  EquivalenceClass.clear();
+  MemberTypes.clear();
+  MemberTypeIndex.clear();
+}
+
 void ConstraintGraphNode::addAdjacency(TypeVariableType *typeVar) {
   auto &adjacency = getAdjacency(typeVar);
 
@@ -239,6 +261,8 @@ ConstraintGraphScope::~ConstraintGraphScope() {
   // Pop changes off the stack until we hit the change could we had prior to
   // introducing this scope.
   assert(CG.Changes.size() >= NumChanges && "Scope stack corrupted");
+  if (auto solverState = CG.CS.solverState)
+    solverState->NumGraphChangesUndone += CG.Changes.size() - NumChanges;
   while (CG.Changes.size() > NumChanges) {
     CG.Changes.back().undo(CG);
     CG.Changes.pop_back();
@@ -362,7 +386,7 @@ void ConstraintGraph::removeNode(TypeVariableType *typeVar) {
   // Remove this node.
   auto &impl = typeVar->getImpl();
   unsigned index = impl.getGraphIndex();
-  delete impl.getGraphNode();
+  FreeNodes.push_back(impl.getGraphNode());
   impl.setGraphNode(0);
 
   // Remove this type variable from the list.
@@ -22,6 +22,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include <functional>
@@ -104,7 +105,11 @@ private:
   /// directly. If the adjacency becomes empty afterward, it will be
   /// removed.
   void modifyAdjacency(TypeVariableType *typeVar,
-                       std::function<void(Adjacency& adj)> modify);
+                       llvm::function_ref<void(Adjacency& adj)> modify);
+
+  /// Make this node represent \p typeVar, with no constraints, adjacencies,
+  /// equivalences or member types, keeping the storage it already has.
+  void reset(TypeVariableType *typeVar);
 
   /// Add an adjacency to the list of adjacencies.
   void addAdjacency(TypeVariableType *typeVar);
@@ -323,6 +328,14 @@ private:
   /// The type variables in this graph, in stable order.
   SmallVector<TypeVariableType *, 4> TypeVariables;
 
+  /// Nodes whose type variables have been removed from the graph, to be
+  /// reused for the next type variables added.
+  ///
+  /// The solver adds and removes the same type variables over and over as it
+  /// enters and leaves scopes; reusing the nodes saves allocating them, and
+  /// their vectors and maps, each time.
+  SmallVector<ConstraintGraphNode *, 4> FreeNodes;
+
   /// The kind of change made to the graph.
   enum class ChangeKind {
     /// Added a type variable.
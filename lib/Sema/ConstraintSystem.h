@@ -1042,6 +1042,17 @@ public:
   /// we're exploring. 
   SolverState *solverState = nullptr;
 
+  /// \brief The statistics of every solver state this system has had, added
+  /// together.
+  struct Statistics {
+    #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+    #include "ConstraintSolverStats.def"
+  };
+  Statistics TotalStats;
+
+  /// The wall time, in seconds, spent ranking solutions.
+  double TotalRankingTime = 0;
+
   struct ArgumentLabelState {
     ArrayRef<Identifier> Labels;
     bool HasTrailingClosure;
@@ -21,8 +21,20 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/Basic/Defer.h"
+#include "llvm/ADT/Statistic.h"
 using namespace swift;
 
+#define DEBUG_TYPE "Iterative type checker"
+STATISTIC(NumRequests, "# of type check requests made");
+STATISTIC(NumRequestsAlreadySatisfied,
+          "# of type check requests already satisfied when made");
+STATISTIC(NumUnbrokenCycles,
+          "# of circular references that couldn't be broken");
+
+#define TYPE_CHECK_REQUEST(Request,PayloadName)                 \
+  STATISTIC(NumProcessed##Request, "# of " #Request " requests processed");
+#include "swift/Sema/TypeCheckRequestKinds.def"
+
 ASTContext &IterativeTypeChecker::getASTContext() const {
   return TC.Context;
 }
@@ -37,6 +49,7 @@ void IterativeTypeChecker::process(
   switch (request.getKind()) {
 #define TYPE_CHECK_REQUEST(Request,PayloadName)                   \
   case TypeCheckRequest::Request:                                 \
+    ++NumProcessed##Request;                                      \
     return process##Request(request.get##PayloadName##Payload(),  \
                             unsatisfiedDependency);
 
@@ -67,7 +80,11 @@ bool IterativeTypeChecker::breakCycle(TypeCheckRequest request) {
 
 void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
   // If the request has already been satisfied, we're done.
-  if (isSatisfied(request)) return;
+  ++NumRequests;
+  if (isSatisfied(request)) {
+    ++NumRequestsAlreadySatisfied;
+    return;
+  }
 
   // Check for circular dependencies in our requests.
   // FIXME: This stack operation is painfully inefficient.
@@ -106,9 +123,18 @@ void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
 
     // Recurse to satisfy any unsatisfied dependencies.
     // FIXME: Don't recurse in the iterative type checker, silly!
+    bool satisfiedAny = false;
     for (auto dependency : unsatisfied) {
       satisfy(dependency);
+      if (isSatisfied(dependency))
+        satisfiedAny = true;
     }
+
+    // If none of them could be satisfied, they're part of a cycle that has
+    // been diagnosed but couldn't be broken, and processing this request
+    // again won't get any further.
+    if (!satisfiedAny)
+      break;
   }
 }
 
@@ -126,18 +152,12 @@ void IterativeTypeChecker::diagnoseCircularReference(
     isFirst = false;
   }
 
-  // Now try to break the cycle.
-#ifndef NDEBUG
-  bool brokeCycle = false;
-#endif
+  // Now try to break the cycle. If it can't be, the requests in it are left
+  // unsatisfied; the cycle has been diagnosed, so the requests that depend on
+  // them give up rather than retrying.
   for (const auto &request : reverse(requests)) {
-    if (breakCycle(request)) {
-#ifndef NDEBUG
-      brokeCycle = true;
-#endif
-      break;
-    }
+    if (breakCycle(request))
+      return;
   }
-
-  assert(brokeCycle && "Will the cycle be unbroken?");
+  ++NumUnbrokenCycles;
 }
@@ -37,6 +37,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1277,6 +1278,38 @@ solveForExpression(Expr *&expr, DeclContext *dc, Type convertType,
 }
 
 namespace {
+  /// Adds an entry to the ASTContext's solver profile once an expression has
+  /// been checked, if there's a profile being recorded.
+  class SolverProfiler {
+    ConstraintSystem &CS;
+    SourceRange Range;
+    llvm::TimeRecord StartTime;
+
+  public:
+    SolverProfiler(ConstraintSystem &cs, Expr *expr)
+      : CS(cs), Range(expr->getSourceRange()),
+        StartTime(llvm::TimeRecord::getCurrentTime()) {}
+
+    ~SolverProfiler() {
+      ASTContext &ctx = CS.getASTContext();
+      if (!ctx.SolverProfile)
+        return;
+
+      llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
+      ASTContext::SolverProfileEntry entry;
+      entry.Range = Range;
+      entry.WallTime = endTime.getWallTime() - StartTime.getWallTime();
+      entry.RankingTime = CS.TotalRankingTime;
+      entry.PeakSolverMemory = ctx.getSolverMemory();
+      entry.NumStatesExplored = CS.TotalStats.NumStatesExplored;
+      entry.NumDisjunctions = CS.TotalStats.NumDisjunctions;
+      entry.NumDisjunctionTerms = CS.TotalStats.NumDisjunctionTerms;
+      entry.NumComponentsSplit = CS.TotalStats.NumComponentsSplit;
+      entry.NumSolutionsCompared = CS.TotalStats.NumSolutionsCompared;
+      ctx.SolverProfile->push_back(entry);
+    }
+  };
+
   /// ExprCleanser - This class is used by typeCheckExpression to ensure that in
   /// no situation will an expr node be left with a dangling type variable stuck
   /// to it.  Often type checking will create new AST nodes and replace old ones
@@ -1357,6 +1390,9 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
   ConstraintSystem cs(*this, dc, csOptions);
   CleanupIllFormedExpressionRAII cleanup(Context, expr);
   ExprCleanser cleanup2(expr);
+  Optional<SolverProfiler> profiler;
+  if (Context.SolverProfile)
+    profiler.emplace(cs, expr);
 
   // Verify that a purpose was specified if a convertType was.  Note that it is
   // ok to have a purpose without a convertType (which is used for call
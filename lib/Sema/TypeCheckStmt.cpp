@@ -35,6 +35,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/Timer.h"
 
 using namespace swift;
@@ -288,6 +289,8 @@ public:
   /// switch.
   CaseStmt /*nullable*/ *FallthroughDest = nullptr;
 
+  /// When valid, the body is only type-checked up to the statement containing
+  /// this location (the code completion point).
   SourceLoc EndTypeCheckLoc;
 
   /// Used to check for discarded expression values: in the REPL top-level
@@ -1137,6 +1140,21 @@ void TypeChecker::checkIgnoredExpr(Expr *E) {
     .highlight(valueE->getSourceRange());
 }
 
+/// Whether an element of a brace statement that ends before \p EndLoc can be
+/// left unchecked when type-checking only up to \p EndLoc.
+///
+/// Expressions and statements don't make names visible to the statements that
+/// follow them, with the exception of 'guard' and '#if', so the result of
+/// checking them cannot matter at \p EndLoc. Declarations are always checked.
+static bool canSkipBeforeEndLoc(const SourceManager &SM, SourceRange Range,
+                                Stmt *S, SourceLoc EndLoc) {
+  if (EndLoc.isInvalid() || Range.End.isInvalid())
+    return false;
+  if (S && (isa<GuardStmt>(S) || isa<IfConfigStmt>(S)))
+    return false;
+  return SM.isBeforeInBuffer(Range.End, EndLoc);
+}
+
 Stmt *StmtChecker::visitBraceStmt(BraceStmt *BS) {
   const SourceManager &SM = TC.Context.SourceMgr;
   for (auto &elem : BS->getElements()) {
@@ -1145,6 +1163,9 @@ Stmt *StmtChecker::visitBraceStmt(BraceStmt *BS) {
       if (EndTypeCheckLoc.isValid() &&
           (Loc == EndTypeCheckLoc || SM.isBeforeInBuffer(EndTypeCheckLoc, Loc)))
         break;
+      if (canSkipBeforeEndLoc(SM, SubExpr->getSourceRange(), nullptr,
+                              EndTypeCheckLoc))
+        continue;
 
       // Type check the expression.
       TypeCheckExprOptions options = TypeCheckExprFlags::IsExprStmt;
@@ -1167,6 +1188,9 @@ Stmt *StmtChecker::visitBraceStmt(BraceStmt *BS) {
       if (EndTypeCheckLoc.isValid() &&
           (Loc == EndTypeCheckLoc || SM.isBeforeInBuffer(EndTypeCheckLoc, Loc)))
         break;
+      if (canSkipBeforeEndLoc(SM, SubStmt->getSourceRange(), SubStmt,
+                              EndTypeCheckLoc))
+        continue;
 
       typeCheckStmt(SubStmt);
       elem = SubStmt;
@@ -1236,6 +1260,10 @@ static void checkDefaultArguments(TypeChecker &tc, ParameterList *params,
 
 bool TypeChecker::typeCheckAbstractFunctionBodyUntil(AbstractFunctionDecl *AFD,
                                                      SourceLoc EndTypeCheckLoc) {
+  llvm::SaveAndRestore<SourceLoc> savedEndLoc(this->EndTypeCheckLoc);
+  if (EndTypeCheckLoc.isValid())
+    this->EndTypeCheckLoc = EndTypeCheckLoc;
+
   if (auto *FD = dyn_cast<FuncDecl>(AFD))
     return typeCheckFunctionBodyUntil(FD, EndTypeCheckLoc);
 
@@ -1496,7 +1524,18 @@ void TypeChecker::typeCheckClosureBody(ClosureExpr *closure) {
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(closure, DebugTimeFunctionBodies, WarnLongFunctionBodies);
 
-  StmtChecker(*this, closure).typeCheckBody(body);
+  StmtChecker SC(*this, closure);
+
+  // When checking a body up to a location, only closures containing it
+  // matter, and only up to that location.
+  if (EndTypeCheckLoc.isValid() && body) {
+    if (!Context.SourceMgr.rangeContainsTokenLoc(body->getSourceRange(),
+                                                 EndTypeCheckLoc))
+      return;
+    SC.EndTypeCheckLoc = EndTypeCheckLoc;
+  }
+
+  SC.typeCheckBody(body);
   if (body) {
     closure->setBody(body, closure->hasSingleExpressionBody());
   }
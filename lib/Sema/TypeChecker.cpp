@@ -397,6 +397,13 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     // Type check the body of each of the function in turn.  Note that outside
     // functions must be visited before nested functions for type-checking to
     // work correctly.
+    //
+    // FIXME: These bodies are mostly independent, but they can't be checked
+    // concurrently: checking one allocates from the ASTContext's arenas,
+    // uniques types in its unlocked tables, validates declarations lazily,
+    // appends to definedFunctions and the other TypeChecker worklists, and
+    // emits diagnostics as it goes. For now, parallelism comes from the
+    // driver running a frontend job per primary file.
     for (unsigned n = TC.definedFunctions.size(); currentFunctionIdx != n;
          ++currentFunctionIdx) {
       auto *AFD = TC.definedFunctions[currentFunctionIdx];
@@ -45,6 +45,7 @@ class TypeChecker;
 namespace constraints {
   enum class ConstraintKind : char;
   class ConstraintSystem;
+  class FailureDiagnosisSession;
   class Solution;
 }
 
@@ -512,6 +513,18 @@ public:
   /// computed.
   llvm::DenseMap<AnyFunctionRef, std::vector<Expr*>> LocalCFunctionPointers;
 
+  /// The types each binary operator function seen so far requires for its
+  /// arguments, as computed by getBinaryOperatorParamTypes.
+  llvm::DenseMap<ValueDecl *, std::pair<NominalTypeDecl *, NominalTypeDecl *>>
+    BinaryOperatorParamTypes;
+
+  /// Returns the struct or enum each parameter of the binary operator
+  /// function \p op requires its argument to be exactly, or null for a
+  /// parameter that arguments of different types could be passed to (because
+  /// it's generic, a class, a protocol, Optional, inout, and so on).
+  std::pair<NominalTypeDecl *, NominalTypeDecl *>
+  getBinaryOperatorParamTypes(ValueDecl *op);
+
 private:
   Type IntLiteralType;
   Type FloatLiteralType;
@@ -541,6 +554,10 @@ private:
   /// The set of expressions currently being analyzed for failures.
   llvm::DenseMap<Expr*, Expr*> DiagnosedExprs;
 
+  /// The outermost failure diagnosis under way, which the diagnoses of the
+  /// subexpressions it re-type-checks share a budget with.
+  constraints::FailureDiagnosisSession *ActiveDiagnosisSession = nullptr;
+
   Module *StdlibModule = nullptr;
 
   /// The index of the next response metavariable to bind to a REPL result.
@@ -561,6 +578,11 @@ private:
   /// when executing scripts.
   bool InImmediateMode = false;
 
+  /// If valid, the location up to which the current function body is
+  /// type-checked, for code completion. Closures that don't contain it are
+  /// not checked at all.
+  SourceLoc EndTypeCheckLoc;
+
   /// A helper to construct and typecheck call to super.init().
   ///
   /// \returns NULL if the constructed expression does not typecheck.
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "Serialization"
 #include "swift/Serialization/ModuleFile.h"
 #include "swift/Serialization/ModuleFormat.h"
 #include "swift/AST/AST.h"
@@ -19,11 +20,26 @@
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 using namespace swift::serialization;
 
+STATISTIC(NumDeclsLoaded, "# of decls deserialized");
+STATISTIC(NumMemberListsLoaded,
+          "# of nominals/extensions whose members were loaded");
+STATISTIC(NumNamedMembersLoaded,
+          "# of members loaded by name without loading all members");
+STATISTIC(NumNormalConformancesLoaded,
+          "# of normal conformances deserialized");
+STATISTIC(NumConformanceTypeWitnessesLoaded,
+          "# of normal conformances whose type witnesses were loaded");
+STATISTIC(NumConformanceValueWitnessesLoaded,
+          "# of normal conformances whose value witnesses were loaded");
+STATISTIC(NumModuleBytesTouched,
+          "# of module file bytes read while deserializing decls and types");
+
 namespace {
   struct IDAndKind {
     const Decl *D;
@@ -223,6 +239,25 @@ namespace {
       }
     }
   };
+
+  /// Counts the bytes of the decls-and-types block read for a single decl or
+  /// type record, not including the records of anything it refers to.
+  ///
+  /// Must be destroyed before any BCOffsetRAII covering the same cursor.
+  class TouchedBytesRAII {
+    llvm::BitstreamCursor &Cursor;
+    uint64_t StartBit;
+
+  public:
+    explicit TouchedBytesRAII(llvm::BitstreamCursor &cursor)
+      : Cursor(cursor), StartBit(cursor.GetCurrentBitNo()) {}
+
+    ~TouchedBytesRAII() {
+      uint64_t endBit = Cursor.GetCurrentBitNo();
+      if (endBit > StartBit)
+        NumModuleBytesTouched += (endBit - StartBit + 7) / 8;
+    }
+  };
 } // end anonymous namespace
 
 
@@ -571,6 +606,7 @@ NormalProtocolConformance *ModuleFile::readNormalConformance(
 
   uint64_t offset = conformanceEntry;
   conformanceEntry = conformance;
+  ++NumNormalConformancesLoaded;
 
   dc->getAsNominalTypeOrNominalTypeExtensionContext()
     ->registerProtocolConformance(conformance);
@@ -1824,8 +1860,10 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   if (declOrOffset.isComplete())
     return declOrOffset;
 
+  ++NumDeclsLoaded;
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(declOrOffset);
+  TouchedBytesRAII countTouchedBytes(DeclTypeCursor);
   auto entry = DeclTypeCursor.advance();
 
   if (entry.Kind != llvm::BitstreamEntry::Record) {
@@ -2335,6 +2373,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theStruct, rawInheritedIDs);
 
     theStruct->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theStruct] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theStruct->setConformanceLoader(
       this,
@@ -2927,6 +2966,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theClass, rawInheritedIDs);
 
     theClass->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theClass] = DID;
     theClass->setHasDestructor();
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theClass->setConformanceLoader(
@@ -2994,6 +3034,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theEnum, rawInheritedIDs);
 
     theEnum->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theEnum] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theEnum->setConformanceLoader(
       this,
@@ -3189,6 +3230,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     }
 
     extension->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[extension] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     extension->setConformanceLoader(
       this,
@@ -3363,6 +3405,7 @@ Type ModuleFile::getType(TypeID TID) {
 
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(typeOrOffset);
+  TouchedBytesRAII countTouchedBytes(DeclTypeCursor);
   auto entry = DeclTypeCursor.advance();
 
   if (entry.Kind != llvm::BitstreamEntry::Record) {
@@ -4089,6 +4132,7 @@ Type ModuleFile::getType(TypeID TID) {
 
 void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   PrettyStackTraceDecl trace("loading members for", D);
+  ++NumMemberListsLoaded;
 
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(contextData);
@@ -4113,6 +4157,31 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+bool ModuleFile::loadNamedMembers(const Decl *D, Identifier Name,
+                                  uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &Members) {
+  if (!DeclMembersByName)
+    return false;
+
+  auto knownID = MemberContextIDs.find(D);
+  if (knownID == MemberContextIDs.end())
+    return false;
+
+  PrettyStackTraceDecl trace("loading members named", D);
+
+  auto iter = DeclMembersByName->find({knownID->second, Name});
+  if (iter == DeclMembersByName->end())
+    return true;
+
+  for (DeclID memberID : *iter) {
+    auto member = cast<ValueDecl>(getDecl(memberID));
+    Members.push_back(member);
+    ++NumNamedMembersLoaded;
+  }
+
+  return true;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
@@ -4139,24 +4208,25 @@ ModuleFile::loadAssociatedTypeDefault(const swift::AssociatedTypeDecl *ATD,
   return TypeLoc::withoutLoc(getType(contextData));
 }
 
-void ModuleFile::finishNormalConformance(NormalProtocolConformance *conformance,
-                                         uint64_t contextData) {
+/// Reads the NORMAL_PROTOCOL_CONFORMANCE record at \p bitPosition, leaving
+/// the cursor at the first record after it.
+static void readNormalConformanceRecord(llvm::BitstreamCursor &cursor,
+                                        uint64_t bitPosition,
+                                        SmallVectorImpl<uint64_t> &scratch,
+                                        unsigned &valueCount,
+                                        unsigned &typeCount,
+                                        unsigned &inheritedCount,
+                                        ArrayRef<uint64_t> &rawIDs) {
   using namespace decls_block;
 
-  // Find the conformance record.
-  BCOffsetRAII restoreOffset(DeclTypeCursor);
-  DeclTypeCursor.JumpToBit(contextData);
-  auto entry = DeclTypeCursor.advance();
+  cursor.JumpToBit(bitPosition);
+  auto entry = cursor.advance();
   assert(entry.Kind == llvm::BitstreamEntry::Record &&
          "registered lazy loader incorrectly");
 
   DeclID protoID;
   DeclContextID contextID;
-  unsigned valueCount, typeCount, inheritedCount;
-  ArrayRef<uint64_t> rawIDs;
-  SmallVector<uint64_t, 16> scratch;
-
-  unsigned kind = DeclTypeCursor.readRecord(entry.ID, scratch);
+  unsigned kind = cursor.readRecord(entry.ID, scratch);
   (void) kind;
   assert(kind == NORMAL_PROTOCOL_CONFORMANCE &&
          "registered lazy loader incorrectly");
@@ -4164,23 +4234,26 @@ void ModuleFile::finishNormalConformance(NormalProtocolConformance *conformance,
                                               contextID, valueCount,
                                               typeCount, inheritedCount,
                                               rawIDs);
+}
 
-  // Skip trailing inherited conformances.
+void ModuleFile::finishNormalConformanceTypeWitnesses(
+       NormalProtocolConformance *conformance, uint64_t contextData) {
+  ++NumConformanceTypeWitnessesLoaded;
+
+  // Find the conformance record.
+  BCOffsetRAII restoreOffset(DeclTypeCursor);
+  unsigned valueCount, typeCount, inheritedCount;
+  ArrayRef<uint64_t> rawIDs;
+  SmallVector<uint64_t, 16> scratch;
+  readNormalConformanceRecord(DeclTypeCursor, contextData, scratch,
+                              valueCount, typeCount, inheritedCount, rawIDs);
+
+  // The type witness substitutions follow the inherited conformances.
   while (inheritedCount--)
     (void)readConformance(DeclTypeCursor);
 
-  ASTContext &ctx = getContext();
-  ArrayRef<uint64_t>::iterator rawIDIter = rawIDs.begin();
-
-  WitnessMap witnesses;
-  while (valueCount--) {
-    auto first = cast<ValueDecl>(getDecl(*rawIDIter++));
-    auto second = cast_or_null<ValueDecl>(getDecl(*rawIDIter++));
-    assert(second || first->getAttrs().hasAttribute<OptionalAttr>() ||
-           first->getAttrs().isUnavailable(ctx));
-    (void) ctx;
-    witnesses.insert(std::make_pair(first, second));
-  }
+  // Skip the value witnesses.
+  ArrayRef<uint64_t>::iterator rawIDIter = rawIDs.begin() + 2 * valueCount;
   assert(rawIDIter <= rawIDs.end() && "read too much");
 
   TypeWitnessMap typeWitnesses;
@@ -4195,13 +4268,39 @@ void ModuleFile::finishNormalConformance(NormalProtocolConformance *conformance,
   }
   assert(rawIDIter <= rawIDs.end() && "read too much");
 
-  // Set type witnesses.
   for (auto typeWitness : typeWitnesses) {
     conformance->setTypeWitness(typeWitness.first, typeWitness.second.first,
                                 typeWitness.second.second);
   }
+}
+
+void ModuleFile::finishNormalConformanceValueWitnesses(
+       NormalProtocolConformance *conformance, uint64_t contextData) {
+  ++NumConformanceValueWitnessesLoaded;
+
+  // Find the conformance record. The value witnesses are entirely described
+  // by the record itself, so there's no need to read the trailing records.
+  BCOffsetRAII restoreOffset(DeclTypeCursor);
+  unsigned valueCount, typeCount, inheritedCount;
+  ArrayRef<uint64_t> rawIDs;
+  SmallVector<uint64_t, 16> scratch;
+  readNormalConformanceRecord(DeclTypeCursor, contextData, scratch,
+                              valueCount, typeCount, inheritedCount, rawIDs);
+
+  ASTContext &ctx = getContext();
+  ArrayRef<uint64_t>::iterator rawIDIter = rawIDs.begin();
+
+  WitnessMap witnesses;
+  while (valueCount--) {
+    auto first = cast<ValueDecl>(getDecl(*rawIDIter++));
+    auto second = cast_or_null<ValueDecl>(getDecl(*rawIDIter++));
+    assert(second || first->getAttrs().hasAttribute<OptionalAttr>() ||
+           first->getAttrs().isUnavailable(ctx));
+    (void) ctx;
+    witnesses.insert(std::make_pair(first, second));
+  }
+  assert(rawIDIter <= rawIDs.end() && "read too much");
 
-  // Set witnesses.
   for (auto witness : witnesses) {
     conformance->setWitness(witness.first, witness.second);
   }
@@ -112,11 +112,11 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
 
   llvm::BitstreamCursor cursor = SILIndexCursor;
   // We expect SIL_FUNC_NAMES first, then SIL_VTABLE_NAMES, then
-  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, and finally
-  // SIL_DEFAULT_WITNESS_TABLE_NAMES. But each one can be
-  // omitted if no entries exist in the module file.
+  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, then
+  // SIL_DEFAULT_WITNESS_TABLE_NAMES, and finally SIL_FUNC_EFFECTS_NAMES. But
+  // each one can be omitted if no entries exist in the module file.
   unsigned kind = 0;
-  while (kind != sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES) {
+  while (kind != sil_index_block::SIL_FUNC_EFFECTS_NAMES) {
     auto next = cursor.advance();
     if (next.Kind == llvm::BitstreamEntry::EndBlock)
       return;
@@ -131,9 +131,11 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
              kind == sil_index_block::SIL_VTABLE_NAMES ||
              kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
              kind == sil_index_block::SIL_WITNESS_TABLE_NAMES ||
-             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES)) &&
+             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES ||
+             kind == sil_index_block::SIL_FUNC_EFFECTS_NAMES)) &&
          "Expect SIL_FUNC_NAMES, SIL_VTABLE_NAMES, SIL_GLOBALVAR_NAMES, \
-          SIL_WITNESS_TABLE_NAMES, or SIL_DEFAULT_WITNESS_TABLE_NAMES.");
+          SIL_WITNESS_TABLE_NAMES, SIL_DEFAULT_WITNESS_TABLE_NAMES, or \
+          SIL_FUNC_EFFECTS_NAMES.");
     (void)prevKind;
 
     if (kind == sil_index_block::SIL_FUNC_NAMES)
@@ -146,6 +148,8 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
       WitnessTableList = readFuncTable(scratch, blobData);
     else if (kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES)
       DefaultWitnessTableList = readFuncTable(scratch, blobData);
+    else if (kind == sil_index_block::SIL_FUNC_EFFECTS_NAMES)
+      EffectsSummaryList = readFuncTable(scratch, blobData);
 
     // Read SIL_FUNC|VTABLE|GLOBALVAR_OFFSETS record.
     next = cursor.advance();
@@ -177,6 +181,11 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
               offKind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_OFFSETS) &&
              "Expect a SIL_DEFAULT_WITNESS_TABLE_OFFSETS record.");
       DefaultWitnessTables.assign(scratch.begin(), scratch.end());
+    } else if (kind == sil_index_block::SIL_FUNC_EFFECTS_NAMES) {
+      assert((next.Kind == llvm::BitstreamEntry::Record &&
+              offKind == sil_index_block::SIL_FUNC_EFFECTS_OFFSETS) &&
+             "Expect a SIL_FUNC_EFFECTS_OFFSETS record.");
+      EffectsSummaries.assign(scratch.begin(), scratch.end());
     }
   }
 }
@@ -2393,6 +2402,42 @@ SILDeserializer::lookupDefaultWitnessTable(SILDefaultWitnessTable *existingWt) {
   return Wt;
 }
 
+bool SILDeserializer::lookupEffectsSummary(StringRef Name,
+                                           SILFunctionEffectsSummary &Summary) {
+  // If we don't have any summaries, we can't look anything up.
+  if (!EffectsSummaryList)
+    return false;
+
+  auto iter = EffectsSummaryList->find(Name);
+  if (iter == EffectsSummaryList->end())
+    return false;
+  DeclID SId = *iter;
+  assert(SId != 0 && SId <= EffectsSummaries.size() &&
+         "invalid effects summary ID");
+
+  BCOffsetRAII restoreOffset(SILCursor);
+  SILCursor.JumpToBit(EffectsSummaries[SId-1]);
+  auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+  if (entry.Kind == llvm::BitstreamEntry::Error) {
+    DEBUG(llvm::dbgs() << "Cursor advance error in lookupEffectsSummary.\n");
+    return false;
+  }
+
+  SmallVector<uint64_t, 8> scratch;
+  unsigned kind = SILCursor.readRecord(entry.ID, scratch);
+  assert(kind == SIL_FUNCTION_EFFECTS && "expect a sil function effects");
+  (void)kind;
+
+  unsigned GlobalEffects;
+  ArrayRef<uint64_t> ArgumentEffects;
+  SILFunctionEffectsLayout::readRecord(scratch, GlobalEffects,
+                                       ArgumentEffects);
+  Summary.GlobalEffects = GlobalEffects;
+  Summary.ArgumentEffects.assign(ArgumentEffects.begin(),
+                                 ArgumentEffects.end());
+  return true;
+}
+
 SILDeserializer::~SILDeserializer() {
   // Drop our references to anything we've deserialized.
   for (auto &fnEntry : Funcs) {
@@ -53,6 +53,9 @@ namespace swift {
     std::vector<ModuleFile::PartiallySerialized<SILDefaultWitnessTable *>>
     DefaultWitnessTables;
 
+    std::unique_ptr<SerializedFuncTable> EffectsSummaryList;
+    std::vector<uint64_t> EffectsSummaries;
+
     /// A declaration will only
     llvm::DenseMap<NormalProtocolConformance *, SILWitnessTable *>
     ConformanceToWitnessTableMap;
@@ -122,6 +125,8 @@ public:
     SILWitnessTable *lookupWitnessTable(SILWitnessTable *wt);
     SILDefaultWitnessTable *
     lookupDefaultWitnessTable(SILDefaultWitnessTable *wt);
+    bool lookupEffectsSummary(StringRef Name,
+                              SILFunctionEffectsSummary &Summary);
 
     /// Invalidate all cached SILFunctions.
     void invalidateFunctionCache();
@@ -204,6 +204,9 @@ validateControlBlock(llvm::BitstreamCursor &cursor,
     case control_block::TARGET:
       result.targetTriple = blobData;
       break;
+    case control_block::INTERFACE_HASH:
+      result.interfaceHash = blobData;
+      break;
     default:
       // Unknown metadata record, possibly for use by a future version of the
       // module format.
@@ -399,6 +402,65 @@ ModuleFile::readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
     base + sizeof(uint32_t), base));
 }
 
+/// Used to deserialize entries in the on-disk table of members by parent and
+/// name.
+class ModuleFile::DeclMemberTableInfo {
+public:
+  using internal_key_type = std::pair<uint32_t, StringRef>;
+  using external_key_type = std::pair<DeclID, Identifier>;
+  using data_type = SmallVector<DeclID, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type key) {
+    return { key.first, key.second.str() };
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.second, key.first);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint32_t parentID = endian::readNext<uint32_t, little, unaligned>(data);
+    return { parentID, StringRef(reinterpret_cast<const char *>(data),
+                                 length - sizeof(uint32_t)) };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      DeclID memberID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back(memberID);
+      length -= sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedDeclMemberTable>
+ModuleFile::readDeclMemberTable(ArrayRef<uint64_t> fields,
+                                StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberTable>;
+  return OwnedTable(SerializedDeclMemberTable::Create(base + tableOffset,
+    base + sizeof(uint32_t), base));
+}
+
 /// Used to deserialize entries in the on-disk Objective-C method table.
 class ModuleFile::ObjCMethodTableInfo {
 public:
@@ -534,6 +596,9 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         assert(blobData.empty());
         NormalConformances.assign(scratch.begin(), scratch.end());
         break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMembersByName = readDeclMemberTable(scratch, blobData);
+        break;
 
       default:
         // Unknown index kind, which this version of the compiler won't use.
@@ -94,7 +94,9 @@ namespace sil_index_block {
     SIL_WITNESS_TABLE_NAMES,
     SIL_WITNESS_TABLE_OFFSETS,
     SIL_DEFAULT_WITNESS_TABLE_NAMES,
-    SIL_DEFAULT_WITNESS_TABLE_OFFSETS
+    SIL_DEFAULT_WITNESS_TABLE_OFFSETS,
+    SIL_FUNC_EFFECTS_NAMES,
+    SIL_FUNC_EFFECTS_OFFSETS
   };
 
   using ListLayout = BCGenericRecordLayout<
@@ -143,6 +145,7 @@ namespace sil_block {
     SIL_GENERIC_OUTER_PARAMS,
     SIL_INST_WITNESS_METHOD,
     SIL_SPECIALIZE_ATTR,
+    SIL_FUNCTION_EFFECTS,
 
     // We also share these layouts from the decls block. Their enumerators must
     // not overlap with ours.
@@ -254,6 +257,12 @@ namespace sil_block {
                      // followed by generic param list, if any
                      >;
 
+  using SILFunctionEffectsLayout = BCRecordLayout<
+    SIL_FUNCTION_EFFECTS,
+    BCFixed<7>,          // global effects
+    BCArray<BCFixed<4>>  // effects on each argument
+  >;
+
   using SILSpecializeAttrLayout =
       BCRecordLayout<SIL_SPECIALIZE_ATTR,
                      BCFixed<5> // number of substitutions
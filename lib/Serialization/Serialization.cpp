@@ -29,6 +29,8 @@
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
+#include "swift/AST/PrintOptions.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/Serialization/SerializationOptions.h"
 
 #include "clang/Basic/Module.h"
@@ -44,6 +46,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -108,6 +111,48 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk table of members by parent and name.
+  class DeclMemberTableInfo {
+  public:
+    using key_type = std::pair<unsigned, Identifier>;
+    using key_type_ref = const key_type &;
+    using data_type = Serializer::DeclMemberTableData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.second.empty());
+      return llvm::HashString(key.second.str(), key.first);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint32_t) + key.second.str().size();
+      uint32_t dataLength = sizeof(uint32_t) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      writer.write<uint32_t>(key.first);
+      out << key.second.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data)
+        writer.write<uint32_t>(entry);
+    }
+  };
+
   class LocalDeclTableInfo {
   public:
     using key_type = std::string;
@@ -434,6 +479,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(control_block, METADATA);
   BLOCK_RECORD(control_block, MODULE_NAME);
   BLOCK_RECORD(control_block, TARGET);
+  BLOCK_RECORD(control_block, INTERFACE_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   BLOCK_RECORD(options_block, SDK_PATH);
@@ -472,6 +518,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, DECL_CONTEXT_OFFSETS);
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
+  BLOCK_RECORD(index_block, DECL_MEMBER_NAMES);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -564,12 +611,80 @@ void Serializer::writeDocBlockInfoBlock() {
 #undef BLOCK_RECORD
 }
 
-void Serializer::writeHeader(const SerializationOptions &options) {
+/// Whether a client's object code could depend on \p D, and so whether it has
+/// to be part of the module's interface hash.
+///
+/// This is deliberately conservative: every nominal type is included whatever
+/// its accessibility, since a public type's layout can depend on the layout of
+/// a non-public one.
+static bool isPartOfInterfaceHash(const Decl *D, Accessibility minAccess) {
+  if (isa<TopLevelCodeDecl>(D) || isa<IfConfigDecl>(D))
+    return false;
+  if (isa<NominalTypeDecl>(D))
+    return true;
+  if (auto VD = dyn_cast<ValueDecl>(D))
+    return VD->hasAccessibility() && VD->getFormalAccess() >= minAccess;
+  return true;
+}
+
+/// Computes the fingerprint stored in the INTERFACE_HASH record.
+///
+/// Declarations are printed without function bodies but with all of their
+/// members, since private stored properties and methods still affect type
+/// layout and class vtables. SIL function bodies that will be serialized are
+/// hashed too, because clients may inline them.
+static void computeInterfaceHash(ArrayRef<const FileUnit *> files,
+                                 const Module *M, const SILModule *SILMod,
+                                 bool serializeAllSIL,
+                                 SmallVectorImpl<char> &result) {
+  llvm::MD5 hash;
+  SmallString<256> buffer;
+
+  PrintOptions options;
+  options.PrintAccessibility = true;
+  options.SkipImplicit = true;
+  Accessibility minAccess = M->isTestingEnabled() ? Accessibility::Internal
+                                                  : Accessibility::Public;
+
+  for (auto file : files) {
+    SmallVector<Decl *, 32> fileDecls;
+    file->getTopLevelDecls(fileDecls);
+    for (auto D : fileDecls) {
+      if (!isPartOfInterfaceHash(D, minAccess))
+        continue;
+      buffer.clear();
+      llvm::raw_svector_ostream out(buffer);
+      D->print(out, options);
+      hash.update(out.str());
+    }
+  }
+
+  if (SILMod) {
+    for (const SILFunction &F : *SILMod) {
+      if (F.isExternalDeclaration() || (!serializeAllSIL && !F.isFragile()))
+        continue;
+      buffer.clear();
+      llvm::raw_svector_ostream out(buffer);
+      F.print(out);
+      hash.update(out.str());
+    }
+  }
+
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  SmallString<32> digestString;
+  llvm::MD5::stringifyResult(digest, digestString);
+  result.assign(digestString.begin(), digestString.end());
+}
+
+void Serializer::writeHeader(const SerializationOptions &options,
+                             const SILModule *SILMod) {
   {
     BCBlockRAII restoreBlock(Out, CONTROL_BLOCK_ID, 3);
     control_block::ModuleNameLayout ModuleName(Out);
     control_block::MetadataLayout Metadata(Out);
     control_block::TargetLayout Target(Out);
+    control_block::InterfaceHashLayout InterfaceHash(Out);
 
     ModuleName.emit(ScratchRecord, M->getName().str());
 
@@ -584,6 +699,12 @@ void Serializer::writeHeader(const SerializationOptions &options) {
 
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
+    SmallString<32> interfaceHash;
+    ArrayRef<const FileUnit *> files = SF ? SF : M->getFiles();
+    computeInterfaceHash(files, M, SILMod, options.SerializeAllSIL,
+                         interfaceHash);
+    InterfaceHash.emit(ScratchRecord, interfaceHash);
+
     {
       llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
 
@@ -1247,7 +1368,8 @@ static bool shouldSerializeMember(Decl *D) {
   }
 }
 
-void Serializer::writeMembers(DeclRange members, bool isClass) {
+void Serializer::writeMembers(DeclID parentID, DeclRange members,
+                              bool isClass) {
   using namespace decls_block;
 
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
@@ -1259,6 +1381,15 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (parentID) {
+      if (auto VD = dyn_cast<ValueDecl>(member)) {
+        if (VD->hasName()) {
+          auto &list = DeclMembersByName[{parentID, VD->getName()}];
+          list.push_back(memberID);
+        }
+      }
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -2103,7 +2234,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(extension->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(extension->getGenericRequirements());
-    writeMembers(extension->getMembers(), isClassExtension);
+    writeMembers(id, extension->getMembers(), isClassExtension);
     writeConformances(conformances, DeclTypeAbbrCodes);
 
     break;
@@ -2282,7 +2413,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theStruct->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theStruct->getGenericRequirements());
-    writeMembers(theStruct->getMembers(), false);
+    writeMembers(id, theStruct->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2316,7 +2447,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theEnum->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theEnum->getGenericRequirements());
-    writeMembers(theEnum->getMembers(), false);
+    writeMembers(id, theEnum->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2353,7 +2484,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theClass->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theClass->getGenericRequirements());
-    writeMembers(theClass->getMembers(), true);
+    writeMembers(id, theClass->getMembers(), true);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2389,7 +2520,9 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(proto->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(proto->getGenericRequirements());
-    writeMembers(proto->getMembers(), true);
+    // Protocol members are always loaded together with the default witness
+    // table, so they aren't looked up by name.
+    writeMembers(/*parentID=*/0, proto->getMembers(), true);
     writeDefaultWitnessTable(proto, DeclTypeAbbrCodes);
     break;
   }
@@ -3431,6 +3564,31 @@ static void writeDeclTable(const index_block::DeclListLayout &DeclList,
   DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
+/// Writes the in-memory table of members by parent and name to an on-disk
+/// representation.
+static void writeDeclMemberTable(const index_block::DeclListLayout &DeclList,
+                                 const Serializer::DeclMemberTable &table) {
+  if (table.empty())
+    return;
+
+  SmallVector<uint64_t, 8> scratch;
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::OnDiskChainedHashTableGenerator<DeclMemberTableInfo> generator;
+    for (auto &entry : table)
+      generator.insert(entry.first, entry.second);
+
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  DeclList.emit(scratch, index_block::DECL_MEMBER_NAMES, tableOffset,
+                hashTableBlob);
+}
+
 static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
                                 index_block::RecordKind kind,
                                 LocalTypeHashTableGenerator &generator) {
@@ -4057,6 +4215,7 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
     writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
     writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
+    writeDeclMemberTable(DeclList, DeclMembersByName);
     if (hasLocalTypes)
       writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
                           localTypeGenerator);
@@ -4097,7 +4256,7 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
 
   {
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
-    S.writeHeader(options);
+    S.writeHeader(options, SILMod);
     S.writeInputBlock(options);
     S.writeSIL(SILMod, options.SerializeAllSIL);
     S.writeAST(DC);
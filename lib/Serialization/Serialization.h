@@ -113,6 +113,12 @@ public:
   /// table.
   using DeclTable = llvm::MapVector<Identifier, DeclTableData>;
 
+  using DeclMemberTableData = SmallVector<DeclID, 2>;
+  /// The in-memory representation of the on-disk table of members by
+  /// containing decl and name.
+  using DeclMemberTable =
+      llvm::MapVector<std::pair<unsigned, Identifier>, DeclMemberTableData>;
+
   /// Returns the declaration the given generic parameter list is associated
   /// with.
   const Decl *getGenericContext(const GenericParamList *paramList);
@@ -129,6 +135,12 @@ private:
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// A map from nominal types and extensions, and names, to the members of
+  /// the type or extension with the given name.
+  ///
+  /// This is used to deserialize only the members a lookup asks for.
+  DeclMemberTable DeclMembersByName;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -227,7 +239,11 @@ private:
 
   /// Writes the Swift module file header and name, plus metadata determining
   /// if the module can be loaded.
-  void writeHeader(const SerializationOptions &options = {});
+  ///
+  /// If \p SILMod is given, the interface hash covers the SIL function
+  /// bodies that will be serialized.
+  void writeHeader(const SerializationOptions &options = {},
+                   const SILModule *SILMod = nullptr);
 
   /// Writes the Swift doc module file header and name.
   void writeDocHeader();
@@ -254,10 +270,12 @@ private:
 
   /// Writes an array of members for a decl context.
   ///
+  /// \param parentID The ID of the nominal type or extension, if its members
+  ///        should be recorded in the table of members by name, or 0.
   /// \param members The decls within the context
   /// \param isClass True if the context could be a class context (class,
   ///        class extension, or protocol).
-  void writeMembers(DeclRange members, bool isClass);
+  void writeMembers(DeclID parentID, DeclRange members, bool isClass);
 
   /// Write a default witness table for a protocol.
   ///
@@ -156,6 +156,12 @@ namespace {
     std::vector<BitOffset> DefaultWitnessTableOffset;
     uint32_t /*DeclID*/ NextDefaultWitnessTableID = 1;
 
+    /// Maps function name to the ID of its side-effects summary.
+    Table EffectsSummaryList;
+    /// Holds the list of side-effects summaries.
+    std::vector<BitOffset> EffectsSummaryOffset;
+    uint32_t /*DeclID*/ NextEffectsSummaryID = 1;
+
     /// Give each SILBasicBlock a unique ID.
     llvm::DenseMap<const SILBasicBlock *, unsigned> BasicBlockMap;
 
@@ -197,6 +203,7 @@ namespace {
     void writeSILGlobalVar(const SILGlobalVariable &g);
     void writeSILWitnessTable(const SILWitnessTable &wt);
     void writeSILDefaultWitnessTable(const SILDefaultWitnessTable &wt);
+    void writeSILFunctionEffects(const SILFunction &F);
 
     void writeSILBlock(const SILModule *SILMod);
     void writeIndexTables();
@@ -1559,9 +1566,10 @@ static void writeIndexTable(const sil_index_block::ListLayout &List,
           kind == sil_index_block::SIL_VTABLE_NAMES ||
           kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
           kind == sil_index_block::SIL_WITNESS_TABLE_NAMES ||
-          kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES) &&
-         "SIL function table, global, vtable and (default) witness table "
-         "are supported");
+          kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES ||
+          kind == sil_index_block::SIL_FUNC_EFFECTS_NAMES) &&
+         "SIL function table, global, vtable, (default) witness table and "
+         "function effects are supported");
   llvm::SmallString<4096> hashTableBlob;
   uint32_t tableOffset;
   {
@@ -1614,6 +1622,13 @@ void SILSerializer::writeIndexTables() {
                 sil_index_block::SIL_DEFAULT_WITNESS_TABLE_OFFSETS,
                 DefaultWitnessTableOffset);
   }
+
+  if (!EffectsSummaryList.empty()) {
+    writeIndexTable(List, sil_index_block::SIL_FUNC_EFFECTS_NAMES,
+                    EffectsSummaryList);
+    Offset.emit(ScratchRecord, sil_index_block::SIL_FUNC_EFFECTS_OFFSETS,
+                EffectsSummaryOffset);
+  }
 }
 
 void SILSerializer::writeSILGlobalVar(const SILGlobalVariable &g) {
@@ -1748,6 +1763,17 @@ writeSILDefaultWitnessTable(const SILDefaultWitnessTable &wt) {
   }
 }
 
+void SILSerializer::writeSILFunctionEffects(const SILFunction &F) {
+  const SILFunctionEffectsSummary &Summary = *F.getEffectsSummary();
+
+  EffectsSummaryList[Ctx.getIdentifier(F.getName())] = NextEffectsSummaryID++;
+  EffectsSummaryOffset.push_back(Out.GetCurrentBitNo());
+
+  SILFunctionEffectsLayout::emitRecord(Out, ScratchRecord,
+      SILAbbrCodes[SILFunctionEffectsLayout::Code],
+      Summary.GlobalEffects, Summary.ArgumentEffects);
+}
+
 /// Helper function for whether to emit a function body.
 bool SILSerializer::shouldEmitFunctionBody(const SILFunction *F) {
   // If we are asked to serialize everything, go ahead and do it.
@@ -1796,6 +1822,7 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
   registerSILAbbr<SILInstCastLayout>();
   registerSILAbbr<SILInstWitnessMethodLayout>();
   registerSILAbbr<SILSpecializeAttrLayout>();
+  registerSILAbbr<SILFunctionEffectsLayout>();
 
   // Register the abbreviation codes so these layouts can exist in both
   // decl blocks and sil blocks.
@@ -1860,6 +1887,13 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
       if (!hasPublicVisibility(F.getLinkage()) ||
           !isWhitelistedSpecialization(F.getName()))
         continue;
+    } else if (F.isKeepAsPublic() && F.getLinkage() == SILLinkage::Public &&
+               !shouldEmitFunctionBody(&F)) {
+      // Specializations exported with -enable-specialization-sharing or
+      // -prespecialize-list are only looked up by other modules to refer to
+      // them, which needs just a declaration.
+      addReferencedSILFunction(&F, /*DeclOnly=*/true);
+      continue;
     }
 
     addMandatorySILFunction(&F, emitDeclarationsForOnoneSupport);
@@ -1878,6 +1912,14 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
     }
   }
 
+  // Write out the side-effects summarized for clients of the module. They are
+  // looked up by name, regardless of whether anything else about the function
+  // was serialized.
+  for (const SILFunction &F : *SILMod) {
+    if (F.getEffectsSummary() && F.getLinkage() == SILLinkage::Public)
+      writeSILFunctionEffects(F);
+  }
+
   assert(Worklist.empty() && "Did not emit everything in worklist");
 }
 
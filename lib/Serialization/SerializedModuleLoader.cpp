@@ -19,6 +19,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
@@ -26,6 +27,10 @@
 
 using namespace swift;
 
+#define DEBUG_TYPE "Serialization"
+STATISTIC(NumModuleBytesMapped, "# of module file bytes memory-mapped");
+STATISTIC(NumModuleBytesCopied, "# of module file bytes read into memory");
+
 namespace {
 typedef std::pair<Identifier, SourceLoc> AccessPathElem;
 } // end unnamed namespace
@@ -36,6 +41,28 @@ SerializedModuleLoader::SerializedModuleLoader(ASTContext &ctx,
   : ModuleLoader(tracker), Ctx(ctx) {}
 SerializedModuleLoader::~SerializedModuleLoader() = default;
 
+/// Opens a serialized module or module documentation file.
+///
+/// The bitstream reader never needs a trailing null byte, so don't ask for
+/// one; that lets MemoryBuffer map the file read-only instead of copying it,
+/// so the on-disk tables in the module point directly into the page cache
+/// shared by every frontend job reading the same module. (MemoryBuffer still
+/// reads very small files into memory, where mapping isn't profitable.)
+static llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+openModuleBuffer(StringRef path) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                                 /*RequiresNullTerminator=*/
+                                                 false);
+  if (bufferOrErr) {
+    const llvm::MemoryBuffer &buffer = *bufferOrErr.get();
+    if (buffer.getBufferKind() == llvm::MemoryBuffer::MemoryBuffer_MMap)
+      NumModuleBytesMapped += buffer.getBufferSize();
+    else
+      NumModuleBytesCopied += buffer.getBufferSize();
+  }
+  return bufferOrErr;
+}
+
 static std::error_code
 openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 StringRef ModuleDocFilename,
@@ -47,7 +74,7 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    openModuleBuffer(StringRef(Scratch.data(), Scratch.size()));
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +83,7 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    openModuleBuffer(StringRef(Scratch.data(), Scratch.size()));
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -143,32 +170,51 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
                          moduleBuffer, moduleDocBuffer, scratch);
 }
 
-FileUnit *SerializedModuleLoader::loadAST(
-    Module &M, Optional<SourceLoc> diagLoc,
+SerializedModuleLoader::PreparedAST::PreparedAST() = default;
+SerializedModuleLoader::PreparedAST::PreparedAST(PreparedAST &&) = default;
+SerializedModuleLoader::PreparedAST::~PreparedAST() = default;
+
+SerializedModuleLoader::PreparedAST SerializedModuleLoader::prepareAST(
     std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
     std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
     bool isFramework) {
   assert(moduleInputBuffer);
 
-  const char *moduleBufferID = moduleInputBuffer->getBufferIdentifier();
-  const char *moduleDocBufferID = nullptr;
+  PreparedAST result;
+  result.ModuleBufferID = moduleInputBuffer->getBufferIdentifier();
   if (moduleDocInputBuffer)
-    moduleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
+    result.ModuleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
 
   if (moduleInputBuffer->getBufferSize() % 4 != 0) {
-    if (diagLoc)
-      Ctx.Diags.diagnose(*diagLoc, diag::serialization_malformed_module,
-                         moduleBufferID);
-    return nullptr;
+    result.LoadInfo.status = serialization::Status::Malformed;
+    return result;
   }
 
-  serialization::ExtendedValidationInfo extendedInfo;
-  std::unique_ptr<ModuleFile> loadedModuleFile;
-  serialization::ValidationInfo loadInfo =
-      ModuleFile::load(std::move(moduleInputBuffer),
-                       std::move(moduleDocInputBuffer),
-                       isFramework, loadedModuleFile,
-                       &extendedInfo);
+  result.LoadInfo = ModuleFile::load(std::move(moduleInputBuffer),
+                                     std::move(moduleDocInputBuffer),
+                                     isFramework, result.File,
+                                     &result.ExtendedInfo);
+  return result;
+}
+
+FileUnit *SerializedModuleLoader::loadAST(
+    Module &M, Optional<SourceLoc> diagLoc,
+    std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
+    std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
+    bool isFramework) {
+  return loadAST(M, diagLoc, prepareAST(std::move(moduleInputBuffer),
+                                        std::move(moduleDocInputBuffer),
+                                        isFramework));
+}
+
+FileUnit *SerializedModuleLoader::loadAST(Module &M,
+                                          Optional<SourceLoc> diagLoc,
+                                          PreparedAST prepared) {
+  StringRef moduleBufferID = prepared.ModuleBufferID;
+  StringRef moduleDocBufferID = prepared.ModuleDocBufferID;
+  serialization::ExtendedValidationInfo &extendedInfo = prepared.ExtendedInfo;
+  std::unique_ptr<ModuleFile> &loadedModuleFile = prepared.File;
+  serialization::ValidationInfo &loadInfo = prepared.LoadInfo;
   if (loadInfo.status == serialization::Status::Valid) {
     Ctx.bumpGeneration();
 
@@ -236,9 +282,9 @@ FileUnit *SerializedModuleLoader::loadAST(
     break;
 
   case serialization::Status::MalformedDocumentation:
-    assert(moduleDocBufferID);
+    assert(!moduleDocBufferID.empty());
     Ctx.Diags.diagnose(*diagLoc, diag::serialization_malformed_module,
-                       moduleDocBufferID ? moduleDocBufferID : "");
+                       moduleDocBufferID);
     break;
 
   case serialization::Status::MissingDependency: {
@@ -139,6 +139,14 @@ lookupDefaultWitnessTable(SILDefaultWitnessTable *WT) {
   return nullptr;
 }
 
+bool SerializedSILLoader::
+lookupEffectsSummary(StringRef Name, SILFunctionEffectsSummary &Summary) {
+  for (auto &Des : LoadedSILSections)
+    if (Des->lookupEffectsSummary(Name, Summary))
+      return true;
+  return false;
+}
+
 void SerializedSILLoader::invalidateCaches() {
   for (auto &Des : LoadedSILSections)
     Des->invalidateFunctionCache();
@@ -387,9 +387,29 @@ const RecordTypeInfo *RecordTypeInfoBuilder::build() {
   if (Invalid)
     return nullptr;
 
-  return TC.makeTypeInfo<RecordTypeInfo>(
-      Size, Alignment, Stride,
-      NumExtraInhabitants, Kind, Fields);
+  return TC.getRecordTypeInfo(Size, Alignment, Stride,
+                              NumExtraInhabitants, Kind, Fields);
+}
+
+const RecordTypeInfo *
+TypeConverter::getRecordTypeInfo(unsigned Size, unsigned Alignment,
+                                 unsigned Stride, unsigned NumExtraInhabitants,
+                                 RecordKind Kind,
+                                 const std::vector<FieldInfo> &Fields) {
+  std::vector<RecordFieldKey> FieldKeys;
+  for (auto &Field : Fields)
+    FieldKeys.emplace_back(Field.Name, Field.Offset, Field.TR, &Field.TI);
+  RecordKey Key(Size, Alignment, Stride, NumExtraInhabitants, unsigned(Kind),
+                std::move(FieldKeys));
+
+  auto found = RecordCache.find(Key);
+  if (found != RecordCache.end())
+    return found->second;
+
+  auto TI = makeTypeInfo<RecordTypeInfo>(Size, Alignment, Stride,
+                                         NumExtraInhabitants, Kind, Fields);
+  RecordCache.insert({std::move(Key), TI});
+  return TI;
 }
 
 const ReferenceTypeInfo *
@@ -1007,9 +1027,37 @@ const TypeInfo *TypeConverter::getTypeInfo(const TypeRef *TR) {
   return TI;
 }
 
+std::vector<const TypeInfo *>
+TypeConverter::getTypeInfos(const std::vector<const TypeRef *> &TRs) {
+  std::vector<const TypeInfo *> TIs;
+  TIs.reserve(TRs.size());
+  // Failed lowerings aren't in Cache, so remember every type seen here.
+  llvm::DenseMap<const TypeRef *, const TypeInfo *> Seen;
+  for (auto TR : TRs) {
+    auto found = Seen.find(TR);
+    if (found == Seen.end())
+      found = Seen.insert({TR, getTypeInfo(TR)}).first;
+    TIs.push_back(found->second);
+  }
+  return TIs;
+}
+
 const TypeInfo *TypeConverter::getClassInstanceTypeInfo(const TypeRef *TR,
                                                         unsigned start,
                                                         unsigned align) {
+  auto key = std::make_pair(TR, std::make_pair(start, align));
+  auto found = ClassInstanceCache.find(key);
+  if (found != ClassInstanceCache.end())
+    return found->second;
+
+  auto TI = lowerClassInstance(TR, start, align);
+  ClassInstanceCache[key] = TI;
+  return TI;
+}
+
+const TypeInfo *TypeConverter::lowerClassInstance(const TypeRef *TR,
+                                                  unsigned start,
+                                                  unsigned align) {
   const FieldDescriptor *FD = getBuilder().getFieldTypeInfo(TR);
   if (FD == nullptr)
     return nullptr;
@@ -28,26 +28,60 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::indexReflectionInfos() {
+  for (; NumIndexedReflectionInfos < ReflectionInfos.size();
+       ++NumIndexedReflectionInfos) {
+    auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    // Earlier images win if a type is described more than once, as they
+    // did when every lookup scanned the sections in order.
+    for (auto &FD : Info.fieldmd) {
+      if (FD.hasMangledTypeName())
+        FieldTypeInfoIndex.insert({FD.getMangledTypeName(), &FD});
+    }
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (BuiltinTypeDescriptor.hasMangledTypeName())
+        BuiltinTypeInfoIndex.insert({BuiltinTypeDescriptor.getMangledTypeName(),
+                                     &BuiltinTypeDescriptor});
+    }
+    for (auto &AssocTyDescriptor : Info.assocty) {
+      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
+      AssociatedTypeIndex[ConformingTypeName].push_back(&AssocTyDescriptor);
+    }
+  }
+}
+
+const TypeRef *
+TypeRefBuilder::decodeMangledTypeName(const std::string &MangledName) {
+  auto found = DecodedTypeRefs.find(MangledName);
+  if (found != DecodedTypeRefs.end())
+    return found->second;
+
+  auto Demangled = Demangle::demangleTypeAsNode(MangledName);
+  auto TR = swift::remote::decodeMangledType(*this, Demangled);
+  DecodedTypeRefs.insert({MangledName, TR});
+  return TR;
+}
+
 const AssociatedTypeDescriptor * TypeRefBuilder::
 lookupAssociatedTypes(const std::string &MangledTypeName,
                       const DependentMemberTypeRef *DependentMember) {
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
+  indexReflectionInfos();
+  auto found = AssociatedTypeIndex.find(MangledTypeName);
+  if (found == AssociatedTypeIndex.end())
+    return nullptr;
+
+  auto &Conformance = *DependentMember->getProtocol();
+  for (auto AssocTyDescriptor : found->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    auto TR = decodeMangledTypeName(ProtocolMangledName);
+    if (auto Protocol = dyn_cast_or_null<ProtocolTypeRef>(TR)) {
+      if (*Protocol != Conformance)
         continue;
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
-
-      auto &Conformance = *DependentMember->getProtocol();
-      if (auto Protocol = dyn_cast<ProtocolTypeRef>(TR)) {
-        if (*Protocol != Conformance)
-          continue;
-        return &AssocTyDescriptor;
-      }
+      return AssocTyDescriptor;
     }
   }
   return nullptr;
@@ -63,8 +97,7 @@ getDependentMemberTypeRef(const std::string &MangledTypeName,
         continue;
 
       auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
-      return swift::remote::decodeMangledType(*this, Demangled);
+      return decodeMangledTypeName(SubstitutedTypeName);
     }
   }
   return nullptr;
@@ -82,19 +115,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto found = FieldTypeInfoIndex.find(MangledName);
+  if (found == FieldTypeInfoIndex.end())
+    return nullptr;
+  return found->second;
 }
 
 std::vector<std::pair<std::string, const TypeRef *>> TypeRefBuilder::
@@ -115,9 +140,7 @@ getFieldTypeRefs(const TypeRef *TR, const FieldDescriptor *FD) {
       continue;
     }
 
-    auto Demangled
-      = Demangle::demangleTypeAsNode(Field.getMangledTypeName());
-    auto Unsubstituted = swift::remote::decodeMangledType(*this, Demangled);
+    auto Unsubstituted = decodeMangledTypeName(Field.getMangledTypeName());
     if (!Unsubstituted)
       return {};
 
@@ -137,21 +160,11 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto found = BuiltinTypeInfoIndex.find(MangledName);
+  if (found == BuiltinTypeInfoIndex.end())
+    return nullptr;
+  return found->second;
 }
 
 const CaptureDescriptor *
@@ -177,9 +190,7 @@ TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
   for (auto i = CD.capture_begin(), e = CD.capture_end(); i != e; ++i) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
-      auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
-      TR = swift::remote::decodeMangledType(*this, DemangleTree);
+      TR = decodeMangledTypeName(i->getMangledTypeName());
     }
     Info.CaptureTypes.push_back(TR);
   }
@@ -187,9 +198,7 @@ TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
   for (auto i = CD.source_begin(), e = CD.source_end(); i != e; ++i) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
-      auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
-      TR = swift::remote::decodeMangledType(*this, DemangleTree);
+      TR = decodeMangledTypeName(i->getMangledTypeName());
     }
 
     const MetadataSource *MS = nullptr;
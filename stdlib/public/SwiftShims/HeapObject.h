@@ -30,9 +30,16 @@ typedef struct HeapMetadata HeapMetadata;
 
 // The members of the HeapObject header that are not shared by a
 // standard Objective-C instance
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+#define SWIFT_HEAPOBJECT_NON_OBJC_MEMBERS       \
+  StrongRefCount refCount;                      \
+  WeakRefCount weakRefCount;                    \
+  BiasedRefCount biasedRefCount
+#else
 #define SWIFT_HEAPOBJECT_NON_OBJC_MEMBERS       \
   StrongRefCount refCount;                      \
   WeakRefCount weakRefCount
+#endif
 
 /// The Swift heap-object header.
 struct HeapObject {
@@ -50,6 +57,9 @@ struct HeapObject {
     : metadata(newMetadata)
     , refCount(StrongRefCount::Initialized)
     , weakRefCount(WeakRefCount::Initialized)
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    , biasedRefCount(BiasedRefCount::Initialized)
+#endif
   { }
 #endif
 };
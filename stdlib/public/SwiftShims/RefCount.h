@@ -27,6 +27,13 @@ typedef struct {
   __swift_uint32_t weakRefCount __attribute__((__unavailable__));
 } WeakRefCount;
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+typedef struct {
+  __swift_uint32_t owner __attribute__((__unavailable__));
+  __swift_int32_t biasedRefCount __attribute__((__unavailable__));
+} BiasedRefCount;
+#endif
+
 // not __cplusplus
 #else
 // __cplusplus
@@ -56,19 +63,39 @@ class StrongRefCount {
   // The next bit is the deallocating marker.
   // The remaining bits are the reference count.
   // refCount == RC_ONE means reference count == 1.
+  //
+  // With biased reference counting, two more flags follow the deallocating
+  // marker. While the biased marker is set, the count is only the shared
+  // part of the object's reference count; the rest is kept non-atomically
+  // by the owning thread in the object's BiasedRefCount, and the shared
+  // part may be negative. The queued marker is set once the shared part
+  // has gone negative and the object has been handed to its owner to merge.
   enum : uint32_t {
     RC_PINNED_FLAG = 0x1,
     RC_DEALLOCATING_FLAG = 0x2,
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    RC_BIASED_FLAG = 0x4,
+    RC_QUEUED_FLAG = 0x8,
+
+    RC_FLAGS_COUNT = 4,
+    RC_FLAGS_MASK = 15,
+#else
     RC_FLAGS_COUNT = 2,
     RC_FLAGS_MASK = 3,
+#endif
     RC_COUNT_MASK = ~RC_FLAGS_MASK,
 
     RC_ONE = RC_FLAGS_MASK + 1
   };
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  static_assert(RC_ONE == RC_QUEUED_FLAG << 1,
+                "queued bit must be adjacent to refcount bits");
+#else
   static_assert(RC_ONE == RC_DEALLOCATING_FLAG << 1,
                 "deallocating bit must be adjacent to refcount bits");
+#endif
   static_assert(RC_ONE == 1 << RC_FLAGS_COUNT,
                 "inconsistent refcount flags");
   static_assert(RC_ONE == 1 + RC_FLAGS_MASK,
@@ -237,6 +264,108 @@ class StrongRefCount {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_DEALLOCATING_FLAG;
   }
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  enum class SharedDecrementResult {
+    /// Nothing more to do.
+    Done,
+    /// The caller should deallocate the object.
+    Deallocate,
+    /// The shared count of a biased object went negative for the first
+    /// time. The caller should queue the object for its owner to merge.
+    Queue
+  };
+
+  // Mark a new object as biased towards the thread that allocated it.
+  // The owner holds the object's one reference, so the shared count is 0.
+  void initBiased() {
+    refCount = RC_BIASED_FLAG;
+  }
+
+  // Return true if part of the reference count is held by an owning thread.
+  // An object's reference count is never re-biased once merged.
+  bool isBiased() const {
+    return __atomic_load_n(&refCount, __ATOMIC_ACQUIRE) & RC_BIASED_FLAG;
+  }
+
+  bool isPinned() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_PINNED_FLAG;
+  }
+
+  // Return the (possibly negative) shared part of the reference count.
+  int32_t getSharedCount() const {
+    return int32_t(__atomic_load_n(&refCount, __ATOMIC_RELAXED))
+             >> RC_FLAGS_COUNT;
+  }
+
+  // Decrement the shared reference count by n on behalf of a thread that
+  // doesn't own the object.
+  template <bool ClearPinnedFlag>
+  SharedDecrementResult decrementShared(uint32_t n) {
+    uint32_t delta = (n << RC_FLAGS_COUNT) +
+                     (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    while (true) {
+      uint32_t newval = oldval - delta;
+      auto result = SharedDecrementResult::Done;
+
+      if (oldval & RC_BIASED_FLAG) {
+        // The owner's part keeps the object alive. Hand it over only the
+        // first time the shared part goes negative.
+        if (int32_t(newval) < 0 && !(oldval & RC_QUEUED_FLAG)) {
+          newval |= RC_QUEUED_FLAG;
+          result = SharedDecrementResult::Queue;
+        }
+      } else if ((newval & (RC_COUNT_MASK | RC_PINNED_FLAG |
+                            RC_DEALLOCATING_FLAG)) == 0) {
+        newval = RC_DEALLOCATING_FLAG;
+        result = SharedDecrementResult::Deallocate;
+      }
+
+      if (__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                    result == SharedDecrementResult::Deallocate
+                                      ? __ATOMIC_ACQ_REL : __ATOMIC_RELEASE,
+                                    __ATOMIC_RELAXED))
+        return result;
+    }
+  }
+
+  // Fold the owner's part of the reference count into the shared count and
+  // clear the biased marker.
+  //
+  // Unless Force is set, a queued object is left biased, since the thread
+  // that queued it still refers to it; merging happens when the owner
+  // drains its queue.
+  //
+  // Returns true if the caller should now deallocate the object.
+  template <bool Force>
+  bool mergeBiased(int32_t biased, bool &merged) {
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    while (true) {
+      assert((oldval & RC_BIASED_FLAG) && "merging an unbiased object");
+      if (!Force && (oldval & RC_QUEUED_FLAG)) {
+        merged = false;
+        return false;
+      }
+
+      int32_t count = (int32_t(oldval) >> RC_FLAGS_COUNT) + biased;
+      assert(count >= 0 && "merged reference count is negative");
+      uint32_t newval = (oldval & (RC_PINNED_FLAG | RC_DEALLOCATING_FLAG))
+                        | (uint32_t(count) << RC_FLAGS_COUNT);
+      bool shouldDeallocate =
+        (newval & (RC_COUNT_MASK | RC_PINNED_FLAG | RC_DEALLOCATING_FLAG))
+          == 0;
+      if (shouldDeallocate)
+        newval = RC_DEALLOCATING_FLAG;
+
+      if (__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        merged = true;
+        return shouldDeallocate;
+      }
+    }
+  }
+#endif
+
 private:
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocate() {
@@ -267,7 +396,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 2 || RC_FLAGS_COUNT == 4,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -307,7 +436,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 2 || RC_FLAGS_COUNT == 4,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -343,7 +472,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 2 || RC_FLAGS_COUNT == 4,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -382,7 +511,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 2 || RC_FLAGS_COUNT == 4,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -398,8 +527,8 @@ class WeakRefCount {
   uint32_t refCount;
 
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    // Set once a weak reference to the object has created its side table.
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -472,12 +601,98 @@ class WeakRefCount {
   }
 
   // Return weak reference count.
-  // Note that this is not equal to the number of outstanding weak pointers.
+  // Note that this does not include weak pointers, which are counted by the
+  // object's side table.
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
+
+  // Record that the object has a weak reference side table.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  // Return true if a weak reference side table has been created for the
+  // object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
+};
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+// The part of a strong reference count kept by the thread that owns an
+// object.
+//
+// Only the owning thread reads or writes the count, so it is updated without
+// atomic read-modify-write operations; see StrongRefCount for the shared
+// part. The count may go negative when the owner releases a reference that
+// was retained through the shared count.
+
+class BiasedRefCount {
+  uint32_t owner;
+  int32_t refCount;
+
+ public:
+  enum Initialized_t { Initialized };
+
+  // BiasedRefCount must be trivially constructible to avoid ObjC++
+  // destruction overhead at runtime. Use BiasedRefCount(Initialized) to
+  // produce an initialized instance, which has no owner.
+  BiasedRefCount() = default;
+
+  constexpr BiasedRefCount(Initialized_t)
+    : owner(0), refCount(0) { }
+
+  void init() {
+    owner = 0;
+    refCount = 0;
+  }
+
+  // Give the object's one reference to the thread with the given tag.
+  void initOwned(uint32_t ownerTag) {
+    owner = ownerTag;
+    refCount = 1;
+  }
+
+  // Return the tag of the owning thread, or 0 if the object has none.
+  uint32_t getOwner() const {
+    return __atomic_load_n(&owner, __ATOMIC_RELAXED);
+  }
+
+  void clearOwner() {
+    __atomic_store_n(&owner, 0, __ATOMIC_RELAXED);
+  }
+
+  void increment(uint32_t n) {
+    int32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    __atomic_store_n(&refCount, val + int32_t(n), __ATOMIC_RELAXED);
+  }
+
+  // Decrement the count and return the new value.
+  int32_t decrement(uint32_t n) {
+    int32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED) - int32_t(n);
+    __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
+    return val;
+  }
+
+  int32_t getCount() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+  }
+
+  // Reset the count to zero and return the old value.
+  int32_t take() {
+    int32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    __atomic_store_n(&refCount, 0, __ATOMIC_RELAXED);
+    return val;
+  }
 };
 
+static_assert(swift::IsTriviallyConstructible<BiasedRefCount>::value,
+              "BiasedRefCount must be trivially initializable");
+static_assert(std::is_trivially_destructible<BiasedRefCount>::value,
+              "BiasedRefCount must be trivially destructible");
+#endif
+
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
               "StrongRefCount must be trivially initializable");
 static_assert(swift::IsTriviallyConstructible<WeakRefCount>::value,
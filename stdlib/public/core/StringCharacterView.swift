@@ -198,6 +198,21 @@ extension String.CharacterView : BidirectionalCollection {
       }
 
       let startIndexUTF16 = start._position
+
+      // Fast path: there is a grapheme cluster boundary between any two
+      // ASCII scalars except CR-LF.
+      let core = start._core
+      let cu0 = core[startIndexUTF16]
+      if _fastPath(cu0 < 0x80) {
+        if startIndexUTF16 + 1 == end._position {
+          return 1
+        }
+        let cu1 = core[startIndexUTF16 + 1]
+        if _fastPath(cu1 < 0x80) && !(cu0 == 0x0d && cu1 == 0x0a) {
+          return 1
+        }
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
@@ -238,6 +253,21 @@ extension String.CharacterView : BidirectionalCollection {
       }
 
       let endIndexUTF16 = end._position
+
+      // Fast path: there is a grapheme cluster boundary between any two
+      // ASCII scalars except CR-LF.
+      let core = end._core
+      let cu1 = core[endIndexUTF16 - 1]
+      if _fastPath(cu1 < 0x80) {
+        if endIndexUTF16 - 1 == start._position {
+          return 1
+        }
+        let cu0 = core[endIndexUTF16 - 2]
+        if _fastPath(cu0 < 0x80) && !(cu0 == 0x0d && cu1 == 0x0a) {
+          return 1
+        }
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
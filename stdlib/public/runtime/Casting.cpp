@@ -18,13 +18,12 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PointerIntPair.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
@@ -318,54 +317,70 @@ std::string swift::nameForMetadata(const Metadata *type,
   return result;
 }
 
+namespace {
+  struct TypeNameCacheKey {
+    const Metadata *Type;
+    bool Qualified;
+  };
+
+  /// A cached type name. The null-terminated name is tail-allocated, so it
+  /// lives as long as the cache and can be handed out directly.
+  struct TypeNameCacheEntry {
+  private:
+    const Metadata *Type;
+    bool Qualified;
+    size_t Length;
+
+    char *getNameBuffer() { return reinterpret_cast<char *>(this + 1); }
+
+  public:
+    TypeNameCacheEntry(TypeNameCacheKey key, llvm::StringRef name)
+      : Type(key.Type), Qualified(key.Qualified), Length(name.size()) {
+      memcpy(getNameBuffer(), name.data(), Length);
+      getNameBuffer()[Length] = 0;
+    }
+
+    int compareWithKey(TypeNameCacheKey key) const {
+      if (key.Type != Type)
+        return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
+      if (key.Qualified != Qualified)
+        return (int(key.Qualified) < int(Qualified) ? -1 : 1);
+      return 0;
+    }
+
+    static size_t getExtraAllocationSize(TypeNameCacheKey key,
+                                         llvm::StringRef name) {
+      return name.size() + 1;
+    }
+
+    const char *getName() const {
+      return reinterpret_cast<const char *>(this + 1);
+    }
+    size_t getLength() const { return Length; }
+  };
+}
+
+/// The names returned by swift_getTypeName. The map is insert-only, so
+/// lookups take no lock.
+static Lazy<ConcurrentMap<TypeNameCacheEntry>> TypeNameCache;
+
 SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
 extern "C"
 TwoWordPair<const char *, uintptr_t>::Return
 swift_getTypeName(const Metadata *type, bool qualified) {
   using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
 
-  static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
+  TypeNameCacheKey key{type, qualified};
   auto &cache = TypeNameCache.get();
 
-  // Attempt read-only lookup of cache entry.
-  {
-    StaticScopedReadLock guard(TypeNameCacheLock);
-
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
-  }
-
-  // Read-only lookup failed to find item, we may need to create it.
-  {
-    StaticScopedWriteLock guard(TypeNameCacheLock);
-
-    // Do lookup again just to make sure it wasn't created by another
-    // thread before we acquired the write lock.
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
-
-    // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
-    // Copy it to memory we can reference forever.
-    auto size = name.size();
-    auto result = (char *)malloc(size + 1);
-    memcpy(result, name.data(), size);
-    result[size] = 0;
+  if (auto found = cache.find(key))
+    return Pair{found->getName(), found->getLength()};
 
-    cache.insert({key, {result, size}});
-    return Pair{result, size};
-  }
+  // Build the metadata name. If another thread races us to insert it,
+  // getOrInsert hands back the winner's entry and we discard ours.
+  auto name = nameForMetadata(type, qualified);
+  auto entry = cache.getOrInsert(key, llvm::StringRef(name)).first;
+  return Pair{entry->getName(), entry->getLength()};
 }
 
 /// Report a dynamic cast failure.
@@ -646,6 +661,136 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+namespace {
+  struct ExistentialCastCacheKey {
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+  };
+
+  /// A cached answer to whether a type conforms to all of the protocols of
+  /// an existential type, and if so, with which witness tables. The witness
+  /// tables are tail-allocated.
+  struct ExistentialCastCacheEntry {
+  private:
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+    bool Succeeded;
+    /// For failures, the conformance generation the failure was computed
+    /// under.
+    std::atomic<uintptr_t> FailureGeneration;
+
+    const WitnessTable **getWitnessTablesBuffer() {
+      return reinterpret_cast<const WitnessTable **>(this + 1);
+    }
+
+  public:
+    ExistentialCastCacheEntry(ExistentialCastCacheKey key,
+                              const WitnessTable * const *conformances,
+                              uintptr_t failureGeneration)
+      : SrcType(key.SrcType), TargetType(key.TargetType),
+        Succeeded(conformances != nullptr),
+        FailureGeneration(failureGeneration) {
+      if (conformances)
+        memcpy(getWitnessTablesBuffer(), conformances,
+               getNumWitnessTables(key) * sizeof(const WitnessTable *));
+    }
+
+    static unsigned getNumWitnessTables(ExistentialCastCacheKey key) {
+      return key.TargetType->Flags.getNumWitnessTables();
+    }
+
+    int compareWithKey(ExistentialCastCacheKey key) const {
+      if (key.SrcType != SrcType)
+        return (uintptr_t(key.SrcType) < uintptr_t(SrcType) ? -1 : 1);
+      if (key.TargetType != TargetType)
+        return (uintptr_t(key.TargetType) < uintptr_t(TargetType) ? -1 : 1);
+      return 0;
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(ExistentialCastCacheKey key,
+                                         Args &&... ignored) {
+      return getNumWitnessTables(key) * sizeof(const WitnessTable *);
+    }
+
+    bool isSucceeded() const { return Succeeded; }
+
+    const WitnessTable * const *getWitnessTables() const {
+      assert(Succeeded);
+      return reinterpret_cast<const WitnessTable * const *>(this + 1);
+    }
+
+    uintptr_t getFailureGeneration() const {
+      assert(!Succeeded);
+      return FailureGeneration.load(std::memory_order_relaxed);
+    }
+
+    void updateFailureGeneration(uintptr_t generation) {
+      assert(!Succeeded);
+      FailureGeneration.store(generation, std::memory_order_relaxed);
+    }
+  };
+}
+
+/// Results of conformance checks for casts to existential types, keyed by
+/// the dynamic source type and the target existential type.
+static Lazy<ConcurrentMap<ExistentialCastCacheEntry>> ExistentialCastCache;
+
+/// Can the result of checking conformance of any value of a type to the
+/// protocols of an existential be cached for the type?
+///
+/// Conformances to Objective-C protocols are checked against the value's
+/// actual class, which isn't determined by its static metadata.
+static bool canCacheExistentialConformances(
+                                      const ExistentialTypeMetadata *target) {
+  for (unsigned i = 0, n = target->Protocols.NumProtocols; i != n; ++i) {
+    auto protocol = target->Protocols[i];
+    if (!protocol->Flags.needsWitnessTable() &&
+        protocol->Flags.getSpecialProtocol() != SpecialProtocol::AnyObject)
+      return false;
+  }
+  return true;
+}
+
+/// Check whether a type conforms to the protocols of an existential type,
+/// filling in a list of conformances, and remember the result so that
+/// repeated casts between the same types skip the conformance lookups.
+static bool _conformsToExistentialProtocols(
+                                     const OpaqueValue *value,
+                                     const Metadata *type,
+                                     const ExistentialTypeMetadata *target,
+                                     const WitnessTable **conformances) {
+  if (!canCacheExistentialConformances(target))
+    return _conformsToProtocols(value, type, target->Protocols, conformances);
+
+  ExistentialCastCacheKey key{type, target};
+  auto &cache = ExistentialCastCache.get();
+  if (auto entry = cache.find(key)) {
+    if (entry->isSucceeded()) {
+      memcpy(conformances, entry->getWitnessTables(),
+             ExistentialCastCacheEntry::getNumWitnessTables(key)
+               * sizeof(const WitnessTable *));
+      return true;
+    }
+    if (entry->getFailureGeneration() == _getProtocolConformanceGeneration())
+      return false;
+  }
+
+  // Read the generation before checking, so that a concurrent image load
+  // makes the failure stale rather than being missed.
+  uintptr_t generation = _getProtocolConformanceGeneration();
+  if (_conformsToProtocols(value, type, target->Protocols, conformances)) {
+    cache.getOrInsert(key, conformances, uintptr_t(0));
+    return true;
+  }
+
+  auto result = cache.getOrInsert(key, (const WitnessTable * const *)nullptr,
+                                  generation);
+  if (!result.second && !result.first->isSucceeded())
+    result.first->updateFailureGeneration(generation);
+  return false;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -966,9 +1111,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     }
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables())) {
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables())) {
       return _fail(src, srcType, targetType, flags, srcDynamicType);
     }
 
@@ -985,9 +1130,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return _fail(src, srcType, targetType, flags, srcDynamicType);
 
     // Fill in the type and value.
@@ -1009,9 +1154,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // one we need.
     assert(targetType->Protocols.NumProtocols == 1);
     const WitnessTable *errorWitness;
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              &errorWitness))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         &errorWitness))
       return _fail(src, srcType, targetType, flags, srcDynamicType);
     
     BoxPair destBox = swift_allocError(srcDynamicType, errorWitness,
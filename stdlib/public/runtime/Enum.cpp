@@ -274,47 +274,6 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
 #endif
 }
 
-void
-swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
-                                     EnumMetadata *enumType,
-                                     unsigned numPayloads,
-                                     const TypeLayout * const *payloadLayouts) {
-  // Accumulate the layout requirements of the payloads.
-  size_t payloadSize = 0, alignMask = 0;
-  bool isPOD = true, isBT = true;
-  for (unsigned i = 0; i < numPayloads; ++i) {
-    const TypeLayout *payloadLayout = payloadLayouts[i];
-    payloadSize
-      = std::max(payloadSize, (size_t)payloadLayout->size);
-    alignMask |= payloadLayout->flags.getAlignmentMask();
-    isPOD &= payloadLayout->flags.isPOD();
-    isBT &= payloadLayout->flags.isBitwiseTakable();
-  }
-  
-  // Store the max payload size in the metadata.
-  assignUnlessEqual(enumType->getPayloadSize(), payloadSize);
-  
-  // The total size includes space for the tag.
-  unsigned totalSize = payloadSize + getNumTagBytes(payloadSize,
-                                enumType->Description->Enum.getNumEmptyCases(),
-                                numPayloads);
-  
-  // Set up the layout info in the vwtable.
-  vwtable->size = totalSize;
-  vwtable->flags = ValueWitnessFlags()
-    .withAlignmentMask(alignMask)
-    .withPOD(isPOD)
-    .withBitwiseTakable(isBT)
-    // TODO: Extra inhabitants
-    .withExtraInhabitants(false)
-    .withEnumWitnesses(true)
-    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
-    ;
-  vwtable->stride = (totalSize + alignMask) & ~alignMask;
-  
-  installCommonValueWitnesses(vwtable);
-}
-
 namespace {
 struct MultiPayloadLayout {
   size_t payloadSize;
@@ -328,16 +287,15 @@ static MultiPayloadLayout getMultiPayloadLayout(const EnumMetadata *enumType) {
   return {payloadSize, totalSize - payloadSize};
 }
 
-static void storeMultiPayloadTag(OpaqueValue *value,
-                                 MultiPayloadLayout layout,
+template <unsigned NumTagBytes>
+static void storeMultiPayloadTag(OpaqueValue *value, size_t payloadSize,
                                  unsigned tag) {
-  auto tagBytes = reinterpret_cast<char *>(value) + layout.payloadSize;
+  auto tagBytes = reinterpret_cast<char *>(value) + payloadSize;
 #if defined(__BIG_ENDIAN__)
-  small_memcpy(tagBytes,
-               reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               layout.numTagBytes);
+  small_memcpy<NumTagBytes>(tagBytes,
+                            reinterpret_cast<char *>(&tag) + 4 - NumTagBytes);
 #else
-  small_memcpy(tagBytes, &tag, layout.numTagBytes);
+  small_memcpy<NumTagBytes>(tagBytes, &tag);
 #endif
 }
 
@@ -361,16 +319,17 @@ static void storeMultiPayloadValue(OpaqueValue *value,
            layout.payloadSize - sizeof(payloadValue));
 }
 
+template <unsigned NumTagBytes>
 static unsigned loadMultiPayloadTag(const OpaqueValue *value,
-                                    MultiPayloadLayout layout) {
-  auto tagBytes = reinterpret_cast<const char *>(value) + layout.payloadSize;
+                                    size_t payloadSize) {
+  auto tagBytes = reinterpret_cast<const char *>(value) + payloadSize;
 
   unsigned tag = 0;
 #if defined(__BIG_ENDIAN__)
-  small_memcpy(reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               tagBytes, layout.numTagBytes);
+  small_memcpy<NumTagBytes>(reinterpret_cast<char *>(&tag) + 4 - NumTagBytes,
+                            tagBytes);
 #else
-  small_memcpy(&tag, tagBytes, layout.numTagBytes);
+  small_memcpy<NumTagBytes>(&tag, tagBytes);
 #endif
 
   return tag;
@@ -392,31 +351,224 @@ static unsigned loadMultiPayloadValue(const OpaqueValue *value,
   return payloadValue;
 }
 
+/// Store the tag for \p whichCase into a multi-payload enum whose tag area
+/// is \p NumTagBytes wide. \p LargePayload is true if the payload area is at
+/// least four bytes, so an empty case's index fits entirely in the payload.
+template <unsigned NumTagBytes, bool LargePayload>
+static void storeMultiPayloadCase(OpaqueValue *value, size_t payloadSize,
+                                  unsigned numPayloads, unsigned whichCase) {
+  if (whichCase < numPayloads) {
+    // For a payload case, store the tag after the payload area.
+    storeMultiPayloadTag<NumTagBytes>(value, payloadSize, whichCase);
+    return;
+  }
+
+  // For an empty case, factor out the parts that go in the payload and
+  // tag areas.
+  unsigned whichEmptyCase = whichCase - numPayloads;
+  if (LargePayload) {
+    storeMultiPayloadTag<NumTagBytes>(value, payloadSize, numPayloads);
+    auto bytes = reinterpret_cast<char *>(value);
+    small_memcpy<4>(bytes, &whichEmptyCase);
+    memset(bytes + 4, 0, payloadSize - 4);
+    return;
+  }
+
+  unsigned numPayloadBits = payloadSize * CHAR_BIT;
+  unsigned whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
+  unsigned whichPayloadValue =
+    whichEmptyCase & ((1U << numPayloadBits) - 1U);
+  storeMultiPayloadTag<NumTagBytes>(value, payloadSize, whichTag);
+  storeMultiPayloadValue(value, {payloadSize, NumTagBytes}, whichPayloadValue);
+}
+
+/// Load the case index of a multi-payload enum whose tag area is
+/// \p NumTagBytes wide. See storeMultiPayloadCase.
+template <unsigned NumTagBytes, bool LargePayload>
+static unsigned loadMultiPayloadCase(const OpaqueValue *value,
+                                     size_t payloadSize,
+                                     unsigned numPayloads) {
+  unsigned tag = loadMultiPayloadTag<NumTagBytes>(value, payloadSize);
+  if (tag < numPayloads) {
+    // If the tag indicates a payload, then we're done.
+    return tag;
+  }
+
+  // Otherwise, the other part of the discriminator is in the payload.
+  if (LargePayload) {
+    unsigned payloadValue;
+    small_memcpy<4>(&payloadValue, value);
+    return numPayloads + payloadValue;
+  }
+
+  unsigned payloadValue =
+    loadMultiPayloadValue(value, {payloadSize, NumTagBytes});
+  unsigned numPayloadBits = payloadSize * CHAR_BIT;
+  return (payloadValue | (tag - numPayloads) << numPayloadBits)
+         + numPayloads;
+}
+
+// Enum value witnesses for multi-payload enums laid out by the runtime,
+// specialized for the layout of the tag. They replace the witnesses emitted
+// by the compiler, which call back into swift_getEnumCaseMultiPayload and
+// swift_storeEnumTagMultiPayload and rediscover the layout every time.
+
+template <unsigned NumTagBytes, bool LargePayload>
+static int multiPayloadEnum_getEnumTag(const OpaqueValue *value,
+                                       const Metadata *self) {
+  auto enumType = static_cast<const EnumMetadata *>(self);
+  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+  unsigned whichCase = loadMultiPayloadCase<NumTagBytes, LargePayload>(
+                            value, enumType->getPayloadSize(), numPayloads);
+
+  // Convert fragile tag index into resilient tag index.
+  return int(whichCase) - int(numPayloads);
+}
+
+template <unsigned NumTagBytes, bool LargePayload>
+static void multiPayloadEnum_destructiveInjectEnumTag(OpaqueValue *value,
+                                                      int tag,
+                                                      const Metadata *self) {
+  auto enumType = static_cast<const EnumMetadata *>(self);
+  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+
+  // Convert resilient tag index into fragile tag index.
+  storeMultiPayloadCase<NumTagBytes, LargePayload>(
+                            value, enumType->getPayloadSize(), numPayloads,
+                            unsigned(tag + int(numPayloads)));
+}
+
+// Runtime-laid-out multi-payload enums never store tag bits in the payload,
+// so projecting the payload out leaves the value untouched.
+static void multiPayloadEnum_destructiveProjectEnumData(OpaqueValue *value,
+                                                        const Metadata *self) {
+}
+
+template <unsigned NumTagBytes>
+static void installMultiPayloadEnumWitnesses(EnumValueWitnessTable *vwtable,
+                                             size_t payloadSize) {
+  if (payloadSize >= 4) {
+    vwtable->getEnumTag = multiPayloadEnum_getEnumTag<NumTagBytes, true>;
+    vwtable->destructiveInjectEnumTag
+      = multiPayloadEnum_destructiveInjectEnumTag<NumTagBytes, true>;
+  } else {
+    vwtable->getEnumTag = multiPayloadEnum_getEnumTag<NumTagBytes, false>;
+    vwtable->destructiveInjectEnumTag
+      = multiPayloadEnum_destructiveInjectEnumTag<NumTagBytes, false>;
+  }
+  vwtable->destructiveProjectEnumData
+    = multiPayloadEnum_destructiveProjectEnumData;
+}
+
+void
+swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
+                                     EnumMetadata *enumType,
+                                     unsigned numPayloads,
+                                     const TypeLayout * const *payloadLayouts) {
+  // Accumulate the layout requirements of the payloads.
+  size_t payloadSize = 0, alignMask = 0;
+  bool isPOD = true, isBT = true;
+  for (unsigned i = 0; i < numPayloads; ++i) {
+    const TypeLayout *payloadLayout = payloadLayouts[i];
+    payloadSize
+      = std::max(payloadSize, (size_t)payloadLayout->size);
+    alignMask |= payloadLayout->flags.getAlignmentMask();
+    isPOD &= payloadLayout->flags.isPOD();
+    isBT &= payloadLayout->flags.isBitwiseTakable();
+  }
+  
+  // Store the max payload size in the metadata.
+  assignUnlessEqual(enumType->getPayloadSize(), payloadSize);
+  
+  // The total size includes space for the tag.
+  unsigned numTagBytes = getNumTagBytes(payloadSize,
+                                enumType->Description->Enum.getNumEmptyCases(),
+                                numPayloads);
+  unsigned totalSize = payloadSize + numTagBytes;
+  
+  // Set up the layout info in the vwtable.
+  vwtable->size = totalSize;
+  vwtable->flags = ValueWitnessFlags()
+    .withAlignmentMask(alignMask)
+    .withPOD(isPOD)
+    .withBitwiseTakable(isBT)
+    // TODO: Extra inhabitants
+    .withExtraInhabitants(false)
+    .withEnumWitnesses(true)
+    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
+    ;
+  vwtable->stride = (totalSize + alignMask) & ~alignMask;
+  
+  installCommonValueWitnesses(vwtable);
+
+  // Pick enum witnesses specialized for the tag layout.
+  auto enumVWTable = static_cast<EnumValueWitnessTable *>(vwtable);
+  switch (numTagBytes) {
+  case 1:
+    installMultiPayloadEnumWitnesses<1>(enumVWTable, payloadSize);
+    break;
+  case 2:
+    installMultiPayloadEnumWitnesses<2>(enumVWTable, payloadSize);
+    break;
+  case 4:
+    installMultiPayloadEnumWitnesses<4>(enumVWTable, payloadSize);
+    break;
+  default:
+    crash("Tagbyte values should be 1, 2 or 4.");
+  }
+}
+
+template <bool LargePayload>
+static void storeMultiPayloadCaseWithLayout(OpaqueValue *value,
+                                            MultiPayloadLayout layout,
+                                            unsigned numPayloads,
+                                            unsigned whichCase) {
+  switch (layout.numTagBytes) {
+  case 1:
+    return storeMultiPayloadCase<1, LargePayload>(value, layout.payloadSize,
+                                                  numPayloads, whichCase);
+  case 2:
+    return storeMultiPayloadCase<2, LargePayload>(value, layout.payloadSize,
+                                                  numPayloads, whichCase);
+  case 4:
+    return storeMultiPayloadCase<4, LargePayload>(value, layout.payloadSize,
+                                                  numPayloads, whichCase);
+  default:
+    crash("Tagbyte values should be 1, 2 or 4.");
+  }
+}
+
+template <bool LargePayload>
+static unsigned loadMultiPayloadCaseWithLayout(const OpaqueValue *value,
+                                               MultiPayloadLayout layout,
+                                               unsigned numPayloads) {
+  switch (layout.numTagBytes) {
+  case 1:
+    return loadMultiPayloadCase<1, LargePayload>(value, layout.payloadSize,
+                                                 numPayloads);
+  case 2:
+    return loadMultiPayloadCase<2, LargePayload>(value, layout.payloadSize,
+                                                 numPayloads);
+  case 4:
+    return loadMultiPayloadCase<4, LargePayload>(value, layout.payloadSize,
+                                                 numPayloads);
+  default:
+    crash("Tagbyte values should be 1, 2 or 4.");
+  }
+}
+
 void
 swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
                                       const EnumMetadata *enumType,
                                       unsigned whichCase) {
   auto layout = getMultiPayloadLayout(enumType);
   unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-  if (whichCase < numPayloads) {
-    // For a payload case, store the tag after the payload area.
-    storeMultiPayloadTag(value, layout, whichCase);
-  } else {
-    // For an empty case, factor out the parts that go in the payload and
-    // tag areas.
-    unsigned whichEmptyCase = whichCase - numPayloads;
-    unsigned whichTag, whichPayloadValue;
-    if (layout.payloadSize >= 4) {
-      whichTag = numPayloads;
-      whichPayloadValue = whichEmptyCase;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
-      whichPayloadValue = whichEmptyCase & ((1U << numPayloads) - 1U);
-    }
-    storeMultiPayloadTag(value, layout, whichTag);
-    storeMultiPayloadValue(value, layout, whichPayloadValue);
-  }
+  if (layout.payloadSize >= 4)
+    storeMultiPayloadCaseWithLayout<true>(value, layout, numPayloads,
+                                          whichCase);
+  else
+    storeMultiPayloadCaseWithLayout<false>(value, layout, numPayloads,
+                                           whichCase);
 }
 
 unsigned
@@ -424,21 +576,7 @@ swift::swift_getEnumCaseMultiPayload(const OpaqueValue *value,
                                      const EnumMetadata *enumType) {
   auto layout = getMultiPayloadLayout(enumType);
   unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-
-  unsigned tag = loadMultiPayloadTag(value, layout);
-  if (tag < numPayloads) {
-    // If the tag indicates a payload, then we're done.
-    return tag;
-  } else {
-    // Otherwise, the other part of the discriminator is in the payload.
-    unsigned payloadValue = loadMultiPayloadValue(value, layout);
-    
-    if (layout.payloadSize >= 4) {
-      return numPayloads + payloadValue;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      return (payloadValue | (tag - numPayloads) << numPayloadBits)
-             + numPayloads;
-    }
-  }
+  if (layout.payloadSize >= 4)
+    return loadMultiPayloadCaseWithLayout<true>(value, layout, numPayloads);
+  return loadMultiPayloadCaseWithLayout<false>(value, layout, numPayloads);
 }
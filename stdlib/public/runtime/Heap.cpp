@@ -18,21 +18,328 @@
 #include "swift/Runtime/Heap.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <cstddef>
 #include <stdlib.h>
 
+#if SWIFT_RUNTIME_ENABLE_SLAB_ALLOCATOR
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Mutex.h"
+#include <atomic>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#endif
+
 using namespace swift;
 
+/// The alignment mask malloc guarantees on this platform.
+static const size_t MallocAlignMask = alignof(std::max_align_t) - 1;
+
+static void *allocateWithMalloc(size_t size, size_t alignMask) {
+  void *p;
+  if (alignMask <= MallocAlignMask) {
+    p = malloc(size);
+  } else {
+    // posix_memalign requires at least pointer alignment, which any
+    // alignment greater than malloc's already satisfies.
+    if (posix_memalign(&p, alignMask + 1, size) != 0)
+      p = nullptr;
+  }
+  if (!p) swift::crash("Could not allocate memory.");
+  return p;
+}
+
+#if SWIFT_RUNTIME_ENABLE_SLAB_ALLOCATOR
+// An optional size-class allocator for small objects.
+//
+// Small allocations are carved out of 64KB slabs, each of which holds blocks
+// of a single size class. All slabs live in one reservation of address
+// space, so deciding whether a pointer belongs to the slab allocator is a
+// range check, and its size class is a single byte loaded from a side table
+// indexed by slab number. That is cheaper than malloc's own size lookup, and
+// unlike trusting the size passed to swift_slowDealloc, it stays correct for
+// objects with tail allocations, which are not always deallocated with the
+// size they were allocated with.
+//
+// Each thread keeps a free list per size class. Lists that grow too long
+// spill a batch of blocks into a global pool, and empty lists refill from
+// it, so memory freed by one thread can be reused by others. A thread's
+// cached blocks are returned to the pool when it exits.
+//
+// The allocator is compiled in with SWIFT_RUNTIME_ENABLE_SLAB_ALLOCATOR and
+// turned on by setting SWIFT_RUNTIME_SLAB_ALLOCATOR=1 in the environment.
+// Setting SWIFT_RUNTIME_SLAB_ALLOCATOR_STATS=1 as well prints
+// per-size-class statistics when the process exits.
+
+namespace {
+
+/// The granularity of size classes, and the alignment of every block.
+const size_t SlabQuantum = 16;
+const size_t NumSizeClasses = 16;
+/// Allocations larger than this go to malloc.
+const size_t MaxSlabAllocationSize = SlabQuantum * NumSizeClasses;
+
+const size_t SlabSize = 64 * 1024;
+const size_t SlabRegionSize = size_t(1) << 36;
+const size_t NumSlabs = SlabRegionSize / SlabSize;
+
+/// The number of blocks moved between a thread cache and the global pool
+/// at once.
+const size_t SlabBatchSize = 64;
+/// The number of free blocks a thread keeps per size class before spilling.
+const size_t MaxThreadCachedBlocks = 4 * SlabBatchSize;
+
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+struct ThreadSizeClassCache {
+  FreeBlock *Head;
+  size_t Count;
+};
+
+struct SizeClassStatistics {
+  std::atomic<size_t> Allocations;
+  std::atomic<size_t> Deallocations;
+  std::atomic<size_t> Slabs;
+};
+
+struct SlabAllocator {
+  char *RegionBegin = nullptr;
+  char *RegionEnd = nullptr;
+
+  /// Maps each slab to its size class plus one; zero if not yet carved.
+  uint8_t *SlabSizeClasses = nullptr;
+
+  /// Guards NextSlab and the global free lists.
+  StaticMutex Lock;
+  size_t NextSlab = 0;
+  FreeBlock *GlobalFreeLists[NumSizeClasses] = {};
+
+  bool CollectStatistics = false;
+  SizeClassStatistics Statistics[NumSizeClasses] = {};
+
+  pthread_key_t ThreadExitKey;
+
+  SlabAllocator();
+
+  bool isEnabled() const { return RegionBegin != nullptr; }
+
+  bool contains(const void *ptr) const {
+    return (const char *)ptr >= RegionBegin && (const char *)ptr < RegionEnd;
+  }
+
+  unsigned getSizeClass(const void *ptr) const {
+    size_t slab = ((const char *)ptr - RegionBegin) / SlabSize;
+    assert(SlabSizeClasses[slab] != 0 && "pointer into uncarved slab");
+    return SlabSizeClasses[slab] - 1;
+  }
+
+  void refill(ThreadSizeClassCache &cache, unsigned sizeClass);
+  void spill(ThreadSizeClassCache &cache, unsigned sizeClass, size_t count);
+  void printStatistics();
+};
+
+} // end anonymous namespace
+
+static Lazy<SlabAllocator> Slabs;
+
+static SWIFT_THREAD_LOCAL ThreadSizeClassCache ThreadCaches[NumSizeClasses];
+static SWIFT_THREAD_LOCAL bool ThreadCachesRegistered;
+
+static unsigned getSizeClassForSize(size_t size) {
+  return (size + SlabQuantum - 1) / SlabQuantum - (size != 0);
+}
+
+static size_t getSizeOfSizeClass(unsigned sizeClass) {
+  return (sizeClass + 1) * SlabQuantum;
+}
+
+static void flushThreadCaches(void *) {
+  auto &S = Slabs.unsafeGetAlreadyInitialized();
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass)
+    S.spill(ThreadCaches[sizeClass], sizeClass,
+            ThreadCaches[sizeClass].Count);
+}
+
+static void printSlabStatistics() {
+  Slabs.unsafeGetAlreadyInitialized().printStatistics();
+}
+
+static bool isEnvironmentFlagSet(const char *name) {
+  const char *value = getenv(name);
+  return value && value[0] == '1';
+}
+
+SlabAllocator::SlabAllocator() {
+  if (!isEnvironmentFlagSet("SWIFT_RUNTIME_SLAB_ALLOCATOR"))
+    return;
+
+  // Reserve the slab region, plus one slab's worth of slack so we can align
+  // it to the slab size. Pages are only committed as slabs are touched.
+  void *region = mmap(nullptr, SlabRegionSize + SlabSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED)
+    return;
+  void *sizeClasses = mmap(nullptr, NumSlabs, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+  if (sizeClasses == MAP_FAILED) {
+    munmap(region, SlabRegionSize + SlabSize);
+    return;
+  }
+  if (pthread_key_create(&ThreadExitKey, flushThreadCaches) != 0) {
+    munmap(region, SlabRegionSize + SlabSize);
+    munmap(sizeClasses, NumSlabs);
+    return;
+  }
+
+  uintptr_t begin = ((uintptr_t)region + SlabSize - 1) & ~(SlabSize - 1);
+  SlabSizeClasses = reinterpret_cast<uint8_t *>(sizeClasses);
+  RegionEnd = reinterpret_cast<char *>(begin + SlabRegionSize);
+  RegionBegin = reinterpret_cast<char *>(begin);
+
+  if (isEnvironmentFlagSet("SWIFT_RUNTIME_SLAB_ALLOCATOR_STATS")) {
+    CollectStatistics = true;
+    atexit(printSlabStatistics);
+  }
+}
+
+void SlabAllocator::refill(ThreadSizeClassCache &cache, unsigned sizeClass) {
+  StaticScopedLock guard(Lock);
+
+  // Take a batch from the global pool if it has one.
+  if (FreeBlock *head = GlobalFreeLists[sizeClass]) {
+    FreeBlock *tail = head;
+    size_t count = 1;
+    while (tail->Next && count < SlabBatchSize) {
+      tail = tail->Next;
+      ++count;
+    }
+    GlobalFreeLists[sizeClass] = tail->Next;
+    tail->Next = cache.Head;
+    cache.Head = head;
+    cache.Count += count;
+    return;
+  }
+
+  // Otherwise, carve a new slab.
+  if (NextSlab == NumSlabs)
+    swift::crash("Slab allocator region exhausted.");
+  size_t slab = NextSlab++;
+  SlabSizeClasses[slab] = sizeClass + 1;
+  if (CollectStatistics)
+    Statistics[sizeClass].Slabs.fetch_add(1, std::memory_order_relaxed);
+
+  size_t blockSize = getSizeOfSizeClass(sizeClass);
+  char *slabBegin = RegionBegin + slab * SlabSize;
+  char *slabEnd = slabBegin + SlabSize - SlabSize % blockSize;
+  // Thread the blocks in address order.
+  for (char *block = slabEnd - blockSize; block >= slabBegin;
+       block -= blockSize) {
+    auto freeBlock = reinterpret_cast<FreeBlock *>(block);
+    freeBlock->Next = cache.Head;
+    cache.Head = freeBlock;
+    ++cache.Count;
+  }
+}
+
+void SlabAllocator::spill(ThreadSizeClassCache &cache, unsigned sizeClass,
+                          size_t count) {
+  if (count == 0)
+    return;
+
+  FreeBlock *head = cache.Head;
+  FreeBlock *tail = head;
+  for (size_t i = 1; i < count; ++i)
+    tail = tail->Next;
+  cache.Head = tail->Next;
+  cache.Count -= count;
+
+  StaticScopedLock guard(Lock);
+  tail->Next = GlobalFreeLists[sizeClass];
+  GlobalFreeLists[sizeClass] = head;
+}
+
+void SlabAllocator::printStatistics() {
+  fprintf(stderr, "swift slab allocator statistics:\n");
+  fprintf(stderr, "%8s %8s %14s %14s %12s\n",
+          "size", "slabs", "allocations", "deallocations", "live");
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass) {
+    auto &stats = Statistics[sizeClass];
+    size_t allocs = stats.Allocations.load(std::memory_order_relaxed);
+    size_t deallocs = stats.Deallocations.load(std::memory_order_relaxed);
+    fprintf(stderr, "%8zu %8zu %14zu %14zu %12zd\n",
+            getSizeOfSizeClass(sizeClass),
+            stats.Slabs.load(std::memory_order_relaxed),
+            allocs, deallocs, (ssize_t)(allocs - deallocs));
+  }
+}
+
+static void *allocateFromSlab(SlabAllocator &S, size_t size) {
+  unsigned sizeClass = getSizeClassForSize(size);
+  auto &cache = ThreadCaches[sizeClass];
+
+  if (!cache.Head) {
+    // Make sure this thread's cached blocks are returned when it exits.
+    if (!ThreadCachesRegistered) {
+      pthread_setspecific(S.ThreadExitKey, &ThreadCachesRegistered);
+      ThreadCachesRegistered = true;
+    }
+    S.refill(cache, sizeClass);
+  }
+
+  FreeBlock *block = cache.Head;
+  cache.Head = block->Next;
+  --cache.Count;
+
+  if (S.CollectStatistics)
+    S.Statistics[sizeClass].Allocations.fetch_add(1,
+                                                  std::memory_order_relaxed);
+  return block;
+}
+
+static void deallocateToSlab(SlabAllocator &S, void *ptr) {
+  unsigned sizeClass = S.getSizeClass(ptr);
+  auto &cache = ThreadCaches[sizeClass];
+
+  auto block = reinterpret_cast<FreeBlock *>(ptr);
+  block->Next = cache.Head;
+  cache.Head = block;
+  if (++cache.Count > MaxThreadCachedBlocks)
+    S.spill(cache, sizeClass, SlabBatchSize);
+
+  if (S.CollectStatistics)
+    S.Statistics[sizeClass].Deallocations.fetch_add(1,
+                                                    std::memory_order_relaxed);
+}
+#endif
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
-  if (!p) swift::crash("Could not allocate memory.");
-  return p;
+#if SWIFT_RUNTIME_ENABLE_SLAB_ALLOCATOR
+  if (size <= MaxSlabAllocationSize && alignMask < SlabQuantum) {
+    auto &S = Slabs.get();
+    if (S.isEnabled())
+      return allocateFromSlab(S, size);
+  }
+#endif
+  return allocateWithMalloc(size, alignMask);
 }
 
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_RUNTIME_ENABLE_SLAB_ALLOCATOR
+  // Anything the slab allocator could have handed out was allocated after
+  // the allocator was initialized, so the region is valid if ptr is in it.
+  auto &S = Slabs.unsafeGetAlreadyInitialized();
+  if (S.contains(ptr)) {
+    deallocateToSlab(S, ptr);
+    return;
+  }
+#endif
   free(ptr);
 }
@@ -18,12 +18,15 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -37,10 +40,292 @@
 # include <objc/objc.h>
 #include "swift/Runtime/ObjCBridge.h"
 #endif
+#include "HeapProfiler.h"
 #include "Leaks.h"
+#include "RuntimeCounters.h"
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+#include <pthread.h>
+#include <vector>
+#endif
 
 using namespace swift;
 
+// Forward-declare this, but define it after swift_release.
+extern "C" LLVM_LIBRARY_VISIBILITY void
+_swift_release_dealloc(HeapObject *object) SWIFT_CC(RegisterPreservingCC_IMPL)
+    __attribute__((__noinline__, __used__));
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+//===----------------------------------------------------------------------===//
+// Biased reference counting
+//===----------------------------------------------------------------------===//
+//
+// An object is biased towards the thread that allocates it. That thread keeps
+// its part of the strong reference count in the object's BiasedRefCount and
+// updates it with plain loads and stores; every other thread updates the
+// shared part in the StrongRefCount atomically. The object's reference count
+// is the sum of the two.
+//
+// When the owner's part drops to zero, the owner merges the two counts, after
+// which the object is reference counted normally. When another thread
+// drives the shared part negative, the owner may never release the object
+// itself, so that thread queues the object with its owner, which merges it
+// the next time it allocates an object or when it exits. Queued objects of
+// threads that have already exited are merged by the queueing thread.
+
+namespace {
+  /// The state of a thread that owns biased objects.
+  struct BiasedThread {
+    Mutex Lock;
+
+    /// Objects the thread should merge. Guarded by Lock.
+    std::vector<HeapObject *> Queue;
+
+    /// Set when the thread exits. Guarded by Lock.
+    bool Exited = false;
+
+    /// Whether Queue is non-empty, so the owner can check without locking.
+    std::atomic<bool> HasQueuedObjects{false};
+  };
+
+  struct BiasedThreadRegistry {
+    /// Threads beyond this many never own objects.
+    static const uint32_t MaxThreads = 1 << 16;
+
+    /// Thread records indexed by tag. Tags are never reused, so records of
+    /// exited threads stay valid. Tag 0 means that an object has no owner.
+    std::atomic<BiasedThread *> Threads[MaxThreads];
+    std::atomic<uint32_t> NextTag{1};
+
+    pthread_key_t ThreadExitKey;
+
+    BiasedThreadRegistry();
+  };
+}
+
+static Lazy<BiasedThreadRegistry> BiasedThreads;
+
+/// The tag of the current thread, or 0 if it hasn't allocated an object yet.
+/// Threads that can't own objects, including threads that have begun to
+/// exit, use a tag that no object has.
+static SWIFT_THREAD_LOCAL uint32_t CurrentBiasedThreadTag;
+static SWIFT_THREAD_LOCAL BiasedThread *CurrentBiasedThread;
+static const uint32_t NoBiasedThreadTag = ~uint32_t(0);
+
+static void biasedThreadExited(void *);
+
+BiasedThreadRegistry::BiasedThreadRegistry() {
+  if (pthread_key_create(&ThreadExitKey, biasedThreadExited) != 0)
+    NextTag.store(MaxThreads, std::memory_order_relaxed);
+}
+
+/// Merge the counts of an object that was queued with its owner.
+static void mergeQueuedObject(HeapObject *object) {
+  bool merged;
+  if (object->refCount.mergeBiased</*Force*/ true>(
+                                 object->biasedRefCount.take(), merged))
+    _swift_release_dealloc(object);
+}
+
+static void drainBiasedQueue(BiasedThread *thread) {
+  std::vector<HeapObject *> queue;
+  {
+    ScopedLock guard(thread->Lock);
+    queue.swap(thread->Queue);
+    thread->HasQueuedObjects.store(false, std::memory_order_relaxed);
+  }
+  for (auto object : queue)
+    mergeQueuedObject(object);
+}
+
+static void biasedThreadExited(void *record) {
+  auto thread = static_cast<BiasedThread *>(record);
+
+  // Stop acting as the owner of anything; objects released from here on,
+  // say by later TLS destructors, take the shared path.
+  CurrentBiasedThreadTag = NoBiasedThreadTag;
+  CurrentBiasedThread = nullptr;
+
+  std::vector<HeapObject *> queue;
+  {
+    ScopedLock guard(thread->Lock);
+    thread->Exited = true;
+    queue.swap(thread->Queue);
+  }
+  for (auto object : queue)
+    mergeQueuedObject(object);
+}
+
+/// Return the current thread's tag, registering it if necessary.
+static uint32_t getCurrentBiasedThreadTag() {
+  if (CurrentBiasedThreadTag != 0)
+    return CurrentBiasedThreadTag;
+
+  auto &registry = BiasedThreads.get();
+  uint32_t tag = registry.NextTag.fetch_add(1, std::memory_order_relaxed);
+  if (tag >= BiasedThreadRegistry::MaxThreads) {
+    CurrentBiasedThreadTag = NoBiasedThreadTag;
+    return NoBiasedThreadTag;
+  }
+
+  auto thread = new BiasedThread();
+  registry.Threads[tag].store(thread, std::memory_order_release);
+  pthread_setspecific(registry.ThreadExitKey, thread);
+  CurrentBiasedThread = thread;
+  CurrentBiasedThreadTag = tag;
+  return tag;
+}
+
+/// Bias a newly-allocated object towards the current thread.
+static void biasNewObject(HeapObject *object) {
+  uint32_t tag = getCurrentBiasedThreadTag();
+  if (tag == NoBiasedThreadTag)
+    return;
+
+  object->refCount.initBiased();
+  object->biasedRefCount.initOwned(tag);
+
+  auto thread = CurrentBiasedThread;
+  if (thread->HasQueuedObjects.load(std::memory_order_relaxed))
+    drainBiasedQueue(thread);
+}
+
+static inline bool isOwnedByCurrentThread(const HeapObject *object) {
+  // An object's owner never changes, but stays recorded after the object
+  // has been merged.
+  return object->biasedRefCount.getOwner() == CurrentBiasedThreadTag
+      && object->refCount.isBiased();
+}
+
+/// Hand a biased object whose shared count went negative to its owner.
+static void queueBiasedObject(HeapObject *object, uint32_t ownerTag) {
+  auto thread = BiasedThreads.unsafeGetAlreadyInitialized()
+                  .Threads[ownerTag].load(std::memory_order_acquire);
+  {
+    ScopedLock guard(thread->Lock);
+    if (!thread->Exited) {
+      thread->Queue.push_back(object);
+      thread->HasQueuedObjects.store(true, std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  // Nobody else will touch the owner's count again.
+  mergeQueuedObject(object);
+}
+
+/// Release n references to an object on a thread that doesn't own it.
+template <bool ClearPinnedFlag>
+static void releaseShared(HeapObject *object, uint32_t n) {
+  // Read the owner while we still hold a reference.
+  uint32_t ownerTag = object->biasedRefCount.getOwner();
+  switch (object->refCount.decrementShared<ClearPinnedFlag>(n)) {
+  case StrongRefCount::SharedDecrementResult::Done:
+    return;
+  case StrongRefCount::SharedDecrementResult::Deallocate:
+    _swift_release_dealloc(object);
+    return;
+  case StrongRefCount::SharedDecrementResult::Queue:
+    queueBiasedObject(object, ownerTag);
+    return;
+  }
+}
+
+/// Merge the counts of an object owned by the current thread. Returns true
+/// if the caller should deallocate the object.
+static bool mergeOwnedObject(HeapObject *object) {
+  // Clear the owner's count before publishing the merge; once merged, the
+  // object may be freed by another thread at any time.
+  int32_t biased = object->biasedRefCount.take();
+  bool merged;
+  bool shouldDeallocate =
+    object->refCount.mergeBiased</*Force*/ false>(biased, merged);
+  if (!merged) {
+    // The object is queued with us, which keeps it alive until we drain our
+    // queue.
+    object->biasedRefCount.increment(biased);
+  }
+  return shouldDeallocate;
+}
+
+bool swift::_swift_isUniquelyReferencedBiased(const HeapObject *object) {
+  return isOwnedByCurrentThread(object)
+      && object->biasedRefCount.getCount()
+           + object->refCount.getSharedCount() == 1;
+}
+
+void swift::_swift_unbiasObject(HeapObject *object) {
+  if (!isOwnedByCurrentThread(object))
+    return;
+  bool shouldDeallocate = mergeOwnedObject(object);
+  assert(!shouldDeallocate && "unbiasing an object with no references");
+  (void)shouldDeallocate;
+}
+
+SWIFT_RT_ENTRY_IMPL_VISIBILITY
+extern "C"
+void SWIFT_RT_ENTRY_IMPL(swift_biased_retain)(HeapObject *object)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (!object)
+    return;
+  SWIFT_RUNTIME_COUNT(Retains, 1);
+  if (isOwnedByCurrentThread(object))
+    object->biasedRefCount.increment(1);
+  else
+    object->refCount.increment();
+}
+
+SWIFT_RT_ENTRY_IMPL_VISIBILITY
+extern "C"
+void SWIFT_RT_ENTRY_IMPL(swift_biased_retain_n)(HeapObject *object,
+                                                 uint32_t n)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (!object)
+    return;
+  SWIFT_RUNTIME_COUNT(Retains, n);
+  if (isOwnedByCurrentThread(object))
+    object->biasedRefCount.increment(n);
+  else
+    object->refCount.increment(n);
+}
+
+SWIFT_RT_ENTRY_IMPL_VISIBILITY
+extern "C"
+void SWIFT_RT_ENTRY_IMPL(swift_biased_release_n)(HeapObject *object,
+                                                  uint32_t n)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (!object)
+    return;
+  SWIFT_RUNTIME_COUNT(Releases, n);
+
+  if (isOwnedByCurrentThread(object)) {
+    if (object->biasedRefCount.decrement(n) > 0)
+      return;
+    if (mergeOwnedObject(object))
+      _swift_release_dealloc(object);
+    return;
+  }
+
+  // Objects are never re-biased, so an unbiased object can take the usual
+  // path.
+  if (!object->refCount.isBiased()) {
+    if (object->refCount.decrementShouldDeallocateN(n))
+      _swift_release_dealloc(object);
+    return;
+  }
+
+  releaseShared</*ClearPinnedFlag*/ false>(object, n);
+}
+
+SWIFT_RT_ENTRY_IMPL_VISIBILITY
+extern "C"
+void SWIFT_RT_ENTRY_IMPL(swift_biased_release)(HeapObject *object)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_RT_ENTRY_IMPL(swift_biased_release_n)(object, 1);
+}
+#endif
+
 SWIFT_RT_ENTRY_VISIBILITY
 extern "C"
 HeapObject *
@@ -67,10 +352,20 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
   object->metadata = metadata;
   object->refCount.init();
   object->weakRefCount.init();
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  object->biasedRefCount.init();
+  biasNewObject(object);
+#endif
 
   // If leak tracking is enabled, start tracking this object.
   SWIFT_LEAKS_START_TRACKING_OBJECT(object);
 
+  // If heap profiling is enabled, maybe sample this allocation.
+  SWIFT_HEAP_PROFILER_RECORD_ALLOCATION(object, requiredSize);
+
+  SWIFT_RUNTIME_COUNT(Allocations, 1);
+  SWIFT_RUNTIME_COUNT(AllocatedBytes, requiredSize);
+
   return object;
 }
 
@@ -80,6 +375,9 @@ swift::swift_initStackObject(HeapMetadata const *metadata,
   object->metadata = metadata;
   object->refCount.init();
   object->weakRefCount.initForNotDeallocating();
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  object->biasedRefCount.init();
+#endif
 
   return object;
 
@@ -91,7 +389,8 @@ swift::swift_verifyEndOfLifetime(HeapObject *object) {
     swift::fatalError(/* flags = */ 0,
                       "fatal error: stack object escaped\n");
   
-  if (object->weakRefCount.getCount() != 1)
+  if (object->weakRefCount.getCount() != 1 ||
+      object->weakRefCount.hasSideTable())
     swift::fatalError(/* flags = */ 0,
                       "fatal error: weak/unowned reference to stack object\n");
 }
@@ -225,11 +524,6 @@ OpaqueValue *swift::swift_projectBox(HeapObject *o) {
   return metadata->project(o);
 }
 
-// Forward-declare this, but define it after swift_release.
-extern "C" LLVM_LIBRARY_VISIBILITY void
-_swift_release_dealloc(HeapObject *object) SWIFT_CC(RegisterPreservingCC_IMPL)
-    __attribute__((__noinline__, __used__));
-
 SWIFT_RT_ENTRY_VISIBILITY
 extern "C"
 void swift::swift_retain(HeapObject *object)
@@ -246,6 +540,8 @@ void swift::swift_nonatomic_retain(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain)(HeapObject *object) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Retains, 1);
   _swift_nonatomic_retain_inlined(object);
 }
 
@@ -258,6 +554,8 @@ void swift::swift_nonatomic_release(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release)(HeapObject *object) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Releases, 1);
   if (object  &&  object->refCount.decrementShouldDeallocateNonAtomic()) {
     // TODO: Use non-atomic _swift_release_dealloc?
     _swift_release_dealloc(object);
@@ -268,6 +566,8 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Retains, 1);
   _swift_retain_inlined(object);
 }
 
@@ -283,6 +583,7 @@ extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   if (object) {
+    SWIFT_RUNTIME_COUNT(Retains, n);
     object->refCount.increment(n);
   }
 }
@@ -299,6 +600,7 @@ extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   if (object) {
+    SWIFT_RUNTIME_COUNT(Retains, n);
     object->refCount.incrementNonAtomic(n);
   }
 }
@@ -314,6 +616,8 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Releases, 1);
   if (object  &&  object->refCount.decrementShouldDeallocate()) {
     _swift_release_dealloc(object);
   }
@@ -329,6 +633,8 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Releases, n);
   if (object && object->refCount.decrementShouldDeallocateN(n)) {
     _swift_release_dealloc(object);
   }
@@ -348,12 +654,74 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (object)
+    SWIFT_RUNTIME_COUNT(Releases, n);
   if (object && object->refCount.decrementShouldDeallocateNNonAtomic(n)) {
     _swift_release_dealloc(object);
   }
 }
 
+/// How many elements ahead the array entry points prefetch objects.
+static const size_t ArrayPrefetchDistance = 8;
+
+static inline HeapObject *loadArrayElement(char *base, size_t index,
+                                           size_t stride) {
+  return *reinterpret_cast<HeapObject **>(base + index * stride);
+}
+
+/// Call \p body with each run of equal non-null references in the
+/// strided buffer and the length of the run, prefetching the objects a few
+/// elements ahead so their refcounts are in cache when they are reached.
+template <class Body>
+static inline void forEachArrayElementRun(HeapObject **refs, size_t count,
+                                          size_t stride, Body &&body) {
+  auto base = reinterpret_cast<char *>(refs);
+  size_t i = 0;
+  while (i < count) {
+    HeapObject *object = loadArrayElement(base, i, stride);
+    size_t end = i + 1;
+    while (end < count && loadArrayElement(base, end, stride) == object)
+      ++end;
+    for (size_t ahead = i + ArrayPrefetchDistance;
+         ahead < end + ArrayPrefetchDistance && ahead < count; ++ahead) {
+      if (auto next = loadArrayElement(base, ahead, stride))
+        __builtin_prefetch(next, /*write*/ 1);
+    }
+    if (object)
+      body(object, uint32_t(end - i));
+    i = end;
+  }
+}
+
+void swift::swift_retainArray(HeapObject **refs, size_t count,
+                              size_t stride) {
+  forEachArrayElementRun(refs, count, stride,
+                         [](HeapObject *object, uint32_t n) {
+    if (n == 1)
+      SWIFT_RT_ENTRY_CALL(swift_retain)(object);
+    else
+      SWIFT_RT_ENTRY_CALL(swift_retain_n)(object, n);
+  });
+}
+
+void swift::swift_releaseArray(HeapObject **refs, size_t count,
+                               size_t stride) {
+  forEachArrayElementRun(refs, count, stride,
+                         [](HeapObject *object, uint32_t n) {
+    if (n == 1)
+      SWIFT_RT_ENTRY_CALL(swift_release)(object);
+    else
+      SWIFT_RT_ENTRY_CALL(swift_release_n)(object, n);
+  });
+}
+
 size_t swift::swift_retainCount(HeapObject *object) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // The owner's part can only be read reliably on the owning thread.
+  if (object->refCount.isBiased())
+    return object->refCount.getSharedCount()
+         + object->biasedRefCount.getCount();
+#endif
   return object->refCount.getCount();
 }
 
@@ -436,6 +804,13 @@ HeapObject *swift::swift_tryPin(HeapObject *object)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_unpin(HeapObject *object)
   SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // Pinning always retains through the shared count.
+  if (object && object->refCount.isBiased()) {
+    releaseShared</*ClearPinnedFlag*/ true>(object, 1);
+    return;
+  }
+#endif
   if (object && object->refCount.decrementAndUnpinShouldDeallocate()) {
     _swift_release_dealloc(object);
   }
@@ -466,6 +841,12 @@ HeapObject *swift::swift_nonatomic_tryPin(HeapObject *object)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_nonatomic_unpin(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  if (object && object->refCount.isBiased()) {
+    releaseShared</*ClearPinnedFlag*/ true>(object, 1);
+    return;
+  }
+#endif
   if (object && object->refCount.decrementAndUnpinShouldDeallocateNonAtomic()) {
     _swift_release_dealloc(object);
   }
@@ -618,6 +999,9 @@ extern "C" void swift_deallocPartialClassInstance(HeapObject *object,
 #endif
 
   // The strong reference count should be +1 -- tear down the object
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  _swift_unbiasObject(object);
+#endif
   bool shouldDeallocate = object->refCount.decrementShouldDeallocate();
   assert(shouldDeallocate);
   (void) shouldDeallocate;
@@ -636,6 +1020,8 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+static void detachSideTable(HeapObject *object);
+
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_deallocObject(HeapObject *object,
                                 size_t allocatedSize,
@@ -652,6 +1038,13 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // If the object was sampled by the heap profiler, drop the sample.
+  SWIFT_HEAP_PROFILER_RECORD_DEALLOCATION(object);
+
+  // Weak references to the object load nil from now on.
+  if (object->weakRefCount.hasSideTable())
+    detachSideTable(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -726,144 +1119,177 @@ void swift::swift_deallocObject(HeapObject *object,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Weak references
+//===----------------------------------------------------------------------===//
+//
+// A native weak reference points to a side table shared by all the weak
+// references to an object, rather than to the object itself. Weak references
+// retain the side table, not the object, so the object's memory is freed as
+// soon as its strong and unowned reference counts reach zero; only the side
+// table outlives it until the last weak reference goes away.
+
+namespace {
+  /// The side allocation shared by all the weak references to one object.
+  struct WeakReferenceSideTable {
+    /// Keeps the object from being freed while a weak reference retains it.
+    Mutex Lock;
+
+    /// The object, or null once it has been deallocated. Only cleared with
+    /// Lock held.
+    std::atomic<HeapObject *> Object;
+
+    /// The number of weak references to the side table, plus one while the
+    /// object is alive.
+    std::atomic<size_t> RefCount;
+
+    WeakReferenceSideTable(HeapObject *object)
+      : Object(object), RefCount(1) {}
+
+    void retain() {
+      RefCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+      if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+    /// Retain and return the object, or return null if it has begun
+    /// deallocation.
+    HeapObject *loadStrong() {
+      if (!Object.load(std::memory_order_relaxed))
+        return nullptr;
+      ScopedLock guard(Lock);
+      auto object = Object.load(std::memory_order_relaxed);
+      return object ? swift_tryRetain(object) : nullptr;
+    }
+  };
+
+  struct WeakReferenceSideTableMap {
+    Mutex Lock;
+    llvm::DenseMap<HeapObject *, WeakReferenceSideTable *> Tables;
+  };
+}
+
+static Lazy<WeakReferenceSideTableMap> WeakReferenceSideTables;
+
+/// Return the object's side table with an extra retain, creating it if
+/// necessary.
+static WeakReferenceSideTable *retainSideTable(HeapObject *object) {
+  auto &map = WeakReferenceSideTables.get();
+  ScopedLock guard(map.Lock);
+  auto &table = map.Tables[object];
+  if (!table) {
+    table = new WeakReferenceSideTable(object);
+    object->weakRefCount.setHasSideTable();
+  }
+  table->retain();
+  return table;
+}
+
+/// Disconnect an object that is being deallocated from its side table, so
+/// that weak references to it load nil.
+static void detachSideTable(HeapObject *object) {
+  WeakReferenceSideTable *table;
+  {
+    auto &map = WeakReferenceSideTables.unsafeGetAlreadyInitialized();
+    ScopedLock guard(map.Lock);
+    auto found = map.Tables.find(object);
+    assert(found != map.Tables.end() && "object has no side table");
+    table = found->second;
+    map.Tables.erase(found);
+  }
+  {
+    ScopedLock guard(table->Lock);
+    table->Object.store(nullptr, std::memory_order_relaxed);
+  }
+  table->release();
+}
+
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
+static_assert(WR_NATIVE < alignof(WeakReferenceSideTable),
+              "weakref native bit mustn't interfere with side table pointers");
 
-enum: short {
-  WR_SPINLIMIT = 64,
-};
+static WeakReferenceSideTable *getSideTable(WeakReference *ref) {
+  return reinterpret_cast<WeakReferenceSideTable *>(ref->Value & ~WR_NATIVE);
+}
+
+static void setSideTable(WeakReference *ref, WeakReferenceSideTable *table) {
+  ref->Value = table ? (uintptr_t)table | WR_NATIVE : (uintptr_t)nullptr;
+}
 
 bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  setSideTable(ref, value ? retainSideTable(value) : nullptr);
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto oldTable = getSideTable(ref);
+  setSideTable(ref, newValue ? retainSideTable(newValue) : nullptr);
+  if (oldTable)
+    oldTable->release();
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
-    return nullptr;
-  }
-
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
+  auto table = getSideTable(ref);
+  if (table == nullptr)
     return nullptr;
-  }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  return table->loadStrong();
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
+  auto table = getSideTable(ref);
+  if (table == nullptr)
+    return nullptr;
+  auto result = table->loadStrong();
   ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  table->release();
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  auto table = getSideTable(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (table)
+    table->release();
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
+  auto table = getSideTable(src);
+
+  // Don't bother sharing the side table of an object that is already gone.
+  if (table == nullptr || !table->Object.load(std::memory_order_relaxed)) {
     dest->Value = (uintptr_t)nullptr;
     return;
   }
 
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  table->retain();
+  setSideTable(dest, table);
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  dest->Value = src->Value;
   src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getSideTable(dest))
+    table->release();
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getSideTable(dest))
+    table->release();
   swift_weakTakeInit(dest, src);
 }
 
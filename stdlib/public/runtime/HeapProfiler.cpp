@@ -0,0 +1,296 @@
+//===--- HeapProfiler.cpp - Sampling heap profiler ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Samples are taken at exponentially distributed byte intervals, the scheme
+// pprof expects of "heap_v2" profiles, so it can scale the sampled counts
+// back up to estimates of the real ones. Each sample is filed under its
+// stack trace with the object's type as the innermost frame. Symbolizing
+// the profile turns that frame into the type's metadata or nominal type
+// descriptor symbol, so pprof's per-function views become per-type ones.
+//
+//===----------------------------------------------------------------------===//
+
+#if SWIFT_RUNTIME_ENABLE_HEAP_PROFILER
+
+#include "HeapProfiler.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__APPLE__) || defined(__GLIBC__)
+#include <execinfo.h>
+#define SWIFT_HEAP_PROFILER_HAS_BACKTRACE 1
+#endif
+
+using namespace swift;
+
+SWIFT_THREAD_LOCAL intptr_t swift::_heapProfilerBytesUntilSample = 0;
+std::atomic<size_t> swift::_heapProfilerNumLiveSamples{0};
+
+namespace {
+
+/// The default mean number of bytes allocated between samples.
+const size_t DefaultSampleInterval = 512 * 1024;
+
+/// The deepest stack trace recorded for a sample.
+const int MaxSampleFrames = 64;
+
+/// The number of counters in the filter of sampled addresses. Must be a
+/// power of two.
+const size_t LiveSampleFilterSize = 4096;
+
+/// A sampled type and stack trace. The first frame is the address
+/// identifying the type; the rest are return addresses, innermost first.
+struct SampleKey {
+  std::vector<void *> Frames;
+
+  bool operator==(const SampleKey &other) const {
+    return Frames == other.Frames;
+  }
+};
+
+struct SampleKeyHash {
+  size_t operator()(const SampleKey &key) const {
+    size_t hash = 0;
+    for (auto frame : key.Frames)
+      hash = (hash ^ (uintptr_t(frame) >> 2)) * 0x100000001b3ULL;
+    return hash;
+  }
+};
+
+/// The samples taken for one type and stack trace.
+struct SampleBucket {
+  uint64_t AllocatedObjects = 0, AllocatedBytes = 0;
+  uint64_t LiveObjects = 0, LiveBytes = 0;
+};
+
+/// A sampled object that has not been deallocated yet.
+struct LiveSample {
+  SampleBucket *Bucket;
+  size_t Size;
+};
+
+struct HeapProfilerState {
+  bool Enabled = false;
+  const char *Path = nullptr;
+  size_t SampleInterval = DefaultSampleInterval;
+
+  /// Guards Buckets and LiveSamples.
+  Mutex Lock;
+  std::unordered_map<SampleKey, SampleBucket, SampleKeyHash> Buckets;
+  std::unordered_map<const HeapObject *, LiveSample> LiveSamples;
+
+  /// Counts of the live samples whose address hashes to each slot, so most
+  /// deallocations can tell they were not sampled without taking the lock.
+  std::atomic<uint32_t> LiveSampleFilter[LiveSampleFilterSize];
+
+  HeapProfilerState();
+
+  static size_t getFilterIndex(const HeapObject *object) {
+    return (uintptr_t(object) >> 4) & (LiveSampleFilterSize - 1);
+  }
+
+  void dump(const char *path);
+};
+
+} // end anonymous namespace
+
+static Lazy<HeapProfilerState> HeapProfiler;
+
+static void dumpHeapProfileAtExit() {
+  auto &P = HeapProfiler.unsafeGetAlreadyInitialized();
+  P.dump(P.Path);
+}
+
+HeapProfilerState::HeapProfilerState() {
+  for (auto &count : LiveSampleFilter)
+    count.store(0, std::memory_order_relaxed);
+
+  Path = getenv("SWIFT_RUNTIME_HEAP_PROFILE");
+  if (!Path || !Path[0])
+    return;
+
+  if (const char *interval = getenv("SWIFT_RUNTIME_HEAP_PROFILE_INTERVAL")) {
+    size_t value = strtoull(interval, nullptr, 10);
+    if (value > 0)
+      SampleInterval = value;
+  }
+
+  Enabled = true;
+  atexit(dumpHeapProfileAtExit);
+}
+
+/// State for choosing this thread's sample points.
+static SWIFT_THREAD_LOCAL bool ThreadIsSampling = false;
+static SWIFT_THREAD_LOCAL uint64_t ThreadRandomState = 0;
+
+/// Pick the number of bytes to allocate before the next sample, at random
+/// from an exponential distribution with the given mean.
+static intptr_t getNextSampleDistance(size_t mean) {
+  uint64_t x = ThreadRandomState;
+  if (x == 0)
+    x = uintptr_t(&ThreadRandomState) | 1;
+  // xorshift64
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  ThreadRandomState = x;
+
+  // A uniform value in (0, 1].
+  double u = double((x >> 11) + 1) * (1.0 / 9007199254740992.0);
+  double distance = -std::log(u) * double(mean);
+  if (distance > double(INTPTR_MAX / 2))
+    return INTPTR_MAX / 2;
+  return intptr_t(distance);
+}
+
+/// The address that identifies the type of \p object in a profile. This is
+/// the metadata if it has a symbol, which it does for nongeneric types, and
+/// otherwise the nominal type descriptor, which groups every instantiation
+/// of a generic type together.
+static void *getTypeAddressForProfile(const HeapObject *object) {
+  auto metadata = object->metadata;
+  Dl_info info;
+  if (dladdr(metadata, &info) && info.dli_sname)
+    return const_cast<HeapMetadata *>(metadata);
+  if (auto description = metadata->getNominalTypeDescriptor())
+    return const_cast<NominalTypeDescriptor *>(description.get());
+  return const_cast<HeapMetadata *>(metadata);
+}
+
+void swift::_heapProfilerSampleAllocation(HeapObject *object, size_t size) {
+  auto &P = HeapProfiler.get();
+  if (!P.Enabled) {
+    // Never come back to this thread.
+    _heapProfilerBytesUntilSample = INTPTR_MAX;
+    return;
+  }
+
+  intptr_t overshoot = _heapProfilerBytesUntilSample;
+  _heapProfilerBytesUntilSample =
+    getNextSampleDistance(P.SampleInterval) + overshoot;
+  if (_heapProfilerBytesUntilSample < 0)
+    _heapProfilerBytesUntilSample = 0;
+
+  // The first allocation on a thread only hits this path because the
+  // countdown starts at zero; don't sample it.
+  if (!ThreadIsSampling) {
+    ThreadIsSampling = true;
+    return;
+  }
+
+  SampleKey key;
+  key.Frames.push_back(getTypeAddressForProfile(object));
+#if SWIFT_HEAP_PROFILER_HAS_BACKTRACE
+  void *frames[MaxSampleFrames + 1];
+  int numFrames = backtrace(frames, MaxSampleFrames + 1);
+  // Drop this function's own frame.
+  for (int i = 1; i < numFrames; ++i)
+    key.Frames.push_back(frames[i]);
+#endif
+
+  ScopedLock guard(P.Lock);
+  auto &bucket = P.Buckets[std::move(key)];
+  bucket.AllocatedObjects += 1;
+  bucket.AllocatedBytes += size;
+  bucket.LiveObjects += 1;
+  bucket.LiveBytes += size;
+
+  P.LiveSamples[object] = LiveSample{&bucket, size};
+  P.LiveSampleFilter[HeapProfilerState::getFilterIndex(object)]
+    .fetch_add(1, std::memory_order_relaxed);
+  _heapProfilerNumLiveSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void swift::_heapProfilerRecordDeallocation(HeapObject *object) {
+  auto &P = HeapProfiler.unsafeGetAlreadyInitialized();
+  auto &filterCount =
+    P.LiveSampleFilter[HeapProfilerState::getFilterIndex(object)];
+  if (filterCount.load(std::memory_order_relaxed) == 0)
+    return;
+
+  ScopedLock guard(P.Lock);
+  auto found = P.LiveSamples.find(object);
+  if (found == P.LiveSamples.end())
+    return;
+
+  found->second.Bucket->LiveObjects -= 1;
+  found->second.Bucket->LiveBytes -= found->second.Size;
+  P.LiveSamples.erase(found);
+  filterCount.fetch_sub(1, std::memory_order_relaxed);
+  _heapProfilerNumLiveSamples.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void HeapProfilerState::dump(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "swift heap profiler: unable to write %s\n", path);
+    return;
+  }
+
+  ScopedLock guard(Lock);
+
+  SampleBucket total;
+  for (auto &entry : Buckets) {
+    total.AllocatedObjects += entry.second.AllocatedObjects;
+    total.AllocatedBytes += entry.second.AllocatedBytes;
+    total.LiveObjects += entry.second.LiveObjects;
+    total.LiveBytes += entry.second.LiveBytes;
+  }
+
+  // The legacy text heap profile format, as written by gperftools.
+  auto printCounts = [&](const SampleBucket &bucket) {
+    fprintf(file, "%llu: %llu [%llu: %llu] @",
+            (unsigned long long)bucket.LiveObjects,
+            (unsigned long long)bucket.LiveBytes,
+            (unsigned long long)bucket.AllocatedObjects,
+            (unsigned long long)bucket.AllocatedBytes);
+  };
+  fprintf(file, "heap profile: ");
+  printCounts(total);
+  fprintf(file, " heap_v2/%zu\n", SampleInterval);
+  for (auto &entry : Buckets) {
+    printCounts(entry.second);
+    for (auto frame : entry.first.Frames)
+      fprintf(file, " %p", frame);
+    fprintf(file, "\n");
+  }
+
+  // pprof needs the memory map to symbolize the addresses.
+  fprintf(file, "\nMAPPED_LIBRARIES:\n");
+  if (FILE *maps = fopen("/proc/self/maps", "r")) {
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), maps)) > 0)
+      fwrite(buffer, 1, count, file);
+    fclose(maps);
+  }
+
+  fclose(file);
+}
+
+void swift_heapProfiler_dump(const char *path) {
+  auto &P = HeapProfiler.get();
+  if (!P.Enabled)
+    return;
+  P.dump(path ? path : P.Path);
+}
+
+#endif
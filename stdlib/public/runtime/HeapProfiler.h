@@ -0,0 +1,70 @@
+//===--- HeapProfiler.h - Sampling heap profiler ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A sampling profiler for Swift object allocations. It is only built into
+// the runtime with SWIFT_RUNTIME_ENABLE_HEAP_PROFILER, and only runs if
+// SWIFT_RUNTIME_HEAP_PROFILE=<path> is set in the environment. It then
+// samples about one object per SWIFT_RUNTIME_HEAP_PROFILE_INTERVAL bytes
+// allocated (512KB by default), recording its type and a stack trace, and
+// writes the samples to <path> at exit as a heap profile pprof can read.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_STDLIB_RUNTIME_HEAPPROFILER_H
+#define SWIFT_STDLIB_RUNTIME_HEAPPROFILER_H
+
+#if SWIFT_RUNTIME_ENABLE_HEAP_PROFILER
+
+#include "swift/Runtime/Config.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace swift {
+struct HeapObject;
+
+/// The number of bytes this thread may allocate before its next sample.
+/// Threads start at zero, so their first allocation initializes them.
+extern SWIFT_THREAD_LOCAL intptr_t _heapProfilerBytesUntilSample;
+
+/// The number of sampled objects that have not been deallocated yet.
+/// Deallocation does not look for samples while this is zero.
+extern std::atomic<size_t> _heapProfilerNumLiveSamples;
+
+/// Record a sample of \p object, or set up this thread's sampling state if
+/// it has not sampled before.
+void _heapProfilerSampleAllocation(HeapObject *object, size_t size);
+
+/// Forget \p object if it was sampled.
+void _heapProfilerRecordDeallocation(HeapObject *object);
+}
+
+/// Write the samples taken so far to \p path as a pprof heap profile.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_heapProfiler_dump(const char *path);
+
+#define SWIFT_HEAP_PROFILER_RECORD_ALLOCATION(obj, size)                       \
+  do {                                                                         \
+    if ((swift::_heapProfilerBytesUntilSample -= intptr_t(size)) < 0)          \
+      swift::_heapProfilerSampleAllocation(obj, size);                         \
+  } while (0)
+#define SWIFT_HEAP_PROFILER_RECORD_DEALLOCATION(obj)                           \
+  do {                                                                         \
+    if (swift::_heapProfilerNumLiveSamples.load(std::memory_order_relaxed))    \
+      swift::_heapProfilerRecordDeallocation(obj);                             \
+  } while (0)
+#else
+#define SWIFT_HEAP_PROFILER_RECORD_ALLOCATION(obj, size)
+#define SWIFT_HEAP_PROFILER_RECORD_DEALLOCATION(obj)
+#endif
+
+#endif
@@ -27,7 +27,10 @@
 #include <algorithm>
 #include <condition_variable>
 #include <new>
+#include <vector>
 #include <cctype>
+#include <cstring>
+#include <dlfcn.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include "llvm/ADT/DenseMap.h"
@@ -41,6 +44,11 @@
 #include <mach/vm_page_size.h>
 #endif
 
+#if defined(__APPLE__) && defined(__MACH__)
+#include <mach-o/dyld.h>
+#include <mach-o/getsect.h>
+#endif
+
 #if SWIFT_OBJC_INTEROP
 #include <objc/runtime.h>
 #endif
@@ -56,7 +64,112 @@
 using namespace swift;
 using namespace metadataimpl;
 
+#if SWIFT_RUNTIME_ENABLE_METADATA_ARENAS
+// Metadata arenas.
+//
+// Instead of giving every metadata cache its own pages, all caches share a
+// couple of arenas made of large, 2MB-aligned chunks that are backed by huge
+// pages where the platform lets us ask for them. Metadata is never freed,
+// so allocation is a single atomic bump in the current chunk.
+
+namespace {
+  struct MetadataArenaChunk {
+    std::atomic<uintptr_t> Next;
+    uintptr_t End;
+  };
+
+  struct MetadataArena {
+    std::atomic<MetadataArenaChunk *> Current{nullptr};
+    /// Guards replacing Current.
+    StaticMutex Lock;
+    std::atomic<size_t> BytesReserved{0};
+    std::atomic<size_t> BytesInUse{0};
+
+    void *alloc(size_t size);
+  };
+
+  const size_t MetadataArenaChunkSize = 2 * 1024 * 1024;
+  /// Allocations at least this big get their own mapping.
+  const size_t MetadataArenaMaxAllocationSize = MetadataArenaChunkSize / 8;
+}
+
+static MetadataArena MetadataArenas[2];
+
+static MetadataArena &getMetadataArena(MetadataArenaKind kind) {
+  return MetadataArenas[unsigned(kind)];
+}
+
+/// Map \p size bytes aligned to \p alignment.
+static void *mapMetadataMemory(size_t size, size_t alignment) {
+  // Over-allocate and trim to get the alignment.
+  size_t mappedSize = size + alignment;
+  auto mem = mmap(nullptr, mappedSize, PROT_READ|PROT_WRITE,
+                  MAP_ANON|MAP_PRIVATE, VM_TAG_FOR_SWIFT_METADATA, 0);
+  if (mem == MAP_FAILED)
+    crash("unable to allocate memory for metadata cache");
+
+  uintptr_t begin = (uintptr_t)mem;
+  uintptr_t alignedBegin = (begin + alignment - 1) & ~(alignment - 1);
+  if (alignedBegin != begin)
+    munmap(mem, alignedBegin - begin);
+  uintptr_t end = begin + mappedSize, alignedEnd = alignedBegin + size;
+  if (end != alignedEnd)
+    munmap((void *)alignedEnd, end - alignedEnd);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Transparent huge pages are advisory; ignore failure.
+  if (size % MetadataArenaChunkSize == 0)
+    madvise((void *)alignedBegin, size, MADV_HUGEPAGE);
+#endif
+  return (void *)alignedBegin;
+}
+
+void *MetadataArena::alloc(size_t size) {
+  // Keep every allocation pointer-aligned.
+  size = (size + alignof(void*) - 1) & ~(alignof(void*) - 1);
+  BytesInUse.fetch_add(size, std::memory_order_relaxed);
+
+  if (LLVM_UNLIKELY(size >= MetadataArenaMaxAllocationSize)) {
+    static const size_t PageSize = sysconf(_SC_PAGESIZE);
+    size_t mappedSize = (size + PageSize - 1) & ~(PageSize - 1);
+    BytesReserved.fetch_add(mappedSize, std::memory_order_relaxed);
+    return mapMetadataMemory(mappedSize, PageSize);
+  }
+
+  while (true) {
+    if (auto chunk = Current.load(std::memory_order_acquire)) {
+      uintptr_t next = chunk->Next.fetch_add(size, std::memory_order_relaxed);
+      if (LLVM_LIKELY(next + size <= chunk->End))
+        return reinterpret_cast<void *>(next);
+    }
+
+    // The chunk is exhausted (or there is none yet). Start a new one,
+    // unless another thread beat us to it while we waited for the lock.
+    auto exhausted = Current.load(std::memory_order_acquire);
+    StaticScopedLock guard(Lock);
+    if (Current.load(std::memory_order_acquire) != exhausted)
+      continue;
+
+    auto mem = mapMetadataMemory(MetadataArenaChunkSize,
+                                 MetadataArenaChunkSize);
+    BytesReserved.fetch_add(MetadataArenaChunkSize, std::memory_order_relaxed);
+
+    // The chunk header lives at the start of the chunk itself.
+    auto chunk = new (mem) MetadataArenaChunk;
+    chunk->Next.store((uintptr_t)mem + sizeof(MetadataArenaChunk),
+                      std::memory_order_relaxed);
+    chunk->End = (uintptr_t)mem + MetadataArenaChunkSize;
+    Current.store(chunk, std::memory_order_release);
+  }
+}
+#endif
+
 void *MetadataAllocator::alloc(size_t size) {
+#if SWIFT_RUNTIME_ENABLE_METADATA_ARENAS
+  BytesAllocated.fetch_add(size, std::memory_order_relaxed);
+  return getMetadataArena(ArenaKind).alloc(size);
+#endif
+
 #if defined(__APPLE__)
   const uintptr_t PageSizeMask = vm_page_mask;
 #else
@@ -70,6 +183,7 @@ void *MetadataAllocator::alloc(size_t size) {
                     VM_TAG_FOR_SWIFT_METADATA, 0);
     if (mem == MAP_FAILED)
       crash("unable to allocate memory for metadata cache");
+    BytesAllocated.fetch_add(size, std::memory_order_relaxed);
     return mem;
   }
 
@@ -100,6 +214,7 @@ void *MetadataAllocator::alloc(size_t size) {
     if (LLVM_LIKELY(std::atomic_compare_exchange_weak_explicit(
             &NextValue, &curValue, reinterpret_cast<uintptr_t>(end),
             std::memory_order_relaxed, std::memory_order_relaxed))) {
+      BytesAllocated.fetch_add(size, std::memory_order_relaxed);
       return next;
     }
 
@@ -112,6 +227,126 @@ void *MetadataAllocator::alloc(size_t size) {
   }
 }
 
+namespace {
+  struct MetadataCacheStatisticsRegistry {
+    ConcurrentList<MetadataCacheStatistics *> AllStatistics;
+
+    MetadataCacheStatisticsRegistry() {
+      const char *value = getenv("SWIFT_DEBUG_METADATA_CACHE_STATISTICS");
+      if (value && value[0] == '1')
+        atexit(swift_dumpMetadataCacheStatistics);
+    }
+  };
+}
+
+static Lazy<MetadataCacheStatisticsRegistry> MetadataCacheStatisticsList;
+
+MetadataCacheStatistics *
+swift::createMetadataCacheStatistics(const char *name, const void *cache) {
+  auto stats = new MetadataCacheStatistics(name, cache);
+  MetadataCacheStatisticsList->AllStatistics.push_front(stats);
+  return stats;
+}
+
+/// Describe the symbol containing \p address, if any.
+static const char *getSymbolNameForAddress(const void *address) {
+  Dl_info info;
+  if (dladdr(address, &info) && info.dli_sname)
+    return info.dli_sname;
+  return "<unknown>";
+}
+
+void swift::swift_dumpMetadataCacheStatistics() {
+  struct Totals {
+    const char *Name;
+    uint64_t Caches = 0, Lookups = 0, Hits = 0, Inserts = 0, Waits = 0,
+             WaitNanoseconds = 0, BuildNanoseconds = 0, AllocatedBytes = 0;
+  };
+  std::vector<Totals> totals;
+  std::vector<const MetadataCacheStatistics *> caches;
+
+  for (auto stats : MetadataCacheStatisticsList->AllStatistics) {
+    caches.push_back(stats);
+
+    auto found = std::find_if(totals.begin(), totals.end(),
+                              [&](const Totals &t) {
+                                return strcmp(t.Name, stats->Name) == 0;
+                              });
+    if (found == totals.end()) {
+      totals.push_back(Totals());
+      found = totals.end() - 1;
+      found->Name = stats->Name;
+    }
+    ++found->Caches;
+    found->Lookups += stats->Lookups.load(std::memory_order_relaxed);
+    found->Hits += stats->Hits.load(std::memory_order_relaxed);
+    found->Inserts += stats->Inserts.load(std::memory_order_relaxed);
+    found->Waits += stats->Waits.load(std::memory_order_relaxed);
+    found->WaitNanoseconds +=
+      stats->WaitNanoseconds.load(std::memory_order_relaxed);
+    found->BuildNanoseconds +=
+      stats->BuildNanoseconds.load(std::memory_order_relaxed);
+    found->AllocatedBytes +=
+      stats->AllocatedBytes.load(std::memory_order_relaxed);
+  }
+
+  fprintf(stderr, "swift metadata cache statistics:\n");
+  fprintf(stderr, "%-26s %8s %12s %12s %10s %10s %12s %12s %12s\n",
+          "cache", "caches", "lookups", "hits", "entries", "waits",
+          "wait (us)", "bytes", "build (us)");
+  for (auto &t : totals) {
+    fprintf(stderr,
+            "%-26s %8llu %12llu %12llu %10llu %10llu %12llu %12llu %12llu\n",
+            t.Name, (unsigned long long)t.Caches,
+            (unsigned long long)t.Lookups, (unsigned long long)t.Hits,
+            (unsigned long long)t.Inserts, (unsigned long long)t.Waits,
+            (unsigned long long)(t.WaitNanoseconds / 1000),
+            (unsigned long long)t.AllocatedBytes,
+            (unsigned long long)(t.BuildNanoseconds / 1000));
+  }
+
+#if SWIFT_RUNTIME_ENABLE_METADATA_ARENAS
+  fprintf(stderr, "\nmetadata arenas:\n");
+  const char *arenaNames[] = { "general", "hot" };
+  for (unsigned i = 0; i < 2; ++i) {
+    auto &arena = MetadataArenas[i];
+    fprintf(stderr, "%-26s %12zu bytes in use %12zu bytes reserved\n",
+            arenaNames[i],
+            arena.BytesInUse.load(std::memory_order_relaxed),
+            arena.BytesReserved.load(std::memory_order_relaxed));
+  }
+#endif
+
+  _dumpImageScanningStatistics();
+
+  // List the individual caches that did the most work. The symbol of a
+  // generic metadata cache is the generic type's metadata pattern.
+  const size_t NumTopCaches = 20;
+  auto cost = [](const MetadataCacheStatistics *stats) {
+    return std::make_pair(
+      stats->WaitNanoseconds.load(std::memory_order_relaxed),
+      stats->Inserts.load(std::memory_order_relaxed));
+  };
+  std::sort(caches.begin(), caches.end(),
+            [&](const MetadataCacheStatistics *a,
+                const MetadataCacheStatistics *b) {
+              return cost(a) > cost(b);
+            });
+  if (caches.size() > NumTopCaches)
+    caches.resize(NumTopCaches);
+
+  fprintf(stderr, "\nbusiest caches:\n");
+  for (auto stats : caches) {
+    fprintf(stderr, "%-26s %p %10llu entries %10llu waits %10llu us  %s\n",
+            stats->Name, stats->Cache,
+            (unsigned long long)stats->Inserts.load(std::memory_order_relaxed),
+            (unsigned long long)stats->Waits.load(std::memory_order_relaxed),
+            (unsigned long long)
+              (stats->WaitNanoseconds.load(std::memory_order_relaxed) / 1000),
+            getSymbolNameForAddress(stats->Cache));
+  }
+}
+
 namespace {
   struct GenericCacheEntry;
 
@@ -126,6 +361,10 @@ namespace {
 
     static const char *getName() { return "GenericCache"; }
 
+    static constexpr MetadataArenaKind getArenaKind() {
+      return MetadataArenaKind::Hot;
+    }
+
     GenericCacheEntry(unsigned numArguments) {
       NumArguments = numArguments;
     }
@@ -268,6 +507,118 @@ swift::swift_allocateGenericValueMetadata(GenericMetadata *pattern,
   return metadata;
 }
 
+// Prespecialized generic metadata.
+//
+// The compiler can build the metadata for selected instantiations of a
+// generic type statically. Each image lists them in a section of
+// PrespecializedMetadataRecords; the first request for generic metadata
+// scans the loaded images and adds the prebuilt metadata to the caches of
+// their patterns, so those instantiations never allocate or take a lock.
+
+#if defined(__APPLE__) && defined(__MACH__)
+#define SWIFT_PRESPECIALIZED_METADATA_SECTION "__swift2_prespec"
+#elif defined(__ELF__)
+#define SWIFT_PRESPECIALIZED_METADATA_SECTION \
+  ".swift2_prespecialized_metadata_start"
+#elif defined(__CYGWIN__)
+#define SWIFT_PRESPECIALIZED_METADATA_SECTION ".sw2prsp"
+#endif
+
+static void
+_registerPrespecializedMetadata(const PrespecializedMetadataRecord *begin,
+                                const PrespecializedMetadataRecord *end) {
+  for (auto record = begin; record != end; ++record) {
+    auto pattern = record->getPattern();
+    auto metadata = record->getMetadata();
+
+    // The metadata carries its own key in its generic argument vector.
+    auto arguments = reinterpret_cast<const void * const *>(
+      cast<ValueMetadata>(metadata)->getGenericArgs());
+    size_t numArguments = pattern->NumKeyArguments;
+
+    // If the instantiation is already cached, because another image
+    // prespecialized it or it was instantiated before this image was
+    // loaded, keep the existing metadata; someone may be using it.
+    auto &cache = getCache(pattern);
+    cache.findOrAdd(arguments, numArguments,
+      [&]() -> GenericCacheEntry* {
+        auto entry = GenericCacheEntry::allocate(cache.getAllocator(),
+                                                 arguments, numArguments,
+                                                 /*payloadSize*/ 0);
+        entry->Value = metadata;
+        return entry;
+      });
+  }
+}
+
+static void _addImagePrespecializedMetadataBlock(const uint8_t *records,
+                                                 size_t recordsSize) {
+  assert(recordsSize % sizeof(PrespecializedMetadataRecord) == 0
+         && "weird-sized prespecialized metadata section?!");
+
+  auto recordsBegin
+    = reinterpret_cast<const PrespecializedMetadataRecord*>(records);
+  auto recordsEnd
+    = reinterpret_cast<const PrespecializedMetadataRecord*>
+                                            (records + recordsSize);
+  _registerPrespecializedMetadata(recordsBegin, recordsEnd);
+}
+
+#if defined(__APPLE__) && defined(__MACH__)
+static void _addImagePrespecializedMetadata(const mach_header *mh,
+                                            intptr_t vmaddr_slide) {
+#ifdef __LP64__
+  using mach_header_platform = mach_header_64;
+  assert(mh->magic == MH_MAGIC_64 && "loaded non-64-bit image?!");
+#else
+  using mach_header_platform = mach_header;
+#endif
+
+  // Look for a __swift2_prespec section.
+  unsigned long recordsSize;
+  const uint8_t *records =
+    getsectiondata(reinterpret_cast<const mach_header_platform *>(mh),
+                   SEG_TEXT, SWIFT_PRESPECIALIZED_METADATA_SECTION,
+                   &recordsSize);
+
+  if (!records)
+    return;
+
+  _addImagePrespecializedMetadataBlock(records, recordsSize);
+}
+#else
+namespace swift {
+  void _swift_initializeCallbacksToInspectDylib(
+    void (*fnAddImageBlock)(const uint8_t *, size_t),
+    const char *sectionName);
+}
+#endif
+
+namespace {
+  struct PrespecializedMetadataState {
+    PrespecializedMetadataState() {
+#if defined(__APPLE__) && defined(__MACH__)
+      // Dyld will invoke this on our behalf for all images that have
+      // already been loaded, and for any that are loaded later.
+      _dyld_register_func_for_add_image(_addImagePrespecializedMetadata);
+#else
+      _swift_initializeCallbacksToInspectDylib(
+        _addImagePrespecializedMetadataBlock,
+        SWIFT_PRESPECIALIZED_METADATA_SECTION);
+#endif
+    }
+  };
+}
+
+static Lazy<PrespecializedMetadataState> PrespecializedMetadata;
+
+void
+swift::swift_registerPrespecializedMetadata(
+                                    const PrespecializedMetadataRecord *begin,
+                                    const PrespecializedMetadataRecord *end) {
+  _registerPrespecializedMetadata(begin, end);
+}
+
 /// The primary entrypoint.
 SWIFT_RT_ENTRY_VISIBILITY
 const Metadata *
@@ -277,6 +628,10 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
 
+  // Make sure metadata prebuilt by the compiler is in the cache before we
+  // consider instantiating anything.
+  PrespecializedMetadata.get();
+
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
@@ -380,54 +735,8 @@ namespace {
 /// The uniquing structure for function type metadata.
 static Lazy<MetadataCache<FunctionCacheEntry>> FunctionTypes;
 
-const FunctionTypeMetadata *
-swift::swift_getFunctionTypeMetadata1(FunctionTypeFlags flags,
-                                      const void *arg0,
-                                      const Metadata *result) {
-  assert(flags.getNumArguments() == 1
-         && "wrong number of arguments in function metadata flags?!");
-  const void *flagsArgsAndResult[] = {
-    reinterpret_cast<const void*>(flags.getIntValue()),
-    arg0,
-    static_cast<const void *>(result)                      
-  };                                                       
-  return swift_getFunctionTypeMetadata(flagsArgsAndResult);
-}                                                          
-const FunctionTypeMetadata *                               
-swift::swift_getFunctionTypeMetadata2(FunctionTypeFlags flags,
-                                      const void *arg0,
-                                      const void *arg1,
-                                      const Metadata *result) {
-  assert(flags.getNumArguments() == 2
-         && "wrong number of arguments in function metadata flags?!");
-  const void *flagsArgsAndResult[] = {
-    reinterpret_cast<const void*>(flags.getIntValue()),
-    arg0,
-    arg1,                                                  
-    static_cast<const void *>(result)                      
-  };                                                       
-  return swift_getFunctionTypeMetadata(flagsArgsAndResult);
-}                                                          
-const FunctionTypeMetadata *                               
-swift::swift_getFunctionTypeMetadata3(FunctionTypeFlags flags,
-                                      const void *arg0,
-                                      const void *arg1,
-                                      const void *arg2,
-                                      const Metadata *result) {
-  assert(flags.getNumArguments() == 3
-         && "wrong number of arguments in function metadata flags?!");
-  const void *flagsArgsAndResult[] = {
-    reinterpret_cast<const void*>(flags.getIntValue()),
-    arg0,                                                  
-    arg1,                                                  
-    arg2,                                                  
-    static_cast<const void *>(result)                      
-  };                                                       
-  return swift_getFunctionTypeMetadata(flagsArgsAndResult);
-}
-
-const FunctionTypeMetadata *
-swift::swift_getFunctionTypeMetadata(const void *flagsArgsAndResult[]) {
+static FunctionCacheEntry *
+getFunctionCacheEntry(const void *flagsArgsAndResult[]) {
   auto flags = FunctionTypeFlags::fromIntValue(size_t(flagsArgsAndResult[0]));
 
   unsigned numArguments = flags.getNumArguments();
@@ -491,9 +800,81 @@ swift::swift_getFunctionTypeMetadata(const void *flagsArgsAndResult[]) {
       return entry;
     });
 
+  return entry;
+}
+
+const FunctionTypeMetadata *
+swift::swift_getFunctionTypeMetadata(const void *flagsArgsAndResult[]) {
+  return getFunctionCacheEntry(flagsArgsAndResult)->getData();
+}
+
+/// Memos of recently used function types of each small arity, keyed by the
+/// flags word, the arguments and the result.
+static MetadataCacheMemo<FunctionCacheEntry, 3> FunctionTypes1Memo;
+static MetadataCacheMemo<FunctionCacheEntry, 4> FunctionTypes2Memo;
+static MetadataCacheMemo<FunctionCacheEntry, 5> FunctionTypes3Memo;
+
+template <unsigned NumKeyArguments>
+static const FunctionTypeMetadata *getMemoizedFunctionTypeMetadata(
+                   MetadataCacheMemo<FunctionCacheEntry, NumKeyArguments> &memo,
+                   const void *flagsArgsAndResult[]) {
+  if (auto entry = memo.find(flagsArgsAndResult))
+    return entry->getData();
+
+  auto entry = getFunctionCacheEntry(flagsArgsAndResult);
+  memo.remember(flagsArgsAndResult, entry);
   return entry->getData();
 }
 
+const FunctionTypeMetadata *
+swift::swift_getFunctionTypeMetadata1(FunctionTypeFlags flags,
+                                      const void *arg0,
+                                      const Metadata *result) {
+  assert(flags.getNumArguments() == 1
+         && "wrong number of arguments in function metadata flags?!");
+  const void *flagsArgsAndResult[] = {
+    reinterpret_cast<const void*>(flags.getIntValue()),
+    arg0,
+    static_cast<const void *>(result)
+  };
+  return getMemoizedFunctionTypeMetadata(FunctionTypes1Memo,
+                                         flagsArgsAndResult);
+}
+const FunctionTypeMetadata *
+swift::swift_getFunctionTypeMetadata2(FunctionTypeFlags flags,
+                                      const void *arg0,
+                                      const void *arg1,
+                                      const Metadata *result) {
+  assert(flags.getNumArguments() == 2
+         && "wrong number of arguments in function metadata flags?!");
+  const void *flagsArgsAndResult[] = {
+    reinterpret_cast<const void*>(flags.getIntValue()),
+    arg0,
+    arg1,
+    static_cast<const void *>(result)
+  };
+  return getMemoizedFunctionTypeMetadata(FunctionTypes2Memo,
+                                         flagsArgsAndResult);
+}
+const FunctionTypeMetadata *
+swift::swift_getFunctionTypeMetadata3(FunctionTypeFlags flags,
+                                      const void *arg0,
+                                      const void *arg1,
+                                      const void *arg2,
+                                      const Metadata *result) {
+  assert(flags.getNumArguments() == 3
+         && "wrong number of arguments in function metadata flags?!");
+  const void *flagsArgsAndResult[] = {
+    reinterpret_cast<const void*>(flags.getIntValue()),
+    arg0,
+    arg1,
+    arg2,
+    static_cast<const void *>(result)
+  };
+  return getMemoizedFunctionTypeMetadata(FunctionTypes3Memo,
+                                         flagsArgsAndResult);
+}
+
 /*** Tuples ****************************************************************/
 
 namespace {
@@ -986,15 +1367,11 @@ void performBasicLayout(BasicLayout &layout,
 }
 } // end anonymous namespace
 
-const TupleTypeMetadata *
-swift::swift_getTupleTypeMetadata(size_t numElements,
-                                  const Metadata * const *elements,
-                                  const char *labels,
-                                  const ValueWitnessTable *proposedWitnesses) {
-  // Bypass the cache for the empty tuple. We might reasonably get called
-  // by generic code, like a demangler that produces type objects.
-  if (numElements == 0) return &_TMT_;
-
+static TupleCacheEntry *
+getTupleCacheEntry(size_t numElements,
+                   const Metadata * const *elements,
+                   const char *labels,
+                   const ValueWitnessTable *proposedWitnesses) {
   // Search the cache.
 
   // FIXME: include labels when uniquing!
@@ -1084,6 +1461,40 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
       return entry;
     });
 
+  return entry;
+}
+
+const TupleTypeMetadata *
+swift::swift_getTupleTypeMetadata(size_t numElements,
+                                  const Metadata * const *elements,
+                                  const char *labels,
+                                  const ValueWitnessTable *proposedWitnesses) {
+  // Bypass the cache for the empty tuple. We might reasonably get called
+  // by generic code, like a demangler that produces type objects.
+  if (numElements == 0) return &_TMT_;
+
+  return getTupleCacheEntry(numElements, elements, labels, proposedWitnesses)
+    ->getData();
+}
+
+/// Memos of recently used tuple types of each small arity, keyed by the
+/// element types just like the cache.
+static MetadataCacheMemo<TupleCacheEntry, 2> TupleTypes2Memo;
+static MetadataCacheMemo<TupleCacheEntry, 3> TupleTypes3Memo;
+
+template <unsigned NumElements>
+static const TupleTypeMetadata *getMemoizedTupleTypeMetadata(
+                       MetadataCacheMemo<TupleCacheEntry, NumElements> &memo,
+                       const Metadata * const *elements,
+                       const char *labels,
+                       const ValueWitnessTable *proposedWitnesses) {
+  auto key = (const void * const *) elements;
+  if (auto entry = memo.find(key))
+    return entry->getData();
+
+  auto entry = getTupleCacheEntry(NumElements, elements, labels,
+                                  proposedWitnesses);
+  memo.remember(key, entry);
   return entry->getData();
 }
 
@@ -1092,7 +1503,8 @@ swift::swift_getTupleTypeMetadata2(const Metadata *elt0, const Metadata *elt1,
                                    const char *labels,
                                    const ValueWitnessTable *proposedWitnesses) {
   const Metadata *elts[] = { elt0, elt1 };
-  return swift_getTupleTypeMetadata(2, elts, labels, proposedWitnesses);
+  return getMemoizedTupleTypeMetadata(TupleTypes2Memo, elts, labels,
+                                      proposedWitnesses);
 }
 
 const TupleTypeMetadata *
@@ -1101,7 +1513,8 @@ swift::swift_getTupleTypeMetadata3(const Metadata *elt0, const Metadata *elt1,
                                    const char *labels,
                                    const ValueWitnessTable *proposedWitnesses) {
   const Metadata *elts[] = { elt0, elt1, elt2 };
-  return swift_getTupleTypeMetadata(3, elts, labels, proposedWitnesses);
+  return getMemoizedTupleTypeMetadata(TupleTypes3Memo, elts, labels,
+                                      proposedWitnesses);
 }
 
 /*** Common value witnesses ************************************************/
@@ -2286,20 +2699,10 @@ const ExistentialTypeMetadata *
 swift::swift_getExistentialTypeMetadata(size_t numProtocols,
                                         const ProtocolDescriptor **protocols)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // Sort the protocol set.
-  std::sort(protocols, protocols + numProtocols);
-
-  // Calculate the class constraint and number of witness tables for the
-  // protocol set.
-  unsigned numWitnessTables = 0;
-  ProtocolClassConstraint classConstraint = ProtocolClassConstraint::Any;
-  for (auto p : make_range(protocols, protocols + numProtocols)) {
-    if (p->Flags.needsWitnessTable()) {
-      ++numWitnessTables;
-    }
-    if (p->Flags.getClassConstraint() == ProtocolClassConstraint::Class)
-      classConstraint = ProtocolClassConstraint::Class;
-  }
+  // Sort the protocol set. Protocol lists from the compiler usually have one
+  // element or are already sorted, so check that first.
+  if (numProtocols > 1 && !std::is_sorted(protocols, protocols + numProtocols))
+    std::sort(protocols, protocols + numProtocols);
 
   // Search the cache.
 
@@ -2313,6 +2716,18 @@ swift::swift_getExistentialTypeMetadata(size_t numProtocols,
                              protocolArgs, numProtocols,
                              sizeof(const ProtocolDescriptor *) * numProtocols);
       auto metadata = entry->getData();
+
+      // Calculate the class constraint and number of witness tables for the
+      // protocol set.
+      unsigned numWitnessTables = 0;
+      ProtocolClassConstraint classConstraint = ProtocolClassConstraint::Any;
+      for (auto p : make_range(protocols, protocols + numProtocols)) {
+        if (p->Flags.needsWitnessTable()) {
+          ++numWitnessTables;
+        }
+        if (p->Flags.getClassConstraint() == ProtocolClassConstraint::Class)
+          classConstraint = ProtocolClassConstraint::Class;
+      }
       
       // Get the special protocol kind for an uncomposed protocol existential.
       // Protocol compositions are currently never special.
@@ -2522,6 +2937,10 @@ namespace {
   public:
     static const char *getName() { return "WitnessTableCache"; }
 
+    static constexpr MetadataArenaKind getArenaKind() {
+      return MetadataArenaKind::Hot;
+    }
+
     WitnessTableCacheEntry(size_t numArguments) {
       assert(numArguments == getNumArguments());
     }
@@ -2536,6 +2955,19 @@ namespace {
           const_cast<void **>(getData<void *>()) +
           genericTable->WitnessTablePrivateSizeInWords);
     }
+
+    /// Recover the entry from a witness table returned by get().
+    static const WitnessTableCacheEntry *
+    fromTable(const WitnessTable *table, GenericWitnessTable *genericTable) {
+      auto data = reinterpret_cast<void * const *>(table) -
+        genericTable->WitnessTablePrivateSizeInWords;
+      return reinterpret_cast<const WitnessTableCacheEntry *>(data) - 1;
+    }
+
+    /// The conforming type this witness table was instantiated for.
+    const Metadata *getType() const {
+      return reinterpret_cast<const Metadata *>(getArgumentsBuffer()[0]);
+    }
   };
 }
 
@@ -2672,3 +3104,23 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
 
   return entry->get(genericTable);
 }
+
+const WitnessTable *
+swift::swift_getWitnessTableBase(WitnessTable *table, size_t index) {
+  auto slot = reinterpret_cast<std::atomic<uintptr_t> *>(table) + index;
+  uintptr_t value = slot->load(std::memory_order_acquire);
+  if (!(value & LazyWitnessTableBaseTag))
+    return reinterpret_cast<const WitnessTable *>(value);
+
+  // Derive the base witness table for the type the table was instantiated
+  // for. Racing threads derive the same uniqued table, so whichever store
+  // lands last is as good as the first.
+  auto lazyBase = reinterpret_cast<const LazyWitnessTableBase *>(
+                                            value & ~LazyWitnessTableBaseTag);
+  auto entry = WitnessTableCacheEntry::fromTable(table,
+                                                 lazyBase->GenericTable.get());
+  auto base = lazyBase->Accessor(entry->getType());
+
+  slot->store(reinterpret_cast<uintptr_t>(base), std::memory_order_release);
+  return base;
+}
@@ -17,6 +17,8 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "RuntimeCounters.h"
+#include <chrono>
 #include <condition_variable>
 #include <thread>
 
@@ -24,8 +26,25 @@
 #define SWIFT_DEBUG_RUNTIME 0
 #endif
 
+/// Back metadata caches with a ConcurrentHashMap instead of the
+/// tree-based ConcurrentMap.
+#ifndef SWIFT_RUNTIME_METADATA_CACHE_HASH_MAP
+#define SWIFT_RUNTIME_METADATA_CACHE_HASH_MAP 0
+#endif
+
 namespace swift {
 
+/// The shared arena a metadata allocator draws from when the runtime is
+/// built with SWIFT_RUNTIME_ENABLE_METADATA_ARENAS.
+enum class MetadataArenaKind : uint8_t {
+  /// Metadata that is rarely touched after instantiation.
+  General,
+  /// Metadata that generic code reads constantly: instantiated generic
+  /// type metadata and witness tables. Keeping it together improves TLB
+  /// and cache locality.
+  Hot,
+};
+
 /// A bump pointer for metadata allocations. Since metadata is (currently)
 /// never released, it does not support deallocation. This allocator by itself
 /// is not thread-safe; in concurrent uses, allocations must be guarded by
@@ -38,9 +57,17 @@ class MetadataAllocator {
   /// Initializing to -1 instead of nullptr ensures that the first allocation
   /// triggers a page allocation since it will always span a "page" boundary.
   std::atomic<uintptr_t> NextValue;
+
+  /// The total number of bytes handed out by this allocator.
+  std::atomic<size_t> BytesAllocated;
+
+  /// The shared arena to allocate from, if arenas are enabled.
+  MetadataArenaKind ArenaKind;
   
 public:
-  constexpr MetadataAllocator() : NextValue(~(uintptr_t)0) {}
+  constexpr MetadataAllocator(
+      MetadataArenaKind arenaKind = MetadataArenaKind::General)
+    : NextValue(~(uintptr_t)0), BytesAllocated(0), ArenaKind(arenaKind) {}
 
   // Don't copy or move, please.
   MetadataAllocator(const MetadataAllocator &) = delete;
@@ -49,8 +76,58 @@ public:
   MetadataAllocator &operator=(MetadataAllocator &&) = delete;
   
   void *alloc(size_t size);
+
+  size_t getBytesAllocated() const {
+    return BytesAllocated.load(std::memory_order_relaxed);
+  }
 };
 
+/// Counters kept by every metadata cache. They are updated with relaxed
+/// atomic operations, and the ones that involve timing are only touched on
+/// the slow path, so they are cheap enough to always collect.
+///
+/// Statistics are registered in a global list when their cache is created
+/// and are never freed, so they can be dumped at any point.
+struct MetadataCacheStatistics {
+  /// The name of the kind of cache, e.g. "GenericCache".
+  const char *Name;
+  /// The address of the cache, for symbolication. For generic metadata and
+  /// witness table caches this lies inside the pattern.
+  const void *Cache;
+
+  /// The number of calls to findOrAdd.
+  std::atomic<uint64_t> Lookups;
+  /// The number of lookups that found an initialized entry without waiting.
+  std::atomic<uint64_t> Hits;
+  /// The number of entries created.
+  std::atomic<uint64_t> Inserts;
+  /// The number of lookups that had to wait for another thread to finish
+  /// initializing an entry.
+  std::atomic<uint64_t> Waits;
+  /// The total time spent in such waits.
+  std::atomic<uint64_t> WaitNanoseconds;
+  /// The total time spent building the entries that were created.
+  std::atomic<uint64_t> BuildNanoseconds;
+  /// The high-water mark of bytes taken from the cache's allocator.
+  std::atomic<size_t> AllocatedBytes;
+
+  MetadataCacheStatistics(const char *name, const void *cache)
+    : Name(name), Cache(cache), Lookups(0), Hits(0), Inserts(0), Waits(0),
+      WaitNanoseconds(0), BuildNanoseconds(0), AllocatedBytes(0) {}
+
+  void noteAllocatedBytes(size_t bytes) {
+    size_t old = AllocatedBytes.load(std::memory_order_relaxed);
+    while (old < bytes &&
+           !AllocatedBytes.compare_exchange_weak(old, bytes,
+                                                 std::memory_order_relaxed))
+      ;
+  }
+};
+
+/// Create and register statistics for the cache at \p cache.
+MetadataCacheStatistics *
+createMetadataCacheStatistics(const char *name, const void *cache);
+
 // A wrapper around a pointer to a metadata cache entry that provides
 // DenseMap semantics that compare values in the key vector for the metadata
 // instance.
@@ -184,6 +261,57 @@ public:
                                          unsigned numArguments) {
     return reinterpret_cast<const Impl *>(argsBuffer + numArguments);
   }
+
+  /// The arena the cache should allocate entries from. Entry types for
+  /// frequently accessed metadata override this.
+  static constexpr MetadataArenaKind getArenaKind() {
+    return MetadataArenaKind::General;
+  }
+};
+
+/// A small direct-mapped memo of recently used entries, checked before a
+/// metadata cache for keys with exactly NumKeyArguments words.
+///
+/// Each slot holds a pointer to an entry; the key is read back from the
+/// entry's argument buffer, so a hit costs one atomic load and a few
+/// compares, without hashing the whole key or searching the cache.  Cache
+/// entries are never freed, so a slot that is overwritten by another thread
+/// still points to a valid entry, which simply fails to match.  Like the
+/// cache, all-zero is a valid state.
+template <class EntryTy, unsigned NumKeyArguments, unsigned NumSlots = 64>
+class MetadataCacheMemo {
+  static_assert((NumSlots & (NumSlots - 1)) == 0,
+                "number of slots must be a power of two");
+
+  std::atomic<EntryTy *> Slots[NumSlots];
+
+  static unsigned getSlotIndex(const void * const *arguments) {
+    uintptr_t hash = 0;
+    for (unsigned i = 0; i != NumKeyArguments; ++i)
+      hash = (hash ^ (uintptr_t(arguments[i]) >> 4)) * 0x9E3779B1;
+    return (hash >> 8) & (NumSlots - 1);
+  }
+
+public:
+  /// Return the remembered entry for the given key, or null.
+  EntryTy *find(const void * const *arguments) {
+    auto entry =
+      Slots[getSlotIndex(arguments)].load(std::memory_order_acquire);
+    if (!entry)
+      return nullptr;
+
+    auto entryArguments = entry->getArgumentsBuffer();
+    for (unsigned i = 0; i != NumKeyArguments; ++i)
+      if (entryArguments[i] != arguments[i])
+        return nullptr;
+    return entry;
+  }
+
+  /// Remember a fully-initialized entry for the given key, replacing
+  /// whatever its slot held before.
+  void remember(const void * const *arguments, EntryTy *entry) {
+    Slots[getSlotIndex(arguments)].store(entry, std::memory_order_release);
+  }
 };
 
 /// The implementation of a metadata cache.  Note that all-zero must
@@ -244,6 +372,10 @@ template <class ValueTy> class MetadataCache {
       return key.KeyData.size() * sizeof(void*);
     }
 
+    static size_t getKeyHash(const Key &key) {
+      return key.Hash;
+    }
+
     int compareWithKey(const Key &key) const {
       // Order by hash first, then by the actual key data.
       if (key.Hash != Hash) {
@@ -267,7 +399,11 @@ template <class ValueTy> class MetadataCache {
   };
 
   /// The concurrent map.
+#if SWIFT_RUNTIME_METADATA_CACHE_HASH_MAP
+  ConcurrentHashMap<Entry> Map;
+#else
   ConcurrentMap<Entry> Map;
+#endif
 
   static_assert(sizeof(Map) == 2 * sizeof(void*),
                 "offset of Head is not at proper offset");
@@ -280,6 +416,7 @@ template <class ValueTy> class MetadataCache {
   struct ConcurrencyControl {
     Mutex Lock;
     ConditionVariable Queue;
+    MetadataCacheStatistics *Statistics;
   };
   std::unique_ptr<ConcurrencyControl> Concurrency;
 
@@ -287,7 +424,12 @@ template <class ValueTy> class MetadataCache {
   MetadataAllocator Allocator;
   
 public:
-  MetadataCache() : Concurrency(new ConcurrencyControl()) {}
+  MetadataCache()
+    : Concurrency(new ConcurrencyControl()),
+      Allocator(ValueTy::getArenaKind()) {
+    Concurrency->Statistics =
+      createMetadataCacheStatistics(ValueTy::getName(), this);
+  }
   ~MetadataCache() {}
 
   /// Caches are not copyable.
@@ -319,6 +461,10 @@ public:
            ValueTy::getName(), this, key.Hash);
 #endif
 
+    auto concurrency = Concurrency.get();
+    auto stats = concurrency->Statistics;
+    stats->Lookups.fetch_add(1, std::memory_order_relaxed);
+
     // Ensure the existence of a map entry.
     auto insertResult = Map.getOrInsert(key);
     Entry *entry = insertResult.first;
@@ -330,13 +476,14 @@ public:
       // If the entry is already initialized, great.
       auto value = entry->getValue();
       if (value) {
+        stats->Hits.fetch_add(1, std::memory_order_relaxed);
         return value;
       }
 
       // Otherwise, we have to grab the lock and wait for the value to
       // appear there.  Note that we have to check again immediately
       // after acquiring the lock to prevent a race.
-      auto concurrency = Concurrency.get();
+      auto waitStart = std::chrono::steady_clock::now();
       concurrency->Lock.withLockOrWait(concurrency->Queue, [&, this] {
         if ((value = entry->getValue())) {
           return true; // found a value, done waiting
@@ -355,12 +502,27 @@ public:
         return false; // don't have a value, continue waiting
       });
 
+      auto waitTime = std::chrono::steady_clock::now() - waitStart;
+      stats->Waits.fetch_add(1, std::memory_order_relaxed);
+      stats->WaitNanoseconds.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime).count(),
+        std::memory_order_relaxed);
+
       return value;
     }
 
     // Otherwise, we created the entry and are responsible for
     // creating the metadata.
+    auto buildStart = std::chrono::steady_clock::now();
     auto value = builder();
+    auto buildTime = std::chrono::steady_clock::now() - buildStart;
+
+    stats->Inserts.fetch_add(1, std::memory_order_relaxed);
+    stats->BuildNanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(buildTime).count(),
+      std::memory_order_relaxed);
+    SWIFT_RUNTIME_COUNT(MetadataInstantiations, 1);
+    stats->noteAllocatedBytes(Allocator.getBytesAllocated());
 
     // Update the linked list.
     value->Next = Head;
@@ -372,7 +534,6 @@ public:
 #endif
 
     // Acquire the lock, set the value, and notify any waiters.
-    auto concurrency = Concurrency.get();
     concurrency->Lock.withLockThenNotifyAll(
         concurrency->Queue, [&entry, &value] { entry->setValue(value); });
 
@@ -24,6 +24,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/StringExtras.h"
+#include "MetadataCache.h"
 #include "Private.h"
 
 #if defined(__APPLE__) && defined(__MACH__)
@@ -56,16 +57,6 @@ using namespace Demangle;
 // Type Metadata Cache.
 
 namespace {
-  struct TypeMetadataSection {
-    const TypeMetadataRecord *Begin, *End;
-    const TypeMetadataRecord *begin() const {
-      return Begin;
-    }
-    const TypeMetadataRecord *end() const {
-      return End;
-    }
-  };
-
   struct TypeMetadataCacheEntry {
   private:
     std::string Name;
@@ -84,6 +75,10 @@ namespace {
       return aName.compare(Name);
     }
 
+    static size_t getKeyHash(llvm::StringRef aName) {
+      return _hashMangledTypeName(aName);
+    }
+
     template <class... T>
     static size_t getExtraAllocationSize(T &&... ignored) {
       return 0;
@@ -105,12 +100,19 @@ static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
 #endif
 
 struct TypeMetadataState {
-  ConcurrentMap<TypeMetadataCacheEntry> Cache;
-  std::vector<TypeMetadataSection> SectionsToScan;
-  Mutex SectionsToScanLock;
+  /// Names that have been resolved to metadata.
+  ConcurrentHashMap<TypeMetadataCacheEntry> Cache;
+  MetadataCacheStatistics *CacheStatistics;
+
+  /// The registered type metadata records, by the name of their type.
+  ConcurrentHashMap<MangledTypeNameIndexEntry<TypeMetadataRecord>>
+    RecordsByName;
+  MetadataCacheStatistics *RecordsByNameStatistics;
 
   TypeMetadataState() {
-    SectionsToScan.reserve(16);
+    CacheStatistics = createMetadataCacheStatistics("TypeNameCache", &Cache);
+    RecordsByNameStatistics =
+      createMetadataCacheStatistics("TypeNameIndex", &RecordsByName);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
 #else
@@ -124,12 +126,40 @@ struct TypeMetadataState {
 
 static Lazy<TypeMetadataState> TypeMetadataRecords;
 
+/// The nominal type descriptor of the type a record describes, if there is
+/// one.
+static const NominalTypeDescriptor *
+_getRecordTypeDescriptor(const TypeMetadataRecord &record) {
+  switch (record.getTypeKind()) {
+  case TypeMetadataRecordKind::UniqueDirectType:
+  case TypeMetadataRecordKind::NonuniqueDirectType:
+  case TypeMetadataRecordKind::UniqueDirectClass:
+    if (auto metadata = record.getDirectType())
+      return metadata->getNominalTypeDescriptor();
+    return nullptr;
+  case TypeMetadataRecordKind::UniqueNominalTypeDescriptor:
+    return record.getNominalTypeDescriptor();
+  case TypeMetadataRecordKind::UniqueIndirectClass:
+  case TypeMetadataRecordKind::Universal:
+    return nullptr;
+  }
+}
+
 static void
 _registerTypeMetadataRecords(TypeMetadataState &T,
                              const TypeMetadataRecord *begin,
                              const TypeMetadataRecord *end) {
-  ScopedLock guard(T.SectionsToScanLock);
-  T.SectionsToScan.push_back(TypeMetadataSection{begin, end});
+  // Index the records by name. If several records describe the same type,
+  // the first one registered wins.
+  for (auto record = begin; record != end; ++record) {
+    auto ntd = _getRecordTypeDescriptor(*record);
+    if (!ntd)
+      continue;
+    if (T.RecordsByName.getOrInsert(llvm::StringRef(ntd->Name.get()),
+                                    record).second)
+      T.RecordsByNameStatistics->Inserts.fetch_add(1,
+                                                  std::memory_order_relaxed);
+  }
 }
 
 static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
@@ -230,26 +260,15 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
 
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
-  }
+  T.RecordsByNameStatistics->Lookups.fetch_add(1, std::memory_order_relaxed);
+  auto found = T.RecordsByName.find(typeName);
+  if (!found)
+    return nullptr;
 
-  return nullptr;
+  T.RecordsByNameStatistics->Hits.fetch_add(1, std::memory_order_relaxed);
+  return _resolveMangledTypeNameRecord(typeName, *found->getRecord());
 }
 
 static const Metadata *
@@ -258,14 +277,14 @@ _typeByMangledName(const llvm::StringRef typeName) {
   auto &T = TypeMetadataRecords.get();
 
   // Look for an existing entry.
-  // Find the bucket for the metadata entry.
-  if (auto Value = T.Cache.find(typeName))
+  T.CacheStatistics->Lookups.fetch_add(1, std::memory_order_relaxed);
+  if (auto Value = T.Cache.find(typeName)) {
+    T.CacheStatistics->Hits.fetch_add(1, std::memory_order_relaxed);
     return Value->getMetadata();
+  }
 
   // Check type metadata records
-  T.SectionsToScanLock.withLock([&] {
-    foundMetadata = _searchTypeMetadataRecords(T, typeName);
-  });
+  foundMetadata = _searchTypeMetadataRecords(T, typeName);
 
   // Check protocol conformances table. Note that this has no support for
   // resolving generic types yet.
@@ -273,7 +292,8 @@ _typeByMangledName(const llvm::StringRef typeName) {
     foundMetadata = _searchConformancesByMangledTypeName(typeName);
 
   if (foundMetadata) {
-    T.Cache.getOrInsert(typeName, foundMetadata);
+    if (T.Cache.getOrInsert(typeName, foundMetadata).second)
+      T.CacheStatistics->Inserts.fetch_add(1, std::memory_order_relaxed);
   }
 
 #if SWIFT_OBJC_INTEROP
@@ -17,6 +17,7 @@
 #include "Private.h"
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include <condition_variable>
 #include <type_traits>
 
 using namespace swift;
@@ -44,12 +45,31 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #elif defined(__CYGWIN__)
   _swift_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  // The predicate goes from 0 to 1 while fn runs, and to ~0 when it is done,
+  // like it does with dispatch_once. IRGen checks for the "done" value inline
+  // (see SwiftTargetInfo::OnceDonePredicateValue), so this is only reached
+  // before the initialization has finished.
+  const swift_once_t running = 1;
+  const swift_once_t done = ~swift_once_t(0);
+  if (__atomic_load_n(predicate, __ATOMIC_ACQUIRE) == done)
+    return;
+
+  // Initializations are rare, so all of them share one lock. It is not held
+  // while fn runs, which may initialize other globals.
+  static std::mutex *mutex = new std::mutex;
+  static std::condition_variable *finished = new std::condition_variable;
+  std::unique_lock<std::mutex> lock(*mutex);
+  while (__atomic_load_n(predicate, __ATOMIC_RELAXED) == running)
+    finished->wait(lock);
+  if (__atomic_load_n(predicate, __ATOMIC_RELAXED) == done)
+    return;
+  __atomic_store_n(predicate, running, __ATOMIC_RELAXED);
+  lock.unlock();
+
+  fn(nullptr);
+
+  lock.lock();
+  __atomic_store_n(predicate, done, __ATOMIC_RELEASE);
+  finished->notify_all();
 #endif
 }
@@ -45,6 +45,17 @@ namespace swift {
   extern "C" LLVM_LIBRARY_VISIBILITY LLVM_ATTRIBUTE_NORETURN
   void _swift_abortRetainUnowned(const void *object);
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  /// Is a biased object uniquely referenced? Only the owning thread can
+  /// see the whole reference count, so this is false on any other thread.
+  bool _swift_isUniquelyReferencedBiased(const HeapObject *object);
+
+  /// Fold the owning thread's part of an object's reference count into the
+  /// shared count, if the current thread owns the object. Afterwards the
+  /// object's strong reference count can be used directly.
+  void _swift_unbiasObject(HeapObject *object);
+#endif
+
   /// Is the given value a valid alignment mask?
   static inline bool isAlignmentMask(size_t mask) {
     // mask          == xyz01111...
@@ -156,6 +167,74 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  /// Hash a mangled type name for the runtime's name-keyed hash maps.
+  inline size_t _hashMangledTypeName(llvm::StringRef name) {
+    // FNV-1a.
+    size_t hash = sizeof(size_t) == 8 ? size_t(14695981039346656037ULL)
+                                      : size_t(2166136261U);
+    size_t prime = sizeof(size_t) == 8 ? size_t(1099511628211ULL)
+                                       : size_t(16777619U);
+    for (char c : name)
+      hash = (hash ^ (unsigned char)c) * prime;
+    return hash;
+  }
+
+  /// An entry in an index of type metadata or protocol conformance records,
+  /// keyed by the mangled name of the type the record describes. The index
+  /// is filled in as images register their records, so resolving a name
+  /// takes one hash probe rather than a walk over every record.
+  ///
+  /// The name points into the type's nominal type descriptor, which lives
+  /// as long as the image that registered the record.
+  template <class RecordTy>
+  class MangledTypeNameIndexEntry {
+    llvm::StringRef Name;
+    const RecordTy *Record;
+
+  public:
+    MangledTypeNameIndexEntry(llvm::StringRef name, const RecordTy *record)
+      : Name(name), Record(record) {}
+
+    /// The first registered record for the type.
+    const RecordTy *getRecord() const { return Record; }
+
+    int compareWithKey(llvm::StringRef name) const {
+      return name.compare(Name);
+    }
+
+    static size_t getKeyHash(llvm::StringRef name) {
+      return _hashMangledTypeName(name);
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+  };
+
+  /// Resolve a record found in a mangled-name index to the metadata for
+  /// \p typeName, or null if the record does not denote a single type.
+  template <class RecordTy>
+  const Metadata *_resolveMangledTypeNameRecord(llvm::StringRef typeName,
+                                                const RecordTy &record) {
+    if (auto metadata = record.getCanonicalTypeMetadata())
+      return _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
+    if (record.getTypeKind() ==
+          TypeMetadataRecordKind::UniqueNominalTypeDescriptor)
+      return _matchMetadataByMangledTypeName(typeName, nullptr,
+                                             record.getNominalTypeDescriptor());
+    return nullptr;
+  }
+
+  /// Return a counter that changes whenever new protocol conformance
+  /// records are registered. A negative conformance result computed under
+  /// one generation may be stale under another.
+  uintptr_t _getProtocolConformanceGeneration();
+
+  /// Print how much work was spent finding and indexing the conformance
+  /// records of loaded images. Part of swift_dumpMetadataCacheStatistics.
+  void _dumpImageScanningStatistics();
+
 #if SWIFT_OBJC_INTEROP
   Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
 #endif
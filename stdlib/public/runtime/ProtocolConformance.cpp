@@ -19,7 +19,9 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "MetadataCache.h"
 #include "Private.h"
+#include "RuntimeCounters.h"
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -29,6 +31,8 @@
 #include <link.h>
 #endif
 
+#include <chrono>
+#include <cstdio>
 #include <dlfcn.h>
 
 using namespace swift;
@@ -223,6 +227,47 @@ namespace {
       return FailureGeneration.load(std::memory_order_relaxed);
     }
   };
+
+  /// An entry in the index of conformance records, keyed by the protocol
+  /// they conform to. The index is populated when an image's conformance
+  /// block is registered, so a cache miss only has to visit the records
+  /// for the protocol being queried instead of every record in the process.
+  struct ConformanceIndexEntry {
+  private:
+    const ProtocolDescriptor *Proto;
+
+    /// The number of records in Records, published for lock-free readers.
+    std::atomic<size_t> NumRecords;
+
+  public:
+    /// The records conforming to Proto, in registration order.
+    /// Guarded by SectionsToScanLock.
+    std::vector<const ProtocolConformanceRecord *> Records;
+
+    ConformanceIndexEntry(const ProtocolDescriptor *proto)
+      : Proto(proto), NumRecords(0) {}
+
+    int compareWithKey(const ProtocolDescriptor *key) const {
+      if (key != Proto)
+        return (uintptr_t(key) < uintptr_t(Proto) ? -1 : 1);
+      return 0;
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+
+    /// Add a record to the index. Must be called with SectionsToScanLock held.
+    void addRecord(const ProtocolConformanceRecord *record) {
+      Records.push_back(record);
+      NumRecords.store(Records.size(), std::memory_order_release);
+    }
+
+    size_t getNumRecords() const {
+      return NumRecords.load(std::memory_order_acquire);
+    }
+  };
 }
 
 // Conformance Cache.
@@ -239,13 +284,84 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
                                                size_t conformancesSize);
 #endif
 
+namespace {
+  /// Counters describing the work done to find and index the conformance
+  /// records of loaded images. They live outside ConformanceState so that
+  /// dumping them does not force the images to be scanned.
+  struct ImageScanningStatistics {
+    std::atomic<uint64_t> Sections{0};
+    std::atomic<uint64_t> Records{0};
+    /// Time spent inspecting the images loaded at startup, including
+    /// indexing their records unless indexing is lazy.
+    std::atomic<uint64_t> InspectNanoseconds{0};
+    /// Time spent adding records to the index by protocol.
+    std::atomic<uint64_t> ProtocolIndexNanoseconds{0};
+    /// Time spent adding records to the index by conforming type name.
+    std::atomic<uint64_t> NameIndexNanoseconds{0};
+  };
+
+  /// Adds the time between its construction and destruction to a counter.
+  class ScanningTimer {
+    std::atomic<uint64_t> &Counter;
+    std::chrono::steady_clock::time_point Start;
+
+  public:
+    ScanningTimer(std::atomic<uint64_t> &counter)
+      : Counter(counter), Start(std::chrono::steady_clock::now()) {}
+
+    ~ScanningTimer() {
+      auto elapsed = std::chrono::steady_clock::now() - Start;
+      Counter.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        std::memory_order_relaxed);
+    }
+  };
+}
+
+static ImageScanningStatistics ScanningStatistics;
+
 struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
+  ConcurrentMap<ConformanceIndexEntry> RecordsByProtocol;
+
+  /// The registered records, by the mangled name of the conforming type.
+  ConcurrentHashMap<MangledTypeNameIndexEntry<ProtocolConformanceRecord>>
+    RecordsByTypeName;
+  MetadataCacheStatistics *RecordsByTypeNameStatistics;
+
   std::vector<ConformanceSection> SectionsToScan;
   Mutex SectionsToScanLock;
+
+  /// If set, registering an image only records its conformance section;
+  /// the records are indexed by the first lookup that needs them.
+  /// Enabled with SWIFT_RUNTIME_LAZY_CONFORMANCE_INDEXING=1.
+  bool LazyIndexing;
+
+  /// The number of sections in SectionsToScan whose records have been
+  /// added to RecordsByProtocol and RecordsByTypeName, respectively.
+  /// Guarded by SectionsToScanLock.
+  size_t NumSectionsIndexedByProtocol = 0;
+  size_t NumSectionsIndexedByTypeName = 0;
+
+  /// Set while SectionsToScan has sections missing from either index,
+  /// so that lookups can skip the lock when there is nothing to do.
+  std::atomic<bool> HasSectionsToIndexByProtocol{false};
+  std::atomic<bool> HasSectionsToIndexByTypeName{false};
+
+  /// Incremented whenever new conformance records are registered.
+  /// Negative results in the per-thread front cache are only valid
+  /// while this is unchanged.
+  std::atomic<uintptr_t> RegistrationGeneration{0};
   
   ConformanceState() {
     SectionsToScan.reserve(16);
+    RecordsByTypeNameStatistics =
+      createMetadataCacheStatistics("TypeNameIndex", &RecordsByTypeName);
+
+    const char *lazy = getenv("SWIFT_RUNTIME_LAZY_CONFORMANCE_INDEXING");
+    LazyIndexing = lazy && lazy[0] == '1';
+
+    ScanningTimer timer(ScanningStatistics.InspectNanoseconds);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
 #else
@@ -255,6 +371,48 @@ struct ConformanceState {
 #endif
   }
 
+  /// Add the records of any sections registered since the last call to
+  /// RecordsByProtocol. Must be called with SectionsToScanLock held.
+  void indexSectionsByProtocol() {
+    if (NumSectionsIndexedByProtocol == SectionsToScan.size())
+      return;
+
+    ScanningTimer timer(ScanningStatistics.ProtocolIndexNanoseconds);
+    for (; NumSectionsIndexedByProtocol < SectionsToScan.size();
+         ++NumSectionsIndexedByProtocol) {
+      auto &section = SectionsToScan[NumSectionsIndexedByProtocol];
+      ConformanceIndexEntry *lastEntry = nullptr;
+      for (auto &record : section) {
+        auto proto = record.getProtocol();
+        // Records for the same protocol tend to be adjacent; skip the lookup.
+        if (!lastEntry || lastEntry->compareWithKey(proto) != 0)
+          lastEntry = RecordsByProtocol.getOrInsert(proto).first;
+        lastEntry->addRecord(&record);
+      }
+    }
+    HasSectionsToIndexByProtocol.store(false, std::memory_order_release);
+  }
+
+  /// Add the records of any sections registered since the last call to
+  /// RecordsByTypeName. Must be called with SectionsToScanLock held.
+  void indexSectionsByTypeName();
+
+  /// Make RecordsByProtocol cover every registered section.
+  void ensureIndexedByProtocol() {
+    if (!HasSectionsToIndexByProtocol.load(std::memory_order_acquire))
+      return;
+    ScopedLock guard(SectionsToScanLock);
+    indexSectionsByProtocol();
+  }
+
+  /// Make RecordsByTypeName cover every registered section.
+  void ensureIndexedByTypeName() {
+    if (!HasSectionsToIndexByTypeName.load(std::memory_order_acquire))
+      return;
+    ScopedLock guard(SectionsToScanLock);
+    indexSectionsByTypeName();
+  }
+
   void cacheSuccess(const void *type, const ProtocolDescriptor *proto,
                     const WitnessTable *witness) {
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
@@ -266,8 +424,17 @@ struct ConformanceState {
     }
   }
 
+  /// Return the number of registered records conforming to \p proto.
+  /// Negative cache entries remember this count, so they stay valid until
+  /// an image adding a conformance to the same protocol is loaded.
+  size_t getNumRecords(const ProtocolDescriptor *proto) {
+    if (auto *entry = RecordsByProtocol.find(proto))
+      return entry->getNumRecords();
+    return 0;
+  }
+
   void cacheFailure(const void *type, const ProtocolDescriptor *proto) {
-    uintptr_t failureGeneration = SectionsToScan.size();
+    uintptr_t failureGeneration = getNumRecords(proto);
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
                                     (const WitnessTable *) nullptr,
                                     failureGeneration);
@@ -286,12 +453,94 @@ struct ConformanceState {
 
 static Lazy<ConformanceState> Conformances;
 
+/// The nominal type descriptor of the conforming type of a record, if there
+/// is a single one.
+static const NominalTypeDescriptor *
+_getConformingTypeDescriptor(const ProtocolConformanceRecord &record) {
+  switch (record.getTypeKind()) {
+  case TypeMetadataRecordKind::UniqueDirectType:
+  case TypeMetadataRecordKind::NonuniqueDirectType:
+    return record.getDirectType()->getNominalTypeDescriptor();
+  case TypeMetadataRecordKind::UniqueIndirectClass:
+    // The class may be weak-linked.
+    if (auto cls = *record.getIndirectClass())
+      return cls->getNominalTypeDescriptor();
+    return nullptr;
+  case TypeMetadataRecordKind::UniqueDirectClass:
+    if (auto cls = record.getDirectClass())
+      return cls->getNominalTypeDescriptor();
+    return nullptr;
+  case TypeMetadataRecordKind::UniqueNominalTypeDescriptor:
+    return record.getNominalTypeDescriptor();
+  case TypeMetadataRecordKind::Universal:
+    return nullptr;
+  }
+}
+
+void ConformanceState::indexSectionsByTypeName() {
+  if (NumSectionsIndexedByTypeName == SectionsToScan.size())
+    return;
+
+  // Resolving the conforming type touches every type's descriptor, which is
+  // the expensive part of indexing an image.
+  ScanningTimer timer(ScanningStatistics.NameIndexNanoseconds);
+  for (; NumSectionsIndexedByTypeName < SectionsToScan.size();
+       ++NumSectionsIndexedByTypeName) {
+    for (auto &record : SectionsToScan[NumSectionsIndexedByTypeName]) {
+      // The first record registered for a type wins.
+      auto ntd = _getConformingTypeDescriptor(record);
+      if (!ntd)
+        continue;
+      if (RecordsByTypeName.getOrInsert(llvm::StringRef(ntd->Name.get()),
+                                        &record).second)
+        RecordsByTypeNameStatistics->Inserts.fetch_add(
+                                              1, std::memory_order_relaxed);
+    }
+  }
+  HasSectionsToIndexByTypeName.store(false, std::memory_order_release);
+}
+
 static void
 _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *begin,
                               const ProtocolConformanceRecord *end) {
   ScopedLock guard(C.SectionsToScanLock);
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  ScanningStatistics.Sections.fetch_add(1, std::memory_order_relaxed);
+  ScanningStatistics.Records.fetch_add(end - begin, std::memory_order_relaxed);
+
+  // In lazy mode, leave the new records for the first lookup to index.
+  // Otherwise index them now; only the records of this image are visited,
+  // since previously registered images are already indexed.
+  if (C.LazyIndexing) {
+    C.HasSectionsToIndexByProtocol.store(true, std::memory_order_release);
+    C.HasSectionsToIndexByTypeName.store(true, std::memory_order_release);
+  } else {
+    C.indexSectionsByProtocol();
+    C.indexSectionsByTypeName();
+  }
+
+  C.RegistrationGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void swift::_dumpImageScanningStatistics() {
+  auto microseconds = [](const std::atomic<uint64_t> &nanoseconds) {
+    return (unsigned long long)
+      (nanoseconds.load(std::memory_order_relaxed) / 1000);
+  };
+
+  fprintf(stderr, "\nconformance image scanning:\n");
+  fprintf(stderr, "%-26s %12llu sections %12llu records\n", "registered",
+          (unsigned long long)
+            ScanningStatistics.Sections.load(std::memory_order_relaxed),
+          (unsigned long long)
+            ScanningStatistics.Records.load(std::memory_order_relaxed));
+  fprintf(stderr, "%-26s %12llu us\n", "startup inspection",
+          microseconds(ScanningStatistics.InspectNanoseconds));
+  fprintf(stderr, "%-26s %12llu us\n", "protocol indexing",
+          microseconds(ScanningStatistics.ProtocolIndexNanoseconds));
+  fprintf(stderr, "%-26s %12llu us\n", "type name indexing",
+          microseconds(ScanningStatistics.NameIndexNanoseconds));
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -472,7 +721,7 @@ recur_inside_cache_lock:
         foundEntry = Value;
 
       // If we got a cached negative response, check the generation number.
-      if (Value->getFailureGeneration() == C.SectionsToScan.size()) {
+      if (Value->getFailureGeneration() == C.getNumRecords(protocol)) {
         // We found an entry with a negative value.
         return std::make_pair(nullptr, true);
       }
@@ -543,19 +792,21 @@ bool isRelatedType(const Metadata *type, const void *candidate,
   return false;
 }
 
-const WitnessTable *
-swift::swift_conformsToProtocol(const Metadata *type,
-                                const ProtocolDescriptor *protocol) {
-  auto &C = Conformances.get();
+static const WitnessTable *
+_conformsToProtocolSlow(ConformanceState &C, const Metadata *type,
+                        const ProtocolDescriptor *protocol) {
   auto origType = type;
-  unsigned numSections = 0;
+  size_t numRecords = 0;
   ConformanceCacheEntry *foundEntry;
 
+  // Negative cache entries are checked against the size of the index, so
+  // it has to be up to date before the cache is consulted.
+  C.ensureIndexedByProtocol();
+
 recur:
   // See if we have a cached conformance. The ConcurrentMap data structure
   // allows us to insert and search the map concurrently without locking.
-  // We do lock the slow path because the SectionsToScan data structure is not
-  // concurrent.
+  // We do lock the slow path because the record index is not concurrent.
   auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
   // The negative answer does not always mean that there is no conformance,
   // unless it is an exact match on the type. If it is not an exact match,
@@ -566,13 +817,17 @@ recur:
       return FoundConformance.first;
   }
 
-  // If we didn't have an up-to-date cache entry, scan the conformance records.
+  // If we didn't have an up-to-date cache entry, scan the conformance records
+  // registered for this protocol.
   C.SectionsToScanLock.lock();
+  C.indexSectionsByProtocol();
   unsigned failedGeneration = ConformanceCacheGeneration;
+  auto *indexEntry = C.RecordsByProtocol.find(protocol);
+  size_t endRecordIdx = indexEntry ? indexEntry->Records.size() : 0;
 
   // If we have no new information to pull in (and nobody else pulled in
   // new information while we waited on the lock), we're done.
-  if (C.SectionsToScan.size() == numSections) {
+  if (endRecordIdx == numRecords) {
     if (failedGeneration != ConformanceCacheGeneration) {
       // Someone else pulled in new conformances while we were waiting.
       // Start over with our newly-populated cache.
@@ -589,59 +844,47 @@ recur:
     return nullptr;
   }
 
-  // Update the last known number of sections to scan.
-  numSections = C.SectionsToScan.size();
+  // Update the last known number of records to scan.
+  numRecords = endRecordIdx;
 
-  // Scan only sections that were not scanned yet.
-  unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
+  // Scan only records that were not scanned yet.
+  size_t recordIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
+
+  for (; recordIdx < endRecordIdx; ++recordIdx) {
+    const auto &record = *indexEntry->Records[recordIdx];
+    assert(record.getProtocol() == protocol && "misindexed conformance");
 
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
     // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
-      // If the record applies to a specific type, cache it.
-      if (auto metadata = record.getCanonicalTypeMetadata()) {
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, metadata, /*isMetadata=*/true))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        auto witness = record.getWitnessTable(metadata);
-        if (witness) {
-          C.cacheSuccess(metadata, P, witness);
-        } else {
-          C.cacheFailure(metadata, P);
-        }
-
-      // If the record provides a nondependent witness table for all instances
-      // of a generic type, cache it for the generic pattern.
-      // TODO: "Nondependent witness table" probably deserves its own flag.
-      // An accessor function might still be necessary even if the witness table
-      // can be shared.
-      } else if (record.getTypeKind()
-                   == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
-                 && record.getConformanceKind()
-                   == ProtocolConformanceReferenceKind::WitnessTable) {
-
-        auto R = record.getNominalTypeDescriptor();
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, R, /*isMetadata=*/false))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        C.cacheSuccess(R, P, record.getStaticWitnessTable());
+    // If the record applies to a specific type, cache it.
+    if (auto metadata = record.getCanonicalTypeMetadata()) {
+      if (!isRelatedType(type, metadata, /*isMetadata=*/true))
+        continue;
+
+      // Store the type-protocol pair in the cache.
+      auto witness = record.getWitnessTable(metadata);
+      if (witness) {
+        C.cacheSuccess(metadata, protocol, witness);
+      } else {
+        C.cacheFailure(metadata, protocol);
       }
+
+    // If the record provides a nondependent witness table for all instances
+    // of a generic type, cache it for the generic pattern.
+    // TODO: "Nondependent witness table" probably deserves its own flag.
+    // An accessor function might still be necessary even if the witness table
+    // can be shared.
+    } else if (record.getTypeKind()
+                 == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
+               && record.getConformanceKind()
+                 == ProtocolConformanceReferenceKind::WitnessTable) {
+
+      auto R = record.getNominalTypeDescriptor();
+
+      if (!isRelatedType(type, R, /*isMetadata=*/false))
+        continue;
+
+      // Store the type-protocol pair in the cache.
+      C.cacheSuccess(R, protocol, record.getStaticWitnessTable());
     }
   }
   ++ConformanceCacheGeneration;
@@ -652,30 +895,73 @@ recur:
   goto recur;
 }
 
-const Metadata *
-swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
+namespace {
+  /// An entry in the per-thread conformance front cache.
+  struct ConformanceFrontCacheEntry {
+    const Metadata *Type;
+    const ProtocolDescriptor *Proto;
+    const WitnessTable *Table;
+    /// The registration generation at which a negative result was computed.
+    /// Ignored for positive results, which never become stale.
+    uintptr_t Generation;
+  };
+
+  /// The number of entries in the per-thread front cache. Must be a power
+  /// of two.
+  enum : size_t { ConformanceFrontCacheSize = 64 };
+}
+
+/// A small direct-mapped cache of recent conformance queries made on this
+/// thread. Hits are answered without touching any shared cache lines.
+static SWIFT_THREAD_LOCAL
+ConformanceFrontCacheEntry ConformanceFrontCache[ConformanceFrontCacheSize];
+
+static inline ConformanceFrontCacheEntry &
+getConformanceFrontCacheEntry(const Metadata *type,
+                              const ProtocolDescriptor *protocol) {
+  // Metadata and protocol descriptors are pointer-aligned, so drop the
+  // low bits before mixing.
+  uintptr_t hash = (uintptr_t(type) >> 4) ^ (uintptr_t(protocol) >> 3);
+  return ConformanceFrontCache[hash & (ConformanceFrontCacheSize - 1)];
+}
+
+const WitnessTable *
+swift::swift_conformsToProtocol(const Metadata *type,
+                                const ProtocolDescriptor *protocol) {
+  SWIFT_RUNTIME_COUNT(ConformanceLookups, 1);
   auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
+  auto &frontEntry = getConformanceFrontCacheEntry(type, protocol);
 
-  ScopedLock guard(C.SectionsToScanLock);
+  // Read the generation before doing the lookup, so that a registration
+  // racing with the lookup invalidates the negative result we store.
+  uintptr_t generation =
+    C.RegistrationGeneration.load(std::memory_order_acquire);
 
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
+  if (frontEntry.Type == type && frontEntry.Proto == protocol &&
+      (frontEntry.Table || frontEntry.Generation == generation))
+    return frontEntry.Table;
 
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
+  auto table = _conformsToProtocolSlow(C, type, protocol);
+  frontEntry = ConformanceFrontCacheEntry{type, protocol, table, generation};
+  return table;
+}
 
-      if (foundMetadata != nullptr)
-        break;
-    }
-    if (foundMetadata != nullptr)
-      break;
-  }
+uintptr_t swift::_getProtocolConformanceGeneration() {
+  return Conformances.get().RegistrationGeneration.load(
+                                                    std::memory_order_acquire);
+}
+
+const Metadata *
+swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
+  auto &C = Conformances.get();
+  C.ensureIndexedByTypeName();
+
+  C.RecordsByTypeNameStatistics->Lookups.fetch_add(1,
+                                                   std::memory_order_relaxed);
+  auto found = C.RecordsByTypeName.find(typeName);
+  if (!found)
+    return nullptr;
 
-  return foundMetadata;
+  C.RecordsByTypeNameStatistics->Hits.fetch_add(1, std::memory_order_relaxed);
+  return _resolveMangledTypeNameRecord(typeName, *found->getRecord());
 }
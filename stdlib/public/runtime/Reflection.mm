@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Reflection.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
@@ -451,16 +453,144 @@ void swift_TupleMirror_subscript(String *outString,
   new (outMirror) Mirror(reflect(owner, eltData, elt.Type));
 }
   
-// Get a field name from a doubly-null-terminated list.
-static const char *getFieldName(const char *fieldNames, size_t i) {
+// -- Decoded field cache.
+
+/// A stored property of a struct or class, or a case of an enum, decoded
+/// from the type's metadata and nominal type descriptor.
+struct FieldInfo {
+  const char *Name;
+  size_t NameLength;
+  /// The type of the property. Not recorded for enum cases.
+  FieldType Type;
+  /// The offset of the property in the instance. Not recorded for enum
+  /// cases.
+  uintptr_t Offset;
+};
+
+/// The decoded fields of a type. Programs tend to reflect over the same
+/// types many times, so the packed field name list is split and the field
+/// type accessor called once per type metadata, and mirror child accesses
+/// just index into the field array.
+class FieldInfoCacheEntry {
+  const Metadata *Type;
+  size_t NumFields;
+
+  FieldInfo *getFieldBuffer() {
+    return reinterpret_cast<FieldInfo *>(this + 1);
+  }
+
+public:
+  FieldInfoCacheEntry(const Metadata *type, size_t numFields);
+
+  int compareWithKey(const Metadata *key) const {
+    if (key != Type)
+      return (uintptr_t(key) < uintptr_t(Type) ? -1 : 1);
+    return 0;
+  }
+
+  static size_t getExtraAllocationSize(const Metadata *type,
+                                       size_t numFields) {
+    return numFields * sizeof(FieldInfo);
+  }
+
+  const FieldInfo &getField(size_t i) const {
+    assert(i < NumFields && "field index out of range");
+    return reinterpret_cast<const FieldInfo *>(this + 1)[i];
+  }
+};
+
+// Split a doubly-null-terminated list of names into the first \p numFields
+// entries of \p fields.
+static void splitFieldNames(const char *fieldNames, FieldInfo *fields,
+                            size_t numFields) {
   const char *fieldName = fieldNames;
-  for (size_t j = 0; j < i; ++j) {
+  for (size_t i = 0; i < numFields; ++i) {
     size_t len = strlen(fieldName);
     assert(len != 0);
+    fields[i].Name = fieldName;
+    fields[i].NameLength = len;
     fieldName += len + 1;
   }
+}
 
-  return fieldName;
+FieldInfoCacheEntry::FieldInfoCacheEntry(const Metadata *type,
+                                         size_t numFields)
+  : Type(type), NumFields(numFields) {
+  auto fields = getFieldBuffer();
+  for (size_t i = 0; i < numFields; ++i)
+    ::new (&fields[i]) FieldInfo{nullptr, 0, FieldType(), 0};
+
+  switch (type->getKind()) {
+  case MetadataKind::Struct: {
+    auto Struct = static_cast<const StructMetadata *>(type);
+    splitFieldNames(Struct->Description->Struct.FieldNames, fields, numFields);
+
+    // Load the types and offsets from their respective vectors.
+    auto fieldTypes = Struct->getFieldTypes();
+    auto fieldOffsets = Struct->getFieldOffsets();
+    for (size_t i = 0; i < numFields; ++i) {
+      fields[i].Type = fieldTypes[i];
+      fields[i].Offset = fieldOffsets[i];
+    }
+    break;
+  }
+
+  case MetadataKind::Class: {
+    auto Clas = static_cast<const ClassMetadata *>(type);
+    splitFieldNames(Clas->getDescription()->Class.FieldNames, fields,
+                    numFields);
+
+    auto fieldTypes = Clas->getFieldTypes();
+    for (size_t i = 0; i < numFields; ++i)
+      fields[i].Type = fieldTypes[i];
+
+    // FIXME: If the class has ObjC heritage, get the field offset using the
+    // ObjC metadata, because we don't update the field offsets in the face
+    // of resilient base classes.
+    if (usesNativeSwiftReferenceCounting(Clas)) {
+      auto fieldOffsets = Clas->getFieldOffsets();
+      for (size_t i = 0; i < numFields; ++i)
+        fields[i].Offset = fieldOffsets[i];
+    } else {
+#if SWIFT_OBJC_INTEROP
+      Ivar *ivars = class_copyIvarList((Class)Clas, nullptr);
+      for (size_t i = 0; i < numFields; ++i)
+        fields[i].Offset = ivar_getOffset(ivars[i]);
+      free(ivars);
+#else
+      swift::crash("Object appears to be Objective-C, but no runtime.");
+#endif
+    }
+    break;
+  }
+
+  case MetadataKind::Enum:
+  case MetadataKind::Optional: {
+    auto Enum = static_cast<const EnumMetadata *>(type);
+    splitFieldNames(Enum->Description->Enum.CaseNames, fields, numFields);
+    break;
+  }
+
+  default:
+    swift::crash("Swift mirror field lookup on a type without fields");
+  }
+}
+
+/// The decoded fields of every type that has been reflected over. The map
+/// is insert-only, so lookups take no lock.
+static Lazy<ConcurrentMap<FieldInfoCacheEntry>> FieldInfoCache;
+
+/// Get the decoded fields of \p type, which has \p numFields stored
+/// properties or cases.
+static const FieldInfoCacheEntry &getFieldInfo(const Metadata *type,
+                                               size_t numFields) {
+  auto &cache = FieldInfoCache.get();
+  if (auto found = cache.find(type))
+    return *found;
+
+  // If another thread races us to insert the entry, getOrInsert hands back
+  // the winner's entry and we discard ours.
+  return *cache.getOrInsert(type, numFields).first;
 }
 
 // -- Struct destructuring.
@@ -485,21 +615,20 @@ void swift_StructMirror_subscript(String *outString,
                                   const Metadata *type) {
   auto Struct = static_cast<const StructMetadata *>(type);
   
-  if (i < 0 || (size_t)i > Struct->Description->Struct.NumFields)
+  auto numFields = Struct->Description->Struct.NumFields;
+  if (i < 0 || (size_t)i >= numFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
-  // Load the type and offset from their respective vectors.
-  auto fieldType = Struct->getFieldTypes()[i];
-  auto fieldOffset = Struct->getFieldOffsets()[i];
+  auto &field = getFieldInfo(type, numFields).getField(i);
   
   auto bytes = reinterpret_cast<const char*>(value);
-  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
+  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + field.Offset);
 
-  new (outString) String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  new (outString) String(field.Name, field.NameLength);
 
   // 'owner' is consumed by this call.
-  assert(!fieldType.isIndirect() && "indirect struct fields not implemented");
-  new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
+  assert(!field.Type.isIndirect() && "indirect struct fields not implemented");
+  new (outMirror) Mirror(reflect(owner, fieldData, field.Type.getType()));
 }
 
 // -- Enum destructuring.
@@ -566,7 +695,7 @@ const char *swift_EnumMirror_caseName(HeapObject *owner,
 
   swift_release(owner);
 
-  return getFieldName(Description.CaseNames, tag);
+  return getFieldInfo(type, Description.getNumCases()).getField(tag).Name;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -649,7 +778,8 @@ void swift_EnumMirror_subscript(String *outString,
     swift_release(pair.first);
   }
 
-  new (outString) String(getFieldName(Description.CaseNames, tag));
+  auto &caseInfo = getFieldInfo(type, Description.getNumCases()).getField(tag);
+  new (outString) String(caseInfo.Name, caseInfo.NameLength);
   new (outMirror) Mirror(reflect(owner, value, payloadType));
 }
   
@@ -701,36 +831,20 @@ void swift_ClassMirror_subscript(String *outString,
     --i;
   }
   
-  if (i < 0 || (size_t)i > Clas->getDescription()->Class.NumFields)
+  auto numFields = Clas->getDescription()->Class.NumFields;
+  if (i < 0 || (size_t)i >= numFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
-  // Load the type and offset from their respective vectors.
-  auto fieldType = Clas->getFieldTypes()[i];
-  assert(!fieldType.isIndirect()
+  auto &field = getFieldInfo(type, numFields).getField(i);
+  assert(!field.Type.isIndirect()
          && "class indirect properties not implemented");
   
-  // FIXME: If the class has ObjC heritage, get the field offset using the ObjC
-  // metadata, because we don't update the field offsets in the face of
-  // resilient base classes.
-  uintptr_t fieldOffset;
-  if (usesNativeSwiftReferenceCounting(Clas)) {
-    fieldOffset = Clas->getFieldOffsets()[i];
-  } else {
-#if SWIFT_OBJC_INTEROP
-    Ivar *ivars = class_copyIvarList((Class)Clas, nullptr);
-    fieldOffset = ivar_getOffset(ivars[i]);
-    free(ivars);
-#else
-    swift::crash("Object appears to be Objective-C, but no runtime.");
-#endif
-  }
-  
   auto bytes = *reinterpret_cast<const char * const*>(value);
-  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
+  auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + field.Offset);
   
-  new (outString) String(getFieldName(Clas->getDescription()->Class.FieldNames, i));
+  new (outString) String(field.Name, field.NameLength);
   // 'owner' is consumed by this call.
-  new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
+  new (outMirror) Mirror(reflect(owner, fieldData, field.Type.getType()));
 }
   
 // -- Mirror witnesses for ObjC classes.
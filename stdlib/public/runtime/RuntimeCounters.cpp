@@ -0,0 +1,50 @@
+//===--- RuntimeCounters.cpp - Event counters for benchmarks --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The blocks of counters of all threads are kept in a list that is never
+// shrunk, so the events of threads that have exited still count.
+//
+//===----------------------------------------------------------------------===//
+
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+
+#include "RuntimeCounters.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
+
+using namespace swift;
+
+SWIFT_THREAD_LOCAL RuntimeCounterBlock *swift::_runtimeCounterBlock = nullptr;
+
+static Lazy<ConcurrentList<RuntimeCounterBlock *>> AllCounterBlocks;
+
+RuntimeCounterBlock *swift::_createRuntimeCounterBlock() {
+  auto block = new RuntimeCounterBlock();
+  for (auto &value : block->Values)
+    value.store(0, std::memory_order_relaxed);
+  AllCounterBlocks->push_front(block);
+  _runtimeCounterBlock = block;
+  return block;
+}
+
+size_t swift_runtimeCounters_read(uint64_t *values, size_t count) {
+  const size_t numCounters = size_t(RuntimeCounter::NumCounters);
+  for (size_t i = 0; i < count && i < numCounters; ++i)
+    values[i] = 0;
+  for (auto block : *AllCounterBlocks) {
+    for (size_t i = 0; i < count && i < numCounters; ++i)
+      values[i] += block->Values[i].load(std::memory_order_relaxed);
+  }
+  return numCounters;
+}
+
+#endif
@@ -0,0 +1,79 @@
+//===--- RuntimeCounters.h - Event counters for benchmarks ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts of runtime events, such as retains, releases and allocations, for
+// benchmarks to read before and after they run. They are only built into the
+// runtime with SWIFT_RUNTIME_ENABLE_COUNTERS. Each thread counts into its own
+// block of counters without atomic read-modify-write operations, and a read
+// sums the blocks of all threads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_STDLIB_RUNTIME_RUNTIMECOUNTERS_H
+#define SWIFT_STDLIB_RUNTIME_RUNTIMECOUNTERS_H
+
+#if SWIFT_RUNTIME_ENABLE_COUNTERS
+
+#include "swift/Runtime/Config.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace swift {
+
+/// The events that are counted, in the order swift_runtimeCounters_read
+/// reports them.
+enum class RuntimeCounter : unsigned {
+  Retains,
+  Releases,
+  Allocations,
+  AllocatedBytes,
+  MetadataInstantiations,
+  ConformanceLookups,
+  NumCounters
+};
+
+/// The counters of one thread. Only their thread writes them, so updates are
+/// relaxed loads and stores, which other threads may read at any time.
+struct RuntimeCounterBlock {
+  std::atomic<uint64_t> Values[unsigned(RuntimeCounter::NumCounters)];
+};
+
+/// This thread's counters, or null if it has not counted anything yet.
+extern SWIFT_THREAD_LOCAL RuntimeCounterBlock *_runtimeCounterBlock;
+
+/// Create and register this thread's counters.
+RuntimeCounterBlock *_createRuntimeCounterBlock();
+
+static inline void _incrementRuntimeCounter(RuntimeCounter counter,
+                                            uint64_t n) {
+  auto block = _runtimeCounterBlock;
+  if (!block)
+    block = _createRuntimeCounterBlock();
+  auto &value = block->Values[unsigned(counter)];
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+}
+
+/// Write the totals of the first \p count counters, summed over all threads,
+/// to \p values, and return the number of counters there are.
+SWIFT_RUNTIME_EXPORT
+extern "C" size_t swift_runtimeCounters_read(uint64_t *values, size_t count);
+
+#define SWIFT_RUNTIME_COUNT(counter, n)                                        \
+  swift::_incrementRuntimeCounter(swift::RuntimeCounter::counter, n)
+#else
+#define SWIFT_RUNTIME_COUNT(counter, n) do {} while (0)
+#endif
+
+#endif
@@ -78,6 +78,10 @@ struct SwiftObject_s {
   void *isa __attribute__((__unavailable__));
   uint32_t strongRefCount __attribute__((__unavailable__));
   uint32_t weakRefCount __attribute__((__unavailable__));
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  uint32_t biasedOwner __attribute__((__unavailable__));
+  int32_t biasedRefCount __attribute__((__unavailable__));
+#endif
 };
 
 static_assert(sizeof(SwiftObject_s) == sizeof(HeapObject),
@@ -1395,6 +1399,10 @@ bool swift::swift_isUniquelyReferenced_nonNull_native(
 ) SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(object != nullptr);
   assert(!object->refCount.isDeallocating());
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  if (object->refCount.isBiased())
+    return _swift_isUniquelyReferencedBiased(object);
+#endif
   return object->refCount.isUniquelyReferenced();
 }
 
@@ -1505,6 +1513,11 @@ bool swift::swift_isUniquelyReferencedOrPinned_nonNull_native(
   SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(object != nullptr);
   assert(!object->refCount.isDeallocating());
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  if (object->refCount.isBiased())
+    return object->refCount.isPinned()
+        || _swift_isUniquelyReferencedBiased(object);
+#endif
   return object->refCount.isUniquelyReferencedOrPinned();
 }
 
@@ -64,19 +64,51 @@ static long double swift_strtold_l(const char *nptr,
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
 
+/// The decimal digits of 00 through 99.
+static const char DecimalDigitPairs[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536"
+  "37383940414243444546474849505152535455565758596061626364656667686970717273"
+  "7475767778798081828384858687888990919293949596979899";
+
+/// Write \p Value in decimal, two digits per division, and return the
+/// number of characters written.
+static uint64_t uint64ToDecimalString(char *Buffer, uint64_t Value,
+                                      bool Negative) {
+  char Digits[20];
+  char *P = Digits + sizeof(Digits);
+  while (Value >= 100) {
+    unsigned Pair = unsigned(Value % 100) * 2;
+    Value /= 100;
+    *--P = DecimalDigitPairs[Pair + 1];
+    *--P = DecimalDigitPairs[Pair];
+  }
+  if (Value >= 10) {
+    unsigned Pair = unsigned(Value) * 2;
+    *--P = DecimalDigitPairs[Pair + 1];
+    *--P = DecimalDigitPairs[Pair];
+  } else {
+    *--P = '0' + char(Value);
+  }
+
+  char *Out = Buffer;
+  if (Negative)
+    *Out++ = '-';
+  size_t Length = Digits + sizeof(Digits) - P;
+  memcpy(Out, P, Length);
+  return size_t(Out - Buffer) + Length;
+}
+
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
                                    bool Negative) {
+  if (Radix == 10)
+    return uint64ToDecimalString(Buffer, Value, Negative);
+
   char *P = Buffer;
   uint64_t Y = Value;
 
   if (Y == 0) {
     *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
-    }
   } else {
     unsigned Radix32 = Radix;
     while (Y) {
@@ -174,6 +206,297 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+namespace {
+
+/// An unnormalized floating-point number with a 64-bit significand:
+/// F * 2^E.
+struct DiyFp {
+  uint64_t F;
+  int E;
+
+  DiyFp(uint64_t F, int E) : F(F), E(E) {}
+
+  DiyFp operator-(const DiyFp &rhs) const {
+    return DiyFp(F - rhs.F, E);
+  }
+
+  /// The upper 64 bits of the product, rounded.
+  DiyFp operator*(const DiyFp &rhs) const {
+    const uint64_t M32 = 0xFFFFFFFFu;
+    uint64_t a = F >> 32, b = F & M32, c = rhs.F >> 32, d = rhs.F & M32;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32) + (1U << 31);
+    return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), E + rhs.E + 64);
+  }
+
+  DiyFp normalize() const {
+    int shift = __builtin_clzll(F);
+    return DiyFp(F << shift, E - shift);
+  }
+};
+
+/// The layout of an IEEE binary floating-point type.
+template <typename T> struct FloatLayout;
+template <> struct FloatLayout<float> {
+  using Bits = uint32_t;
+  static const int SignificandBits = 23;
+  static const int ExponentBias = 127 + SignificandBits;
+};
+template <> struct FloatLayout<double> {
+  using Bits = uint64_t;
+  static const int SignificandBits = 52;
+  static const int ExponentBias = 1023 + SignificandBits;
+};
+
+/// 10^K for K from -348 to 340 in steps of 8, normalized.
+const uint64_t CachedPowersF[] = {
+  0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76,
+  0xcf42894a5dce35ea, 0x9a6bb0aa55653b2d, 0xe61acf033d1a45df,
+  0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f, 0xbe5691ef416bd60c,
+  0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+  0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57,
+  0xc21094364dfb5637, 0x9096ea6f3848984f, 0xd77485cb25823ac7,
+  0xa086cfcd97bf97f4, 0xef340a98172aace5, 0xb23867fb2a35b28e,
+  0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+  0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126,
+  0xb5b5ada8aaff80b8, 0x87625f056c7c4a8b, 0xc9bcff6034c13053,
+  0x964e858c91ba2655, 0xdff9772470297ebd, 0xa6dfbd9fb8e5b88f,
+  0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+  0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06,
+  0xaa242499697392d3, 0xfd87b5f28300ca0e, 0xbce5086492111aeb,
+  0x8cbccc096f5088cc, 0xd1b71758e219652c, 0x9c40000000000000,
+  0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+  0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068,
+  0x9f4f2726179a2245, 0xed63a231d4c4fb27, 0xb0de65388cc8ada8,
+  0x83c7088e1aab65db, 0xc45d1df942711d9a, 0x924d692ca61be758,
+  0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+  0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d,
+  0x952ab45cfa97a0b3, 0xde469fbd99a05fe3, 0xa59bc234db398c25,
+  0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece, 0x88fcf317f22241e2,
+  0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+  0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410,
+  0x8bab8eefb6409c1a, 0xd01fef10a657842c, 0x9b10a4e5e9913129,
+  0xe7109bfba19c0c9d, 0xac2820d9623bf429, 0x80444b5e7aa7cf85,
+  0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+  0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b
+};
+const int16_t CachedPowersE[] = {
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+  -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+  -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+  -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+  -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+  109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+  375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+  641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+  907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/// Return a cached power of ten c = 10^-K such that the product of c and
+/// a normalized DiyFp with exponent \p e has an exponent in [-60, -32].
+DiyFp getCachedPower(int e, int &K) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int k = int(dk);
+  if (dk - k > 0.0)
+    ++k;
+  unsigned index = unsigned((k >> 3) + 1);
+  K = -(-348 + int(index) * 8);
+  return DiyFp(CachedPowersF[index], CachedPowersE[index]);
+}
+
+/// Move the last digit of \p buffer towards the value while it stays in
+/// the rounding interval.
+void roundWeed(char *buffer, int length, uint64_t delta, uint64_t rest,
+               uint64_t tenKappa, uint64_t distance) {
+  while (rest < distance && delta - rest >= tenKappa &&
+         (rest + tenKappa < distance ||
+          distance - rest > rest + tenKappa - distance)) {
+    buffer[length - 1]--;
+    rest += tenKappa;
+  }
+}
+
+int countDecimalDigits(uint32_t n) {
+  int digits = 1;
+  while (n >= 10) {
+    n /= 10;
+    ++digits;
+  }
+  return digits;
+}
+
+/// Generate the digits of a number in [low, high], as close to \p w as
+/// possible. \p delta is high - low.
+void generateDigits(const DiyFp &w, const DiyFp &high, uint64_t delta,
+                    char *buffer, int &length, int &K) {
+  static const uint32_t Pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  const DiyFp one(uint64_t(1) << -high.E, high.E);
+  const DiyFp distance = high - w;
+  uint32_t p1 = uint32_t(high.F >> -one.E);
+  uint64_t p2 = high.F & (one.F - 1);
+  int kappa = countDecimalDigits(p1);
+  length = 0;
+
+  while (kappa > 0) {
+    uint32_t digit = p1 / Pow10[kappa - 1];
+    p1 %= Pow10[kappa - 1];
+    if (digit || length)
+      buffer[length++] = char('0' + digit);
+    --kappa;
+    uint64_t rest = (uint64_t(p1) << -one.E) + p2;
+    if (rest <= delta) {
+      K += kappa;
+      roundWeed(buffer, length, delta, rest, uint64_t(Pow10[kappa]) << -one.E,
+                distance.F);
+      return;
+    }
+  }
+
+  while (true) {
+    p2 *= 10;
+    delta *= 10;
+    char digit = char(p2 >> -one.E);
+    if (digit || length)
+      buffer[length++] = char('0' + digit);
+    p2 &= one.F - 1;
+    --kappa;
+    if (p2 < delta) {
+      K += kappa;
+      int index = -kappa;
+      roundWeed(buffer, length, delta, p2, one.F,
+                distance.F * (index < 10 ? Pow10[index] : 0));
+      return;
+    }
+  }
+}
+
+/// Write the digits of a short decimal that converts back to \p value to
+/// \p buffer, using the Grisu2 algorithm. \p value must be finite and
+/// positive. The result is \p buffer[0..length) * 10^K.
+template <typename T>
+void shortestDigits(T value, char *buffer, int &length, int &K) {
+  using Layout = FloatLayout<T>;
+  typename Layout::Bits bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint64_t hiddenBit = uint64_t(1) << Layout::SignificandBits;
+  uint64_t significand = bits & (hiddenBit - 1);
+  int biasedExponent = int(bits >> Layout::SignificandBits);
+
+  DiyFp v(significand, 1 - Layout::ExponentBias);
+  if (biasedExponent != 0)
+    v = DiyFp(significand + hiddenBit, biasedExponent - Layout::ExponentBias);
+
+  // The boundaries of the values that round to v.
+  DiyFp high = DiyFp((v.F << 1) + 1, v.E - 1).normalize();
+  DiyFp low = v.F == hiddenBit ? DiyFp((v.F << 2) - 1, v.E - 2)
+                               : DiyFp((v.F << 1) - 1, v.E - 1);
+  low.F <<= low.E - high.E;
+  low.E = high.E;
+
+  const DiyFp power = getCachedPower(high.E, K);
+  const DiyFp w = v.normalize() * power;
+  DiyFp scaledHigh = high * power;
+  DiyFp scaledLow = low * power;
+  ++scaledLow.F;
+  --scaledHigh.F;
+  generateDigits(w, scaledHigh, scaledHigh.F - scaledLow.F, buffer, length,
+                 K);
+}
+
+/// Format \p value like printf's "%.*g" with std::numeric_limits<T>::digits10
+/// digits of precision, without going through the C library. Returns the
+/// length written, or 0 if the value needs the slow path.
+template <typename T>
+size_t formatShortFloat(char *buffer, T value) {
+  const int precision = std::numeric_limits<T>::digits10;
+  char *out = buffer;
+  if (std::signbit(value)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (value == 0) {
+    *out++ = '0';
+    return out - buffer;
+  }
+
+  // Subnormals have too little precision for the digits10 argument below.
+  if (value < std::numeric_limits<T>::min())
+    return 0;
+
+  char digits[32];
+  int length, K;
+  shortestDigits(value, digits, length, K);
+  while (length > 1 && digits[length - 1] == '0') {
+    --length;
+    ++K;
+  }
+
+  // Any decimal of at most digits10 digits that round-trips is also what
+  // the value rounds to at that precision, so it is what printf prints.
+  // Longer digit strings don't say how printf would round.
+  if (length > precision)
+    return 0;
+
+  int exponent = K + length - 1;
+  if (exponent < -4 || exponent >= precision) {
+    *out++ = digits[0];
+    if (length > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, length - 1);
+      out += length - 1;
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    unsigned magnitude = unsigned(exponent < 0 ? -exponent : exponent);
+    if (magnitude >= 100)
+      *out++ = char('0' + magnitude / 100);
+    *out++ = char('0' + magnitude / 10 % 10);
+    *out++ = char('0' + magnitude % 10);
+  } else if (exponent < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = -1; i > exponent; --i)
+      *out++ = '0';
+    memcpy(out, digits, length);
+    out += length;
+  } else if (length <= exponent + 1) {
+    memcpy(out, digits, length);
+    out += length;
+    for (int i = length; i <= exponent; ++i)
+      *out++ = '0';
+  } else {
+    memcpy(out, digits, exponent + 1);
+    out += exponent + 1;
+    *out++ = '.';
+    memcpy(out, digits + exponent + 1, length - exponent - 1);
+    out += length - exponent - 1;
+  }
+  return out - buffer;
+}
+
+/// There's no fast path for Float80.
+size_t formatShortFloat(char *buffer, long double value) {
+  return 0;
+}
+
+} // end anonymous namespace
+
+/// Add ".0" to a float that (a) is not in scientific notation, (b) does not
+/// already have a fractional part, (c) is not infinite, and (d) is not a NaN
+/// value.
+static uint64_t swift_addFractionalPart(char *Buffer, int i) {
+  if (strchr(Buffer, 'e') == nullptr && strchr(Buffer, '.') == nullptr &&
+      strchr(Buffer, 'n') == nullptr) {
+    Buffer[i++] = '.';
+    Buffer[i++] = '0';
+  }
+
+  return i;
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -181,6 +504,14 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   if (BufferLength < 32)
     swift::crash("swift_floatingPointToString: insufficient buffer size");
 
+  // Most values that 'description' prints have few enough digits to skip
+  // the C library and its locale switching.
+  int i = Debug ? 0 : int(formatShortFloat(Buffer, Value));
+  if (i != 0) {
+    Buffer[i] = '\0';
+    return swift_addFractionalPart(Buffer, i);
+  }
+
   int Precision = std::numeric_limits<T>::digits10;
   if (Debug) {
     Precision = std::numeric_limits<T>::max_digits10;
@@ -195,9 +526,9 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   ValueStream.imbue(std::locale::classic());
   ValueStream << Value;
   std::string ValueString(ValueStream.str());
-  size_t i = ValueString.length();
+  i = ValueString.length();
 
-  if (i < BufferLength) {
+  if (size_t(i) < BufferLength) {
     std::copy(ValueString.begin(), ValueString.end(), Buffer);
     Buffer[i] = '\0';
   } else {
@@ -205,8 +536,8 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   }
 #else
   // Pass a null locale to use the C locale.
-  int i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
-                           Precision, Value);
+  i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
+                       Precision, Value);
 
   if (i < 0)
     swift::crash(
@@ -215,16 +546,7 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
     swift::crash("swift_floatingPointToString: insufficient buffer size");
 #endif
 
-  // Add ".0" to a float that (a) is not in scientific notation, (b) does not
-  // already have a fractional part, (c) is not infinite, and (d) is not a NaN
-  // value.
-  if (strchr(Buffer, 'e') == nullptr && strchr(Buffer, '.') == nullptr &&
-      strchr(Buffer, 'n') == nullptr) {
-    Buffer[i++] = '.';
-    Buffer[i++] = '0';
-  }
-
-  return i;
+  return swift_addFractionalPart(Buffer, i);
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -379,12 +701,144 @@ __mulodi4(di_int a, di_int b, int* overflow)
 }
 #endif
 
+namespace {
+
+/// The limits of Clinger's fast path: an integer significand and a power of
+/// ten that are both exactly representable in T give a correctly rounded
+/// product or quotient.
+template <typename T> struct ExactDecimal;
+
+template <> struct ExactDecimal<float> {
+  static const uint64_t MaxSignificand = uint64_t(1) << 24;
+  static const int MaxExponent = 10;
+  static float getPowerOfTen(int E) {
+    static const float Powers[] = {
+      1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+    return Powers[E];
+  }
+};
+
+template <> struct ExactDecimal<double> {
+  static const uint64_t MaxSignificand = uint64_t(1) << 53;
+  static const int MaxExponent = 22;
+  static double getPowerOfTen(int E) {
+    static const double Powers[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    return Powers[E];
+  }
+};
+
+bool isDecimalDigit(char C) {
+  return C >= '0' && C <= '9';
+}
+
+/// Parse the plain decimal numbers that make up most input, such as "42",
+/// "-0.25" or "6.02e23", without going through the C library. Return the end
+/// of the number, or null to leave anything else (leading whitespace, hex
+/// floats, infinities and NaNs, long significands and large exponents) to
+/// strtod.
+template <typename T>
+const char *parseDecimalFast(const char *nptr, T *outResult) {
+  const char *P = nptr;
+  bool Negative = false;
+  if (*P == '-' || *P == '+')
+    Negative = *P++ == '-';
+
+  uint64_t Significand = 0;
+  int NumDigits = 0;
+  int Exponent = 0;
+  bool SawDigits = false;
+
+  // Leading zeros don't count against the significand's digits.
+  while (*P == '0') {
+    SawDigits = true;
+    ++P;
+  }
+  // Hex floats start with "0x".
+  if (*P == 'x' || *P == 'X')
+    return nullptr;
+  for (; isDecimalDigit(*P); ++P, ++NumDigits) {
+    SawDigits = true;
+    Significand = Significand * 10 + (*P - '0');
+    if (NumDigits >= 19)
+      return nullptr;
+  }
+  if (*P == '.') {
+    ++P;
+    if (Significand == 0) {
+      while (*P == '0') {
+        SawDigits = true;
+        --Exponent;
+        ++P;
+      }
+    }
+    for (; isDecimalDigit(*P); ++P, ++NumDigits) {
+      SawDigits = true;
+      Significand = Significand * 10 + (*P - '0');
+      --Exponent;
+      if (NumDigits >= 19)
+        return nullptr;
+    }
+  }
+  if (!SawDigits)
+    return nullptr;
+
+  if (*P == 'e' || *P == 'E') {
+    // A malformed exponent isn't part of the number.
+    const char *Q = P + 1;
+    bool NegativeExponent = false;
+    if (*Q == '-' || *Q == '+')
+      NegativeExponent = *Q++ == '-';
+    if (isDecimalDigit(*Q)) {
+      int ExplicitExponent = 0;
+      for (; isDecimalDigit(*Q); ++Q) {
+        if (ExplicitExponent > 1000)
+          return nullptr;
+        ExplicitExponent = ExplicitExponent * 10 + (*Q - '0');
+      }
+      Exponent += NegativeExponent ? -ExplicitExponent : ExplicitExponent;
+      P = Q;
+    }
+  }
+
+  typedef ExactDecimal<T> Limits;
+  T Result;
+  if (Significand == 0) {
+    Result = 0;
+  } else {
+    if (Significand > Limits::MaxSignificand ||
+        Exponent < -Limits::MaxExponent || Exponent > Limits::MaxExponent)
+      return nullptr;
+    Result = T(Significand);
+    if (Exponent < 0)
+      Result /= Limits::getPowerOfTen(-Exponent);
+    else
+      Result *= Limits::getPowerOfTen(Exponent);
+  }
+
+  *outResult = Negative ? -Result : Result;
+  return P;
+}
+
+/// There's no fast path for Float80.
+const char *parseDecimalFast(const char *nptr, long double *outResult) {
+  return nullptr;
+}
+
+} // end anonymous namespace
+
 #if defined(__CYGWIN__)
 // Cygwin does not support uselocale(), but we can use the locale feature 
 // in stringstream object.
 template <typename T>
 static const char *_swift_stdlib_strtoX_clocale_impl(
     const char *nptr, T *outResult) {
+  if (const char *End = parseDecimalFast(nptr, outResult))
+    return End;
+
   std::istringstream ValueStream(nptr);
   ValueStream.imbue(std::locale::classic());
   T ParsedValue;
@@ -422,6 +876,9 @@ static const char *_swift_stdlib_strtoX_clocale_impl(
     const char * nptr, T* outResult, T huge,
     T (*posixImpl)(const char *, char **, locale_t)
 ) {
+  if (const char *End = parseDecimalFast(nptr, outResult))
+    return End;
+
   char *EndPtr;
   errno = 0;
   const auto result = posixImpl(nptr, &EndPtr, getCLocale());
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <mutex>
 #include <assert.h>
+#include <string.h>
 
 #include <unicode/ustring.h>
 #include <unicode/ucol.h>
@@ -71,6 +72,33 @@ static const UCollator *GetRootCollator() {
 /// unicode.
 class ASCIICollation {
   int32_t CollationTable[128];
+
+  /// The weights of each level of the collation elements, so ASCII strings
+  /// can be compared one level at a time as ucol_strcoll does.
+  uint16_t PrimaryWeights[128];
+  uint8_t SecondaryWeights[128];
+  uint8_t TertiaryWeights[128];
+
+  /// Compare the nonzero weights of one level of two ASCII strings.
+  template <typename WeightType, typename LeftUnit, typename RightUnit>
+  static int32_t compareLevel(const WeightType *Weights,
+                              const LeftUnit *Left, int32_t LeftLength,
+                              const RightUnit *Right, int32_t RightLength) {
+    int32_t LeftPos = 0, RightPos = 0;
+    while (true) {
+      WeightType LeftWeight = 0, RightWeight = 0;
+      while (LeftPos < LeftLength && !(LeftWeight = Weights[Left[LeftPos++]]))
+        ;
+      while (RightPos < RightLength &&
+             !(RightWeight = Weights[Right[RightPos++]]))
+        ;
+      if (LeftWeight != RightWeight)
+        return LeftWeight < RightWeight ? -1 : 1;
+      if (LeftWeight == 0)
+        return 0;
+    }
+  }
+
 public:
 
   static const ASCIICollation *getTable() {
@@ -86,6 +114,19 @@ public:
     return CollationTable[c];
   }
 
+  /// Compares two strings of ASCII code units the way ucol_strcoll would.
+  template <typename LeftUnit, typename RightUnit>
+  int32_t compare(const LeftUnit *Left, int32_t LeftLength,
+                  const RightUnit *Right, int32_t RightLength) const {
+    if (int32_t Diff = compareLevel(PrimaryWeights, Left, LeftLength,
+                                    Right, RightLength))
+      return Diff;
+    if (int32_t Diff = compareLevel(SecondaryWeights, Left, LeftLength,
+                                    Right, RightLength))
+      return Diff;
+    return compareLevel(TertiaryWeights, Left, LeftLength, Right, RightLength);
+  }
+
 private:
   /// Construct the ASCII collation table.
   ASCIICollation() {
@@ -117,6 +158,10 @@ private:
       if (U_FAILURE(ErrorCode) || NumCollationElts != 1) {
         swift::crash("Error setting up the ASCII collation table");
       }
+
+      PrimaryWeights[c] = ucol_primaryOrder(CollationTable[c]);
+      SecondaryWeights[c] = ucol_secondaryOrder(CollationTable[c]);
+      TertiaryWeights[c] = ucol_tertiaryOrder(CollationTable[c]);
     }
   }
 
@@ -124,6 +169,56 @@ private:
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// Return the number of leading code units of \p Str that are ASCII,
+/// checking a word at a time.
+static int32_t getASCIIPrefixLength(const uint8_t *Str, int32_t Length) {
+  int32_t Pos = 0;
+  for (; Pos + 8 <= Length; Pos += 8) {
+    uint64_t Word;
+    memcpy(&Word, Str + Pos, sizeof(Word));
+    if (Word & 0x8080808080808080ULL)
+      break;
+  }
+  while (Pos < Length && Str[Pos] < 0x80)
+    ++Pos;
+  return Pos;
+}
+
+static int32_t getASCIIPrefixLength(const uint16_t *Str, int32_t Length) {
+  int32_t Pos = 0;
+  for (; Pos + 4 <= Length; Pos += 4) {
+    uint64_t Word;
+    memcpy(&Word, Str + Pos, sizeof(Word));
+    if (Word & 0xFF80FF80FF80FF80ULL)
+      break;
+  }
+  while (Pos < Length && Str[Pos] < 0x80)
+    ++Pos;
+  return Pos;
+}
+
+/// Return the length of the longest ASCII prefix the strings share that
+/// collates independently of what follows it, so comparing the rest of the
+/// strings gives the same result as comparing all of them.
+///
+/// A character's collation elements can depend on the characters after it,
+/// as with a combining accent, so the prefix stops short of the last ASCII
+/// character before anything that isn't ASCII.
+template <typename LeftUnit, typename RightUnit>
+static int32_t getCommonASCIIPrefixLength(const LeftUnit *Left,
+                                          int32_t LeftLength,
+                                          const RightUnit *Right,
+                                          int32_t RightLength) {
+  int32_t Length = std::min(LeftLength, RightLength);
+  int32_t Pos = 0;
+  while (Pos < Length && Left[Pos] == Right[Pos] && Left[Pos] < 0x80)
+    ++Pos;
+  if (Pos > 0 && ((Pos < LeftLength && Left[Pos] >= 0x80) ||
+                  (Pos < RightLength && Right[Pos] >= 0x80)))
+    --Pos;
+  return Pos;
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -134,6 +229,17 @@ swift::_swift_stdlib_unicode_compare_utf16_utf16(const uint16_t *LeftString,
                                                  int32_t LeftLength,
                                                  const uint16_t *RightString,
                                                  int32_t RightLength) {
+  int32_t Prefix = getCommonASCIIPrefixLength(LeftString, LeftLength,
+                                              RightString, RightLength);
+  LeftString += Prefix;
+  LeftLength -= Prefix;
+  RightString += Prefix;
+  RightLength -= Prefix;
+  if (getASCIIPrefixLength(LeftString, LeftLength) == LeftLength &&
+      getASCIIPrefixLength(RightString, RightLength) == RightLength)
+    return ASCIICollation::getTable()->compare(LeftString, LeftLength,
+                                               RightString, RightLength);
+
 #if defined(__CYGWIN__)
   // ICU UChar type is platform dependent. In Cygwin, it is defined
   // as wchar_t which size is 2. It seems that the underlying binary
@@ -158,6 +264,19 @@ swift::_swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
                                                 int32_t LeftLength,
                                                 const uint16_t *RightString,
                                                 int32_t RightLength) {
+  auto LeftUnits = reinterpret_cast<const uint8_t *>(LeftString);
+  int32_t Prefix = getCommonASCIIPrefixLength(LeftUnits, LeftLength,
+                                              RightString, RightLength);
+  LeftUnits += Prefix;
+  LeftString += Prefix;
+  LeftLength -= Prefix;
+  RightString += Prefix;
+  RightLength -= Prefix;
+  if (getASCIIPrefixLength(LeftUnits, LeftLength) == LeftLength &&
+      getASCIIPrefixLength(RightString, RightLength) == RightLength)
+    return ASCIICollation::getTable()->compare(LeftUnits, LeftLength,
+                                               RightString, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -188,6 +307,21 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
                                                int32_t LeftLength,
                                                const char *RightString,
                                                int32_t RightLength) {
+  auto LeftUnits = reinterpret_cast<const uint8_t *>(LeftString);
+  auto RightUnits = reinterpret_cast<const uint8_t *>(RightString);
+  int32_t Prefix = getCommonASCIIPrefixLength(LeftUnits, LeftLength,
+                                              RightUnits, RightLength);
+  LeftUnits += Prefix;
+  LeftString += Prefix;
+  LeftLength -= Prefix;
+  RightUnits += Prefix;
+  RightString += Prefix;
+  RightLength -= Prefix;
+  if (getASCIIPrefixLength(LeftUnits, LeftLength) == LeftLength &&
+      getASCIIPrefixLength(RightUnits, RightLength) == RightLength)
+    return ASCIICollation::getTable()->compare(LeftUnits, LeftLength,
+                                               RightUnits, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -248,6 +382,27 @@ static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
   return HashState;
 }
 
+template <typename Unit>
+static intptr_t hashASCIIChunk(const ASCIICollation *Table,
+                               intptr_t HashState, const Unit *Str,
+                               int32_t Length) {
+  for (int32_t Pos = 0; Pos < Length; ++Pos) {
+    assert(Str[Pos] < 0x80 && "This table only exists for the ASCII subset");
+    intptr_t Elem = Table->map(Str[Pos]);
+    // Ignore zero valued collation elements. They don't participate in the
+    // ordering relation.
+    if (Elem == 0)
+      continue;
+    Elem *= HASH_M;
+    Elem ^= Elem >> HASH_R;
+    Elem *= HASH_M;
+
+    HashState *= HASH_M;
+    HashState ^= Elem;
+  }
+  return HashState;
+}
+
 static intptr_t hashFinish(intptr_t HashState) {
   HashState ^= HashState >> HASH_R;
   HashState *= HASH_M;
@@ -257,9 +412,19 @@ static intptr_t hashFinish(intptr_t HashState) {
 
 intptr_t
 swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  // The collation elements of an ASCII prefix come straight from the table,
+  // except for its last character, which may combine with what follows it.
+  int32_t Prefix = getASCIIPrefixLength(Str, Length);
+  if (Prefix < Length && Prefix > 0)
+    --Prefix;
+  intptr_t HashState = hashASCIIChunk(ASCIICollation::getTable(), HASH_SEED,
+                                      Str, Prefix);
+  if (Prefix == Length)
+    return hashFinish(HashState);
+
   UErrorCode ErrorCode = U_ZERO_ERROR;
-  intptr_t HashState = HASH_SEED;
-  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
+  HashState = hashChunk(GetRootCollator(), HashState, Str + Prefix,
+                        Length - Prefix, &ErrorCode);
 
   if (U_FAILURE(ErrorCode)) {
     swift::crash("hashChunk: Unexpected error hashing unicode string.");
@@ -269,24 +434,9 @@ swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
 
 intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
                                                  int32_t Length) {
-  const ASCIICollation *Table = ASCIICollation::getTable();
-  intptr_t HashState = HASH_SEED;
-  int32_t Pos = 0;
-  while (Pos < Length) {
-    const char c = Str[Pos++];
-    assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
-    intptr_t Elem = Table->map(c);
-    // Ignore zero valued collation elements. They don't participate in the
-    // ordering relation.
-    if (Elem == 0)
-      continue;
-    Elem *= HASH_M;
-    Elem ^= Elem >> HASH_R;
-    Elem *= HASH_M;
-
-    HashState *= HASH_M;
-    HashState ^= Elem;
-  }
+  intptr_t HashState = hashASCIIChunk(
+      ASCIICollation::getTable(), HASH_SEED,
+      reinterpret_cast<const uint8_t *>(Str), Length);
   return hashFinish(HashState);
 }
 
@@ -20,5 +20,17 @@ StringOrderRelationTestSuite.test("StringOrderRelation/ASCII/NullByte")
   expectTrue(baseString != nullbyteString)
 }
 
+StringOrderRelationTestSuite.test("StringOrderRelation/ASCIIPrefix") {
+  // A combining accent after a shared ASCII prefix changes the collation
+  // of the prefix's last character.
+  expectTrue("cafe" < "cafe\u{301}")
+  expectTrue("cafe\u{301}" < "cafes")
+  expectEqual("cafe\u{301}", "caf\u{e9}")
+  expectEqual("cafe\u{301}".hashValue, "caf\u{e9}".hashValue)
+
+  expectTrue("Ab" < "ac")
+  expectTrue("a-b" < "ab")
+}
+
 runAllTests()
 
@@ -0,0 +1,16 @@
+// REQUIRES: asserts
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse %clang-importer-sdk -module-cache-path %t/clang-module-cache %s -print-stats 2>&1 | FileCheck %s
+
+// Only the names actually looked up should be read from the module's
+// serialized lookup table.
+
+// CHECK: Statistics Collected
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ +}}- # of base name lookups in Swift lookup tables
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ +}}- # of base names deserialized from Swift lookup tables
+
+import ctypes
+
+func usePoint() -> Point {
+  return Point(x: 1, y: 2)
+}
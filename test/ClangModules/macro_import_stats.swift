@@ -0,0 +1,18 @@
+// REQUIRES: asserts
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -module-cache-path %t/clang-module-cache %s -print-stats 2>&1 | FileCheck %s
+
+// XFAIL: linux
+
+// Only the macros that are referenced are parsed and imported, not every
+// macro in the module.
+
+// CHECK: Statistics Collected
+// CHECK-DAG: {{^ *[1-9] Clang module importer +- # of macro expansions parsed for import}}
+// CHECK-DAG: {{^ *[1-9] Clang module importer +- # of macros imported as Swift declarations}}
+
+import macros
+
+func circle_area(_ radius: CDouble) -> CDouble {
+  return M_PI * radius * radius
+}
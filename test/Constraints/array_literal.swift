@@ -103,3 +103,25 @@ func longArray() {
 }
 
 [1,2].map // expected-error {{expression type '(@noescape (Int) throws -> _) throws -> [_]' is ambiguous without more context}}
+
+func repeatedShapes() {
+  let nested = [[1.5, 2.5], [3.5], [4.5, 5.5, 6.5]]
+  let _: [[Double]] = nested
+  let table = ["a": [1, 2], "b": [3], "c": [4, 5, 6]]
+  let _: [String: [Int]] = table
+
+  // Elements of different shapes are still checked separately.
+  let mixed = [1, 2.5, 3]
+  let _: [Double] = mixed
+}
+
+func repeatedTypes(_ a: Int, _ b: Int, _ s: String) {
+  let ints = [a, b, a, b, a]
+  let _: [Int] = ints
+  let byName = [s: a, s: b, s: a]
+  let _: [String: Int] = byName
+
+  // Elements of different types still each need a conversion.
+  let anys: [Any] = [a, s, b, s]
+  _ = anys
+}
@@ -161,3 +161,18 @@ struct X2 {
 
 let x2 = X2(Int.self)
 let x2check: X2 = x2 // expected-error{{value of optional type 'X2?' not unwrapped; did you mean to use '!' or '?'?}}
+
+// Overloads of an operator for other structs and enums aren't candidates.
+struct Meters { var value: Double }
+struct Feet { var value: Double }
+enum Direction { case up, down }
+func + (lhs: Meters, rhs: Meters) -> Meters { return Meters(value: lhs.value + rhs.value) }
+func + (lhs: Feet, rhs: Feet) -> Feet { return Feet(value: lhs.value + rhs.value) }
+func + (lhs: Direction, rhs: Direction) -> Direction { return lhs }
+
+func addLengths(_ m: Meters, _ f: Feet, _ d: Direction) {
+  let _: Meters = m + m
+  let _: Feet = f + f
+  let _ = d + d
+  let _ = m + m + m
+}
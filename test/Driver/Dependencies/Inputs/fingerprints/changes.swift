@@ -0,0 +1,4 @@
+# Dependencies after compilation:
+provides-top-level: [a1, a2]
+fingerprints: [[a1, "same"], [a2, "after"]]
+interface-hash: "after"
@@ -0,0 +1,3 @@
+# Dependencies after compilation:
+depends-top-level: [a2]
+interface-hash: "same"
@@ -0,0 +1,3 @@
+# Dependencies after compilation:
+depends-top-level: [a1]
+interface-hash: "same"
@@ -0,0 +1,34 @@
+/// "./main-external" ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/compilation-cache/ %t
+
+// The first build fills the cache...
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -compilation-cache-path %t/cache -driver-show-compilation-cache ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+// CHECK-FIRST: Compilation cache: 0 of 2 jobs restored (0%), 0 bytes restored, 2 jobs stored
+
+// ...so that the next one runs nothing, but still produces the outputs and
+// what the frontend printed.
+// RUN: rm %t/main.o %t/other.o
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -compilation-cache-path %t/cache -driver-show-compilation-cache ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-SECOND %s
+// RUN: ls %t/main.o %t/other.o
+
+// CHECK-SECOND-NOT: -frontend
+// CHECK-SECOND: Compilation cache: 2 of 2 jobs restored (100%), {{[1-9][0-9]*}} bytes restored, 0 jobs stored
+
+// A changed source file changes the key of every job in the module.
+// RUN: echo "# a comment" >> %t/other.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -compilation-cache-path %t/cache -driver-show-compilation-cache ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-SOURCE %s
+
+// CHECK-SOURCE: Compilation cache: 0 of 2 jobs restored (0%), 0 bytes restored, 2 jobs stored
+
+// A changed module only affects the jobs that imported it.
+// RUN: echo "changed" > %t/main-external
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -compilation-cache-path %t/cache -driver-show-compilation-cache ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-EXTERNAL %s
+
+// CHECK-EXTERNAL-NOT: -primary-file ./other.swift
+// CHECK-EXTERNAL: -frontend -c -primary-file ./main.swift
+// CHECK-EXTERNAL-NOT: -primary-file ./other.swift
+// CHECK-EXTERNAL: Compilation cache: 1 of 2 jobs restored (50%), {{[1-9][0-9]*}} bytes restored, 1 jobs stored
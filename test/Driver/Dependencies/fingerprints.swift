@@ -0,0 +1,38 @@
+/// changes ==> uses-changed, changes ==> uses-unchanged
+/// but only the declaration uses-changed depends on changes along with the
+/// interface.
+
+// RUN: rm -rf %t && cp -r %S/Inputs/fingerprints/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// Generate the build record...
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changes.swift ./uses-changed.swift ./uses-unchanged.swift -module-name main -j1 -v
+
+// ...then reset the .swiftdeps files.
+// RUN: cp -r %S/Inputs/fingerprints/*.swiftdeps %t
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changes.swift ./uses-changed.swift ./uses-unchanged.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-CLEAN %s
+
+// CHECK-CLEAN-NOT: Handled
+
+// RUN: touch -t 201401240006 %t/changes.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-show-incremental ./changes.swift ./uses-changed.swift ./uses-unchanged.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-CHANGE %s
+
+// CHECK-CHANGE-NOT: Handled uses-unchanged.swift
+// CHECK-CHANGE: Handled changes.swift
+// CHECK-CHANGE-NOT: Handled uses-unchanged.swift
+// CHECK-CHANGE: Handled uses-changed.swift
+// CHECK-CHANGE-NOT: Handled uses-unchanged.swift
+// CHECK-CHANGE: Skipping uses-unchanged.swift because none of the declarations it uses changed
+// CHECK-CHANGE: Declaration fingerprints: 1 dependent jobs skipped
+
+
+// Without fingerprints from before, every dependent is rebuilt.
+// RUN: cp -r %S/Inputs/fingerprints/*.swiftdeps %t
+// RUN: sed -E -e '/^fingerprints:/d' -i.prev %t/changes.swiftdeps
+// RUN: touch -t 201401240007 %t/changes.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changes.swift ./uses-changed.swift ./uses-unchanged.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-NO-FINGERPRINTS %s
+
+// CHECK-NO-FINGERPRINTS: Handled changes.swift
+// CHECK-NO-FINGERPRINTS-DAG: Handled uses-changed.swift
+// CHECK-NO-FINGERPRINTS-DAG: Handled uses-unchanged.swift
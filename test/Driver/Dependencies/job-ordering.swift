@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way/ %t
+// RUN: %S/Inputs/touch.py 443865900 %t/*
+
+// Files that took longer to compile last time are started first.
+// RUN: echo '{version: "'$(%swiftc_driver_plain -version | head -n1)'", inputs: {"./main.swift": [443865899, 0], "./other.swift": [443865899, 0]}, durations: {"./main.swift": [1, 0], "./other.swift": [20, 0]}, build_time: [443865901, 0]}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-LONGEST-FIRST %s
+
+// CHECK-LONGEST-FIRST-NOT: warning
+// CHECK-LONGEST-FIRST: "kind": "began"
+// CHECK-LONGEST-FIRST: ".\/other.swift"
+// CHECK-LONGEST-FIRST: "kind": "began"
+// CHECK-LONGEST-FIRST: ".\/main.swift"
+
+// The new durations are recorded for the next build.
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-RECORD: durations:
+// CHECK-RECORD-DAG: "./main.swift": [{{[0-9]+}}, {{[0-9]+}}]
+// CHECK-RECORD-DAG: "./other.swift": [{{[0-9]+}}, {{[0-9]+}}]
+
+// With one job at a time, command-line order is kept.
+// RUN: echo '{version: "'$(%swiftc_driver_plain -version | head -n1)'", inputs: {"./main.swift": [443865899, 0], "./other.swift": [443865899, 0]}, durations: {"./main.swift": [1, 0], "./other.swift": [20, 0]}, build_time: [443865901, 0]}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-IN-ORDER %s
+
+// CHECK-IN-ORDER: "kind": "began"
+// CHECK-IN-ORDER: ".\/main.swift"
+// CHECK-IN-ORDER: "kind": "began"
+// CHECK-IN-ORDER: ".\/other.swift"
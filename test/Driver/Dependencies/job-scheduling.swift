@@ -0,0 +1,6 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/fail-simple/ %t
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./bad.swift ./other.swift -module-name main -j1 -driver-show-job-scheduling 2>&1 | FileCheck %s
+
+// CHECK: Job scheduling: 2 jobs started in freed slots, {{[0-9]+}}us average and {{[0-9]+}}us maximum delay
+// CHECK: Job slots: 1 for {{[0-9]+}}us, {{[0-9]+}}us idle
@@ -0,0 +1 @@
+static inline int bridgingHeaderValue(void) { return 42; }
@@ -0,0 +1,18 @@
+// RUN: %swiftc_driver -driver-skip-execution -enable-batch-mode -c %S/Inputs/main.swift %S/Inputs/lib.swift %s -module-name main -j2 -v 2>&1 | FileCheck -check-prefix=CHECK-TWO %s
+
+// With two jobs at a time, the three files are split between two frontend
+// invocations. A file left on its own is compiled as usual.
+// CHECK-TWO: -frontend -c {{.*}}-primary-file {{[^ ]*}}lib.swift {{.*}}-o {{[^ ]*}}lib-{{[^ ]*}}.o
+// CHECK-TWO-NEXT: -frontend -c -primary-file {{[^ ]*}}main.swift {{[^ ]*}}lib.swift -primary-file {{[^ ]*}}batch_mode.swift {{.*}}-o {{[^ ]*}}main-{{[^ ]*}}.o -o {{[^ ]*}}batch_mode-{{[^ ]*}}.o
+// CHECK-TWO-NOT: -frontend
+
+// RUN: %swiftc_driver -driver-skip-execution -enable-batch-mode -c %S/Inputs/main.swift %S/Inputs/lib.swift %s -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-ONE %s
+
+// CHECK-ONE: -frontend -c -primary-file {{[^ ]*}}main.swift -primary-file {{[^ ]*}}lib.swift -primary-file {{[^ ]*}}batch_mode.swift {{.*}}-o {{[^ ]*}}main-{{[^ ]*}}.o -o {{[^ ]*}}lib-{{[^ ]*}}.o -o {{[^ ]*}}batch_mode-{{[^ ]*}}.o
+// CHECK-ONE-NOT: -frontend
+
+// Jobs whose outputs can't yet be told apart are not batched.
+// RUN: %swiftc_driver -driver-skip-execution -enable-batch-mode -c %S/Inputs/main.swift %S/Inputs/lib.swift -module-name main -serialize-diagnostics -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-DIAGS %s
+
+// CHECK-DIAGS: -frontend -c -primary-file {{[^ ]*}}main.swift {{[^ ]*}}lib.swift {{.*}}-serialize-diagnostics-path
+// CHECK-DIAGS: -frontend -c {{[^ ]*}}main.swift -primary-file {{[^ ]*}}lib.swift {{.*}}-serialize-diagnostics-path
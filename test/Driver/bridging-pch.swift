@@ -0,0 +1,25 @@
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=ACTIONS
+// ACTIONS: 0: input, "{{.*}}bridging-pch.swift", swift
+// ACTIONS: 1: input, "{{.*}}bridging-header.h", objc-header
+// ACTIONS: 2: generate-pch, {1}, pch
+// ACTIONS: 3: compile, {0, 2}, object
+// ACTIONS: 4: input, "{{.*}}lib.swift", swift
+// ACTIONS: 5: compile, {4, 2}, object
+// ACTIONS: 6: link, {3, 5}, image
+
+// Without -enable-bridging-pch every job parses the header itself.
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h %s 2>&1 | FileCheck %s -check-prefix=NOPCH
+// NOPCH-NOT: generate-pch
+
+// Whole-module builds parse the header once already.
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -whole-module-optimization %s 2>&1 | FileCheck %s -check-prefix=WMO
+// WMO-NOT: generate-pch
+
+// RUN: %swiftc_driver -### -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -c %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=JOBS
+// JOBS: -frontend {{.*}}bridging-header.h -emit-pch {{.*}}-o [[PCH:[^ ]*bridging-header-[^ ]*\.pch]]
+// JOBS: -frontend -c -primary-file {{[^ ]*}}bridging-pch.swift {{.*}}-import-objc-header [[PCH]]
+// JOBS: -frontend -c {{.*}}-primary-file {{[^ ]*}}lib.swift {{.*}}-import-objc-header [[PCH]]
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %swiftc_driver -### -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -pch-output-dir %t/pch -c %s 2>&1 | FileCheck %s -check-prefix=PERSISTENT
+// PERSISTENT: -emit-pch {{.*}}-o {{.*}}/pch/bridging-header-{{[0-9a-f]+}}.pch
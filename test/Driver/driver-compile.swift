@@ -7,6 +7,8 @@
 // RUN: FileCheck %s < %t.complex.txt
 // RUN: FileCheck -check-prefix COMPLEX %s < %t.complex.txt
 
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 %s -incremental -driver-emit-yaml-reference-dependencies 2>&1 | FileCheck -check-prefix YAML-REFERENCE-DEPENDENCIES %s
+
 // RUN: %swiftc_driver -driver-print-jobs -emit-silgen -target x86_64-apple-macosx10.9 %s 2>&1 > %t.silgen.txt
 // RUN: FileCheck %s < %t.silgen.txt
 // RUN: FileCheck -check-prefix SILGEN %s < %t.silgen.txt
@@ -73,9 +75,13 @@
 // COMPLEX-DAG: -F /path/to/frameworks -F /path/to/more/frameworks
 // COMPLEX-DAG: -I /path/to/headers -I path/to/more/headers
 // COMPLEX-DAG: -module-cache-path /tmp/modules
-// COMPLEX-DAG: -emit-reference-dependencies-path {{(.*/)?driver-compile[^ /]+}}.swiftdeps
+// COMPLEX-DAG: -emit-reference-dependencies-path {{(.*/)?driver-compile[^ /]+}}.swiftdeps -binary-reference-dependencies
 // COMPLEX: -o {{.+}}.o
 
+// YAML-REFERENCE-DEPENDENCIES: bin/swift
+// YAML-REFERENCE-DEPENDENCIES: -emit-reference-dependencies-path
+// YAML-REFERENCE-DEPENDENCIES-NOT: -binary-reference-dependencies
+
 
 // SILGEN: bin/swift
 // SILGEN: -emit-silgen
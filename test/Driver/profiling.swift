@@ -46,3 +46,8 @@
 // LINUX: clang++{{"? }}
 // LINUX: lib/swift/clang/lib/linux/libclang_rt.profile-x86_64.a
 
+
+// RUN: %swiftc_driver -driver-print-jobs -profile-use=%t.profdata -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=USE %s
+
+// USE: swift
+// USE: -profile-use={{.*}}.profdata
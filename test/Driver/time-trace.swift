@@ -0,0 +1,11 @@
+// RUN: %swiftc_driver -driver-skip-execution -c %S/Inputs/main.swift %s -module-name main -driver-time-trace %t.json -v 2>&1 | FileCheck %s
+
+// Each compile job records the phases it goes through.
+// CHECK: -frontend -c -primary-file {{[^ ]*}}main.swift {{.*}}-phase-timeline-path {{[^ ]*}}main-{{[^ ]*}}.phases
+// CHECK: -frontend -c {{[^ ]*}}main.swift -primary-file {{[^ ]*}}time-trace.swift {{.*}}-phase-timeline-path {{[^ ]*}}time-trace-{{[^ ]*}}.phases
+
+// ...so those jobs aren't batched.
+// RUN: %swiftc_driver -driver-skip-execution -enable-batch-mode -c %S/Inputs/main.swift %s -module-name main -driver-time-trace %t.json -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-BATCH %s
+
+// CHECK-BATCH: -frontend -c -primary-file {{[^ ]*}}main.swift {{[^ ]*}}time-trace.swift {{.*}}-phase-timeline-path
+// CHECK-BATCH: -frontend -c {{[^ ]*}}main.swift -primary-file {{[^ ]*}}time-trace.swift {{.*}}-phase-timeline-path
@@ -0,0 +1,23 @@
+struct Counter {
+  var count: Int
+
+  mutating func increment() {
+    // Only parsed when this file is the primary file.
+    count += = 1
+  }
+
+  var doubled: Int {
+    return count * * 2
+  }
+
+  init() {
+    count = 0 +
+  }
+}
+
+func makeCounter() -> Counter {
+  return Counter(
+}
+
+@_transparent
+func transparentIdentity(_ x: Int) -> Int { return x }
@@ -0,0 +1,12 @@
+// RUN: %target-swift-frontend -parse %s -print-ast-memory 2>&1 | FileCheck %s
+
+// CHECK: AST memory after type checking:
+// CHECK-NEXT: arena bytes:
+// CHECK-NEXT: permanent {{ *[0-9]+}}
+// CHECK: node allocations:
+// CHECK-NEXT: Decl {{ *[0-9]+ +[0-9]+ +[0-9]+ +[0-9]+}}
+// CHECK: Expr {{ *[0-9]+ +[0-9]+ +[0-9]+ +[0-9]+}}
+// CHECK: uniquing tables (permanent arena):
+// CHECK: TupleTypes {{ *[0-9]+}}
+let a = 1 + 2
+func f(_ x: Int) -> Int { return x * a }
@@ -0,0 +1,9 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c %s -o %t/print-phase-memory.o -print-phase-memory 2>&1 | FileCheck %s
+
+// CHECK: Memory after type checking: peak RSS {{[0-9]+}}, malloc {{[0-9]+}}, AST {{[1-9][0-9]*}}, SIL {{[0-9]+}}
+// CHECK-NEXT: Memory after SIL generation: peak RSS {{[0-9]+}}, malloc {{[0-9]+}}, AST {{[1-9][0-9]*}}, SIL {{[0-9]+}}
+// CHECK-NEXT: Memory after SIL optimization: peak RSS {{[0-9]+}}, malloc {{[0-9]+}}, AST {{[1-9][0-9]*}}, SIL {{[0-9]+}}
+// CHECK-NEXT: Memory after IR generation: peak RSS {{[0-9]+}}, malloc {{[0-9]+}}, AST {{[1-9][0-9]*}}, SIL {{[0-9]+}}
+let a = 1 + 2
+func f(_ x: Int) -> Int { return x * a }
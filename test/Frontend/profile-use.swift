@@ -0,0 +1,6 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: not %target-swift-frontend -emit-sil -profile-use=%t/missing.profdata %s 2>&1 | FileCheck %s
+
+// CHECK: error: failed to load profile data '{{.*}}missing.profdata'
+
+func f() {}
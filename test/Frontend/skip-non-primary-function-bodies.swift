@@ -0,0 +1,12 @@
+// The bodies of the functions in a non-primary file aren't parsed, so the
+// errors in them are only reported by the job compiling that file.
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-function-bodies-other.swift
+// RUN: not %target-swift-frontend -parse %s -primary-file %S/Inputs/skip-function-bodies-other.swift 2>&1 | FileCheck %s
+
+// CHECK: skip-function-bodies-other.swift:6:{{[0-9]+}}: error:
+
+func useCounter() -> Int {
+  var c = makeCounter()
+  c.increment()
+  return transparentIdentity(c.doubled)
+}
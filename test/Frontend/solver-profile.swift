@@ -0,0 +1,9 @@
+// RUN: %target-swift-frontend -parse %s -solver-profile-path %t.json
+// RUN: FileCheck %s < %t.json
+
+// CHECK: [
+// CHECK-DAG: {"file": "{{.*}}solver-profile.swift", "start_line": [[@LINE+3]], "start_column": 9, "end_line": [[@LINE+3]], "end_column": 22, "wall_time_ms": {{[0-9.]+}}, "ranking_time_ms": {{[0-9.]+}}, "peak_solver_memory": {{[0-9]+}}, "states_explored": {{[0-9]+}}, "disjunctions": {{[0-9]+}}, "disjunction_terms": {{[0-9]+}}, "components_split": {{[0-9]+}}, "solutions_compared": {{[0-9]+}}}
+// CHECK-DAG: {"file": "{{.*}}solver-profile.swift", "start_line": [[@LINE+3]], "start_column": 9,
+// CHECK: ]
+let a = 1 + 2 * 3 - 4
+let b = "x" + "y"
@@ -0,0 +1,34 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -primary-file %s -module-name main -o %t/stats-dir.o -stats-output-dir %t/stats -suppress-warnings
+// RUN: cat %t/stats/frontend-main-stats-dir-*.json | FileCheck %s
+// RUN: %{python} %S/../../utils/process-stats-dir.py %t/stats | FileCheck -check-prefix=TOTALS %s
+
+// CHECK: "module": "main",
+// CHECK-NEXT: "primary_files": ["{{.*}}stats-dir.swift"],
+// CHECK-NEXT: "phases_ms": {
+// CHECK-DAG: "Type checking / Semantic analysis": {{[0-9.]+}}
+// CHECK-DAG: "IRGen": {{[0-9.]+}}
+// CHECK: },
+// CHECK-NEXT: "ast": {"source_files": 1, "top_level_decls": 3, "memory_bytes": {{[0-9]+}}},
+// CHECK-NEXT: "sil": {"functions": {{[1-9][0-9]*}}, "basic_blocks": {{[0-9]+}}, "instructions": {{[0-9]+}}, "vtables": 0, "witness_tables": 0, "global_variables": 0},
+// CHECK-NEXT: "diagnostics": {
+// CHECK-NEXT: "pbd_never_used": {"emitted": 0, "ignored": 1}
+// CHECK-NEXT: },
+// CHECK-NEXT: "llvm_statistics": [
+// CHECK: "phase_memory": [
+// CHECK-NEXT: {"phase": "type checking", "peak_rss_bytes": {{[0-9]+}}, "malloc_bytes": {{[0-9]+}}, "ast_bytes": {{[0-9]+}}, "sil_bytes": {{[0-9]+}}},
+// CHECK-NEXT: {"phase": "SIL generation",
+// CHECK-NEXT: {"phase": "SIL optimization",
+// CHECK-NEXT: {"phase": "IR generation",
+// CHECK-NEXT: ],
+// CHECK-NEXT: "peak_rss_bytes": {{[0-9]+}}
+
+// TOTALS: ast.source_files {{ +}}1
+// TOTALS: diagnostics.pbd_never_used.ignored {{ +}}1
+// TOTALS: jobs {{ +}}1
+// TOTALS: Slowest jobs:
+// TOTALS-NEXT: ms  main: {{.*}}stats-dir.swift
+
+func f(_ x: Int) -> Int { return x + 1 }
+func g() -> Int { return f(41) }
+func h() { let unused = g() }
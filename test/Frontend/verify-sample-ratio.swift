@@ -0,0 +1,12 @@
+// RUN: %target-swift-frontend -emit-sil %s -verify-sample-ratio 3 -o /dev/null
+// RUN: not %target-swift-frontend -parse %s -verify-sample-ratio 0 2>&1 | FileCheck %s
+
+// CHECK: error: invalid value '0' in '-verify-sample-ratio 0'
+
+struct S {
+  var x: Int
+  func f() -> Int { return x }
+}
+
+func g(_ s: S) -> Int { return s.f() + 1 }
+func h<T>(_ t: T) -> T { return t }
@@ -0,0 +1,46 @@
+// RUN: %target-swift-ide-test -code-completion -source-filename %s -code-completion-token=AFTER_STMTS | FileCheck %s -check-prefix=FOO_OBJECT_DOT
+// RUN: %target-swift-ide-test -code-completion -source-filename %s -code-completion-token=AFTER_GUARD | FileCheck %s -check-prefix=FOO_OBJECT_DOT
+// RUN: %target-swift-ide-test -code-completion -source-filename %s -code-completion-token=IN_SECOND_CLOSURE | FileCheck %s -check-prefix=FOO_OBJECT_DOT
+
+// Statements and closures that end before the completion point are not
+// type-checked, while the declarations before it still are.
+
+struct FooStruct {
+  var instanceVar : Int
+
+  func instanceFunc0() {}
+}
+
+func takeClosures(_ a: () -> Void, _ b: (FooStruct) -> Void) {}
+
+func afterStatements(_ opt: FooStruct?) {
+  let foo = FooStruct(instanceVar: 0)
+  if foo.instanceVar > 0 {
+    _ = foo.instanceVar + undefinedName
+  }
+  for _ in 0..<10 {
+    takeClosures({ undefinedFunction() }, { _ in })
+  }
+  foo.#^AFTER_STMTS^#
+}
+
+func afterGuard(_ opt: FooStruct?) {
+  _ = undefinedName
+  guard let foo = opt else { return }
+  foo.#^AFTER_GUARD^#
+}
+
+func inSecondClosure() {
+  takeClosures({
+    let x = undefinedName
+    _ = x
+  }, { (foo: FooStruct) in
+    _ = 1
+    foo.#^IN_SECOND_CLOSURE^#
+  })
+}
+
+// FOO_OBJECT_DOT: Begin completions
+// FOO_OBJECT_DOT-NEXT: Decl[InstanceVar]/CurrNominal:    instanceVar[#Int#]{{; name=.+$}}
+// FOO_OBJECT_DOT-NEXT: Decl[InstanceMethod]/CurrNominal: instanceFunc0()[#Void#]{{; name=.+$}}
+// FOO_OBJECT_DOT-NEXT: End completions
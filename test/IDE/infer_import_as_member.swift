@@ -2,6 +2,13 @@
 // RUN: %target-swift-frontend -parse -import-objc-header %S/Inputs/custom-modules/CollisionImportAsMember.h -I %t -I %S/Inputs/custom-modules %s -enable-infer-import-as-member -verify
 // RUN: FileCheck %s -check-prefix=PRINT -strict-whitespace < %t.printed.A.txt
 
+// The second job reads the results of inference from the module cache.
+// RUN: rm -rf %t.mcp
+// RUN: %target-swift-ide-test(mock-sdk: %clang-importer-sdk) -import-objc-header %S/Inputs/custom-modules/CollisionImportAsMember.h -I %t -I %S/Inputs/custom-modules -print-module -source-filename %s -module-to-print=InferImportAsMember -always-argument-labels -enable-infer-import-as-member -module-cache-path %t.mcp > %t.printed.B.txt
+// RUN: %target-swift-ide-test(mock-sdk: %clang-importer-sdk) -import-objc-header %S/Inputs/custom-modules/CollisionImportAsMember.h -I %t -I %S/Inputs/custom-modules -print-module -source-filename %s -module-to-print=InferImportAsMember -always-argument-labels -enable-infer-import-as-member -module-cache-path %t.mcp > %t.printed.C.txt
+// RUN: diff -u %t.printed.A.txt %t.printed.B.txt
+// RUN: diff -u %t.printed.A.txt %t.printed.C.txt
+
 // REQUIRES: objc_interop
 
 import InferImportAsMember
@@ -0,0 +1,20 @@
+// RUN: %target-swift-frontend -emit-ir %s -Xllvm -debug-only=enum-layout 2>&1 >/dev/null | FileCheck %s
+
+// REQUIRES: asserts
+
+class C {}
+
+// CHECK-LABEL: Multi-payload enum IntOrClass needs 1 extra tag bit(s): 2 tags, 0 common spare bit(s)
+// CHECK-NEXT:    case int: 0 of {{32|64}} bits spare
+// CHECK-NEXT:    case object: {{[0-9]+}} of {{32|64}} bits spare
+enum IntOrClass {
+  case int(Int)
+  case object(C)
+}
+
+// Both payloads have spare bits in common, so no extra tag bits are needed.
+// CHECK-NOT: Multi-payload enum TwoClasses
+enum TwoClasses {
+  case first(C)
+  case second(C)
+}
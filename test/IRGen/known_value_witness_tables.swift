@@ -0,0 +1,36 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s > %t.ll
+// RUN: FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-%target-ptrsize < %t.ll
+// RUN: FileCheck %s --check-prefix=NEGATIVE < %t.ll
+
+// POD types with a common size and alignment and without extra inhabitants
+// use the value witness tables exported from the runtime.
+
+// NEGATIVE-NOT: @_TWVV26known_value_witness_tables5Empty =
+// NEGATIVE-NOT: @_TWVV26known_value_witness_tables7OneWord =
+
+// CHECK-LABEL: @_TMfV26known_value_witness_tables5Empty = internal constant
+// CHECK-SAME:    @_TWVT_
+struct Empty {}
+
+// CHECK-LABEL: @_TMfV26known_value_witness_tables7OneWord = internal constant
+// CHECK-32-SAME: @_TWVBi32_
+// CHECK-64-SAME: @_TWVBi64_
+struct OneWord {
+  var x: Int
+}
+
+// The size does not match the alignment.
+// CHECK-LABEL: @_TMfV26known_value_witness_tables11WithPadding = internal constant
+// CHECK-SAME:    @_TWVV26known_value_witness_tables11WithPadding
+struct WithPadding {
+  var x: Int
+  var y: Int8
+}
+
+// Types with extra inhabitants keep their own witnesses.
+// CHECK-LABEL: @_TMfV26known_value_witness_tables8WithBool = internal constant
+// CHECK-SAME:    @_TWVV26known_value_witness_tables8WithBool
+struct WithBool {
+  var b: Bool
+}
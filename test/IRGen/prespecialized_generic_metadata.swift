@@ -0,0 +1,28 @@
+// RUN: %target-swift-frontend -emit-ir %s -prespecialize-generic-metadata 'Pair<Int, Int>' -prespecialize-generic-metadata 'Choice<Int>' | FileCheck %s
+// RUN: %target-swift-frontend -emit-ir %s -prespecialize-generic-metadata 'Box<Int>' 2>&1 | FileCheck %s --check-prefix=UNSUPPORTED
+// RUN: %target-swift-frontend -emit-ir %s -prespecialize-generic-metadata 'Missing<Int>' 2>&1 | FileCheck %s --check-prefix=NOT_FOUND
+
+// REQUIRES: CPU=x86_64
+
+// CHECK-DAG: @prespecialized_metadata = private constant
+// CHECK-DAG: @prespecialized_metadata{{[.0-9]+}} = private constant
+// CHECK-DAG: @"\01l_prespecialized_metadata_table" = private constant [2 x %swift.prespecialized_metadata_record] {{.*}} section "{{[^"]*}}prespec{{[^"]*}}"
+
+// NOT_FOUND: unable to find generic type instantiation 'Missing<Int>' to prespecialize
+
+public struct Pair<T, U> {
+  public var first: Int
+  public var second: Int
+}
+
+// Metadata whose layout depends on its argument is still instantiated at
+// runtime.
+// UNSUPPORTED: metadata for 'Box<Int>' cannot be built at compile time
+public struct Box<T> {
+  public var value: T
+}
+
+public enum Choice<T> {
+  case none
+  case some(Int)
+}
@@ -0,0 +1,33 @@
+// RUN: %target-swift-frontend -emit-ir -enable-struct-field-reordering %s | FileCheck %s
+// RUN: %target-swift-frontend -emit-ir %s | FileCheck %s --check-prefix=DEFAULT
+
+// CHECK-DAG: %V23struct_field_reordering5Mixed = type <{ %Sb, [{{3|7}} x i8], %Si, %Si, %Sb, %Sb }>
+// DEFAULT-DAG: %V23struct_field_reordering5Mixed = type <{ %Sb, [{{3|7}} x i8], %Si, %Sb, [{{3|7}} x i8], %Si, %Sb }>
+struct Mixed {
+  var a: Bool
+  var b: Int
+  var c: Bool
+  var d: Int
+  var e: Bool
+}
+
+// Public structs keep their declaration order, because other modules depend
+// on their layout.
+// CHECK-DAG: %V23struct_field_reordering11PublicMixed = type <{ %Sb, [{{3|7}} x i8], %Si, %Sb, [{{3|7}} x i8], %Si, %Sb }>
+public struct PublicMixed {
+  var a: Bool
+  var b: Int
+  var c: Bool
+  var d: Int
+  var e: Bool
+}
+
+// The layout is only changed if it gets smaller.
+// CHECK-DAG: %V23struct_field_reordering6Sorted = type <{ %Si, %Si, %Sb, %Sb }>
+struct Sorted {
+  var a: Int
+  var b: Int
+  var c: Bool
+  var d: Bool
+}
+
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run -immediate-object-cache-path %t/cache -debug-time-compilation %s 2>%t.first.err | FileCheck %s
+// RUN: FileCheck -check-prefix=FIRST %s < %t.first.err
+// RUN: %target-jit-run -immediate-object-cache-path %t/cache -debug-time-compilation %s 2>%t.second.err | FileCheck %s
+// RUN: FileCheck -check-prefix=SECOND %s < %t.second.err
+// REQUIRES: swift_interpreter
+
+// FIRST: Immediate mode: {{[0-9]+}} ms from IRGen to running main (object code added to the cache)
+// SECOND: Immediate mode: {{[0-9]+}} ms from IRGen to running main (cached object code)
+
+func greet(_ name: String) -> String {
+  return "Hello, " + name
+}
+
+// CHECK: Hello, cache
+print(greet("cache"))
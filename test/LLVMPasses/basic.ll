@@ -369,6 +369,58 @@ bb1:
   ret void
 }
 
+; CHECK-LABEL: @retain_release_across_blocks(
+; CHECK-NOT: swift_retain
+; CHECK-NOT: swift_release
+; CHECK: ret void
+define void @retain_release_across_blocks(%swift.refcounted* %A, i32* %ptr) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  store i32 42, i32* %ptr
+  br label %bb1
+bb1:
+  %B = bitcast %swift.refcounted* %A to i32*
+  store i32 0, i32* %B
+  br label %bb2
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: @release_motion_into_predecessor(
+; CHECK: entry:
+; CHECK-NEXT: call void @unknown_func()
+; CHECK-NEXT: tail call void @swift_release(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: add i32
+; CHECK-NEXT: ret i32
+define i32 @release_motion_into_predecessor(%swift.refcounted* %A, i32 %x) {
+entry:
+  call void @unknown_func()
+  br label %bb1
+bb1:
+  %y = add i32 %x, 1
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret i32 %y
+}
+
+; A release can't be paired with a retain in a block that doesn't always
+; branch to it.
+; CHECK-LABEL: @retain_release_across_conditional_branch(
+; CHECK: swift_retain
+; CHECK: swift_release
+; CHECK: ret void
+define void @retain_release_across_conditional_branch(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb2
+bb2:
+  ret void
+}
 
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
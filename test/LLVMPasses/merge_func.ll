@@ -323,3 +323,37 @@ done:
 ; CHECK: ret i1
   ret i1 %result
 }
+
+; Check that functions which only differ in the constants they compare
+; against (e.g. type metadata in generic specializations) are merged.
+
+@m1 = external global i32
+@m2 = external global i32
+
+; CHECK-LABEL: define i1 @cmp_metadata_a(i32* %p)
+; CHECK: %1 = tail call i1 @cmp_metadata_a_merged(i32* %p, i32* @m1)
+; CHECK: ret i1 %1
+define i1 @cmp_metadata_a(i32* %p) {
+  %l = load i32, i32* %p
+  %sum = add i32 %l, 1
+  %sum2 = add i32 %sum, 2
+  %sum3 = add i32 %sum2, 3
+  %cmp = icmp eq i32* %p, @m1
+  ret i1 %cmp
+}
+
+; CHECK-LABEL: define i1 @cmp_metadata_b(i32* %p)
+; CHECK: %1 = tail call i1 @cmp_metadata_a_merged(i32* %p, i32* @m2)
+; CHECK: ret i1 %1
+define i1 @cmp_metadata_b(i32* %p) {
+  %l = load i32, i32* %p
+  %sum = add i32 %l, 1
+  %sum2 = add i32 %sum, 2
+  %sum3 = add i32 %sum2, 3
+  %cmp = icmp eq i32* %p, @m2
+  ret i1 %cmp
+}
+
+; CHECK-LABEL: define internal i1 @cmp_metadata_a_merged(i32*, i32*)
+; CHECK: %cmp = icmp eq i32* %0, %1
+; CHECK: ret i1 %cmp
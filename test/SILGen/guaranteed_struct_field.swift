@@ -0,0 +1,64 @@
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s
+
+// Stored properties of structs that cannot change during the call are passed
+// to guaranteed parameters at +0.
+
+class C {
+  func method() {}
+}
+
+struct Inner {
+  var c: C
+
+  func method() {}
+}
+
+struct Outer {
+  var inner: Inner
+  var c: C
+
+  // CHECK-LABEL: sil hidden @_TFV23guaranteed_struct_field5Outer15callOnSelfField
+  // CHECK:       bb0([[SELF:%.*]] : $Outer):
+  // CHECK:         [[C:%.*]] = struct_extract [[SELF]] : $Outer, #Outer.c
+  // CHECK-NOT:     strong_retain [[C]]
+  // CHECK:         apply {{%.*}}([[C]])
+  // CHECK-NOT:     strong_release [[C]]
+  // CHECK:         return
+  func callOnSelfField() {
+    c.method()
+  }
+
+  // CHECK-LABEL: sil hidden @_TFV23guaranteed_struct_field5Outer17callOnNestedField
+  // CHECK:       bb0([[SELF:%.*]] : $Outer):
+  // CHECK:         [[INNER:%.*]] = struct_extract [[SELF]] : $Outer, #Outer.inner
+  // CHECK-NOT:     retain_value [[INNER]]
+  // CHECK:         apply {{%.*}}([[INNER]])
+  // CHECK-NOT:     release_value [[INNER]]
+  // CHECK:         return
+  func callOnNestedField() {
+    inner.method()
+  }
+}
+
+// CHECK-LABEL: sil hidden @_TF23guaranteed_struct_field14callOnLetField
+// CHECK:         [[INNER:%.*]] = struct_extract {{%.*}} : $Outer, #Outer.inner
+// CHECK:         [[C:%.*]] = struct_extract [[INNER]] : $Inner, #Inner.c
+// CHECK-NOT:     strong_retain [[C]]
+// CHECK:         apply {{%.*}}([[C]])
+// CHECK-NOT:     strong_release [[C]]
+// CHECK:         return
+func callOnLetField(_ o: Outer) {
+  let local = o
+  local.inner.c.method()
+}
+
+// A 'var' may be changed by the callee, so its fields are still copied.
+// CHECK-LABEL: sil hidden @_TF23guaranteed_struct_field14callOnVarField
+// CHECK:         strong_retain
+// CHECK:         apply
+// CHECK:         strong_release
+// CHECK:         return
+func callOnVarField(_ o: Outer) {
+  var local = o
+  local.c.method()
+}
@@ -0,0 +1,30 @@
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -profile-generate -profile-entry-counts-only %s | FileCheck %s
+// RUN: not %target-swift-frontend -parse-as-library -emit-silgen -profile-generate -profile-entry-counts-only -profile-coverage-mapping %s 2>&1 | FileCheck -check-prefix=CHECK-COVERAGE %s
+
+// CHECK-COVERAGE: error: argument '-profile-entry-counts-only' is not allowed with '-profile-coverage-mapping'
+
+// Only the entry of the function and of the closure are counted, not the
+// branches and loops.
+
+// CHECK-LABEL: sil hidden @{{.*}}branches
+// CHECK: %[[HASH:.*]] = integer_literal $Builtin.Int64, 1
+// CHECK: %[[NCOUNTS:.*]] = integer_literal $Builtin.Int32, 2
+// CHECK: %[[INDEX:.*]] = integer_literal $Builtin.Int32, 0
+// CHECK: builtin "int_instrprof_increment"({{.*}}, %[[HASH]] : {{.*}}, %[[NCOUNTS]] : {{.*}}, %[[INDEX]] : {{.*}})
+// CHECK-NOT: builtin "int_instrprof_increment"
+// CHECK: return
+func branches(a : Int32) -> Int32 {
+  if a == 0 {
+    return 1
+  }
+  for _ in 0 ..< a {
+  }
+  let c = { (x : Int32) -> Int32 in x == 0 ? 1 : x }
+  return c(a)
+}
+
+// CHECK-LABEL: sil shared @{{.*}}branches
+// CHECK: %[[INDEX:.*]] = integer_literal $Builtin.Int32, 1
+// CHECK: builtin "int_instrprof_increment"({{.*}}, %[[INDEX]] : {{.*}})
+// CHECK-NOT: builtin "int_instrprof_increment"
+// CHECK: return
@@ -0,0 +1,11 @@
+@_silgen_name("unknown")
+public func unknown() -> ()
+
+public func inlinedOnDemand() {
+  unknown()
+}
+
+@inline(never)
+public func neverInlined() {
+  unknown()
+}
@@ -0,0 +1,11 @@
+public struct Point {
+  public var x: Int
+
+  public init(x: Int) {
+    self.x = x
+  }
+}
+
+public func appendPoint(_ points: inout [Point], x: Int) {
+  points.append(Point(x: x))
+}
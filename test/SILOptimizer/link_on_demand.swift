@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module %S/Inputs/link_on_demand_input.swift -o %t -parse-as-library -sil-serialize-all
+// RUN: %target-swift-frontend %s -O -I %t -sil-link-on-demand -emit-sil -o - | FileCheck %s
+
+// REQUIRES: asserts
+// RUN: %target-swift-frontend %s -O -I %t -sil-link-on-demand -emit-sil -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+import link_on_demand_input
+
+// The body of inlinedOnDemand is deserialized when the inliner asks for it.
+// neverInlined can't be inlined, so its body is never loaded.
+
+// CHECK-LABEL: sil @main
+// CHECK-NOT: function_ref @{{.*}}inlinedOnDemand
+// CHECK: function_ref @unknown
+// CHECK: function_ref @{{.*}}neverInlined
+// CHECK: return
+
+// CHECK: sil @{{.*}}neverInlined{{.*}} : $@convention(thin) () -> (){{$}}
+
+// STATS: {{[0-9]+}} sil-module{{ +}}- Number of SIL function bodies linked on demand
+
+inlinedOnDemand()
+neverInlined()
@@ -0,0 +1,21 @@
+// RUN: %target-swift-frontend -O -parse-as-library -emit-sil -prespecialize-list %S/Inputs/prespecialize_list.txt %s | FileCheck %s
+// RUN: %target-swift-frontend -O -parse-as-library -emit-sil -prespecialize-list %S/Inputs/prespecialize_list_bad.txt %s 2>&1 | FileCheck -check-prefix=BAD %s
+// RUN: not %target-swift-frontend -O -parse-as-library -emit-sil -prespecialize-list %S/Inputs/no_such_list.txt %s 2>&1 | FileCheck -check-prefix=MISSING %s
+
+// The generic function dispatches to the listed specialization...
+// CHECK-LABEL: sil [noinline] @_TF18prespecialize_list8identityurFxx
+// CHECK: function_ref @_TTSg5Si___TF18prespecialize_list8identityurFxx
+// CHECK: return
+
+// ...which is public, for clients to call directly.
+// CHECK-LABEL: sil @_TTSg5Si___TF18prespecialize_list8identityurFxx : $@convention(thin) (Int) -> Int
+
+// BAD: warning: not prespecializing '_TF18prespecialize_list8identityurFxx': cannot find type 'NoSuchModule.Thing'
+// BAD: warning: not prespecializing '_TF18prespecialize_list8identityurFxx': the types do not satisfy its requirements
+
+// MISSING: error: cannot read prespecialization list '{{.*}}no_such_list.txt'
+
+@inline(never)
+public func identity<T>(_ x: T) -> T {
+  return x
+}
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -O -enable-specialization-sharing -parse-as-library -emit-module -module-name SharedTypes -o %t %S/Inputs/specialization_sharing_types.swift
+// RUN: %target-swift-frontend -O -enable-specialization-sharing -parse-as-library -module-name SharedTypes -emit-sil %S/Inputs/specialization_sharing_types.swift | FileCheck -check-prefix=EXPORT %s
+// RUN: %target-swift-frontend -O -enable-specialization-sharing -I %t -emit-sil %s | FileCheck %s
+// RUN: %target-swift-frontend -O -I %t -emit-sil %s | FileCheck -check-prefix=NOSHARING %s
+
+import SharedTypes
+
+// The module which declares Point exports the specializations for it...
+// EXPORT: sil @_TTSg5V11SharedTypes5Point___TFSa6append{{.*}} : $@convention(method)
+
+// ...and the modules which import it refer to them instead of specializing
+// again.
+// CHECK-LABEL: sil {{.*}}@_TF22specialization_sharing9addPoints
+// CHECK: function_ref @_TTSg5V11SharedTypes5Point___TFSa6append
+// CHECK: sil public_external @_TTSg5V11SharedTypes5Point___TFSa6append{{.*}} : $@convention(method)
+// CHECK-NOT: sil shared {{.*}}@_TTSg5V11SharedTypes5Point___TFSa6append
+
+// NOSHARING: sil shared {{.*}}@_TTSg5V11SharedTypes5Point___TFSa6append
+@inline(never)
+public func addPoints(_ points: inout [Point]) {
+  points.append(Point(x: 1))
+}
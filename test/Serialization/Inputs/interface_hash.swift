@@ -0,0 +1,27 @@
+public struct Point {
+  public var x: Int
+#if LAYOUT_CHANGE
+  private var y: Int = 0
+#endif
+  public init(x: Int) { self.x = x }
+}
+
+public func publicFunc() -> Int {
+#if BODY_CHANGE
+  return privateFunc() + 1
+#else
+  return privateFunc()
+#endif
+}
+
+private func privateFunc() -> Int {
+#if BODY_CHANGE
+  return 2
+#else
+  return 1
+#endif
+}
+
+#if PUBLIC_CHANGE
+public func addedFunc() {}
+#endif
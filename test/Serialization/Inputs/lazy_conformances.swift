@@ -0,0 +1,9 @@
+public protocol LazyP {
+  associatedtype Assoc
+  func method() -> Assoc
+}
+
+public struct LazyConformingStruct : LazyP {
+  public init() {}
+  public func method() -> Int { return 0 }
+}
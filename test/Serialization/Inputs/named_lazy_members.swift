@@ -0,0 +1,23 @@
+public struct LazyStruct {
+  public var x: Int
+  public init(x: Int) { self.x = x }
+  public func first() -> Int { return x }
+  public func second() -> Int { return x + 1 }
+  public func third() -> Int { return x + 2 }
+}
+
+extension LazyStruct {
+  public func fromExtension() -> Int { return x * 2 }
+  public static func make() -> LazyStruct { return LazyStruct(x: 0) }
+}
+
+public class LazyClass {
+  public init() {}
+  public func method() -> Int { return 0 }
+  public func unused() -> Int { return 1 }
+}
+
+public enum LazyEnum {
+  case a, b
+  public func describe() -> LazyEnum { return self }
+}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir -p %t/base %t/body %t/layout %t/public
+// RUN: %target-swift-frontend -emit-module -o %t/base %S/Inputs/interface_hash.swift
+// RUN: %target-swift-frontend -emit-module -o %t/body %S/Inputs/interface_hash.swift -D BODY_CHANGE
+// RUN: %target-swift-frontend -emit-module -o %t/layout %S/Inputs/interface_hash.swift -D LAYOUT_CHANGE
+// RUN: %target-swift-frontend -emit-module -o %t/public %S/Inputs/interface_hash.swift -D PUBLIC_CHANGE
+// RUN: llvm-bcanalyzer -dump %t/base/interface_hash.swiftmodule > %t/hashes.txt
+// RUN: llvm-bcanalyzer -dump %t/body/interface_hash.swiftmodule >> %t/hashes.txt
+// RUN: llvm-bcanalyzer -dump %t/layout/interface_hash.swiftmodule >> %t/hashes.txt
+// RUN: llvm-bcanalyzer -dump %t/public/interface_hash.swiftmodule >> %t/hashes.txt
+// RUN: FileCheck %s < %t/hashes.txt
+
+// Editing function bodies that clients can't inline keeps the hash the same.
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '[[BASE:[0-9a-f]+]]'
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '[[BASE]]'
+
+// Private stored properties change the layout clients see.
+// CHECK-NOT: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '[[BASE]]'
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '{{[0-9a-f]+}}'
+
+// So do new public declarations.
+// CHECK-NOT: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '[[BASE]]'
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '{{[0-9a-f]+}}'
+// CHECK-NOT: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '[[BASE]]'
@@ -0,0 +1,18 @@
+// REQUIRES: asserts
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/lazy_conformances.swift
+// RUN: %target-swift-frontend -parse -I %t %s -print-stats 2>&1 | FileCheck %s
+
+// Only asking whether a type conforms shouldn't pull in any witnesses.
+
+// CHECK: Statistics Collected
+// CHECK: {{[0-9]+}} Serialization{{ +}}- # of normal conformances deserialized
+// CHECK-NOT: # of normal conformances whose value witnesses were loaded
+
+import lazy_conformances
+
+func requiresP<T : LazyP>(_: T) {}
+
+func test(s: LazyConformingStruct) {
+  requiresP(s)
+}
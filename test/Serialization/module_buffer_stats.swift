@@ -0,0 +1,13 @@
+// REQUIRES: asserts
+// RUN: %target-swift-frontend -parse %s -print-stats 2>&1 | FileCheck %s
+
+// The standard library module is large enough to always be mapped rather
+// than read into memory, and only a fraction of it should be deserialized.
+
+// CHECK: Statistics Collected
+// CHECK-DAG: {{[0-9]+}} Serialization{{ +}}- # of module file bytes memory-mapped
+// CHECK-DAG: {{[0-9]+}} Serialization{{ +}}- # of module file bytes read while deserializing decls and types
+
+func useStdlib(x: [Int]) -> Int {
+  return x.count
+}
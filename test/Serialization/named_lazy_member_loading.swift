@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/named_lazy_members.swift
+// RUN: llvm-bcanalyzer %t/named_lazy_members.swiftmodule | FileCheck -check-prefix=BCANALYZER %s
+// RUN: %target-swift-frontend -parse -I %t %s
+// RUN: %target-swift-frontend -parse -I %t %s -enable-named-lazy-member-loading
+
+// BCANALYZER-NOT: UnknownCode
+
+// REQUIRES: asserts
+// RUN: %target-swift-frontend -parse -I %t %s -enable-named-lazy-member-loading -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+// RUN: %target-swift-frontend -parse -I %t %s -print-stats 2>&1 | FileCheck -check-prefix=NO-NAMED %s
+
+// STATS: Statistics Collected
+// STATS: {{[0-9]+}} Serialization{{ +}}- # of members loaded by name
+
+// NO-NAMED: Statistics Collected
+// NO-NAMED-NOT: # of members loaded by name
+
+import named_lazy_members
+
+func useMembers(s: LazyStruct, c: LazyClass, e: LazyEnum) -> Int {
+  _ = LazyStruct.make()
+  _ = e.describe()
+  return s.first() + s.fromExtension() + c.method()
+}
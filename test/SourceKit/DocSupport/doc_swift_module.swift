@@ -3,3 +3,8 @@
 // RUN: %swift -emit-module -o %t.mod/cake.swiftmodule %S/Inputs/cake.swift -parse-as-library
 // RUN: %sourcekitd-test -req=doc-info -module cake -- -I %t.mod > %t.response
 // RUN: diff -u %s.response %t.response
+
+// The second request reuses the documentation of the unchanged module.
+// RUN: %sourcekitd-test -req=doc-info -module cake -- -I %t.mod == -req=doc-info -module cake -- -I %t.mod > %t.response.twice
+// RUN: cat %s.response %s.response > %t.response.expected
+// RUN: diff -u %t.response.expected %t.response.twice
@@ -25,3 +25,9 @@ func f(s : inout [Int]) {
 // RUN: %sourcekitd-test -req=interface-gen-open -module Swift \
 // RUN: 	== -req=find-usr -usr "s:FesRxs17MutableCollectionxs22RandomAccessCollectionWxPs10Collection8Iterator7Element_s10ComparablerS_4sortFT_T_::SYNTHESIZED::USRDOESNOTEXIST" | FileCheck -check-prefix=SYNTHESIZED-USR3 %s
 // SYNTHESIZED-USR3-NOT: USR NOT FOUND
+
+// Opening the module again reuses the interface of the open document.
+// RUN: %sourcekitd-test -req=interface-gen-open -module swift_mod -- -I %t.mod \
+// RUN: 	== -req=interface-gen-open -module swift_mod -- -I %t.mod \
+// RUN: 	== -req=find-usr -usr "s:C9swift_mod7MyClass" | FileCheck -check-prefix=REOPEN-USR %s
+// REOPEN-USR-NOT: USR NOT FOUND
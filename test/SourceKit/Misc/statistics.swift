@@ -0,0 +1,14 @@
+// RUN: %sourcekitd-test -req=structure %s == -req=statistics | FileCheck %s
+
+struct S {
+  func foo() {}
+}
+
+// CHECK: key.results: [
+// CHECK:      key.name: "editor.parse",
+// CHECK-NEXT: key.count: 1,
+// CHECK:      key.buckets: [
+// CHECK:      key.name: "source.request.editor.open",
+// CHECK-NEXT: key.count: 1,
+// CHECK:      key.name: "source.request.editor.open.response",
+// CHECK-NEXT: key.count: 1,
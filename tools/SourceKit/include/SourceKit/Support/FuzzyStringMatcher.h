@@ -32,6 +32,8 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The character mask of the pattern. \see getCharacterMask.
+  uint64_t patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -39,6 +41,21 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Computes a summary of the case-insensitive set of characters in \p str.
+  ///
+  /// Candidates are expected to compute their mask once and pass it to
+  /// \c mayMatchCandidateMask whenever they are filtered.
+  static uint64_t getCharacterMask(StringRef str);
+
+  /// Whether a candidate with the character mask \p candidateMask may match
+  /// the pattern.
+  ///
+  /// A false result means the candidate lacks some character of the pattern
+  /// and does not need to be checked with \c matchesCandidate.
+  bool mayMatchCandidateMask(uint64_t candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
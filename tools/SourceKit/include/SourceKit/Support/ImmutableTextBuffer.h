@@ -27,6 +27,10 @@ namespace llvm {
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -158,8 +162,16 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   ImmutableTextUpdateRef CurrUpd;
   std::string Filename;
 
+  /// The text as of \c RopeUpd, kept between calls to \c getBufferForSnapshot
+  /// so that materializing a later snapshot only needs to apply the updates
+  /// made since.
+  llvm::sys::Mutex RopeMtx;
+  std::unique_ptr<clang::RewriteRope> Rope;
+  ImmutableTextUpdateRef RopeUpd;
+
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
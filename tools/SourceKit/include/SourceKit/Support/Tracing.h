@@ -15,7 +15,9 @@
 
 #include "SourceKit/Support/UIdent.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/Support/TimeValue.h"
 
+#include <string>
 #include <vector>
 
 namespace SourceKit {
@@ -126,6 +128,57 @@ public:
 
 };
 
+// Latency histogram for one kind of operation. Bucket 0 counts operations
+// that took less than 1 ms, bucket I > 0 the ones that took at least 2^(I-1)
+// and less than 2^I ms; the last bucket also counts anything longer.
+struct LatencyHistogram {
+  static const unsigned NumBuckets = 16;
+
+  uint64_t Count = 0;
+  uint64_t TotalUSec = 0;
+  uint64_t MaxUSec = 0;
+  uint64_t Buckets[NumBuckets] = {};
+
+  void add(uint64_t USec);
+
+  // Upper limit of a bucket, in milliseconds.
+  static uint64_t getBucketLimitMSec(unsigned Bucket) {
+    return uint64_t(1) << Bucket;
+  }
+};
+
+// Record that an operation, e.g. a request kind or a phase like "ast-build",
+// took \p USec microseconds. This is independent of whether tracing is
+// enabled.
+void recordLatency(llvm::StringRef Name, uint64_t USec);
+
+// The latency histograms recorded so far, sorted by name.
+std::vector<std::pair<std::string, LatencyHistogram>> getLatencyHistograms();
+
+// Class that utilizes the RAII idiom to record the latency of a scope
+class LatencyTimer final {
+  llvm::StringRef Name;
+  llvm::sys::TimeValue Start;
+  bool Finished = false;
+
+public:
+  explicit LatencyTimer(llvm::StringRef Name)
+    : Name(Name), Start(llvm::sys::TimeValue::now()) {}
+  ~LatencyTimer() {
+    finish();
+  }
+
+  LatencyTimer(const LatencyTimer &) = delete;
+  LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+  void finish() {
+    if (!Finished) {
+      recordLatency(Name, (llvm::sys::TimeValue::now() - Start).usec());
+      Finished = true;
+    }
+  }
+};
+
 } // namespace sourcekitd
 } // namespace trace
 
@@ -14,6 +14,11 @@
 #include "clang/Basic/CharInfo.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MathExtras.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace SourceKit;
 using clang::toUppercase;
@@ -22,7 +27,8 @@ using clang::isUppercase;
 using clang::isLowercase;
 
 FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
-    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)) {
+    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)),
+      patternMask(getCharacterMask(pattern_)) {
   lowercasePattern.reserve(pattern.size());
   unsigned upperCharCount = 0;
   for (char c : pattern) {
@@ -50,6 +56,43 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  // Characters share bits, which only makes the mask less precise.
+  uint64_t mask = 0;
+  for (char c : str)
+    mask |= uint64_t(1) << (static_cast<unsigned char>(toLowercase(c)) & 63);
+  return mask;
+}
+
+/// Returns the index of the first character at or after \p from in
+/// \p candidate that is either \p lower or \p upper, or the size of
+/// \p candidate if there is none.
+static unsigned findEitherChar(StringRef candidate, unsigned from, char lower,
+                               char upper) {
+  const char *data = candidate.data();
+  unsigned size = candidate.size();
+
+#ifdef __SSE2__
+  // Compare 16 characters at a time.
+  const __m128i lowerChars = _mm_set1_epi8(lower);
+  const __m128i upperChars = _mm_set1_epi8(upper);
+  for (; from + 16 <= size; from += 16) {
+    __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+    __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chars, lowerChars),
+                                   _mm_cmpeq_epi8(chars, upperChars));
+    if (unsigned bits = _mm_movemask_epi8(matches))
+      return from + llvm::countTrailingZeros(bits);
+  }
+#endif
+
+  for (; from < size; ++from) {
+    if (data[from] == lower || data[from] == upper)
+      return from;
+  }
+  return size;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
@@ -57,16 +100,15 @@ bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
     return false;
 
   // Do all of the pattern characters match the candidate in order?
-  unsigned pidx = 0, cidx = 0;
-  while (pidx < patternLength && cidx < candidateLength) {
-    char c = candidate[cidx];
-    char p = lowercasePattern[pidx];
-    if (p == c || p == toLowercase(c))
-      ++pidx;
+  unsigned cidx = 0;
+  for (char p : lowercasePattern) {
+    cidx = findEitherChar(candidate, cidx, p, toUppercase(p));
+    if (cidx == candidateLength)
+      return false;
     ++cidx;
   }
 
-  return pidx == patternLength;
+  return true;
 }
 
 static bool isTokenizingChar(char c) {
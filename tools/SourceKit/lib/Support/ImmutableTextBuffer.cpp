@@ -125,6 +125,8 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   CurrUpd = Root;
 }
 
+EditableTextBuffer::~EditableTextBuffer() = default;
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -170,15 +172,10 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
 
 static std::unique_ptr<llvm::MemoryBuffer>
 getMemBufferFromRope(StringRef Filename, const RewriteRope &Rope) {
-  size_t Length = 0;
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    Length += I.piece().size();
-  }
-
-  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Length, Filename);
+  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Rope.size(),
+                                                          Filename);
   char *Ptr = (char*)MemBuf->getBufferStart();
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
+  for (RewriteRope::const_iterator I = Rope.begin(), E = Rope.end(); I != E;
        I.MoveToNextPiece()) {
     StringRef Text = I.piece();
     memcpy(Ptr, Text.data(), Text.size());
@@ -188,6 +185,16 @@ getMemBufferFromRope(StringRef Filename, const RewriteRope &Rope) {
   return MemBuf;
 }
 
+/// Whether \p End can be reached by following the updates after \p Begin.
+static bool isSameOrLaterUpdate(ImmutableTextUpdateRef Begin,
+                                const ImmutableTextUpdateRef &End) {
+  for (; Begin; Begin = Begin->getNext()) {
+    if (Begin == End)
+      return true;
+  }
+  return false;
+}
+
 ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     const ImmutableTextSnapshot &Snap) {
   if (auto Buf = dyn_cast<ImmutableTextBuffer>(Snap.DiffEnd))
@@ -198,33 +205,41 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
-  // Check if a buffer was created in the middle of the snapshot updates.
-  ImmutableTextBufferRef StartBuf = Snap.BufferStart;
-  ImmutableTextUpdateRef Upd = StartBuf;  
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
-      StartBuf = Buf;
-  }
-  StringRef StartText = StartBuf->getText();
-
-  RewriteRope Rope;
-  auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
-    if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
-      StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+  std::unique_ptr<llvm::MemoryBuffer> MemBuf;
+  {
+    llvm::sys::ScopedLock RL(RopeMtx);
+
+    // If the rope isn't at or before this snapshot, start it over from the
+    // last buffer created before the snapshot.
+    if (!Rope || !isSameOrLaterUpdate(RopeUpd, Snap.DiffEnd)) {
+      ImmutableTextBufferRef StartBuf = Snap.BufferStart;
+      ImmutableTextUpdateRef Upd = StartBuf;
+      while (Upd != Snap.DiffEnd) {
+        Upd = Upd->Next;
+        if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
+          StartBuf = Buf;
+      }
+      StringRef StartText = StartBuf->getText();
+
+      if (!Rope)
+        Rope.reset(new RewriteRope);
+      Rope->assign(StartText.begin(), StartText.end());
+      RopeUpd = StartBuf;
+    }
+
+    // Only apply the updates made since the rope was last used.
+    while (RopeUpd != Snap.DiffEnd) {
+      RopeUpd = RopeUpd->Next;
+      if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(RopeUpd)) {
+        Rope->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+        StringRef Text = ReplaceUpd->getText();
+        Rope->insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+      }
     }
-  };
 
-  Rope.assign(StartText.begin(), StartText.end());
-  Upd = StartBuf;
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    applyUpdate(Upd);
+    MemBuf = getMemBufferFromRope(getFilename(), *Rope);
   }
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
                                                           Snap.getStamp());
 
@@ -14,9 +14,13 @@
 
 #include "swift/Frontend/Frontend.h"
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/YAMLTraits.h"
 
+#include <algorithm>
+#include <mutex>
+
 using namespace SourceKit;
 using namespace llvm;
 
@@ -91,3 +95,49 @@ void trace::registerConsumer(trace::TraceConsumer *Consumer) {
                                             std::memory_order_release,
                                             std::memory_order_relaxed));
 }
+
+//===----------------------------------------------------------------------===//
+// Latency accounting
+//===----------------------------------------------------------------------===//
+
+void trace::LatencyHistogram::add(uint64_t USec) {
+  ++Count;
+  TotalUSec += USec;
+  MaxUSec = std::max(MaxUSec, USec);
+
+  unsigned Bucket = 0;
+  while (Bucket + 1 < NumBuckets && USec >= getBucketLimitMSec(Bucket) * 1000)
+    ++Bucket;
+  ++Buckets[Bucket];
+}
+
+static std::mutex &getLatencyMutex() {
+  static std::mutex Mtx;
+  return Mtx;
+}
+
+static llvm::StringMap<trace::LatencyHistogram> &getLatencyHistogramMap() {
+  static llvm::StringMap<trace::LatencyHistogram> Histograms;
+  return Histograms;
+}
+
+void trace::recordLatency(StringRef Name, uint64_t USec) {
+  std::lock_guard<std::mutex> Lock(getLatencyMutex());
+  getLatencyHistogramMap()[Name].add(USec);
+}
+
+std::vector<std::pair<std::string, trace::LatencyHistogram>>
+trace::getLatencyHistograms() {
+  std::vector<std::pair<std::string, LatencyHistogram>> Result;
+  {
+    std::lock_guard<std::mutex> Lock(getLatencyMutex());
+    for (auto &Entry : getLatencyHistogramMap())
+      Result.push_back({ Entry.getKey().str(), Entry.getValue() });
+  }
+  std::sort(Result.begin(), Result.end(),
+            [](const std::pair<std::string, LatencyHistogram> &LHS,
+               const std::pair<std::string, LatencyHistogram> &RHS) {
+    return LHS.first < RHS.first;
+  });
+  return Result;
+}
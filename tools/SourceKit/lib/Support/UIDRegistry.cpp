@@ -11,9 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/UIdent.h"
-#include "SourceKit/Support/Concurrency.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -21,13 +24,44 @@ using namespace SourceKit;
 using llvm::StringRef;
 
 namespace {
+/// Interns UID names in an insert-only, open addressing hash table.
+///
+/// Lookups of existing names, which is what almost every UID construction
+/// is, don't take any lock: entries are never removed or moved, and a table
+/// that gets too full is replaced by a bigger copy while the old one stays
+/// valid for readers that are still probing it. A name that isn't found is
+/// looked up again and inserted under the lock.
 class UIDRegistryImpl {
-  typedef llvm::StringMap<void *, llvm::BumpPtrAllocator> HashTableTy;
   typedef llvm::StringMapEntry<void *> EntryTy;
-  HashTableTy HashTable;
-  WorkQueue Queue{ WorkQueue::Dequeuing::Concurrent, "UIDRegistryImpl" };
+
+  struct Slot {
+    std::atomic<unsigned> Hash{0};
+    std::atomic<EntryTy *> Entry{nullptr};
+  };
+
+  struct Table {
+    const unsigned Capacity; // Always a power of two.
+    std::unique_ptr<Slot[]> Slots;
+
+    explicit Table(unsigned Capacity)
+      : Capacity(Capacity), Slots(new Slot[Capacity]) {}
+
+    EntryTy *find(StringRef Str, unsigned Hash) const;
+    void insert(EntryTy *Entry, unsigned Hash);
+  };
+
+  std::atomic<Table *> CurrentTable;
+  /// Protects insertion; the tables that were replaced are kept alive here.
+  std::mutex InsertMtx;
+  std::vector<std::unique_ptr<Table>> Tables;
+  unsigned NumEntries = 0;
+  llvm::BumpPtrAllocator Allocator;
 
 public:
+  UIDRegistryImpl() {
+    Tables.emplace_back(new Table(1024));
+    CurrentTable = Tables.back().get();
+  }
 
   void *get(StringRef Str);
   static StringRef getName(void *Ptr);
@@ -82,24 +116,60 @@ void UIdent::print(llvm::raw_ostream &OS) const {
     OS << getName();
 }
 
+UIDRegistryImpl::EntryTy *
+UIDRegistryImpl::Table::find(StringRef Str, unsigned Hash) const {
+  for (unsigned I = Hash & (Capacity - 1);; I = (I + 1) & (Capacity - 1)) {
+    EntryTy *Entry = Slots[I].Entry.load(std::memory_order_acquire);
+    if (!Entry)
+      return nullptr;
+    if (Slots[I].Hash.load(std::memory_order_relaxed) == Hash &&
+        Entry->getKey() == Str)
+      return Entry;
+  }
+}
+
+void UIDRegistryImpl::Table::insert(EntryTy *Entry, unsigned Hash) {
+  for (unsigned I = Hash & (Capacity - 1);; I = (I + 1) & (Capacity - 1)) {
+    if (!Slots[I].Entry.load(std::memory_order_relaxed)) {
+      Slots[I].Hash.store(Hash, std::memory_order_relaxed);
+      // Publish the entry after its hash and contents.
+      Slots[I].Entry.store(Entry, std::memory_order_release);
+      return;
+    }
+  }
+}
+
 void *UIDRegistryImpl::get(StringRef Str) {
   assert(!Str.empty());
   assert(Str.find(' ') == StringRef::npos);
-  EntryTy *Ptr = 0;
-  Queue.dispatchSync([&]{
-    HashTableTy::iterator It = HashTable.find(Str);
-    if (It != HashTable.end())
-      Ptr = &(*It);
-  });
-
-  if (Ptr == 0) {
-    Queue.dispatchBarrierSync([&]{
-      EntryTy &Entry = *HashTable.insert(std::make_pair(Str, nullptr)).first;
-      Ptr = &Entry;
-    });
+  unsigned Hash = llvm::HashString(Str);
+
+  if (EntryTy *Entry =
+          CurrentTable.load(std::memory_order_acquire)->find(Str, Hash))
+    return Entry;
+
+  std::lock_guard<std::mutex> Lock(InsertMtx);
+  Table *T = CurrentTable.load(std::memory_order_relaxed);
+  // Another thread may have inserted it after our lookup.
+  if (EntryTy *Entry = T->find(Str, Hash))
+    return Entry;
+
+  // Keep the load factor at or below 1/2 so that probe sequences stay short.
+  if ((NumEntries + 1) * 2 > T->Capacity) {
+    Table *NewT = new Table(T->Capacity * 2);
+    for (unsigned I = 0; I != T->Capacity; ++I) {
+      if (EntryTy *Entry = T->Slots[I].Entry.load(std::memory_order_relaxed))
+        NewT->insert(Entry, T->Slots[I].Hash.load(std::memory_order_relaxed));
+    }
+    Tables.emplace_back(NewT);
+    CurrentTable.store(NewT, std::memory_order_release);
+    T = NewT;
   }
 
-  return Ptr;
+  EntryTy *Entry = EntryTy::Create(Str, Allocator, nullptr);
+  T->insert(Entry, Hash);
+  ++NumEntries;
+  return Entry;
 }
 
 StringRef UIDRegistryImpl::getName(void *Ptr) {
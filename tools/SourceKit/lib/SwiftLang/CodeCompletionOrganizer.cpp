@@ -20,7 +20,9 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
+#include <atomic>
 #include <deque>
+#include <thread>
 
 using namespace SourceKit;
 using namespace CodeCompletion;
@@ -216,9 +218,10 @@ public:
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
                                 const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches);
 
-  void sort(Options options);
+  void sort(Options options, unsigned sortLimit);
 
   void groupOverloads() {
     groupStemsRecursive(
@@ -291,18 +294,20 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   impl.addCompletionsWithFilter(completions, filterText, options, rules,
-                                exactMatch);
+                                exactMatch, matches);
 }
 
-void CodeCompletionOrganizer::groupAndSort(const Options &options) {
+void CodeCompletionOrganizer::groupAndSort(const Options &options,
+                                           unsigned sortLimit) {
   if (options.groupStems)
     impl.groupStems();
   else if (options.groupOverloads)
     impl.groupOverloads();
 
-  impl.sort(options);
+  impl.sort(options, sortLimit);
 }
 
 CodeCompletionViewRef CodeCompletionOrganizer::takeResultsView() {
@@ -506,9 +511,46 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
   return hideAll;
 }
 
+/// The number of results scored by each thread in \c scoreResults.
+static constexpr size_t scoringChunkSize = 2048;
+
+/// Sets the match score of each of \p results against \p pattern, spreading
+/// the work across threads when there are enough results.
+static void scoreResults(const FuzzyStringMatcher &pattern,
+                         ArrayRef<std::unique_ptr<Item>> results) {
+  size_t numChunks = (results.size() + scoringChunkSize - 1) / scoringChunkSize;
+  auto scoreChunk = [&](size_t chunk) {
+    size_t end = std::min(results.size(), (chunk + 1) * scoringChunkSize);
+    for (size_t i = chunk * scoringChunkSize; i < end; ++i) {
+      Result *result = cast<Result>(results[i].get());
+      result->matchScore = pattern.scoreCandidate(result->value->getName());
+    }
+  };
+
+  size_t numThreads =
+      std::min<size_t>(std::thread::hardware_concurrency(), numChunks);
+  if (numThreads > 1) {
+    std::atomic<size_t> nextChunk(0);
+    auto scoreRemaining = [&] {
+      for (size_t i = nextChunk++; i < numChunks; i = nextChunk++)
+        scoreChunk(i);
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i)
+      threads.push_back(std::thread(scoreRemaining));
+    scoreRemaining();
+    for (std::thread &thread : threads)
+      thread.join();
+  } else {
+    for (size_t i = 0; i < numChunks; ++i)
+      scoreChunk(i);
+  }
+}
+
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -575,6 +617,9 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
+  bool fuzzyMatching =
+      options.fuzzyMatching && filterText.size() >= options.minFuzzyLength;
+  size_t firstNewResult = contents.size();
   for (Completion *completion : completions) {
     if (rules.hideCompletion(completion))
       continue;
@@ -590,12 +635,17 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
       continue;
 
     bool match = false;
-    if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
-      match = pattern.matchesCandidate(completion->getName());
+    if (fuzzyMatching) {
+      match =
+          pattern.mayMatchCandidateMask(completion->getNameCharacterMask()) &&
+          pattern.matchesCandidate(completion->getName());
     } else {
       match = completion->getName().startswith_lower(filterText);
     }
 
+    if (match && matches)
+      matches->push_back(completion);
+
     bool isExactMatch = match && completion->getName().equals_lower(filterText);
 
     if (isExactMatch) {
@@ -618,14 +668,15 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     // Build wrapper and add to results.
     if (match) {
       auto wrapper = make_result(completion);
-      if (options.fuzzyMatching) {
-        wrapper->matchScore = pattern.scoreCandidate(completion->getName());
-      }
       wrapper->isExactMatch = isExactMatch;
 
       contents.push_back(std::move(wrapper));
     }
   }
+
+  if (options.fuzzyMatching)
+    scoreResults(pattern,
+                 llvm::makeArrayRef(contents).slice(firstNewResult));
 }
 
 static double getSemanticContextScore(bool useImportDepth,
@@ -945,8 +996,38 @@ static void sortTopN(const Options &options, Group *group,
   }
 }
 
+/// Sorts \p contents with \p compare.
+///
+/// If \p sortLimit is non-zero, only the first \p sortLimit items are put in
+/// order, and the rest are left after them unsorted.
+template <typename Compare>
+static void sortItems(const Options &options,
+                      std::vector<std::unique_ptr<Item>> &contents,
+                      bool hasExpectedTypes, unsigned sortLimit,
+                      Compare compare) {
+  if (sortLimit == 0 || sortLimit >= contents.size()) {
+    std::sort(contents.begin(), contents.end(), compare);
+    return;
+  }
+
+  auto middle = contents.begin() + sortLimit;
+  std::partial_sort(contents.begin(), middle, contents.end(), compare);
+
+  // sortTopN may pull results from the rest of the list in front of leading
+  // literals, so those need to be in order too.
+  auto topBucket = getResultBucket(*contents[0], hasExpectedTypes);
+  if (options.showTopNonLiteralResults != 0 &&
+      (topBucket == ResultBucket::Literal ||
+       topBucket == ResultBucket::LiteralTypeMatch))
+    std::sort(middle, contents.end(), compare);
+}
+
+/// Sorts \p group and all of its subgroups.
+///
+/// If \p sortLimit is non-zero, only the first \p sortLimit items of \p group
+/// itself are put in order, and the rest are left after them unsorted.
 static void sortRecursive(const Options &options, Group *group,
-                          bool hasExpectedTypes) {
+                          bool hasExpectedTypes, unsigned sortLimit = 0) {
   // Sort all of the subgroups first, and fill in the bucket for each result.
   auto &contents = group->contents;
   double best = -1.0;
@@ -967,14 +1048,17 @@ static void sortRecursive(const Options &options, Group *group,
   // Now sort the group itself.
 
   if (options.sortByName) {
-    llvm::array_pod_sort(contents.begin(), contents.end(),
-        [](const std::unique_ptr<Item> *a, const std::unique_ptr<Item> *b) {
-      return compareResultName(**a, **b);
+    sortItems(options, contents, hasExpectedTypes, sortLimit,
+              [](const std::unique_ptr<Item> &a,
+                 const std::unique_ptr<Item> &b) {
+      return compareResultName(*a, *b) < 0;
     });
     return;
   }
 
-  std::sort(contents.begin(), contents.end(), [=](const std::unique_ptr<Item> &a_, const std::unique_ptr<Item> &b_) {
+  sortItems(options, contents, hasExpectedTypes, sortLimit,
+            [=](const std::unique_ptr<Item> &a_,
+                const std::unique_ptr<Item> &b_) {
     Item &a = *a_;
     Item &b = *b_;
 
@@ -1025,8 +1109,9 @@ static void sortRecursive(const Options &options, Group *group,
   });
 }
 
-void CodeCompletionOrganizer::Impl::sort(Options options) {
-  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes);
+void CodeCompletionOrganizer::Impl::sort(Options options, unsigned sortLimit) {
+  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes,
+                sortLimit);
   if (options.showTopNonLiteralResults != 0)
     sortTopN(options, rootGroup.get(), completionHasExpectedTypes);
 }
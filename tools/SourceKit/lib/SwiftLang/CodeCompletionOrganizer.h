@@ -86,12 +86,22 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p matches is given, the completions whose names match \p filterText
+  /// are appended to it in order.  Since any completion matching a longer
+  /// filter text also matches its prefixes, these can be passed back in when
+  /// the filter text is extended.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches = nullptr);
 
-  void groupAndSort(const Options &options);
+  /// Groups and sorts the results.
+  ///
+  /// If \p sortLimit is non-zero, only that many top-level results are put in
+  /// order; any results after them are in unspecified order.
+  void groupAndSort(const Options &options, unsigned sortLimit = 0);
 
   /// Finishes the results and returns them.
   /// For convenience, this returns a shared_ptr, but it is uniquely referenced.
@@ -29,8 +29,10 @@
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
@@ -172,6 +174,11 @@ namespace SourceKit {
     Queue.dispatch([ASTRef, ConsumerRef]{
       SwiftASTConsumer &ASTConsumer = *ConsumerRef;
 
+      if (ASTConsumer.isCancellationRequested()) {
+        ASTConsumer.cancelled();
+        return;
+      }
+
       CompilerInstance &CI = ASTRef->getCompilerInstance();
 
       if (CI.getPrimarySourceFile()) {
@@ -234,6 +241,12 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   ThreadSafeRefCntPtr<ASTUnit> AST;
   SmallVector<std::pair<std::string, BufferStamp>, 8> DependencyStamps;
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
+  /// Consumers that were popped off \c QueuedConsumers with a once-per-AST
+  /// token, so that a newer query with the same token can still cancel them.
+  llvm::DenseMap<const void*, std::weak_ptr<SwiftASTConsumer>>
+    DispatchedConsumers;
+  /// Whether a rebuild requested by \c rebuildInBackground hasn't run yet.
+  bool BackgroundRebuildQueued = false;
   llvm::sys::Mutex Mtx;
 
 public:
@@ -252,6 +265,11 @@ public:
   bool shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                      ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
+  /// Brings the AST up to date on the AST build queue, without a consumer
+  /// waiting for it, so that later requests find a fresh AST.
+  void rebuildInBackground(SwiftASTManager::Implementation &MgrImpl,
+                           ArrayRef<ImmutableTextSnapshotRef> Snapshots);
+
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
 
@@ -299,10 +317,31 @@ struct CacheKeyHashInfo<ASTKey> {
 } // namespace sys
 } // namespace swift.
 
+/// The memory the cached ASTs may use, in megabytes, unless overridden with
+/// SOURCEKIT_AST_CACHE_MEMORY_LIMIT.  Darwin's cache already gives up entries
+/// under memory pressure, so this is only a default elsewhere.
+#if defined(__APPLE__)
+static const unsigned DefaultASTCacheMemoryLimitMB = 0;
+#else
+static const unsigned DefaultASTCacheMemoryLimitMB = 1024;
+#endif
+
+static size_t getASTCacheMemoryLimit() {
+  unsigned LimitMB = DefaultASTCacheMemoryLimitMB;
+  if (const char *EnvOpt = ::getenv("SOURCEKIT_AST_CACHE_MEMORY_LIMIT")) {
+    if (StringRef(EnvOpt).getAsInteger(10, LimitMB))
+      LOG_WARN_FUNC("invalid SOURCEKIT_AST_CACHE_MEMORY_LIMIT: " << EnvOpt);
+  }
+  return size_t(LimitMB) << 20;
+}
+
 struct SwiftASTManager::Implementation {
   explicit Implementation(SwiftLangSupport &LangSupport)
     : EditorDocs(LangSupport.getEditorDocuments()),
-      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) { }
+      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) {
+    if (size_t Limit = getASTCacheMemoryLimit())
+      ASTCache.setCostLimit(Limit);
+  }
 
   SwiftEditorDocumentFileMap &EditorDocs;
   std::string RuntimeResourcePath;
@@ -465,6 +504,17 @@ SwiftASTManager::getInvocation(ArrayRef<const char *> OrigArgs,
       *new SwiftInvocation::Implementation(std::move(Opts)));
 }
 
+/// Whether any of the editor documents in \p Snapshots has been edited after
+/// its snapshot was taken.
+static bool hasNewerSnapshots(ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  for (auto &Snap : Snapshots) {
+    if (auto EditableBuffer = Snap->getEditableBuffer())
+      if (EditableBuffer->getSnapshot()->getStamp() != Snap->getStamp())
+        return true;
+  }
+  return false;
+}
+
 void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
                                       SwiftASTConsumerRef ASTConsumer,
                                       const void *OncePerASTToken,
@@ -474,6 +524,11 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
     if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
+      // The consumer has been answered from a possibly stale AST; if the
+      // documents were edited since, start on the fresh one now instead of
+      // waiting for a request that needs it.
+      if (hasNewerSnapshots(Unit->getSnapshots()))
+        Producer->rebuildInBackground(Impl, Snapshots);
       return;
     }
   }
@@ -571,6 +626,22 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
   }, /*isStackDeep=*/true);
 }
 
+void ASTProducer::rebuildInBackground(SwiftASTManager::Implementation &MgrImpl,
+                                   ArrayRef<ImmutableTextSnapshotRef> Snaps) {
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    if (BackgroundRebuildQueued)
+      return;
+    BackgroundRebuildQueued = true;
+  }
+
+  ASTProducerRef ThisProducer = this;
+  getASTUnitAsync(MgrImpl, Snaps, [ThisProducer](ASTUnitRef, StringRef) {
+    llvm::sys::ScopedLock L(ThisProducer->Mtx);
+    ThisProducer->BackgroundRebuildQueued = false;
+  });
+}
+
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                    std::string &Error) {
@@ -601,6 +672,14 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
     }
+
+    LOG_FUNC_SECTION(InfoLowPrio) {
+      CacheStatistics Stats = MgrImpl.ASTCache.getStatistics();
+      Log->getOS() << "AST cache: " << Stats.Count << " ASTs, "
+                   << (Stats.TotalCost >> 20) << " MB, hit rate "
+                   << llvm::format("%.2f", Stats.getHitRate()) << ", "
+                   << Stats.Evictions << " evictions";
+    }
   }
 
   return AST;
@@ -618,6 +697,13 @@ void ASTProducer::enqueueConsumer(SwiftASTConsumerRef Consumer,
         break;
       }
     }
+
+    auto Found = DispatchedConsumers.find(OncePerASTToken);
+    if (Found != DispatchedConsumers.end()) {
+      if (auto Previous = Found->second.lock())
+        Previous->requestCancellation();
+      DispatchedConsumers.erase(Found);
+    }
   }
   QueuedConsumers.push_back({ std::move(Consumer), OncePerASTToken });
 }
@@ -626,8 +712,11 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   llvm::sys::ScopedLock L(Mtx);
   std::vector<SwiftASTConsumerRef> Consumers;
   Consumers.reserve(QueuedConsumers.size());
-  for (auto &C : QueuedConsumers)
+  for (auto &C : QueuedConsumers) {
+    if (C.second)
+      DispatchedConsumers[C.second] = C.first;
     Consumers.push_back(std::move(C.first));
+  }
   QueuedConsumers.clear();
   return Consumers;
 }
@@ -717,6 +806,7 @@ static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                       std::string &Error) {
+  trace::LatencyTimer BuildTimer("ast-build");
   Stamps.clear();
   DependencyStamps.clear();
 
@@ -793,7 +883,10 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
-  CompIns.performSema();
+  {
+    trace::LatencyTimer SemaTimer("ast-build.sema");
+    CompIns.performSema();
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -17,6 +17,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include <atomic>
 #include <string>
 
 namespace llvm {
@@ -60,9 +61,18 @@ public:
 typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
 
 class SwiftASTConsumer {
+  std::atomic<bool> CancellationRequested{false};
+
 public:
   virtual ~SwiftASTConsumer() { }
   virtual void cancelled() {}
+
+  /// Marks the consumer as no longer wanted, e.g. because a newer query
+  /// superseded it. If it hasn't been handed the AST yet, \c cancelled() is
+  /// called instead of \c handlePrimaryAST().
+  void requestCancellation() { CancellationRequested = true; }
+  bool isCancellationRequested() const { return CancellationRequested; }
+
   /// If there is an existing AST, this is called before trying to update it.
   /// Consumers may choose to still accept it even though it may have stale parts.
   ///
@@ -91,7 +101,8 @@ public:
   /// asynchronously.
   /// \param OncePerASTToken if non-null, a previous query with the same value
   /// token, that is enqueued waiting to be executed on the same AST, will be
-  /// cancelled.
+  /// cancelled. This includes a query that already has its AST but hasn't
+  /// started consuming it yet.
   void processASTAsync(SwiftInvocationRef Invok,
                        SwiftASTConsumerRef ASTConsumer,
                        const void *OncePerASTToken,
@@ -209,7 +209,10 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
       *CI.getASTContext().getClangModuleLoader());
   SwiftConsumer.setContext(&CI.getASTContext(), &Invocation,
                            &CompletionContext);
-  CI.performSema();
+  {
+    trace::LatencyTimer SemaTimer("code-completion.sema");
+    CI.performSema();
+  }
   SwiftConsumer.clearContext();
   return true;
 }
@@ -693,6 +696,26 @@ ArrayRef<Completion *> CodeCompletion::SessionCache::getSortedCompletions() {
   llvm::sys::ScopedLock L(mtx);
   return sortedCompletions;
 }
+std::vector<Completion *>
+CodeCompletion::SessionCache::getCompletionsForFilter(StringRef filterText,
+                                                      bool fuzzyMatching) {
+  llvm::sys::ScopedLock L(mtx);
+  // A name matching the longer filter text also matches the previous one,
+  // either way if that was fuzzy, and as a prefix otherwise.
+  if (!lastFilterText.empty() &&
+      filterText.startswith_lower(lastFilterText) &&
+      (lastFilterWasFuzzy || !fuzzyMatching))
+    return lastFilterMatches;
+  return sortedCompletions;
+}
+void CodeCompletion::SessionCache::setFilterMatches(
+    StringRef filterText, bool fuzzyMatching,
+    std::vector<Completion *> &&matches) {
+  llvm::sys::ScopedLock L(mtx);
+  lastFilterText = filterText;
+  lastFilterWasFuzzy = fuzzyMatching;
+  lastFilterMatches = std::move(matches);
+}
 llvm::MemoryBuffer *CodeCompletion::SessionCache::getBuffer() {
   llvm::sys::ScopedLock L(mtx);
   return buffer.get();
@@ -1005,8 +1028,18 @@ static void transformAndForwardResults(
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
   if (!hasEarlyInnerResults) {
-    organizer.addCompletionsWithFilter(session->getSortedCompletions(),
-                                       filterText, rules, exactMatch);
+    if (filterText.empty()) {
+      organizer.addCompletionsWithFilter(session->getSortedCompletions(),
+                                         filterText, rules, exactMatch);
+    } else {
+      bool fuzzyMatching = options.fuzzyMatching &&
+                           filterText.size() >= options.minFuzzyLength;
+      std::vector<Completion *> matches;
+      organizer.addCompletionsWithFilter(
+          session->getCompletionsForFilter(filterText, fuzzyMatching),
+          filterText, rules, exactMatch, &matches);
+      session->setFilterMatches(filterText, fuzzyMatching, std::move(matches));
+    }
   }
 
   if (hasEarlyInnerResults &&
@@ -1032,7 +1065,9 @@ static void transformAndForwardResults(
                                        CodeCompletion::FilterRules(), exactMatch);
   }
 
-  organizer.groupAndSort(options);
+  // Only the results up to the requested page need to be in order.
+  unsigned sortLimit = maxResults ? resultOffset + maxResults : 0;
+  organizer.groupAndSort(options, sortLimit);
 
   if ((options.addInnerResults || options.addInnerOperators) &&
       exactMatch && exactMatch->getKind() == Completion::Declaration) {
@@ -1091,7 +1126,7 @@ static void transformAndForwardResults(
     CodeCompletion::Options noGroupOpts = options;
     noGroupOpts.groupStems = false;
     noGroupOpts.groupOverloads = false;
-    organizer.groupAndSort(noGroupOpts);
+    organizer.groupAndSort(noGroupOpts, sortLimit);
   }
 
   // Build the final results view.
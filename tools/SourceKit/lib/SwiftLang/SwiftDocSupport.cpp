@@ -13,6 +13,7 @@
 #include "SwiftASTManager.h"
 #include "SwiftEditorDiagConsumer.h"
 #include "SwiftLangSupport.h"
+#include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "swift/AST/ASTPrinter.h"
@@ -27,9 +28,12 @@
 #include "swift/Sema/IDETypeChecking.h"
 #include "swift/Config.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
+#include <algorithm>
+
 using namespace SourceKit;
 using namespace swift;
 using namespace ide;
@@ -857,9 +861,201 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx, StringRef ModuleName,
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// SwiftDocInfoCache
+//===----------------------------------------------------------------------===//
+
+/// The documentation info reported for a module, together with the state of
+/// the module files it was generated from.
+class SwiftDocInfoCache::Entry : public DocInfoConsumer {
+  struct ModuleFileStatus {
+    std::string Filename;
+    uint64_t Size;
+    uint64_t ModTime;
+  };
+
+  enum class EventKind : uint8_t {
+    SourceText,
+    Annotation,
+    StartEntity,
+    Inherits,
+    ConformsTo,
+    Extends,
+    AvailableAttr,
+    FinishEntity,
+    Diagnostic,
+  };
+
+  std::vector<ModuleFileStatus> ModuleFiles;
+
+  /// The reported events in order, with the index of their info in the
+  /// vector for the kind of info.
+  std::vector<std::pair<EventKind, unsigned>> Events;
+  std::string SourceText;
+  std::vector<DocEntityInfo> EntityInfos;
+  std::vector<AvailableAttrInfo> AttrInfos;
+  std::vector<UIdent> FinishedKinds;
+  std::vector<DiagnosticEntryInfo> Diags;
+
+  bool addEntityInfo(EventKind Kind, const DocEntityInfo &Info) {
+    Events.push_back({ Kind, unsigned(EntityInfos.size()) });
+    EntityInfos.push_back(Info);
+    // The type belongs to the AST, which doesn't outlive the request.
+    EntityInfos.back().Ty = Type();
+    return true;
+  }
+
+public:
+  const std::string Key;
+
+  explicit Entry(std::string Key) : Key(std::move(Key)) {}
+
+  void addModuleFiles(Module *M) {
+    for (auto *File : M->getFiles()) {
+      auto *LF = dyn_cast<LoadedFile>(File);
+      if (!LF || LF->getFilename().empty())
+        continue;
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(LF->getFilename(), Status))
+        continue;
+      ModuleFiles.push_back({ LF->getFilename(), Status.getSize(),
+                        Status.getLastModificationTime().toEpochTime() });
+    }
+  }
+
+  bool isUpToDate() const {
+    for (auto &File : ModuleFiles) {
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(File.Filename, Status))
+        return false;
+      if (Status.getSize() != File.Size ||
+          Status.getLastModificationTime().toEpochTime() != File.ModTime)
+        return false;
+    }
+    return true;
+  }
+
+  /// Report the recorded events to \p Consumer, stopping early if it asks
+  /// for no more.
+  void replay(DocInfoConsumer &Consumer) const {
+    for (auto &Event : Events) {
+      bool Continue = true;
+      switch (Event.first) {
+      case EventKind::SourceText:
+        Continue = Consumer.handleSourceText(SourceText);
+        break;
+      case EventKind::Annotation:
+        Continue = Consumer.handleAnnotation(EntityInfos[Event.second]);
+        break;
+      case EventKind::StartEntity:
+        Continue = Consumer.startSourceEntity(EntityInfos[Event.second]);
+        break;
+      case EventKind::Inherits:
+        Continue = Consumer.handleInheritsEntity(EntityInfos[Event.second]);
+        break;
+      case EventKind::ConformsTo:
+        Continue = Consumer.handleConformsToEntity(EntityInfos[Event.second]);
+        break;
+      case EventKind::Extends:
+        Continue = Consumer.handleExtendsEntity(EntityInfos[Event.second]);
+        break;
+      case EventKind::AvailableAttr:
+        Continue = Consumer.handleAvailableAttribute(AttrInfos[Event.second]);
+        break;
+      case EventKind::FinishEntity:
+        Continue = Consumer.finishSourceEntity(FinishedKinds[Event.second]);
+        break;
+      case EventKind::Diagnostic:
+        Continue = Consumer.handleDiagnostic(Diags[Event.second]);
+        break;
+      }
+      if (!Continue)
+        return;
+    }
+  }
+
+  void failed(StringRef ErrDescription) override {}
+
+  bool handleSourceText(StringRef Text) override {
+    Events.push_back({ EventKind::SourceText, 0 });
+    SourceText = Text;
+    return true;
+  }
+
+  bool handleAnnotation(const DocEntityInfo &Info) override {
+    return addEntityInfo(EventKind::Annotation, Info);
+  }
+
+  bool startSourceEntity(const DocEntityInfo &Info) override {
+    return addEntityInfo(EventKind::StartEntity, Info);
+  }
+
+  bool handleInheritsEntity(const DocEntityInfo &Info) override {
+    return addEntityInfo(EventKind::Inherits, Info);
+  }
+
+  bool handleConformsToEntity(const DocEntityInfo &Info) override {
+    return addEntityInfo(EventKind::ConformsTo, Info);
+  }
+
+  bool handleExtendsEntity(const DocEntityInfo &Info) override {
+    return addEntityInfo(EventKind::Extends, Info);
+  }
+
+  bool handleAvailableAttribute(const AvailableAttrInfo &Info) override {
+    Events.push_back({ EventKind::AvailableAttr, unsigned(AttrInfos.size()) });
+    AttrInfos.push_back(Info);
+    return true;
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    Events.push_back({ EventKind::FinishEntity,
+                       unsigned(FinishedKinds.size()) });
+    FinishedKinds.push_back(Kind);
+    return true;
+  }
+
+  bool handleDiagnostic(const DiagnosticEntryInfo &Info) override {
+    Events.push_back({ EventKind::Diagnostic, unsigned(Diags.size()) });
+    Diags.push_back(Info);
+    return true;
+  }
+};
+
+/// The recorded documentation of a large module takes tens of megabytes, so
+/// only a few modules are kept.
+static const unsigned MaxCachedDocInfos = 4;
+
+SwiftDocInfoCache::EntryRef SwiftDocInfoCache::find(StringRef Key) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto I = Entries.begin(), E = Entries.end(); I != E; ++I) {
+    if ((*I)->Key != Key)
+      continue;
+    EntryRef Found = *I;
+    Entries.erase(I);
+    if (!Found->isUpToDate())
+      return nullptr;
+    Entries.push_back(Found);
+    return Found;
+  }
+  return nullptr;
+}
+
+void SwiftDocInfoCache::set(EntryRef NewEntry) {
+  llvm::sys::ScopedLock L(Mtx);
+  Entries.erase(std::remove_if(Entries.begin(), Entries.end(),
+                               [&](const EntryRef &Existing) {
+                                 return Existing->Key == NewEntry->Key;
+                               }),
+                Entries.end());
+  Entries.push_back(std::move(NewEntry));
+  if (Entries.size() > MaxCachedDocInfos)
+    Entries.erase(Entries.begin());
+}
+
 static bool reportModuleDocInfo(CompilerInvocation Invocation,
                                 StringRef ModuleName,
-                                DocInfoConsumer &Consumer) {
+                                SwiftDocInfoCache::Entry &Consumer) {
   CompilerInstance CI;
   // Display diagnostics to stderr.
   PrintingDiagnosticConsumer PrintDiags;
@@ -875,6 +1071,7 @@ static bool reportModuleDocInfo(CompilerInvocation Invocation,
   SourceTextInfo IFaceInfo;
   if (getModuleInterfaceInfo(Ctx, ModuleName, IFaceInfo))
     return true;
+  Consumer.addModuleFiles(getModuleByFullName(Ctx, ModuleName));
 
   CompilerInstance ParseCI;
   if (makeParserAST(ParseCI, IFaceInfo.Text))
@@ -1032,9 +1229,26 @@ void SwiftLangSupport::getDocInfo(llvm::MemoryBuffer *InputBuf,
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
   if (!ModuleName.empty()) {
-    bool Error = reportModuleDocInfo(Invocation, ModuleName, Consumer);
-    if (Error)
+    // Reuse the documentation of an unchanged module.
+    std::string Key = ModuleName;
+    for (auto Arg : Args) {
+      Key += '\0';
+      Key += Arg;
+    }
+    if (auto Cached = getDocInfoCache().find(Key)) {
+      LOG_INFO_FUNC(High, "reusing doc info of " << ModuleName);
+      Cached->replay(Consumer);
+      return;
+    }
+
+    auto Recorded = std::make_shared<SwiftDocInfoCache::Entry>(Key);
+    bool Error = reportModuleDocInfo(Invocation, ModuleName, *Recorded);
+    if (Error) {
       Consumer.failed("Error occurred");
+      return;
+    }
+    Recorded->replay(Consumer);
+    getDocInfoCache().set(std::move(Recorded));
     return;
   }
 
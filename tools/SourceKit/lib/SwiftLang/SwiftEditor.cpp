@@ -1233,15 +1233,30 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+    // Note that the length can span multiple lines.
+    unsigned Length = Node.Range.getByteLength();
+
+    if (EditedLineRange.isValid()) {
+      // Nodes come in buffer order, so after an edit everything outside of the
+      // affected range can be skipped by offset alone, without computing line
+      // and column information or touching the syntax map.
+      if (Offset + Length <= AffectedRange.first) {
+        // We're entirely before the edited range, no update needed.
+        return true;
+      }
+      if (Offset >= AffectedRange.first + AffectedRange.second) {
+        // We're past the affected range and already synced up, just return.
+        return true;
+      }
+    }
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
-    // Note that the length can span multiple lines.
-    unsigned Length = Node.Range.getByteLength();
 
     SwiftSyntaxToken Token(StartLineAndColumn.second, Length,
                            Node.Kind);
@@ -1265,10 +1280,6 @@ public:
         AffectedRange.first -= AdjCharCount;
         AffectedRange.second += AdjCharCount;
       }
-      else if (Offset > AffectedRange.first + AffectedRange.second) {
-        // We're passed the affected range and already synced up, just return.
-        return true;
-      }
       else if (StartLine > EditedLineRange.endLine()) {
         // We're after the edited line range, let's test if we're synced up.
         if (SyntaxMap.matchesFirstTokenOnLine(StartLine, Token)) {
@@ -1680,6 +1691,7 @@ void SwiftEditorDocument::parse(ImmutableTextSnapshotRef Snapshot,
   Impl.SyntaxInfo.reset(
     new SwiftDocumentSyntaxInfo(CompInv, Snapshot, Args, Impl.FilePath));
 
+  trace::LatencyTimer ParseTimer("editor.parse");
   Impl.SyntaxInfo->parse();
 }
 
@@ -1704,7 +1716,10 @@ void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
                                        Consumer,
                                        Impl.SyntaxInfo->getBufferID());
 
-  ModelContext.walk(SyntaxWalker);
+  {
+    trace::LatencyTimer WalkTimer("editor.syntax-model");
+    ModelContext.walk(SyntaxWalker);
+  }
 
   Consumer.recordAffectedRange(Impl.AffectedRange.first,
                                Impl.AffectedRange.second);
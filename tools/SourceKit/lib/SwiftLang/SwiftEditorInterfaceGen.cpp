@@ -13,6 +13,7 @@
 #include "SwiftLangSupport.h"
 #include "SwiftInterfaceGenContext.h"
 #include "SwiftASTManager.h"
+#include "SourceKit/Support/Logging.h"
 
 #include "swift/AST/ASTPrinter.h"
 #include "swift/AST/ASTWalker.h"
@@ -23,6 +24,7 @@
 #include "swift/IDE/Utils.h"
 #include "swift/Strings.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
 
@@ -67,9 +69,14 @@ public:
     llvm::StringMap<TextDecl> USRMap;
   };
 
+  struct ModuleFileStatus {
+    std::string Filename;
+    uint64_t Size;
+    uint64_t ModTime;
+  };
+
   // Hold an AstUnit so that the Decl* we have are always valid.
   ASTUnitRef AstUnit;
-  std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
   CompilerInvocation Invocation;
@@ -79,6 +86,12 @@ public:
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
+
+  // The options the module interface was printed with, and the files it was
+  // printed from, to decide whether it can be reused.
+  Optional<std::string> Group;
+  bool SynthesizedExtensions = false;
+  std::vector<ModuleFileStatus> ModuleFiles;
 };
 
 typedef SwiftInterfaceGenContext::Implementation::TextRange TextRange;
@@ -320,6 +333,19 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
   if (!Group && InterestedUSR) {
     Group = findGroupNameForUSR(Mod, InterestedUSR.getValue());
   }
+  if (Group)
+    Impl.Group = Group->str();
+  Impl.SynthesizedExtensions = SynthesizedExtensions;
+  for (auto *File : Mod->getFiles()) {
+    auto *LF = dyn_cast<LoadedFile>(File);
+    if (!LF || LF->getFilename().empty())
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(LF->getFilename(), Status))
+      continue;
+    Impl.ModuleFiles.push_back({ LF->getFilename(), Status.getSize(),
+                      Status.getLastModificationTime().toEpochTime() });
+  }
   printSubmoduleInterface(Mod, SplitModuleName,
     Group.hasValue() ? llvm::makeArrayRef(Group.getValue()) : ArrayRef<StringRef>(),
                           TraversalOptions,
@@ -355,8 +381,9 @@ SwiftInterfaceGenContext::createForSwiftSource(StringRef DocumentName,
                                                StringRef SourceFileName,
                                                ASTUnitRef AstUnit,
                                                std::string &ErrMsg) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(DocumentName,
+                                 std::make_shared<Implementation>()) };
   IFaceGenCtx->Impl.IsModule = true;
   IFaceGenCtx->Impl.ModuleOrHeaderName = SourceFileName;
   IFaceGenCtx->Impl.AstUnit = AstUnit;
@@ -383,8 +410,9 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                  std::string &ErrMsg,
                                  bool SynthesizedExtensions,
                                  Optional<StringRef> InterestedUSR) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(DocumentName,
+                                 std::make_shared<Implementation>()) };
   IFaceGenCtx->Impl.IsModule = IsModule;
   IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
   IFaceGenCtx->Impl.Invocation = Invocation;
@@ -438,15 +466,21 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   return IFaceGenCtx;
 }
 
-SwiftInterfaceGenContext::SwiftInterfaceGenContext()
-  : Impl(*new Implementation) {
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenContext::createFromExisting(StringRef DocumentName,
+                                             SwiftInterfaceGenContextRef Other) {
+  return SwiftInterfaceGenContextRef{
+    new SwiftInterfaceGenContext(DocumentName, Other->ImplPtr) };
 }
-SwiftInterfaceGenContext::~SwiftInterfaceGenContext() {
-  delete &Impl;
+
+SwiftInterfaceGenContext::SwiftInterfaceGenContext(
+    StringRef DocumentName, std::shared_ptr<Implementation> Shared)
+  : ImplPtr(std::move(Shared)), Impl(*ImplPtr), DocumentName(DocumentName) {
 }
+SwiftInterfaceGenContext::~SwiftInterfaceGenContext() = default;
 
 StringRef SwiftInterfaceGenContext::getDocumentName() const {
-  return Impl.DocumentName;
+  return DocumentName;
 }
 
 StringRef SwiftInterfaceGenContext::getModuleOrHeaderName() const {
@@ -490,6 +524,31 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::canReuseFor(StringRef ModuleName,
+                                           Optional<StringRef> Group,
+                                       const swift::CompilerInvocation &Invok,
+                                           bool SynthesizedExtensions) {
+  if (!matches(ModuleName, Invok))
+    return false;
+  if (Group.hasValue() != Impl.Group.hasValue())
+    return false;
+  if (Group && *Group != *Impl.Group)
+    return false;
+  // Synthesized extensions are only printed for a group.
+  if (Group && SynthesizedExtensions != Impl.SynthesizedExtensions)
+    return false;
+
+  for (auto &File : Impl.ModuleFiles) {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(File.Filename, Status))
+      return false;
+    if (Status.getSize() != File.Size ||
+        Status.getLastModificationTime().toEpochTime() != File.ModTime)
+      return false;
+  }
+  return true;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -582,6 +641,20 @@ SwiftInterfaceGenMap::find(StringRef ModuleName,
   return nullptr;
 }
 
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenMap::findReusable(StringRef ModuleName,
+                                   Optional<StringRef> Group,
+                                   const CompilerInvocation &Invok,
+                                   bool SynthesizedExtensions) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto &Entry : IFaceGens) {
+    if (Entry.getValue()->canReuseFor(ModuleName, Group, Invok,
+                                      SynthesizedExtensions))
+      return Entry.getValue();
+  }
+  return nullptr;
+}
+
 //===----------------------------------------------------------------------===//
 // EditorOpenInterface
 //===----------------------------------------------------------------------===//
@@ -619,15 +692,33 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
-  std::string ErrMsg;
-  auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
-                                                      /*IsModule=*/true,
-                                                      ModuleName,
-                                                      Group,
+  // Reuse the interface if the module is already open in another document.
+  // The group for an interested USR is only known once the module is loaded,
+  // so that case is always generated.
+  SwiftInterfaceGenContextRef IFaceGenRef;
+  if (Group || !InterestedUSR) {
+    if (auto Existing = IFaceGenContexts.findReusable(ModuleName, Group,
                                                       Invocation,
-                                                      ErrMsg,
-                                                      SynthesizedExtensions,
-                                                      InterestedUSR);
+                                                      SynthesizedExtensions)) {
+      LOG_INFO_FUNC(Low, "reusing interface of " << ModuleName << " from "
+                    << Existing->getDocumentName());
+      IFaceGenRef = SwiftInterfaceGenContext::createFromExisting(Name,
+                                                                 Existing);
+    }
+  }
+
+  std::string ErrMsg;
+  if (!IFaceGenRef) {
+    trace::LatencyTimer Timer("interface-gen");
+    IFaceGenRef = SwiftInterfaceGenContext::create(Name,
+                                                   /*IsModule=*/true,
+                                                   ModuleName,
+                                                   Group,
+                                                   Invocation,
+                                                   ErrMsg,
+                                                   SynthesizedExtensions,
+                                                   InterestedUSR);
+  }
   if (!IFaceGenRef) {
     Consumer.handleRequestError(ErrMsg.c_str());
     return;
@@ -23,6 +23,7 @@
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -44,7 +45,19 @@ static UIdent getUIDForDependencyKind(SymbolKind depKind) {
 
 class SKIndexDataConsumer : public IndexDataConsumer {
 public:
-  SKIndexDataConsumer(IndexingConsumer &C) : impl(C) {}
+  SKIndexDataConsumer(IndexingConsumer &C)
+    : impl(C), start(llvm::sys::TimeValue::now()) {}
+
+  /// Logs how many entities were reported and how fast, and records the
+  /// latency of the operation under \p name.
+  void reportThroughput(StringRef name, StringRef input) {
+    uint64_t usec = (llvm::sys::TimeValue::now() - start).usec();
+    trace::recordLatency(name, usec);
+    LOG_INFO_FUNC(Low, name << " " << input << ": " << numEntities
+                  << " entities in " << usec / 1000 << " ms ("
+                  << (usec ? numEntities * 1000000 / usec : numEntities)
+                  << " entities/s)");
+  }
 
 private:
   void failed(StringRef error) override { impl.failed(error); }
@@ -72,6 +85,7 @@ private:
   }
 
   bool startSourceEntity(const IndexSymbol &symbol) override {
+    ++numEntities;
     return withEntityInfo(symbol, [this](const EntityInfo &info) {
       return impl.startSourceEntity(info);
     });
@@ -115,6 +129,8 @@ private:
 
 private:
   IndexingConsumer &impl;
+  llvm::sys::TimeValue start;
+  uint64_t numEntities = 0;
 };
 
 static void indexModule(llvm::MemoryBuffer *Input,
@@ -168,6 +184,7 @@ static void indexModule(llvm::MemoryBuffer *Input,
 
   SKIndexDataConsumer IdxDataConsumer(IdxConsumer);
   index::indexModule(Mod, Hash, IdxDataConsumer);
+  IdxDataConsumer.reportThroughput("index-module", ModuleName);
 }
 
 
@@ -268,4 +285,5 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
 
   SKIndexDataConsumer IdxDataConsumer(IdxConsumer);
   index::indexSourceFile(CI.getPrimarySourceFile(), Hash, IdxDataConsumer);
+  IdxDataConsumer.reportThroughput("index-source", InputFile);
 }
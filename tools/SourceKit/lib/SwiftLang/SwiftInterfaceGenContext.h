@@ -16,6 +16,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "swift/AST/Module.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -47,6 +48,11 @@ public:
                                                           ASTUnitRef AstUnit,
                                                           std::string &ErrMsg);
 
+  /// Creates a context for \p DocumentName that shares the generated
+  /// interface of \p Other, instead of printing the module again.
+  static SwiftInterfaceGenContextRef
+  createFromExisting(StringRef DocumentName, SwiftInterfaceGenContextRef Other);
+
   ~SwiftInterfaceGenContext();
 
   StringRef getDocumentName() const;
@@ -55,6 +61,13 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Whether the generated interface is the one \c create would produce for
+  /// the given arguments, and the files of the module are unchanged since it
+  /// was generated.
+  bool canReuseFor(StringRef ModuleName, Optional<StringRef> Group,
+                   const swift::CompilerInvocation &Invok,
+                   bool SynthesizedExtensions);
+
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
   struct ResolvedEntity {
@@ -84,9 +97,13 @@ public:
   class Implementation;
 
 private:
+  // The generated interface, shared by all the documents that opened it.
+  std::shared_ptr<Implementation> ImplPtr;
   Implementation &Impl;
+  std::string DocumentName;
 
-  SwiftInterfaceGenContext();
+  SwiftInterfaceGenContext(StringRef DocumentName,
+                           std::shared_ptr<Implementation> Shared);
 };
 
 } // namespace SourceKit.
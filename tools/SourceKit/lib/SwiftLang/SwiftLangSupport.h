@@ -26,6 +26,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Mutex.h"
 #include <map>
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -134,6 +135,11 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionKind completionKind;
   bool completionHasExpectedTypes;
   FilterRules filterRules;
+  /// The completions matching the filter text of the previous request, which
+  /// are all that need to be looked at when the filter text is extended.
+  std::string lastFilterText;
+  bool lastFilterWasFuzzy = false;
+  std::vector<Completion *> lastFilterMatches;
   llvm::sys::Mutex mtx;
 
 public:
@@ -147,6 +153,13 @@ public:
         filterRules(std::move(filterRules)) {}
   void setSortedCompletions(std::vector<Completion *> &&completions);
   ArrayRef<Completion *> getSortedCompletions();
+  /// Returns the sorted completions that may match \p filterText, reusing the
+  /// matches of the previous request if \p filterText extends its filter text.
+  std::vector<Completion *> getCompletionsForFilter(StringRef filterText,
+                                                    bool fuzzyMatching);
+  /// Records the completions that matched \p filterText.
+  void setFilterMatches(StringRef filterText, bool fuzzyMatching,
+                        std::vector<Completion *> &&matches);
   llvm::MemoryBuffer *getBuffer();
   ArrayRef<std::string> getCompilerArgs();
   const FilterRules &getFilterRules();
@@ -183,6 +196,28 @@ public:
   bool remove(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
+  SwiftInterfaceGenContextRef findReusable(StringRef ModuleName,
+                                           Optional<StringRef> Group,
+                                       const swift::CompilerInvocation &Invok,
+                                           bool SynthesizedExtensions);
+};
+
+/// The documentation info of the most recently requested modules, replayed
+/// while their module files are unchanged instead of building an AST again.
+class SwiftDocInfoCache {
+public:
+  class Entry;
+  typedef std::shared_ptr<const Entry> EntryRef;
+
+private:
+  /// The entries, least recently used first.
+  std::vector<EntryRef> Entries;
+  mutable llvm::sys::Mutex Mtx;
+
+public:
+  /// Returns the up-to-date entry for \p Key, or null.
+  EntryRef find(StringRef Key);
+  void set(EntryRef NewEntry);
 };
 
 struct SwiftCompletionCache
@@ -209,6 +244,7 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  SwiftDocInfoCache DocInfos;
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
@@ -226,6 +262,7 @@ public:
 
   SwiftEditorDocumentFileMap &getEditorDocuments() { return EditorDocuments; }
   SwiftInterfaceGenMap &getIFaceGenContexts() { return IFaceGenContexts; }
+  SwiftDocInfoCache &getDocInfoCache() { return DocInfos; }
   IntrusiveRefCntPtr<SwiftCompletionCache> getCodeCompletionCache() {
     return CCCache;
   }
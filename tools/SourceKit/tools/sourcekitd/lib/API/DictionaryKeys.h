@@ -118,6 +118,11 @@ extern SourceKit::UIdent KeyObsoleted;
 extern SourceKit::UIdent KeyRemoveCache;
 extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyCount;
+extern SourceKit::UIdent KeyTotalUSec;
+extern SourceKit::UIdent KeyMaxUSec;
+extern SourceKit::UIdent KeyBuckets;
+extern SourceKit::UIdent KeyLimitMSec;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
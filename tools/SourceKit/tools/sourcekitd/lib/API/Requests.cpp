@@ -20,6 +20,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "swift/Basic/DemangleWrappers.h"
@@ -28,8 +29,10 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/raw_ostream.h"
 #include <mutex>
 
@@ -59,6 +62,7 @@ public:
 } // anonymous namespace.
 
 static LazySKDUID RequestProtocolVersion("source.request.protocol_version");
+static LazySKDUID RequestStatistics("source.request.statistics");
 
 static LazySKDUID RequestCrashWithExit("source.request.crash_exit");
 
@@ -234,6 +238,35 @@ editorFindModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args);
 
 static bool isSemanticEditorDisabled();
 
+namespace {
+/// Tracks the most recent completion request that was queued for each source
+/// file.
+class CompletionRequestTracker {
+  std::mutex Mtx;
+  llvm::StringMap<uint64_t> LatestRequest;
+  uint64_t NextRequest = 0;
+
+public:
+  uint64_t enqueue(StringRef SourceFile) {
+    std::lock_guard<std::mutex> Lock(Mtx);
+    uint64_t Request = ++NextRequest;
+    LatestRequest[SourceFile] = Request;
+    return Request;
+  }
+
+  bool isSuperseded(StringRef SourceFile, uint64_t Request) {
+    std::lock_guard<std::mutex> Lock(Mtx);
+    auto Found = LatestRequest.find(SourceFile);
+    return Found != LatestRequest.end() && Found->getValue() != Request;
+  }
+};
+} // anonymous namespace.
+
+static CompletionRequestTracker &getCompletionRequests() {
+  static CompletionRequestTracker Tracker;
+  return Tracker;
+}
+
 static void fillDictionaryForDiagnosticInfo(
     ResponseBuilder::Dictionary Elem, const DiagnosticEntryInfoBase &Info);
 
@@ -246,14 +279,28 @@ void sourcekitd::handleRequest(sourcekitd_object_t Req,
     sourcekitd::printRequestObject(Req, Log->getOS());
   }
 
-  handleRequestImpl(Req, [Receiver](sourcekitd_response_t Resp) {
+  // Account the time until the response for each request kind, and the time
+  // that handing the response over takes separately.
+  std::string LatencyName = "unknown";
+  if (sourcekitd_uid_t ReqUID = RequestDict(Req).getUID(KeyRequest))
+    LatencyName = sourcekitd_uid_get_string_ptr(ReqUID);
+  llvm::sys::TimeValue Start = llvm::sys::TimeValue::now();
+
+  handleRequestImpl(Req, [Receiver, LatencyName, Start](
+                             sourcekitd_response_t Resp) {
+    trace::recordLatency(LatencyName,
+                         (llvm::sys::TimeValue::now() - Start).usec());
+
     LOG_SECTION("handleRequest-after", InfoHighPrio) {
       // Responses are big, print them out with info medium priority.
       if (Logger::isLoggingEnabledForLevel(Logger::Level::InfoMediumPrio))
         sourcekitd::printResponse(Resp, Log->getOS());
     }
 
+    llvm::sys::TimeValue ResponseStart = llvm::sys::TimeValue::now();
     Receiver(Resp);
+    trace::recordLatency(LatencyName + ".response",
+                         (llvm::sys::TimeValue::now() - ResponseStart).usec());
   });
 }
 
@@ -313,6 +360,31 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(RB.createResponse());
   }
 
+  if (ReqUID == RequestStatistics) {
+    ResponseBuilder RB;
+    auto Results = RB.getDictionary().setArray(KeyResults);
+    for (auto &Entry : trace::getLatencyHistograms()) {
+      const trace::LatencyHistogram &Histogram = Entry.second;
+      auto Elem = Results.appendDictionary();
+      Elem.set(KeyName, Entry.first);
+      Elem.set(KeyCount, Histogram.Count);
+      Elem.set(KeyTotalUSec, Histogram.TotalUSec);
+      Elem.set(KeyMaxUSec, Histogram.MaxUSec);
+      auto Buckets = Elem.setArray(KeyBuckets);
+      for (unsigned I = 0; I != trace::LatencyHistogram::NumBuckets; ++I) {
+        if (!Histogram.Buckets[I])
+          continue;
+        auto Bucket = Buckets.appendDictionary();
+        // The last bucket has no upper limit.
+        if (I + 1 != trace::LatencyHistogram::NumBuckets)
+          Bucket.set(KeyLimitMSec,
+                     trace::LatencyHistogram::getBucketLimitMSec(I));
+        Bucket.set(KeyCount, Histogram.Buckets[I]);
+      }
+    }
+    return Rec(RB.createResponse());
+  }
+
   if (ReqUID == RequestCrashWithExit) {
     // 'exit' has the same effect as crashing but without the crash log.
     ::exit(1);
@@ -632,14 +704,45 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
 
   static WorkQueue SemaQueue{ WorkQueue::Dequeuing::Concurrent,
                               "sourcekit.request.semantic" };
+
+  // A completion request for a file is superseded by any later one for the
+  // same file; if it is still waiting when that one arrives, don't bother
+  // type checking for it.
+  bool IsCompletion = SourceFile.hasValue() &&
+                      (ReqUID == RequestCodeComplete ||
+                       ReqUID == RequestCodeCompleteOpen);
+  uint64_t CompletionRequest = 0;
+  if (IsCompletion)
+    CompletionRequest = getCompletionRequests().enqueue(*SourceFile);
+
+  llvm::sys::TimeValue QueuedAt = llvm::sys::TimeValue::now();
   sourcekitd_request_retain(ReqObj);
-  SemaQueue.dispatch(
-    [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args] {
+  auto Work = [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args, QueuedAt,
+               IsCompletion, CompletionRequest] {
+    LOG_SECTION("semantic-request-dequeued", InfoLowPrio) {
+      Log->getOS() << sourcekitd_uid_get_string_ptr(ReqUID) << " waited "
+                   << (llvm::sys::TimeValue::now() - QueuedAt).msec()
+                   << " ms";
+    }
+
+    if (IsCompletion &&
+        getCompletionRequests().isSuperseded(*SourceFile, CompletionRequest)) {
+      Rec(createErrorRequestCancelled());
+    } else {
       RequestDict Req(ReqObj);
       handleSemanticRequest(Req, Rec, ReqUID, SourceFile, SourceText, Args);
-      sourcekitd_request_release(ReqObj);
-    },
-    /*isStackDeep=*/true);
+    }
+    sourcekitd_request_release(ReqObj);
+  };
+
+  // Nobody is waiting interactively on indexing, run it in the background so
+  // that it yields to the requests on the semantic queue.
+  if (ReqUID == RequestIndex)
+    WorkQueue::dispatchConcurrent(std::move(Work),
+                                  WorkQueue::Priority::Background,
+                                  /*isStackDeep=*/true);
+  else
+    SemaQueue.dispatch(std::move(Work), /*isStackDeep=*/true);
 }
 
 static void
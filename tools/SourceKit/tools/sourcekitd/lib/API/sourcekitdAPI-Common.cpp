@@ -131,6 +131,11 @@ UIdent sourcekitd::KeyObsoleted("key.obsoleted");
 UIdent sourcekitd::KeyRemoveCache("key.removecache");
 UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyCount("key.count");
+UIdent sourcekitd::KeyTotalUSec("key.total_usec");
+UIdent sourcekitd::KeyMaxUSec("key.max_usec");
+UIdent sourcekitd::KeyBuckets("key.buckets");
+UIdent sourcekitd::KeyLimitMSec("key.limit_msec");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -219,7 +224,13 @@ static UIdent *OrderedKeys[] = {
   &KeyIntroduced,
   &KeyDeprecated,
   &KeyObsoleted,
-  &KeyRemoveCache
+  &KeyRemoveCache,
+
+  &KeyCount,
+  &KeyTotalUSec,
+  &KeyMaxUSec,
+  &KeyLimitMSec,
+  &KeyBuckets,
 };
 
 static unsigned findPrintOrderForDictKey(UIdent Key) {
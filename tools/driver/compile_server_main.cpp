@@ -0,0 +1,277 @@
+//===--- compile_server_main.cpp - Long-lived frontend job server ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// swift -compile-server <socket> [-j <n>]
+//
+// Listens on a Unix domain socket for frontend jobs from the driver (see
+// swift/Basic/CompileServer.h) and runs up to <n> of them at a time.
+//
+// The frontend keeps a lot of process-wide state (LLVM's command-line
+// options and statistics, the compilation timers, the working directory),
+// so jobs can't share one process. Instead each job runs in a process forked
+// from the server, which has already been loaded and has set up LLVM, and so
+// skips the cost of starting a compiler from scratch. Everything a job reads
+// from disk, including the modules it imports, it reads afresh, so changes to
+// those files are always seen.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/CompileServer.h"
+#include "swift/Basic/LLVM.h"
+#include "swift/FrontendTool/FrontendTool.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SWIFT_COMPILE_SERVER_SUPPORTED 1
+#endif
+
+using namespace swift;
+namespace server = swift::compile_server;
+
+#if SWIFT_COMPILE_SERVER_SUPPORTED
+
+namespace {
+/// The connections accepted but not yet taken by a worker.
+class ConnectionQueue {
+  std::mutex Lock;
+  std::condition_variable Available;
+  std::queue<int> Connections;
+
+public:
+  void push(int fd) {
+    {
+      std::lock_guard<std::mutex> guard(Lock);
+      Connections.push(fd);
+    }
+    Available.notify_one();
+  }
+
+  int pop() {
+    std::unique_lock<std::mutex> guard(Lock);
+    Available.wait(guard, [this] { return !Connections.empty(); });
+    int fd = Connections.front();
+    Connections.pop();
+    return fd;
+  }
+};
+} // end anonymous namespace
+
+/// Runs the frontend with \p args in the working directory of the request,
+/// in the process forked for the job. Never returns.
+static void LLVM_ATTRIBUTE_NORETURN
+runJob(int outputFd, const std::string &workingDirectory,
+       const std::vector<std::string> &args, const char *argv0,
+       void *mainAddr) {
+  dup2(outputFd, STDOUT_FILENO);
+  dup2(STDOUT_FILENO, STDERR_FILENO);
+
+  // Other jobs' connections must close when those jobs finish, not when this
+  // one does.
+  for (int fd = STDERR_FILENO + 1, e = getdtablesize(); fd < e; ++fd)
+    close(fd);
+
+  if (chdir(workingDirectory.c_str()) != 0) {
+    llvm::errs() << "error: unable to change to directory '"
+                 << workingDirectory << "': " << strerror(errno) << "\n";
+    _exit(1);
+  }
+  if (args.empty() || args.front() != "-frontend") {
+    llvm::errs() << "error: the compile server only runs frontend jobs\n";
+    _exit(1);
+  }
+
+  SmallVector<const char *, 128> frontendArgs;
+  for (const std::string &arg : llvm::makeArrayRef(args).slice(1))
+    frontendArgs.push_back(arg.c_str());
+  int result = performFrontend(frontendArgs, argv0, mainAddr);
+
+  // Skip the destructors of the server's state, which this process doesn't
+  // own.
+  llvm::outs().flush();
+  llvm::errs().flush();
+  _exit(result);
+}
+
+/// Runs the job requested on \p connection, passing on what it prints and
+/// how it ends.
+static void handleConnection(int connection, const char *argv0,
+                             void *mainAddr) {
+  server::MessageKind kind;
+  std::string payload;
+  std::string workingDirectory;
+  std::vector<std::string> args;
+  if (!server::readMessage(connection, kind, payload) ||
+      kind != server::MessageKind::Request ||
+      !server::decodeRequest(payload, workingDirectory, args)) {
+    close(connection);
+    return;
+  }
+
+  int outputPipe[2];
+  if (pipe(outputPipe) != 0) {
+    close(connection);
+    return;
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(outputPipe[0]);
+    runJob(outputPipe[1], workingDirectory, args, argv0, mainAddr);
+  }
+  close(outputPipe[1]);
+  if (pid < 0) {
+    close(outputPipe[0]);
+    close(connection);
+    return;
+  }
+
+  // If the driver has gone away, there's no one to pass things on to, but
+  // the job still has to be waited for.
+  bool connected =
+      server::writeMessage(connection, server::MessageKind::Started,
+                           std::to_string(pid));
+  std::vector<char> buffer(64 * 1024);
+  while (true) {
+    ssize_t readBytes = read(outputPipe[0], buffer.data(), buffer.size());
+    if (readBytes < 0 && errno == EINTR)
+      continue;
+    if (readBytes <= 0)
+      break;
+    if (connected)
+      connected = server::writeMessage(connection, server::MessageKind::Output,
+                                       StringRef(buffer.data(), readBytes));
+  }
+  close(outputPipe[0]);
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    ;
+  if (connected)
+    server::writeMessage(connection, server::MessageKind::Exited,
+                         std::to_string(status));
+  close(connection);
+}
+
+static int listenOn(StringRef socketPath) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    llvm::errs() << "error: socket path is too long: " << socketPath << "\n";
+    return -1;
+  }
+  memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0) {
+    // Replace the socket of a server which has since stopped.
+    unlink(address.sun_path);
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&address),
+             sizeof(address)) == 0 &&
+        listen(fd, SOMAXCONN) == 0)
+      return fd;
+    close(fd);
+  }
+  llvm::errs() << "error: unable to listen on '" << socketPath << "': "
+               << strerror(errno) << "\n";
+  return -1;
+}
+
+int compile_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                        void *MainAddr) {
+  StringRef SocketPath;
+  unsigned NumWorkers = std::thread::hardware_concurrency();
+  for (size_t i = 0, e = Args.size(); i != e; ++i) {
+    StringRef Arg = Args[i];
+    if (Arg == "-j" && i + 1 != e) {
+      if (StringRef(Args[++i]).getAsInteger(10, NumWorkers) ||
+          NumWorkers == 0) {
+        llvm::errs() << "error: invalid value '" << Args[i] << "' for -j\n";
+        return 1;
+      }
+    } else if (SocketPath.empty() && !Arg.startswith("-")) {
+      SocketPath = Arg;
+    } else {
+      llvm::errs() << "error: unexpected argument '" << Arg << "'\n";
+      return 1;
+    }
+  }
+  if (SocketPath.empty()) {
+    llvm::errs() << "usage: swift -compile-server <socket> [-j <n>]\n";
+    return 1;
+  }
+  if (NumWorkers == 0)
+    NumWorkers = 1;
+
+  // Do the setup every job would otherwise repeat.
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  // A driver which goes away mid-job shouldn't take the server with it.
+  signal(SIGPIPE, SIG_IGN);
+
+  int ListenFd = listenOn(SocketPath);
+  if (ListenFd < 0)
+    return 1;
+
+  ConnectionQueue Connections;
+  std::vector<std::thread> Workers;
+  for (unsigned i = 0; i != NumWorkers; ++i) {
+    Workers.emplace_back([&] {
+      while (true)
+        handleConnection(Connections.pop(), Argv0, MainAddr);
+    });
+  }
+
+  while (true) {
+    int Connection = accept(ListenFd, nullptr, nullptr);
+    if (Connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      llvm::errs() << "error: unable to accept connections: "
+                   << strerror(errno) << "\n";
+      _exit(1);
+    }
+    Connections.push(Connection);
+  }
+}
+
+#else
+
+int compile_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                        void *MainAddr) {
+  llvm::errs() << "error: the compile server isn't supported on this "
+                  "platform\n";
+  return 1;
+}
+
+#endif
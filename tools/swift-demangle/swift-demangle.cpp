@@ -15,15 +15,25 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 static llvm::cl::opt<bool>
 ExpandMode("expand",
@@ -49,6 +59,20 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<std::string>
+BatchInput("batch",
+           llvm::cl::desc("Demangle the symbols in a file on several threads"),
+           llvm::cl::value_desc("filename"));
+
+static llvm::cl::opt<unsigned>
+NumThreads("j", llvm::cl::desc("The number of threads for -batch "
+                               "(defaults to the number of cores)"),
+           llvm::cl::init(0));
+
+static llvm::cl::opt<bool>
+PrintStats("stats",
+           llvm::cl::desc("Print throughput statistics for -batch to stderr"));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -60,40 +84,259 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     hadLeadingUnderscore = true;
     name = name.substr(1);
   }
+  // The nodes only live until this symbol has been printed.
+  swift::Demangle::NodeFactory factory;
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(name, factory);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
+/// The most demangled names to remember before starting over.
+static const size_t MaxCachedDemanglings = 64 * 1024;
+
+/// How much of the input to read at a time.
+static const size_t InputChunkSize = 64 * 1024;
+
+/// Whether \p c may appear in a mangled name after its "_T" prefix.
+static bool isMangledNameChar(char c) {
+  return isalnum((unsigned char)c) || c == '_' || c == '$';
 }
 
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
+/// Demangled names shared by the threads of -batch mode. It's split into
+/// shards with their own locks so that the threads rarely contend.
+class SharedDemangleCache {
+  static const size_t NumShards = 64;
+
+  struct Shard {
+    std::mutex Lock;
+    llvm::StringMap<std::string> Map;
+  };
+  Shard Shards[NumShards];
+
+  Shard &getShard(llvm::StringRef name) {
+    return Shards[llvm::hash_value(name) % NumShards];
+  }
+
+public:
+  bool lookup(llvm::StringRef name, std::string &result) {
+    auto &shard = getShard(name);
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    auto found = shard.Map.find(name);
+    if (found == shard.Map.end())
+      return false;
+    result = found->getValue();
+    return true;
+  }
+
+  void insert(llvm::StringRef name, const std::string &demangled) {
+    auto &shard = getShard(name);
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    if (shard.Map.size() >= MaxCachedDemanglings / NumShards)
+      shard.Map.clear();
+    shard.Map.insert({name, demangled});
+  }
+};
+
+/// Demangles the symbols in text, copying everything else through. Logs
+/// and traces mention the same symbols over and over, so the demangled
+/// names are memoized, in a cache of its own or in one shared with other
+/// threads.
+class TextDemangler {
+  llvm::raw_ostream &OS;
+  const swift::Demangle::DemangleOptions &Options;
+  llvm::StringMap<std::string> Cache;
+  SharedDemangleCache *SharedCache;
+
+  void demangleSymbol(llvm::StringRef name) {
+    ++NumSymbols;
+
+    // Only the demangled string is cacheable; the other modes print the
+    // node tree.
+    if (ExpandMode || TreeOnly || RemangleMode) {
+      demangle(OS, name, Options);
+      return;
+    }
+
+    if (SharedCache) {
+      std::string string;
+      if (SharedCache->lookup(name, string)) {
+        ++NumCacheHits;
+        OS << string;
+        return;
+      }
+      llvm::raw_string_ostream stringOS(string);
+      demangle(stringOS, name, Options);
+      SharedCache->insert(name, stringOS.str());
+      OS << string;
+      return;
+    }
+
+    auto found = Cache.find(name);
+    if (found != Cache.end()) {
+      ++NumCacheHits;
+      OS << found->getValue();
+      return;
+    }
+
+    if (Cache.size() >= MaxCachedDemanglings)
+      Cache.clear();
+    std::string string;
+    llvm::raw_string_ostream stringOS(string);
+    demangle(stringOS, name, Options);
+    OS << Cache.insert({name, std::move(stringOS.str())}).first->getValue();
+  }
+
+public:
+  size_t NumSymbols = 0;
+  size_t NumCacheHits = 0;
+
+  TextDemangler(llvm::raw_ostream &OS,
+                const swift::Demangle::DemangleOptions &Options,
+                SharedDemangleCache *SharedCache = nullptr)
+    : OS(OS), Options(Options), SharedCache(SharedCache) {}
+
+  /// Demangle the symbols in \p text. Symbols must not be split across
+  /// calls.
+  void process(llvm::StringRef text) {
+    // This doesn't handle Unicode symbols, but maybe that's okay.
+    size_t copied = 0, pos = 0;
+    while ((pos = text.find("_T", pos)) != llvm::StringRef::npos) {
+      size_t end = pos + 2;
+      while (end < text.size() && isMangledNameChar(text[end]))
+        ++end;
+      if (end == pos + 2) {
+        pos = end;
+        continue;
+      }
+      OS << text.slice(copied, pos);
+      demangleSymbol(text.slice(pos, end));
+      copied = pos = end;
+    }
+    OS << text.substr(copied);
+  }
+};
+
+/// Demangle the symbols in standard input, a chunk of whole lines at a
+/// time, so that memory use doesn't grow with the size of the input.
+static bool demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
+  TextDemangler demangler(llvm::outs(), options);
+  std::vector<char> buffer(InputChunkSize);
+  size_t filled = 0;
+  while (true) {
+    if (filled == buffer.size())
+      buffer.resize(buffer.size() * 2);
+    size_t count = fread(buffer.data() + filled, 1, buffer.size() - filled,
+                         stdin);
+    filled += count;
+    if (count == 0) {
+      demangler.process(llvm::StringRef(buffer.data(), filled));
+      return !ferror(stdin);
+    }
+
+    // Hold back the last partial line, which may end in part of a symbol.
+    llvm::StringRef contents(buffer.data(), filled);
+    size_t lineEnd = contents.rfind('\n');
+    if (lineEnd == llvm::StringRef::npos)
+      continue;
+    demangler.process(contents.substr(0, lineEnd + 1));
+    filled -= lineEnd + 1;
+    memmove(buffer.data(), buffer.data() + lineEnd + 1, filled);
+  }
+}
+
+/// How much of the input each thread of -batch mode demangles at a time.
+static const size_t BatchChunkSize = 1024 * 1024;
+
+/// Split \p contents into chunks of whole lines about \p chunkSize long.
+static std::vector<llvm::StringRef> splitIntoChunks(llvm::StringRef contents,
+                                                    size_t chunkSize) {
+  std::vector<llvm::StringRef> chunks;
+  while (!contents.empty()) {
+    size_t end = contents.find('\n', std::min(chunkSize, contents.size()) - 1);
+    end = end == llvm::StringRef::npos ? contents.size() : end + 1;
+    chunks.push_back(contents.substr(0, end));
+    contents = contents.substr(end);
+  }
+  return chunks;
+}
+
+/// Demangle the symbols in the file at \p path on several threads. The
+/// file is mapped into memory and split into chunks of whole lines, which
+/// the threads take in turn. The output is written in batches of one chunk
+/// per thread, in input order.
+static bool demangleBatch(llvm::StringRef path,
+                          const swift::Demangle::DemangleOptions &options) {
+  auto start = std::chrono::steady_clock::now();
+  auto input = llvm::MemoryBuffer::getFileOrSTDIN(path);
+  if (!input) {
+    llvm::errs() << path << ": " << input.getError().message() << '\n';
+    return false;
+  }
+  auto chunks = splitIntoChunks(input.get()->getBuffer(), BatchChunkSize);
+
+  unsigned numThreads = NumThreads;
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  SharedDemangleCache cache;
+  std::vector<std::string> outputs(numThreads);
+  std::atomic<size_t> numSymbols{0}, numCacheHits{0};
+
+  for (size_t batch = 0; batch < chunks.size(); batch += numThreads) {
+    size_t batchSize = std::min(size_t(numThreads), chunks.size() - batch);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < batchSize; ++i) {
+      threads.emplace_back([&, i] {
+        outputs[i].clear();
+        llvm::raw_string_ostream os(outputs[i]);
+        TextDemangler demangler(os, options, &cache);
+        demangler.process(chunks[batch + i]);
+        os.flush();
+        numSymbols += demangler.NumSymbols;
+        numCacheHits += demangler.NumCacheHits;
+      });
+    }
+    for (size_t i = 0; i < batchSize; ++i) {
+      threads[i].join();
+      llvm::outs() << outputs[i];
+    }
+  }
+  llvm::outs().flush();
+
+  if (PrintStats) {
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    double megabytes = input.get()->getBufferSize() / (1024.0 * 1024.0);
+    llvm::errs() << "swift-demangle: " << llvm::format("%.1f", megabytes)
+                 << " MB, " << numSymbols << " symbols ("
+                 << numCacheHits << " cached) in "
+                 << llvm::format("%.3f", elapsed.count()) << " s on "
+                 << numThreads << " threads: "
+                 << llvm::format("%.1f", megabytes / elapsed.count())
+                 << " MB/s\n";
+  }
+  return true;
 }
 
 int main(int argc, char **argv) {
@@ -109,25 +352,17 @@ int main(int argc, char **argv) {
   if (Simplified)
     options = swift::Demangle::DemangleOptions::SimplifiedUIDemangleOptions();
 
+  if (!BatchInput.empty()) {
+    CompactMode = true;
+    return demangleBatch(BatchInput, options) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
-    if (!input) {
-      llvm::errs() << input.getError().message() << '\n';
+    if (!demangleSTDIN(options)) {
+      llvm::errs() << "error reading standard input\n";
       return EXIT_FAILURE;
     }
-    llvm::StringRef inputContents = input.get()->getBuffer();
-
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-    llvm::outs() << inputContents;
-
   } else {
     for (llvm::StringRef name : InputNames) {
       demangle(llvm::outs(), name, options);
@@ -0,0 +1,80 @@
+//===--- DiagnosticEngineTests.cpp - Tests for DiagnosticEngine -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/AST/DiagnosticsFrontend.h"
+#include "swift/Basic/SourceManager.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+/// Records the text of every diagnostic it is handed.
+class RecordingConsumer : public DiagnosticConsumer {
+public:
+  std::vector<std::string> Texts;
+
+  void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
+                        DiagnosticKind Kind, StringRef Text,
+                        const DiagnosticInfo &Info) override {
+    Texts.push_back(Text);
+  }
+};
+} // end anonymous namespace
+
+TEST(DiagnosticEngine, SuppressedWarningsAreCounted) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+  Diags.setSuppressWarnings(true);
+
+  Diags.diagnose(SourceLoc(), diag::warning_no_such_sdk, "a")
+    .fixItInsertAfter(SourceLoc(), "b");
+  // A note belongs to the preceding diagnostic, so it is ignored as well.
+  Diags.diagnose(SourceLoc(), diag::while_parsing_as_less_operator);
+  Diags.diagnose(SourceLoc(), diag::error_opening_output, "c", "d");
+
+  ASSERT_EQ(1u, Consumer.Texts.size());
+  EXPECT_EQ("error opening 'c' for output: d", Consumer.Texts[0]);
+
+  std::vector<std::string> Counts;
+  Diags.forEachDiagnosticCount([&](StringRef name, unsigned emitted,
+                                   unsigned ignored) {
+    Counts.push_back(name.str() + " " + std::to_string(emitted) + " " +
+                     std::to_string(ignored));
+  });
+  ASSERT_EQ(3u, Counts.size());
+  EXPECT_EQ("error_opening_output 1 0", Counts[0]);
+  EXPECT_EQ("while_parsing_as_less_operator 0 1", Counts[1]);
+  EXPECT_EQ("warning_no_such_sdk 0 1", Counts[2]);
+}
+
+TEST(DiagnosticEngine, SuppressedWarningsInTransactions) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+  Diags.setSuppressWarnings(true);
+
+  {
+    DiagnosticTransaction Transaction(Diags);
+    Diags.diagnose(SourceLoc(), diag::warning_no_such_sdk, "a");
+    Diags.diagnose(SourceLoc(), diag::error_opening_output, "c", "d");
+  }
+
+  ASSERT_EQ(1u, Consumer.Texts.size());
+  EXPECT_EQ("error opening 'c' for output: d", Consumer.Texts[0]);
+}
@@ -651,4 +651,30 @@ TEST(BlotMapVectorCustomTest, SmallBlotMapVectorGrowTest) {
   EXPECT_TRUE(map.find(32) == map.end());
 }
 
+// Make sure assignUnblotted drops blotted elements and keeps the order of the
+// others.
+TEST(BlotMapVectorCustomTest, AssignUnblottedTest) {
+  BlotMapVector<unsigned, unsigned> map;
+  for (unsigned i = 0; i < 8; ++i)
+    map[i] = i + 1;
+  for (unsigned i = 0; i < 8; i += 2)
+    map.blot(i);
+
+  BlotMapVector<unsigned, unsigned> copyMap;
+  copyMap[100] = 1;
+  copyMap.assignUnblotted(map);
+
+  EXPECT_EQ(4u, copyMap.size());
+  EXPECT_EQ(4, std::distance(copyMap.begin(), copyMap.end()));
+  unsigned expectedKey = 1;
+  for (auto &elt : copyMap) {
+    ASSERT_TRUE(elt.hasValue());
+    EXPECT_EQ(expectedKey, elt->first);
+    EXPECT_EQ(expectedKey + 1, elt->second);
+    expectedKey += 2;
+  }
+  EXPECT_TRUE(copyMap.find(100) == copyMap.end());
+  EXPECT_EQ(6u, copyMap.lookup(5));
+}
+
 } // end anonymous namespace
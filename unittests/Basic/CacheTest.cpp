@@ -0,0 +1,83 @@
+#include "swift/Basic/Cache.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::sys;
+
+namespace {
+struct CostedValue {
+  size_t Cost;
+  int *LiveCount;
+
+  CostedValue(size_t Cost, int *LiveCount) : Cost(Cost), LiveCount(LiveCount) {
+    ++*LiveCount;
+  }
+  CostedValue(const CostedValue &Other)
+      : Cost(Other.Cost), LiveCount(Other.LiveCount) {
+    ++*LiveCount;
+  }
+  ~CostedValue() { --*LiveCount; }
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace sys {
+template <>
+struct CacheValueCostInfo<CostedValue> {
+  static size_t getCost(const CostedValue &Val) { return Val.Cost; }
+};
+} // end namespace sys
+} // end namespace swift
+
+TEST(Cache, HitsAndMisses) {
+  int LiveCount = 0;
+  {
+    Cache<int, CostedValue> C("swift.test.cache");
+    C.set(1, CostedValue(10, &LiveCount));
+    EXPECT_TRUE(C.get(1).hasValue());
+    EXPECT_FALSE(C.get(2).hasValue());
+    EXPECT_TRUE(C.remove(1));
+    EXPECT_FALSE(C.get(1).hasValue());
+
+    CacheStatistics Stats = C.getStatistics();
+    EXPECT_EQ(1U, Stats.Hits);
+    EXPECT_EQ(2U, Stats.Misses);
+  }
+  EXPECT_EQ(0, LiveCount);
+}
+
+#if !defined(__APPLE__)
+// libcache only uses the cost limit as a hint.
+TEST(Cache, EvictsLeastRecentlyUsed) {
+  int LiveCount = 0;
+  {
+    Cache<int, CostedValue> C("swift.test.cache");
+    C.setCostLimit(100);
+    C.set(1, CostedValue(40, &LiveCount));
+    C.set(2, CostedValue(40, &LiveCount));
+    EXPECT_TRUE(C.get(1).hasValue()); // 2 is now the least recently used.
+    C.set(3, CostedValue(40, &LiveCount));
+
+    EXPECT_TRUE(C.get(1).hasValue());
+    EXPECT_FALSE(C.get(2).hasValue());
+    EXPECT_TRUE(C.get(3).hasValue());
+
+    CacheStatistics Stats = C.getStatistics();
+    EXPECT_EQ(1U, Stats.Evictions);
+    EXPECT_EQ(2U, Stats.Count);
+    EXPECT_EQ(80U, Stats.TotalCost);
+    EXPECT_EQ(2, LiveCount);
+
+    // The most recently set value is kept even if it is over the limit.
+    C.set(4, CostedValue(200, &LiveCount));
+    EXPECT_TRUE(C.get(4).hasValue());
+    EXPECT_EQ(1U, C.getStatistics().Count);
+
+    // Replacing a value updates the cost.
+    C.set(4, CostedValue(20, &LiveCount));
+    EXPECT_EQ(20U, C.getStatistics().TotalCost);
+    EXPECT_EQ(1, LiveCount);
+  }
+  EXPECT_EQ(0, LiveCount);
+}
+#endif
@@ -208,3 +208,47 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, SetClearBits) {
+  ClusteredBitVector vec;
+  vec.appendClearBits(200);
+  vec.setBits(0, 0);
+  EXPECT_EQ(0u, vec.count());
+
+  vec.setBits(60, 8);
+  EXPECT_EQ(8u, vec.count());
+  EXPECT_EQ(false, vec[59]);
+  EXPECT_EQ(true, vec[60]);
+  EXPECT_EQ(true, vec[67]);
+  EXPECT_EQ(false, vec[68]);
+
+  vec.setBits(10, 180);
+  EXPECT_EQ(180u, vec.count());
+  vec.clearBits(64, 64);
+  EXPECT_EQ(116u, vec.count());
+  EXPECT_EQ(true, vec[63]);
+  EXPECT_EQ(false, vec[64]);
+  EXPECT_EQ(false, vec[127]);
+  EXPECT_EQ(true, vec[128]);
+
+  vec.clearBits(0, 200);
+  EXPECT_EQ(0u, vec.count());
+}
+
+TEST(ClusteredBitVector, FindFirstLastSetBit) {
+  using Opt = Optional<size_t>;
+  ClusteredBitVector vec;
+  EXPECT_EQ(Opt(), vec.findFirstSetBit());
+  vec.appendClearBits(150);
+  EXPECT_EQ(Opt(), vec.findFirstSetBit());
+  EXPECT_EQ(Opt(), vec.findLastSetBit());
+
+  vec.setBit(70);
+  EXPECT_EQ(Opt(70), vec.findFirstSetBit());
+  EXPECT_EQ(Opt(70), vec.findLastSetBit());
+
+  vec.setBit(3);
+  vec.setBit(149);
+  EXPECT_EQ(Opt(3), vec.findFirstSetBit());
+  EXPECT_EQ(Opt(149), vec.findLastSetBit());
+}
@@ -0,0 +1,69 @@
+#include "swift/Basic/CompileServer.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::compile_server;
+
+TEST(CompileServer, MessagesSplitAcrossReads) {
+  std::string bytes;
+  encodeMessage(MessageKind::Started, "1234", bytes);
+  encodeMessage(MessageKind::Output, StringRef("a\0b", 3), bytes);
+  encodeMessage(MessageKind::Exited, "", bytes);
+
+  MessageReader reader;
+  MessageKind kind;
+  std::string payload;
+  EXPECT_FALSE(reader.next(kind, payload));
+  EXPECT_FALSE(reader.hasPartialMessage());
+
+  // Feed the bytes one at a time; each message appears once it's complete.
+  std::vector<std::pair<MessageKind, std::string>> messages;
+  for (char c : bytes) {
+    reader.append(StringRef(&c, 1));
+    while (reader.next(kind, payload))
+      messages.push_back({kind, payload});
+  }
+  EXPECT_FALSE(reader.hasPartialMessage());
+
+  ASSERT_EQ(3U, messages.size());
+  EXPECT_EQ(MessageKind::Started, messages[0].first);
+  EXPECT_EQ("1234", messages[0].second);
+  EXPECT_EQ(MessageKind::Output, messages[1].first);
+  EXPECT_EQ(std::string("a\0b", 3), messages[1].second);
+  EXPECT_EQ(MessageKind::Exited, messages[2].first);
+  EXPECT_EQ("", messages[2].second);
+}
+
+TEST(CompileServer, PartialMessage) {
+  std::string bytes;
+  encodeMessage(MessageKind::Output, "hello", bytes);
+
+  MessageReader reader;
+  reader.append(StringRef(bytes).drop_back());
+  MessageKind kind;
+  std::string payload;
+  EXPECT_FALSE(reader.next(kind, payload));
+  EXPECT_TRUE(reader.hasPartialMessage());
+
+  reader.append(StringRef(bytes).substr(bytes.size() - 1));
+  ASSERT_TRUE(reader.next(kind, payload));
+  EXPECT_EQ("hello", payload);
+  EXPECT_FALSE(reader.hasPartialMessage());
+}
+
+TEST(CompileServer, RequestRoundTrip) {
+  const char *args[] = { "-frontend", "-c", "", "-primary-file", "main.swift" };
+  std::string payload = encodeRequest("/tmp/project", args);
+
+  std::string workingDirectory;
+  std::vector<std::string> decodedArgs;
+  ASSERT_TRUE(decodeRequest(payload, workingDirectory, decodedArgs));
+  EXPECT_EQ("/tmp/project", workingDirectory);
+  ASSERT_EQ(5U, decodedArgs.size());
+  for (size_t i = 0; i != decodedArgs.size(); ++i)
+    EXPECT_EQ(args[i], decodedArgs[i]);
+
+  EXPECT_FALSE(decodeRequest("", workingDirectory, decodedArgs));
+  EXPECT_FALSE(decodeRequest(StringRef(payload).drop_back(), workingDirectory,
+                             decodedArgs));
+}
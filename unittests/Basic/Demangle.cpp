@@ -11,3 +11,15 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+
+TEST(Demangle, ArenaNodeFactory) {
+  std::string MangledName = "_TFC3foo3bar3basfT3zimCS_3zim_T_";
+  swift::Demangle::NodeFactory Factory;
+  auto Root = swift::Demangle::demangleSymbolAsNode(MangledName.data(),
+                                                    MangledName.size(),
+                                                    Factory);
+  ASSERT_TRUE(Root != nullptr);
+  EXPECT_EQ(demangleSymbolAsString(MangledName),
+            swift::Demangle::nodeToString(Root));
+  EXPECT_EQ(MangledName, swift::Demangle::mangleNode(Root));
+}
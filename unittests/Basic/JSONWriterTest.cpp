@@ -0,0 +1,164 @@
+//===--- JSONWriterTest.cpp - Tests for json::Writer ----------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/JSONSerialization.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+struct Record {
+  std::string Name;
+  uint64_t Size;
+  bool Valid;
+  std::vector<std::string> Files;
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace json {
+template<>
+struct ArrayTraits<std::vector<std::string>> {
+  static size_t size(Output &out, std::vector<std::string> &seq) {
+    return seq.size();
+  }
+  static std::string &element(Output &out, std::vector<std::string> &seq,
+                              size_t index) {
+    return seq[index];
+  }
+};
+
+template<>
+struct ObjectTraits<Record> {
+  static void mapping(Output &out, Record &R) {
+    out.mapRequired("name", R.Name);
+    out.mapRequired("size", R.Size);
+    out.mapRequired("valid", R.Valid);
+    out.mapRequired("files", R.Files);
+  }
+};
+} // end namespace json
+} // end namespace swift
+
+static std::string writeWithOutput(Record R) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  json::Output Out(OS);
+  Out << R;
+  return OS.str();
+}
+
+static void writeRecord(json::Writer &W, const Record &R) {
+  W.beginObject();
+  W.attribute("name", R.Name);
+  W.attribute("size", R.Size);
+  W.attribute("valid", R.Valid);
+  W.key("files");
+  W.beginArray();
+  for (auto &File : R.Files)
+    W.value(File);
+  W.endArray();
+  W.endObject();
+}
+
+static std::string writeWithWriter(const Record &R) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  {
+    json::Writer W(OS);
+    writeRecord(W, R);
+  }
+  return OS.str();
+}
+
+TEST(JSONWriter, MatchesOutput) {
+  Record R = { "main", 42, true, { "a.swift", "b.swift" } };
+  EXPECT_EQ(writeWithOutput(R), writeWithWriter(R));
+}
+
+TEST(JSONWriter, EmptyContainers) {
+  Record R = { "", 0, false, {} };
+  EXPECT_EQ(writeWithOutput(R), writeWithWriter(R));
+
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  {
+    json::Writer W(OS);
+    W.beginObject();
+    W.endObject();
+  }
+  EXPECT_EQ("{\n\n}", OS.str());
+}
+
+TEST(JSONWriter, Escaping) {
+  Record R = { "a \"b\"\\c/d\n\te\x01", 1, true, { "\x7f" } };
+  EXPECT_EQ(writeWithOutput(R), writeWithWriter(R));
+
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  json::writeEscapedString(OS, "x\"y\\z/\n\x01");
+  EXPECT_EQ("\"x\\\"y\\\\z\\/\\n\\u0001\"", OS.str());
+}
+
+TEST(JSONWriter, Compact) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  {
+    json::Writer W(OS, /*PrettyPrint=*/false);
+    W.beginObject();
+    W.attribute("kind", "began");
+    W.attribute("pid", -1);
+    W.key("inputs");
+    W.beginArray();
+    W.value("x.swift");
+    W.value(2);
+    W.endArray();
+    W.endObject();
+  }
+  EXPECT_EQ("{\"kind\":\"began\",\"pid\":-1,\"inputs\":[\"x.swift\",2]}",
+            OS.str());
+}
+
+// Measures how fast Output and Writer write a few megabytes of strings, as
+// the driver's parseable output does for the output of a job. This is
+// disabled by default; run it with
+//
+//   SwiftBasicTests --gtest_also_run_disabled_tests \
+//     --gtest_filter='*DISABLED_Throughput*'
+TEST(JSONWriter, DISABLED_Throughput) {
+  const size_t NumFiles = 1 << 12;
+  Record R = { std::string(1 << 22, 'x'), 0, true, {} };
+  R.Name.append("\n\"quoted\"\n");
+  for (size_t i = 0; i != NumFiles; ++i)
+    R.Files.push_back("/path/to/some/file" + std::to_string(i) + ".swift");
+
+  auto time = [](const std::function<std::string()> &Body,
+                 const char *Label) {
+    auto Start = std::chrono::steady_clock::now();
+    size_t Bytes = 0;
+    const unsigned Iterations = 16;
+    for (unsigned i = 0; i != Iterations; ++i)
+      Bytes += Body().size();
+    auto End = std::chrono::steady_clock::now();
+    double Seconds = std::chrono::duration<double>(End - Start).count();
+    printf("%-8s %8.1f MB/s\n", Label, Bytes / Seconds / (1 << 20));
+  };
+
+  time([&] { return writeWithOutput(R); }, "Output");
+  time([&] { return writeWithWriter(R); }, "Writer");
+}
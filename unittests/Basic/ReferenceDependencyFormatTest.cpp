@@ -0,0 +1,132 @@
+#include "swift/Basic/ReferenceDependencyFormat.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace swift;
+using namespace swift::reference_dependencies;
+
+namespace {
+
+struct ReadEntry {
+  Section section;
+  std::string name;
+  std::string member;
+  bool isCascading;
+};
+
+static std::string write(const BinaryWriter &writer) {
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  writer.write(out);
+  return out.str();
+}
+
+static bool read(StringRef data, std::string &interfaceHash,
+                 std::vector<ReadEntry> &entries) {
+  StringRef hash;
+  bool result = readBinary(data, hash, [&](const Entry &entry) -> bool {
+    entries.push_back({entry.section, entry.name.str(), entry.member.str(),
+                       entry.isCascading});
+    return true;
+  });
+  interfaceHash = hash.str();
+  return result;
+}
+
+} // end anonymous namespace
+
+TEST(ReferenceDependencyFormat, RoundTrip) {
+  BinaryWriter writer;
+  writer.addName(Section::ProvidesTopLevel, "foo");
+  writer.addName(Section::ProvidesNominal, "V4main3Bar");
+  writer.addPair(Section::ProvidesMember, "V4main3Bar", "");
+  writer.addName(Section::DependsTopLevel, "foo", /*isCascading=*/false);
+  writer.addPair(Section::DependsMember, "V4main3Bar", "baz");
+  writer.addName(Section::DependsExternal, "/tmp/Module.swiftmodule");
+  writer.addPair(Section::Fingerprints, StringRef("V4main3Bar\0baz", 14),
+                 "fedcba9876543210");
+  writer.setInterfaceHash("0123456789abcdef");
+  std::string data = write(writer);
+
+  EXPECT_TRUE(isBinaryFormat(data));
+  EXPECT_FALSE(isBinaryFormat("### Swift dependencies file v0 ###\n"));
+
+  std::string hash;
+  std::vector<ReadEntry> entries;
+  ASSERT_TRUE(read(data, hash, entries));
+  EXPECT_EQ("0123456789abcdef", hash);
+  ASSERT_EQ(7U, entries.size());
+
+  EXPECT_EQ(Section::ProvidesTopLevel, entries[0].section);
+  EXPECT_EQ("foo", entries[0].name);
+  EXPECT_TRUE(entries[0].isCascading);
+
+  EXPECT_EQ(Section::ProvidesMember, entries[2].section);
+  EXPECT_EQ("V4main3Bar", entries[2].name);
+  EXPECT_EQ("", entries[2].member);
+
+  EXPECT_EQ(Section::DependsTopLevel, entries[3].section);
+  EXPECT_EQ("foo", entries[3].name);
+  EXPECT_FALSE(entries[3].isCascading);
+
+  EXPECT_EQ(Section::DependsMember, entries[4].section);
+  EXPECT_EQ("V4main3Bar", entries[4].name);
+  EXPECT_EQ("baz", entries[4].member);
+
+  EXPECT_EQ(Section::DependsExternal, entries[5].section);
+  EXPECT_EQ("/tmp/Module.swiftmodule", entries[5].name);
+
+  EXPECT_EQ(Section::Fingerprints, entries[6].section);
+  EXPECT_EQ(std::string("V4main3Bar\0baz", 14), entries[6].name);
+  EXPECT_EQ("fedcba9876543210", entries[6].member);
+}
+
+TEST(ReferenceDependencyFormat, StringsAreStoredOnce) {
+  BinaryWriter once;
+  once.addName(Section::DependsTopLevel, "aVeryLongNameIndeed");
+  BinaryWriter twice;
+  twice.addName(Section::DependsTopLevel, "aVeryLongNameIndeed");
+  twice.addName(Section::ProvidesTopLevel, "aVeryLongNameIndeed");
+
+  // The second record costs only its own fixed-size fields.
+  EXPECT_EQ(write(once).size() + 3 * sizeof(uint32_t), write(twice).size());
+}
+
+TEST(ReferenceDependencyFormat, Empty) {
+  std::string hash = "stale";
+  std::vector<ReadEntry> entries;
+  ASSERT_TRUE(read(write(BinaryWriter()), hash, entries));
+  EXPECT_EQ("", hash);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(ReferenceDependencyFormat, RejectsMalformedFiles) {
+  BinaryWriter writer;
+  writer.addPair(Section::DependsMember, "V4main3Bar", "baz");
+  writer.setInterfaceHash("0123456789abcdef");
+  std::string data = write(writer);
+
+  std::string hash;
+  std::vector<ReadEntry> entries;
+
+  // Every truncation is caught.
+  for (size_t length = 0; length != data.size(); ++length) {
+    entries.clear();
+    EXPECT_FALSE(read(StringRef(data).substr(0, length), hash, entries));
+  }
+
+  // So is a different version.
+  std::string otherVersion = data;
+  otherVersion[sizeof(Signature)] += 1;
+  EXPECT_FALSE(read(otherVersion, hash, entries));
+
+  // And so is an unknown section.
+  std::string badSection = data;
+  // The header, then the ends of the three strings, then the record.
+  size_t recordOffset = sizeof(Signature) + 7 * sizeof(uint32_t);
+  badSection[recordOffset + 2 * sizeof(uint32_t)] = 0x7F;
+  EXPECT_FALSE(read(badSection, hash, entries));
+}
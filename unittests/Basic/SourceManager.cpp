@@ -1,6 +1,9 @@
 #include "swift/Basic/SourceManager.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
 #include <vector>
 
 using namespace swift;
@@ -85,3 +88,76 @@ TEST(SourceManager, RangeContains) {
   EXPECT_TRUE(SM.rangeContains(R_ad, R_bc));
 }
 
+
+TEST(SourceManager, LineAndColumn) {
+  SourceManager SM;
+  StringRef Source = "a\nbb\r\nccc\n\nd\re\n";
+  unsigned ID = SM.addMemBufferCopy(Source);
+  const llvm::SourceMgr &LLVMSM = SM.getLLVMSourceMgr();
+  const char *Start = LLVMSM.getMemoryBuffer(ID)->getBufferStart();
+
+  // Forwards, backwards and out of order, the lines and columns must match
+  // llvm::SourceMgr's.
+  std::vector<unsigned> Offsets;
+  for (unsigned i = 0, e = Source.size(); i <= e; ++i)
+    Offsets.push_back(i);
+  for (unsigned i = Source.size() + 1; i != 0; --i)
+    Offsets.push_back(i - 1);
+  for (unsigned i = 0, e = Source.size(); i <= e; ++i)
+    Offsets.push_back((i * 7) % (e + 1));
+
+  for (unsigned Offset : Offsets) {
+    SMLoc Ptr = SMLoc::getFromPointer(Start + Offset);
+    SourceLoc Loc(Ptr);
+    auto Expected = LLVMSM.getLineAndColumn(Ptr, ID);
+    EXPECT_EQ(Expected, SM.getLineAndColumn(Loc, ID)) << "offset " << Offset;
+    EXPECT_EQ(Expected, SM.getLineAndColumn(Loc)) << "offset " << Offset;
+    EXPECT_EQ(Expected.first, SM.getLineNumber(Loc)) << "offset " << Offset;
+  }
+}
+
+/// Compares line lookups through the SourceManager with ones straight through
+/// llvm::SourceMgr. This is disabled by default; run it with
+///
+///   SwiftBasicTests --gtest_also_run_disabled_tests \
+///     --gtest_filter='*LineAndColumnBenchmark*'
+TEST(SourceManager, DISABLED_LineAndColumnBenchmark) {
+  std::string Source;
+  for (unsigned i = 0; i != 20000; ++i)
+    Source += "  let value = someFunction(argument, anotherArgument)\n";
+
+  SourceManager SM;
+  unsigned ID = SM.addMemBufferCopy(Source);
+  const llvm::SourceMgr &LLVMSM = SM.getLLVMSourceMgr();
+  const char *Start = LLVMSM.getMemoryBuffer(ID)->getBufferStart();
+
+  // Mostly forward, with the occasional jump back the way debug info and
+  // diagnostics make them.
+  std::vector<SMLoc> Locs;
+  for (unsigned i = 0, e = Source.size(); i < e; i += 13) {
+    Locs.push_back(SMLoc::getFromPointer(Start + i));
+    if (i % 1000 == 0)
+      Locs.push_back(SMLoc::getFromPointer(Start + i / 2));
+  }
+
+  auto time = [](const std::function<void()> &body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  };
+
+  unsigned Total = 0;
+  double LLVMTime = time([&] {
+    for (SMLoc Loc : Locs)
+      Total += LLVMSM.getLineAndColumn(Loc, ID).first;
+  });
+  double IndexTime = time([&] {
+    for (SMLoc Loc : Locs)
+      Total -= SM.getLineAndColumn(SourceLoc(Loc), ID).first;
+  });
+  EXPECT_EQ(0U, Total);
+
+  printf("%zu lookups: llvm::SourceMgr %.2f ms, SourceManager %.2f ms\n",
+         Locs.size(), LLVMTime, IndexTime);
+}
@@ -0,0 +1,52 @@
+#include "swift/Basic/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+TEST(SharedTimer, RecordTimeline) {
+  std::vector<TimedPhase> timeline;
+  SharedTimer::recordTimeline(&timeline);
+  {
+    SharedTimer outer("Outer");
+    {
+      SharedTimer inner("Inner");
+    }
+  }
+  SharedTimer::recordTimeline(nullptr);
+
+  ASSERT_EQ(2U, timeline.size());
+  EXPECT_EQ("Outer", timeline[0].Name);
+  EXPECT_EQ("Inner", timeline[1].Name);
+  EXPECT_LE(timeline[0].Start.usec(), timeline[1].Start.usec());
+  EXPECT_LE(timeline[1].End.usec(), timeline[0].End.usec());
+}
+
+TEST(SharedTimer, TimelineRoundTrip) {
+  std::vector<TimedPhase> timeline(2);
+  timeline[0].Name = "Type checking / Semantic analysis";
+  timeline[0].Start.usec(1000);
+  timeline[0].End.usec(2500);
+  timeline[1].Name = "IRGen";
+  timeline[1].Start.usec(2600);
+  timeline[1].End.usec(2600);
+
+  std::string data;
+  llvm::raw_string_ostream out(data);
+  SharedTimer::writeTimeline(out, timeline);
+  out.flush();
+
+  std::vector<TimedPhase> read;
+  ASSERT_TRUE(SharedTimer::readTimeline(data, read));
+  ASSERT_EQ(2U, read.size());
+  EXPECT_EQ(timeline[0].Name, read[0].Name);
+  EXPECT_EQ(1000U, read[0].Start.usec());
+  EXPECT_EQ(2500U, read[0].End.usec());
+  EXPECT_EQ(timeline[1].Name, read[1].Name);
+  EXPECT_EQ(2600U, read[1].End.usec());
+
+  std::vector<TimedPhase> malformed;
+  EXPECT_FALSE(SharedTimer::readTimeline("1000 abc Parsing\n", malformed));
+  EXPECT_FALSE(SharedTimer::readTimeline("2000 1000 Parsing\n", malformed));
+  EXPECT_FALSE(SharedTimer::readTimeline("1000 2000\n", malformed));
+}
@@ -790,3 +790,105 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, ChangedFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints: [[a, a1], [b, b1]]\n"
+                                 "interface-hash: \"before\""),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Only b's declaration changed along with the interface.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints: [[a, a1], [b, b2]]\n"
+                                 "interface-hash: \"after\""),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.wasSparedByFingerprints(1));
+  EXPECT_FALSE(graph.wasSparedByFingerprints(2));
+}
+
+TEST(DependencyGraph, UnchangedFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints: [[a, a1]]\n"
+                                 "interface-hash: \"before\""),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+
+  // The interface changed somewhere nothing else can see.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints: [[a, a1]]\n"
+                                 "interface-hash: \"after\""),
+            LoadResult::UpToDate);
+}
+
+TEST(DependencyGraph, RemovedFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints: [[a, a1], [b, b1]]\n"
+                                 "interface-hash: \"before\""),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Dropping b affects its users.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints: [[a, a1]]\n"
+                                 "interface-hash: \"after\""),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+}
+
+TEST(DependencyGraph, MissingFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"before\""),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Without fingerprints from before, everything is affected.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints: [[a, a1], [b, b1]]\n"
+                                 "interface-hash: \"after\""),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_FALSE(graph.wasSparedByFingerprints(1));
+}
@@ -72,6 +72,29 @@ TEST_F(LexerTest, TokenizeWithComments) {
             Toks[0].getLoc().getAdvancedLoc(8));
 }
 
+TEST_F(LexerTest, TokenizeLongComments) {
+  // Long enough that the comments are skipped a word at a time, with the
+  // delimiters, newlines and non-ASCII characters in the middle of a word.
+  const char *Source =
+      "// A line comment long enough to skip in words\n"
+      "abcdefghijklmnop_qrstuvwxyz0123456789$ident\u00e9t\u00e9\n"
+      "/* A block comment /* nested */ with \u00fcnicode and\r\n"
+      "a second line, ending here **/\n"
+      "    \t  x // trailing";
+  std::vector<tok> ExpectedTokens{
+    tok::comment, tok::identifier, tok::comment, tok::identifier, tok::comment
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ(47U, Toks[0].getLength());
+  EXPECT_EQ("abcdefghijklmnop_qrstuvwxyz0123456789$ident\u00e9t\u00e9",
+            Toks[1].getText());
+  EXPECT_TRUE(Toks[2].getText().endswith("ending here **/"));
+  EXPECT_TRUE(Toks[3].isAtStartOfLine());
+  EXPECT_EQ("x", Toks[3].getText());
+  EXPECT_EQ("// trailing", Toks[4].getText());
+}
+
 TEST_F(LexerTest, EOFTokenLengthIsZero) {
   const char *Source = "meow";
   std::vector<tok> ExpectedTokens{ tok::identifier, tok::eof };
@@ -0,0 +1,105 @@
+//===--- CachingMemoryReader.cpp - CachingMemoryReader tests --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Remote/CachingMemoryReader.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace swift;
+using namespace remote;
+
+namespace {
+
+/// A fake address space of a few pages starting at PageSize, which counts
+/// how often it is read.
+class FakeMemoryReader final : public MemoryReader {
+public:
+  static const uint64_t PageSize = 64;
+  std::vector<uint8_t> Memory;
+  unsigned NumReads = 0;
+
+  FakeMemoryReader() : Memory(4 * PageSize) {
+    for (size_t i = 0; i < Memory.size(); ++i)
+      Memory[i] = uint8_t(i + 1);
+    // A string that crosses into the second page.
+    std::memcpy(&Memory[PageSize - 3], "hello", 6);
+  }
+
+  uint8_t getPointerSize() override { return 8; }
+  uint8_t getSizeSize() override { return 8; }
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return RemoteAddress(uint64_t(0));
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++NumReads;
+    uint64_t start = address.getAddressData();
+    if (start < PageSize || start - PageSize + size > Memory.size())
+      return false;
+    std::memcpy(dest, &Memory[start - PageSize], size);
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    ++NumReads;
+    uint64_t start = address.getAddressData();
+    if (start < PageSize || start - PageSize >= Memory.size())
+      return false;
+    dest = reinterpret_cast<const char *>(&Memory[start - PageSize]);
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+TEST(CachingMemoryReaderTest, ReadsWholePages) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, FakeMemoryReader::PageSize, 2);
+  const uint64_t base = FakeMemoryReader::PageSize;
+
+  uint32_t value;
+  for (uint64_t offset = 0; offset < 32; offset += 4) {
+    ASSERT_TRUE(reader.readInteger(RemoteAddress(base + offset), &value));
+    uint32_t expected;
+    std::memcpy(&expected, &fake->Memory[offset], sizeof(expected));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_EQ(1u, fake->NumReads);
+
+  // A read across a page boundary.
+  uint8_t bytes[8];
+  ASSERT_TRUE(reader.readBytes(RemoteAddress(base + 60), bytes, 8));
+  EXPECT_EQ(0, std::memcmp(bytes, &fake->Memory[60], 8));
+  EXPECT_EQ(2u, fake->NumReads);
+
+  std::string string;
+  ASSERT_TRUE(reader.readString(RemoteAddress(base + 61), string));
+  EXPECT_EQ("hello", string);
+  EXPECT_EQ(2u, fake->NumReads);
+
+  reader.invalidate();
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(base), &value));
+  EXPECT_EQ(3u, fake->NumReads);
+}
+
+TEST(CachingMemoryReaderTest, FallsBackForUnmappedPages) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, 256);
+
+  // The 256-byte page containing this address isn't fully mapped.
+  uint8_t bytes[4];
+  ASSERT_TRUE(reader.readBytes(RemoteAddress(uint64_t(100)), bytes, 4));
+  EXPECT_EQ(0, std::memcmp(bytes, &fake->Memory[100 - 64], 4));
+
+  EXPECT_FALSE(reader.readBytes(RemoteAddress(uint64_t(8)), bytes, 4));
+}
@@ -14,6 +14,7 @@
 #include "gtest/gtest.h"
 
 using FuzzyStringMatcher = SourceKit::FuzzyStringMatcher;
+using llvm::StringRef;
 
 TEST(FuzzyStringMatcher, BasicMatching) {
   {
@@ -51,6 +52,29 @@ TEST(FuzzyStringMatcher, SingleCharacterMatching) {
   EXPECT_FALSE(FuzzyStringMatcher("a").matchesCandidate(""));
 }
 
+TEST(FuzzyStringMatcher, LongCandidateMatching) {
+  FuzzyStringMatcher m("uiCtrlEvt");
+  EXPECT_TRUE(m.matchesCandidate("UIApplicationControlWillReceiveEvent"));
+  EXPECT_TRUE(m.matchesCandidate("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxuictrlevt"));
+  EXPECT_TRUE(m.matchesCandidate("UICTRLEVTxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"));
+  EXPECT_FALSE(m.matchesCandidate("UIApplicationControlWillReceiveEven"));
+  EXPECT_FALSE(m.matchesCandidate("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxuievtctrl"));
+}
+
+TEST(FuzzyStringMatcher, CharacterMask) {
+  FuzzyStringMatcher m("asDf");
+  auto mayMatch = [&](StringRef candidate) {
+    return m.mayMatchCandidateMask(
+        FuzzyStringMatcher::getCharacterMask(candidate));
+  };
+  EXPECT_TRUE(mayMatch("ASDF"));
+  EXPECT_TRUE(mayMatch("fdsa"));
+  EXPECT_TRUE(mayMatch("a_s_d_f"));
+  EXPECT_FALSE(mayMatch("asd"));
+  EXPECT_FALSE(mayMatch(""));
+  EXPECT_TRUE(FuzzyStringMatcher("").mayMatchCandidateMask(0));
+}
+
 TEST(FuzzyStringMatcher, UnicodeMatching) {
   // Single code point matching.
   EXPECT_TRUE(FuzzyStringMatcher(u8"\u2602a\U0002000Bz")
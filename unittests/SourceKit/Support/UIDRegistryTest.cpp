@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/UIdent.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SourceKit;
+using namespace llvm;
+
+TEST(UIdent, Interning) {
+  UIdent A("source.test.uid.a");
+  UIdent B("source.test.uid.b");
+  EXPECT_TRUE(A.isValid());
+  EXPECT_NE(A, B);
+  EXPECT_EQ(A, UIdent("source.test.uid.a"));
+  EXPECT_EQ(A.getName(), "source.test.uid.a");
+  EXPECT_STREQ(A.c_str(), "source.test.uid.a");
+
+  int Tag;
+  A.setTag(&Tag);
+  EXPECT_EQ(UIdent("source.test.uid.a").getTag(), &Tag);
+  EXPECT_EQ(B.getTag(), nullptr);
+}
+
+TEST(UIdent, ConcurrentInterning) {
+  // Enough names that the registry has to grow while the threads race on
+  // inserting and looking them up.
+  const unsigned NumNames = 5000;
+  const unsigned NumThreads = 4;
+  std::vector<std::string> Names;
+  for (unsigned I = 0; I != NumNames; ++I)
+    Names.push_back("source.test.concurrent." + std::to_string(I));
+
+  std::vector<std::vector<UIdent>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    Threads.emplace_back([&, T] {
+      // Go through the names in a different order on each thread.
+      for (unsigned I = 0; I != NumNames; ++I)
+        Results[T].push_back(UIdent(Names[(I * (T + 1)) % NumNames]));
+    });
+  }
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    for (unsigned I = 0; I != NumNames; ++I) {
+      const std::string &Name = Names[(I * (T + 1)) % NumNames];
+      EXPECT_EQ(Results[T][I].getName(), Name);
+      EXPECT_EQ(Results[T][I], UIdent(Name));
+    }
+  }
+}
@@ -0,0 +1,54 @@
+//===--- Benchmark.h - Helpers for runtime microbenchmarks ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Timing helpers shared by the disabled *Benchmark tests of the runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_UNITTESTS_RUNTIME_BENCHMARK_H
+#define SWIFT_UNITTESTS_RUNTIME_BENCHMARK_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/// Run \p body on \p numThreads threads at once and return the elapsed
+/// wall-clock time in milliseconds.
+template <class Fn>
+double timeThreads(unsigned numThreads, const Fn &body) {
+  std::atomic<unsigned> ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+
+  for (unsigned t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t] {
+      ++ready;
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+      body(t);
+    });
+  }
+
+  while (ready.load() != numThreads)
+    std::this_thread::yield();
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &thread : threads)
+    thread.join();
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+#endif
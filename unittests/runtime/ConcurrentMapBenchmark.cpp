@@ -0,0 +1,107 @@
+//===--- ConcurrentMapBenchmark.cpp - Concurrent map microbenchmarks ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares the lookup and insertion throughput of ConcurrentMap and
+// ConcurrentHashMap under increasing numbers of threads. These are disabled
+// by default; run them with
+//
+//   SwiftRuntimeTests --gtest_also_run_disabled_tests \
+//     --gtest_filter='*ConcurrentMapBenchmark*'
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "swift/Runtime/Concurrent.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+
+namespace {
+
+struct BenchmarkEntry {
+  size_t Key;
+  BenchmarkEntry(size_t key) : Key(key) {}
+  int compareWithKey(size_t key) const {
+    return (key == Key ? 0 : (key < Key ? -1 : 1));
+  }
+  static size_t getExtraAllocationSize(size_t key) { return 0; }
+  static size_t getKeyHash(size_t key) { return (key >> 4) * 0x9E3779B1; }
+};
+
+/// The number of distinct keys, roughly the number of entries in a busy
+/// metadata cache.
+const size_t NumKeys = 1 << 14;
+
+/// The number of operations each thread performs.
+const size_t NumOpsPerThread = 1 << 18;
+
+/// Keys spread over the address space the way metadata pointers are:
+/// scrambled, and 16-byte aligned.
+size_t getKey(size_t i) {
+  return size_t(uint32_t(i * 2654435761u)) << 4;
+}
+
+template <class Map>
+double benchmarkLookups(unsigned numThreads) {
+  Map map;
+  for (size_t i = 0; i < NumKeys; ++i)
+    map.getOrInsert(getKey(i));
+
+  std::atomic<size_t> sink(0);
+  double ms = timeThreads(numThreads, [&](unsigned t) {
+    size_t found = 0;
+    for (size_t i = 0; i < NumOpsPerThread; ++i)
+      found += map.find(getKey((i + t * 7919) % NumKeys)) != nullptr;
+    sink += found;
+  });
+
+  EXPECT_EQ(numThreads * NumOpsPerThread, sink.load());
+  return ms;
+}
+
+template <class Map>
+double benchmarkInsertions(unsigned numThreads) {
+  Map map;
+  return timeThreads(numThreads, [&](unsigned t) {
+    // Every thread races to insert the same keys, as happens when many
+    // threads instantiate the same metadata for the first time.
+    for (size_t i = 0; i < NumKeys; ++i)
+      map.getOrInsert(getKey((i + t * 7919) % NumKeys));
+  });
+}
+
+template <class Fn>
+void runForThreadCounts(const char *name, const Fn &fn) {
+  printf("%-24s %8s %12s %12s\n", name, "threads", "tree (ms)", "hash (ms)");
+  for (unsigned numThreads = 1; numThreads <= 64; numThreads *= 2) {
+    auto result = fn(numThreads);
+    printf("%-24s %8u %12.2f %12.2f\n", "", numThreads,
+           result.first, result.second);
+  }
+}
+
+} // end anonymous namespace
+
+TEST(ConcurrentMapBenchmark, DISABLED_Lookup) {
+  runForThreadCounts("lookup", [](unsigned numThreads) {
+    return std::make_pair(
+      benchmarkLookups<ConcurrentMap<BenchmarkEntry>>(numThreads),
+      benchmarkLookups<ConcurrentHashMap<BenchmarkEntry>>(numThreads));
+  });
+}
+
+TEST(ConcurrentMapBenchmark, DISABLED_Insert) {
+  runForThreadCounts("insert", [](unsigned numThreads) {
+    return std::make_pair(
+      benchmarkInsertions<ConcurrentMap<BenchmarkEntry>>(numThreads),
+      benchmarkInsertions<ConcurrentHashMap<BenchmarkEntry>>(numThreads));
+  });
+}
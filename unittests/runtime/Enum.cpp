@@ -13,6 +13,8 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Enum.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
 
 using namespace swift;
 
@@ -170,3 +172,75 @@ TEST(EnumTest, storeEnumTagSinglePayload) {
   ASSERT_TRUE(test_storeEnumTagSinglePayload({1, 1}, {219, 123},
                                               XI_TMBi8_, 3, 4));
 }
+
+namespace {
+/// Metadata for a multi-payload enum laid out by the runtime, with the
+/// payload size stored right after the enum metadata.
+struct TestMultiPayloadEnum {
+  EnumValueWitnessTable ValueWitnesses;
+  const ValueWitnessTable *ValueWitnessesRef;
+  EnumMetadata Metadata;
+  EnumMetadata::StoredSize PayloadSize;
+
+  TestMultiPayloadEnum(NominalTypeDescriptor *description)
+    : ValueWitnessesRef(&ValueWitnesses),
+      Metadata(MetadataKind::Enum, description, nullptr), PayloadSize(0) {}
+};
+
+/// Initialize an enum with \p numPayloads payloads of type \p payload and
+/// \p numEmptyCases empty cases, and check that every case in \p cases
+/// round-trips through the runtime entry points and the installed enum
+/// value witnesses. Returns the size of the enum.
+size_t test_multiPayloadRoundTrip(const ValueWitnessTable &payload,
+                                  unsigned numPayloads,
+                                  unsigned numEmptyCases,
+                                  std::initializer_list<unsigned> cases) {
+  alignas(NominalTypeDescriptor)
+    uint8_t descriptionBuffer[sizeof(NominalTypeDescriptor)] = {};
+  auto description =
+    reinterpret_cast<NominalTypeDescriptor *>(descriptionBuffer);
+  TestMultiPayloadEnum type(description);
+  size_t payloadSizeOffset =
+    (reinterpret_cast<char *>(&type.PayloadSize) -
+     reinterpret_cast<char *>(&type.Metadata)) / sizeof(void *);
+  description->Enum.NumPayloadCasesAndPayloadSizeOffset =
+    numPayloads | (payloadSizeOffset << 24);
+  description->Enum.NumEmptyCases = numEmptyCases;
+
+  std::vector<const TypeLayout *> payloadLayouts(numPayloads,
+                                                 payload.getTypeLayout());
+  swift_initEnumMetadataMultiPayload(&type.ValueWitnesses, &type.Metadata,
+                                     numPayloads, payloadLayouts.data());
+  EXPECT_EQ(payload.size, type.PayloadSize);
+
+  std::vector<uint8_t> buf(type.ValueWitnesses.size, 0xA5);
+  auto value = asOpaque(buf.data());
+  for (unsigned whichCase : cases) {
+    swift_storeEnumTagMultiPayload(value, &type.Metadata, whichCase);
+    EXPECT_EQ(whichCase, swift_getEnumCaseMultiPayload(value, &type.Metadata));
+    EXPECT_EQ(int(whichCase) - int(numPayloads),
+              type.ValueWitnesses.getEnumTag(value, &type.Metadata));
+
+    std::fill(buf.begin(), buf.end(), 0xA5);
+    type.ValueWitnesses.destructiveInjectEnumTag(
+      value, int(whichCase) - int(numPayloads), &type.Metadata);
+    EXPECT_EQ(whichCase, swift_getEnumCaseMultiPayload(value, &type.Metadata));
+  }
+
+  return type.ValueWitnesses.size;
+}
+} // end anonymous namespace
+
+TEST(EnumTest, multiPayloadRoundTrip) {
+  // A one-byte payload and a one-byte tag.
+  EXPECT_EQ(2u, test_multiPayloadRoundTrip(_TWVBi8_, 2, 3, {0, 1, 2, 3, 4}));
+
+  // A one-byte payload with enough empty cases to need a two-byte tag. The
+  // empty cases are split between the payload and tag areas.
+  EXPECT_EQ(3u, test_multiPayloadRoundTrip(_TWVBi8_, 2, 70000,
+                                           {0, 1, 2, 257, 300, 70001}));
+
+  // An eight-byte payload holds the whole index of an empty case.
+  EXPECT_EQ(9u, test_multiPayloadRoundTrip(_TWVBi64_, 3, 1000,
+                                           {0, 1, 2, 3, 500, 1002}));
+}
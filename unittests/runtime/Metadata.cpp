@@ -13,6 +13,8 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Concurrent.h"
 #include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
 #include <iterator>
 #include <functional>
 #include <sys/mman.h>
@@ -248,6 +250,47 @@ TEST(Concurrent, ConcurrentMap) {
   }
 }
 
+TEST(Concurrent, ConcurrentHashMap) {
+  const int numElem = 1000;
+
+  struct Entry {
+    size_t Key;
+    Entry(size_t key) : Key(key) {}
+    int compareWithKey(size_t key) const {
+      return (key == Key ? 0 : (key < Key ? -1 : 1));
+    }
+    static size_t getExtraAllocationSize(size_t key) { return 0; }
+    static size_t getKeyHash(size_t key) { return key * 0x9E3779B1; }
+  };
+
+  ConcurrentHashMap<Entry> Map;
+  std::atomic<int> numInserted(0);
+
+  // Add a bunch of numbers to the map concurrently. Enough of them to force
+  // the table to grow several times while other threads are inserting.
+  auto results = RaceTest<int*>(
+    [&]() -> int* {
+      for (int i = 0; i < numElem; i++) {
+        size_t hash = (i * 123512) % 0xFFFF ;
+        if (Map.getOrInsert(hash).second)
+          ++numInserted;
+      }
+      return nullptr;
+    }
+  );
+
+  // Each key must have been inserted exactly once.
+  EXPECT_EQ(numElem, numInserted.load());
+
+  // Check that all of the values that we inserted are in the map.
+  for (int i=0; i < numElem; i++) {
+    size_t hash = (i * 123512) % 0xFFFF ;
+    auto entry = Map.find(hash);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(hash, entry->Key);
+  }
+  EXPECT_FALSE(Map.find(size_t(0xFFFF)));
+}
 
 TEST(MetadataTest, getGenericMetadata) {
   auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
@@ -341,6 +384,114 @@ TEST(MetadataTest, getMetatypeMetadata) {
   ASSERT_EQ(inst1, inst5->InstanceType);
 }
 
+static const Metadata *SmallTypeMetadataElements[] = {
+  &_TMBi8_.base, &_TMBi16_.base, &_TMBi32_.base, &_TMBi64_.base,
+  &MetadataTest2,
+};
+
+TEST(MetadataTest, getTupleTypeMetadata_smallArities) {
+  // The memoized entry points must agree with the general one, including
+  // when many keys compete for the same memo slots.
+  for (auto elt0 : SmallTypeMetadataElements)
+  for (auto elt1 : SmallTypeMetadataElements) {
+    const Metadata *elts2[] = { elt0, elt1 };
+    auto tuple2 = RaceTest_ExpectEqual<const TupleTypeMetadata *>(
+      [&]() -> const TupleTypeMetadata * {
+        return swift_getTupleTypeMetadata2(elt0, elt1, nullptr, nullptr);
+      });
+    EXPECT_EQ(swift_getTupleTypeMetadata(2, elts2, nullptr, nullptr), tuple2);
+    EXPECT_EQ(elt0, tuple2->getElement(0).Type);
+    EXPECT_EQ(elt1, tuple2->getElement(1).Type);
+
+    for (auto elt2 : SmallTypeMetadataElements) {
+      const Metadata *elts3[] = { elt0, elt1, elt2 };
+      auto tuple3 = swift_getTupleTypeMetadata3(elt0, elt1, elt2,
+                                                nullptr, nullptr);
+      EXPECT_EQ(swift_getTupleTypeMetadata(3, elts3, nullptr, nullptr),
+                tuple3);
+      EXPECT_EQ(elt2, tuple3->getElement(2).Type);
+    }
+  }
+}
+
+TEST(MetadataTest, getFunctionTypeMetadata_smallArities) {
+  auto flags1 = FunctionTypeFlags().withNumArguments(1);
+  auto flags2 = FunctionTypeFlags().withNumArguments(2);
+
+  for (auto arg : SmallTypeMetadataElements)
+  for (auto result : SmallTypeMetadataElements) {
+    auto fn1 = RaceTest_ExpectEqual<const FunctionTypeMetadata *>(
+      [&]() -> const FunctionTypeMetadata * {
+        return swift_getFunctionTypeMetadata1(flags1, arg, result);
+      });
+    const void *key1[] = {
+      reinterpret_cast<const void *>(flags1.getIntValue()), arg, result
+    };
+    EXPECT_EQ(swift_getFunctionTypeMetadata(key1), fn1);
+    EXPECT_EQ(result, fn1->ResultType);
+
+    auto fn2 = swift_getFunctionTypeMetadata2(flags2, arg, result, result);
+    const void *key2[] = {
+      reinterpret_cast<const void *>(flags2.getIntValue()), arg, result,
+      result
+    };
+    EXPECT_EQ(swift_getFunctionTypeMetadata(key2), fn2);
+
+    // The flags are part of the key.
+    auto throwing1 = swift_getFunctionTypeMetadata1(flags1.withThrows(true),
+                                                    arg, result);
+    EXPECT_NE(fn1, throwing1);
+    EXPECT_TRUE(throwing1->throws());
+  }
+}
+
+/// Time \p count calls to \p fn in milliseconds.
+template <class Fn>
+static double timeCalls(size_t count, const Fn &fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i)
+    fn(i);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Compare the memoized small-arity entry points with the general ones, which
+// always search the cache. Disabled by default; run with
+//   --gtest_also_run_disabled_tests --gtest_filter='*SmallArityBenchmark*'
+TEST(MetadataTest, DISABLED_SmallArityBenchmark) {
+  const size_t NumCalls = 1 << 22;
+  const size_t NumElements = std::end(SmallTypeMetadataElements) -
+                             std::begin(SmallTypeMetadataElements);
+  auto elt = [&](size_t i) {
+    return SmallTypeMetadataElements[i % NumElements];
+  };
+  auto flags2 = FunctionTypeFlags().withNumArguments(2);
+
+  double tupleGeneral = timeCalls(NumCalls, [&](size_t i) {
+    const Metadata *elts[] = { elt(i), elt(i / NumElements) };
+    swift_getTupleTypeMetadata(2, elts, nullptr, nullptr);
+  });
+  double tupleMemo = timeCalls(NumCalls, [&](size_t i) {
+    swift_getTupleTypeMetadata2(elt(i), elt(i / NumElements),
+                                nullptr, nullptr);
+  });
+  double functionGeneral = timeCalls(NumCalls, [&](size_t i) {
+    const void *key[] = {
+      reinterpret_cast<const void *>(flags2.getIntValue()),
+      elt(i), elt(i / NumElements), elt(i + 1)
+    };
+    swift_getFunctionTypeMetadata(key);
+  });
+  double functionMemo = timeCalls(NumCalls, [&](size_t i) {
+    swift_getFunctionTypeMetadata2(flags2, elt(i), elt(i / NumElements),
+                                   elt(i + 1));
+  });
+
+  printf("%zu calls: tuple2 %.2f ms (cache) vs %.2f ms (memo), "
+         "function2 %.2f ms (cache) vs %.2f ms (memo)\n",
+         NumCalls, tupleGeneral, tupleMemo, functionGeneral, functionMemo);
+}
+
 ProtocolDescriptor ProtocolA{
   "_TMp8Metadata9ProtocolA",
   nullptr,
@@ -980,3 +1131,69 @@ TEST(WitnessTableTest, getGenericWitnessTable) {
       });
   }
 }
+
+// Tests for base protocol witness tables derived on first use
+
+struct LazyWitnessTableBaseStorage {
+  int32_t GenericTable;
+  int32_t Accessor;
+};
+
+const void *lazyBaseWitnesses[] = {
+  (void *) 123
+};
+
+std::atomic<unsigned> NumLazyBaseAccessorCalls(0);
+
+static const WitnessTable *lazyBaseAccessor(const Metadata *type) {
+  ++NumLazyBaseAccessorCalls;
+  EXPECT_EQ(type, &MetadataTest2);
+  return reinterpret_cast<const WitnessTable *>(lazyBaseWitnesses);
+}
+
+GenericWitnessTableStorage lazyTableStorage;
+LazyWitnessTableBaseStorage lazyBaseStorage;
+const void *lazyWitnesses[2];
+
+TEST(WitnessTableTest, getWitnessTableBase) {
+  initializeRelativePointer(&lazyBaseStorage.GenericTable, &lazyTableStorage);
+  initializeRelativePointer(&lazyBaseStorage.Accessor,
+                            (const void *) lazyBaseAccessor);
+
+  lazyWitnesses[0] = (const char *) &lazyBaseStorage + LazyWitnessTableBaseTag;
+  lazyWitnesses[1] = (void *) 234;
+
+  lazyTableStorage.WitnessTableSizeInWords = 2;
+  lazyTableStorage.WitnessTablePrivateSizeInWords = 1;
+  initializeRelativePointer(&lazyTableStorage.Protocol, nullptr);
+  initializeRelativePointer(&lazyTableStorage.Pattern, lazyWitnesses);
+  initializeRelativePointer(&lazyTableStorage.Instantiator, nullptr);
+
+  GenericWitnessTable *table = reinterpret_cast<GenericWitnessTable *>(
+      &lazyTableStorage);
+
+  auto instantiatedTable = const_cast<WitnessTable *>(
+      swift_getGenericWitnessTable(table, &MetadataTest2, nullptr));
+
+  // Instantiation leaves the lazy slot alone.
+  EXPECT_EQ(((void **) instantiatedTable)[0], lazyWitnesses[0]);
+  EXPECT_EQ(NumLazyBaseAccessorCalls.load(), 0u);
+
+  auto base = RaceTest_ExpectEqual<const WitnessTable *>(
+    [&]() -> const WitnessTable * {
+      return swift_getWitnessTableBase(instantiatedTable, 0);
+    });
+
+  EXPECT_EQ(base, (const void *) lazyBaseWitnesses);
+  EXPECT_EQ(((void **) instantiatedTable)[0], (const void *) base);
+  EXPECT_GE(NumLazyBaseAccessorCalls.load(), 1u);
+
+  // Once resolved, the slot is read directly.
+  unsigned calls = NumLazyBaseAccessorCalls.load();
+  EXPECT_EQ(swift_getWitnessTableBase(instantiatedTable, 0), base);
+  EXPECT_EQ(NumLazyBaseAccessorCalls.load(), calls);
+
+  // Slots that were never lazy are returned as they are.
+  EXPECT_EQ(swift_getWitnessTableBase(instantiatedTable, 1),
+            (const void *) 234);
+}
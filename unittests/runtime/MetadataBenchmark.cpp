@@ -0,0 +1,366 @@
+//===--- MetadataBenchmark.cpp - Metadata and cast microbenchmarks --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the metadata lookups, conformance checks and dynamic casts of the
+// runtime in ns/op under increasing numbers of threads, so that changes to
+// the runtime's caches can be evaluated in isolation. These are disabled by
+// default; run them with
+//
+//   SwiftRuntimeTests --gtest_also_run_disabled_tests \
+//     --gtest_filter='*MetadataBenchmark*'
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "swift/Runtime/Metadata.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <mutex>
+
+using namespace swift;
+
+namespace {
+
+/// The number of operations each thread performs for cheap operations.
+const size_t NumOpsPerThread = 1 << 18;
+
+/// The number of operations each thread performs for operations that
+/// create an entry in a cache, which grow the caches as they run.
+const size_t NumMissesPerThread = 1 << 12;
+
+/// The number of distinct types looked up by the benchmarks that must not
+/// be answered by the per-thread conformance front cache, which has 64
+/// entries.
+const size_t NumTypes = 256;
+
+const unsigned MaxThreads = 16;
+
+/// The nominal type descriptor of the generic type, only used for its
+/// identity.
+uint32_t BenchDescriptor = 0;
+
+struct BenchGenericPattern {
+  GenericMetadata Header;
+  StructMetadata Template;
+};
+
+/// A generic struct with one argument, whose instantiations are cheap.
+BenchGenericPattern BenchGeneric = {
+  // Header
+  {
+    // allocation function
+    [](GenericMetadata *pattern, const void *args) -> Metadata * {
+      auto metadata = swift_allocateGenericValueMetadata(pattern, args);
+      auto metadataWords = reinterpret_cast<const void**>(metadata);
+      auto argsWords = reinterpret_cast<const void* const*>(args);
+      metadataWords[2] = argsWords[0];
+      return metadata;
+    },
+    3 * sizeof(void*), // metadata size
+    1, // num arguments
+    0, // address point
+    {} // private data
+  },
+
+  // Fields
+  {
+    MetadataKind::Struct,
+    reinterpret_cast<const NominalTypeDescriptor*>(&BenchDescriptor),
+    nullptr
+  }
+};
+
+/// Generic arguments that were never used before. They are only hashed and
+/// stored, so they don't need to point anywhere.
+std::atomic<uintptr_t> NextFreshArgument(0x100000);
+
+/// Reserve \p count fresh arguments, and return the first of them. The
+/// others follow it at intervals of 16 bytes.
+uintptr_t reserveFreshArguments(size_t count) {
+  return NextFreshArgument.fetch_add(16 * count);
+}
+
+const void *getFreshArgument() {
+  return reinterpret_cast<const void *>(reserveFreshArguments(1));
+}
+
+const Metadata *getBenchGeneric(const void *argument) {
+  const void *args[] = { argument };
+  return swift_getGenericMetadata(&BenchGeneric.Header, args);
+}
+
+ProtocolDescriptor BenchProtocol{
+  "_TMp17MetadataBenchmark13BenchProtocol",
+  nullptr,
+  ProtocolDescriptorFlags()
+    .withSwift(true)
+    .withClassConstraint(ProtocolClassConstraint::Any)
+    .withDispatchStrategy(ProtocolDispatchStrategy::Swift)
+};
+
+/// A protocol that nothing conforms to.
+ProtocolDescriptor BenchUnrelatedProtocol{
+  "_TMp17MetadataBenchmark22BenchUnrelatedProtocol",
+  nullptr,
+  ProtocolDescriptorFlags()
+    .withSwift(true)
+    .withClassConstraint(ProtocolClassConstraint::Any)
+    .withDispatchStrategy(ProtocolDispatchStrategy::Swift)
+};
+
+const void *BenchWitnesses[] = { (void *) 123 };
+
+/// The layout of a ProtocolConformanceRecord.
+struct ConformanceRecordStorage {
+  int32_t Protocol;
+  int32_t Type;
+  int32_t WitnessTable;
+  uint32_t Flags;
+};
+
+/// Builtin.Int64 and every instantiation of BenchGeneric conform to
+/// BenchProtocol.
+ConformanceRecordStorage BenchConformances[2];
+
+template <typename T>
+void initializeRelativePointer(int32_t *ptr, T value) {
+  *ptr = (int32_t)(value == nullptr ? 0 : (uintptr_t) value - (uintptr_t) ptr);
+}
+
+void registerBenchConformances() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    auto witnessTableFlags = ProtocolConformanceFlags()
+      .withConformanceKind(ProtocolConformanceReferenceKind::WitnessTable);
+
+    auto &int64Record = BenchConformances[0];
+    initializeRelativePointer(&int64Record.Protocol, &BenchProtocol);
+    initializeRelativePointer(&int64Record.Type, &_TMBi64_.base);
+    initializeRelativePointer(&int64Record.WitnessTable, BenchWitnesses);
+    int64Record.Flags = witnessTableFlags
+      .withTypeKind(TypeMetadataRecordKind::UniqueDirectType).getValue();
+
+    auto &genericRecord = BenchConformances[1];
+    initializeRelativePointer(&genericRecord.Protocol, &BenchProtocol);
+    initializeRelativePointer(&genericRecord.Type, &BenchDescriptor);
+    initializeRelativePointer(&genericRecord.WitnessTable, BenchWitnesses);
+    genericRecord.Flags = witnessTableFlags
+      .withTypeKind(TypeMetadataRecordKind::UniqueNominalTypeDescriptor)
+      .getValue();
+
+    auto begin =
+      reinterpret_cast<const ProtocolConformanceRecord *>(BenchConformances);
+    swift_registerProtocolConformances(begin, begin + 2);
+  });
+}
+
+/// The layout of an existential of one Swift protocol.
+struct BenchExistential {
+  ValueBuffer Buffer;
+  const Metadata *Type;
+  const WitnessTable *Witness;
+};
+
+const ExistentialTypeMetadata *getBenchExistentialType(
+                                        const ProtocolDescriptor *protocol) {
+  const ProtocolDescriptor *protocols[] = { protocol };
+  return swift_getExistentialTypeMetadata(1, protocols);
+}
+
+/// Run \p op \p opsPerThread times on each of \p numThreads threads, and
+/// return the time each operation took in nanoseconds. \p op is given the
+/// index of its thread and of the operation.
+template <class Fn>
+double timeOps(unsigned numThreads, size_t opsPerThread, const Fn &op) {
+  std::atomic<size_t> failures(0);
+  double ms = timeThreads(numThreads, [&](unsigned t) {
+    size_t failed = 0;
+    for (size_t i = 0; i < opsPerThread; ++i)
+      failed += !op(t, i);
+    failures += failed;
+  });
+  EXPECT_EQ(0u, failures.load());
+  return ms * 1e6 / opsPerThread;
+}
+
+void printHeader() {
+  printf("%-32s", "ns/op");
+  for (unsigned numThreads = 1; numThreads <= MaxThreads; numThreads *= 2)
+    printf(" %6u thr", numThreads);
+  printf("\n");
+}
+
+/// Print a row of the time \p fn takes per operation for each thread count.
+/// \p fn is called once for each thread count, and returns the ns/op.
+template <class Fn>
+void printRow(const char *name, const Fn &fn) {
+  printf("%-32s", name);
+  for (unsigned numThreads = 1; numThreads <= MaxThreads; numThreads *= 2)
+    printf(" %10.1f", fn(numThreads));
+  printf("\n");
+  fflush(stdout);
+}
+
+} // end anonymous namespace
+
+TEST(MetadataBenchmark, DISABLED_Metadata) {
+  printHeader();
+
+  printRow("getGenericMetadata hit", [](unsigned numThreads) {
+    const void *arguments[NumTypes];
+    for (auto &argument : arguments)
+      getBenchGeneric(argument = getFreshArgument());
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      return getBenchGeneric(arguments[(i + t * 31) % NumTypes]) != nullptr;
+    });
+  });
+
+  printRow("getGenericMetadata miss", [](unsigned numThreads) {
+    auto first = reserveFreshArguments(numThreads * NumMissesPerThread);
+    return timeOps(numThreads, NumMissesPerThread, [&](unsigned t, size_t i) {
+      auto argument = first + 16 * (t * NumMissesPerThread + i);
+      return getBenchGeneric(reinterpret_cast<const void *>(argument))
+        != nullptr;
+    });
+  });
+
+  printRow("getTupleTypeMetadata", [](unsigned numThreads) {
+    const Metadata *elements[] = {
+      &_TMBi8_.base, &_TMBi16_.base, &_TMBi32_.base, &_TMBi64_.base
+    };
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      const Metadata *elts[] = {
+        elements[i % 4], elements[(i / 4) % 4], elements[(i / 16) % 4],
+        elements[t % 4]
+      };
+      return swift_getTupleTypeMetadata(4, elts, nullptr, nullptr) != nullptr;
+    });
+  });
+
+  printRow("getExistentialTypeMetadata", [](unsigned numThreads) {
+    return timeOps(numThreads, NumOpsPerThread, [](unsigned t, size_t i) {
+      // The protocols are sorted in place, so start over from an unsorted
+      // list every time.
+      const ProtocolDescriptor *protocols[] = {
+        &BenchUnrelatedProtocol, &BenchProtocol
+      };
+      return swift_getExistentialTypeMetadata(1 + i % 2, protocols)
+        != nullptr;
+    });
+  });
+}
+
+TEST(MetadataBenchmark, DISABLED_ConformsToProtocol) {
+  registerBenchConformances();
+  printHeader();
+
+  printRow("conformsToProtocol front hit", [](unsigned numThreads) {
+    auto type = getBenchGeneric(getFreshArgument());
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      return swift_conformsToProtocol(type, &BenchProtocol) != nullptr;
+    });
+  });
+
+  printRow("conformsToProtocol hit", [](unsigned numThreads) {
+    // More types than fit in the front cache.
+    const Metadata *types[NumTypes];
+    for (auto &type : types) {
+      type = getBenchGeneric(getFreshArgument());
+      swift_conformsToProtocol(type, &BenchProtocol);
+    }
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      auto type = types[(i + t * 31) % NumTypes];
+      return swift_conformsToProtocol(type, &BenchProtocol) != nullptr;
+    });
+  });
+
+  printRow("conformsToProtocol miss", [](unsigned numThreads) {
+    // Types that were never checked, so every check has to consult the
+    // conformance records.
+    std::vector<const Metadata *> types(numThreads * NumMissesPerThread);
+    for (auto &type : types)
+      type = getBenchGeneric(getFreshArgument());
+    return timeOps(numThreads, NumMissesPerThread, [&](unsigned t, size_t i) {
+      auto type = types[t * NumMissesPerThread + i];
+      return swift_conformsToProtocol(type, &BenchUnrelatedProtocol)
+        == nullptr;
+    });
+  });
+
+  printRow("conformsToProtocol negative", [](unsigned numThreads) {
+    // More types than fit in the front cache, whose failures are cached.
+    const Metadata *types[NumTypes];
+    for (auto &type : types) {
+      type = getBenchGeneric(getFreshArgument());
+      swift_conformsToProtocol(type, &BenchUnrelatedProtocol);
+    }
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      auto type = types[(i + t * 31) % NumTypes];
+      return swift_conformsToProtocol(type, &BenchUnrelatedProtocol)
+        == nullptr;
+    });
+  });
+}
+
+TEST(MetadataBenchmark, DISABLED_DynamicCast) {
+  registerBenchConformances();
+  auto int64Type = &_TMBi64_.base;
+  auto existentialType = getBenchExistentialType(&BenchProtocol);
+  auto unrelatedType = getBenchExistentialType(&BenchUnrelatedProtocol);
+  printHeader();
+
+  printRow("dynamicCast same type", [&](unsigned numThreads) {
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      int64_t src = i, dest = 0;
+      return swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                               reinterpret_cast<OpaqueValue *>(&src),
+                               int64Type, int64Type,
+                               DynamicCastFlags::Default) && dest == src;
+    });
+  });
+
+  printRow("dynamicCast to existential", [&](unsigned numThreads) {
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      int64_t src = i;
+      BenchExistential dest;
+      return swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                               reinterpret_cast<OpaqueValue *>(&src),
+                               int64Type, existentialType,
+                               DynamicCastFlags::Default);
+    });
+  });
+
+  printRow("dynamicCast from existential", [&](unsigned numThreads) {
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      BenchExistential src;
+      *reinterpret_cast<int64_t *>(&src.Buffer) = i;
+      src.Type = int64Type;
+      src.Witness = reinterpret_cast<const WitnessTable *>(BenchWitnesses);
+      int64_t dest = 0;
+      return swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                               reinterpret_cast<OpaqueValue *>(&src),
+                               existentialType, int64Type,
+                               DynamicCastFlags::Default) && dest == int64_t(i);
+    });
+  });
+
+  printRow("dynamicCast failure", [&](unsigned numThreads) {
+    return timeOps(numThreads, NumOpsPerThread, [&](unsigned t, size_t i) {
+      int64_t src = i;
+      BenchExistential dest;
+      return !swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                                reinterpret_cast<OpaqueValue *>(&src),
+                                int64Type, unrelatedType,
+                                DynamicCastFlags::Default);
+    });
+  });
+}
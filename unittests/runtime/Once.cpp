@@ -0,0 +1,72 @@
+//===--- Once.cpp - swift_once Tests --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Once.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static std::atomic<int> NumInitializations;
+static int InitializedValue;
+
+static void initialize(void *) {
+  // Give the other threads time to pile up behind the initialization.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  InitializedValue = 42;
+  ++NumInitializations;
+}
+
+TEST(OnceTest, RunsOnceAcrossThreads) {
+  static swift_once_t predicate;
+  std::vector<std::thread> threads;
+  std::atomic<int> wrongValues(0);
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([&] {
+      swift_once(&predicate, initialize);
+      if (InitializedValue != 42)
+        ++wrongValues;
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(1, NumInitializations.load());
+  EXPECT_EQ(0, wrongValues.load());
+
+  // Later calls don't run the function again.
+  swift_once(&predicate, initialize);
+  EXPECT_EQ(1, NumInitializations.load());
+}
+
+#if !defined(__CYGWIN__)
+static swift_once_t OuterPredicate;
+static swift_once_t InnerPredicate;
+static bool InnerDone;
+
+static void initializeInner(void *) { InnerDone = true; }
+static void initializeOuter(void *) {
+  swift_once(&InnerPredicate, initializeInner);
+}
+
+// The initializer of one global may initialize another. IRGen compares the
+// predicate with -1 inline, so that is what it has to hold afterwards.
+TEST(OnceTest, NestedInitialization) {
+  swift_once(&OuterPredicate, initializeOuter);
+  EXPECT_TRUE(InnerDone);
+  EXPECT_EQ(~swift_once_t(0), OuterPredicate);
+  EXPECT_EQ(~swift_once_t(0), InnerPredicate);
+}
+#endif
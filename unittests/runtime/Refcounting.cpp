@@ -13,6 +13,7 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 using namespace swift;
 
@@ -117,6 +118,34 @@ TEST(RefcountingTest, retain_release_n) {
   EXPECT_EQ(1u, swift_retainCount(object));
 }
 
+TEST(RefcountingTest, retain_release_array) {
+  size_t values[2] = {0, 0};
+  auto first = allocTestObject(&values[0], 1);
+  auto second = allocTestObject(&values[1], 2);
+
+  // Pairs of a reference and an unrelated word, with repeats and nils.
+  HeapObject *refs[][2] = {
+    {first, nullptr}, {first, nullptr}, {nullptr, nullptr},
+    {second, nullptr}, {first, nullptr}, {nullptr, nullptr},
+  };
+  const size_t count = sizeof(refs) / sizeof(refs[0]);
+
+  swift_retainArray(&refs[0][0], count, sizeof(refs[0]));
+  EXPECT_EQ(4u, swift_retainCount(first));
+  EXPECT_EQ(2u, swift_retainCount(second));
+
+  swift_releaseArray(&refs[0][0], count, sizeof(refs[0]));
+  EXPECT_EQ(1u, swift_retainCount(first));
+  EXPECT_EQ(1u, swift_retainCount(second));
+  EXPECT_EQ(0u, values[0]);
+  EXPECT_EQ(0u, values[1]);
+
+  HeapObject *last[] = {first, second};
+  swift_releaseArray(last, 2, sizeof(last[0]));
+  EXPECT_EQ(1u, values[0]);
+  EXPECT_EQ(2u, values[1]);
+}
+
 TEST(RefcountingTest, unknown_retain_release_n) {
   size_t value = 0;
   auto object = allocTestObject(&value, 1);
@@ -153,6 +182,111 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   EXPECT_EQ(1u, value);
 }
 
+TEST(RefcountingTest, release_on_other_thread) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  swift_retain(object);
+  swift_retain(object);
+  EXPECT_EQ(3u, swift_retainCount(object));
+
+  // Hand two of the references to another thread.
+  std::thread([object] {
+    swift_retain(object);
+    swift_release(object);
+    swift_release(object);
+    swift_release(object);
+  }).join();
+  EXPECT_EQ(0u, value);
+  EXPECT_EQ(1u, swift_retainCount(object));
+
+  swift_release(object);
+
+  // With biased reference counting, an object released on another thread
+  // is merged by its owner the next time it allocates.
+  size_t otherValue = 0;
+  swift_release(allocTestObject(&otherValue, 1));
+  EXPECT_EQ(1u, otherValue);
+  EXPECT_EQ(1u, value);
+}
+
+TEST(RefcountingTest, allocating_thread_exits) {
+  size_t value = 0;
+  TestObject *object = nullptr;
+  std::thread([&] {
+    object = allocTestObject(&value, 1);
+    swift_retain(object);
+  }).join();
+
+  swift_release(object);
+  EXPECT_EQ(0u, value);
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+}
+
+TEST(RefcountingTest, weak_load_after_release) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+
+  WeakReference ref;
+  swift_weakInit(&ref, object);
+  auto loaded = swift_weakLoadStrong(&ref);
+  EXPECT_EQ(object, loaded);
+  swift_release(loaded);
+
+  // A weak reference doesn't keep the object allocated.
+  EXPECT_EQ(1u, swift_unownedRetainCount(object));
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref));
+
+  swift_weakDestroy(&ref);
+}
+
+TEST(RefcountingTest, weak_copy_and_take) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+
+  WeakReference ref1, ref2, ref3;
+  swift_weakInit(&ref1, object);
+  swift_weakCopyInit(&ref2, &ref1);
+  swift_weakTakeInit(&ref3, &ref1);
+
+  auto loaded = swift_weakTakeStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  swift_release(loaded);
+
+  swift_weakInit(&ref1, nullptr);
+  swift_weakCopyAssign(&ref1, &ref3);
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  EXPECT_EQ(nullptr, swift_weakTakeStrong(&ref3));
+  swift_weakDestroy(&ref1);
+}
+
+TEST(RefcountingTest, weak_assign) {
+  size_t value1 = 0, value2 = 0;
+  auto object1 = allocTestObject(&value1, 1);
+  auto object2 = allocTestObject(&value2, 1);
+
+  WeakReference ref;
+  swift_weakInit(&ref, object1);
+  swift_weakAssign(&ref, object2);
+  swift_release(object1);
+  EXPECT_EQ(1u, value1);
+
+  auto loaded = swift_weakLoadStrong(&ref);
+  EXPECT_EQ(object2, loaded);
+  swift_release(loaded);
+
+  swift_weakAssign(&ref, nullptr);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref));
+  swift_release(object2);
+  EXPECT_EQ(1u, value2);
+  swift_weakDestroy(&ref);
+}
+
 /////////////////////////////////////////
 // Non-atomic reference counting tests //
 /////////////////////////////////////////
@@ -0,0 +1,89 @@
+//===--- WeakReferenceBenchmark.cpp - Weak reference memory benchmark -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures how much memory stays allocated for objects that are only
+// referenced weakly, as in an object graph whose delegates point back to
+// their owners. This is disabled by default; run it with
+//
+//   SwiftRuntimeTests --gtest_also_run_disabled_tests \
+//     --gtest_filter='*WeakReferenceBenchmark*'
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+using namespace swift;
+
+namespace {
+
+/// A typical model object: a header and a few hundred bytes of fields.
+struct ModelObject : HeapObject {
+  char Fields[240];
+};
+
+void destroyModelObject(HeapObject *object) {
+  swift_deallocObject(object, sizeof(ModelObject), alignof(ModelObject) - 1);
+}
+
+const FullMetadata<ClassMetadata> ModelObjectMetadata = {
+  { { &destroyModelObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+const size_t NumObjects = 100000;
+
+size_t getHeapBytesInUse() {
+#if defined(__APPLE__)
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  return stats.size_in_use;
+#else
+  return mallinfo().uordblks;
+#endif
+}
+
+} // end anonymous namespace
+
+TEST(WeakReferenceBenchmark, DISABLED_MemoryHeldByWeakReferences) {
+  std::vector<WeakReference> delegates(NumObjects);
+
+  size_t before = getHeapBytesInUse();
+  for (auto &delegate : delegates) {
+    auto object = swift_allocObject(&ModelObjectMetadata, sizeof(ModelObject),
+                                    alignof(ModelObject) - 1);
+    swift_weakInit(&delegate, object);
+    swift_release(object);
+  }
+  size_t after = getHeapBytesInUse();
+
+  for (auto &delegate : delegates)
+    EXPECT_EQ(nullptr, swift_weakLoadStrong(&delegate));
+
+  printf("%zu weakly referenced %zu-byte objects: %zu bytes still allocated "
+         "(%zu per object)\n",
+         NumObjects, sizeof(ModelObject), after - before,
+         (after - before) / NumObjects);
+
+  for (auto &delegate : delegates)
+    swift_weakDestroy(&delegate);
+}
@@ -0,0 +1,123 @@
+#!/usr/bin/env python
+# process-stats-dir.py - Summarize -stats-output-dir files -*- python -*-
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ----------------------------------------------------------------------------
+#
+# Totals the JSON files that frontend jobs write to the directory given with
+# -stats-output-dir, across a whole build, and lists the jobs that took the
+# longest:
+#
+#   swiftc -stats-output-dir /tmp/stats ...
+#   utils/process-stats-dir.py /tmp/stats
+#
+# ----------------------------------------------------------------------------
+
+from __future__ import print_function
+
+import argparse
+import collections
+import csv
+import glob
+import json
+import os
+import sys
+
+
+def load_jobs(dirs):
+    jobs = []
+    for d in dirs:
+        for path in sorted(glob.glob(os.path.join(d, "frontend-*.json"))):
+            with open(path) as f:
+                try:
+                    job = json.load(f)
+                except ValueError as e:
+                    print("warning: skipping %s: %s" % (path, e),
+                          file=sys.stderr)
+                    continue
+            job["path"] = path
+            jobs.append(job)
+    return jobs
+
+
+def job_time_ms(job):
+    # Phases nest, so the time of a job is that of its longest phase.
+    return max(list(job.get("phases_ms", {}).values()) + [0])
+
+
+def totals(jobs):
+    total = collections.OrderedDict()
+
+    def add(key, value):
+        total[key] = total.get(key, 0) + value
+
+    for job in jobs:
+        for phase, ms in job.get("phases_ms", {}).items():
+            add("time_ms." + phase, ms)
+        for group in ("ast", "sil"):
+            for key, value in job.get(group, {}).items():
+                add(group + "." + key, value)
+        for name, counts in job.get("diagnostics", {}).items():
+            for key, value in counts.items():
+                add("diagnostics.%s.%s" % (name, key), value)
+        for stat in job.get("llvm_statistics", []):
+            add("%s.%s" % (stat["component"], stat["description"]),
+                stat["value"])
+    total["jobs"] = len(jobs)
+    total["max_peak_rss_bytes"] = max(
+        [job.get("peak_rss_bytes", 0) for job in jobs] + [0])
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Summarize the statistics of the frontend jobs of a "
+                    "build, as written by -stats-output-dir.")
+    parser.add_argument("dirs", nargs="+", metavar="DIR",
+                        help="directory passed to -stats-output-dir")
+    parser.add_argument("--csv", action="store_true",
+                        help="print the totals as CSV")
+    parser.add_argument("--top", type=int, default=10, metavar="N",
+                        help="list the N slowest jobs (default: 10)")
+    args = parser.parse_args()
+
+    jobs = load_jobs(args.dirs)
+    if not jobs:
+        print("error: no statistics files found", file=sys.stderr)
+        return 1
+
+    total = totals(jobs)
+    if args.csv:
+        writer = csv.writer(sys.stdout)
+        writer.writerow(["name", "value"])
+        for key in sorted(total):
+            writer.writerow([key, total[key]])
+        return 0
+
+    width = max(len(key) for key in total)
+    for key in sorted(total):
+        value = total[key]
+        if isinstance(value, float):
+            print("%-*s %14.3f" % (width, key, value))
+        else:
+            print("%-*s %14d" % (width, key, value))
+
+    if args.top > 0:
+        print()
+        print("Slowest jobs:")
+        for job in sorted(jobs, key=job_time_ms, reverse=True)[:args.top]:
+            files = ", ".join(job.get("primary_files", [])) or "(whole module)"
+            print("%12.3f ms  %s: %s" % (job_time_ms(job), job.get("module"),
+                                         files))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -59,6 +59,7 @@ _swift_complete()
       -sil-print-pass-name \
       -sil-print-pass-time \
       -sil-opt-pass-count \
+      -sil-print-last \
       -sil-print-only-function \
       -sil-print-only-functions \
       -sil-print-before \
@@ -2,6 +2,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/Twine.h"
+#include <algorithm>
 #include <vector>
 #include "stdlib.h"
 
@@ -52,7 +53,7 @@ static void run() {
   unsigned nextTemp = 0;
 
   while (true) {
-    switch (randCount(10)) {
+    switch (randCount(12)) {
     case 0: {
       auto from = randNV();
       auto to = randNV();
@@ -170,12 +171,44 @@ static void run() {
       while (count--) vecs[to].push_back(true);
       break;
     }
+
+    case 10:
+    case 11: {
+      auto to = randNV();
+      auto size = cbvs[to].size();
+      auto start = randCount(size + 1);
+      auto count = randCount(size - start + 1);
+      bool value = (randCount(2) == 0);
+      llvm::outs() << "  cbvs[" << to << "]."
+                   << (value ? "setBits(" : "clearBits(")
+                   << start << ", " << count << ");\n";
+      if (value)
+        cbvs[to].setBits(start, count);
+      else
+        cbvs[to].clearBits(start, count);
+      std::fill(vecs[to].begin() + start, vecs[to].begin() + start + count,
+                value);
+      break;
+    }
     }
 
     // Validate that everything's still okay.
     for (auto i = 0; i != NV; ++i) {
       checkConsistency("cbvs[" + Twine(i) + "]", cbvs[i], vecs[i], 1);
 
+      auto first = std::find(vecs[i].begin(), vecs[i].end(), true);
+      auto last = std::find(vecs[i].rbegin(), vecs[i].rend(), true);
+      Optional<size_t> expectedFirst, expectedLast;
+      if (first != vecs[i].end()) {
+        expectedFirst = first - vecs[i].begin();
+        expectedLast = vecs[i].rend() - last - 1;
+      }
+      if (cbvs[i].findFirstSetBit() != expectedFirst ||
+          cbvs[i].findLastSetBit() != expectedLast) {
+        llvm::outs() << "  cbvs[" << i << "] has wrong first or last set bit\n";
+        abort();
+      }
+
       auto enumerator = cbvs[i].enumerateSetBits();
       auto nextIndex = enumerator.findNext();
       for (unsigned j = 0, je = cbvs[i].size(); j != je; ++j) {